@@ -7,6 +7,8 @@
 //
 
 #import "AppDelegate.h"
+#import "EKTrace.h"
+#import "EKRecord.h"
 
 @interface AppDelegate ()
 
@@ -17,6 +19,13 @@
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions {
     // Override point for customization after application launch.
+    
+#if DEBUG
+    // If the app crashes, the most recent trace messages get written to this file (see EKTrace.h)
+    NSString* tracePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"EKTrace.log"];
+    EKTraceInstallCrashHandler([tracePath fileSystemRepresentation]);
+#endif
+    
     return YES;
 }
 
@@ -28,6 +37,20 @@
 - (void)applicationDidEnterBackground:(UIApplication *)application {
     // Use this method to release shared resources, save user data, invalidate timers, and store enough application state information to restore your application to its current state in case it is terminated later.
     // If your application supports background execution, this method is called instead of applicationWillTerminate: when the user quits.
+    
+    // Saves are written out in the background (see EKRecord), so the app asks for a little extra time to finish any that
+    // haven't been written yet.
+    __block UIBackgroundTaskIdentifier saveTask = [application beginBackgroundTaskWithExpirationHandler:^{
+        [application endBackgroundTask:saveTask];
+        saveTask = UIBackgroundTaskInvalid;
+    }];
+    
+    [[EKRecord sharedRecord] flushSavesWithCompletion:^{
+        if( saveTask != UIBackgroundTaskInvalid ) {
+            [application endBackgroundTask:saveTask];
+            saveTask = UIBackgroundTaskInvalid;
+        }
+    }];
 }
 
 - (void)applicationWillEnterForeground:(UIApplication *)application {
@@ -40,6 +63,7 @@
 
 - (void)applicationWillTerminate:(UIApplication *)application {
     // Called when the application is about to terminate. Save data if appropriate. See also applicationDidEnterBackground:.
+    [[EKRecord sharedRecord] flushSaves];
 }
 
 @end
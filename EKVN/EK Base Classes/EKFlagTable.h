@@ -0,0 +1,98 @@
+//
+//  EKFlagTable.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ EKFlagTable
+
+ Holds a set of flags (see EKRecord for what flags are) without storing each one as an NSNumber object inside of
+ a dictionary. Every flag name gets a "slot" number, and each slot is just an int64 value in a contiguous array, so
+ reading a flag is an array lookup and modifying a flag doesn't allocate anything. Slot numbers are shared by the
+ whole app (the same flag name always has the same slot, in every table), which is what lets VNScript resolve flag
+ names once when a script is loaded, instead of hashing a string every time a flag is used.
+
+ Flags aren't ALWAYS integers (EKRecord allows any kind of object to be used as a flag), so values that can't be
+ stored as an int64 (strings, floating-point numbers, BOOLs, etc.) are kept as objects on the side. They can still
+ be read as integers, in which case they're converted the same way 'intValue' would convert them.
+
+ Every change marks that flag's slot as "dirty", so that whatever owns the table can find out which flags have
+ changed since the last time it checked (and write back just those flags). The table can be created from, and
+ turned back into, the same dictionary that's stored in saved games under EKRecordFlagsKey, so the save format
+ doesn't change.
+
+ Copying a table is cheap no matter how many flags it has: the copy shares its storage with the original, and the
+ storage only gets copied the first time one of the two tables is modified ("copy-on-write"). That makes a copy a good
+ way to take a snapshot of a set of flags, which is what VNScene's safe-save does before every effect.
+
+ Flag tables are NOT thread-safe (they're meant to be used on the main thread, like the rest of EKVN), but a copy
+ can be handed off to another thread, as long as only that thread uses the copy (this is how EKRecord saves flags in
+ the background). The slot registry can be used from any thread.
+
+ */
+
+#import <Foundation/Foundation.h>
+
+#pragma mark - Definitions
+
+#define EKFlagTableNoSlot           UINT32_MAX  // Returned when a slot doesn't exist (same value as VNScriptImageNotFound)
+
+#pragma mark - EKFlagTable
+
+@interface EKFlagTable : NSObject <NSCopying>
+
+#pragma mark Slots
+
+// Returns the slot for a flag name, creating a new slot if this is the first time that name has been used
++ (uint32_t)slotForFlagNamed:(NSString*)name;
++ (NSString*)flagNameForSlot:(uint32_t)slot;
++ (uint32_t)slotCount; // Number of slots that have been handed out so far
+
+#pragma mark Creation
+
++ (instancetype)flagTable;
++ (instancetype)flagTableWithDictionary:(NSDictionary*)flags;
+- (instancetype)initWithDictionary:(NSDictionary*)flags;
+
+#pragma mark Flags (by slot)
+
+- (BOOL)hasValueForSlot:(uint32_t)slot;
+- (int64_t)valueForSlot:(uint32_t)slot; // Flags that don't exist are treated as zero
+- (void)setValue:(int64_t)value forSlot:(uint32_t)slot;
+- (int64_t)modifyValueForSlot:(uint32_t)slot by:(int64_t)amount; // Returns the updated value
+- (id)objectForSlot:(uint32_t)slot; // NSNumber (or whatever object was stored), or nil if the flag doesn't exist
+- (void)setObject:(id)object forSlot:(uint32_t)slot; // Passing nil removes the flag
+- (void)removeValueForSlot:(uint32_t)slot;
+
+#pragma mark Flags (by name)
+
+// These work just like the slot functions above (they look up the slot first, and then call those)
+- (BOOL)hasValueForFlagNamed:(NSString*)name;
+- (int64_t)valueOfFlagNamed:(NSString*)name;
+- (void)setValue:(int64_t)value forFlagNamed:(NSString*)name;
+- (int64_t)modifyValueOfFlagNamed:(NSString*)name by:(int64_t)amount;
+- (id)objectForFlagNamed:(NSString*)name;
+- (void)setObject:(id)object forFlagNamed:(NSString*)name;
+
+#pragma mark Dirty flags
+
+- (BOOL)hasChanges;                         // Has anything changed since the last 'clearChanges'?
+- (NSUInteger)modificationCount;            // Goes up every time a flag changes (or the changes are cleared)
+- (BOOL)slotHasChanged:(uint32_t)slot;
+- (NSDictionary*)changedFlags;              // Name/value pairs for every changed flag (removed flags map to NSNull)
+- (void)clearChanges;
+
+#pragma mark Dictionaries
+
+// The dictionary format is the one stored under EKRecordFlagsKey (flag name -> NSNumber or other object)
+- (NSUInteger)count;
+- (NSMutableDictionary*)dictionaryRepresentation;
+- (void)addEntriesFromDictionary:(NSDictionary*)flags; // Overwrites flags that already exist
+- (void)addEntriesFromDictionary:(NSDictionary*)flags overwriteExistingFlags:(BOOL)shouldOverwrite;
+- (void)addEntriesFromFlagTable:(EKFlagTable*)otherTable; // Copies every flag in the other table into this one
+- (void)applyChangesFromFlagTable:(EKFlagTable*)otherTable; // Copies (or removes) only the other table's changed flags
+- (void)removeAllFlags;
+
+@end
@@ -0,0 +1,657 @@
+//
+//  EKFlagTable.m
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#import "EKFlagTable.h"
+
+#include <stdatomic.h>
+
+#pragma mark - Bitmaps
+
+// Each table keeps three bitmaps (one bit per slot): whether the slot has a value, whether that value is an object
+// instead of an integer, and whether the slot has changed since the last time 'clearChanges' was called.
+#define EKFlagTableBitsPerWord      64
+
+static inline BOOL EKFlagTableBitIsSet(const uint64_t* bits, uint32_t slot)
+{
+    return (bits[slot / EKFlagTableBitsPerWord] >> (slot % EKFlagTableBitsPerWord)) & 1;
+}
+
+static inline void EKFlagTableSetBit(uint64_t* bits, uint32_t slot)
+{
+    bits[slot / EKFlagTableBitsPerWord] |= ((uint64_t)1 << (slot % EKFlagTableBitsPerWord));
+}
+
+static inline void EKFlagTableClearBit(uint64_t* bits, uint32_t slot)
+{
+    bits[slot / EKFlagTableBitsPerWord] &= ~((uint64_t)1 << (slot % EKFlagTableBitsPerWord));
+}
+
+// Checks if an object can be stored in the int64 array without losing anything when it gets turned back into an
+// object (floating-point numbers and BOOLs would come back as plain integers, so those are kept as objects instead).
+static BOOL EKFlagTableIntegerFromObject(id object, int64_t* outValue)
+{
+    if( object == nil || [object isKindOfClass:[NSNumber class]] == NO )
+        return NO;
+
+    CFTypeRef number = (__bridge CFTypeRef)object;
+    if( CFGetTypeID(number) == CFBooleanGetTypeID() || CFNumberIsFloatType((CFNumberRef)number) )
+        return NO;
+
+    *outValue = [object longLongValue];
+    return YES;
+}
+
+#pragma mark - Storage
+
+// The arrays and bitmaps are kept in a "storage" block that copies of the table share, so that copying a table doesn't
+// copy any flags. Whichever table modifies the storage first gets its own copy of it (copy-on-write), which means that
+// a copy that never gets modified (like a snapshot) never costs more than the copy itself.
+typedef struct {
+    int64_t* values;
+    uint64_t* presentBits;
+    uint64_t* objectBits;
+    uint64_t* dirtyBits;
+    uint32_t capacity;              // Number of slots that the arrays can hold (always a multiple of 64)
+
+    NSUInteger flagCount;
+    NSUInteger changeCount;         // Number of dirty bits that are set
+    _Atomic(NSUInteger) referenceCount; // Number of tables using this storage (copies can be released on other threads)
+} EKFlagTableStorage;
+
+static EKFlagTableStorage* EKFlagTableStorageCreate(void)
+{
+    EKFlagTableStorage* storage = calloc(1, sizeof(EKFlagTableStorage));
+    if( storage != NULL )
+        storage->referenceCount = 1;
+
+    return storage;
+}
+
+static void EKFlagTableStorageRelease(EKFlagTableStorage* storage)
+{
+    if( storage == NULL )
+        return;
+
+    if( atomic_fetch_sub(&storage->referenceCount, 1) > 1 )
+        return;
+
+    free(storage->values);
+    free(storage->presentBits);
+    free(storage->objectBits);
+    free(storage->dirtyBits);
+    free(storage);
+}
+
+// Creates a copy of some storage that isn't shared with anything yet (or returns NULL if there wasn't enough memory)
+static EKFlagTableStorage* EKFlagTableStorageCopy(const EKFlagTableStorage* original)
+{
+    EKFlagTableStorage* storage = EKFlagTableStorageCreate();
+    if( storage == NULL || original->capacity == 0 )
+        return storage;
+
+    size_t words = original->capacity / EKFlagTableBitsPerWord;
+    storage->values = malloc(original->capacity * sizeof(int64_t));
+    storage->presentBits = malloc(words * sizeof(uint64_t));
+    storage->objectBits = malloc(words * sizeof(uint64_t));
+    storage->dirtyBits = malloc(words * sizeof(uint64_t));
+
+    if( storage->values == NULL || storage->presentBits == NULL || storage->objectBits == NULL || storage->dirtyBits == NULL ) {
+        EKFlagTableStorageRelease(storage);
+        return NULL;
+    }
+
+    memcpy(storage->values, original->values, original->capacity * sizeof(int64_t));
+    memcpy(storage->presentBits, original->presentBits, words * sizeof(uint64_t));
+    memcpy(storage->objectBits, original->objectBits, words * sizeof(uint64_t));
+    memcpy(storage->dirtyBits, original->dirtyBits, words * sizeof(uint64_t));
+    storage->capacity = original->capacity;
+    storage->flagCount = original->flagCount;
+    storage->changeCount = original->changeCount;
+
+    return storage;
+}
+
+#pragma mark - Slot registry
+
+// Every flag name that's been used so far, along with its slot number
+static NSMutableDictionary* EKFlagTableSlotsByName = nil;
+static NSMutableArray* EKFlagTableNamesBySlot = nil;
+
+// Same as 'slotForFlagNamed' except that no slot gets created (used when reading flags, so that checking for a flag
+// that doesn't exist won't use up a slot)
+static uint32_t EKFlagTableExistingSlot(NSString* name)
+{
+    if( name == nil )
+        return EKFlagTableNoSlot;
+
+    @synchronized( [EKFlagTable class] ) {
+
+        NSNumber* slot = [EKFlagTableSlotsByName objectForKey:name];
+        return (slot != nil) ? [slot unsignedIntValue] : EKFlagTableNoSlot;
+    }
+}
+
+#pragma mark - EKFlagTable
+
+@implementation EKFlagTable
+{
+    EKFlagTableStorage* storage;    // Might be shared with copies of this table (see 'prepareToModify')
+    NSMutableDictionary* objects;   // Slot number (NSNumber) -> non-integer value
+    BOOL objectsAreShared;          // The objects dictionary is shared with a copy, and has to be copied before it's modified
+    NSUInteger modificationCount;   // Belongs to this table (not the storage), since copies change separately
+}
+
++ (uint32_t)slotForFlagNamed:(NSString*)name
+{
+    if( name == nil )
+        return EKFlagTableNoSlot;
+
+    @synchronized( [EKFlagTable class] ) {
+
+        if( EKFlagTableSlotsByName == nil ) {
+            EKFlagTableSlotsByName = [[NSMutableDictionary alloc] init];
+            EKFlagTableNamesBySlot = [[NSMutableArray alloc] init];
+        }
+
+        NSNumber* slot = [EKFlagTableSlotsByName objectForKey:name];
+        if( slot == nil ) {
+
+            NSString* key = [name copy];
+            slot = @(EKFlagTableNamesBySlot.count);
+            [EKFlagTableSlotsByName setObject:slot forKey:key];
+            [EKFlagTableNamesBySlot addObject:key];
+        }
+
+        return [slot unsignedIntValue];
+    }
+}
+
++ (NSString*)flagNameForSlot:(uint32_t)slot
+{
+    @synchronized( [EKFlagTable class] ) {
+
+        if( slot >= EKFlagTableNamesBySlot.count )
+            return nil;
+
+        return [EKFlagTableNamesBySlot objectAtIndex:slot];
+    }
+}
+
++ (uint32_t)slotCount
+{
+    @synchronized( [EKFlagTable class] ) {
+        return (uint32_t)EKFlagTableNamesBySlot.count;
+    }
+}
+
+#pragma mark - Creation
+
++ (instancetype)flagTable
+{
+    return [[self alloc] init];
+}
+
++ (instancetype)flagTableWithDictionary:(NSDictionary*)flags
+{
+    return [[self alloc] initWithDictionary:flags];
+}
+
+- (instancetype)init
+{
+    if( (self = [super init]) ) {
+
+        storage = EKFlagTableStorageCreate();
+        if( storage == NULL ) {
+            NSLog(@"[EKFlagTable] ERROR: Could not allocate memory for flag table.");
+            return nil;
+        }
+
+        objects = [[NSMutableDictionary alloc] init];
+    }
+
+    return self;
+}
+
+// The new table starts out with no changes, since it holds exactly what's in the dictionary
+- (instancetype)initWithDictionary:(NSDictionary*)flags
+{
+    if( (self = [self init]) ) {
+        [self addEntriesFromDictionary:flags];
+        [self clearChanges];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    EKFlagTableStorageRelease(storage);
+}
+
+// Copies share everything with the original (so making a copy doesn't depend on how many flags there are); the storage
+// only gets copied once one of the tables is modified.
+- (id)copyWithZone:(NSZone*)zone
+{
+    EKFlagTable* copy = [[[self class] allocWithZone:zone] init];
+    if( copy == nil )
+        return nil;
+
+    EKFlagTableStorageRelease(copy->storage);
+    copy->storage = storage;
+    storage->referenceCount++;
+
+    copy->objects = objects;
+    copy->objectsAreShared = YES;
+    objectsAreShared = YES;
+
+    return copy;
+}
+
+// Has to be called before anything in the storage gets modified. If the storage is shared with another table, then
+// this table gets its own copy of it.
+- (BOOL)prepareToModify
+{
+    if( storage->referenceCount > 1 ) {
+
+        EKFlagTableStorage* copiedStorage = EKFlagTableStorageCopy(storage);
+        if( copiedStorage == NULL ) {
+            NSLog(@"[EKFlagTable] ERROR: Could not allocate memory for %u flags.", storage->capacity);
+            return NO;
+        }
+
+        EKFlagTableStorageRelease(storage);
+        storage = copiedStorage;
+    }
+
+    return YES;
+}
+
+// Same idea as 'prepareToModify', but for the dictionary of non-integer values
+- (void)prepareToModifyObjects
+{
+    if( objectsAreShared == YES ) {
+        objects = [objects mutableCopy];
+        objectsAreShared = NO;
+    }
+}
+
+// Makes sure that the arrays are big enough to hold a particular slot (and that the storage isn't shared with another
+// table, since the caller is about to modify it). New slots are empty.
+- (BOOL)growToSlot:(uint32_t)slot
+{
+    if( slot == EKFlagTableNoSlot || [self prepareToModify] == NO )
+        return NO;
+
+    uint32_t capacity = storage->capacity;
+    if( slot < capacity )
+        return YES;
+
+    uint32_t updatedCapacity = (capacity > 0) ? capacity : EKFlagTableBitsPerWord;
+    while( updatedCapacity <= slot )
+        updatedCapacity *= 2;
+
+    size_t oldWords = capacity / EKFlagTableBitsPerWord;
+    size_t newWords = updatedCapacity / EKFlagTableBitsPerWord;
+
+    int64_t* updatedValues = realloc(storage->values, updatedCapacity * sizeof(int64_t));
+    if( updatedValues == NULL ) {
+        NSLog(@"[EKFlagTable] ERROR: Could not allocate memory for %u flags.", updatedCapacity);
+        return NO;
+    }
+    storage->values = updatedValues;
+    memset(storage->values + capacity, 0, (updatedCapacity - capacity) * sizeof(int64_t));
+
+    uint64_t** bitmaps[3] = { &storage->presentBits, &storage->objectBits, &storage->dirtyBits };
+    for( int i = 0; i < 3; i++ ) {
+
+        uint64_t* updatedBits = realloc(*bitmaps[i], newWords * sizeof(uint64_t));
+        if( updatedBits == NULL ) {
+            NSLog(@"[EKFlagTable] ERROR: Could not allocate memory for %u flags.", updatedCapacity);
+            return NO; // The arrays that were already resized are still valid, and 'capacity' hasn't changed yet
+        }
+
+        memset(updatedBits + oldWords, 0, (newWords - oldWords) * sizeof(uint64_t));
+        *bitmaps[i] = updatedBits;
+    }
+
+    storage->capacity = updatedCapacity;
+    return YES;
+}
+
+- (void)markSlotAsChanged:(uint32_t)slot
+{
+    modificationCount++;
+    
+    if( EKFlagTableBitIsSet(storage->dirtyBits, slot) == NO ) {
+        EKFlagTableSetBit(storage->dirtyBits, slot);
+        storage->changeCount++;
+    }
+}
+
+#pragma mark - Flags (by slot)
+
+- (BOOL)hasValueForSlot:(uint32_t)slot
+{
+    return slot < storage->capacity && EKFlagTableBitIsSet(storage->presentBits, slot);
+}
+
+- (int64_t)valueForSlot:(uint32_t)slot
+{
+    if( [self hasValueForSlot:slot] == NO )
+        return 0;
+
+    if( EKFlagTableBitIsSet(storage->objectBits, slot) ) {
+
+        id object = [objects objectForKey:@(slot)];
+        return [object respondsToSelector:@selector(longLongValue)] ? [object longLongValue] : 0;
+    }
+
+    return storage->values[slot];
+}
+
+- (void)setValue:(int64_t)value forSlot:(uint32_t)slot
+{
+    // Setting a flag to the value it already has doesn't count as a change (and doesn't need the storage to be copied)
+    if( [self hasValueForSlot:slot] && EKFlagTableBitIsSet(storage->objectBits, slot) == NO && storage->values[slot] == value )
+        return;
+
+    if( [self growToSlot:slot] == NO )
+        return;
+
+    if( EKFlagTableBitIsSet(storage->presentBits, slot) == NO ) {
+        EKFlagTableSetBit(storage->presentBits, slot);
+        storage->flagCount++;
+    } else if( EKFlagTableBitIsSet(storage->objectBits, slot) ) {
+        EKFlagTableClearBit(storage->objectBits, slot);
+        [self prepareToModifyObjects];
+        [objects removeObjectForKey:@(slot)];
+    }
+
+    storage->values[slot] = value;
+    [self markSlotAsChanged:slot];
+}
+
+// If the flag doesn't exist yet, it gets created with 'amount' as its value
+- (int64_t)modifyValueForSlot:(uint32_t)slot by:(int64_t)amount
+{
+    int64_t updatedValue = [self valueForSlot:slot] + amount;
+    [self setValue:updatedValue forSlot:slot];
+
+    return updatedValue;
+}
+
+- (id)objectForSlot:(uint32_t)slot
+{
+    if( [self hasValueForSlot:slot] == NO )
+        return nil;
+
+    if( EKFlagTableBitIsSet(storage->objectBits, slot) )
+        return [objects objectForKey:@(slot)];
+
+    return @(storage->values[slot]);
+}
+
+- (void)setObject:(id)object forSlot:(uint32_t)slot
+{
+    if( object == nil ) {
+        [self removeValueForSlot:slot];
+        return;
+    }
+
+    int64_t integerValue = 0;
+    if( EKFlagTableIntegerFromObject(object, &integerValue) ) {
+        [self setValue:integerValue forSlot:slot];
+        return;
+    }
+
+    if( [self growToSlot:slot] == NO )
+        return;
+
+    if( EKFlagTableBitIsSet(storage->presentBits, slot) == NO ) {
+        EKFlagTableSetBit(storage->presentBits, slot);
+        storage->flagCount++;
+    }
+
+    EKFlagTableSetBit(storage->objectBits, slot);
+    [self prepareToModifyObjects];
+    [objects setObject:object forKey:@(slot)];
+    [self markSlotAsChanged:slot];
+}
+
+- (void)removeValueForSlot:(uint32_t)slot
+{
+    if( [self hasValueForSlot:slot] == NO || [self prepareToModify] == NO )
+        return;
+
+    if( EKFlagTableBitIsSet(storage->objectBits, slot) ) {
+        EKFlagTableClearBit(storage->objectBits, slot);
+        [self prepareToModifyObjects];
+        [objects removeObjectForKey:@(slot)];
+    }
+
+    EKFlagTableClearBit(storage->presentBits, slot);
+    storage->values[slot] = 0;
+    storage->flagCount--;
+    [self markSlotAsChanged:slot];
+}
+
+#pragma mark - Flags (by name)
+
+- (BOOL)hasValueForFlagNamed:(NSString*)name
+{
+    return [self hasValueForSlot:EKFlagTableExistingSlot(name)];
+}
+
+- (int64_t)valueOfFlagNamed:(NSString*)name
+{
+    return [self valueForSlot:EKFlagTableExistingSlot(name)];
+}
+
+- (void)setValue:(int64_t)value forFlagNamed:(NSString*)name
+{
+    [self setValue:value forSlot:[EKFlagTable slotForFlagNamed:name]];
+}
+
+- (int64_t)modifyValueOfFlagNamed:(NSString*)name by:(int64_t)amount
+{
+    return [self modifyValueForSlot:[EKFlagTable slotForFlagNamed:name] by:amount];
+}
+
+- (id)objectForFlagNamed:(NSString*)name
+{
+    return [self objectForSlot:EKFlagTableExistingSlot(name)];
+}
+
+- (void)setObject:(id)object forFlagNamed:(NSString*)name
+{
+    if( object == nil ) {
+        [self removeValueForSlot:EKFlagTableExistingSlot(name)];
+        return;
+    }
+
+    [self setObject:object forSlot:[EKFlagTable slotForFlagNamed:name]];
+}
+
+#pragma mark - Dirty flags
+
+- (BOOL)hasChanges
+{
+    return storage->changeCount > 0;
+}
+
+- (BOOL)slotHasChanged:(uint32_t)slot
+{
+    return slot < storage->capacity && EKFlagTableBitIsSet(storage->dirtyBits, slot);
+}
+
+- (NSDictionary*)changedFlags
+{
+    NSMutableDictionary* changes = [NSMutableDictionary dictionaryWithCapacity:storage->changeCount];
+    if( storage->changeCount == 0 )
+        return changes;
+
+    for( uint32_t word = 0; word < storage->capacity / EKFlagTableBitsPerWord; word++ ) {
+
+        uint64_t bits = storage->dirtyBits[word];
+        while( bits != 0 ) {
+
+            uint32_t slot = (word * EKFlagTableBitsPerWord) + (uint32_t)__builtin_ctzll(bits);
+            bits &= (bits - 1);
+
+            NSString* name = [EKFlagTable flagNameForSlot:slot];
+            id value = [self objectForSlot:slot];
+            [changes setObject:(value != nil ? value : [NSNull null]) forKey:name];
+        }
+    }
+
+    return changes;
+}
+
+- (void)clearChanges
+{
+    if( storage->changeCount == 0 || [self prepareToModify] == NO )
+        return;
+
+    memset(storage->dirtyBits, 0, (storage->capacity / EKFlagTableBitsPerWord) * sizeof(uint64_t));
+    storage->changeCount = 0;
+    modificationCount++;
+}
+
+- (NSUInteger)modificationCount
+{
+    return modificationCount;
+}
+
+#pragma mark - Dictionaries
+
+- (NSUInteger)count
+{
+    return storage->flagCount;
+}
+
+- (NSMutableDictionary*)dictionaryRepresentation
+{
+    NSMutableDictionary* dictionary = [NSMutableDictionary dictionaryWithCapacity:storage->flagCount];
+
+    for( uint32_t word = 0; word < storage->capacity / EKFlagTableBitsPerWord; word++ ) {
+
+        uint64_t bits = storage->presentBits[word];
+        while( bits != 0 ) {
+
+            uint32_t slot = (word * EKFlagTableBitsPerWord) + (uint32_t)__builtin_ctzll(bits);
+            bits &= (bits - 1);
+
+            [dictionary setObject:[self objectForSlot:slot] forKey:[EKFlagTable flagNameForSlot:slot]];
+        }
+    }
+
+    return dictionary;
+}
+
+- (void)addEntriesFromDictionary:(NSDictionary*)flags
+{
+    [self addEntriesFromDictionary:flags overwriteExistingFlags:YES];
+}
+
+- (void)addEntriesFromDictionary:(NSDictionary*)flags overwriteExistingFlags:(BOOL)shouldOverwrite
+{
+    if( flags == nil || flags.count < 1 )
+        return;
+
+    [flags enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL* stop) {
+
+        if( [key isKindOfClass:[NSString class]] == NO ) {
+            NSLog(@"[EKFlagTable] WARNING: Ignoring flag with a name that isn't a string: %@", key);
+            return;
+        }
+
+        uint32_t slot = [EKFlagTable slotForFlagNamed:key];
+        if( shouldOverwrite == YES || [self hasValueForSlot:slot] == NO ) {
+            [self setObject:value forSlot:slot];
+        }
+    }];
+}
+
+- (void)addEntriesFromFlagTable:(EKFlagTable*)otherTable
+{
+    if( otherTable == nil || otherTable == self )
+        return;
+
+    // The other table's storage might be shared with this one, so it's held on to while this table gets modified
+    EKFlagTableStorage* otherStorage = otherTable->storage;
+    otherStorage->referenceCount++;
+
+    for( uint32_t word = 0; word < otherStorage->capacity / EKFlagTableBitsPerWord; word++ ) {
+
+        uint64_t bits = otherStorage->presentBits[word];
+        while( bits != 0 ) {
+
+            uint32_t slot = (word * EKFlagTableBitsPerWord) + (uint32_t)__builtin_ctzll(bits);
+            bits &= (bits - 1);
+
+            if( EKFlagTableBitIsSet(otherStorage->objectBits, slot) )
+                [self setObject:[otherTable->objects objectForKey:@(slot)] forSlot:slot];
+            else
+                [self setValue:otherStorage->values[slot] forSlot:slot];
+        }
+    }
+
+    EKFlagTableStorageRelease(otherStorage);
+}
+
+// Like 'addEntriesFromFlagTable', except that only the other table's changed ("dirty") flags get copied, so this only
+// takes as long as the number of changes. Flags that were removed from the other table are removed from this one too.
+- (void)applyChangesFromFlagTable:(EKFlagTable*)otherTable
+{
+    if( otherTable == nil || otherTable == self || [otherTable hasChanges] == NO )
+        return;
+
+    EKFlagTableStorage* otherStorage = otherTable->storage;
+    otherStorage->referenceCount++;
+
+    for( uint32_t word = 0; word < otherStorage->capacity / EKFlagTableBitsPerWord; word++ ) {
+
+        uint64_t bits = otherStorage->dirtyBits[word];
+        while( bits != 0 ) {
+
+            uint32_t slot = (word * EKFlagTableBitsPerWord) + (uint32_t)__builtin_ctzll(bits);
+            bits &= (bits - 1);
+
+            if( EKFlagTableBitIsSet(otherStorage->presentBits, slot) == NO )
+                [self removeValueForSlot:slot];
+            else if( EKFlagTableBitIsSet(otherStorage->objectBits, slot) )
+                [self setObject:[otherTable->objects objectForKey:@(slot)] forSlot:slot];
+            else
+                [self setValue:otherStorage->values[slot] forSlot:slot];
+        }
+    }
+
+    EKFlagTableStorageRelease(otherStorage);
+}
+
+- (void)removeAllFlags
+{
+    if( [self prepareToModify] == NO )
+        return;
+
+    for( uint32_t word = 0; word < storage->capacity / EKFlagTableBitsPerWord; word++ ) {
+
+        uint64_t bits = storage->presentBits[word];
+        while( bits != 0 ) {
+
+            uint32_t slot = (word * EKFlagTableBitsPerWord) + (uint32_t)__builtin_ctzll(bits);
+            bits &= (bits - 1);
+            [self removeValueForSlot:slot];
+        }
+    }
+}
+
+- (NSString*)description
+{
+    return [[self dictionaryRepresentation] description];
+}
+
+@end
@@ -9,14 +9,19 @@
  
  EKRecord
  
- This class works by storing game data in NSUserDefaults. There are two types of data; the "global" data
+ This class works by storing game data on the device. There are two types of data; the "global" data
  that remains the same across all saved games / new games, and then the data that's stored inside "slots"
  and is only relevant within a particular playthrough of the game.
  
  The "global" relevant-across-all-playthroughs data is just stored in NSUserDefault's "root" dictionary
  as either NSString or NSNumber objects. Conversely, an entire slot is stored as a single NSData object
- in the root dictionary. Each slot can be accessed through the dictionary key "slotX", where X is the
- number.
+ in a file of its own, named "slotX.sav" (where X is the number), in the "Saved Games" folder inside of the
+ app's Application Support folder. Older versions stored slots in NSUserDefaults under the key "slotX";
+ those get moved into files the first time EKRecord looks at its slots.
+ 
+ The same folder also has a slot index (see EKSlotIndex), which holds a short summary of every slot: when it
+ was saved, the activity type, the score, and a preview of whoever was speaking. A save/load menu can show
+ all the slots with 'summariesOfUsedSlots', which only reads the index instead of loading every saved game.
  
  The main Global values are:
    1. HIGH SCORE (NSUInteger) - The highest score achieved by a player
@@ -28,8 +33,9 @@
  in Slot Zero. On the other hand, some other game types (such as, say, JRPGs) might require multiple slots.
  There is no hard-coded limit on the number of slots you can use.
 
- Each slot is an NSData object, which can be decoded into a single NSDictionary (or more practically,
- an NSMutableDictionary) called the Record, which holds the following values:
+ Each slot is an NSData object (in a compact binary format, or JSON if 'savesAsJSON' is turned on), which can be
+ decoded into a single NSDictionary (or more practically, an NSMutableDictionary) called the Record, which holds
+ the following values:
  
    1. ACTIVITY TYPE (NSString) - What kind of activity the player was engaged in when the game was saved
                                  (a specific mini-game, cutscene, etc)
@@ -57,12 +63,12 @@
  EKRecord is meant to be used as a singleton, and having multiple EKRecord objects in existence may lead to
  unknown/untested behaviors, especially since they all write data to the same NSUserDefaults dictionary.
  
- In the future, functionality for saving to iCloud or to actual files (as opposed to NSUserDefaults) may be
- added, but for now EKRecord works well enough.
+ In the future, functionality for saving to iCloud may be added, but for now EKRecord works well enough.
  
  */
 
 #import <UIKit/UIKit.h>
+#import "EKFlagTable.h"
 
 #pragma mark Definitions
 
@@ -73,6 +79,7 @@
 #define EKRecordDateSavedKey            @"date saved"       // The last time any data was saved on this device
 #define EKRecordCurrentSlotKey          @"current slot"     // The most recently used slot
 #define EKRecordUsedSlotNumbersKey      @"used slots array" // Lists all the arrays used so far
+#define EKRecordReadHistoryKey          @"read history"     // Which lines of dialogue have been read, in any playthrough (see VNReadHistory)
 
 // Keys for data that's specific to a particular playthrough and is stored inside of individual "slots" (which contain a single
 // NSData object that encapsulates all the other playthrough-specific data)
@@ -86,6 +93,12 @@
 #define EKRecordCurrentActivityDictKey  @"current activity" // Used to locate the activity data in the User Defaults
 #define EKRecordActivityTypeKey         @"activity type" // Is this a VNScene, or some other kind of CCScene / activity type?
 #define EKRecordActivityDataKey         @"activity data" // This will almost always be a dictionary with activity-specific data
+#define EKRecordPreviewSpeakerKey       @"preview speaker" // Optional; who's speaking, for showing in a list of saved games
+#define EKRecordPreviewTextKey          @"preview text" // Optional; what they're saying (only the start of it gets shown)
+
+// Keys for slot summaries (which also use the date, score, activity type, and preview keys from above)
+#define EKRecordSlotNumberKey           @"slot number"
+#define EKRecordSlotDataLengthKey       @"data length"      // Size of the saved game, in bytes
 
 /*
  Persistent Records
@@ -105,11 +118,24 @@
 {
     // The record holds all data (scores, flags, activities, etc.) for a particular playthrough of the game.
     NSMutableDictionary* record;
+    
+    // Working copy of the flags dictionary in the record (see 'flagTable' below)
+    EKFlagTable* flagTable;
 }
 
 // Which slot is being used for saved games
 @property NSUInteger currentSlot;
 
+// Records are normally saved in a compact binary format (see EKRecordBinary.h). Turning this on saves them as
+// pretty-printed JSON instead, which is handy for debugging. Either kind can always be loaded, whatever this is set to.
+@property BOOL savesAsJSON;
+
+// Journal mode: after a slot has been saved (or loaded) once, later saves to it only write down what changed since
+// then, by adding an entry to the end of the slot's journal file ("slotN.log", next to "slotN.sav"). That's much less
+// to encode and write than the whole record when only a few flags have changed. Loading a slot replays its journal,
+// and once the journal gets large, it's folded back into the slot's file in the background.
+@property BOOL usesJournal;
+
 #pragma mark - EKRecord functions
 
 + (EKRecord*)sharedRecord; // Singleton access
@@ -126,6 +152,11 @@
 - (NSMutableDictionary*)flags;
 - (void)setFlags:(NSMutableDictionary*)updatedFlags;
 
+// While the game is running, flags are kept in an EKFlagTable instead of the dictionary (the table is much faster to
+// read and modify). Changes get copied back into the dictionary whenever the record is saved, or whenever 'flags' or
+// 'record' is called. A new record is created if one doesn't exist yet.
+- (EKFlagTable*)flagTable;
+
 - (NSMutableDictionary*)spriteAliases;
 - (void)setSpriteAliases:(NSMutableDictionary*)updatedAliases;
 
@@ -134,6 +165,12 @@
 - (void)setCurrentScore:(NSUInteger)scoreValue;
 - (NSUInteger)currentScore;
 
+// The read history (which lines of dialogue have ever been seen) is a global value, like the high score, so that it
+// covers every playthrough. The record just stores it as data; VNScene is what encodes and decodes it. Passing nil
+// removes the history.
+- (void)setReadHistoryData:(NSData*)historyData;
+- (NSData*)readHistoryData;
+
 - (void)setActivityDict:(NSDictionary*)activityDict;
 - (NSDictionary*)activityDict;
 - (void)resetActivityInformationInDict:(NSDictionary*)dict;
@@ -151,6 +188,14 @@
 - (void)addToUsedSlotNumbers:(NSUInteger)slotNumber; // Adds a particular slot number to the "used slots" array
 - (BOOL)slotNumberHasBeenUsed:(NSUInteger)slotNumber; // Checks if a particular slot has been used
 
+// Summaries come from the slot index, so the saved games themselves don't get loaded. Each summary is a dictionary with
+// the slot number, the size of its data, the date (as both an NSDate and a string), the score, the activity type, and
+// (if the activity provided them) the preview speaker and text. Returns nil if the slot hasn't been used.
+- (NSDictionary*)summaryOfSlot:(NSUInteger)slotNumber;
+- (NSArray*)summariesOfUsedSlots; // In order of slot number
+
+- (NSString*)pathForSlot:(NSUInteger)slotNumber; // The file where a slot's data is kept
+
 #pragma mark Sprite Alias functions
 
 - (void)resetAllSpriteAliases;
@@ -165,6 +210,8 @@
 
 - (void)resetAllFlags;
 - (void)addExistingFlags:(NSDictionary*)existingFlags; // Add existing flags from another dictionary to EKRecord's flag dictionary
+- (void)addFlagsFromTable:(EKFlagTable*)existingFlags; // Same as above, but with the flags from a flag table
+- (void)addChangedFlagsFromTable:(EKFlagTable*)changedFlags; // Only the table's changed flags (removed flags get removed)
 - (id)flagNamed:(NSString*)nameOfFlag; // Retrieve a particular flag
 - (int)valueOfFlagNamed:(NSString*)flagName;
 - (void)setFlagValue:(id)flagValue forFlagNamed:(NSString*)nameOfFlag;
@@ -182,18 +229,32 @@
 - (void)startNewRecord; // This "resets" EKRecord so that it will have brand-new data (as in a fresh saved game)
 - (BOOL)hasAnySavedData; // Does this game have any saved-game data at all?
 
-- (NSData*)dataFromSlot:(NSUInteger)slotNumber; // Loads NSData from a "slot" (a key/value pair in the NSUserDefaults dictionary)
-- (NSDictionary*)recordFromData:(NSData*)data; // Creates an NSDictionary from NSData; assumes NSData holds saved game info
-- (NSDictionary*)recordFromSlot:(NSUInteger)slotNumber; // "Shortcut" to load NSData from NSUserDefaults, then NSDictionary from that NSData
+- (NSData*)dataFromSlot:(NSUInteger)slotNumber; // Loads NSData from a "slot" (a file in the saved games folder)
+- (NSDictionary*)recordFromData:(NSData*)data; // Creates an NSDictionary from NSData; assumes NSData holds saved game info (binary or JSON)
+- (NSDictionary*)recordFromBinaryData:(NSData*)data;
+- (NSDictionary*)recordFromSlot:(NSUInteger)slotNumber; // "Shortcut" to load NSData from a slot, then NSDictionary from that NSData
 - (void)loadRecordFromCurrentSlot; // Takes whatever data might be in the current slot and overwrites EKRecord's "record" dictionary with it
 
 #pragma mark Saving functions
 
-- (NSData*)dataFromRecord:(NSDictionary*)dict; // Encodes saved game information in NSDictionary into NSData
-- (void)saveData:(NSData*)data toSlot:(NSUInteger)slotNumber; // Saves NSData to a particular "slot" in NSUserDefaults
+- (NSData*)dataFromRecord:(NSDictionary*)dict; // Encodes saved game information in NSDictionary into NSData (see 'savesAsJSON')
+- (NSData*)binaryDataFromRecord:(NSDictionary*)dict;
+- (NSData*)JSONDataFromRecord:(NSDictionary*)dict;
+- (void)saveData:(NSData*)data toSlot:(NSUInteger)slotNumber; // Saves NSData to a particular "slot" (and updates the slot index)
 - (void)updateHighScore; // Checks if the current score is higher than the "high score" and updates the value stored in NSUserDefaults
-- (void)saveCurrentRecord; // Saves the current record to a "slot" in NSUserDefaults (the exact slot number is based on 'currentSlot')
+- (void)saveCurrentRecord; // Saves the current record to a "slot" (the exact slot number is based on 'currentSlot')
+
+// Saving only takes a snapshot of the record right away; the snapshot gets encoded and written out (to a temporary file
+// that then replaces the slot's file) on a background queue. If the same slot gets saved again before that happens, only
+// the newest save gets written. The completion block runs on the main queue once the save (or a newer one that replaced
+// it) has been written, or has failed.
+- (void)saveCurrentRecordWithCompletion:(void (^)(BOOL succeeded))completion;
+
+// These wait for every save that's been made so far to be written. Call one of them when the app goes into the
+// background, since saves that haven't been written yet are lost if the app gets terminated.
+- (void)flushSaves; // Blocks until everything's been written
+- (void)flushSavesWithCompletion:(void (^)(void))completion; // Doesn't block; the completion block runs on the main queue
 
-- (void)saveToDevice; // Saves the data stored in NSUserDefaults to device memory (this should happen on its own, but this speeds up the process)
+- (void)saveToDevice; // Saves the current record, and then saves the data stored in NSUserDefaults to device memory (this should happen on its own, but this speeds up the process)
 
 @end
@@ -7,8 +7,409 @@
 
 #import "EKRecord.h"
 #import "EKUtils.h"
+#import "EKTrace.h"
+#import "EKSlotIndex.h"
+#import "EKRecordBinary.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 //#import "VNLayer.h"
 
+#define EKRecordSavedGamesFolderName    @"Saved Games"  // Inside of the app's Application Support folder
+#define EKRecordSlotIndexFilename       @"slots.index"
+#define EKRecordSlotFilenameFormat      @"slot%lu.sav"
+#define EKRecordJournalFilenameFormat   @"slot%lu.log"  // Changes made since the slot's file was last written in full
+#define EKRecordJournalCompactionSize   (256 * 1024)    // Journals longer than this get folded back into the slot's file
+#define EKRecordLegacySlotKeyFormat     @"slot%lu"      // Where older versions kept slots in NSUserDefaults
+#define EKRecordDateFormat              @"h:mm a',' yyyy'-'MM'-'dd" // Example: "12:34 AM, 2013-02-10"
+
+// Keys for the changes in a journal entry (see 'EKRecordJournalChanges')
+#define EKRecordJournalSetKey           @"set"          // Key -> new value
+#define EKRecordJournalRemoveKey        @"remove"       // Keys that were removed
+#define EKRecordJournalNestedKey        @"nested"       // Key -> changes to the dictionary under that key
+
+// Keys for a save that's waiting to be written
+#define EKRecordPendingRecordKey        @"record"       // Snapshot of the record (with no mutable containers in it)
+#define EKRecordPendingAsJSONKey        @"as JSON"
+#define EKRecordPendingJournalKey       @"journal"
+#define EKRecordPendingCompletionsKey   @"completions"  // Completion blocks of every save that was folded into this one
+#define EKRecordPendingFlagsKey         @"flags"        // Copy of the flag table, if there is one (the record's flags are left out)
+
+@interface EKRecord () {
+    
+    // Summaries of every slot that's been used (loaded the first time anything asks about slots)
+    EKSlotIndex* slotIndex;
+    NSString* savedGamesFolder;
+    
+    // Saves get encoded and written out on a serial background queue. Each slot only ever has one save waiting to be
+    // written; if the game is saved again before that happens, the newer save replaces the one that was waiting.
+    // The slot index and the pending saves are both protected by synchronizing on 'pendingSaves'.
+    dispatch_queue_t saveQueue;
+    NSMutableDictionary* pendingSaves; // Slot number -> pending save
+    NSMutableSet* writingSlots; // Slot numbers that the save queue is writing right now (also protected by 'pendingSaves')
+    
+    // In journal mode, this is what each slot's saved game (plus its journal) looks like right now, so that the next
+    // save only has to write down what's different. Also protected by 'pendingSaves'.
+    NSMutableDictionary* journalBases; // Slot number -> snapshot
+}
+
+@end
+
+#pragma mark - Snapshots
+
+// Copies every mutable container (and string) in the record, so that the copy can be encoded on another thread while
+// the game goes on changing the original. Immutable objects are shared instead of copied, so this only costs as much
+// as the number of objects in mutable containers (there's no encoding, and nothing gets written out).
+static id EKRecordImmutableCopy(id value)
+{
+    if( [value isKindOfClass:[NSMutableDictionary class]] ) {
+        
+        NSMutableDictionary* copy = [[NSMutableDictionary alloc] initWithCapacity:[value count]];
+        [value enumerateKeysAndObjectsUsingBlock:^(id key, id item, BOOL* stop) {
+            [copy setObject:EKRecordImmutableCopy(item) forKey:key];
+        }];
+        return [copy copy];
+    }
+    
+    if( [value isKindOfClass:[NSMutableArray class]] ) {
+        
+        NSMutableArray* copy = [[NSMutableArray alloc] initWithCapacity:[value count]];
+        for( id item in value )
+            [copy addObject:EKRecordImmutableCopy(item)];
+        return [copy copy];
+    }
+    
+    if( [value isKindOfClass:[NSMutableString class]] )
+        return [value copy];
+    
+    return value;
+}
+
+// Snapshots the record without its flags (for when the flags are going to come from a copy of the flag table instead)
+static NSDictionary* EKRecordImmutableCopyWithoutFlags(NSDictionary* record)
+{
+    NSMutableDictionary* recordWithoutFlags = [[NSMutableDictionary alloc] initWithDictionary:record];
+    [recordWithoutFlags removeObjectForKey:EKRecordFlagsKey];
+    return EKRecordImmutableCopy(recordWithoutFlags);
+}
+
+#pragma mark - Journal entries
+
+// Works out what changed between two snapshots of a record. Dictionaries are compared key by key (all the way down), so
+// changing a single flag just gives { nested: { flag data: { set: { flag name: value } } } }, instead of all the flags.
+// Anything else that changed gets stored whole. Returns nil if nothing changed.
+static NSDictionary* EKRecordJournalChanges(NSDictionary* oldDictionary, NSDictionary* newDictionary)
+{
+    NSMutableDictionary* setValues = [[NSMutableDictionary alloc] init];
+    NSMutableDictionary* nestedChanges = [[NSMutableDictionary alloc] init];
+    NSMutableArray* removedKeys = [[NSMutableArray alloc] init];
+    
+    [newDictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL* stop) {
+        
+        id oldValue = [oldDictionary objectForKey:key];
+        if( oldValue == value )
+            return; // Snapshots share anything that wasn't mutable, so this is common (and much quicker than 'isEqual')
+        
+        if( [oldValue isKindOfClass:[NSDictionary class]] && [value isKindOfClass:[NSDictionary class]] ) {
+            NSDictionary* changes = EKRecordJournalChanges(oldValue, value);
+            if( changes != nil )
+                [nestedChanges setObject:changes forKey:key];
+        } else if( [oldValue isEqual:value] == NO ) {
+            [setValues setObject:value forKey:key];
+        }
+    }];
+    
+    [oldDictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL* stop) {
+        if( [newDictionary objectForKey:key] == nil )
+            [removedKeys addObject:key];
+    }];
+    
+    if( setValues.count == 0 && nestedChanges.count == 0 && removedKeys.count == 0 )
+        return nil;
+    
+    NSMutableDictionary* changes = [[NSMutableDictionary alloc] init];
+    if( setValues.count > 0 )
+        [changes setObject:setValues forKey:EKRecordJournalSetKey];
+    if( nestedChanges.count > 0 )
+        [changes setObject:nestedChanges forKey:EKRecordJournalNestedKey];
+    if( removedKeys.count > 0 )
+        [changes setObject:removedKeys forKey:EKRecordJournalRemoveKey];
+    
+    return changes;
+}
+
+// The opposite of 'EKRecordJournalChanges'. Applying the same changes twice gives the same result as applying them once,
+// so replaying a journal on top of a slot file that the journal was already folded into does no harm (which can happen
+// if the app stops right after the slot file gets written, but before the old journal gets deleted).
+static NSMutableDictionary* EKRecordApplyJournalChanges(NSDictionary* dictionary, NSDictionary* changes)
+{
+    NSMutableDictionary* result = [[NSMutableDictionary alloc] initWithDictionary:dictionary];
+    
+    NSArray* removedKeys = [changes objectForKey:EKRecordJournalRemoveKey];
+    if( [removedKeys isKindOfClass:[NSArray class]] )
+        [result removeObjectsForKeys:removedKeys];
+    
+    NSDictionary* setValues = [changes objectForKey:EKRecordJournalSetKey];
+    if( [setValues isKindOfClass:[NSDictionary class]] )
+        [result addEntriesFromDictionary:setValues];
+    
+    NSDictionary* nestedChanges = [changes objectForKey:EKRecordJournalNestedKey];
+    if( [nestedChanges isKindOfClass:[NSDictionary class]] ) {
+        [nestedChanges enumerateKeysAndObjectsUsingBlock:^(id key, id nested, BOOL* stop) {
+            NSDictionary* current = [result objectForKey:key];
+            if( [current isKindOfClass:[NSDictionary class]] == NO )
+                current = nil;
+            if( [nested isKindOfClass:[NSDictionary class]] )
+                [result setObject:EKRecordApplyJournalChanges(current, nested) forKey:key];
+        }];
+    }
+    
+    return result;
+}
+
+// Adds data to the end of a file. If it can't all be written, the file gets cut back to the way it was, so that a
+// half-written entry can't end up in the middle of the journal. Returns the new size of the file (or -1).
+static off_t EKRecordAppendToFile(NSString* path, NSData* data)
+{
+    int file = open([path fileSystemRepresentation], O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if( file < 0 )
+        return -1;
+    
+    struct stat info;
+    off_t newSize = -1;
+    
+    if( fstat(file, &info) == 0 ) {
+        
+        if( write(file, data.bytes, data.length) == (ssize_t)data.length && fsync(file) == 0 )
+            newSize = info.st_size + (off_t)data.length;
+        else
+            ftruncate(file, info.st_size);
+    }
+    
+    close(file);
+    return newSize;
+}
+
+#pragma mark - Binary records
+
+// See EKRecordBinary.h for the format. Records only ever hold what JSON can hold (dictionaries with string keys, arrays,
+// strings, numbers, and NSNull), so binary records can always be turned back into JSON for debugging, and vice versa.
+
+static void EKRecordEncodeString(NSString* string, EKRecordWriter* writer)
+{
+    // The bytes go straight into the writer's buffer, instead of into a temporary C string first
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    EKRecordWriterWriteVarint(writer, length);
+    
+    uint8_t* bytes = EKRecordWriterAppend(writer, length);
+    if( bytes != NULL && length > 0 ) {
+        [string getBytes:bytes maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding
+                 options:0 range:NSMakeRange(0, string.length) remainingRange:NULL];
+    }
+}
+
+static void EKRecordEncodeNumber(NSNumber* number, EKRecordWriter* writer)
+{
+    if( CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID() ) {
+        EKRecordWriterWriteByte(writer, [number boolValue] ? EKRecordBinaryTagTrue : EKRecordBinaryTagFalse);
+        return;
+    }
+    
+    char type = [number objCType][0];
+    if( type == 'f' || type == 'd' ) {
+        EKRecordWriterWriteByte(writer, EKRecordBinaryTagDouble);
+        EKRecordWriterWriteDouble(writer, [number doubleValue]);
+        
+    } else if( type == 'Q' || type == 'L' || type == 'I' || type == 'S' || type == 'C' ) {
+        EKRecordWriterWriteByte(writer, EKRecordBinaryTagInteger);
+        EKRecordWriterWriteVarint(writer, [number unsignedLongLongValue]);
+        
+    } else {
+        long long value = [number longLongValue];
+        if( value >= 0 ) {
+            EKRecordWriterWriteByte(writer, EKRecordBinaryTagInteger);
+            EKRecordWriterWriteVarint(writer, (uint64_t)value);
+        } else {
+            EKRecordWriterWriteByte(writer, EKRecordBinaryTagNegative);
+            EKRecordWriterWriteVarint(writer, (uint64_t)(-(value + 1)));
+        }
+    }
+}
+
+// 'keyNumbers' holds the number of every key that's been written so far. Returns NO if there's something in the record
+// that can't be encoded.
+static BOOL EKRecordEncodeValue(id value, EKRecordWriter* writer, NSMutableDictionary* keyNumbers, int depth)
+{
+    if( depth > EKRecordBinaryMaxDepth ) {
+        NSLog(@"[EKRecord] ERROR: Cannot encode record; containers are nested too deeply.");
+        return NO;
+    }
+    
+    if( value == [NSNull null] ) {
+        EKRecordWriterWriteByte(writer, EKRecordBinaryTagNull);
+        
+    } else if( [value isKindOfClass:[NSString class]] ) {
+        EKRecordWriterWriteByte(writer, EKRecordBinaryTagString);
+        EKRecordEncodeString(value, writer);
+        
+    } else if( [value isKindOfClass:[NSNumber class]] ) {
+        EKRecordEncodeNumber(value, writer);
+        
+    } else if( [value isKindOfClass:[NSArray class]] ) {
+        EKRecordWriterWriteByte(writer, EKRecordBinaryTagArray);
+        EKRecordWriterWriteVarint(writer, [value count]);
+        
+        for( id item in value ) {
+            if( EKRecordEncodeValue(item, writer, keyNumbers, depth + 1) == NO )
+                return NO;
+        }
+        
+    } else if( [value isKindOfClass:[NSDictionary class]] ) {
+        EKRecordWriterWriteByte(writer, EKRecordBinaryTagDictionary);
+        EKRecordWriterWriteVarint(writer, [value count]);
+        
+        __block BOOL succeeded = YES;
+        [value enumerateKeysAndObjectsUsingBlock:^(id key, id item, BOOL* stop) {
+            
+            if( [key isKindOfClass:[NSString class]] == NO ) {
+                NSLog(@"[EKRecord] ERROR: Cannot encode record; dictionary key is not a string: %@", key);
+                succeeded = NO;
+                *stop = YES;
+                return;
+            }
+            
+            NSNumber* keyNumber = [keyNumbers objectForKey:key];
+            if( keyNumber != nil ) {
+                EKRecordWriterWriteVarint(writer, [keyNumber unsignedLongLongValue]);
+            } else {
+                EKRecordWriterWriteVarint(writer, EKRecordBinaryNewKey);
+                EKRecordEncodeString(key, writer);
+                [keyNumbers setObject:@(keyNumbers.count + 1) forKey:key];
+            }
+            
+            if( EKRecordEncodeValue(item, writer, keyNumbers, depth + 1) == NO ) {
+                succeeded = NO;
+                *stop = YES;
+            }
+        }];
+        
+        return succeeded;
+        
+    } else {
+        NSLog(@"[EKRecord] ERROR: Cannot encode record; unsupported type: %@", [value class]);
+        return NO;
+    }
+    
+    return YES;
+}
+
+static NSString* EKRecordDecodeString(EKRecordReader* reader)
+{
+    uint64_t length = EKRecordReaderReadVarint(reader);
+    if( length > EKRecordReaderRemaining(reader) )
+        return nil;
+    
+    const uint8_t* bytes = EKRecordReaderReadBytes(reader, (size_t)length);
+    if( bytes == NULL )
+        return nil;
+    
+    return [[NSString alloc] initWithBytes:bytes length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+}
+
+// 'keys' holds every key that's been read so far, in the order they first appeared. Returns nil if the data is invalid.
+static id EKRecordDecodeValue(EKRecordReader* reader, NSMutableArray* keys, int depth)
+{
+    if( depth > EKRecordBinaryMaxDepth )
+        return nil;
+    
+    uint8_t tag = EKRecordReaderReadByte(reader);
+    if( reader->failed )
+        return nil;
+    
+    switch( tag ) {
+            
+        case EKRecordBinaryTagNull:     return [NSNull null];
+        case EKRecordBinaryTagFalse:    return @NO;
+        case EKRecordBinaryTagTrue:     return @YES;
+            
+        case EKRecordBinaryTagInteger: {
+            uint64_t value = EKRecordReaderReadVarint(reader);
+            if( reader->failed )
+                return nil;
+            if( value > INT64_MAX )
+                return [NSNumber numberWithUnsignedLongLong:value];
+            return [NSNumber numberWithLongLong:(long long)value];
+        }
+            
+        case EKRecordBinaryTagNegative: {
+            uint64_t value = EKRecordReaderReadVarint(reader);
+            if( reader->failed || value > INT64_MAX )
+                return nil;
+            return [NSNumber numberWithLongLong:-(long long)value - 1];
+        }
+            
+        case EKRecordBinaryTagDouble: {
+            double value = EKRecordReaderReadDouble(reader);
+            return reader->failed ? nil : [NSNumber numberWithDouble:value];
+        }
+            
+        case EKRecordBinaryTagString:
+            return EKRecordDecodeString(reader);
+            
+        case EKRecordBinaryTagArray: {
+            
+            // Every value takes at least one byte, so a count that's larger than that can't be right
+            uint64_t count = EKRecordReaderReadVarint(reader);
+            if( reader->failed || count > EKRecordReaderRemaining(reader) )
+                return nil;
+            
+            NSMutableArray* array = [[NSMutableArray alloc] initWithCapacity:(NSUInteger)count];
+            for( uint64_t i = 0; i < count; i++ ) {
+                id item = EKRecordDecodeValue(reader, keys, depth + 1);
+                if( item == nil )
+                    return nil;
+                [array addObject:item];
+            }
+            
+            return array;
+        }
+            
+        case EKRecordBinaryTagDictionary: {
+            
+            // ...and every pair takes at least two
+            uint64_t count = EKRecordReaderReadVarint(reader);
+            if( reader->failed || count > EKRecordReaderRemaining(reader) / 2 )
+                return nil;
+            
+            NSMutableDictionary* dictionary = [[NSMutableDictionary alloc] initWithCapacity:(NSUInteger)count];
+            for( uint64_t i = 0; i < count; i++ ) {
+                
+                NSString* key = nil;
+                uint64_t keyNumber = EKRecordReaderReadVarint(reader);
+                if( reader->failed )
+                    return nil;
+                
+                if( keyNumber == EKRecordBinaryNewKey ) {
+                    key = EKRecordDecodeString(reader);
+                    if( key != nil )
+                        [keys addObject:key];
+                } else if( keyNumber <= keys.count ) {
+                    key = [keys objectAtIndex:(NSUInteger)(keyNumber - 1)];
+                }
+                
+                id item = (key != nil) ? EKRecordDecodeValue(reader, keys, depth + 1) : nil;
+                if( item == nil )
+                    return nil;
+                [dictionary setObject:item forKey:key];
+            }
+            
+            return dictionary;
+        }
+    }
+    
+    return nil; // Unknown tag
+}
+
 @implementation EKRecord
 
 // A (supposedly) thread-safe singleton function
@@ -30,12 +431,16 @@
     if( !dateObject ) // Check for invalid parameters
         return nil;
     
-    // Set up the date formatter
-    NSDateFormatter* format = [[NSDateFormatter alloc] init];
-    [format setDateFormat:@"h:mm a',' yyyy'-'MM'-'dd"]; // Example: "12:34 AM, 2013-02-10"
-    NSString* formattedDate = [format stringFromDate:dateObject];
+    // Setting up a date formatter takes much longer than using one, so the same one gets used every time
+    // (date formatters can be used from any thread)
+    static NSDateFormatter* format = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        format = [[NSDateFormatter alloc] init];
+        [format setDateFormat:EKRecordDateFormat];
+    });
     
-    return formattedDate;
+    return [format stringFromDate:dateObject];
 }
 
 // Set all time/date information in a save slot to the current time.
@@ -92,6 +497,7 @@
 - (void)startNewRecord
 {
     record = [[NSMutableDictionary alloc] initWithDictionary:[self emptyRecord]];
+    flagTable = nil; // Any flags from the old record get thrown out along with it
     [[NSUserDefaults standardUserDefaults] setValue:@(self.currentSlot) forKey:EKRecordCurrentSlotKey];
 }
 
@@ -113,18 +519,23 @@
 #pragma mark - Properties
 
 // There's a function to get the record, but not one to set it. That is, "record" is treated as a read-only variable.
+// Since whoever asks for the record might read (or change) the flags dictionary inside of it, any changes made to the
+// flag table get written back into the record first.
 - (NSMutableDictionary*)record
 {
+    [self releaseFlagTable];
     return record;
 }
 
 // Returns the flags dictionary that's stored in the record... assuming that the record exists, that is!
-// (If the record does exist, then the flags dictionary should also exist inside it too)
+// (If the record does exist, then the flags dictionary should also exist inside it too). Changes that are made to the
+// dictionary will show up in the flag table, since the table gets rebuilt from the dictionary the next time it's used.
 - (NSMutableDictionary*)flags
 {
     if( !record )
         return nil;
     
+    [self releaseFlagTable];
     return [record objectForKey:EKRecordFlagsKey];
 }
 
@@ -139,9 +550,55 @@
     // Flags will only get updated if the dictionary is valid
     if( updatedFlags ) {
         [record setValue:updatedFlags forKey:EKRecordFlagsKey];
+        flagTable = nil; // The old table no longer matches the dictionary
     }
 }
 
+// The flag table holds the same flags as the dictionary stored in the record, except in a form that's much faster to
+// read and modify (see EKFlagTable.h). It gets created from the dictionary the first time it's needed, and from then
+// on, all the flag functions use the table instead of the dictionary.
+- (EKFlagTable*)flagTable
+{
+    if( !record )
+        [self startNewRecord];
+    
+    if( flagTable == nil ) {
+        
+        NSDictionary* storedFlags = [record objectForKey:EKRecordFlagsKey];
+        flagTable = [[EKFlagTable alloc] initWithDictionary:storedFlags];
+    }
+    
+    return flagTable;
+}
+
+// Copies any flags that have changed in the flag table back into the record's flags dictionary. Only the flags with
+// "dirty" bits get copied, so this costs nothing if no flags have changed since the last time it was called.
+- (void)storeFlagTable
+{
+    if( flagTable == nil || [flagTable hasChanges] == NO )
+        return;
+    
+    // The dictionary might be immutable (such as when it was loaded from a saved game), so a mutable copy gets stored instead
+    NSMutableDictionary* storedFlags = [NSMutableDictionary dictionaryWithDictionary:[record objectForKey:EKRecordFlagsKey]];
+    
+    [[flagTable changedFlags] enumerateKeysAndObjectsUsingBlock:^(id name, id value, BOOL* stop) {
+        if( value == [NSNull null] )
+            [storedFlags removeObjectForKey:name];
+        else
+            [storedFlags setObject:value forKey:name];
+    }];
+    
+    [record setValue:storedFlags forKey:EKRecordFlagsKey];
+    [flagTable clearChanges];
+}
+
+// Writes the flag table back into the record and then gets rid of it, for when the dictionary is going to be used directly
+- (void)releaseFlagTable
+{
+    [self storeFlagTable];
+    flagTable = nil;
+}
+
 - (NSMutableDictionary*)spriteAliases
 {
     if( record == nil ) {
@@ -188,76 +645,310 @@
 
 #pragma mark - Slots tracking
 
-// This grabs an NSArray (filled with NSNumbers) from NSUserDefaults. The array keeps track of which "slots" have saved game information stored in them.
-- (NSArray*)arrayOfUsedSlotNumbers
+// Saved games (and the slot index) are kept in a folder inside of Application Support, which gets created the first time
+// it's needed.
+- (NSString*)savedGamesFolder
 {
-    // The array is considered a "global" value (that is, the same value is stored across multiple playthrough/saved-games)
-    // so it would be found under the root dictionary of NSUserDefaults for this app.
-    NSUserDefaults* deviceMemory = [NSUserDefaults standardUserDefaults];
-    NSArray* tempArray = [deviceMemory objectForKey:EKRecordUsedSlotNumbersKey];
+    if( savedGamesFolder != nil )
+        return savedGamesFolder;
     
-    if( tempArray == nil ) {
-        NSLog(@"[EKRecord] Cannot find a previously existing array of used slot numbers.");
+    NSArray* paths = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
+    NSString* folder = [[paths firstObject] stringByAppendingPathComponent:EKRecordSavedGamesFolderName];
+    
+    NSError* error = nil;
+    if( [[NSFileManager defaultManager] createDirectoryAtPath:folder withIntermediateDirectories:YES attributes:nil error:&error] == NO ) {
+        NSLog(@"[EKRecord] ERROR: Could not create saved games folder: %@", error.localizedDescription);
+        return folder; // Saving will fail, but there might still be something to load
     }
     
-    return tempArray;
+    savedGamesFolder = folder;
+    return savedGamesFolder;
 }
 
-// This just checks if a particular slot number has been used (reminder: the "autosave" slot is slot ZERO)
-- (BOOL)slotNumberHasBeenUsed:(NSUInteger)slotNumber
+- (NSString*)pathForSlot:(NSUInteger)slotNumber
 {
-    BOOL result = NO; // Assume NO by default; this gets changed if data proves otherwise
-    
-    // Check if there's any slot number data at all. If there isn't, then obviously none of the slot numbers have been used.
-    NSArray* slotsUsed = [self arrayOfUsedSlotNumbers];
-    if( !slotsUsed || slotsUsed.count < 1 ) {
-        return result;
+    NSString* filename = [NSString stringWithFormat:EKRecordSlotFilenameFormat, (unsigned long)slotNumber];
+    return [[self savedGamesFolder] stringByAppendingPathComponent:filename];
+}
+
+- (NSString*)journalPathForSlot:(NSUInteger)slotNumber
+{
+    NSString* filename = [NSString stringWithFormat:EKRecordJournalFilenameFormat, (unsigned long)slotNumber];
+    return [[self savedGamesFolder] stringByAppendingPathComponent:filename];
+}
+
+- (NSString*)slotIndexPath
+{
+    return [[self savedGamesFolder] stringByAppendingPathComponent:EKRecordSlotIndexFilename];
+}
+
+// The slot index is read the first time it's needed. If it's missing (or damaged), a new one is made from whatever slot
+// files are in the saved games folder, and any slots that an older version left in NSUserDefaults get moved into files.
+//
+// Since saves are written on a background queue, anything that uses the slot index has to synchronize on 'pendingSaves'.
+- (EKSlotIndex*)slotIndex
+{
+    @synchronized( pendingSaves ) {
+        
+        if( slotIndex != NULL )
+            return slotIndex;
+        
+        NSString* indexPath = [self slotIndexPath];
+        slotIndex = EKSlotIndexRead([indexPath fileSystemRepresentation]);
+        
+        // Slot files can be there even when the index isn't (if the app stopped right after a slot was written for the
+        // first time, but before the index was), so the folder gets checked whether the index is damaged or missing
+        if( slotIndex == NULL ) {
+            slotIndex = EKSlotIndexCreate();
+            [self rebuildSlotIndex];
+        }
+        
+        [self moveSlotsOutOfUserDefaults];
+        return slotIndex;
+    }
+}
+
+- (void)writeSlotIndex
+{
+    @synchronized( pendingSaves ) {
+        if( EKSlotIndexWrite(slotIndex, [[self slotIndexPath] fileSystemRepresentation]) == 0 ) {
+            NSLog(@"[EKRecord] ERROR: Could not write the slot index.");
+        }
+    }
+}
+
+// Fills in a slot's summary from its record. If no date is given, the date is read from the record's date string.
+- (EKSlotIndexEntry)indexEntryForSlot:(NSUInteger)slotNumber record:(NSDictionary*)dict dataLength:(NSUInteger)dataLength date:(NSDate*)date
+{
+    EKSlotIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.slot = (uint32_t)slotNumber;
+    entry.dataLength = dataLength;
+    
+    if( [dict isKindOfClass:[NSDictionary class]] == NO )
+        return entry;
+    
+    if( date == nil ) {
+        NSDateFormatter* format = [[NSDateFormatter alloc] init];
+        [format setDateFormat:EKRecordDateFormat];
+        NSString* dateString = [dict objectForKey:EKRecordDateSavedAsString];
+        date = [dateString isKindOfClass:[NSString class]] ? [format dateFromString:dateString] : nil;
     }
+    entry.dateSaved = (date != nil) ? [date timeIntervalSince1970] : 0;
     
-    // The following loop checks every single index in the array and examines if the NSNumber stored within holds the value as the slot number we're checking for.
-    for( NSUInteger i = 0; i < slotsUsed.count; i++ ) {
+    NSNumber* score = [dict objectForKey:EKRecordCurrentScoreKey];
+    if( [score isKindOfClass:[NSNumber class]] )
+        entry.score = [score unsignedLongLongValue];
+    
+    NSDictionary* activity = [dict objectForKey:EKRecordCurrentActivityDictKey];
+    if( [activity isKindOfClass:[NSDictionary class]] ) {
         
-        NSNumber* currentNumber = [slotsUsed objectAtIndex:i];
-        NSUInteger valueOfCurrentNumber = [currentNumber unsignedIntegerValue];
+        NSString* activityType = [activity objectForKey:EKRecordActivityTypeKey];
+        NSString* speaker = [activity objectForKey:EKRecordPreviewSpeakerKey];
+        NSString* preview = [activity objectForKey:EKRecordPreviewTextKey];
         
-        // Check if the value that was found matches the value that was expected
-        if( valueOfCurrentNumber == slotNumber ) {
-            NSLog(@"[EKRecord] Match found for slot number %lu in index %lu", (unsigned long)slotNumber, (unsigned long)i); // Log success
-            result = YES; // This slot number has indeed been used
+        if( [activityType isKindOfClass:[NSString class]] )
+            EKSlotIndexSetString(entry.activity, sizeof(entry.activity), [activityType UTF8String]);
+        if( [speaker isKindOfClass:[NSString class]] )
+            EKSlotIndexSetString(entry.speaker, sizeof(entry.speaker), [speaker UTF8String]);
+        if( [preview isKindOfClass:[NSString class]] )
+            EKSlotIndexSetString(entry.preview, sizeof(entry.preview), [preview UTF8String]);
+    }
+    
+    return entry;
+}
+
+// Writes the slot's file, and then updates (but doesn't write) the slot index. The record is only used for the slot's
+// summary in the index.
+- (BOOL)writeData:(NSData*)data toSlot:(NSUInteger)slotNumber record:(NSDictionary*)dict date:(NSDate*)date
+{
+    NSError* error = nil;
+    if( [data writeToFile:[self pathForSlot:slotNumber] options:NSDataWritingAtomic error:&error] == NO ) {
+        NSLog(@"[EKRecord] ERROR: Could not save data to slot %lu: %@", (unsigned long)slotNumber, error.localizedDescription);
+        return NO;
+    }
+    
+    // The slot's file now holds everything, so any journal that was kept for it is out of date
+    [self discardJournalForSlot:slotNumber];
+    
+    EKSlotIndexEntry entry = [self indexEntryForSlot:slotNumber record:dict dataLength:data.length date:date];
+    return [self setIndexEntry:&entry];
+}
+
+- (BOOL)setIndexEntry:(const EKSlotIndexEntry*)entry
+{
+    @synchronized( pendingSaves ) {
+        if( EKSlotIndexSet([self slotIndex], entry) == 0 ) {
+            NSLog(@"[EKRecord] ERROR: Could not add slot %lu to the slot index.", (unsigned long)entry->slot);
+            return NO;
         }
     }
     
-    return result;
+    return YES;
 }
 
-// This adds a particular value to the list of used slot numbers.
-- (void)addToUsedSlotNumbers:(NSUInteger)slotNumber
+// Older versions kept each slot as an NSData object in NSUserDefaults (which meant that every save, and every launch,
+// had to go through all of them). This moves them into files, and then removes them from NSUserDefaults. Any slot that
+// can't be moved is left where it is, and will be tried again the next time the app runs.
+- (void)moveSlotsOutOfUserDefaults
 {
-    NSLog(@"[EKRecord] Will now attempt to add %lu to array of used slot numbers.", (unsigned long)slotNumber);
-    BOOL numberWasAlreadyUsed = [self slotNumberHasBeenUsed:slotNumber];
- 
-    // If the number has already been used, then there's no point adding another mention of it; that would
-    // up more memory to tell EKRecord something that it already knows. Information will only be added
-    // if the slot number in question hasn't been used yet.
-    if( numberWasAlreadyUsed == NO ) {
+    NSUserDefaults* deviceMemory = [NSUserDefaults standardUserDefaults];
+    NSArray* legacySlots = [deviceMemory objectForKey:EKRecordUsedSlotNumbersKey];
+    if( [legacySlots isKindOfClass:[NSArray class]] == NO )
+        return;
+    
+    NSMutableArray* slotsLeft = [[NSMutableArray alloc] init];
+    
+    for( NSNumber* slotNumber in legacySlots ) {
         
-        NSLog(@"[EKRecord] Slot number %lu has not been used previously.", (unsigned long)slotNumber);
-        NSMutableArray* slotNumbersArray = [[NSMutableArray alloc] init];
+        NSUInteger slot = [slotNumber unsignedIntegerValue];
+        NSString* slotKey = [NSString stringWithFormat:EKRecordLegacySlotKeyFormat, (unsigned long)slot];
+        NSData* slotData = [deviceMemory dataForKey:slotKey];
+        if( slotData == nil )
+            continue;
         
-        // Check if there was any previous data. If there was, then it'll be added to the new array. If not... well, it's not a big deal!
-        NSArray* previousSlotsArray = [self arrayOfUsedSlotNumbers];
-        if( previousSlotsArray )
-            [slotNumbersArray addObjectsFromArray:previousSlotsArray];
+        if( [self writeData:slotData toSlot:slot record:[self recordFromData:slotData] date:nil] ) {
+            [deviceMemory removeObjectForKey:slotKey];
+            EKTraceInfo(EKTraceCategoryRecord, "Moved slot %lu out of NSUserDefaults", (unsigned long)slot);
+        } else {
+            [slotsLeft addObject:slotNumber];
+        }
+    }
+    
+    if( slotsLeft.count > 0 )
+        [deviceMemory setObject:slotsLeft forKey:EKRecordUsedSlotNumbersKey];
+    else
+        [deviceMemory removeObjectForKey:EKRecordUsedSlotNumbersKey];
+    
+    [self writeSlotIndex];
+}
+
+// Makes a new slot index out of the slot files in the saved games folder. This has to load every saved game, so it's
+// only done when the index itself has been lost or damaged. If there aren't any slot files, nothing gets written.
+- (void)rebuildSlotIndex
+{
+    NSArray* filenames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:[self savedGamesFolder] error:nil];
+    NSUInteger slotsFound = 0;
+    
+    for( NSString* filename in filenames ) {
         
-        // Add the slot number that was passed in to the newly-created array
-        [slotNumbersArray addObject:@(slotNumber)];
+        if( [filename hasPrefix:@"slot"] == NO || [[filename pathExtension] isEqualToString:@"sav"] == NO )
+            continue;
         
-        // Create a regular non-mutable NSArray and store the data there
-        NSArray* unmutableArray = [[NSArray alloc] initWithArray:slotNumbersArray];
-        NSUserDefaults* deviceMemory = [NSUserDefaults standardUserDefaults]; // Pointer to NSUserDefaults
-        [deviceMemory setObject:unmutableArray forKey:EKRecordUsedSlotNumbersKey]; // Store the updated array in NSUserDefaults
-        NSLog(@"[EKRecord] Slot number %lu saved to array of used slot numbers.", (unsigned long)slotNumber);
+        // Only files that are named exactly the way 'pathForSlot' names them count
+        NSUInteger slot = (NSUInteger)[[[filename stringByDeletingPathExtension] substringFromIndex:4] longLongValue];
+        if( [filename isEqualToString:[NSString stringWithFormat:EKRecordSlotFilenameFormat, (unsigned long)slot]] == NO )
+            continue;
+        
+        NSData* slotData = [self dataFromSlot:slot];
+        EKSlotIndexEntry entry = [self indexEntryForSlot:slot record:[self recordFromData:slotData] dataLength:slotData.length date:nil];
+        EKSlotIndexSet(slotIndex, &entry);
+        slotsFound++;
     }
+    
+    if( slotsFound == 0 )
+        return;
+    
+    NSLog(@"[EKRecord] WARNING: Slot index could not be read; rebuilt it from %lu slot files in the saved games folder.", (unsigned long)slotsFound);
+    [self writeSlotIndex];
+}
+
+// Returns an array (filled with NSNumbers) of the slots that have saved game information stored in them, or nil if
+// nothing has been saved yet.
+- (NSArray*)arrayOfUsedSlotNumbers
+{
+    NSMutableArray* tempArray = [[NSMutableArray alloc] init];
+    
+    @synchronized( pendingSaves ) {
+        EKSlotIndex* index = [self slotIndex];
+        for( uint32_t i = 0; i < EKSlotIndexCount(index); i++ )
+            [tempArray addObject:@(EKSlotIndexEntryAt(index, i)->slot)];
+    }
+    
+    if( tempArray.count == 0 ) {
+        NSLog(@"[EKRecord] Cannot find a previously existing array of used slot numbers.");
+        return nil;
+    }
+    
+    return [NSArray arrayWithArray:tempArray];
+}
+
+// This just checks if a particular slot number has been used (reminder: the "autosave" slot is slot ZERO)
+- (BOOL)slotNumberHasBeenUsed:(NSUInteger)slotNumber
+{
+    if( slotNumber > UINT32_MAX )
+        return NO;
+    
+    @synchronized( pendingSaves ) {
+        return (EKSlotIndexFind([self slotIndex], (uint32_t)slotNumber) != NULL);
+    }
+}
+
+// This adds a particular value to the list of used slot numbers. Saving to a slot already does this (along with the
+// rest of the slot's summary), so the slot only gets added with an empty summary if it isn't in the index yet.
+- (void)addToUsedSlotNumbers:(NSUInteger)slotNumber
+{
+    if( [self slotNumberHasBeenUsed:slotNumber] == YES || slotNumber > UINT32_MAX )
+        return;
+    
+    EKTraceDebug(EKTraceCategoryRecord, "Slot number %lu has not been used previously.", (unsigned long)slotNumber);
+    EKSlotIndexEntry entry = [self indexEntryForSlot:slotNumber record:nil dataLength:0 date:nil];
+    
+    if( [self setIndexEntry:&entry] ) {
+        [self writeSlotIndex];
+        EKTraceDebug(EKTraceCategoryRecord, "Slot number %lu saved to array of used slot numbers.", (unsigned long)slotNumber);
+    }
+}
+
+- (NSDictionary*)summaryFromIndexEntry:(const EKSlotIndexEntry*)entry
+{
+    NSDate* dateSaved = [NSDate dateWithTimeIntervalSince1970:entry->dateSaved];
+    NSMutableDictionary* summary = [[NSMutableDictionary alloc] init];
+    
+    [summary setObject:@(entry->slot) forKey:EKRecordSlotNumberKey];
+    [summary setObject:@(entry->score) forKey:EKRecordCurrentScoreKey];
+    [summary setObject:@(entry->dataLength) forKey:EKRecordSlotDataLengthKey];
+    if( entry->dateSaved > 0 ) {
+        [summary setObject:dateSaved forKey:EKRecordDateSavedKey];
+        [summary setObject:[self stringFromDate:dateSaved] forKey:EKRecordDateSavedAsString];
+    }
+    
+    // Strings that somehow aren't valid UTF-8 just get left out
+    NSString* activityType = [NSString stringWithUTF8String:entry->activity];
+    NSString* speaker = [NSString stringWithUTF8String:entry->speaker];
+    NSString* preview = [NSString stringWithUTF8String:entry->preview];
+    if( activityType.length > 0 )
+        [summary setObject:activityType forKey:EKRecordActivityTypeKey];
+    if( speaker.length > 0 )
+        [summary setObject:speaker forKey:EKRecordPreviewSpeakerKey];
+    if( preview.length > 0 )
+        [summary setObject:preview forKey:EKRecordPreviewTextKey];
+    
+    return [NSDictionary dictionaryWithDictionary:summary];
+}
+
+- (NSDictionary*)summaryOfSlot:(NSUInteger)slotNumber
+{
+    if( slotNumber > UINT32_MAX )
+        return nil;
+    
+    @synchronized( pendingSaves ) {
+        const EKSlotIndexEntry* entry = EKSlotIndexFind([self slotIndex], (uint32_t)slotNumber);
+        return (entry != NULL) ? [self summaryFromIndexEntry:entry] : nil;
+    }
+}
+
+- (NSArray*)summariesOfUsedSlots
+{
+    NSMutableArray* summaries = [[NSMutableArray alloc] init];
+    
+    @synchronized( pendingSaves ) {
+        EKSlotIndex* index = [self slotIndex];
+        for( uint32_t i = 0; i < EKSlotIndexCount(index); i++ )
+            [summaries addObject:[self summaryFromIndexEntry:EKSlotIndexEntryAt(index, i)]];
+    }
+    
+    return [NSArray arrayWithArray:summaries];
 }
 
 #pragma mark - Score properties
@@ -290,6 +981,22 @@
     return result;
 }
 
+// Like the high score, the read history is stored directly in NSUserDefaults, since it isn't part of any one playthrough
+- (void)setReadHistoryData:(NSData*)historyData
+{
+    if( historyData ) {
+        [[NSUserDefaults standardUserDefaults] setObject:historyData forKey:EKRecordReadHistoryKey];
+    } else {
+        [[NSUserDefaults standardUserDefaults] removeObjectForKey:EKRecordReadHistoryKey];
+    }
+}
+
+- (NSData*)readHistoryData
+{
+    // This will be nil if nothing has been read yet (or if the game doesn't keep track of what's been read)
+    return [[NSUserDefaults standardUserDefaults] dataForKey:EKRecordReadHistoryKey];
+}
+
 // Sets the current score. Unlike the High Score, the Current Score IS stored in the record/slot section.
 - (void)setCurrentScore:(NSUInteger)scoreValue
 {
@@ -321,25 +1028,48 @@
 
 #pragma mark - Loading data
 
-// Load NSData from a "slot" stored in NSUserDefaults / device memory.
+// Load NSData from a "slot" file in the saved games folder. If the slot has a journal, the journal gets replayed, and
+// the data that comes back is the whole record encoded again (see 'savesAsJSON').
 - (NSData*)dataFromSlot:(NSUInteger)slotNumber
 {
-    NSUserDefaults* deviceMemory = [NSUserDefaults standardUserDefaults];   // Pointer to where memory is stored in the device
-    NSString* slotKey = [NSString stringWithFormat:@"slot%lu", (unsigned long)slotNumber];  // Generate name of the dictionary key where save data is stored
+    [self waitForPendingSaveToSlot:slotNumber];
+    
+    if( [[NSFileManager defaultManager] fileExistsAtPath:[self journalPathForSlot:slotNumber]] == NO )
+        return [self baseDataFromSlot:slotNumber];
     
-    NSLog(@"[EKRecord] Loading record from slot named [%@]", slotKey);
+    NSDictionary* loadedRecord = [self recordFromSlot:slotNumber];
+    if( loadedRecord == nil )
+        return nil;
+    
+    return self.savesAsJSON ? [self JSONDataFromRecord:loadedRecord] : [self binaryDataFromRecord:loadedRecord];
+}
+
+// Just the slot's file, without its journal
+- (NSData*)baseDataFromSlot:(NSUInteger)slotNumber
+{
+    // If this slot still has a save waiting to be written, that save is what should get loaded
+    [self waitForPendingSaveToSlot:slotNumber];
+    
+    NSString* slotPath = [self pathForSlot:slotNumber];
+    EKTraceDebug(EKTraceCategoryRecord, "Loading record from slot file [%s]", [slotPath UTF8String]);
+    
+    // Try to load the data from the slot's file. If it isn't there, it might be a slot that couldn't be moved out of
+    // NSUserDefaults (see 'moveSlotsOutOfUserDefaults').
+    NSData* slotData = [NSData dataWithContentsOfFile:slotPath options:NSDataReadingMappedIfSafe error:nil];
+    if( slotData == nil ) {
+        NSString* slotKey = [NSString stringWithFormat:EKRecordLegacySlotKeyFormat, (unsigned long)slotNumber];
+        slotData = [[NSUserDefaults standardUserDefaults] dataForKey:slotKey];
+    }
     
-    // Try to load the data from the slot that should be stored in the device's memory.
-    NSData* slotData = [deviceMemory objectForKey:slotKey];
     if( slotData == nil ) {
         NSLog(@"[EKRecord] ERROR: No data found in slot number %lu", (unsigned long)slotNumber );
         return nil;
     }
     
     // Note how large the data is
-    NSLog(@"[EKRecord] 'dataFromSlot' has loaded an NSData object of size %lu bytes.", (unsigned long)slotData.length);
+    EKTraceDebug(EKTraceCategoryRecord, "'dataFromSlot' has loaded an NSData object of size %lu bytes.", (unsigned long)slotData.length);
     
-    return [NSData dataWithData:slotData];
+    return slotData;
 }
 
 // Load a dictionary with game record from an NSData object (which was loaded from memory)
@@ -350,6 +1080,10 @@
         return nil;
     }
     
+    // Binary records start with a header; anything else is treated as JSON
+    if( EKRecordBinaryIsRecord(data.bytes, data.length) )
+        return [self recordFromBinaryData:data];
+    
     NSError* error = nil;
     
     /*
@@ -373,21 +1107,113 @@
     {
         NSLog(@"[EKRecord] Failed to unarchive dictionary: %@", error.localizedDescription);
     } else {
-        NSLog(@"Successfully unarchived dictionary: %@", unarchivedDictionary);
+        EKTraceDebug(EKTraceCategoryRecord, "Successfully unarchived dictionary.");
     }
     
     //return [NSDictionary dictionaryWithDictionary:dictFromData];
     //NSDictionary* dictionaryToReturn = [NSDictionary dictionaryWithDictionary:dictFromData];
-    NSLog(@"RAW DICTIONARY OUTPUT: %@", unarchivedDictionary);
+    EKTraceVerbose(EKTraceCategoryRecord, "RAW DICTIONARY OUTPUT: %s", [[unarchivedDictionary description] UTF8String]);
     
     return unarchivedDictionary;
 }
 
-// Load saved game data from a slot
+// Decodes a binary record (see 'binaryDataFromRecord'). Unlike JSON, the dictionaries and arrays that come back are mutable.
+- (NSDictionary*)recordFromBinaryData:(NSData*)data
+{
+    EKRecordReader reader;
+    if( EKRecordReaderInit(&reader, data.bytes, data.length) == 0 ) {
+        NSLog(@"[EKRecord] ERROR: Could not load record; binary data is invalid.");
+        return nil;
+    }
+    
+    NSMutableArray* keys = [[NSMutableArray alloc] init];
+    id decodedRecord = EKRecordDecodeValue(&reader, keys, 0);
+    
+    // Anything left over after the record means the data wasn't what it claimed to be
+    if( [decodedRecord isKindOfClass:[NSDictionary class]] == NO || EKRecordReaderRemaining(&reader) != 0 ) {
+        NSLog(@"[EKRecord] ERROR: Could not load record; binary data is corrupt.");
+        return nil;
+    }
+    
+    EKTraceDebug(EKTraceCategoryRecord, "Successfully decoded binary record (%lu keys).", (unsigned long)keys.count);
+    return decodedRecord;
+}
+
+// Load saved game data from a slot (and replay its journal, if it has one)
 - (NSDictionary*)recordFromSlot:(NSUInteger)slotNumber
 {
-    NSData* loadedData = [self dataFromSlot:slotNumber];
-    return [self recordFromData:loadedData];
+    NSData* loadedData = [self baseDataFromSlot:slotNumber];
+    NSDictionary* loadedRecord = [self recordFromData:loadedData];
+    if( loadedRecord == nil )
+        return nil;
+    
+    // The journal is read into memory (instead of being mapped), since its end might get cut off while it's still around
+    NSData* journal = [NSData dataWithContentsOfFile:[self journalPathForSlot:slotNumber] options:0 error:nil];
+    if( journal.length > 0 )
+        loadedRecord = [self record:loadedRecord byReplayingJournal:journal fromSlot:slotNumber];
+    
+    // In journal mode, the next save to this slot only needs to write down how it's different from what was loaded.
+    // (If the slot already has a base, or a save is on its way, the save queue knows better what's in the slot's files.)
+    if( self.usesJournal ) {
+        @synchronized( pendingSaves ) {
+            if( [journalBases objectForKey:@(slotNumber)] == nil && [self slotHasPendingSave:slotNumber] == NO )
+                [journalBases setObject:EKRecordImmutableCopy(loadedRecord) forKey:@(slotNumber)];
+        }
+    }
+    
+    return loadedRecord;
+}
+
+// Each journal entry is a binary record of changes, and they're stored one after another. If the app stopped while an
+// entry was being written, the journal ends with a partial entry; that entry gets ignored, and cut off the end of the
+// file so that new entries don't end up after it (see 'cutJournalForSlot').
+- (NSDictionary*)record:(NSDictionary*)loadedRecord byReplayingJournal:(NSData*)journal fromSlot:(NSUInteger)slotNumber
+{
+    const uint8_t* bytes = journal.bytes;
+    NSUInteger offset = 0;
+    NSUInteger entryCount = 0;
+    
+    while( offset < journal.length ) {
+        
+        size_t entryLength = EKRecordBinaryLength(bytes + offset, journal.length - offset);
+        if( entryLength == 0 )
+            break;
+        
+        NSDictionary* changes = [self recordFromBinaryData:[journal subdataWithRange:NSMakeRange(offset, entryLength)]];
+        if( changes == nil )
+            break;
+        
+        loadedRecord = EKRecordApplyJournalChanges(loadedRecord, changes);
+        offset += entryLength;
+        entryCount++;
+    }
+    
+    if( offset < journal.length ) {
+        NSLog(@"[EKRecord] WARNING: Journal for slot %lu ends with an incomplete entry; %lu bytes were ignored.",
+              (unsigned long)slotNumber, (unsigned long)(journal.length - offset));
+        [self cutJournalForSlot:slotNumber toLength:offset ifLengthIs:journal.length];
+    }
+    
+    EKTraceDebug(EKTraceCategoryRecord, "Replayed %lu journal entries for slot %lu", (unsigned long)entryCount, (unsigned long)slotNumber);
+    return loadedRecord;
+}
+
+// The journal only gets cut on the save queue, so that it never happens while a save is adding to the same journal. If
+// the journal has changed since it was read, then the "partial" entry was really a save that hadn't finished yet, and
+// the journal is left alone.
+- (void)cutJournalForSlot:(NSUInteger)slotNumber toLength:(NSUInteger)length ifLengthIs:(NSUInteger)lengthWhenRead
+{
+    NSString* journalPath = [self journalPathForSlot:slotNumber];
+    
+    dispatch_async(saveQueue, ^{
+        unsigned long long currentLength = [[[NSFileManager defaultManager] attributesOfItemAtPath:journalPath error:nil] fileSize];
+        if( currentLength != lengthWhenRead ) {
+            NSLog(@"[EKRecord] WARNING: Journal for slot %lu changed after it was read; it won't be cut.", (unsigned long)slotNumber);
+            return;
+        }
+        
+        truncate([journalPath fileSystemRepresentation], (off_t)length);
+    });
 }
 
 // This attempts to load a record from the "current slot," which is slotXX (where XX is whatever the heck 'self.currentSlot' is).
@@ -400,7 +1226,8 @@
     
         // Copy record data from device memory
         record = [[NSMutableDictionary alloc] initWithDictionary:tempDict];
-        NSLog(@"[EKRecord] Record was successfully loaded from slot %lu", (unsigned long)self.currentSlot);
+        flagTable = nil;
+        EKTraceInfo(EKTraceCategoryRecord, "Record was successfully loaded from slot %lu", (unsigned long)self.currentSlot);
         
     } else { // No valid data in dictionary
         
@@ -424,25 +1251,13 @@
     }
     
     if( shouldOverride == YES ) {
-        NSLog(@"[EKRecord] DIAGNOSTIC: Will forcibly overwrite existing flags with flags from file: %@", filename);
+        EKTraceDebug(EKTraceCategoryRecord, "Will forcibly overwrite existing flags with flags from file: %s", [filename UTF8String]);
     } else {
-        NSLog(@"[EKRecord] DIAGNOSTIC: Will add flags (without overwriting) from file named: %@", filename);
+        EKTraceDebug(EKTraceCategoryRecord, "Will add flags (without overwriting) from file named: %s", [filename UTF8String]);
     }
     
-    for( NSString* key in rootDictionary.allKeys ) {
-        id value = [rootDictionary objectForKey:key];
-        
-        if( shouldOverride == YES ) {
-            // just write the value in no matter what
-            [self setFlagValue:value forFlagNamed:key];
-        } else {
-            id existingFlag = [self flagNamed:key];
-            // in "no overwrite" mode, only set the value if no existing flag is found
-            if( existingFlag == nil ) {
-                [self setFlagValue:value forFlagNamed:key];
-            }
-        }
-    }
+    // In "no overwrite" mode, values only get set for flags that don't already exist
+    [[self flagTable] addEntriesFromDictionary:rootDictionary overwriteExistingFlags:shouldOverride];
 }
 
 #pragma mark - Saving data
@@ -459,6 +1274,44 @@
     // Update the date/time information in the record to "right now."
     [self updateDateInDictionary:dict];
     
+    if( self.savesAsJSON )
+        return [self JSONDataFromRecord:dict];
+    
+    return [self binaryDataFromRecord:dict];
+}
+
+// The compact binary format (see EKRecordBinary.h)
+- (NSData*)binaryDataFromRecord:(NSDictionary*)dict
+{
+    if( dict == nil ) {
+        NSLog(@"[EKRecord] ERROR: Cannot create data from record; invalid information passed in!");
+        return nil;
+    }
+    
+    EKRecordWriter writer;
+    EKRecordWriterInit(&writer, 4096);
+    NSMutableDictionary* keyNumbers = [[NSMutableDictionary alloc] init];
+    
+    if( EKRecordEncodeValue(dict, &writer, keyNumbers, 0) == NO || EKRecordWriterFinish(&writer) == 0 ) {
+        NSLog(@"[EKRecord] Failed to encode record as binary data.");
+        EKRecordWriterFree(&writer);
+        return nil;
+    }
+    
+    // The data takes over the writer's buffer, instead of copying it
+    NSData* data = [[NSData alloc] initWithBytesNoCopy:writer.bytes length:writer.length freeWhenDone:YES];
+    EKTraceDebug(EKTraceCategoryRecord, "Successfully encoded record as %lu bytes of binary data", (unsigned long)data.length);
+    return data;
+}
+
+// Pretty-printed JSON, which is larger and slower than binary, but easy to read
+- (NSData*)JSONDataFromRecord:(NSDictionary*)dict
+{
+    if( dict == nil ) {
+        NSLog(@"[EKRecord] ERROR: Cannot create data from record; invalid information passed in!");
+        return nil;
+    }
+    
     /*
     NSKeyedArchiver* archiver = [[NSKeyedArchiver alloc] initRequiringSecureCoding:false];//
     [archiver encodeObject:dict forKey:EKRecordDataKey];
@@ -480,13 +1333,15 @@
     if (error) {
         NSLog(@"[EKRecord] Failed to archive dictionary: %@", error.localizedDescription);
     } else {
-        NSLog(@"[EKRecord] Successfully archived dictionary to NSData");
+        EKTraceDebug(EKTraceCategoryRecord, "Successfully archived dictionary to NSData");
     }
     
     return data;
 }
 
-// Saves NSData object to a particular "slot" (which is located in NSUserDefaults's root dictionary)
+// Saves NSData object to a particular "slot" (which is a file named "slotXX.sav", XX being whatever value 'slotNumber' is).
+// The slot's summary in the index comes from decoding the data; 'saveCurrentRecord' skips that step, since it already
+// has the record that the data came from.
 - (void)saveData:(NSData*)data toSlot:(NSUInteger)slotNumber
 {
     if( !data ) {
@@ -494,11 +1349,11 @@
         return;
     }
     
-    // Store the NSData object into NSUserDefaults, under the key "slotXX" (XX being whatever value 'slotNumber' is)
-    NSUserDefaults* deviceMemory = [NSUserDefaults standardUserDefaults];
-    NSString* stringWithSlotNumber = [NSString stringWithFormat:@"slot%lu", (unsigned long)slotNumber]; // Dictionary key for slot
-    [deviceMemory setValue:data forKey:stringWithSlotNumber]; // Store data in NSUserDefaults dictionary
-    [self addToUsedSlotNumbers:slotNumber]; // Flag this slot number as being used
+    // Otherwise a save that's still waiting to be written would end up replacing this data
+    [self waitForPendingSaveToSlot:slotNumber];
+    
+    if( [self writeData:data toSlot:slotNumber record:[self recordFromData:data] date:[NSDate date]] )
+        [self writeSlotIndex];
 }
 
 // This just checks if the current score is higher than the "high score" saved in NSUserDefaults. If that's the case, then
@@ -519,42 +1374,270 @@
     }
 }
 
-// If EKRecord is storing any data, then it will get stored to device memory (NSUserDefaults). The slot number being used
-// would be whatever 'currentSlot' has as its value.
+// If EKRecord is storing any data, then it will get saved to the slot whose number is whatever 'currentSlot' has as its value.
 - (void)saveCurrentRecord
+{
+    [self saveCurrentRecordWithCompletion:nil];
+}
+
+// Only the quick part of saving happens right away: the record is brought up to date, and then a snapshot of it is
+// taken (see 'EKRecordImmutableCopy') and put in the slot index. Encoding the snapshot and writing it out happens
+// later, on the save queue.
+- (void)saveCurrentRecordWithCompletion:(void (^)(BOOL succeeded))completion
 {
     if( !record ) {
         NSLog(@"[EKRecord] ERROR: No record data exists.");
+        if( completion )
+            completion(NO);
         return;
     }
     
     // Update global data
+    NSDate* dateSaved = [NSDate date];
     NSUserDefaults* deviceMemory = [NSUserDefaults standardUserDefaults];
-    [deviceMemory setValue:[NSDate date] forKey:EKRecordDateSavedKey]; // Store current date as the "most recent save" date
+    [deviceMemory setValue:dateSaved forKey:EKRecordDateSavedKey]; // Store current date as the "most recent save" date
     [deviceMemory setValue:[NSNumber numberWithUnsignedInteger:self.currentSlot] forKey:EKRecordCurrentSlotKey]; // Current slot
     
     // Update record information
     [self updateDateInDictionary:record];
     [self updateHighScore]; // Update high score also
     
-    NSData* recordAsData = [self dataFromRecord:record];
-    [self saveData:recordAsData toSlot:self.currentSlot];
+    // The flags are usually most of the record, so instead of being written back into the record's dictionary and then
+    // copied, they're snapshotted by copying the flag table (which doesn't copy any flags; see EKFlagTable), and turned
+    // into a dictionary on the save queue
+    EKFlagTable* flagSnapshot = [flagTable copy];
+    NSDictionary* snapshot = (flagSnapshot != nil) ? EKRecordImmutableCopyWithoutFlags(record) : EKRecordImmutableCopy(record);
+    NSUInteger slotNumber = self.currentSlot;
+    NSNumber* slotKey = @(slotNumber);
+    BOOL needsWriting = NO;
+    
+    @synchronized( pendingSaves ) {
+        
+        // The slot's summary changes right away, so that anything that lists the slots sees this save (the size of the
+        // data gets filled in once it's known)
+        const EKSlotIndexEntry* oldEntry = EKSlotIndexFind([self slotIndex], (uint32_t)slotNumber);
+        EKSlotIndexEntry entry = [self indexEntryForSlot:slotNumber record:snapshot dataLength:(oldEntry ? oldEntry->dataLength : 0) date:dateSaved];
+        [self setIndexEntry:&entry];
+        
+        // If there's already a save waiting for this slot, this one just takes its place (along with its completion blocks)
+        NSDictionary* previousSave = [pendingSaves objectForKey:slotKey];
+        NSMutableArray* completions = [[NSMutableArray alloc] initWithArray:[previousSave objectForKey:EKRecordPendingCompletionsKey]];
+        if( completion )
+            [completions addObject:[completion copy]];
+        
+        needsWriting = (previousSave == nil);
+        NSMutableDictionary* pendingSave = [@{EKRecordPendingRecordKey:         snapshot,
+                                              EKRecordPendingAsJSONKey:         @(self.savesAsJSON),
+                                              EKRecordPendingJournalKey:        @(self.usesJournal),
+                                              EKRecordPendingCompletionsKey:    completions} mutableCopy];
+        if( flagSnapshot != nil )
+            [pendingSave setObject:flagSnapshot forKey:EKRecordPendingFlagsKey];
+        
+        [pendingSaves setObject:pendingSave forKey:slotKey];
+    }
+    
+    if( needsWriting ) {
+        dispatch_async(saveQueue, ^{
+            [self writePendingSaveToSlot:slotNumber];
+        });
+    }
+    
+    EKTraceDebug(EKTraceCategorySave, "saveCurrentRecord - Record for slot %lu is waiting to be written.", (unsigned long)slotNumber);
+}
+
+// This runs on the save queue. Whatever save is waiting for the slot when this starts is the one that gets written;
+// if the game gets saved again while this is still running, that save gets written the next time around. Until the
+// write is finished, the slot counts as busy (see 'waitForPendingSaveToSlot').
+- (void)writePendingSaveToSlot:(NSUInteger)slotNumber
+{
+    NSDictionary* pendingSave = nil;
+    @synchronized( pendingSaves ) {
+        pendingSave = [pendingSaves objectForKey:@(slotNumber)];
+        [pendingSaves removeObjectForKey:@(slotNumber)];
+        if( pendingSave != nil )
+            [writingSlots addObject:@(slotNumber)];
+    }
+    
+    if( pendingSave == nil )
+        return;
+    
+    NSDictionary* snapshot = [pendingSave objectForKey:EKRecordPendingRecordKey];
+    BOOL asJSON = [[pendingSave objectForKey:EKRecordPendingAsJSONKey] boolValue];
+    BOOL succeeded = NO;
+    
+    @autoreleasepool {
+        // Put the flags back into the snapshot (see 'saveCurrentRecordWithCompletion:')
+        EKFlagTable* flagSnapshot = [pendingSave objectForKey:EKRecordPendingFlagsKey];
+        if( flagSnapshot != nil ) {
+            NSMutableDictionary* snapshotWithFlags = [snapshot mutableCopy];
+            [snapshotWithFlags setObject:EKRecordImmutableCopy([flagSnapshot dictionaryRepresentation]) forKey:EKRecordFlagsKey];
+            snapshot = [snapshotWithFlags copy];
+        }
+        
+        if( [[pendingSave objectForKey:EKRecordPendingJournalKey] boolValue] )
+            succeeded = [self writeJournalEntryForSnapshot:snapshot toSlot:slotNumber asJSON:asJSON];
+        else
+            succeeded = [self writeSnapshot:snapshot toSlot:slotNumber asJSON:asJSON keepAsJournalBase:NO];
+    }
+    
+    @synchronized( pendingSaves ) {
+        [writingSlots removeObject:@(slotNumber)];
+    }
+    
+    NSArray* completions = [pendingSave objectForKey:EKRecordPendingCompletionsKey];
+    if( completions.count > 0 ) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            for( void (^completion)(BOOL) in completions )
+                completion(succeeded);
+        });
+    }
+}
+
+// Writes the whole snapshot to the slot's file, and gets rid of the slot's journal (since the file now has everything
+// that was in it). Runs on the save queue.
+- (BOOL)writeSnapshot:(NSDictionary*)snapshot toSlot:(NSUInteger)slotNumber asJSON:(BOOL)asJSON keepAsJournalBase:(BOOL)keepAsBase
+{
+    NSData* recordAsData = asJSON ? [self JSONDataFromRecord:snapshot] : [self binaryDataFromRecord:snapshot];
+    NSError* error = nil;
+    
+    if( recordAsData == nil ) {
+        NSLog(@"[EKRecord] ERROR: Cannot save data to slot; data was invalid.");
+        return NO;
+    }
+    if( [recordAsData writeToFile:[self pathForSlot:slotNumber] options:NSDataWritingAtomic error:&error] == NO ) {
+        NSLog(@"[EKRecord] ERROR: Could not save data to slot %lu: %@", (unsigned long)slotNumber, error.localizedDescription);
+        return NO;
+    }
+    
+    [self discardJournalForSlot:slotNumber];
+    if( keepAsBase ) {
+        @synchronized( pendingSaves ) {
+            [journalBases setObject:snapshot forKey:@(slotNumber)];
+        }
+    }
+    
+    [self updateIndexDataLength:recordAsData.length forSlot:slotNumber];
+    EKTraceDebug(EKTraceCategorySave, "Slot %lu written (%lu bytes).", (unsigned long)slotNumber, (unsigned long)recordAsData.length);
+    return YES;
+}
+
+// Journal mode: only the changes since the last save get written, by adding them to the end of the slot's journal. If
+// there's nothing to compare against yet (the slot wasn't loaded or saved in journal mode since the app started), the
+// whole snapshot gets written instead, and the same happens once the journal has grown past the compaction size.
+// Runs on the save queue.
+- (BOOL)writeJournalEntryForSnapshot:(NSDictionary*)snapshot toSlot:(NSUInteger)slotNumber asJSON:(BOOL)asJSON
+{
+    NSDictionary* base = nil;
+    @synchronized( pendingSaves ) {
+        base = [journalBases objectForKey:@(slotNumber)];
+    }
+    
+    if( base == nil )
+        return [self writeSnapshot:snapshot toSlot:slotNumber asJSON:asJSON keepAsJournalBase:YES];
+    
+    NSDictionary* changes = EKRecordJournalChanges(base, snapshot);
+    if( changes == nil )
+        return YES; // Nothing's changed since the last save
+    
+    // Journal entries are always binary, whatever 'savesAsJSON' is set to
+    NSData* entry = [self binaryDataFromRecord:changes];
+    off_t journalLength = (entry != nil) ? EKRecordAppendToFile([self journalPathForSlot:slotNumber], entry) : -1;
+    if( journalLength < 0 ) {
+        NSLog(@"[EKRecord] ERROR: Could not add to the journal for slot %lu; writing the whole record instead.", (unsigned long)slotNumber);
+        return [self writeSnapshot:snapshot toSlot:slotNumber asJSON:asJSON keepAsJournalBase:YES];
+    }
+    
+    @synchronized( pendingSaves ) {
+        [journalBases setObject:snapshot forKey:@(slotNumber)];
+    }
+    
+    if( journalLength > EKRecordJournalCompactionSize ) {
+        EKTraceInfo(EKTraceCategorySave, "Journal for slot %lu is %lld bytes; compacting", (unsigned long)slotNumber, (long long)journalLength);
+        return [self writeSnapshot:snapshot toSlot:slotNumber asJSON:asJSON keepAsJournalBase:YES];
+    }
+    
+    unsigned long long baseLength = [[[NSFileManager defaultManager] attributesOfItemAtPath:[self pathForSlot:slotNumber] error:nil] fileSize];
+    [self updateIndexDataLength:baseLength + (unsigned long long)journalLength forSlot:slotNumber];
+    EKTraceDebug(EKTraceCategorySave, "Slot %lu journal entry written (%lu bytes).", (unsigned long)slotNumber, (unsigned long)entry.length);
+    return YES;
+}
+
+- (void)discardJournalForSlot:(NSUInteger)slotNumber
+{
+    @synchronized( pendingSaves ) {
+        [journalBases removeObjectForKey:@(slotNumber)];
+    }
     
-    NSLog(@"[EKRecord] saveCurrentRecord - Record has been saved.");
+    unlink([[self journalPathForSlot:slotNumber] fileSystemRepresentation]); // It's fine if there wasn't one
+}
+
+- (void)updateIndexDataLength:(uint64_t)dataLength forSlot:(NSUInteger)slotNumber
+{
+    @synchronized( pendingSaves ) {
+        const EKSlotIndexEntry* oldEntry = EKSlotIndexFind([self slotIndex], (uint32_t)slotNumber);
+        if( oldEntry != NULL ) {
+            EKSlotIndexEntry entry = *oldEntry;
+            entry.dataLength = dataLength;
+            [self setIndexEntry:&entry];
+        }
+        [self writeSlotIndex];
+    }
+}
+
+// Waits until every save that's been made so far has been written. Each pending save already has its own block on the
+// save queue, so once an empty block that comes after all of them has run, they're all done.
+- (void)flushSaves
+{
+    dispatch_sync(saveQueue, ^{});
+}
+
+// Returns YES if a save to the slot is waiting to be written, or is being written right now
+- (BOOL)slotHasPendingSave:(NSUInteger)slotNumber
+{
+    @synchronized( pendingSaves ) {
+        return ([pendingSaves objectForKey:@(slotNumber)] != nil || [writingSlots containsObject:@(slotNumber)]);
+    }
+}
+
+// Anything that reads or writes a slot's files directly has to call this first, so that it doesn't run at the same
+// time as the save queue is writing to that slot
+- (void)waitForPendingSaveToSlot:(NSUInteger)slotNumber
+{
+    if( [self slotHasPendingSave:slotNumber] )
+        [self flushSaves];
+}
+
+- (void)flushSavesWithCompletion:(void (^)(void))completion
+{
+    dispatch_async(saveQueue, ^{
+        if( completion )
+            dispatch_async(dispatch_get_main_queue(), completion);
+    });
 }
 
 #pragma mark - Initialization Code
 
 /*- (void)dealloc
 {
-    NSLog(@"Record object deallocated; saving data to memory.");
+    EKTraceDebug(EKTraceCategoryRecord, "Record object deallocated; saving data to memory.");
     [self saveToDevice];
 }*/
 
+- (void)dealloc
+{
+    EKSlotIndexFree(slotIndex);
+}
+
 - (id)init
 {
     if( (self = [super init]) ) {
         
+        // This has to exist before anything touches the slot index
+        saveQueue = dispatch_queue_create("EKRecord save", DISPATCH_QUEUE_SERIAL);
+        pendingSaves = [[NSMutableDictionary alloc] init];
+        journalBases = [[NSMutableDictionary alloc] init];
+        writingSlots = [[NSMutableSet alloc] init];
+        
         // Set default values
         self.highScore = 0;
         self.currentSlot = EKRecordAutosaveSlotNumber; // This would be ZERO
@@ -568,7 +1651,7 @@
         // If a slot number was found, then just get that value and overwrite the default slot number
         if( lastSavedSlot ) {
             self.currentSlot = [lastSavedSlot unsignedIntegerValue];
-            NSLog(@"[EKRecord] Current slot set to %lu, which was the value stored in memory.", (unsigned long)self.currentSlot);
+            EKTraceDebug(EKTraceCategoryRecord, "Current slot set to %lu, which was the value stored in memory.", (unsigned long)self.currentSlot);
         }
         
         // If there's any previously-saved data, then just load that information. If there is NO previously-saved data, then just do nothing.
@@ -581,7 +1664,7 @@
             // Display all used slots (this is actually meant for diagnostic/testing purposes)
             NSArray* allUsedSlots = [self arrayOfUsedSlotNumbers];
             if( allUsedSlots ) {
-                NSLog(@"[EKRecord] The following slots are in use: %@", allUsedSlots);
+                EKTraceDebug(EKTraceCategoryRecord, "The following slots are in use: %s", [[allUsedSlots description] UTF8String]);
             }
             
             // Load the data from the current slot (which is the one with the most recent save data)
@@ -589,7 +1672,7 @@
             
             // Log success or failure
             if( record )
-                NSLog(@"[EKRecord] Record initialized with data: %@", record);
+                EKTraceVerbose(EKTraceCategoryRecord, "Record initialized with data: %s", [[record description] UTF8String]);
             else
                 NSLog(@"[EKRecord] Failed to initialize saved game data.");
         }
@@ -666,7 +1749,26 @@
     if( !record )
         [self startNewRecord];
     
-    [[self flags] addEntriesFromDictionary:existingFlags];
+    [[self flagTable] addEntriesFromDictionary:existingFlags];
+}
+
+// Same as above, except that the flags come from another flag table (like the one used by VNScene)
+- (void)addFlagsFromTable:(EKFlagTable*)existingFlags
+{
+    if( !existingFlags || existingFlags.count < 1 )
+        return;
+    
+    [[self flagTable] addEntriesFromFlagTable:existingFlags];
+}
+
+// Unlike 'addFlagsFromTable', this only takes as long as the number of flags that changed in the other table (instead of
+// the number of flags in it), and it also removes any flags that were removed from the other table.
+- (void)addChangedFlagsFromTable:(EKFlagTable*)changedFlags
+{
+    if( !changedFlags || [changedFlags hasChanges] == NO )
+        return;
+
+    [[self flagTable] applyChangesFromFlagTable:changedFlags];
 }
 
 - (id)flagNamed:(NSString*)nameOfFlag
@@ -674,25 +1776,20 @@
     if( !record )
         return nil;
     
-    return [[self flags] objectForKey:nameOfFlag];
+    return [[self flagTable] objectForFlagNamed:nameOfFlag];
 }
 
 // Return the int value of a particular flag. It's important to keep in mind though, that while flags by default
 // use int values, it's entirely possible that it might use something entirely different. It's even possible to use
-// completely different types of objects (say, UIImage) as a flag value.
+// completely different types of objects (say, UIImage) as a flag value. Flags that aren't numbers (and can't be
+// converted into numbers) are treated as zero.
 - (int)valueOfFlagNamed:(NSString*)flagName
 {
-    int result = 0;                           // Assume zero as the default value
-    NSNumber* theFlag = [self flagNamed:flagName];  // Try to get a pointer to the flag
+    if( !record || !flagName )
+        return 0;
     
-    // Check if any data was actually retrieved AND that this holds a number value (as opposed to, say, UIImage or
-    // some entirely different type of class).
-    if( theFlag && [theFlag isKindOfClass:[NSNumber class]]) {
-        result = [theFlag intValue];
-    }
-    
-    // If a flag was found, it will return that value. If no flag was found, then it will just return zero.
-    return result;
+    // If no flag was found, then this will just return zero.
+    return (int) [[self flagTable] valueOfFlagNamed:flagName];
 }
 
 // Sets the value of a flag
@@ -701,12 +1798,8 @@
     if( !flagValue || !nameOfFlag ) // Check for invalid parameters
         return;
     
-    // Automatically create a new record if one doesn't exist
-    if( !record )
-        [self startNewRecord];
-    
-    // Update flags dictionary with this value
-    [[self flags] setValue:flagValue forKey:nameOfFlag];
+    // Update the flag table with this value (a new record is automatically created if one doesn't exist)
+    [[self flagTable] setObject:flagValue forFlagNamed:nameOfFlag];
 }
 
 // Sets a flag's int value. If you want to use a non-integer value (or something that's not even a number to begin with),
@@ -715,35 +1808,18 @@
 {
     // Check if the flag name NSString is valid
     if( nameOfFlag ) {
-        
-        // Convert int to NSNumber and pass that into the flags dictionary
-        NSNumber* tempValue = [NSNumber numberWithInteger:iValue];
-        [self setFlagValue:tempValue forFlagNamed:nameOfFlag];
+        [[self flagTable] setValue:iValue forFlagNamed:nameOfFlag];
     }
 }
 
-// Adds or subtracts the integer value of a flag by a certain amount (the amount being whatever 'iValue' is).
+// Adds or subtracts the integer value of a flag by a certain amount (the amount being whatever 'iValue' is). If there
+// is no value (or if it's not a number to begin with), then the flag is treated as if it were zero.
 - (void)modifyIntegerValue:(int)iValue forFlag:(NSString*)nameOfFlag
 {
     if( !nameOfFlag ) // Function quits if no valid flag name is passed in
         return;
     
-    // Create a record if there isn't one already
-    if( !record )
-        [self startNewRecord];
-    
-    // Get the original flag value
-    NSNumber* numberObject = [[self flags] objectForKey:nameOfFlag];
-    
-    // If there is no value (or if it's not a number to begin with), then make it into an NSNumber with a value of zero
-    if( numberObject == nil || ![numberObject isKindOfClass:[NSNumber class]])
-        numberObject = [NSNumber numberWithInteger:0];
-    
-    int numberValue = [numberObject intValue];    // Convert from NSNumber to int
-    numberValue = numberValue + iValue;                     // Modify value by 'iValue'
-    
-    // Save the updated value into the flags dictionary
-    [self setFlagValue:@(numberValue) forFlagNamed:nameOfFlag];
+    [[self flagTable] modifyValueOfFlagNamed:nameOfFlag by:iValue];
 }
 
 #pragma mark - Activity data
@@ -792,20 +1868,22 @@
     }
 }
 
-// For saving/loading to device. This should cause the information stored by EKRecord to being put to NSUserDefaults, and then
-// it would "synchronize," so that the data would be stored directly into the device memory (as opposed to just sitting in RAM).
+// For saving/loading to device. This saves the current record to its slot file, and then "synchronizes" NSUserDefaults, so that
+// the global values would be stored directly into the device memory (as opposed to just sitting in RAM).
 - (void)saveToDevice
 {
-    NSLog(@"[EKRecord] Will now attempt to save information to device memory.");
+    EKTraceDebug(EKTraceCategorySave, "Will now attempt to save information to device memory.");
     
     if( record ) {
-        NSLog(@"[EKRecord] Saving record to device memory...");
+        EKTraceDebug(EKTraceCategorySave, "Saving record to device memory...");
         [self saveCurrentRecord];
         
         // Now "synchronize" the data so that everything in NSUserDefaults will be moved from RAM into the actual device memory.
         // NSUserDefaults synchronizes its data every so often, but in this case it will be done manually to ensure that EKRecord's data
-        // will be moved into device memory.
-        [[NSUserDefaults standardUserDefaults] synchronize];
+        // will be moved into device memory. This happens on the save queue too, so it doesn't hold up the game either.
+        dispatch_async(saveQueue, ^{
+            [[NSUserDefaults standardUserDefaults] synchronize];
+        });
     } else if ( !record ) {
         NSLog(@"[EKRecord] ERROR: Cannot save information because no record exists.");
     }
@@ -0,0 +1,270 @@
+//
+//  EKRecordBinary.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "EKRecordBinary.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EKRecordBinaryMaxVarintLength   10      // A 64-bit number takes at most ten 7-bit groups
+
+static void EKRecordBinaryWrite32(uint8_t* buffer, uint32_t value)
+{
+    for( int i = 0; i < 4; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint32_t EKRecordBinaryRead32(const uint8_t* buffer)
+{
+    uint32_t value = 0;
+    for( int i = 0; i < 4; i++ )
+        value |= (uint32_t)buffer[i] << (i * 8);
+    return value;
+}
+
+// MARK: - Checksum
+
+// Standard CRC-32 (the same one that zip files use), with the table built the first time it's needed
+static uint32_t EKRecordBinaryCRCTable[256];
+static pthread_once_t EKRecordBinaryCRCTableOnce = PTHREAD_ONCE_INIT;
+
+static void EKRecordBinaryBuildCRCTable(void)
+{
+    for( uint32_t i = 0; i < 256; i++ ) {
+
+        uint32_t value = i;
+        for( int bit = 0; bit < 8; bit++ )
+            value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+
+        EKRecordBinaryCRCTable[i] = value;
+    }
+}
+
+uint32_t EKRecordBinaryChecksum(const uint8_t* data, size_t length)
+{
+    pthread_once(&EKRecordBinaryCRCTableOnce, EKRecordBinaryBuildCRCTable);
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for( size_t i = 0; i < length; i++ )
+        crc = EKRecordBinaryCRCTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFFu;
+}
+
+int EKRecordBinaryIsRecord(const uint8_t* data, size_t length)
+{
+    return (data != NULL && length >= EKRecordBinaryHeaderSize && EKRecordBinaryRead32(data) == EKRecordBinaryMagic);
+}
+
+size_t EKRecordBinaryLength(const uint8_t* data, size_t length)
+{
+    if( EKRecordBinaryIsRecord(data, length) == 0 )
+        return 0;
+
+    size_t recordLength = EKRecordBinaryHeaderSize + (size_t)EKRecordBinaryRead32(data + 8);
+    return (recordLength <= length) ? recordLength : 0;
+}
+
+// MARK: - Writing
+
+void EKRecordWriterInit(EKRecordWriter* writer, size_t capacity)
+{
+    memset(writer, 0, sizeof(EKRecordWriter));
+
+    // The header is left empty until everything else has been written
+    if( EKRecordWriterAppend(writer, EKRecordBinaryHeaderSize + capacity) != NULL )
+        writer->length = EKRecordBinaryHeaderSize;
+}
+
+void EKRecordWriterFree(EKRecordWriter* writer)
+{
+    free(writer->bytes);
+    memset(writer, 0, sizeof(EKRecordWriter));
+}
+
+uint8_t* EKRecordWriterAppend(EKRecordWriter* writer, size_t length)
+{
+    if( writer->failed )
+        return NULL;
+
+    if( length > writer->capacity - writer->length ) {
+
+        size_t capacity = (writer->capacity > 0) ? writer->capacity : 256;
+        while( capacity - writer->length < length ) {
+            if( capacity > SIZE_MAX / 2 ) {
+                writer->failed = 1;
+                return NULL;
+            }
+            capacity *= 2;
+        }
+
+        uint8_t* bytes = realloc(writer->bytes, capacity);
+        if( bytes == NULL ) {
+            writer->failed = 1;
+            return NULL;
+        }
+
+        writer->bytes = bytes;
+        writer->capacity = capacity;
+    }
+
+    uint8_t* position = writer->bytes + writer->length;
+    writer->length += length;
+    return position;
+}
+
+void EKRecordWriterWriteByte(EKRecordWriter* writer, uint8_t value)
+{
+    uint8_t* position = EKRecordWriterAppend(writer, 1);
+    if( position != NULL )
+        *position = value;
+}
+
+void EKRecordWriterWriteVarint(EKRecordWriter* writer, uint64_t value)
+{
+    uint8_t buffer[EKRecordBinaryMaxVarintLength];
+    size_t length = 0;
+
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[length++] = (value != 0) ? (byte | 0x80) : byte;
+    } while( value != 0 );
+
+    EKRecordWriterWriteBytes(writer, buffer, length);
+}
+
+void EKRecordWriterWriteDouble(EKRecordWriter* writer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint8_t* position = EKRecordWriterAppend(writer, 8);
+    if( position != NULL ) {
+        for( int i = 0; i < 8; i++ )
+            position[i] = (uint8_t)(bits >> (i * 8));
+    }
+}
+
+void EKRecordWriterWriteBytes(EKRecordWriter* writer, const void* bytes, size_t length)
+{
+    uint8_t* position = EKRecordWriterAppend(writer, length);
+    if( position != NULL && length > 0 )
+        memcpy(position, bytes, length);
+}
+
+int EKRecordWriterFinish(EKRecordWriter* writer)
+{
+    if( writer->failed || writer->length < EKRecordBinaryHeaderSize )
+        return 0;
+
+    size_t payloadLength = writer->length - EKRecordBinaryHeaderSize;
+    if( payloadLength > UINT32_MAX ) {
+        fprintf(stderr, "[EKRecordBinary] ERROR: Record is too large to encode.\n");
+        return 0;
+    }
+
+    const uint8_t* payload = writer->bytes + EKRecordBinaryHeaderSize;
+    EKRecordBinaryWrite32(writer->bytes, EKRecordBinaryMagic);
+    EKRecordBinaryWrite32(writer->bytes + 4, EKRecordBinaryVersion);
+    EKRecordBinaryWrite32(writer->bytes + 8, (uint32_t)payloadLength);
+    EKRecordBinaryWrite32(writer->bytes + 12, EKRecordBinaryChecksum(payload, payloadLength));
+    return 1;
+}
+
+// MARK: - Reading
+
+int EKRecordReaderInit(EKRecordReader* reader, const uint8_t* data, size_t length)
+{
+    memset(reader, 0, sizeof(EKRecordReader));
+    reader->failed = 1; // Until the header has been checked
+
+    if( EKRecordBinaryIsRecord(data, length) == 0 ) {
+        fprintf(stderr, "[EKRecordBinary] ERROR: Data is not a binary record.\n");
+        return 0;
+    }
+    if( EKRecordBinaryRead32(data + 4) != EKRecordBinaryVersion ) {
+        fprintf(stderr, "[EKRecordBinary] ERROR: Unsupported binary record version: %u\n", EKRecordBinaryRead32(data + 4));
+        return 0;
+    }
+
+    const uint8_t* payload = data + EKRecordBinaryHeaderSize;
+    size_t payloadLength = length - EKRecordBinaryHeaderSize;
+
+    if( EKRecordBinaryRead32(data + 8) != payloadLength || EKRecordBinaryRead32(data + 12) != EKRecordBinaryChecksum(payload, payloadLength) ) {
+        fprintf(stderr, "[EKRecordBinary] ERROR: Binary record is corrupt (the length or checksum doesn't match).\n");
+        return 0;
+    }
+
+    reader->bytes = payload;
+    reader->length = payloadLength;
+    reader->failed = 0;
+    return 1;
+}
+
+size_t EKRecordReaderRemaining(const EKRecordReader* reader)
+{
+    return reader->failed ? 0 : (reader->length - reader->offset);
+}
+
+uint8_t EKRecordReaderReadByte(EKRecordReader* reader)
+{
+    const uint8_t* position = EKRecordReaderReadBytes(reader, 1);
+    return (position != NULL) ? *position : 0;
+}
+
+uint64_t EKRecordReaderReadVarint(EKRecordReader* reader)
+{
+    uint64_t value = 0;
+
+    for( int i = 0; i < EKRecordBinaryMaxVarintLength; i++ ) {
+
+        if( EKRecordReaderRemaining(reader) == 0 )
+            break;
+
+        uint8_t byte = reader->bytes[reader->offset++];
+
+        // The tenth group only has room for the very top bit of a 64-bit number
+        if( i == EKRecordBinaryMaxVarintLength - 1 && byte > 1 )
+            break;
+
+        value |= (uint64_t)(byte & 0x7F) << (i * 7);
+        if( (byte & 0x80) == 0 )
+            return value;
+    }
+
+    reader->failed = 1;
+    return 0;
+}
+
+double EKRecordReaderReadDouble(EKRecordReader* reader)
+{
+    const uint8_t* position = EKRecordReaderReadBytes(reader, 8);
+    if( position == NULL )
+        return 0;
+
+    uint64_t bits = 0;
+    for( int i = 0; i < 8; i++ )
+        bits |= (uint64_t)position[i] << (i * 8);
+
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+const uint8_t* EKRecordReaderReadBytes(EKRecordReader* reader, size_t length)
+{
+    if( reader->failed || length > EKRecordReaderRemaining(reader) ) {
+        reader->failed = 1;
+        return NULL;
+    }
+
+    const uint8_t* position = reader->bytes + reader->offset;
+    reader->offset += length;
+    return position;
+}
@@ -0,0 +1,121 @@
+//
+//  EKRecordBinary.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ EKRecordBinary
+
+ The pieces of EKRecord's binary saved-game format: a buffer to write into, a reader that checks everything it reads,
+ and the header that goes at the start of the data. (EKRecord itself is what turns a record's dictionaries, arrays,
+ strings and numbers into tagged values; see 'binaryDataFromRecord:'.)
+
+ Binary records are much smaller than JSON, and much faster to write and read back. Numbers are written as varints
+ (7 bits per byte, lowest bits first), so small numbers like flag values only take a byte or two. Dictionary keys are
+ interned: the first time a key is written, it's written in full, and after that only its number gets written.
+
+ The data starts with a header:
+
+   uint32 magic, uint32 version, uint32 length of everything after the header, uint32 CRC-32 of everything after the header
+
+ so a saved game that's been cut short (or damaged in some other way) gets noticed before anything is decoded. All the
+ fixed-size numbers are little-endian.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef EKRecordBinary_h
+#define EKRecordBinary_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define EKRecordBinaryMagic             0x42524B45  // "EKRB" (little-endian)
+#define EKRecordBinaryVersion           1
+#define EKRecordBinaryHeaderSize        16
+#define EKRecordBinaryMaxDepth          64          // How deeply containers can be nested inside each other
+
+// Value tags. Each value starts with one of these, followed by:
+#define EKRecordBinaryTagNull           0   // (nothing)
+#define EKRecordBinaryTagFalse          1   // (nothing)
+#define EKRecordBinaryTagTrue           2   // (nothing)
+#define EKRecordBinaryTagInteger        3   // varint
+#define EKRecordBinaryTagNegative       4   // varint of -(value + 1)
+#define EKRecordBinaryTagDouble         5   // float64
+#define EKRecordBinaryTagString         6   // varint length, UTF-8 bytes
+#define EKRecordBinaryTagArray          7   // varint count, values
+#define EKRecordBinaryTagDictionary     8   // varint count, then for each pair: key, value
+
+// Dictionary keys are a varint: zero means that a new key follows (as a varint length and UTF-8 bytes), and any other
+// number N means the Nth key that was written before this one.
+#define EKRecordBinaryNewKey            0
+
+typedef struct {
+    uint8_t* bytes;
+    size_t length;
+    size_t capacity;
+    int failed;         // Set if memory ran out (everything written after that is ignored)
+} EKRecordWriter;
+
+typedef struct {
+    const uint8_t* bytes;
+    size_t length;
+    size_t offset;
+    int failed;         // Set if anything was read past the end of the data (or was invalid)
+} EKRecordReader;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Whether the data starts like a binary record (it still might not be a valid one)
+int EKRecordBinaryIsRecord(const uint8_t* data, size_t length);
+
+// The length of the binary record at the start of the data (header included), for when several records are stored one
+// after another. Returns 0 if the data doesn't start with a record, or if the record is cut off.
+size_t EKRecordBinaryLength(const uint8_t* data, size_t length);
+
+uint32_t EKRecordBinaryChecksum(const uint8_t* data, size_t length);
+
+// MARK: Writing
+
+// Writers start out with space for the header, which gets filled in by EKRecordWriterFinish
+void EKRecordWriterInit(EKRecordWriter* writer, size_t capacity);
+void EKRecordWriterFree(EKRecordWriter* writer);
+
+// Returns where the next 'length' bytes go (or NULL if memory ran out)
+uint8_t* EKRecordWriterAppend(EKRecordWriter* writer, size_t length);
+
+void EKRecordWriterWriteByte(EKRecordWriter* writer, uint8_t value);
+void EKRecordWriterWriteVarint(EKRecordWriter* writer, uint64_t value);
+void EKRecordWriterWriteDouble(EKRecordWriter* writer, double value);
+void EKRecordWriterWriteBytes(EKRecordWriter* writer, const void* bytes, size_t length);
+
+// Fills in the header. Returns 0 if anything went wrong while writing (or if there's too much data for the header).
+int EKRecordWriterFinish(EKRecordWriter* writer);
+
+// MARK: Reading
+
+// Checks the header (and the checksum), and then starts reading right after it. Returns 0 if the data isn't valid.
+int EKRecordReaderInit(EKRecordReader* reader, const uint8_t* data, size_t length);
+
+size_t EKRecordReaderRemaining(const EKRecordReader* reader);
+
+// These all return zero (or NULL) and set 'failed' if there isn't enough data left
+uint8_t EKRecordReaderReadByte(EKRecordReader* reader);
+uint64_t EKRecordReaderReadVarint(EKRecordReader* reader);
+double EKRecordReaderReadDouble(EKRecordReader* reader);
+const uint8_t* EKRecordReaderReadBytes(EKRecordReader* reader, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,324 @@
+//
+//  EKSlotIndex.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "EKSlotIndex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define EKSlotIndexHeaderSize           16      // Magic, version, entry count, entry size
+#define EKSlotIndexEntrySize            192     // Slot, (unused), date, score, data length, and the string fields
+#define EKSlotIndexStringsOffset        32
+#define EKSlotIndexMaxEntries           100000  // Anything more than this is treated as a corrupt file
+
+// Index files look like this (everything is little-endian):
+//
+//   uint32 magic, uint32 version, uint32 entry count, uint32 entry size
+//   for each entry: uint32 slot, uint32 (unused, always zero), float64 date saved, uint64 score, uint64 data length,
+//                   char activity[32], char speaker[32], char preview[96]
+
+struct EKSlotIndex {
+    EKSlotIndexEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+// MARK: - Index
+
+EKSlotIndex* EKSlotIndexCreate(void)
+{
+    return calloc(1, sizeof(EKSlotIndex));
+}
+
+void EKSlotIndexFree(EKSlotIndex* index)
+{
+    if( index == NULL )
+        return;
+
+    free(index->entries);
+    free(index);
+}
+
+uint32_t EKSlotIndexCount(const EKSlotIndex* index)
+{
+    return (index != NULL) ? index->count : 0;
+}
+
+const EKSlotIndexEntry* EKSlotIndexEntryAt(const EKSlotIndex* index, uint32_t position)
+{
+    if( index == NULL || position >= index->count )
+        return NULL;
+
+    return &index->entries[position];
+}
+
+// Returns where the slot is (or where it would go, if it isn't in the index)
+static uint32_t EKSlotIndexPositionOf(const EKSlotIndex* index, uint32_t slot)
+{
+    uint32_t low = 0;
+    uint32_t high = index->count;
+
+    while( low < high ) {
+        uint32_t middle = low + (high - low) / 2;
+        if( index->entries[middle].slot < slot )
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+const EKSlotIndexEntry* EKSlotIndexFind(const EKSlotIndex* index, uint32_t slot)
+{
+    if( index == NULL )
+        return NULL;
+
+    uint32_t position = EKSlotIndexPositionOf(index, slot);
+    if( position < index->count && index->entries[position].slot == slot )
+        return &index->entries[position];
+
+    return NULL;
+}
+
+int EKSlotIndexSet(EKSlotIndex* index, const EKSlotIndexEntry* entry)
+{
+    if( index == NULL || entry == NULL )
+        return 0;
+
+    uint32_t position = EKSlotIndexPositionOf(index, entry->slot);
+    if( position < index->count && index->entries[position].slot == entry->slot ) {
+        index->entries[position] = *entry;
+        return 1;
+    }
+
+    if( index->count == index->capacity ) {
+        uint32_t capacity = (index->capacity > 0) ? index->capacity * 2 : 16;
+        EKSlotIndexEntry* entries = realloc(index->entries, capacity * sizeof(EKSlotIndexEntry));
+        if( entries == NULL )
+            return 0;
+
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+
+    memmove(&index->entries[position + 1], &index->entries[position], (index->count - position) * sizeof(EKSlotIndexEntry));
+    index->entries[position] = *entry;
+    index->count++;
+    return 1;
+}
+
+int EKSlotIndexRemove(EKSlotIndex* index, uint32_t slot)
+{
+    if( EKSlotIndexFind(index, slot) == NULL )
+        return 0;
+
+    uint32_t position = EKSlotIndexPositionOf(index, slot);
+    memmove(&index->entries[position], &index->entries[position + 1], (index->count - position - 1) * sizeof(EKSlotIndexEntry));
+    index->count--;
+    return 1;
+}
+
+void EKSlotIndexSetString(char* field, size_t fieldSize, const char* text)
+{
+    if( field == NULL || fieldSize == 0 )
+        return;
+
+    memset(field, 0, fieldSize);
+    if( text == NULL )
+        return;
+
+    size_t length = strlen(text);
+    if( length >= fieldSize ) {
+
+        // Back up past any continuation bytes (10xxxxxx), so that a character never gets cut in half
+        length = fieldSize - 1;
+        while( length > 0 && (((unsigned char)text[length]) & 0xC0) == 0x80 )
+            length--;
+    }
+
+    memcpy(field, text, length);
+}
+
+// MARK: - Reading and writing
+
+static void EKSlotIndexWrite32(uint8_t* buffer, uint32_t value)
+{
+    for( int i = 0; i < 4; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint32_t EKSlotIndexRead32(const uint8_t* buffer)
+{
+    uint32_t value = 0;
+    for( int i = 0; i < 4; i++ )
+        value |= (uint32_t)buffer[i] << (i * 8);
+    return value;
+}
+
+static void EKSlotIndexWrite64(uint8_t* buffer, uint64_t value)
+{
+    for( int i = 0; i < 8; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint64_t EKSlotIndexRead64(const uint8_t* buffer)
+{
+    uint64_t value = 0;
+    for( int i = 0; i < 8; i++ )
+        value |= (uint64_t)buffer[i] << (i * 8);
+    return value;
+}
+
+EKSlotIndex* EKSlotIndexRead(const char* path)
+{
+    if( path == NULL )
+        return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if( file == NULL )
+        return NULL; // Not an error; there just hasn't been anything saved yet
+
+    uint8_t header[EKSlotIndexHeaderSize];
+    EKSlotIndex* index = NULL;
+    uint8_t* buffer = NULL;
+
+    if( fread(header, 1, EKSlotIndexHeaderSize, file) != EKSlotIndexHeaderSize || EKSlotIndexRead32(header) != EKSlotIndexMagic ) {
+        fprintf(stderr, "[EKSlotIndex] ERROR: File is not a slot index: %s\n", path);
+        goto done;
+    }
+    if( EKSlotIndexRead32(header + 4) != EKSlotIndexVersion || EKSlotIndexRead32(header + 12) != EKSlotIndexEntrySize ) {
+        fprintf(stderr, "[EKSlotIndex] ERROR: Unsupported slot index version: %u\n", EKSlotIndexRead32(header + 4));
+        goto done;
+    }
+
+    uint32_t count = EKSlotIndexRead32(header + 8);
+    if( count > EKSlotIndexMaxEntries )
+        goto corrupt;
+
+    // All the entries get read at once; even a large index is only a few dozen kilobytes
+    size_t length = (size_t)count * EKSlotIndexEntrySize;
+    buffer = malloc(length + 1);
+    index = EKSlotIndexCreate();
+    if( buffer == NULL || index == NULL )
+        goto failed;
+
+    // Reading one byte past the entries makes sure that the file doesn't have anything else at the end of it
+    if( fread(buffer, 1, length + 1, file) != length )
+        goto corrupt;
+
+    if( count > 0 ) {
+        index->entries = malloc(count * sizeof(EKSlotIndexEntry));
+        if( index->entries == NULL )
+            goto failed;
+        index->capacity = count;
+    }
+
+    for( uint32_t i = 0; i < count; i++ ) {
+
+        const uint8_t* record = buffer + ((size_t)i * EKSlotIndexEntrySize);
+        EKSlotIndexEntry* entry = &index->entries[i];
+        uint64_t dateBits = EKSlotIndexRead64(record + 8);
+
+        entry->slot = EKSlotIndexRead32(record);
+        memcpy(&entry->dateSaved, &dateBits, sizeof(entry->dateSaved));
+        entry->score = EKSlotIndexRead64(record + 16);
+        entry->dataLength = EKSlotIndexRead64(record + 24);
+
+        const uint8_t* strings = record + EKSlotIndexStringsOffset;
+        memcpy(entry->activity, strings, EKSlotIndexActivityLength);
+        memcpy(entry->speaker, strings + EKSlotIndexActivityLength, EKSlotIndexSpeakerLength);
+        memcpy(entry->preview, strings + EKSlotIndexActivityLength + EKSlotIndexSpeakerLength, EKSlotIndexPreviewLength);
+
+        // Every field has to end with a zero, and the slots have to be in order (with no slot showing up twice)
+        if( entry->activity[EKSlotIndexActivityLength - 1] != '\0' || entry->speaker[EKSlotIndexSpeakerLength - 1] != '\0' ||
+            entry->preview[EKSlotIndexPreviewLength - 1] != '\0' )
+            goto corrupt;
+        if( i > 0 && entry->slot <= index->entries[i - 1].slot )
+            goto corrupt;
+
+        index->count++;
+    }
+
+    goto done;
+
+corrupt:
+    fprintf(stderr, "[EKSlotIndex] ERROR: Slot index is corrupt: %s\n", path);
+failed:
+    EKSlotIndexFree(index);
+    index = NULL;
+done:
+    free(buffer);
+    fclose(file);
+    return index;
+}
+
+int EKSlotIndexWrite(const EKSlotIndex* index, const char* path)
+{
+    if( index == NULL || path == NULL )
+        return 0;
+
+    size_t length = EKSlotIndexHeaderSize + ((size_t)index->count * EKSlotIndexEntrySize);
+    uint8_t* buffer = calloc(1, length);
+    if( buffer == NULL )
+        return 0;
+
+    EKSlotIndexWrite32(buffer, EKSlotIndexMagic);
+    EKSlotIndexWrite32(buffer + 4, EKSlotIndexVersion);
+    EKSlotIndexWrite32(buffer + 8, index->count);
+    EKSlotIndexWrite32(buffer + 12, EKSlotIndexEntrySize);
+
+    for( uint32_t i = 0; i < index->count; i++ ) {
+
+        uint8_t* record = buffer + EKSlotIndexHeaderSize + ((size_t)i * EKSlotIndexEntrySize);
+        const EKSlotIndexEntry* entry = &index->entries[i];
+        uint64_t dateBits;
+        memcpy(&dateBits, &entry->dateSaved, sizeof(dateBits));
+
+        EKSlotIndexWrite32(record, entry->slot);
+        EKSlotIndexWrite64(record + 8, dateBits);
+        EKSlotIndexWrite64(record + 16, entry->score);
+        EKSlotIndexWrite64(record + 24, entry->dataLength);
+
+        uint8_t* strings = record + EKSlotIndexStringsOffset;
+        memcpy(strings, entry->activity, EKSlotIndexActivityLength - 1);
+        memcpy(strings + EKSlotIndexActivityLength, entry->speaker, EKSlotIndexSpeakerLength - 1);
+        memcpy(strings + EKSlotIndexActivityLength + EKSlotIndexSpeakerLength, entry->preview, EKSlotIndexPreviewLength - 1);
+    }
+
+    // The new index goes into a temporary file first, and only replaces the old one once it's completely written
+    size_t pathLength = strlen(path);
+    char* temporaryPath = malloc(pathLength + 5);
+    if( temporaryPath == NULL ) {
+        free(buffer);
+        return 0;
+    }
+    memcpy(temporaryPath, path, pathLength);
+    memcpy(temporaryPath + pathLength, ".tmp", 5);
+
+    int result = 0;
+    FILE* file = fopen(temporaryPath, "wb");
+    if( file != NULL ) {
+
+        result = (fwrite(buffer, 1, length, file) == length && fflush(file) == 0 && fsync(fileno(file)) == 0);
+        if( fclose(file) != 0 )
+            result = 0;
+
+        if( result && rename(temporaryPath, path) != 0 )
+            result = 0;
+        if( result == 0 )
+            remove(temporaryPath);
+    }
+
+    if( result == 0 )
+        fprintf(stderr, "[EKSlotIndex] ERROR: Could not write slot index: %s\n", path);
+
+    free(temporaryPath);
+    free(buffer);
+    return result;
+}
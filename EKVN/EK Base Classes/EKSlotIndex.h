@@ -0,0 +1,86 @@
+//
+//  EKSlotIndex.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ EKSlotIndex
+
+ A small file that describes every saved-game slot: when it was saved, what the player was doing, who was speaking
+ (and the start of what they said), and the score. Each slot's saved game is kept in a file of its own (see EKRecord),
+ so a save/load menu would otherwise have to load and decode every one of those files just to show a list of them.
+ With the index, listing even a hundred slots only means reading one file of fixed-size records.
+
+ Entries are kept in order of slot number. Strings are stored in fixed-size fields as UTF-8, and text that doesn't fit
+ gets cut off at the end of the last whole character that does.
+
+ The index is written to a temporary file that then replaces the old one, so a crash in the middle of writing can't
+ leave a half-written index behind.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef EKSlotIndex_h
+#define EKSlotIndex_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define EKSlotIndexMagic                0x58495345  // "ESIX" (little-endian)
+#define EKSlotIndexVersion              1
+
+// Sizes of the string fields (including the terminating zero)
+#define EKSlotIndexActivityLength       32
+#define EKSlotIndexSpeakerLength        32
+#define EKSlotIndexPreviewLength        96
+
+typedef struct {
+    uint32_t slot;
+    double dateSaved;       // Seconds since 1970 (zero if it isn't known)
+    uint64_t score;
+    uint64_t dataLength;    // Size of the slot's saved game, in bytes
+    char activity[EKSlotIndexActivityLength];
+    char speaker[EKSlotIndexSpeakerLength];
+    char preview[EKSlotIndexPreviewLength];
+} EKSlotIndexEntry;
+
+typedef struct EKSlotIndex EKSlotIndex;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+EKSlotIndex* EKSlotIndexCreate(void);
+void EKSlotIndexFree(EKSlotIndex* index);
+
+// Returns NULL if the file doesn't exist or isn't a valid index
+EKSlotIndex* EKSlotIndexRead(const char* path);
+
+// Returns 0 if the index couldn't be written
+int EKSlotIndexWrite(const EKSlotIndex* index, const char* path);
+
+uint32_t EKSlotIndexCount(const EKSlotIndex* index);
+const EKSlotIndexEntry* EKSlotIndexEntryAt(const EKSlotIndex* index, uint32_t position); // Zero is the lowest slot number
+const EKSlotIndexEntry* EKSlotIndexFind(const EKSlotIndex* index, uint32_t slot); // NULL if the slot isn't in the index
+
+// Adds the entry, or replaces the one that has the same slot number. Returns 0 if there wasn't enough memory.
+int EKSlotIndexSet(EKSlotIndex* index, const EKSlotIndexEntry* entry);
+
+// Returns 0 if the slot wasn't in the index
+int EKSlotIndexRemove(EKSlotIndex* index, uint32_t slot);
+
+// Copies a UTF-8 string into one of an entry's fields (NULL leaves the field empty)
+void EKSlotIndexSetString(char* field, size_t fieldSize, const char* text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
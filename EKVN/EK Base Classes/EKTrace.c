@@ -0,0 +1,906 @@
+//
+//  EKTrace.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "EKTrace.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define EKTraceBufferMask               (EKTraceBufferEntries - 1)
+#define EKTraceLineLength               1024    // Longest line that a message gets formatted into
+#define EKTraceMaxPrecision             9       // Floating-point numbers are shown with (at most) this many decimal places
+#define EKTraceCategoryNameCount        6
+#define EKTraceSlotBusy                 UINT64_MAX  // Sequence number of a slot that's being written to
+
+#if (EKTraceBufferEntries & EKTraceBufferMask) != 0
+    #error EKTraceBufferEntries has to be a power of two
+#endif
+
+// Each message takes up one of these. Arguments are packed into the payload in the same order that they appear in
+// the format string: numbers and pointers take 8 bytes each, and strings are a length byte followed by the text.
+typedef struct {
+
+    _Atomic uint64_t sequence;  // Index of the message plus one once it's been written (or EKTraceSlotBusy)
+    uint64_t time;              // Nanoseconds since tracing started
+    const char* format;
+    uint32_t thread;            // Threads are numbered in the order that they first traced something
+    uint8_t level;
+    uint8_t category;           // Which bit was set in the category
+    uint8_t argumentCount;      // How many arguments fit in the payload
+    uint8_t payloadLength;
+    uint8_t payload[EKTracePayloadSize];
+
+} EKTraceEntry;
+
+// Argument types, as far as storing them goes
+typedef enum {
+    EKTraceArgumentNone = 0,    // Not a valid conversion (the rest of the format string is shown as-is)
+    EKTraceArgumentSigned,
+    EKTraceArgumentUnsigned,
+    EKTraceArgumentDouble,
+    EKTraceArgumentPointer,
+    EKTraceArgumentString
+} EKTraceArgumentType;
+
+typedef enum {
+    EKTraceLengthDefault = 0,
+    EKTraceLengthChar,          // hh
+    EKTraceLengthShort,         // h
+    EKTraceLengthLong,          // l
+    EKTraceLengthLongLong,      // ll, q
+    EKTraceLengthSize,          // z
+    EKTraceLengthMax,           // j
+    EKTraceLengthPointerDiff,   // t
+    EKTraceLengthLongDouble     // L
+} EKTraceLength;
+
+// One conversion (like "%-8.3f") from a format string
+typedef struct {
+    char conversion;
+    EKTraceLength length;
+    EKTraceArgumentType type;
+    int leftAlign;
+    int zeroPad;
+    int showSign;
+    int spaceSign;
+    int width;                  // -1 if there isn't one
+    int widthFromArgument;      // The width was '*'
+    int precision;              // -1 if there isn't one
+    int precisionFromArgument;  // The precision was '.*'
+} EKTraceConversion;
+
+static EKTraceEntry EKTraceEntries[EKTraceBufferEntries];
+static _Atomic uint64_t EKTraceHead = 0;            // Index of the next message
+static _Atomic uint64_t EKTraceClearedBefore = 0;   // Messages before this index were thrown out by EKTraceClear
+static _Atomic uint64_t EKTraceDroppedCount = 0;
+static _Atomic uint64_t EKTraceStartTime = 0;
+static _Atomic uint32_t EKTraceThreadCount = 0;
+static _Atomic int EKTraceCurrentLevel = EKTraceLevelDebug;
+static _Atomic uint32_t EKTraceCurrentCategories = EKTraceCategoryAll;
+static _Atomic int EKTraceEcho = 0;
+static _Thread_local uint32_t EKTraceThreadNumber = 0;
+
+static const char* EKTraceLevelNames[] = { "ERROR", "WARNING", "INFO", "DEBUG", "VERBOSE" };
+static const char* EKTraceCategoryNames[EKTraceCategoryNameCount] = { "General", "Script", "Scene", "Sprites", "Save", "Record" };
+
+// MARK: - Settings
+
+void EKTraceSetLevel(int level)
+{
+    atomic_store_explicit(&EKTraceCurrentLevel, level, memory_order_relaxed);
+}
+
+int EKTraceLevel(void)
+{
+    return atomic_load_explicit(&EKTraceCurrentLevel, memory_order_relaxed);
+}
+
+void EKTraceSetCategories(uint32_t categories)
+{
+    atomic_store_explicit(&EKTraceCurrentCategories, categories, memory_order_relaxed);
+}
+
+int EKTraceIsEnabled(int level, uint32_t category)
+{
+    if( level > atomic_load_explicit(&EKTraceCurrentLevel, memory_order_relaxed) )
+        return 0;
+
+    return (category & atomic_load_explicit(&EKTraceCurrentCategories, memory_order_relaxed)) != 0;
+}
+
+void EKTraceSetEcho(int shouldEcho)
+{
+    atomic_store_explicit(&EKTraceEcho, shouldEcho, memory_order_relaxed);
+}
+
+uint64_t EKTraceMessageCount(void)
+{
+    return atomic_load_explicit(&EKTraceHead, memory_order_relaxed);
+}
+
+uint64_t EKTraceDroppedMessageCount(void)
+{
+    return atomic_load_explicit(&EKTraceDroppedCount, memory_order_relaxed);
+}
+
+void EKTraceClear(void)
+{
+    atomic_store_explicit(&EKTraceClearedBefore, atomic_load_explicit(&EKTraceHead, memory_order_acquire), memory_order_release);
+}
+
+// MARK: - Format strings
+
+// Reads one conversion, starting just after the '%'. Returns a pointer to whatever comes after the conversion, or NULL
+// if it isn't something that can be traced (in which case everything from the '%' onward is treated as plain text).
+static const char* EKTraceParseConversion(const char* format, EKTraceConversion* conversion)
+{
+    memset(conversion, 0, sizeof(EKTraceConversion));
+    conversion->width = -1;
+    conversion->precision = -1;
+
+    // Flags
+    for( ;; format++ ) {
+        if( *format == '-' )
+            conversion->leftAlign = 1;
+        else if( *format == '0' )
+            conversion->zeroPad = 1;
+        else if( *format == '+' )
+            conversion->showSign = 1;
+        else if( *format == ' ' )
+            conversion->spaceSign = 1;
+        else if( *format != '#' )
+            break;
+    }
+
+    // Width
+    if( *format == '*' ) {
+        conversion->widthFromArgument = 1;
+        format++;
+    } else if( *format >= '0' && *format <= '9' ) {
+        conversion->width = 0;
+        while( *format >= '0' && *format <= '9' ) {
+            if( conversion->width < EKTraceLineLength )
+                conversion->width = (conversion->width * 10) + (*format - '0');
+            format++;
+        }
+    }
+
+    // Precision
+    if( *format == '.' ) {
+        format++;
+        conversion->precision = 0;
+        if( *format == '*' ) {
+            conversion->precisionFromArgument = 1;
+            format++;
+        } else {
+            while( *format >= '0' && *format <= '9' ) {
+                if( conversion->precision < EKTraceLineLength )
+                    conversion->precision = (conversion->precision * 10) + (*format - '0');
+                format++;
+            }
+        }
+    }
+
+    // Length
+    if( format[0] == 'h' && format[1] == 'h' ) {
+        conversion->length = EKTraceLengthChar;
+        format += 2;
+    } else if( format[0] == 'l' && format[1] == 'l' ) {
+        conversion->length = EKTraceLengthLongLong;
+        format += 2;
+    } else if( *format == 'h' ) {
+        conversion->length = EKTraceLengthShort;
+        format++;
+    } else if( *format == 'l' ) {
+        conversion->length = EKTraceLengthLong;
+        format++;
+    } else if( *format == 'q' ) {
+        conversion->length = EKTraceLengthLongLong;
+        format++;
+    } else if( *format == 'z' ) {
+        conversion->length = EKTraceLengthSize;
+        format++;
+    } else if( *format == 'j' ) {
+        conversion->length = EKTraceLengthMax;
+        format++;
+    } else if( *format == 't' ) {
+        conversion->length = EKTraceLengthPointerDiff;
+        format++;
+    } else if( *format == 'L' ) {
+        conversion->length = EKTraceLengthLongDouble;
+        format++;
+    }
+
+    conversion->conversion = *format;
+
+    switch( *format ) {
+        case 'd':
+        case 'i':
+            conversion->type = EKTraceArgumentSigned;
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            conversion->type = EKTraceArgumentUnsigned;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            conversion->type = EKTraceArgumentDouble;
+            break;
+        case 'p':
+            conversion->type = EKTraceArgumentPointer;
+            break;
+        case 's':
+            conversion->type = EKTraceArgumentString;
+            break;
+        default:
+            return NULL; // This includes %n and %@, neither of which can be traced
+    }
+
+    return format + 1;
+}
+
+// MARK: - Writing messages
+
+static int EKTracePackNumber(EKTraceEntry* entry, uint64_t value)
+{
+    if( entry->payloadLength + sizeof(uint64_t) > EKTracePayloadSize )
+        return 0;
+
+    memcpy(entry->payload + entry->payloadLength, &value, sizeof(uint64_t));
+    entry->payloadLength += sizeof(uint64_t);
+    return 1;
+}
+
+static int EKTracePackString(EKTraceEntry* entry, const char* string)
+{
+    if( string == NULL )
+        string = "(null)";
+
+    // At least the length and a few characters have to fit, otherwise the string is left out entirely
+    size_t space = EKTracePayloadSize - entry->payloadLength;
+    if( space < 5 )
+        return 0;
+
+    size_t length = strnlen(string, (space - 1 < EKTraceMaxStringLength) ? space - 1 : EKTraceMaxStringLength);
+    entry->payload[entry->payloadLength] = (uint8_t)length;
+    memcpy(entry->payload + entry->payloadLength + 1, string, length);
+    entry->payloadLength += (uint8_t)(length + 1);
+    return 1;
+}
+
+static int64_t EKTraceReadSigned(va_list* arguments, EKTraceLength length)
+{
+    switch( length ) {
+        case EKTraceLengthLong:         return va_arg(*arguments, long);
+        case EKTraceLengthLongLong:     return va_arg(*arguments, long long);
+        case EKTraceLengthSize:         return (int64_t)va_arg(*arguments, size_t);
+        case EKTraceLengthMax:          return va_arg(*arguments, intmax_t);
+        case EKTraceLengthPointerDiff:  return va_arg(*arguments, ptrdiff_t);
+        default:                        return va_arg(*arguments, int);
+    }
+}
+
+static uint64_t EKTraceReadUnsigned(va_list* arguments, EKTraceLength length)
+{
+    switch( length ) {
+        case EKTraceLengthChar:         return (unsigned char)va_arg(*arguments, unsigned int);
+        case EKTraceLengthShort:        return (unsigned short)va_arg(*arguments, unsigned int);
+        case EKTraceLengthLong:         return va_arg(*arguments, unsigned long);
+        case EKTraceLengthLongLong:     return va_arg(*arguments, unsigned long long);
+        case EKTraceLengthSize:         return va_arg(*arguments, size_t);
+        case EKTraceLengthMax:          return va_arg(*arguments, uintmax_t);
+        case EKTraceLengthPointerDiff:  return (uint64_t)va_arg(*arguments, ptrdiff_t);
+        default:                        return va_arg(*arguments, unsigned int);
+    }
+}
+
+// Copies the arguments into the payload, stopping at the first one that doesn't fit
+static void EKTracePackArguments(EKTraceEntry* entry, const char* format, va_list* arguments)
+{
+    EKTraceConversion conversion;
+
+    while( *format != '\0' ) {
+
+        if( *format++ != '%' )
+            continue;
+        if( *format == '%' ) {
+            format++;
+            continue;
+        }
+
+        format = EKTraceParseConversion(format, &conversion);
+        if( format == NULL )
+            return;
+
+        if( conversion.widthFromArgument && !EKTracePackNumber(entry, (uint64_t)(int64_t)va_arg(*arguments, int)) )
+            return;
+        if( conversion.precisionFromArgument && !EKTracePackNumber(entry, (uint64_t)(int64_t)va_arg(*arguments, int)) )
+            return;
+
+        int fits = 0;
+        switch( conversion.type ) {
+            case EKTraceArgumentSigned: {
+                int64_t value = EKTraceReadSigned(arguments, conversion.length);
+                if( conversion.length == EKTraceLengthChar )
+                    value = (signed char)value;
+                else if( conversion.length == EKTraceLengthShort )
+                    value = (short)value;
+                fits = EKTracePackNumber(entry, (uint64_t)value);
+            } break;
+
+            case EKTraceArgumentUnsigned:
+                fits = EKTracePackNumber(entry, EKTraceReadUnsigned(arguments, conversion.length));
+                break;
+
+            case EKTraceArgumentDouble: {
+                double value = (conversion.length == EKTraceLengthLongDouble) ? (double)va_arg(*arguments, long double) : va_arg(*arguments, double);
+                uint64_t bits = 0;
+                memcpy(&bits, &value, sizeof(double));
+                fits = EKTracePackNumber(entry, bits);
+            } break;
+
+            case EKTraceArgumentPointer:
+                fits = EKTracePackNumber(entry, (uint64_t)(uintptr_t)va_arg(*arguments, void*));
+                break;
+
+            case EKTraceArgumentString:
+                fits = EKTracePackString(entry, va_arg(*arguments, const char*));
+                break;
+
+            default:
+                return;
+        }
+
+        if( fits == 0 )
+            return;
+
+        entry->argumentCount++;
+    }
+}
+
+static uint64_t EKTraceNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+static size_t EKTraceFormatEntry(const EKTraceEntry* entry, char* line, size_t lineLength);
+
+void EKTraceWrite(int level, uint32_t category, const char* format, ...)
+{
+    if( format == NULL )
+        return;
+
+    uint64_t now = EKTraceNow();
+    uint64_t startTime = atomic_load_explicit(&EKTraceStartTime, memory_order_relaxed);
+    if( startTime == 0 ) {
+        uint64_t expected = 0;
+        if( atomic_compare_exchange_strong(&EKTraceStartTime, &expected, now) )
+            startTime = now;
+        else
+            startTime = expected;
+    }
+
+    if( EKTraceThreadNumber == 0 )
+        EKTraceThreadNumber = atomic_fetch_add_explicit(&EKTraceThreadCount, 1, memory_order_relaxed) + 1;
+
+    // Claiming a slot is the only thing that writers have to agree on. The slot is marked as busy while it's being
+    // filled in, so that anything dumping the buffer at the same time knows to skip it. If the buffer has wrapped
+    // all the way around while another thread is still writing to the same slot (or that thread already put a newer
+    // message there), this message gets dropped rather than mixing the two together.
+    uint64_t index = atomic_fetch_add_explicit(&EKTraceHead, 1, memory_order_relaxed);
+    EKTraceEntry* entry = &EKTraceEntries[index & EKTraceBufferMask];
+
+    uint64_t sequence = atomic_load_explicit(&entry->sequence, memory_order_relaxed);
+    do {
+        if( sequence == EKTraceSlotBusy || sequence > index ) {
+            atomic_fetch_add_explicit(&EKTraceDroppedCount, 1, memory_order_relaxed);
+            return;
+        }
+    } while( !atomic_compare_exchange_weak_explicit(&entry->sequence, &sequence, EKTraceSlotBusy, memory_order_relaxed, memory_order_relaxed) );
+    atomic_thread_fence(memory_order_release);
+
+    entry->time = (now > startTime) ? (now - startTime) : 0;
+    entry->format = format;
+    entry->thread = EKTraceThreadNumber;
+    entry->level = (uint8_t)((level < EKTraceLevelError) ? EKTraceLevelError : (level > EKTraceLevelVerbose ? EKTraceLevelVerbose : level));
+    entry->category = (uint8_t)((category != 0) ? __builtin_ctz(category) : 0);
+    entry->argumentCount = 0;
+    entry->payloadLength = 0;
+
+    va_list arguments;
+    va_start(arguments, format);
+    EKTracePackArguments(entry, format, &arguments);
+    va_end(arguments);
+
+    atomic_store_explicit(&entry->sequence, index + 1, memory_order_release);
+
+    if( atomic_load_explicit(&EKTraceEcho, memory_order_relaxed) ) {
+        char line[EKTraceLineLength];
+        size_t length = EKTraceFormatEntry(entry, line, sizeof(line));
+        ssize_t result = write(STDERR_FILENO, line, length);
+        (void)result;
+    }
+}
+
+// MARK: - Formatting messages
+
+// Everything from here on only uses the stack, so that messages can be formatted from inside a signal handler
+
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity; // Includes room for the newline at the end
+} EKTraceLine;
+
+static void EKTraceAppend(EKTraceLine* line, const char* text, size_t length)
+{
+    if( line->length + length > line->capacity )
+        length = line->capacity - line->length;
+
+    memcpy(line->text + line->length, text, length);
+    line->length += length;
+}
+
+static void EKTraceAppendString(EKTraceLine* line, const char* text)
+{
+    EKTraceAppend(line, text, strlen(text));
+}
+
+static void EKTraceAppendPadding(EKTraceLine* line, char padding, int count)
+{
+    while( count-- > 0 && line->length < line->capacity )
+        line->text[line->length++] = padding;
+}
+
+// Appends some text, padded out to the conversion's width
+static void EKTraceAppendPadded(EKTraceLine* line, const EKTraceConversion* conversion, const char* prefix, const char* text, size_t length)
+{
+    size_t prefixLength = strlen(prefix);
+    int padding = (conversion->width > 0) ? conversion->width - (int)(prefixLength + length) : 0;
+
+    if( conversion->leftAlign ) {
+        EKTraceAppend(line, prefix, prefixLength);
+        EKTraceAppend(line, text, length);
+        EKTraceAppendPadding(line, ' ', padding);
+    } else if( conversion->zeroPad ) {
+        EKTraceAppend(line, prefix, prefixLength);
+        EKTraceAppendPadding(line, '0', padding);
+        EKTraceAppend(line, text, length);
+    } else {
+        EKTraceAppendPadding(line, ' ', padding);
+        EKTraceAppend(line, prefix, prefixLength);
+        EKTraceAppend(line, text, length);
+    }
+}
+
+// Writes the digits of a number into the end of a buffer, and returns where they start
+static char* EKTraceDigits(uint64_t value, unsigned base, int uppercase, int minimumDigits, char* bufferEnd)
+{
+    const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    char* start = bufferEnd;
+
+    while( value > 0 ) {
+        *--start = digits[value % base];
+        value /= base;
+    }
+
+    if( minimumDigits > 64 )
+        minimumDigits = 64;
+    while( bufferEnd - start < minimumDigits )
+        *--start = '0';
+
+    return start;
+}
+
+static void EKTraceAppendInteger(EKTraceLine* line, const EKTraceConversion* conversion, uint64_t bits)
+{
+    char buffer[72];
+    char* end = buffer + sizeof(buffer);
+    const char* prefix = "";
+    uint64_t value = bits;
+
+    if( conversion->type == EKTraceArgumentSigned ) {
+        int64_t signedValue = (int64_t)bits;
+        if( signedValue < 0 ) {
+            prefix = "-";
+            value = (uint64_t)0 - bits;
+        } else if( conversion->showSign ) {
+            prefix = "+";
+        } else if( conversion->spaceSign ) {
+            prefix = " ";
+        }
+    }
+
+    if( conversion->conversion == 'c' ) {
+        char character = (char)value;
+        EKTraceAppendPadded(line, conversion, "", &character, 1);
+        return;
+    }
+
+    unsigned base = 10;
+    if( conversion->conversion == 'x' || conversion->conversion == 'X' || conversion->conversion == 'p' )
+        base = 16;
+    else if( conversion->conversion == 'o' )
+        base = 8;
+
+    if( conversion->conversion == 'p' )
+        prefix = "0x";
+
+    // Like printf, a precision means "at least this many digits", and turns off zero-padding
+    EKTraceConversion padded = *conversion;
+    int minimumDigits = 1;
+    if( conversion->precision >= 0 ) {
+        minimumDigits = conversion->precision;
+        padded.zeroPad = 0;
+    }
+
+    char* start = EKTraceDigits(value, base, conversion->conversion == 'X', minimumDigits, end);
+    EKTraceAppendPadded(line, &padded, prefix, start, (size_t)(end - start));
+}
+
+static void EKTraceAppendDouble(EKTraceLine* line, const EKTraceConversion* conversion, uint64_t bits)
+{
+    double value = 0;
+    memcpy(&value, &bits, sizeof(double));
+
+    char buffer[96];
+    char* end = buffer + sizeof(buffer);
+    const char* prefix = "";
+    EKTraceConversion padded = *conversion;
+
+    if( value < 0 || (value == 0 && (bits >> 63) != 0) ) {
+        prefix = "-";
+        value = -value;
+    } else if( conversion->showSign ) {
+        prefix = "+";
+    } else if( conversion->spaceSign ) {
+        prefix = " ";
+    }
+
+    if( value != value || value > 1.0e300 ) {
+        padded.zeroPad = 0;
+        EKTraceAppendPadded(line, &padded, (value != value) ? "" : prefix, (value != value) ? "nan" : "inf", 3);
+        return;
+    }
+
+    int precision = (conversion->precision >= 0) ? conversion->precision : 6;
+    if( precision > EKTraceMaxPrecision )
+        precision = EKTraceMaxPrecision;
+
+    // Numbers that don't fit in 64 bits (or %e) are shown in scientific notation
+    int exponent = 0;
+    int scientific = (conversion->conversion == 'e' || conversion->conversion == 'E' || value >= 1.0e18);
+    if( (conversion->conversion == 'g' || conversion->conversion == 'G') && value != 0 && value < 1.0e-4 )
+        scientific = 1;
+
+    if( scientific && value != 0 ) {
+        while( value >= 10.0 ) {
+            value /= 10.0;
+            exponent++;
+        }
+        while( value < 1.0 ) {
+            value *= 10.0;
+            exponent--;
+        }
+    }
+
+    uint64_t scale = 1;
+    for( int i = 0; i < precision; i++ )
+        scale *= 10;
+
+    uint64_t whole = (uint64_t)value;
+    uint64_t fraction = (uint64_t)(((value - (double)whole) * (double)scale) + 0.5);
+    if( fraction >= scale ) {
+        whole++;
+        fraction -= scale;
+    }
+    if( scientific && whole >= 10 ) {
+        whole /= 10;
+        exponent++;
+    }
+
+    // %g drops trailing zeros
+    if( conversion->conversion == 'g' || conversion->conversion == 'G' ) {
+        while( precision > 0 && fraction % 10 == 0 ) {
+            fraction /= 10;
+            precision--;
+        }
+    }
+
+    char* start = end;
+    if( scientific ) {
+        char* exponentStart = EKTraceDigits((uint64_t)(exponent < 0 ? -exponent : exponent), 10, 0, 2, start);
+        *--exponentStart = (exponent < 0) ? '-' : '+';
+        *--exponentStart = (conversion->conversion == 'E' || conversion->conversion == 'G') ? 'E' : 'e';
+        start = exponentStart;
+    }
+    if( precision > 0 ) {
+        start = EKTraceDigits(fraction, 10, 0, precision, start);
+        *--start = '.';
+    }
+    start = EKTraceDigits(whole, 10, 0, 1, start);
+
+    EKTraceAppendPadded(line, &padded, prefix, start, (size_t)(end - start));
+}
+
+static void EKTraceAppendText(EKTraceLine* line, const EKTraceConversion* conversion, const uint8_t* text, size_t length)
+{
+    if( conversion->precision >= 0 && (size_t)conversion->precision < length )
+        length = (size_t)conversion->precision;
+
+    EKTraceConversion padded = *conversion;
+    padded.zeroPad = 0;
+    EKTraceAppendPadded(line, &padded, "", (const char*)text, length);
+}
+
+// Formats a message (using the arguments from its payload) into a single line, and returns the length of the line
+static size_t EKTraceFormatEntry(const EKTraceEntry* entry, char* text, size_t capacity)
+{
+    EKTraceLine line = { text, 0, capacity - 1 };
+    EKTraceConversion conversion;
+    EKTraceConversion header;
+
+    // Header: "[   12.345678] T1 DEBUG   Scene   "
+    memset(&header, 0, sizeof(header));
+    header.precision = -1;
+    header.type = EKTraceArgumentUnsigned;
+    header.conversion = 'u';
+
+    EKTraceAppendString(&line, "[");
+    header.width = 5;
+    EKTraceAppendInteger(&line, &header, entry->time / 1000000000ULL);
+    EKTraceAppendString(&line, ".");
+    header.width = 6;
+    header.zeroPad = 1;
+    EKTraceAppendInteger(&line, &header, (entry->time % 1000000000ULL) / 1000ULL);
+    EKTraceAppendString(&line, "] T");
+    header.width = -1;
+    header.zeroPad = 0;
+    EKTraceAppendInteger(&line, &header, entry->thread);
+    EKTraceAppendString(&line, " ");
+
+    header.width = 8;
+    header.leftAlign = 1;
+    const char* levelName = EKTraceLevelNames[entry->level <= EKTraceLevelVerbose ? entry->level : EKTraceLevelVerbose];
+    EKTraceAppendPadded(&line, &header, "", levelName, strlen(levelName));
+    const char* categoryName = (entry->category < EKTraceCategoryNameCount) ? EKTraceCategoryNames[entry->category] : "Other";
+    EKTraceAppendPadded(&line, &header, "", categoryName, strlen(categoryName));
+
+    // Message
+    const char* format = entry->format;
+    const uint8_t* payload = entry->payload;
+    const uint8_t* payloadEnd = entry->payload + entry->payloadLength;
+    int argumentsLeft = entry->argumentCount;
+
+    while( *format != '\0' ) {
+
+        const char* next = strchr(format, '%');
+        if( next == NULL ) {
+            EKTraceAppendString(&line, format);
+            break;
+        }
+
+        EKTraceAppend(&line, format, (size_t)(next - format));
+        format = next + 1;
+
+        if( *format == '%' ) {
+            EKTraceAppendString(&line, "%");
+            format++;
+            continue;
+        }
+
+        const char* after = EKTraceParseConversion(format, &conversion);
+        if( after == NULL ) {
+            EKTraceAppendString(&line, next);
+            break;
+        }
+        format = after;
+
+        // Arguments that didn't fit in the payload are shown as "?"
+        if( argumentsLeft <= 0 ) {
+            EKTraceAppendString(&line, "?");
+            continue;
+        }
+
+        if( conversion.widthFromArgument || conversion.precisionFromArgument ) {
+            int64_t values[2] = { 0, 0 };
+            int count = conversion.widthFromArgument + conversion.precisionFromArgument;
+            if( payload + (count * sizeof(uint64_t)) > payloadEnd ) {
+                EKTraceAppendString(&line, "?");
+                argumentsLeft = 0;
+                continue;
+            }
+            for( int i = 0; i < count; i++ ) {
+                memcpy(&values[i], payload, sizeof(uint64_t));
+                payload += sizeof(uint64_t);
+            }
+            if( conversion.widthFromArgument ) {
+                conversion.width = (int)values[0];
+                if( conversion.width < 0 ) {
+                    conversion.leftAlign = 1;
+                    conversion.width = -conversion.width;
+                }
+                if( conversion.width > EKTraceLineLength )
+                    conversion.width = EKTraceLineLength;
+            }
+            if( conversion.precisionFromArgument ) {
+                int64_t precision = values[conversion.widthFromArgument];
+                conversion.precision = (precision < 0) ? -1 : (int)(precision > EKTraceLineLength ? EKTraceLineLength : precision);
+            }
+        }
+
+        if( conversion.type == EKTraceArgumentString ) {
+            size_t length = (payload < payloadEnd) ? payload[0] : 0;
+            if( payload + 1 + length > payloadEnd ) {
+                argumentsLeft = 0;
+                continue;
+            }
+            EKTraceAppendText(&line, &conversion, payload + 1, length);
+            payload += 1 + length;
+
+        } else {
+            uint64_t bits = 0;
+            if( payload + sizeof(uint64_t) > payloadEnd ) {
+                argumentsLeft = 0;
+                continue;
+            }
+            memcpy(&bits, payload, sizeof(uint64_t));
+            payload += sizeof(uint64_t);
+
+            if( conversion.type == EKTraceArgumentDouble )
+                EKTraceAppendDouble(&line, &conversion, bits);
+            else
+                EKTraceAppendInteger(&line, &conversion, bits);
+        }
+
+        argumentsLeft--;
+    }
+
+    text[line.length++] = '\n';
+    return line.length;
+}
+
+// MARK: - Dumping
+
+static void EKTraceWriteAll(int fileDescriptor, const char* text, size_t length)
+{
+    while( length > 0 ) {
+        ssize_t written = write(fileDescriptor, text, length);
+        if( written <= 0 )
+            return;
+
+        text += written;
+        length -= (size_t)written;
+    }
+}
+
+size_t EKTraceDump(int fileDescriptor)
+{
+    if( fileDescriptor < 0 )
+        return 0;
+
+    uint64_t head = atomic_load_explicit(&EKTraceHead, memory_order_acquire);
+    uint64_t first = (head > EKTraceBufferEntries) ? head - EKTraceBufferEntries : 0;
+    uint64_t clearedBefore = atomic_load_explicit(&EKTraceClearedBefore, memory_order_acquire);
+    if( first < clearedBefore )
+        first = clearedBefore;
+
+    EKTraceEntry copy;
+    char line[EKTraceLineLength];
+    size_t count = 0;
+
+    for( uint64_t index = first; index < head; index++ ) {
+
+        // Copy the message, then make sure that it wasn't being (re)written while it was being copied
+        const EKTraceEntry* entry = &EKTraceEntries[index & EKTraceBufferMask];
+        uint64_t sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        if( sequence != index + 1 )
+            continue;
+
+        copy.time = entry->time;
+        copy.format = entry->format;
+        copy.thread = entry->thread;
+        copy.level = entry->level;
+        copy.category = entry->category;
+        copy.argumentCount = entry->argumentCount;
+        copy.payloadLength = entry->payloadLength;
+        memcpy(copy.payload, entry->payload, EKTracePayloadSize);
+
+        atomic_thread_fence(memory_order_acquire);
+        if( atomic_load_explicit(&entry->sequence, memory_order_relaxed) != sequence )
+            continue;
+
+        size_t length = EKTraceFormatEntry(&copy, line, sizeof(line));
+        EKTraceWriteAll(fileDescriptor, line, length);
+        count++;
+    }
+
+    return count;
+}
+
+size_t EKTraceDumpToFile(const char* path)
+{
+    if( path == NULL )
+        return 0;
+
+    int fileDescriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if( fileDescriptor < 0 )
+        return 0;
+
+    size_t count = EKTraceDump(fileDescriptor);
+    close(fileDescriptor);
+    return count;
+}
+
+// MARK: - Crashes
+
+#define EKTraceCrashSignalCount     6
+#define EKTraceCrashPathLength      1024
+
+static const int EKTraceCrashSignals[EKTraceCrashSignalCount] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTRAP };
+static struct sigaction EKTracePreviousActions[EKTraceCrashSignalCount];
+static char EKTraceCrashPath[EKTraceCrashPathLength];
+static volatile sig_atomic_t EKTraceIsHandlingCrash = 0;
+
+static void EKTraceCrashHandler(int signalNumber)
+{
+    if( EKTraceIsHandlingCrash == 0 ) {
+        EKTraceIsHandlingCrash = 1;
+
+        int fileDescriptor = open(EKTraceCrashPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if( fileDescriptor >= 0 ) {
+            char heading[] = "[EKTrace] Crashed with signal   \n";
+            heading[sizeof(heading) - 4] = (char)('0' + ((signalNumber / 10) % 10));
+            heading[sizeof(heading) - 3] = (char)('0' + (signalNumber % 10));
+            EKTraceWriteAll(fileDescriptor, heading, sizeof(heading) - 1);
+            EKTraceDump(fileDescriptor);
+            close(fileDescriptor);
+        }
+    }
+
+    // Put back whatever was handling this signal before, and let it (or the system) deal with the crash
+    for( int i = 0; i < EKTraceCrashSignalCount; i++ ) {
+        if( EKTraceCrashSignals[i] == signalNumber )
+            sigaction(signalNumber, &EKTracePreviousActions[i], NULL);
+    }
+
+    raise(signalNumber);
+}
+
+int EKTraceInstallCrashHandler(const char* path)
+{
+    if( path == NULL || strlen(path) >= EKTraceCrashPathLength )
+        return 0;
+
+    strncpy(EKTraceCrashPath, path, EKTraceCrashPathLength - 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = EKTraceCrashHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_ONSTACK;
+
+    for( int i = 0; i < EKTraceCrashSignalCount; i++ ) {
+        if( sigaction(EKTraceCrashSignals[i], &action, &EKTracePreviousActions[i]) != 0 )
+            return 0;
+    }
+
+    return 1;
+}
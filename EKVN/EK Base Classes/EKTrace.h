@@ -0,0 +1,152 @@
+//
+//  EKTrace.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ EKTrace
+
+ Leveled, category-tagged trace messages that cost (almost) nothing. NSLog formats every message right away and
+ then writes it out synchronously, which is fine for the occasional error, but not for something that happens on
+ every command or every frame; while skipping through a script, most of the main thread's time ended up going to
+ NSLog. Trace messages work differently:
+
+   - In release builds (or whenever EKTRACE_ENABLED is 0), the macros compile to nothing at all. Their arguments
+     aren't even evaluated, so it's fine to pass in expensive things like [[dictionary description] UTF8String].
+
+   - In debug builds, a message is only written if its level and category are turned on (see EKTraceSetLevel and
+     EKTraceSetCategories). Messages above EKTRACE_MAX_LEVEL are stripped out at compile time.
+
+   - Written messages aren't formatted. The format string (which has to be a string literal) and the raw argument
+     values are copied into a fixed-size ring buffer, which any number of threads can write to at once without
+     locking. Messages only get formatted when the buffer is dumped (see EKTraceDump), which happens on demand, or
+     automatically if the app crashes (see EKTraceInstallCrashHandler). The buffer holds the most recent
+     EKTraceBufferEntries messages; older ones get overwritten.
+
+ Format strings work like printf (%d, %ld, %llu, %zu, %x, %p, %c, %s, %f...), but not %@, so Objective-C objects
+ need to be passed as C strings:
+
+   EKTraceDebug(EKTraceCategoryScene, "Saving sprite named: %s", [spriteName UTF8String]);
+
+ Strings are copied when the message is written (up to EKTraceMaxStringLength bytes each), and arguments that don't
+ fit in the message's payload are shown as "?".
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef EKTrace_h
+#define EKTrace_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+// Tracing is on in debug builds, unless it's turned off by defining EKTRACE_ENABLED as 0 in the build settings
+#ifndef EKTRACE_ENABLED
+    #if DEBUG
+        #define EKTRACE_ENABLED         1
+    #else
+        #define EKTRACE_ENABLED         0
+    #endif
+#endif
+
+// Messages with a higher level than this are stripped out at compile time
+#ifndef EKTRACE_MAX_LEVEL
+    #define EKTRACE_MAX_LEVEL           EKTraceLevelVerbose
+#endif
+
+#define EKTraceBufferEntries            4096    // How many messages the ring buffer holds (must be a power of two)
+#define EKTracePayloadSize              224     // Bytes available for each message's arguments (strings included)
+#define EKTraceMaxStringLength          128     // Longer strings get cut off
+
+// Levels
+#define EKTraceLevelError               0
+#define EKTraceLevelWarning             1
+#define EKTraceLevelInfo                2
+#define EKTraceLevelDebug               3
+#define EKTraceLevelVerbose             4       // Things that happen every command or every frame
+
+// Categories (these can be combined, for EKTraceSetCategories)
+#define EKTraceCategoryGeneral          (1u << 0)
+#define EKTraceCategoryScript           (1u << 1)   // Running scripts (VNRuntime, VNScript)
+#define EKTraceCategoryScene            (1u << 2)   // VNScene modes and effects
+#define EKTraceCategorySprites          (1u << 3)
+#define EKTraceCategorySave             (1u << 4)   // Saving and safe-saves
+#define EKTraceCategoryRecord           (1u << 5)   // EKRecord and saved-game slots
+#define EKTraceCategoryAll              0xFFFFFFFFu
+
+// MARK: - Macros
+
+#if EKTRACE_ENABLED
+    #define EKTrace(level, category, format, ...)                                                   \
+        do {                                                                                        \
+            if( (level) <= EKTRACE_MAX_LEVEL && EKTraceIsEnabled((level), (category)) )             \
+                EKTraceWrite((level), (category), "" format, ##__VA_ARGS__);                        \
+        } while( 0 )
+#else
+    // The arguments still get type-checked (so that variables which are only used for tracing don't cause warnings),
+    // but they're never evaluated, and the whole thing gets optimized away
+    #define EKTrace(level, category, format, ...)                                                   \
+        do {                                                                                        \
+            if( 0 )                                                                                 \
+                EKTraceWrite((level), (category), "" format, ##__VA_ARGS__);                        \
+        } while( 0 )
+#endif
+
+#define EKTraceError(category, format, ...)             EKTrace(EKTraceLevelError, category, format, ##__VA_ARGS__)
+#define EKTraceWarning(category, format, ...)           EKTrace(EKTraceLevelWarning, category, format, ##__VA_ARGS__)
+#define EKTraceInfo(category, format, ...)              EKTrace(EKTraceLevelInfo, category, format, ##__VA_ARGS__)
+#define EKTraceDebug(category, format, ...)             EKTrace(EKTraceLevelDebug, category, format, ##__VA_ARGS__)
+#define EKTraceVerbose(category, format, ...)           EKTrace(EKTraceLevelVerbose, category, format, ##__VA_ARGS__)
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only messages at or below this level get written. The default is EKTraceLevelDebug, so verbose messages are
+// compiled in but skipped (which just costs a function call) until they're turned on.
+void EKTraceSetLevel(int level);
+int EKTraceLevel(void);
+
+// Only messages in these categories get written. The default is EKTraceCategoryAll.
+void EKTraceSetCategories(uint32_t categories);
+
+int EKTraceIsEnabled(int level, uint32_t category);
+
+// Use the macros instead of calling this directly (the format string has to stay valid forever)
+void EKTraceWrite(int level, uint32_t category, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+// When echo is on, each message is also formatted and written to stderr as soon as it's traced (like NSLog would),
+// which is handy while debugging something specific. It's off by default.
+void EKTraceSetEcho(int shouldEcho);
+
+// Formats every message in the buffer (oldest first) and writes them to a file descriptor (such as STDERR_FILENO).
+// This doesn't allocate memory or take any locks, so it can be called from a signal handler. Messages that are being
+// written at the same moment are skipped. Returns the number of messages written.
+size_t EKTraceDump(int fileDescriptor);
+size_t EKTraceDumpToFile(const char* path); // Overwrites the file
+
+// Total number of messages written since the app started (including ones that have been overwritten)
+uint64_t EKTraceMessageCount(void);
+
+// Messages that were thrown out because the buffer wrapped around while another thread was still writing to the same
+// slot. This should stay at zero unless threads are tracing a lot at once.
+uint64_t EKTraceDroppedMessageCount(void);
+
+void EKTraceClear(void);
+
+// Dumps the buffer to a file if the app crashes (on SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT or SIGTRAP), and then
+// lets the crash carry on as usual. The path is copied. Returns 0 if the handlers couldn't be installed.
+int EKTraceInstallCrashHandler(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+//
+//  VNAssetCache.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNAssetCache
+
+ Keeps the images and sounds that a scene is about to use, already loaded and decoded. Normally, VNScene loads a
+ sprite, background, speechbox or choice button from its file at the exact moment that the script gets to it (and
+ music the same way), so a scene change that brings in a new background and a couple of characters can take long
+ enough to drop frames. VNScene looks a little way ahead in the script (see 'prefetchUpcomingAssets') and asks the
+ cache to prefetch whatever's coming up; the files get loaded on a background queue, and by the time the script
+ actually gets there, the command just picks up the finished texture or sound:
+
+   [[VNAssetCache sharedCache] prefetchTextureNamed:@"bg-park.png"];
+   ...
+   SKTexture* texture = [[VNAssetCache sharedCache] textureNamed:@"bg-park.png"]; // Already loaded
+
+ Anything that isn't in the cache yet (because it wasn't prefetched, or got thrown out) just gets loaded right away,
+ the way it would have been without the cache. If the prefetch queue is in the middle of loading it, the cache waits a
+ moment for that to finish instead of loading the same file a second time.
+
+ Textures and sound effects stay in the cache after they're used, since scenes tend to use the same ones over and
+ over. Music players can only play one thing at a time, so a prefetched music player is handed over to whoever asks
+ for it (and removed from the cache).
+
+ Everything here can be called from any thread.
+
+ */
+
+#import <SpriteKit/SpriteKit.h>
+@import AVFoundation;
+
+#pragma mark - Definitions
+
+#define VNAssetCacheDefaultBudget       (48 * 1024 * 1024) // Size (in bytes) of the decoded assets the cache holds on to
+
+#pragma mark - VNAssetCache
+
+@interface VNAssetCache : NSObject
+
++ (VNAssetCache*)sharedCache;
+
+// When this is NO, nothing gets prefetched and every asset is loaded from its file when it's needed. The default is YES.
+@property (atomic) BOOL enabled;
+
+// The cache uses up to this much memory (textures and sound effects are counted at their decoded size, and music at
+// its file size, since music players only decode a little at a time).
+// Assets that haven't been used recently may be thrown out to stay under the budget (or when the system is low on
+// memory), in which case they just get loaded again the next time they're needed.
+@property (nonatomic) NSUInteger budget;
+
+// Counters, mostly for checking that prefetching is actually doing something. A "hit" is an asset that was already
+// loaded when it was asked for, and a "miss" is one that had to be loaded right then.
+@property (atomic, readonly) NSUInteger hitCount;
+@property (atomic, readonly) NSUInteger missCount;
+@property (atomic, readonly) NSUInteger prefetchCount; // Assets loaded in the background
+
+// These return the asset from the cache, or load it right away if it isn't there (or if the cache is turned off)
+- (SKTexture*)textureNamed:(NSString*)filename;
+- (AVAudioPCMBuffer*)soundEffectNamed:(NSString*)filename; // The whole sound, already decoded (play it with an AVAudioPlayerNode)
+- (AVAudioPlayer*)musicPlayerNamed:(NSString*)filename; // The player is removed from the cache
+
+// Loads assets into the cache on a background queue. Assets that are already in the cache (or on their way) are skipped.
+- (void)prefetchTextureNamed:(NSString*)filename;
+- (void)prefetchSoundEffectNamed:(NSString*)filename;
+- (void)prefetchMusicNamed:(NSString*)filename;
+
+- (void)resetCounters;
+- (void)removeAllAssets;
+
+@end
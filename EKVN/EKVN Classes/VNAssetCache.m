@@ -0,0 +1,339 @@
+//
+//  VNAssetCache.m
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#import "VNAssetCache.h"
+#import "EKUtils.h"
+#import "EKTrace.h"
+
+// Each kind of asset gets its own prefix, so that an image and a sound with the same name don't get mixed up
+#define VNAssetCacheTexturePrefix       @"texture:"
+#define VNAssetCacheSoundEffectPrefix   @"sound:"
+#define VNAssetCacheMusicPrefix         @"music:"
+
+#define VNAssetCacheBytesPerPixel       4
+#define VNAssetCachePreloadTimeout      1.0 // Longest a prefetch waits (in seconds) for a texture to finish preloading
+#define VNAssetCachePrefetchWaitTime    0.25 // Longest a lookup waits (in seconds) for a prefetch that's already loading the asset
+
+@implementation VNAssetCache
+{
+    NSCache* assets;                // Cache key -> SKTexture, AVAudioPCMBuffer or AVAudioPlayer
+    NSMutableSet* pendingKeys;      // Keys of assets that are being prefetched right now (or are queued up to be)
+    NSString* loadingKey;           // Key of the asset that the prefetch queue is loading at the moment
+    NSCondition* prefetchCondition; // Guards the two above, and gets signalled when a prefetch finishes
+    dispatch_queue_t prefetchQueue;
+    CGFloat screenScale;            // Textures are sized in points, but take up memory in pixels
+}
+
++ (VNAssetCache*)sharedCache
+{
+    static dispatch_once_t pred = 0;
+    __strong static id _sharedObject = nil;
+    dispatch_once(&pred, ^{
+        _sharedObject = [[VNAssetCache alloc] init];
+    });
+    return _sharedObject;
+}
+
+- (id)init
+{
+    if( (self = [super init]) ) {
+
+        assets = [[NSCache alloc] init];
+        assets.name = @"VNAssetCache";
+        assets.totalCostLimit = VNAssetCacheDefaultBudget;
+
+        pendingKeys = [[NSMutableSet alloc] init];
+        prefetchCondition = [[NSCondition alloc] init];
+        screenScale = [[UIScreen mainScreen] scale];
+
+        // Prefetching is for assets that the script is about to use, but it shouldn't get in the way of the scene itself
+        dispatch_queue_attr_t attributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+        prefetchQueue = dispatch_queue_create("VNAssetCache prefetch", attributes);
+
+        _enabled = YES;
+        _budget = VNAssetCacheDefaultBudget;
+    }
+
+    return self;
+}
+
+- (void)setBudget:(NSUInteger)budget
+{
+    _budget = budget;
+    assets.totalCostLimit = budget;
+}
+
+#pragma mark - Loading
+
+// These do the actual loading (on whichever thread they're called from) and work out how much memory the asset takes up
+
+- (SKTexture*)loadTextureNamed:(NSString*)filename cost:(NSUInteger*)cost
+{
+    SKTexture* texture = [SKTexture textureWithImageNamed:filename];
+    if( texture == nil )
+        return nil;
+
+    CGSize size = texture.size;
+    *cost = (NSUInteger)(size.width * screenScale) * (NSUInteger)(size.height * screenScale) * VNAssetCacheBytesPerPixel;
+    return texture;
+}
+
+- (NSUInteger)fileSizeOfSoundNamed:(NSString*)filename
+{
+    NSURL* url = EKStringURLFromFilename(filename);
+    if( url == nil )
+        return 0;
+
+    NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[url path] error:nil];
+    return (NSUInteger)[attributes fileSize];
+}
+
+// Sound effects are short, so the whole file gets decoded into a buffer (which, unlike a player, can be played any number
+// of times, even all at once)
+- (AVAudioPCMBuffer*)loadSoundEffectNamed:(NSString*)filename cost:(NSUInteger*)cost
+{
+    NSURL* url = EKStringURLFromFilename(filename);
+    if( url == nil )
+        return nil;
+
+    NSError* error = nil;
+    AVAudioFile* file = [[AVAudioFile alloc] initForReading:url error:&error];
+    if( file == nil || file.length <= 0 ) {
+        NSLog(@"[VNAssetCache] ERROR: Cannot open sound effect %@: %@", filename, error);
+        return nil;
+    }
+
+    AVAudioPCMBuffer* buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:file.processingFormat frameCapacity:(AVAudioFrameCount)file.length];
+    if( buffer == nil || [file readIntoBuffer:buffer error:&error] == NO ) {
+        NSLog(@"[VNAssetCache] ERROR: Cannot decode sound effect %@: %@", filename, error);
+        return nil;
+    }
+
+    // Non-interleaved formats describe a single channel's frames, and keep a separate buffer for each channel
+    AVAudioFormat* format = buffer.format;
+    NSUInteger buffersPerFrame = format.isInterleaved ? 1 : format.channelCount;
+    *cost = (NSUInteger)buffer.frameLength * format.streamDescription->mBytesPerFrame * buffersPerFrame;
+    return buffer;
+}
+
+- (AVAudioPlayer*)loadMusicNamed:(NSString*)filename cost:(NSUInteger*)cost
+{
+    AVAudioPlayer* player = EKAudioSoundFromFile(filename);
+    [player prepareToPlay]; // Gets the audio buffers ready, so that 'play' can start right away
+    *cost = [self fileSizeOfSoundNamed:filename];
+    return player;
+}
+
+#pragma mark - Assets
+
+// If the prefetch queue is loading this asset right now, waits (briefly) for it to finish, since that's usually quicker
+// than starting over and loading the same file twice. Assets that are only queued up get loaded by the caller instead,
+// and the prefetch skips them once it finds them in the cache.
+- (void)waitForPrefetchOfKey:(NSString*)key
+{
+    if( [assets objectForKey:key] != nil )
+        return;
+
+    NSDate* deadline = [NSDate dateWithTimeIntervalSinceNow:VNAssetCachePrefetchWaitTime];
+
+    [prefetchCondition lock];
+    while( [loadingKey isEqualToString:key] ) {
+        if( [prefetchCondition waitUntilDate:deadline] == NO ) {
+            EKTraceDebug(EKTraceCategoryScene, "Gave up waiting for the prefetch of %s", [key UTF8String]);
+            break;
+        }
+    }
+    [prefetchCondition unlock];
+}
+
+// Looks up an asset, and counts it as a hit or a miss
+- (id)cachedAssetForKey:(NSString*)key remove:(BOOL)shouldRemove
+{
+    id asset = [assets objectForKey:key];
+    if( asset != nil && shouldRemove )
+        [assets removeObjectForKey:key];
+
+    @synchronized( self ) {
+        if( asset != nil )
+            _hitCount++;
+        else
+            _missCount++;
+    }
+
+    EKTraceVerbose(EKTraceCategoryScene, "Asset cache %s: %s", (asset != nil) ? "hit" : "miss", [key UTF8String]);
+    return asset;
+}
+
+- (SKTexture*)textureNamed:(NSString*)filename
+{
+    if( filename == nil )
+        return nil;
+
+    NSUInteger cost = 0;
+    if( self.enabled == NO )
+        return [self loadTextureNamed:filename cost:&cost];
+
+    NSString* key = [VNAssetCacheTexturePrefix stringByAppendingString:filename];
+    [self waitForPrefetchOfKey:key];
+    SKTexture* texture = [self cachedAssetForKey:key remove:NO];
+    if( texture == nil ) {
+        texture = [self loadTextureNamed:filename cost:&cost];
+        if( texture != nil )
+            [assets setObject:texture forKey:key cost:cost];
+    }
+
+    return texture;
+}
+
+- (AVAudioPCMBuffer*)soundEffectNamed:(NSString*)filename
+{
+    if( filename == nil )
+        return nil;
+
+    NSUInteger cost = 0;
+    if( self.enabled == NO )
+        return [self loadSoundEffectNamed:filename cost:&cost];
+
+    NSString* key = [VNAssetCacheSoundEffectPrefix stringByAppendingString:filename];
+    [self waitForPrefetchOfKey:key];
+    AVAudioPCMBuffer* buffer = [self cachedAssetForKey:key remove:NO];
+    if( buffer == nil ) {
+        buffer = [self loadSoundEffectNamed:filename cost:&cost];
+        if( buffer != nil )
+            [assets setObject:buffer forKey:key cost:cost];
+    }
+
+    return buffer;
+}
+
+- (AVAudioPlayer*)musicPlayerNamed:(NSString*)filename
+{
+    if( filename == nil )
+        return nil;
+
+    NSUInteger cost = 0;
+    if( self.enabled == NO )
+        return [self loadMusicNamed:filename cost:&cost];
+
+    // Players aren't shared, so one that gets loaded here doesn't go into the cache
+    NSString* key = [VNAssetCacheMusicPrefix stringByAppendingString:filename];
+    [self waitForPrefetchOfKey:key];
+    AVAudioPlayer* player = [self cachedAssetForKey:key remove:YES];
+    if( player == nil )
+        player = [self loadMusicNamed:filename cost:&cost];
+
+    return player;
+}
+
+#pragma mark - Prefetching
+
+// Runs the loader on the prefetch queue, unless the asset is already in the cache or already being prefetched
+- (void)prefetchAssetForKey:(NSString*)key loader:(id (^)(NSUInteger* cost))loader
+{
+    if( self.enabled == NO || [assets objectForKey:key] != nil )
+        return;
+
+    [prefetchCondition lock];
+    BOOL alreadyPending = [pendingKeys containsObject:key];
+    if( alreadyPending == NO )
+        [pendingKeys addObject:key];
+    [prefetchCondition unlock];
+
+    if( alreadyPending )
+        return;
+
+    dispatch_async(prefetchQueue, ^{
+
+        [prefetchCondition lock];
+        loadingKey = key;
+        [prefetchCondition unlock];
+
+        @autoreleasepool {
+
+            // The asset might have been needed (and loaded) while this prefetch was still waiting its turn
+            if( [assets objectForKey:key] == nil ) {
+
+                NSUInteger cost = 0;
+                id asset = loader(&cost);
+                if( asset != nil ) {
+                    [assets setObject:asset forKey:key cost:cost];
+
+                    @synchronized( self ) {
+                        _prefetchCount++;
+                    }
+                    EKTraceDebug(EKTraceCategoryScene, "Prefetched %s (%lu bytes)", [key UTF8String], (unsigned long)cost);
+                }
+            }
+        }
+
+        [prefetchCondition lock];
+        loadingKey = nil;
+        [pendingKeys removeObject:key];
+        [prefetchCondition broadcast];
+        [prefetchCondition unlock];
+    });
+}
+
+- (void)prefetchTextureNamed:(NSString*)filename
+{
+    if( filename == nil )
+        return;
+
+    [self prefetchAssetForKey:[VNAssetCacheTexturePrefix stringByAppendingString:filename] loader:^id(NSUInteger* cost) {
+
+        SKTexture* texture = [self loadTextureNamed:filename cost:cost];
+        if( texture == nil )
+            return nil;
+
+        // Decoding the image (and uploading it) happens here, instead of the first time the texture gets drawn. If the
+        // preload takes too long (or never finishes), the texture goes into the cache anyway so that the rest of the
+        // prefetches don't get held up; at worst, it gets decoded when it's first drawn, like it would without the cache.
+        dispatch_semaphore_t preloaded = dispatch_semaphore_create(0);
+        [texture preloadWithCompletionHandler:^{
+            dispatch_semaphore_signal(preloaded);
+        }];
+        if( dispatch_semaphore_wait(preloaded, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(VNAssetCachePreloadTimeout * NSEC_PER_SEC))) != 0 )
+            EKTraceInfo(EKTraceCategoryScene, "Timed out while preloading %s", [filename UTF8String]);
+
+        return texture;
+    }];
+}
+
+- (void)prefetchSoundEffectNamed:(NSString*)filename
+{
+    if( filename == nil )
+        return;
+
+    [self prefetchAssetForKey:[VNAssetCacheSoundEffectPrefix stringByAppendingString:filename] loader:^id(NSUInteger* cost) {
+        return [self loadSoundEffectNamed:filename cost:cost];
+    }];
+}
+
+- (void)prefetchMusicNamed:(NSString*)filename
+{
+    if( filename == nil )
+        return;
+
+    [self prefetchAssetForKey:[VNAssetCacheMusicPrefix stringByAppendingString:filename] loader:^id(NSUInteger* cost) {
+        return [self loadMusicNamed:filename cost:cost];
+    }];
+}
+
+- (void)resetCounters
+{
+    @synchronized( self ) {
+        _hitCount = 0;
+        _missCount = 0;
+        _prefetchCount = 0;
+    }
+}
+
+- (void)removeAllAssets
+{
+    [assets removeAllObjects];
+}
+
+@end
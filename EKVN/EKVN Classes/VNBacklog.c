@@ -0,0 +1,433 @@
+//
+//  VNBacklog.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNBacklog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VNBacklogInitialBuckets     64      // Must be a power of two
+#define VNBacklogHeaderSize         24      // Magic, version, position (64 bits), name count, entry count
+#define VNBacklogEntrySize          12
+#define VNBacklogMaxNameLength      (64 * 1024)
+
+// Encoded backlogs look like this (everything is little-endian):
+//
+//   uint32 magic, uint32 version, uint64 position, uint32 name count, uint32 entry count
+//   for each name: uint32 length, bytes
+//   for each entry (oldest first): uint32 speaker, uint32 source, uint32 line
+//
+// Names are numbered in the order that they're stored in, which usually isn't the same as in the backlog that was
+// encoded (only the names that the encoded entries use are stored).
+
+typedef struct {
+    char* bytes;
+    uint32_t length;
+    uint32_t hash;
+} VNBacklogName_;
+
+struct VNBacklog {
+    VNBacklogEntry* entries;    // Ring buffer
+    uint32_t capacity;
+    uint32_t first;
+    uint32_t count;
+    uint64_t position;
+
+    VNBacklogName_* names;
+    uint32_t nameCount;
+    uint32_t nameCapacity;
+    uint32_t* buckets;          // Name number plus one (zero for an empty bucket)
+    uint32_t bucketCount;
+};
+
+// MARK: - Names
+
+static uint32_t VNBacklogHash(const char* bytes, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for( size_t i = 0; i < length; i++ ) {
+        hash ^= (uint8_t)bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static int VNBacklogRehash(VNBacklog* backlog, uint32_t bucketCount)
+{
+    uint32_t* buckets = calloc(bucketCount, sizeof(uint32_t));
+    if( buckets == NULL )
+        return 0;
+
+    for( uint32_t i = 0; i < backlog->nameCount; i++ ) {
+        uint32_t bucket = backlog->names[i].hash & (bucketCount - 1);
+        while( buckets[bucket] != 0 )
+            bucket = (bucket + 1) & (bucketCount - 1);
+        buckets[bucket] = i + 1;
+    }
+
+    free(backlog->buckets);
+    backlog->buckets = buckets;
+    backlog->bucketCount = bucketCount;
+    return 1;
+}
+
+uint32_t VNBacklogInternName(VNBacklog* backlog, const char* name, size_t length)
+{
+    if( backlog == NULL || (name == NULL && length > 0) || length > VNBacklogMaxNameLength )
+        return VNBacklogNoName;
+
+    uint32_t hash = VNBacklogHash(name, length);
+    uint32_t bucket = hash & (backlog->bucketCount - 1);
+
+    while( backlog->buckets[bucket] != 0 ) {
+        const VNBacklogName_* existing = &backlog->names[backlog->buckets[bucket] - 1];
+        if( existing->hash == hash && existing->length == length && memcmp(existing->bytes, name, length) == 0 )
+            return backlog->buckets[bucket] - 1;
+
+        bucket = (bucket + 1) & (backlog->bucketCount - 1);
+    }
+
+    // Keep the hash table no more than half full
+    if( (backlog->nameCount + 1) * 2 > backlog->bucketCount ) {
+        if( VNBacklogRehash(backlog, backlog->bucketCount * 2) == 0 )
+            return VNBacklogNoName;
+
+        bucket = hash & (backlog->bucketCount - 1);
+        while( backlog->buckets[bucket] != 0 )
+            bucket = (bucket + 1) & (backlog->bucketCount - 1);
+    }
+
+    if( backlog->nameCount == backlog->nameCapacity ) {
+        uint32_t capacity = (backlog->nameCapacity > 0) ? backlog->nameCapacity * 2 : 16;
+        VNBacklogName_* names = realloc(backlog->names, capacity * sizeof(VNBacklogName_));
+        if( names == NULL )
+            return VNBacklogNoName;
+
+        backlog->names = names;
+        backlog->nameCapacity = capacity;
+    }
+
+    char* bytes = malloc(length > 0 ? length : 1);
+    if( bytes == NULL )
+        return VNBacklogNoName;
+    if( length > 0 )
+        memcpy(bytes, name, length);
+
+    uint32_t number = backlog->nameCount++;
+    backlog->names[number].bytes = bytes;
+    backlog->names[number].length = (uint32_t)length;
+    backlog->names[number].hash = hash;
+    backlog->buckets[bucket] = number + 1;
+    return number;
+}
+
+uint32_t VNBacklogInternSource(VNBacklog* backlog, const char* scriptName, const char* conversationName)
+{
+    if( scriptName == NULL || conversationName == NULL )
+        return VNBacklogNoName;
+
+    size_t scriptLength = strlen(scriptName);
+    size_t conversationLength = strlen(conversationName);
+    size_t length = scriptLength + 1 + conversationLength;
+    if( length > VNBacklogMaxNameLength )
+        return VNBacklogNoName;
+
+    char* source = malloc(length);
+    if( source == NULL )
+        return VNBacklogNoName;
+
+    memcpy(source, scriptName, scriptLength);
+    source[scriptLength] = '\0';
+    memcpy(source + scriptLength + 1, conversationName, conversationLength);
+
+    uint32_t number = VNBacklogInternName(backlog, source, length);
+    free(source);
+    return number;
+}
+
+const char* VNBacklogName(const VNBacklog* backlog, uint32_t name, size_t* outLength)
+{
+    if( backlog == NULL || name >= backlog->nameCount )
+        return NULL;
+
+    if( outLength != NULL )
+        *outLength = backlog->names[name].length;
+
+    return backlog->names[name].bytes;
+}
+
+// MARK: - Entries
+
+VNBacklog* VNBacklogCreate(uint32_t capacity)
+{
+    if( capacity == 0 )
+        return NULL;
+
+    VNBacklog* backlog = calloc(1, sizeof(VNBacklog));
+    if( backlog == NULL )
+        return NULL;
+
+    backlog->entries = malloc(capacity * sizeof(VNBacklogEntry));
+    backlog->capacity = capacity;
+
+    if( backlog->entries == NULL || VNBacklogRehash(backlog, VNBacklogInitialBuckets) == 0 ) {
+        VNBacklogFree(backlog);
+        return NULL;
+    }
+
+    return backlog;
+}
+
+void VNBacklogFree(VNBacklog* backlog)
+{
+    if( backlog == NULL )
+        return;
+
+    for( uint32_t i = 0; i < backlog->nameCount; i++ )
+        free(backlog->names[i].bytes);
+
+    free(backlog->names);
+    free(backlog->buckets);
+    free(backlog->entries);
+    free(backlog);
+}
+
+void VNBacklogAppend(VNBacklog* backlog, uint32_t speaker, uint32_t source, uint32_t line)
+{
+    if( backlog == NULL )
+        return;
+
+    VNBacklogEntry* entry = &backlog->entries[(backlog->first + backlog->count) % backlog->capacity];
+    if( backlog->count == backlog->capacity )
+        backlog->first = (backlog->first + 1) % backlog->capacity; // The oldest line gets overwritten
+    else
+        backlog->count++;
+
+    entry->speaker = speaker;
+    entry->source = source;
+    entry->line = line;
+    backlog->position++;
+}
+
+uint32_t VNBacklogCount(const VNBacklog* backlog)
+{
+    return (backlog != NULL) ? backlog->count : 0;
+}
+
+uint32_t VNBacklogCapacity(const VNBacklog* backlog)
+{
+    return (backlog != NULL) ? backlog->capacity : 0;
+}
+
+const VNBacklogEntry* VNBacklogEntryAt(const VNBacklog* backlog, uint32_t index)
+{
+    if( backlog == NULL || index >= backlog->count )
+        return NULL;
+
+    return &backlog->entries[(backlog->first + index) % backlog->capacity];
+}
+
+uint64_t VNBacklogPosition(const VNBacklog* backlog)
+{
+    return (backlog != NULL) ? backlog->position : 0;
+}
+
+void VNBacklogRewindTo(VNBacklog* backlog, uint64_t position)
+{
+    if( backlog == NULL || position >= backlog->position )
+        return;
+
+    uint64_t removed = backlog->position - position;
+    backlog->count = (removed < backlog->count) ? backlog->count - (uint32_t)removed : 0;
+    backlog->position = position;
+}
+
+// Names are kept, since they're probably going to be used again
+void VNBacklogClear(VNBacklog* backlog)
+{
+    if( backlog == NULL )
+        return;
+
+    backlog->first = 0;
+    backlog->count = 0;
+}
+
+// MARK: - Encoding
+
+static void VNBacklogWrite32(uint8_t* buffer, uint32_t value)
+{
+    for( int i = 0; i < 4; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static void VNBacklogWrite64(uint8_t* buffer, uint64_t value)
+{
+    for( int i = 0; i < 8; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint32_t VNBacklogRead32(const uint8_t* buffer)
+{
+    uint32_t value = 0;
+    for( int i = 0; i < 4; i++ )
+        value |= (uint32_t)buffer[i] << (i * 8);
+    return value;
+}
+
+static uint64_t VNBacklogRead64(const uint8_t* buffer)
+{
+    uint64_t value = 0;
+    for( int i = 0; i < 8; i++ )
+        value |= (uint64_t)buffer[i] << (i * 8);
+    return value;
+}
+
+// Gives a new number to a name that's used by an encoded entry (the numbers are stored in 'renumbered', plus one)
+static uint32_t VNBacklogRenumber(uint32_t name, uint32_t* renumbered, uint32_t* usedCount)
+{
+    if( renumbered == NULL || name == VNBacklogNoName )
+        return VNBacklogNoName;
+
+    if( renumbered[name] == 0 )
+        renumbered[name] = ++(*usedCount);
+
+    return renumbered[name] - 1;
+}
+
+size_t VNBacklogEncode(const VNBacklog* backlog, uint32_t maxEntries, uint8_t* buffer, size_t capacity)
+{
+    if( backlog == NULL )
+        return 0;
+
+    uint32_t entryCount = (backlog->count < maxEntries) ? backlog->count : maxEntries;
+    uint32_t firstEntry = backlog->count - entryCount;
+
+    uint32_t* renumbered = calloc(backlog->nameCount > 0 ? backlog->nameCount : 1, sizeof(uint32_t));
+    if( renumbered == NULL )
+        return 0;
+
+    // Work out which names get stored (in the order the entries use them)
+    uint32_t usedCount = 0;
+    size_t size = VNBacklogHeaderSize + ((size_t)entryCount * VNBacklogEntrySize);
+    for( uint32_t i = firstEntry; i < backlog->count; i++ ) {
+
+        const VNBacklogEntry* entry = VNBacklogEntryAt(backlog, i);
+        uint32_t names[2] = { entry->speaker, entry->source };
+
+        for( int j = 0; j < 2; j++ ) {
+            if( names[j] < backlog->nameCount && renumbered[names[j]] == 0 ) {
+                VNBacklogRenumber(names[j], renumbered, &usedCount);
+                size += 4 + backlog->names[names[j]].length;
+            }
+        }
+    }
+
+    if( buffer == NULL || capacity < size ) {
+        free(renumbered);
+        return size;
+    }
+
+    VNBacklogWrite32(buffer, VNBacklogMagic);
+    VNBacklogWrite32(buffer + 4, VNBacklogVersion);
+    VNBacklogWrite64(buffer + 8, backlog->position);
+    VNBacklogWrite32(buffer + 16, usedCount);
+    VNBacklogWrite32(buffer + 20, entryCount);
+    uint8_t* position = buffer + VNBacklogHeaderSize;
+
+    // Names go in the order of their new numbers
+    for( uint32_t number = 1; number <= usedCount; number++ ) {
+        for( uint32_t name = 0; name < backlog->nameCount; name++ ) {
+
+            if( renumbered[name] != number )
+                continue;
+
+            VNBacklogWrite32(position, backlog->names[name].length);
+            memcpy(position + 4, backlog->names[name].bytes, backlog->names[name].length);
+            position += 4 + backlog->names[name].length;
+            break;
+        }
+    }
+
+    for( uint32_t i = firstEntry; i < backlog->count; i++ ) {
+
+        const VNBacklogEntry* entry = VNBacklogEntryAt(backlog, i);
+        VNBacklogWrite32(position, (entry->speaker < backlog->nameCount) ? renumbered[entry->speaker] - 1 : VNBacklogNoName);
+        VNBacklogWrite32(position + 4, (entry->source < backlog->nameCount) ? renumbered[entry->source] - 1 : VNBacklogNoName);
+        VNBacklogWrite32(position + 8, entry->line);
+        position += VNBacklogEntrySize;
+    }
+
+    free(renumbered);
+    return size;
+}
+
+VNBacklog* VNBacklogDecode(const uint8_t* data, size_t length, uint32_t capacity)
+{
+    if( data == NULL || length < VNBacklogHeaderSize )
+        return NULL;
+
+    if( VNBacklogRead32(data) != VNBacklogMagic ) {
+        fprintf(stderr, "[VNBacklog] ERROR: Data is not a backlog.\n");
+        return NULL;
+    }
+    if( VNBacklogRead32(data + 4) != VNBacklogVersion ) {
+        fprintf(stderr, "[VNBacklog] ERROR: Unsupported backlog version: %u\n", VNBacklogRead32(data + 4));
+        return NULL;
+    }
+
+    VNBacklog* backlog = VNBacklogCreate(capacity);
+    if( backlog == NULL )
+        return NULL;
+
+    uint64_t position = VNBacklogRead64(data + 8);
+    uint32_t nameCount = VNBacklogRead32(data + 16);
+    uint32_t entryCount = VNBacklogRead32(data + 20);
+    size_t offset = VNBacklogHeaderSize;
+
+    for( uint32_t i = 0; i < nameCount; i++ ) {
+
+        if( length - offset < 4 )
+            goto corrupt;
+        uint32_t nameLength = VNBacklogRead32(data + offset);
+        offset += 4;
+        if( nameLength > VNBacklogMaxNameLength || length - offset < nameLength )
+            goto corrupt;
+
+        // Every name should be different, so each one should get the next number
+        uint32_t number = VNBacklogInternName(backlog, (const char*)(data + offset), nameLength);
+        if( number == VNBacklogNoName )
+            goto failed;
+        if( number != i )
+            goto corrupt;
+
+        offset += nameLength;
+    }
+
+    if( (length - offset) / VNBacklogEntrySize < entryCount || position < entryCount )
+        goto corrupt;
+
+    for( uint32_t i = 0; i < entryCount; i++ ) {
+
+        uint32_t speaker = VNBacklogRead32(data + offset);
+        uint32_t source = VNBacklogRead32(data + offset + 4);
+        if( (speaker != VNBacklogNoName && speaker >= nameCount) || (source != VNBacklogNoName && source >= nameCount) )
+            goto corrupt;
+
+        VNBacklogAppend(backlog, speaker, source, VNBacklogRead32(data + offset + 8));
+        offset += VNBacklogEntrySize;
+    }
+
+    backlog->position = position;
+    return backlog;
+
+corrupt:
+    fprintf(stderr, "[VNBacklog] ERROR: Backlog data is corrupt.\n");
+failed:
+    VNBacklogFree(backlog);
+    return NULL;
+}
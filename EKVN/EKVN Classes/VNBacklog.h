@@ -0,0 +1,95 @@
+//
+//  VNBacklog.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNBacklog
+
+ The dialogue "backlog": the lines that the player has already seen, so that they can scroll back and read them again.
+ It's a ring with a fixed capacity, so once it's full, each new line pushes out the oldest one, and the backlog never
+ grows during a long session.
+
+ Entries don't hold any text. Each one just says who was speaking, and where the line came from (a script, a
+ conversation in that script, and the line's index in that conversation), so the text can be looked up in the script
+ when it's actually needed (like when the line scrolls into view). Speaker names and script/conversation names are
+ only stored once each, and entries refer to them by number; that keeps each entry down to 12 bytes.
+
+ The newest entries can be encoded into a compact binary format (and decoded again) so that the backlog can be kept in
+ a saved game. The backlog isn't thread-safe; it's meant to be used from the main thread.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNBacklog_h
+#define VNBacklog_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNBacklogNoName                 UINT32_MAX
+#define VNBacklogMagic                  0x4C424E56  // "VNBL" (little-endian)
+#define VNBacklogVersion                1
+
+typedef struct {
+    uint32_t speaker;   // Name number of the speaker (VNBacklogNoName if nobody was speaking)
+    uint32_t source;    // Name number of the script and conversation (see VNBacklogInternSource)
+    uint32_t line;      // Index of the line in that conversation
+} VNBacklogEntry;
+
+typedef struct VNBacklog VNBacklog;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+VNBacklog* VNBacklogCreate(uint32_t capacity);
+void VNBacklogFree(VNBacklog* backlog);
+
+// Returns the number for a name (adding the name if it isn't there yet), or VNBacklogNoName if there wasn't enough memory
+uint32_t VNBacklogInternName(VNBacklog* backlog, const char* name, size_t length);
+
+// Sources are stored as names too: the script name, a zero byte, and then the conversation name
+uint32_t VNBacklogInternSource(VNBacklog* backlog, const char* scriptName, const char* conversationName);
+
+// Returns a name (which might have zero bytes in it, for sources), or NULL if there's no such name
+const char* VNBacklogName(const VNBacklog* backlog, uint32_t name, size_t* outLength);
+
+// Adds a line to the backlog. If the backlog is full, the oldest line is dropped.
+void VNBacklogAppend(VNBacklog* backlog, uint32_t speaker, uint32_t source, uint32_t line);
+
+uint32_t VNBacklogCount(const VNBacklog* backlog);
+uint32_t VNBacklogCapacity(const VNBacklog* backlog);
+
+// Entry zero is the oldest line. Returns NULL if there's no such entry.
+const VNBacklogEntry* VNBacklogEntryAt(const VNBacklog* backlog, uint32_t index);
+
+// How many lines have ever been added (including ones that have been dropped since). This is the "position" of the
+// next line, and it's what VNBacklogRewindTo takes.
+uint64_t VNBacklogPosition(const VNBacklog* backlog);
+
+// Removes every line at (or after) a position, like when the scene gets rewound to an earlier line
+void VNBacklogRewindTo(VNBacklog* backlog, uint64_t position);
+void VNBacklogClear(VNBacklog* backlog);
+
+// Encodes (at most) the newest 'maxEntries' lines, along with just the names that they use, and returns the number of
+// bytes used. If the buffer is NULL (or too small), nothing is written and the size that the buffer needs to be is
+// returned instead.
+size_t VNBacklogEncode(const VNBacklog* backlog, uint32_t maxEntries, uint8_t* buffer, size_t capacity);
+
+// Creates a backlog from encoded data. Returns NULL if the data isn't a valid backlog. If there are more lines than the
+// capacity, only the newest ones are kept.
+VNBacklog* VNBacklogDecode(const uint8_t* data, size_t length, uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+//
+//  VNBacklogNode.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNBacklogNode
+
+ A scrollable list of the lines of dialogue that have already been shown (the "backlog"), with the speaker's name
+ beside each line. The newest line is at the bottom, and dragging downwards scrolls back to older lines. Tapping
+ without dragging dismisses the list.
+
+ The node doesn't hold on to any text itself; it asks its data source for the speaker and text of a row when that row
+ scrolls into view. Only the rows that are actually on the screen have nodes (and textures) of their own, and those
+ nodes get reused as rows scroll in and out of view, so a long backlog doesn't cost any more memory than a short one.
+ A row only gets a new texture when it's given a different line to show.
+
+ */
+
+#import <SpriteKit/SpriteKit.h>
+#import "DSMultilineLabelNode.h"
+
+@class VNBacklogNode;
+
+#pragma mark - VNBacklogNodeDataSource
+
+@protocol VNBacklogNodeDataSource <NSObject>
+
+// Row zero is the oldest line
+- (NSUInteger)numberOfRowsInBacklogNode:(VNBacklogNode*)backlogNode;
+- (NSString*)backlogNode:(VNBacklogNode*)backlogNode speakerForRow:(NSUInteger)row; // nil if nobody was speaking
+- (NSString*)backlogNode:(VNBacklogNode*)backlogNode textForRow:(NSUInteger)row;
+
+@optional
+- (void)backlogNodeWasTouched:(VNBacklogNode*)backlogNode;
+- (void)backlogNodeWasDismissed:(VNBacklogNode*)backlogNode; // The player tapped without scrolling
+
+@end
+
+#pragma mark - VNBacklogNode
+
+@interface VNBacklogNode : SKSpriteNode
+
+@property (nonatomic, weak) id<VNBacklogNodeDataSource> dataSource;
+@property (nonatomic, readonly) CGFloat rowHeight;
+@property (nonatomic, strong) UIColor* textColor;
+
+// How far (in points) the list has been scrolled back from the newest line. It can't go past the oldest line.
+@property (nonatomic) CGFloat scrollOffset;
+
+// The node's anchor point is its bottom-left corner
+- (id)initWithSize:(CGSize)size rowHeight:(CGFloat)rowHeight fontName:(NSString*)fontName fontSize:(CGFloat)fontSize;
+
+// Asks the data source for everything again (like after lines were added). Rows that are on the screen get new textures.
+- (void)reloadData;
+- (void)scrollToNewest;
+
+@end
@@ -0,0 +1,239 @@
+//
+//  VNBacklogNode.m
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#import "VNBacklogNode.h"
+
+#define VNBacklogNodeMargin             10.0    // Space (in points) around the list
+#define VNBacklogNodeSpeakerColumn      0.25    // How much of the list's width goes to the speaker's name
+#define VNBacklogNodeTapDistance        10.0    // A touch that moves further than this is a drag, not a tap
+#define VNBacklogNodeNoRow              -1
+
+#pragma mark - VNBacklogRowNode
+
+// One row on the screen. The labels are set up once, and after that only their text changes (which is the only time
+// they get new textures).
+@interface VNBacklogRowNode : SKNode
+
+@property (nonatomic) NSInteger row; // Which row of the backlog this is showing (or VNBacklogNodeNoRow)
+@property (nonatomic, strong) DSMultilineLabelNode* speakerLabel;
+@property (nonatomic, strong) DSMultilineLabelNode* textLabel;
+
+@end
+
+@implementation VNBacklogRowNode
+@end
+
+#pragma mark - VNBacklogNode
+
+@interface VNBacklogNode () {
+
+    SKCropNode* cropNode; // Rows that are only partly on the screen get cut off at the edges of the list
+    NSMutableDictionary* visibleRows; // Row number -> row node
+    NSMutableArray* unusedRows; // Row nodes that aren't showing anything right now
+
+    NSString* fontName;
+    CGFloat fontSize;
+    CGSize listSize;
+    NSUInteger rowCount;
+
+    CGPoint touchStart;
+    BOOL touchIsDragging;
+}
+
+@end
+
+@implementation VNBacklogNode
+
+@synthesize scrollOffset = _scrollOffset;
+
+- (id)initWithSize:(CGSize)size rowHeight:(CGFloat)rowHeight fontName:(NSString*)nameOfFont fontSize:(CGFloat)sizeOfFont
+{
+    if( self = [super initWithColor:[UIColor colorWithWhite:0.0 alpha:0.85] size:size] ) {
+
+        self.anchorPoint = CGPointMake(0, 0);
+        self.userInteractionEnabled = YES;
+
+        _rowHeight = (rowHeight > 1.0) ? rowHeight : 1.0;
+        _textColor = [UIColor whiteColor];
+        fontName = nameOfFont;
+        fontSize = sizeOfFont;
+        listSize = CGSizeMake(MAX(size.width - (VNBacklogNodeMargin * 2), 1.0), MAX(size.height - (VNBacklogNodeMargin * 2), 1.0));
+        visibleRows = [[NSMutableDictionary alloc] init];
+        unusedRows = [[NSMutableArray alloc] init];
+
+        SKSpriteNode* mask = [SKSpriteNode spriteNodeWithColor:[UIColor whiteColor] size:listSize];
+        mask.anchorPoint = CGPointMake(0, 0);
+        cropNode = [[SKCropNode alloc] init];
+        cropNode.maskNode = mask;
+        cropNode.position = CGPointMake(VNBacklogNodeMargin, VNBacklogNodeMargin);
+        [self addChild:cropNode];
+    }
+
+    return self;
+}
+
+- (void)reloadData
+{
+    rowCount = [self.dataSource numberOfRowsInBacklogNode:self];
+
+    // Row numbers may mean different lines now, so every row on the screen has to be filled in again
+    for( VNBacklogRowNode* rowNode in [visibleRows allValues] ) {
+        rowNode.row = VNBacklogNodeNoRow;
+        rowNode.hidden = YES;
+        [unusedRows addObject:rowNode];
+    }
+    [visibleRows removeAllObjects];
+
+    self.scrollOffset = _scrollOffset; // Makes sure the offset is still in range (and lays out the rows)
+}
+
+- (void)scrollToNewest
+{
+    self.scrollOffset = 0.0;
+}
+
+- (CGFloat)maximumScrollOffset
+{
+    return MAX((rowCount * self.rowHeight) - listSize.height, 0.0);
+}
+
+- (void)setScrollOffset:(CGFloat)scrollOffset
+{
+    _scrollOffset = MIN(MAX(scrollOffset, 0.0), [self maximumScrollOffset]);
+    [self layoutRows];
+}
+
+#pragma mark - Rows
+
+- (VNBacklogRowNode*)unusedRowNode
+{
+    VNBacklogRowNode* rowNode = [unusedRows lastObject];
+    if( rowNode != nil ) {
+        [unusedRows removeLastObject];
+        rowNode.hidden = NO;
+        return rowNode;
+    }
+
+    CGFloat speakerWidth = floor(listSize.width * VNBacklogNodeSpeakerColumn);
+
+    rowNode = [[VNBacklogRowNode alloc] init];
+    rowNode.row = VNBacklogNodeNoRow;
+
+    rowNode.speakerLabel = [DSMultilineLabelNode labelNodeWithFontNamed:fontName];
+    rowNode.speakerLabel.fontSize = fontSize;
+    rowNode.speakerLabel.fontColor = self.textColor;
+    rowNode.speakerLabel.paragraphWidth = speakerWidth - VNBacklogNodeMargin;
+    rowNode.speakerLabel.anchorPoint = CGPointMake(0, 1.0);
+    rowNode.speakerLabel.position = CGPointMake(0, self.rowHeight);
+    [rowNode addChild:rowNode.speakerLabel];
+
+    rowNode.textLabel = [DSMultilineLabelNode labelNodeWithFontNamed:fontName];
+    rowNode.textLabel.fontSize = fontSize;
+    rowNode.textLabel.fontColor = self.textColor;
+    rowNode.textLabel.paragraphWidth = listSize.width - speakerWidth;
+    rowNode.textLabel.anchorPoint = CGPointMake(0, 1.0);
+    rowNode.textLabel.position = CGPointMake(speakerWidth, self.rowHeight);
+    [rowNode addChild:rowNode.textLabel];
+
+    [cropNode addChild:rowNode];
+    return rowNode;
+}
+
+// Row 'r' sits (rowCount - 1 - r) rows up from the bottom of the list, and then everything gets moved down by the
+// scroll offset. Only the rows that overlap the list end up with a node.
+- (void)layoutRows
+{
+    if( rowCount == 0 ) {
+        [self reuseRowsOutsideRange:NSMakeRange(0, 0)];
+        return;
+    }
+
+    NSUInteger newestVisible = (NSUInteger)floor(_scrollOffset / self.rowHeight);          // Counted back from the newest row
+    NSUInteger oldestVisible = (NSUInteger)floor((_scrollOffset + listSize.height) / self.rowHeight);
+    newestVisible = MIN(newestVisible, rowCount - 1);
+    oldestVisible = MIN(oldestVisible, rowCount - 1);
+
+    NSRange visibleRange = NSMakeRange(rowCount - 1 - oldestVisible, oldestVisible - newestVisible + 1);
+    [self reuseRowsOutsideRange:visibleRange];
+
+    for( NSUInteger row = visibleRange.location; row < NSMaxRange(visibleRange); row++ ) {
+
+        NSNumber* key = @(row);
+        VNBacklogRowNode* rowNode = [visibleRows objectForKey:key];
+
+        if( rowNode == nil ) {
+
+            rowNode = [self unusedRowNode];
+            rowNode.row = (NSInteger)row;
+
+            NSString* speakerName = [self.dataSource backlogNode:self speakerForRow:row];
+            NSString* text = [self.dataSource backlogNode:self textForRow:row];
+            rowNode.speakerLabel.text = (speakerName.length > 0) ? speakerName : @" ";
+            rowNode.textLabel.text = (text.length > 0) ? text : @" ";
+            [visibleRows setObject:rowNode forKey:key];
+        }
+
+        rowNode.position = CGPointMake(0, ((rowCount - 1 - row) * self.rowHeight) - _scrollOffset);
+    }
+}
+
+- (void)reuseRowsOutsideRange:(NSRange)range
+{
+    for( NSNumber* key in [visibleRows allKeys] ) {
+
+        if( NSLocationInRange([key unsignedIntegerValue], range) )
+            continue;
+
+        VNBacklogRowNode* rowNode = [visibleRows objectForKey:key];
+        rowNode.row = VNBacklogNodeNoRow;
+        rowNode.hidden = YES;
+        [unusedRows addObject:rowNode];
+        [visibleRows removeObjectForKey:key];
+    }
+}
+
+#pragma mark - Touches
+
+- (void)touchesBegan:(NSSet *)touches withEvent:(UIEvent *)event
+{
+    if( [self.dataSource respondsToSelector:@selector(backlogNodeWasTouched:)] )
+        [self.dataSource backlogNodeWasTouched:self];
+
+    UITouch* touch = [touches anyObject];
+    touchStart = [touch locationInNode:self];
+    touchIsDragging = NO;
+}
+
+- (void)touchesMoved:(NSSet *)touches withEvent:(UIEvent *)event
+{
+    if( [self.dataSource respondsToSelector:@selector(backlogNodeWasTouched:)] )
+        [self.dataSource backlogNodeWasTouched:self];
+
+    UITouch* touch = [touches anyObject];
+    CGPoint currentPosition = [touch locationInNode:self];
+    CGPoint previousPosition = [touch previousLocationInNode:self];
+
+    if( hypot(currentPosition.x - touchStart.x, currentPosition.y - touchStart.y) > VNBacklogNodeTapDistance )
+        touchIsDragging = YES;
+
+    // Dragging downwards pulls older lines (which are further up) into view
+    self.scrollOffset = _scrollOffset + (previousPosition.y - currentPosition.y);
+}
+
+- (void)touchesEnded:(NSSet *)touches withEvent:(UIEvent *)event
+{
+    if( touchIsDragging == NO && [self.dataSource respondsToSelector:@selector(backlogNodeWasDismissed:)] )
+        [self.dataSource backlogNodeWasDismissed:self];
+
+    touchIsDragging = NO;
+}
+
+- (void)touchesCancelled:(NSSet *)touches withEvent:(UIEvent *)event
+{
+    touchIsDragging = NO;
+}
+
+@end
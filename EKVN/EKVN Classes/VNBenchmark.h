@@ -0,0 +1,82 @@
+//
+//  VNBenchmark.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNBenchmark
+
+ Microbenchmarks for the parts of the VN system that are CPU-bound (mostly script translation). These only exist
+ in debug builds. Each benchmark logs its results and also returns them in a dictionary, so they can be called
+ from the debugger, from a system call, or from a test harness.
+
+   (lldb) po [VNBenchmark benchmarkCommandDispatchWithLineCount:100000]
+
+ Timings are in seconds, and memory sizes are in bytes.
+
+ */
+
+#import <Foundation/Foundation.h>
+
+#if DEBUG
+
+#define VNBenchmarkLineCountKey                 @"line count"
+#define VNBenchmarkLinearDispatchTimeKey        @"linear dispatch time"     // Old way: compare against each command name in turn
+#define VNBenchmarkHashedDispatchTimeKey        @"hashed dispatch time"     // New way: hash table lookup
+#define VNBenchmarkTranslationTimeKey           @"translation time"         // Full translation with 'prepareScript'
+#define VNBenchmarkSerialTimeKey                @"serial time"              // 'prepareScript' on a single thread
+#define VNBenchmarkParallelTimesKey             @"parallel times"           // Worker count (as a string) -> time
+#define VNBenchmarkSpeedupsKey                  @"speedups"                 // Worker count (as a string) -> serial time / parallel time
+#define VNBenchmarkOutputMatchesKey             @"output matches"           // Whether every parallel result was identical to the serial one
+#define VNBenchmarkBoxedAccessTimeKey           @"boxed access time"        // Reading commands as NSArrays of NSNumber/NSString objects
+#define VNBenchmarkRecordAccessTimeKey          @"record access time"       // Reading commands straight from their records
+#define VNBenchmarkScriptFileSizeKey            @"script file size"
+#define VNBenchmarkStreamingTimeKey             @"streaming time"           // 'prepareScriptFromFile'
+#define VNBenchmarkDictionaryTimeKey            @"dictionary time"          // Loading an NSDictionary, then 'prepareScript'
+#define VNBenchmarkStreamingPeakMemoryKey       @"streaming peak memory"    // Most memory in use (above what was in use beforehand)
+#define VNBenchmarkDictionaryPeakMemoryKey      @"dictionary peak memory"
+#define VNBenchmarkPeakResidentMemoryKey        @"peak resident memory"     // The most memory the whole process has ever used
+#define VNBenchmarkFlagCountKey                 @"flag count"
+#define VNBenchmarkJSONSizeKey                  @"JSON size"                // Pretty-printed (the way records used to be saved)
+#define VNBenchmarkBinarySizeKey                @"binary size"
+#define VNBenchmarkJSONEncodeTimeKey            @"JSON encode time"         // Average of several runs
+#define VNBenchmarkBinaryEncodeTimeKey          @"binary encode time"
+#define VNBenchmarkJSONDecodeTimeKey            @"JSON decode time"
+#define VNBenchmarkBinaryDecodeTimeKey          @"binary decode time"
+
+@interface VNBenchmark : NSObject
+
+// Creates a script dictionary (just like one loaded from a .plist file) filled with a mix of dialogue and commands
++ (NSDictionary*)syntheticScriptWithLineCount:(NSUInteger)lineCount conversations:(NSUInteger)conversationCount;
+
+// Compares the old if/else chain of 'caseInsensitiveCompare' calls with the hash table lookup in VNScriptCommands,
+// and times a full translation of a script with that many lines.
++ (NSDictionary*)benchmarkCommandDispatchWithLineCount:(NSUInteger)lineCount;
+
+// Translates the same synthetic script serially and then with 1, 2, 4... workers (up to the number of active CPU
+// cores), and checks that every parallel translation produces exactly the same script (byte-for-byte, once compiled).
++ (NSDictionary*)benchmarkParallelTranslationWithLineCount:(NSUInteger)lineCount conversations:(NSUInteger)conversationCount;
+
+// Reads every parameter of every command in a translated conversation, first the old way (as NSArray objects, which
+// is what VNScene used to do), and then directly from the command records.
++ (NSDictionary*)benchmarkCommandAccessWithLineCount:(NSUInteger)lineCount;
+
+// Writes a synthetic script to a temporary .plist file and loads it twice: once by streaming it, and once the old way
+// (loading it into an NSDictionary and then translating that). Reports how long each one took and the most memory that
+// was in use while it ran. A 20 MB script has roughly 425,000 lines.
++ (NSDictionary*)benchmarkStreamingLoadWithLineCount:(NSUInteger)lineCount conversations:(NSUInteger)conversationCount;
+
+// Creates a saved-game record (just like one from EKRecord) with that many flags, plus a tenth as many sprite aliases
++ (NSDictionary*)syntheticRecordWithFlagCount:(NSUInteger)flagCount;
+
+// Encodes and decodes the same synthetic record as pretty-printed JSON and as a binary record, and compares their sizes
+// and timings. Also checks that both of them decode back into exactly the same record.
+//
+//   (lldb) po [VNBenchmark benchmarkRecordEncodingWithFlagCount:10000]
++ (NSDictionary*)benchmarkRecordEncodingWithFlagCount:(NSUInteger)flagCount;
+
+@end
+
+#endif
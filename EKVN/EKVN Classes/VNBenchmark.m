@@ -0,0 +1,432 @@
+//
+//  VNBenchmark.m
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#import "VNBenchmark.h"
+
+#if DEBUG
+
+#import "VNScript.h"
+#import "VNScriptStream.h"
+#import "EKRecord.h"
+
+#define VNBenchmarkRecordRepetitions    10  // Each encode and decode gets timed this many times, and then averaged
+
+@implementation VNBenchmark
+
+#pragma mark - Synthetic scripts
+
+// Lines that get repeated over and over in synthetic scripts. There's a bit of everything here: dialogue, commands
+// from the top of the old if/else chain, commands from the very bottom of it, and nested (secondary) commands.
++ (NSArray*)syntheticLines
+{
+    return @[@"This is a perfectly ordinary line of dialogue.",
+             @".setspeaker:Narrator",
+             @"Dialogue can have colons in it too: like this.",
+             @".addsprite:girl.png:NO",
+             @".movesprite:girl.png:100:0:0.5",
+             @".setflag:times talked:1",
+             @".modifyflag:times talked:1",
+             @".isflagbetween:times talked:1:10:.setbackground:pond.png",
+             @".playsound:roar1.caf",
+             @".flipsprite:girl.png:0.5:YES",
+             @".rolldice:6:2:luck",
+             @".modifychoiceboxoffset:10:20",
+             @".scalebackground:1.5:0.5",
+             @".scalesprite:girl.png:1.25:0.5",
+             @".removesprite:girl.png:NO"];
+}
+
++ (NSDictionary*)syntheticScriptWithLineCount:(NSUInteger)lineCount conversations:(NSUInteger)conversationCount
+{
+    NSArray* lines = [self syntheticLines];
+    conversationCount = MAX(1, conversationCount);
+
+    NSMutableDictionary* script = [[NSMutableDictionary alloc] initWithCapacity:conversationCount];
+    NSUInteger linesPerConversation = MAX(1, lineCount / conversationCount);
+    NSUInteger linesAdded = 0;
+
+    for( NSUInteger i = 0; i < conversationCount; i++ ) {
+
+        // The last conversation picks up any leftover lines
+        NSUInteger count = (i == conversationCount - 1) ? (lineCount - linesAdded) : linesPerConversation;
+        NSMutableArray* conversation = [[NSMutableArray alloc] initWithCapacity:count];
+
+        for( NSUInteger j = 0; j < count; j++ )
+            [conversation addObject:[lines objectAtIndex:(linesAdded + j) % lines.count]];
+
+        linesAdded += count;
+
+        NSString* name = (i == 0) ? VNScriptStartingPoint : [NSString stringWithFormat:@"conversation %lu", (unsigned long)i];
+        [script setObject:conversation forKey:name];
+    }
+
+    return script;
+}
+
+#pragma mark - Command dispatch
+
+// The command names, in the same order that the old if/else chain in 'analyzedCommand' checked them
++ (NSArray*)commandNamesInLegacyOrder
+{
+    return @[VNScriptStringAddSprite, VNScriptStringAlignSprite, VNScriptStringRemoveSprite, VNScriptStringEffectMoveSprite,
+             VNScriptStringEffectMoveBackground, VNScriptStringSetSpritePosition, VNScriptStringSetBackground,
+             VNScriptStringSetSpeaker, VNScriptStringChangeConversation, VNScriptStringJumpOnChoice,
+             VNScriptStringShowSpeechOrNot, VNScriptStringEffectFadeIn, VNScriptStringEffectFadeOut, VNScriptStringPlaySound,
+             VNScriptStringPlayMusic, VNScriptStringSetFlag, VNScriptStringModifyFlagValue, VNScriptStringIfFlagHasValue,
+             VNScriptStringIsFlagMoreThan, VNScriptStringIsFlagLessThan, VNScriptStringIsFlagBetween,
+             VNScriptStringModifyFlagOnChoice, VNScriptStringJumpOnFlag, VNScriptStringSystemCall, VNScriptStringSwitchScript,
+             VNScriptStringSetSpeakerFont, VNScriptStringSetSpeakerFontSize, VNScriptStringSetSpeechFont,
+             VNScriptStringSetSpeechFontSize, VNScriptStringSetTypewriterText, VNScriptStringSetSpriteAlias,
+             VNScriptStringSetSpeechbox, VNScriptStringFlipSprite, VNScriptStringRollDice, VNScriptStringModifyChoiceboxOffset,
+             VNScriptStringScaleBackground, VNScriptStringScaleSprite];
+}
+
++ (NSDictionary*)benchmarkCommandDispatchWithLineCount:(NSUInteger)lineCount
+{
+    NSDictionary* script = [self syntheticScriptWithLineCount:lineCount conversations:1];
+    NSArray* lines = [script objectForKey:VNScriptStartingPoint];
+    NSArray* legacyNames = [self commandNamesInLegacyOrder];
+
+    // Split every line ahead of time, so that only the command lookup itself gets timed
+    NSMutableArray* actions = [[NSMutableArray alloc] initWithCapacity:lines.count];
+    for( NSString* line in lines ) {
+        NSString* action = [[line componentsSeparatedByString:VNScriptSeparationString] objectAtIndex:0];
+        if( [action hasPrefix:@"."] )
+            [actions addObject:action];
+    }
+
+    // The old way: compare against every command name until one matches
+    NSUInteger matches = 0;
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for( NSString* action in actions ) {
+        for( NSString* name in legacyNames ) {
+            if( [action caseInsensitiveCompare:name] == NSOrderedSame ) {
+                matches++;
+                break;
+            }
+        }
+    }
+    CFAbsoluteTime linearTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+    // The new way: a single hash table lookup
+    NSUInteger hashedMatches = 0;
+    startTime = CFAbsoluteTimeGetCurrent();
+    for( NSString* action in actions ) {
+        char buffer[VNScriptCommandLongestName + 1];
+        if( [action getCString:buffer maxLength:sizeof(buffer) encoding:NSUTF8StringEncoding] &&
+            VNScriptCommandTypeForName(buffer, strlen(buffer)) != VNScriptCommandUnknown )
+            hashedMatches++;
+    }
+    CFAbsoluteTime hashedTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+    if( matches != hashedMatches )
+        NSLog(@"[VNBenchmark] WARNING: Lookups disagree (%lu matches vs %lu matches)", (unsigned long)matches, (unsigned long)hashedMatches);
+
+    // Finally, time the whole translation process (splitting each line, looking up the command, and creating the arrays)
+    VNScript* translator = [[VNScript alloc] init];
+    startTime = CFAbsoluteTimeGetCurrent();
+    [translator prepareScript:script];
+    CFAbsoluteTime translationTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+    NSLog(@"[VNBenchmark] Command dispatch for %lu lines (%lu commands): linear %.4fs, hashed %.4fs (%.1fx). Full translation: %.4fs",
+          (unsigned long)lineCount, (unsigned long)actions.count, linearTime, hashedTime,
+          (hashedTime > 0 ? linearTime / hashedTime : 0), translationTime);
+
+    return @{VNBenchmarkLineCountKey:           @(lineCount),
+             VNBenchmarkLinearDispatchTimeKey:  @(linearTime),
+             VNBenchmarkHashedDispatchTimeKey:  @(hashedTime),
+             VNBenchmarkTranslationTimeKey:     @(translationTime)};
+}
+
+#pragma mark - Parallel translation
+
++ (NSDictionary*)benchmarkParallelTranslationWithLineCount:(NSUInteger)lineCount conversations:(NSUInteger)conversationCount
+{
+    NSDictionary* script = [self syntheticScriptWithLineCount:lineCount conversations:conversationCount];
+    NSUInteger coreCount = [[NSProcessInfo processInfo] activeProcessorCount];
+
+    VNScript* serialTranslator = [[VNScript alloc] init];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [serialTranslator prepareScript:script];
+    CFAbsoluteTime serialTime = CFAbsoluteTimeGetCurrent() - startTime;
+    NSData* serialBytes = [serialTranslator compiledScriptData];
+
+    NSMutableDictionary* parallelTimes = [[NSMutableDictionary alloc] init];
+    NSMutableDictionary* speedups = [[NSMutableDictionary alloc] init];
+    BOOL outputMatches = YES;
+
+    // Powers of two, and then every core (even if the number of cores isn't a power of two)
+    for( NSUInteger workerCount = 1; workerCount <= coreCount;
+         workerCount = (workerCount < coreCount && workerCount * 2 > coreCount) ? coreCount : workerCount * 2 ) {
+
+        VNScript* parallelTranslator = [[VNScript alloc] init];
+        startTime = CFAbsoluteTimeGetCurrent();
+        [parallelTranslator prepareScript:script workerCount:workerCount];
+        CFAbsoluteTime parallelTime = CFAbsoluteTimeGetCurrent() - startTime;
+
+        // Since the compiled image sorts conversations by name, matching bytes means the scripts are identical
+        if( [parallelTranslator.data isEqualToDictionary:serialTranslator.data] == NO ||
+            [[parallelTranslator compiledScriptData] isEqualToData:serialBytes] == NO ) {
+            NSLog(@"[VNBenchmark] WARNING: Translation with %lu workers doesn't match the serial translation", (unsigned long)workerCount);
+            outputMatches = NO;
+        }
+
+        NSString* key = [NSString stringWithFormat:@"%lu", (unsigned long)workerCount];
+        double speedup = (parallelTime > 0 ? serialTime / parallelTime : 0);
+        [parallelTimes setObject:@(parallelTime) forKey:key];
+        [speedups setObject:@(speedup) forKey:key];
+
+        NSLog(@"[VNBenchmark] Parallel translation of %lu lines (%lu conversations) with %lu workers: %.4fs (%.2fx)",
+              (unsigned long)lineCount, (unsigned long)script.count, (unsigned long)workerCount, parallelTime, speedup);
+    }
+
+    NSLog(@"[VNBenchmark] Serial translation: %.4fs on a device with %lu active cores", serialTime, (unsigned long)coreCount);
+
+    return @{VNBenchmarkLineCountKey:       @(lineCount),
+             VNBenchmarkSerialTimeKey:      @(serialTime),
+             VNBenchmarkParallelTimesKey:   parallelTimes,
+             VNBenchmarkSpeedupsKey:        speedups,
+             VNBenchmarkOutputMatchesKey:   @(outputMatches)};
+}
+
+#pragma mark - Command access
+
++ (NSDictionary*)benchmarkCommandAccessWithLineCount:(NSUInteger)lineCount
+{
+    NSDictionary* script = [self syntheticScriptWithLineCount:lineCount conversations:1];
+    VNScript* translator = [[VNScript alloc] init];
+    [translator prepareScript:script];
+    
+    VNScriptConversation* conversation = [translator conversationNamed:VNScriptStartingPoint];
+    const VNScriptImage* image = [conversation image];
+    
+    // The old way: every command is an NSArray, and every parameter has to be unboxed
+    double boxedTotal = 0;
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for( NSUInteger i = 0; i < conversation.count; i++ ) {
+        @autoreleasepool {
+            NSArray* command = [conversation objectAtIndex:i];
+            boxedTotal += [[command objectAtIndex:0] intValue];
+            for( NSUInteger j = 1; j < command.count; j++ ) {
+                id parameter = [command objectAtIndex:j];
+                if( [parameter isKindOfClass:[NSNumber class]] )
+                    boxedTotal += [parameter doubleValue];
+                else if( [parameter isKindOfClass:[NSString class]] )
+                    boxedTotal += [parameter length];
+            }
+        }
+    }
+    CFAbsoluteTime boxedTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    // The new way: read numbers straight out of the records, and strings from the (cached) string table
+    double recordTotal = 0;
+    startTime = CFAbsoluteTimeGetCurrent();
+    for( NSUInteger i = 0; i < conversation.count; i++ ) {
+        const VNScriptCommandRecord* record = [conversation recordAtIndex:i];
+        recordTotal += record->type;
+        for( int j = 0; j < record->operandCount; j++ ) {
+            if( record->kinds[j] == VNScriptOperandString )
+                recordTotal += [[conversation stringOperand:j ofRecord:record] length];
+            else if( record->kinds[j] != VNScriptOperandStringList && record->kinds[j] != VNScriptOperandCommand )
+                recordTotal += VNScriptImageOperandNumber(image, record, j);
+        }
+    }
+    CFAbsoluteTime recordTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    if( boxedTotal != recordTotal )
+        NSLog(@"[VNBenchmark] WARNING: Boxed and record access read different values (%f vs %f)", boxedTotal, recordTotal);
+    
+    NSLog(@"[VNBenchmark] Command access for %lu lines: boxed %.4fs, records %.4fs (%.1fx)",
+          (unsigned long)conversation.count, boxedTime, recordTime, (recordTime > 0 ? boxedTime / recordTime : 0));
+    
+    return @{VNBenchmarkLineCountKey:           @(lineCount),
+             VNBenchmarkBoxedAccessTimeKey:     @(boxedTime),
+             VNBenchmarkRecordAccessTimeKey:    @(recordTime)};
+}
+
+#pragma mark - Streaming
+
+// Runs a block while a background timer keeps checking how much memory the process is using. Returns the most memory
+// that was seen in use while the block ran, not counting whatever was already in use before it started.
++ (size_t)peakMemoryWhileRunning:(void (^)(void))block
+{
+    size_t baseline = VNScriptStreamResidentBytes();
+    __block size_t peak = baseline;
+
+    dispatch_queue_t samplingQueue = dispatch_queue_create("VNBenchmark memory sampling", DISPATCH_QUEUE_SERIAL);
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, samplingQueue);
+    dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, NSEC_PER_MSEC, NSEC_PER_MSEC / 10);
+    dispatch_source_set_event_handler(timer, ^{
+        peak = MAX(peak, VNScriptStreamResidentBytes());
+    });
+    dispatch_resume(timer);
+
+    block();
+
+    // One last sample, and then wait for the timer to finish (so that 'peak' is only ever touched on the sampling queue)
+    dispatch_source_cancel(timer);
+    __block size_t result = 0;
+    dispatch_sync(samplingQueue, ^{
+        peak = MAX(peak, VNScriptStreamResidentBytes());
+        result = peak - baseline;
+    });
+
+    return result;
+}
+
++ (NSDictionary*)benchmarkStreamingLoadWithLineCount:(NSUInteger)lineCount conversations:(NSUInteger)conversationCount
+{
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"VNBenchmarkStreamingScript.plist"];
+
+    // The synthetic script only exists until it's been written out, so it doesn't count towards either measurement
+    @autoreleasepool {
+        NSDictionary* script = [self syntheticScriptWithLineCount:lineCount conversations:conversationCount];
+        NSData* fileData = [NSPropertyListSerialization dataWithPropertyList:script format:NSPropertyListXMLFormat_v1_0 options:0 error:nil];
+        if( fileData == nil || [fileData writeToFile:path atomically:YES] == NO ) {
+            NSLog(@"[VNBenchmark] ERROR: Could not write synthetic script to: %@", path);
+            return nil;
+        }
+    }
+
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize];
+
+    // Streaming goes first: memory freed by the first run tends to get reused by the second run (which makes the second
+    // run look a little better than it really is), so this way around, any advantage goes to the dictionary.
+    // The scripts get compiled (for comparing) after their measurements are done, since compiling takes memory too.
+    __block VNScript* streamedScript = nil;
+    __block CFAbsoluteTime streamingTime = 0;
+    size_t streamingPeak = [self peakMemoryWhileRunning:^{
+        @autoreleasepool {
+            streamedScript = [[VNScript alloc] init];
+            CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+            [streamedScript prepareScriptFromFile:path];
+            streamingTime = CFAbsoluteTimeGetCurrent() - startTime;
+        }
+    }];
+
+    NSData* streamedBytes = [streamedScript compiledScriptData];
+    streamedScript = nil;
+
+    __block VNScript* dictionaryScript = nil;
+    __block CFAbsoluteTime dictionaryTime = 0;
+    size_t dictionaryPeak = [self peakMemoryWhileRunning:^{
+        @autoreleasepool {
+            dictionaryScript = [[VNScript alloc] init];
+            CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+            [dictionaryScript prepareScript:[[NSDictionary alloc] initWithContentsOfFile:path]];
+            dictionaryTime = CFAbsoluteTimeGetCurrent() - startTime;
+        }
+    }];
+
+    NSData* dictionaryBytes = [dictionaryScript compiledScriptData];
+    dictionaryScript = nil;
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+
+    BOOL outputMatches = (streamedBytes != nil && [streamedBytes isEqualToData:dictionaryBytes]);
+    if( outputMatches == NO )
+        NSLog(@"[VNBenchmark] WARNING: Streamed script doesn't match the script loaded from a dictionary");
+
+    size_t peakResident = VNScriptStreamPeakResidentBytes();
+
+    NSLog(@"[VNBenchmark] Loading a %.1f MB script (%lu lines): streaming %.4fs, %.1f MB peak; dictionary %.4fs, %.1f MB peak. Process peak: %.1f MB",
+          fileSize / 1048576.0, (unsigned long)lineCount, streamingTime, streamingPeak / 1048576.0,
+          dictionaryTime, dictionaryPeak / 1048576.0, peakResident / 1048576.0);
+
+    return @{VNBenchmarkLineCountKey:               @(lineCount),
+             VNBenchmarkScriptFileSizeKey:          @(fileSize),
+             VNBenchmarkStreamingTimeKey:           @(streamingTime),
+             VNBenchmarkDictionaryTimeKey:          @(dictionaryTime),
+             VNBenchmarkStreamingPeakMemoryKey:     @(streamingPeak),
+             VNBenchmarkDictionaryPeakMemoryKey:    @(dictionaryPeak),
+             VNBenchmarkPeakResidentMemoryKey:      @(peakResident),
+             VNBenchmarkOutputMatchesKey:           @(outputMatches)};
+}
+
+#pragma mark - Record encoding
+
++ (NSDictionary*)syntheticRecordWithFlagCount:(NSUInteger)flagCount
+{
+    NSMutableDictionary* record = [[[EKRecord sharedRecord] emptyRecord] mutableCopy];
+
+    // Flags are mostly small numbers (like the ones scripts set), with a few large and negative ones mixed in
+    NSMutableDictionary* flags = [[NSMutableDictionary alloc] initWithCapacity:flagCount];
+    for( NSUInteger i = 0; i < flagCount; i++ ) {
+
+        long long value = (long long)(i % 10);
+        if( i % 50 == 0 )
+            value = 100000 + (long long)i;
+        else if( i % 7 == 0 )
+            value = -(long long)(i % 100);
+
+        [flags setObject:@(value) forKey:[NSString stringWithFormat:@"chapter %lu flag %lu", (unsigned long)(i / 100), (unsigned long)i]];
+    }
+    [record setObject:flags forKey:EKRecordFlagsKey];
+
+    NSMutableDictionary* aliases = [[NSMutableDictionary alloc] init];
+    for( NSUInteger i = 0; i < flagCount / 10; i++ )
+        [aliases setObject:[NSString stringWithFormat:@"character%lu_outfit%lu.png", (unsigned long)(i % 20), (unsigned long)i]
+                    forKey:[NSString stringWithFormat:@"alias %lu", (unsigned long)i]];
+    [record setObject:aliases forKey:EKRecordSpriteAliasesKey];
+
+    NSDictionary* activityData = @{@"scene to play":    @"demo script",
+                                   @"speech to display": @"This is a perfectly ordinary line of dialogue.",
+                                   @"speaker name to show": @"Narrator",
+                                   @"background opacity": @(0.75),
+                                   @"script info":      @{@"conversation": @"start", @"current index": @(1234), @"indexes done": @(1233)}};
+    [record setObject:@{EKRecordActivityTypeKey: @"VNScene", EKRecordActivityDataKey: activityData} forKey:EKRecordCurrentActivityDictKey];
+    [record setObject:@(123456) forKey:EKRecordCurrentScoreKey];
+
+    return record;
+}
+
++ (NSDictionary*)benchmarkRecordEncodingWithFlagCount:(NSUInteger)flagCount
+{
+    EKRecord* encoder = [EKRecord sharedRecord];
+    NSDictionary* record = [self syntheticRecordWithFlagCount:flagCount];
+    __block NSData* JSONData = nil;
+    __block NSData* binaryData = nil;
+    __block NSDictionary* JSONRecord = nil;
+    __block NSDictionary* binaryRecord = nil;
+
+    // Each one runs in its own autorelease pool, so that the temporary objects from one run don't pile up into the next
+    CFAbsoluteTime (^timeRuns)(void (^)(void)) = ^CFAbsoluteTime(void (^block)(void)) {
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        for( int i = 0; i < VNBenchmarkRecordRepetitions; i++ ) {
+            @autoreleasepool {
+                block();
+            }
+        }
+        return (CFAbsoluteTimeGetCurrent() - startTime) / VNBenchmarkRecordRepetitions;
+    };
+
+    CFAbsoluteTime JSONEncodeTime = timeRuns(^{ JSONData = [encoder JSONDataFromRecord:record]; });
+    CFAbsoluteTime binaryEncodeTime = timeRuns(^{ binaryData = [encoder binaryDataFromRecord:record]; });
+    CFAbsoluteTime JSONDecodeTime = timeRuns(^{ JSONRecord = [encoder recordFromData:JSONData]; });
+    CFAbsoluteTime binaryDecodeTime = timeRuns(^{ binaryRecord = [encoder recordFromData:binaryData]; });
+
+    BOOL outputMatches = ([JSONRecord isEqualToDictionary:record] && [binaryRecord isEqualToDictionary:record]);
+    if( outputMatches == NO )
+        NSLog(@"[VNBenchmark] WARNING: A decoded record doesn't match the original record");
+
+    NSLog(@"[VNBenchmark] Record with %lu flags: JSON %.1f KB (encode %.4fs, decode %.4fs); binary %.1f KB (encode %.4fs, decode %.4fs). Binary is %.1fx smaller",
+          (unsigned long)flagCount, JSONData.length / 1024.0, JSONEncodeTime, JSONDecodeTime,
+          binaryData.length / 1024.0, binaryEncodeTime, binaryDecodeTime,
+          (binaryData.length > 0 ? (double)JSONData.length / binaryData.length : 0));
+
+    return @{VNBenchmarkFlagCountKey:           @(flagCount),
+             VNBenchmarkJSONSizeKey:            @(JSONData.length),
+             VNBenchmarkBinarySizeKey:          @(binaryData.length),
+             VNBenchmarkJSONEncodeTimeKey:      @(JSONEncodeTime),
+             VNBenchmarkBinaryEncodeTimeKey:    @(binaryEncodeTime),
+             VNBenchmarkJSONDecodeTimeKey:      @(JSONDecodeTime),
+             VNBenchmarkBinaryDecodeTimeKey:    @(binaryDecodeTime),
+             VNBenchmarkOutputMatchesKey:       @(outputMatches)};
+}
+
+@end
+
+#endif
@@ -0,0 +1,82 @@
+//
+//  VNClock.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNClock.h"
+
+#include <string.h>
+
+void VNClockInit(VNClock* clock)
+{
+    if( clock == NULL )
+        return;
+
+    memset(clock, 0, sizeof(VNClock));
+    clock->maxDelta = VNClockDefaultMaxDelta;
+    clock->scale = 1.0;
+    clock->previousHostTime = -1.0;
+}
+
+double VNClockTick(VNClock* clock, double hostTime)
+{
+    if( clock == NULL )
+        return 0.0;
+
+    clock->ticks++;
+
+    if( clock->fixedStep > 0.0 ) {
+        clock->hostDelta = 0.0;
+        clock->delta = clock->fixedStep * clock->scale;
+        clock->time += clock->delta;
+        return clock->delta;
+    }
+
+    // There's nothing to measure against until the second tick
+    double elapsed = 0.0;
+    if( clock->previousHostTime >= 0.0 && hostTime > clock->previousHostTime )
+        elapsed = hostTime - clock->previousHostTime;
+    clock->previousHostTime = hostTime;
+
+    clock->hostDelta = elapsed;
+    if( clock->maxDelta > 0.0 && elapsed > clock->maxDelta )
+        elapsed = clock->maxDelta;
+
+    clock->delta = elapsed * clock->scale;
+    clock->time += clock->delta;
+    return clock->delta;
+}
+
+void VNClockUseVirtualTime(VNClock* clock, double fixedStep)
+{
+    if( clock == NULL )
+        return;
+
+    clock->fixedStep = (fixedStep > 0.0) ? fixedStep : 0.0;
+
+    // Going back to host time starts over, so the time that passed while the clock was virtual isn't counted twice
+    clock->previousHostTime = -1.0;
+}
+
+int VNClockIsVirtual(const VNClock* clock)
+{
+    return (clock != NULL && clock->fixedStep > 0.0) ? 1 : 0;
+}
+
+void VNClockStep(VNClock* clock, double seconds)
+{
+    if( clock == NULL || seconds < 0.0 )
+        return;
+
+    clock->ticks++;
+    clock->hostDelta = 0.0;
+    clock->delta = seconds * clock->scale;
+    clock->time += clock->delta;
+}
+
+void VNClockResync(VNClock* clock)
+{
+    if( clock != NULL )
+        clock->previousHostTime = -1.0;
+}
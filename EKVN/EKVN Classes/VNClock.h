@@ -0,0 +1,78 @@
+//
+//  VNClock.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNClock
+
+ The clock that VNScene's timed behavior (typewriter text, cinematic text) is driven by, so that it happens at the same
+ speed no matter how often frames get drawn (60Hz, 120Hz, or an adaptive frame rate that changes from moment to moment).
+
+ Normally, the clock follows the "host" time that SpriteKit passes to 'update:'. Each tick works out how much time has
+ passed since the previous one (the "delta"), which everything timed then uses instead of counting frames. The delta is
+ capped by 'maxDelta', so that a long stall (like the app being sent to the background) doesn't make everything jump
+ ahead all at once.
+
+ The clock can also be switched to virtual time, where each tick moves the clock forward by a fixed step, whatever the
+ host time is. This is meant for headless runs and tests, where 'update:' might be called as fast as possible (or with
+ made-up times), but the script should still behave exactly as it would at a steady frame rate:
+
+   VNClockUseVirtualTime([scene sceneClock], 1.0 / 60.0);
+
+ VNClockStep can also be used to move a clock forward by an exact amount. This file is plain C so that it can be used
+ outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNClock_h
+#define VNClock_h
+
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNClockDefaultMaxDelta      0.25    // Longest step (in seconds) that a single tick can take
+
+typedef struct {
+    double time;                // Seconds that have passed on this clock (the sum of every delta)
+    double delta;               // Length of the most recent step, in seconds (capped, and multiplied by the scale)
+    double hostDelta;           // Actual time between the two most recent host times (zero for virtual steps)
+    double maxDelta;
+    double scale;               // 1.0 is normal speed, 0.5 is half speed, etc.
+    double fixedStep;           // Greater than zero if the clock is using virtual time
+    double previousHostTime;    // Less than zero until the clock has been ticked
+    uint64_t ticks;
+} VNClock;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void VNClockInit(VNClock* clock);
+
+// Moves the clock forward to the given host time (in seconds), and returns the delta. The first tick (and any tick where
+// the host time goes backwards) has a delta of zero. With virtual time, the host time is ignored.
+double VNClockTick(VNClock* clock, double hostTime);
+
+// Switches the clock to virtual time, where each tick is exactly one fixed step long. A step of zero (or less) switches
+// the clock back to following the host time.
+void VNClockUseVirtualTime(VNClock* clock, double fixedStep);
+int VNClockIsVirtual(const VNClock* clock);
+
+// Moves the clock forward by an exact amount (which is still multiplied by the scale, but isn't capped)
+void VNClockStep(VNClock* clock, double seconds);
+
+// Forgets the previous host time, so that the next tick has a delta of zero. This is for when the clock's owner has been
+// paused (or idle), and the time that passed in the meantime shouldn't count.
+void VNClockResync(VNClock* clock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,417 @@
+//
+//  VNReadHistory.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNReadHistory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VNReadHistoryInitialBuckets     64      // Must be a power of two
+#define VNReadHistoryHeaderSize         12      // Magic, version, page count
+#define VNReadHistoryMaxKeyLength       (64 * 1024)
+#define VNReadHistoryMaxWords           (16 * 1024 * 1024)
+
+// Encoded histories look like this (everything is little-endian):
+//
+//   uint32 magic, uint32 version, uint32 page count
+//   for each page: uint32 key length, key (script name, a zero byte, conversation name),
+//                  uint32 word count, word count * uint64 (bit N of word W is line (W * 64) + N)
+//
+// Words at the end of a page that are all zeroes are left out.
+
+typedef struct {
+    char* key;
+    uint32_t keyLength;
+    uint32_t hash;
+    uint64_t* words;
+    uint32_t wordCount;
+} VNReadHistoryPage;
+
+struct VNReadHistory {
+    VNReadHistoryPage* pages;
+    uint32_t pageCount;
+    uint32_t pageCapacity;
+    uint32_t* buckets;      // Page number plus one (zero for an empty bucket)
+    uint32_t bucketCount;
+    uint64_t readCount;
+    int isDirty;
+};
+
+// MARK: - Pages
+
+static uint32_t VNReadHistoryHash(const char* key, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for( size_t i = 0; i < length; i++ ) {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static int VNReadHistoryRehash(VNReadHistory* history, uint32_t bucketCount)
+{
+    uint32_t* buckets = calloc(bucketCount, sizeof(uint32_t));
+    if( buckets == NULL )
+        return 0;
+
+    for( uint32_t i = 0; i < history->pageCount; i++ ) {
+        uint32_t bucket = history->pages[i].hash & (bucketCount - 1);
+        while( buckets[bucket] != 0 )
+            bucket = (bucket + 1) & (bucketCount - 1);
+        buckets[bucket] = i + 1;
+    }
+
+    free(history->buckets);
+    history->buckets = buckets;
+    history->bucketCount = bucketCount;
+    return 1;
+}
+
+VNReadHistory* VNReadHistoryCreate(void)
+{
+    VNReadHistory* history = calloc(1, sizeof(VNReadHistory));
+    if( history == NULL )
+        return NULL;
+
+    if( VNReadHistoryRehash(history, VNReadHistoryInitialBuckets) == 0 ) {
+        free(history);
+        return NULL;
+    }
+
+    return history;
+}
+
+void VNReadHistoryFree(VNReadHistory* history)
+{
+    if( history == NULL )
+        return;
+
+    for( uint32_t i = 0; i < history->pageCount; i++ ) {
+        free(history->pages[i].key);
+        free(history->pages[i].words);
+    }
+
+    free(history->pages);
+    free(history->buckets);
+    free(history);
+}
+
+static uint32_t VNReadHistoryFindPage(const VNReadHistory* history, const char* key, uint32_t keyLength, uint32_t hash)
+{
+    uint32_t bucket = hash & (history->bucketCount - 1);
+
+    while( history->buckets[bucket] != 0 ) {
+        const VNReadHistoryPage* page = &history->pages[history->buckets[bucket] - 1];
+        if( page->hash == hash && page->keyLength == keyLength && memcmp(page->key, key, keyLength) == 0 )
+            return history->buckets[bucket] - 1;
+
+        bucket = (bucket + 1) & (history->bucketCount - 1);
+    }
+
+    return VNReadHistoryNoPage;
+}
+
+// Adds a page for a key (which is copied). Returns VNReadHistoryNoPage if there isn't enough memory.
+static uint32_t VNReadHistoryAddPage(VNReadHistory* history, const char* key, uint32_t keyLength, uint32_t hash)
+{
+    // Keep the hash table no more than half full
+    if( (history->pageCount + 1) * 2 > history->bucketCount ) {
+        if( VNReadHistoryRehash(history, history->bucketCount * 2) == 0 )
+            return VNReadHistoryNoPage;
+    }
+
+    if( history->pageCount == history->pageCapacity ) {
+        uint32_t capacity = (history->pageCapacity > 0) ? history->pageCapacity * 2 : 16;
+        VNReadHistoryPage* pages = realloc(history->pages, capacity * sizeof(VNReadHistoryPage));
+        if( pages == NULL )
+            return VNReadHistoryNoPage;
+
+        history->pages = pages;
+        history->pageCapacity = capacity;
+    }
+
+    char* keyCopy = malloc(keyLength > 0 ? keyLength : 1);
+    if( keyCopy == NULL )
+        return VNReadHistoryNoPage;
+    memcpy(keyCopy, key, keyLength);
+
+    uint32_t pageNumber = history->pageCount++;
+    VNReadHistoryPage* page = &history->pages[pageNumber];
+    page->key = keyCopy;
+    page->keyLength = keyLength;
+    page->hash = hash;
+    page->words = NULL;
+    page->wordCount = 0;
+
+    uint32_t bucket = hash & (history->bucketCount - 1);
+    while( history->buckets[bucket] != 0 )
+        bucket = (bucket + 1) & (history->bucketCount - 1);
+    history->buckets[bucket] = pageNumber + 1;
+
+    return pageNumber;
+}
+
+uint32_t VNReadHistoryPageFor(VNReadHistory* history, const char* scriptName, const char* conversationName)
+{
+    if( history == NULL || scriptName == NULL || conversationName == NULL )
+        return VNReadHistoryNoPage;
+
+    // The key is both names, with a zero byte in between
+    size_t scriptLength = strlen(scriptName);
+    size_t conversationLength = strlen(conversationName);
+    size_t keyLength = scriptLength + 1 + conversationLength;
+    if( keyLength > VNReadHistoryMaxKeyLength )
+        return VNReadHistoryNoPage;
+
+    char* key = malloc(keyLength);
+    if( key == NULL )
+        return VNReadHistoryNoPage;
+
+    memcpy(key, scriptName, scriptLength);
+    key[scriptLength] = '\0';
+    memcpy(key + scriptLength + 1, conversationName, conversationLength);
+
+    uint32_t hash = VNReadHistoryHash(key, keyLength);
+    uint32_t page = VNReadHistoryFindPage(history, key, (uint32_t)keyLength, hash);
+    if( page == VNReadHistoryNoPage )
+        page = VNReadHistoryAddPage(history, key, (uint32_t)keyLength, hash);
+
+    free(key);
+    return page;
+}
+
+// MARK: - Lines
+
+int VNReadHistoryHasRead(const VNReadHistory* history, uint32_t page, uint32_t line)
+{
+    if( history == NULL || page >= history->pageCount )
+        return 0;
+
+    const VNReadHistoryPage* readPage = &history->pages[page];
+    uint32_t word = line / 64;
+    if( word >= readPage->wordCount )
+        return 0;
+
+    return (readPage->words[word] >> (line % 64)) & 1;
+}
+
+int VNReadHistoryMarkRead(VNReadHistory* history, uint32_t page, uint32_t line)
+{
+    if( history == NULL || page >= history->pageCount )
+        return 0;
+
+    VNReadHistoryPage* readPage = &history->pages[page];
+    uint32_t word = line / 64;
+    if( word >= VNReadHistoryMaxWords )
+        return 0;
+
+    // Pages grow to fit whichever line is furthest along
+    if( word >= readPage->wordCount ) {
+        uint32_t wordCount = (readPage->wordCount > 0) ? readPage->wordCount : 1;
+        while( wordCount <= word )
+            wordCount *= 2;
+
+        uint64_t* words = realloc(readPage->words, wordCount * sizeof(uint64_t));
+        if( words == NULL )
+            return 0;
+
+        memset(words + readPage->wordCount, 0, (wordCount - readPage->wordCount) * sizeof(uint64_t));
+        readPage->words = words;
+        readPage->wordCount = wordCount;
+    }
+
+    uint64_t bit = 1ULL << (line % 64);
+    if( readPage->words[word] & bit )
+        return 0;
+
+    readPage->words[word] |= bit;
+    history->readCount++;
+    history->isDirty = 1;
+    return 1;
+}
+
+uint64_t VNReadHistoryReadCount(const VNReadHistory* history)
+{
+    return (history != NULL) ? history->readCount : 0;
+}
+
+int VNReadHistoryIsDirty(const VNReadHistory* history)
+{
+    return (history != NULL) ? history->isDirty : 0;
+}
+
+void VNReadHistoryClearDirty(VNReadHistory* history)
+{
+    if( history != NULL )
+        history->isDirty = 0;
+}
+
+void VNReadHistoryReset(VNReadHistory* history)
+{
+    if( history == NULL )
+        return;
+
+    for( uint32_t i = 0; i < history->pageCount; i++ ) {
+        if( history->pages[i].words != NULL )
+            memset(history->pages[i].words, 0, history->pages[i].wordCount * sizeof(uint64_t));
+    }
+
+    history->readCount = 0;
+    history->isDirty = 1;
+}
+
+// MARK: - Encoding
+
+static void VNReadHistoryWrite32(uint8_t* buffer, uint32_t value)
+{
+    for( int i = 0; i < 4; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static void VNReadHistoryWrite64(uint8_t* buffer, uint64_t value)
+{
+    for( int i = 0; i < 8; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint32_t VNReadHistoryRead32(const uint8_t* buffer)
+{
+    uint32_t value = 0;
+    for( int i = 0; i < 4; i++ )
+        value |= (uint32_t)buffer[i] << (i * 8);
+    return value;
+}
+
+static uint64_t VNReadHistoryRead64(const uint8_t* buffer)
+{
+    uint64_t value = 0;
+    for( int i = 0; i < 8; i++ )
+        value |= (uint64_t)buffer[i] << (i * 8);
+    return value;
+}
+
+// Number of words in a page, not counting the empty ones at the end
+static uint32_t VNReadHistoryUsedWords(const VNReadHistoryPage* page)
+{
+    uint32_t count = page->wordCount;
+    while( count > 0 && page->words[count - 1] == 0 )
+        count--;
+    return count;
+}
+
+size_t VNReadHistoryEncode(const VNReadHistory* history, uint8_t* buffer, size_t capacity)
+{
+    if( history == NULL )
+        return 0;
+
+    size_t size = VNReadHistoryHeaderSize;
+    for( uint32_t i = 0; i < history->pageCount; i++ )
+        size += 8 + history->pages[i].keyLength + ((size_t)VNReadHistoryUsedWords(&history->pages[i]) * 8);
+
+    if( buffer == NULL || capacity < size )
+        return size;
+
+    uint8_t* position = buffer;
+    VNReadHistoryWrite32(position, VNReadHistoryMagic);
+    VNReadHistoryWrite32(position + 4, VNReadHistoryVersion);
+    VNReadHistoryWrite32(position + 8, history->pageCount);
+    position += VNReadHistoryHeaderSize;
+
+    for( uint32_t i = 0; i < history->pageCount; i++ ) {
+
+        const VNReadHistoryPage* page = &history->pages[i];
+        uint32_t usedWords = VNReadHistoryUsedWords(page);
+
+        VNReadHistoryWrite32(position, page->keyLength);
+        memcpy(position + 4, page->key, page->keyLength);
+        position += 4 + page->keyLength;
+
+        VNReadHistoryWrite32(position, usedWords);
+        position += 4;
+
+        for( uint32_t word = 0; word < usedWords; word++ ) {
+            VNReadHistoryWrite64(position, page->words[word]);
+            position += 8;
+        }
+    }
+
+    return size;
+}
+
+VNReadHistory* VNReadHistoryDecode(const uint8_t* data, size_t length)
+{
+    if( data == NULL || length < VNReadHistoryHeaderSize )
+        return NULL;
+
+    if( VNReadHistoryRead32(data) != VNReadHistoryMagic ) {
+        fprintf(stderr, "[VNReadHistory] ERROR: Data is not a read history.\n");
+        return NULL;
+    }
+    if( VNReadHistoryRead32(data + 4) != VNReadHistoryVersion ) {
+        fprintf(stderr, "[VNReadHistory] ERROR: Unsupported read history version: %u\n", VNReadHistoryRead32(data + 4));
+        return NULL;
+    }
+
+    VNReadHistory* history = VNReadHistoryCreate();
+    if( history == NULL )
+        return NULL;
+
+    uint32_t pageCount = VNReadHistoryRead32(data + 8);
+    size_t offset = VNReadHistoryHeaderSize;
+
+    for( uint32_t i = 0; i < pageCount; i++ ) {
+
+        if( length - offset < 4 )
+            goto corrupt;
+        uint32_t keyLength = VNReadHistoryRead32(data + offset);
+        offset += 4;
+        if( keyLength > VNReadHistoryMaxKeyLength || length - offset < keyLength )
+            goto corrupt;
+
+        const char* key = (const char*)(data + offset);
+        offset += keyLength;
+
+        if( length - offset < 4 )
+            goto corrupt;
+        uint32_t wordCount = VNReadHistoryRead32(data + offset);
+        offset += 4;
+        if( wordCount > VNReadHistoryMaxWords || (length - offset) / 8 < wordCount )
+            goto corrupt;
+
+        uint32_t hash = VNReadHistoryHash(key, keyLength);
+        if( VNReadHistoryFindPage(history, key, keyLength, hash) != VNReadHistoryNoPage )
+            goto corrupt; // The same page twice
+
+        uint32_t pageNumber = VNReadHistoryAddPage(history, key, keyLength, hash);
+        if( pageNumber == VNReadHistoryNoPage )
+            goto failed;
+
+        if( wordCount > 0 ) {
+            VNReadHistoryPage* page = &history->pages[pageNumber];
+            page->words = malloc(wordCount * sizeof(uint64_t));
+            if( page->words == NULL )
+                goto failed;
+            page->wordCount = wordCount;
+
+            for( uint32_t word = 0; word < wordCount; word++ ) {
+                page->words[word] = VNReadHistoryRead64(data + offset);
+                history->readCount += (uint64_t)__builtin_popcountll(page->words[word]);
+                offset += 8;
+            }
+        }
+    }
+
+    return history;
+
+corrupt:
+    fprintf(stderr, "[VNReadHistory] ERROR: Read history data is corrupt.\n");
+failed:
+    VNReadHistoryFree(history);
+    return NULL;
+}
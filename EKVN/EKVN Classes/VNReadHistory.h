@@ -0,0 +1,81 @@
+//
+//  VNReadHistory.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNReadHistory
+
+ Keeps track of which lines of dialogue the player has already read, across every playthrough of the game. This is
+ what lets skip mode (see 'startSkipping' in VNScene) pass over text the player has seen before, and stop at anything
+ new.
+
+ Each conversation in each script gets its own "page," which is just a bitmap with one bit per line (indexed the same
+ way as the conversation's commands). A conversation with 1,000 lines only needs 128 bytes, so the history stays small
+ even after a lot of playthroughs. Pages are looked up by name, so it's best to look a page up once (whenever the
+ conversation changes) and then use its number for every line in that conversation.
+
+ The history can be encoded into a compact binary format (and decoded again) so that it can be stored somewhere, such as
+ in EKRecord's global data. The history isn't thread-safe; it's meant to be used from the main thread.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNReadHistory_h
+#define VNReadHistory_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNReadHistoryNoPage             UINT32_MAX
+#define VNReadHistoryMagic              0x48524E56  // "VNRH" (little-endian)
+#define VNReadHistoryVersion            1
+
+typedef struct VNReadHistory VNReadHistory;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+VNReadHistory* VNReadHistoryCreate(void);
+void VNReadHistoryFree(VNReadHistory* history);
+
+// Returns the page for a conversation in a script (creating it if it doesn't exist), or VNReadHistoryNoPage if there
+// wasn't enough memory. Page numbers stay the same for as long as the history exists.
+uint32_t VNReadHistoryPageFor(VNReadHistory* history, const char* scriptName, const char* conversationName);
+
+int VNReadHistoryHasRead(const VNReadHistory* history, uint32_t page, uint32_t line);
+
+// Returns 1 if the line hadn't been read before (and 0 if it had, or if it couldn't be marked)
+int VNReadHistoryMarkRead(VNReadHistory* history, uint32_t page, uint32_t line);
+
+// How many lines have been read (in every script)
+uint64_t VNReadHistoryReadCount(const VNReadHistory* history);
+
+// The history is "dirty" whenever lines have been marked since the last call to VNReadHistoryClearDirty (which is
+// meant to be called after the history has been saved)
+int VNReadHistoryIsDirty(const VNReadHistory* history);
+void VNReadHistoryClearDirty(VNReadHistory* history);
+
+// Forgets every line (but keeps the pages, so page numbers are still valid)
+void VNReadHistoryReset(VNReadHistory* history);
+
+// Encodes the history, and returns the number of bytes used. If the buffer is NULL (or too small), nothing is written
+// and the size that the buffer needs to be is returned instead.
+size_t VNReadHistoryEncode(const VNReadHistory* history, uint8_t* buffer, size_t capacity);
+
+// Creates a history from encoded data. Returns NULL if the data isn't a valid history.
+VNReadHistory* VNReadHistoryDecode(const uint8_t* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
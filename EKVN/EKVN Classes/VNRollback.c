@@ -0,0 +1,600 @@
+//
+//  VNRollback.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNRollback.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VNRollbackInitialEntryCapacity  16
+
+// Whole snapshots (keyframes) are stored as-is. Deltas look like this:
+//
+//   varint section count, a bitmap with one bit per section (set if the section changed),
+//   then every changed section, in order, exactly as it appears in the snapshot (varint length plus bytes)
+//
+// Sections that didn't change are copied from the previous snapshot. The oldest snapshot in the history is always a
+// keyframe, so any snapshot can be rebuilt by starting from the nearest keyframe before it and applying deltas.
+
+typedef struct {
+    size_t start;   // Offset of the section's length
+    size_t size;    // Size of the length plus the section's bytes
+} VNRollbackSpan;
+
+typedef struct {
+    uint8_t* data;          // The whole snapshot (for keyframes) or a delta
+    size_t dataLength;
+    size_t stateLength;     // Size of the whole snapshot
+    int isKeyframe;
+} VNRollbackEntry;
+
+struct VNRollback {
+    VNRollbackEntry* entries;   // Ring buffer, oldest first
+    uint32_t entryCapacity;
+    uint32_t first;
+    uint32_t count;
+
+    uint32_t keyframeInterval;
+    uint32_t deltasSinceKeyframe;
+    size_t memoryBudget;
+    size_t memoryUsed;
+
+    // A copy of the newest snapshot (and where its sections are), which the next delta gets made against
+    uint8_t* latest;
+    size_t latestLength;
+    VNRollbackSpan* latestSpans;
+    uint32_t latestSpanCount;
+};
+
+// MARK: - Sections
+
+size_t VNRollbackSectionHeader(uint8_t* header, size_t sectionLength)
+{
+    size_t size = 0;
+    uint64_t value = sectionLength;
+
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if( value != 0 )
+            byte |= 0x80;
+
+        if( header != NULL )
+            header[size] = byte;
+        size++;
+    } while( value != 0 );
+
+    return size;
+}
+
+static int VNRollbackReadVarint(const uint8_t* data, size_t length, size_t* offset, uint64_t* value)
+{
+    uint64_t result = 0;
+
+    for( int shift = 0; shift < 64; shift += 7 ) {
+
+        if( *offset >= length )
+            return 0;
+
+        uint8_t byte = data[(*offset)++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+
+        if( (byte & 0x80) == 0 ) {
+            *value = result;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int VNRollbackReadSection(const uint8_t* state, size_t length, size_t* offset, const uint8_t** section, size_t* sectionLength)
+{
+    if( state == NULL || offset == NULL || *offset >= length )
+        return 0;
+
+    size_t position = *offset;
+    uint64_t sectionSize = 0;
+    if( VNRollbackReadVarint(state, length, &position, &sectionSize) == 0 || sectionSize > length - position )
+        return 0;
+
+    if( section != NULL )
+        *section = state + position;
+    if( sectionLength != NULL )
+        *sectionLength = (size_t)sectionSize;
+
+    *offset = position + (size_t)sectionSize;
+    return 1;
+}
+
+// Finds where each section is. The spans are allocated with malloc (and are NULL if there aren't any sections).
+static int VNRollbackFindSections(const uint8_t* state, size_t length, VNRollbackSpan** spans, uint32_t* count)
+{
+    *spans = NULL;
+    *count = 0;
+
+    // The first pass just checks the sections and counts them
+    uint32_t sectionCount = 0;
+    size_t offset = 0;
+    while( offset < length ) {
+
+        uint64_t sectionLength = 0;
+        if( VNRollbackReadVarint(state, length, &offset, &sectionLength) == 0 || sectionLength > length - offset )
+            return 0;
+
+        offset += (size_t)sectionLength;
+        sectionCount++;
+    }
+
+    if( sectionCount == 0 )
+        return 1;
+
+    VNRollbackSpan* sectionSpans = malloc(sectionCount * sizeof(VNRollbackSpan));
+    if( sectionSpans == NULL )
+        return 0;
+
+    offset = 0;
+    for( uint32_t i = 0; i < sectionCount; i++ ) {
+
+        uint64_t sectionLength = 0;
+        size_t start = offset;
+        VNRollbackReadVarint(state, length, &offset, &sectionLength);
+        offset += (size_t)sectionLength;
+
+        sectionSpans[i].start = start;
+        sectionSpans[i].size = offset - start;
+    }
+
+    *spans = sectionSpans;
+    *count = sectionCount;
+    return 1;
+}
+
+// MARK: - Deltas
+
+// Creates a delta that turns the previous snapshot into the new one (or returns NULL if there wasn't enough memory)
+static uint8_t* VNRollbackCreateDelta(const uint8_t* previous, const VNRollbackSpan* previousSpans, uint32_t previousCount,
+                                      const uint8_t* state, const VNRollbackSpan* spans, uint32_t count, size_t* deltaLength)
+{
+    uint8_t header[VNRollbackMaxSectionHeaderSize];
+    size_t headerSize = VNRollbackSectionHeader(header, count);
+    size_t bitmapSize = (count + 7) / 8;
+
+    // Work out which sections changed (and how much space they need) before allocating anything
+    uint8_t* bitmap = calloc(bitmapSize > 0 ? bitmapSize : 1, 1);
+    if( bitmap == NULL )
+        return NULL;
+
+    size_t length = headerSize + bitmapSize;
+    for( uint32_t i = 0; i < count; i++ ) {
+
+        int isUnchanged = (i < previousCount && spans[i].size == previousSpans[i].size &&
+                           memcmp(state + spans[i].start, previous + previousSpans[i].start, spans[i].size) == 0);
+
+        if( isUnchanged == 0 ) {
+            bitmap[i / 8] |= (uint8_t)(1 << (i % 8));
+            length += spans[i].size;
+        }
+    }
+
+    uint8_t* delta = malloc(length);
+    if( delta == NULL ) {
+        free(bitmap);
+        return NULL;
+    }
+
+    memcpy(delta, header, headerSize);
+    memcpy(delta + headerSize, bitmap, bitmapSize);
+
+    size_t offset = headerSize + bitmapSize;
+    for( uint32_t i = 0; i < count; i++ ) {
+
+        if( bitmap[i / 8] & (1 << (i % 8)) ) {
+            memcpy(delta + offset, state + spans[i].start, spans[i].size);
+            offset += spans[i].size;
+        }
+    }
+
+    free(bitmap);
+    *deltaLength = length;
+    return delta;
+}
+
+// Rebuilds a snapshot from the one before it, plus a delta. The output has to be exactly as long as the snapshot.
+static int VNRollbackApplyDelta(const uint8_t* previous, const VNRollbackSpan* previousSpans, uint32_t previousCount,
+                                const uint8_t* delta, size_t deltaLength, uint8_t* output, size_t outputLength)
+{
+    size_t deltaOffset = 0;
+    uint64_t count = 0;
+    if( VNRollbackReadVarint(delta, deltaLength, &deltaOffset, &count) == 0 || count > deltaLength * 8 )
+        return 0;
+
+    size_t bitmapSize = (size_t)((count + 7) / 8);
+    if( bitmapSize > deltaLength - deltaOffset )
+        return 0;
+
+    const uint8_t* bitmap = delta + deltaOffset;
+    deltaOffset += bitmapSize;
+
+    size_t outputOffset = 0;
+    for( uint64_t i = 0; i < count; i++ ) {
+
+        const uint8_t* source = NULL;
+        size_t size = 0;
+
+        if( bitmap[i / 8] & (1 << (i % 8)) ) {
+
+            size_t start = deltaOffset;
+            uint64_t sectionLength = 0;
+            if( VNRollbackReadVarint(delta, deltaLength, &deltaOffset, &sectionLength) == 0 || sectionLength > deltaLength - deltaOffset )
+                return 0;
+
+            deltaOffset += (size_t)sectionLength;
+            source = delta + start;
+            size = deltaOffset - start;
+
+        } else {
+
+            if( i >= previousCount )
+                return 0;
+
+            source = previous + previousSpans[i].start;
+            size = previousSpans[i].size;
+        }
+
+        if( size > outputLength - outputOffset )
+            return 0;
+
+        memcpy(output + outputOffset, source, size);
+        outputOffset += size;
+    }
+
+    return outputOffset == outputLength;
+}
+
+// MARK: - Entries
+
+static VNRollbackEntry* VNRollbackEntryAt(const VNRollback* rollback, uint32_t index)
+{
+    return &rollback->entries[(rollback->first + index) % rollback->entryCapacity];
+}
+
+static int VNRollbackGrowEntries(VNRollback* rollback)
+{
+    uint32_t capacity = (rollback->entryCapacity > 0) ? rollback->entryCapacity * 2 : VNRollbackInitialEntryCapacity;
+    VNRollbackEntry* entries = malloc(capacity * sizeof(VNRollbackEntry));
+    if( entries == NULL )
+        return 0;
+
+    for( uint32_t i = 0; i < rollback->count; i++ )
+        entries[i] = *VNRollbackEntryAt(rollback, i);
+
+    free(rollback->entries);
+    rollback->entries = entries;
+    rollback->entryCapacity = capacity;
+    rollback->first = 0;
+    return 1;
+}
+
+// Rebuilds the snapshot at a particular index (zero is the oldest) into a new buffer
+static uint8_t* VNRollbackRebuild(const VNRollback* rollback, uint32_t index)
+{
+    uint32_t keyframe = index;
+    while( VNRollbackEntryAt(rollback, keyframe)->isKeyframe == 0 ) {
+        if( keyframe == 0 )
+            return NULL; // This shouldn't happen, since the oldest snapshot is always a keyframe
+        keyframe--;
+    }
+
+    VNRollbackEntry* entry = VNRollbackEntryAt(rollback, keyframe);
+    uint8_t* state = malloc(entry->stateLength > 0 ? entry->stateLength : 1);
+    if( state == NULL )
+        return NULL;
+    memcpy(state, entry->data, entry->stateLength);
+
+    for( uint32_t i = keyframe + 1; i <= index; i++ ) {
+
+        VNRollbackEntry* previousEntry = VNRollbackEntryAt(rollback, i - 1);
+        entry = VNRollbackEntryAt(rollback, i);
+
+        VNRollbackSpan* spans = NULL;
+        uint32_t spanCount = 0;
+        uint8_t* nextState = malloc(entry->stateLength > 0 ? entry->stateLength : 1);
+
+        if( nextState == NULL || VNRollbackFindSections(state, previousEntry->stateLength, &spans, &spanCount) == 0 ||
+            VNRollbackApplyDelta(state, spans, spanCount, entry->data, entry->dataLength, nextState, entry->stateLength) == 0 ) {
+
+            fprintf(stderr, "[VNRollback] ERROR: Could not rebuild snapshot.\n");
+            free(spans);
+            free(nextState);
+            free(state);
+            return NULL;
+        }
+
+        free(spans);
+        free(state);
+        state = nextState;
+    }
+
+    return state;
+}
+
+static void VNRollbackCountDeltasSinceKeyframe(VNRollback* rollback)
+{
+    rollback->deltasSinceKeyframe = 0;
+
+    for( uint32_t i = rollback->count; i > 0; i-- ) {
+        if( VNRollbackEntryAt(rollback, i - 1)->isKeyframe )
+            break;
+        rollback->deltasSinceKeyframe++;
+    }
+}
+
+// The snapshot after the oldest one becomes a keyframe (if it isn't one already), so that it doesn't depend on the
+// snapshot that's being dropped
+static int VNRollbackDropOldest(VNRollback* rollback)
+{
+    if( rollback->count == 0 )
+        return 0;
+
+    if( rollback->count > 1 ) {
+
+        VNRollbackEntry* next = VNRollbackEntryAt(rollback, 1);
+        if( next->isKeyframe == 0 ) {
+
+            uint8_t* state = VNRollbackRebuild(rollback, 1);
+            if( state == NULL )
+                return 0;
+
+            rollback->memoryUsed -= next->dataLength;
+            rollback->memoryUsed += next->stateLength;
+            free(next->data);
+            next->data = state;
+            next->dataLength = next->stateLength;
+            next->isKeyframe = 1;
+        }
+    }
+
+    VNRollbackEntry* oldest = VNRollbackEntryAt(rollback, 0);
+    rollback->memoryUsed -= oldest->dataLength + sizeof(VNRollbackEntry);
+    free(oldest->data);
+    oldest->data = NULL;
+
+    rollback->first = (rollback->first + 1) % rollback->entryCapacity;
+    rollback->count--;
+    return 1;
+}
+
+static void VNRollbackTrim(VNRollback* rollback)
+{
+    while( rollback->memoryUsed > rollback->memoryBudget && rollback->count > 1 ) {
+        if( VNRollbackDropOldest(rollback) == 0 )
+            break;
+    }
+
+    VNRollbackCountDeltasSinceKeyframe(rollback);
+}
+
+static void VNRollbackForgetLatest(VNRollback* rollback)
+{
+    rollback->memoryUsed -= rollback->latestLength;
+    free(rollback->latest);
+    free(rollback->latestSpans);
+    rollback->latest = NULL;
+    rollback->latestLength = 0;
+    rollback->latestSpans = NULL;
+    rollback->latestSpanCount = 0;
+}
+
+// MARK: - History
+
+VNRollback* VNRollbackCreate(size_t memoryBudget, uint32_t keyframeInterval)
+{
+    VNRollback* rollback = calloc(1, sizeof(VNRollback));
+    if( rollback == NULL )
+        return NULL;
+
+    rollback->memoryBudget = memoryBudget;
+    rollback->keyframeInterval = (keyframeInterval > 0) ? keyframeInterval : VNRollbackDefaultKeyframeInterval;
+    return rollback;
+}
+
+void VNRollbackFree(VNRollback* rollback)
+{
+    if( rollback == NULL )
+        return;
+
+    VNRollbackClear(rollback);
+    free(rollback->entries);
+    free(rollback);
+}
+
+int VNRollbackPush(VNRollback* rollback, const uint8_t* state, size_t length)
+{
+    if( rollback == NULL || (state == NULL && length > 0) )
+        return 0;
+
+    VNRollbackSpan* spans = NULL;
+    uint32_t spanCount = 0;
+    if( VNRollbackFindSections(state, length, &spans, &spanCount) == 0 ) {
+        fprintf(stderr, "[VNRollback] ERROR: Snapshot is not a valid list of sections.\n");
+        return 0;
+    }
+
+    if( rollback->count == rollback->entryCapacity && VNRollbackGrowEntries(rollback) == 0 ) {
+        free(spans);
+        return 0;
+    }
+
+    uint8_t* latest = malloc(length > 0 ? length : 1);
+    if( latest == NULL ) {
+        free(spans);
+        return 0;
+    }
+    if( length > 0 )
+        memcpy(latest, state, length);
+
+    // Store a delta if possible (and if it actually saves space); otherwise, store the whole snapshot
+    VNRollbackEntry entry = { NULL, 0, length, 1 };
+    if( rollback->count > 0 && rollback->deltasSinceKeyframe + 1 < rollback->keyframeInterval ) {
+
+        size_t deltaLength = 0;
+        uint8_t* delta = VNRollbackCreateDelta(rollback->latest, rollback->latestSpans, rollback->latestSpanCount,
+                                               state, spans, spanCount, &deltaLength);
+
+        if( delta != NULL && deltaLength < length ) {
+            entry.data = delta;
+            entry.dataLength = deltaLength;
+            entry.isKeyframe = 0;
+        } else {
+            free(delta);
+        }
+    }
+
+    if( entry.isKeyframe ) {
+
+        entry.data = malloc(length > 0 ? length : 1);
+        if( entry.data == NULL ) {
+            free(latest);
+            free(spans);
+            return 0;
+        }
+
+        if( length > 0 )
+            memcpy(entry.data, state, length);
+        entry.dataLength = length;
+    }
+
+    *VNRollbackEntryAt(rollback, rollback->count) = entry;
+    rollback->count++;
+    rollback->memoryUsed += entry.dataLength + sizeof(VNRollbackEntry);
+
+    VNRollbackForgetLatest(rollback);
+    rollback->latest = latest;
+    rollback->latestLength = length;
+    rollback->latestSpans = spans;
+    rollback->latestSpanCount = spanCount;
+    rollback->memoryUsed += length;
+
+    VNRollbackTrim(rollback);
+    return 1;
+}
+
+uint32_t VNRollbackCount(const VNRollback* rollback)
+{
+    return (rollback != NULL) ? rollback->count : 0;
+}
+
+size_t VNRollbackStateLength(const VNRollback* rollback, uint32_t stepsBack)
+{
+    if( rollback == NULL || stepsBack >= rollback->count )
+        return 0;
+
+    return VNRollbackEntryAt(rollback, rollback->count - 1 - stepsBack)->stateLength;
+}
+
+size_t VNRollbackRestore(const VNRollback* rollback, uint32_t stepsBack, uint8_t* buffer, size_t capacity)
+{
+    if( rollback == NULL || stepsBack >= rollback->count )
+        return 0;
+
+    uint32_t index = rollback->count - 1 - stepsBack;
+    VNRollbackEntry* entry = VNRollbackEntryAt(rollback, index);
+    if( buffer == NULL || capacity < entry->stateLength )
+        return entry->stateLength;
+
+    // The newest snapshot is already sitting in memory
+    if( stepsBack == 0 ) {
+        memcpy(buffer, rollback->latest, rollback->latestLength);
+        return rollback->latestLength;
+    }
+
+    if( entry->isKeyframe ) {
+        memcpy(buffer, entry->data, entry->stateLength);
+        return entry->stateLength;
+    }
+
+    uint8_t* state = VNRollbackRebuild(rollback, index);
+    if( state == NULL )
+        return 0;
+
+    memcpy(buffer, state, entry->stateLength);
+    free(state);
+    return entry->stateLength;
+}
+
+void VNRollbackDiscardNewest(VNRollback* rollback, uint32_t count)
+{
+    if( rollback == NULL || count == 0 )
+        return;
+
+    if( count >= rollback->count ) {
+        VNRollbackClear(rollback);
+        return;
+    }
+
+    for( uint32_t i = 0; i < count; i++ ) {
+
+        VNRollbackEntry* entry = VNRollbackEntryAt(rollback, rollback->count - 1);
+        rollback->memoryUsed -= entry->dataLength + sizeof(VNRollbackEntry);
+        free(entry->data);
+        entry->data = NULL;
+        rollback->count--;
+    }
+
+    // The next delta will be made against whichever snapshot is the newest one now
+    VNRollbackForgetLatest(rollback);
+
+    uint8_t* state = VNRollbackRebuild(rollback, rollback->count - 1);
+    size_t length = VNRollbackEntryAt(rollback, rollback->count - 1)->stateLength;
+    if( state == NULL || VNRollbackFindSections(state, length, &rollback->latestSpans, &rollback->latestSpanCount) == 0 ) {
+
+        // Without the newest snapshot, there's nothing to make deltas against, so the history has to start over
+        free(state);
+        VNRollbackClear(rollback);
+        return;
+    }
+
+    rollback->latest = state;
+    rollback->latestLength = length;
+    rollback->memoryUsed += length;
+    VNRollbackCountDeltasSinceKeyframe(rollback);
+}
+
+void VNRollbackClear(VNRollback* rollback)
+{
+    if( rollback == NULL )
+        return;
+
+    for( uint32_t i = 0; i < rollback->count; i++ )
+        free(VNRollbackEntryAt(rollback, i)->data);
+
+    VNRollbackForgetLatest(rollback);
+    rollback->first = 0;
+    rollback->count = 0;
+    rollback->deltasSinceKeyframe = 0;
+    rollback->memoryUsed = 0;
+}
+
+void VNRollbackSetMemoryBudget(VNRollback* rollback, size_t memoryBudget)
+{
+    if( rollback == NULL )
+        return;
+
+    rollback->memoryBudget = memoryBudget;
+    VNRollbackTrim(rollback);
+}
+
+size_t VNRollbackMemoryBudget(const VNRollback* rollback)
+{
+    return (rollback != NULL) ? rollback->memoryBudget : 0;
+}
+
+size_t VNRollbackMemoryUsed(const VNRollback* rollback)
+{
+    return (rollback != NULL) ? rollback->memoryUsed : 0;
+}
@@ -0,0 +1,88 @@
+//
+//  VNRollback.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNRollback
+
+ A bounded history of snapshots, so that a scene can be "rewound" to an earlier point (to let the player go back and
+ pick a different choice, or to let someone step backwards while tracking down a bug in a script). VNScene pushes a
+ snapshot every time it shows a line of dialogue, and VNRollbackRestore hands back any of them.
+
+ The history doesn't know (or care) what's in a snapshot, except that every snapshot is a list of "sections": each one
+ is a varint length followed by that many bytes (VNRollbackSectionHeader writes the length). Neighbouring snapshots
+ usually only differ in a few sections (the line of dialogue and the script's index change, but the background and the
+ sprites usually don't), so most snapshots are stored as a "delta" that only holds the sections that changed since the
+ previous one. Every so often (see 'keyframeInterval') a whole snapshot is stored instead, which puts a limit on how
+ many deltas need to be applied to restore any snapshot; restoring doesn't depend on how long the history is.
+
+ The history has a memory budget. Once it's over budget, the oldest snapshots get dropped (if the oldest remaining
+ snapshot is a delta, it gets turned into a whole snapshot first). The history isn't thread-safe.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNRollback_h
+#define VNRollback_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNRollbackDefaultMemoryBudget       (256 * 1024)    // In bytes
+#define VNRollbackDefaultKeyframeInterval   16              // A whole snapshot is stored at least this often
+#define VNRollbackMaxSectionHeaderSize      10              // Largest size of a varint length
+
+typedef struct VNRollback VNRollback;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A keyframe interval of zero uses the default
+VNRollback* VNRollbackCreate(size_t memoryBudget, uint32_t keyframeInterval);
+void VNRollbackFree(VNRollback* rollback);
+
+// Writes the length that goes in front of a section's bytes, and returns how many bytes that took (the buffer should be
+// at least VNRollbackMaxSectionHeaderSize bytes long)
+size_t VNRollbackSectionHeader(uint8_t* header, size_t sectionLength);
+
+// Reads the section at an offset in a snapshot, and moves the offset past it. Returns 0 at the end of the snapshot (or
+// if the section isn't valid).
+int VNRollbackReadSection(const uint8_t* state, size_t length, size_t* offset, const uint8_t** section, size_t* sectionLength);
+
+// Adds a snapshot to the history (as the newest one). Returns 0 if the snapshot isn't a valid list of sections, or if
+// there wasn't enough memory. A snapshot that's bigger than the whole budget is still stored, but it'll be the only one.
+int VNRollbackPush(VNRollback* rollback, const uint8_t* state, size_t length);
+
+// How many snapshots are in the history
+uint32_t VNRollbackCount(const VNRollback* rollback);
+
+// The size of a snapshot (zero means 0 steps back, which is the newest one), or zero if there's no such snapshot
+size_t VNRollbackStateLength(const VNRollback* rollback, uint32_t stepsBack);
+
+// Copies a snapshot into a buffer, and returns its size. If the buffer is NULL (or too small), nothing is written and the
+// size that the buffer needs to be is returned instead. Returns zero if there's no such snapshot.
+size_t VNRollbackRestore(const VNRollback* rollback, uint32_t stepsBack, uint8_t* buffer, size_t capacity);
+
+// Removes the newest snapshots (like after rewinding, when the snapshots that came afterwards don't apply anymore)
+void VNRollbackDiscardNewest(VNRollback* rollback, uint32_t count);
+void VNRollbackClear(VNRollback* rollback);
+
+// Changing the budget drops old snapshots right away if the history no longer fits
+void VNRollbackSetMemoryBudget(VNRollback* rollback, size_t memoryBudget);
+size_t VNRollbackMemoryBudget(const VNRollback* rollback);
+size_t VNRollbackMemoryUsed(const VNRollback* rollback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
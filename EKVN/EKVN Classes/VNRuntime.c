@@ -0,0 +1,1077 @@
+//
+//  VNRuntime.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNRuntime.h"
+#include "VNScriptCommands.h"
+#include "VNStats.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+struct VNRuntime {
+
+    const VNRuntimeHost* host;
+    void* hostContext;
+    const VNRuntimeBackend* backend;
+    void* backendContext;
+
+    VNRuntimeState state;
+    VNRuntimeConversation conversation;
+    int64_t currentIndex;   // The line that the script has gotten up to
+    int64_t indexesDone;    // Lines before this one have already been run
+    uint64_t conversationChanges;
+    uint64_t commandsRun;
+
+    // The command that's showing a choice menu. The record is copied, since the runtime can't hold on to anything
+    // that belongs to the host; the image is still safe to use, since the conversation can't change during a choice.
+    int choiceCount;
+    VNScriptCommandRecord choiceCommand;
+    const VNScriptImage* choiceImage;
+};
+
+static void VNRuntimeProcessCommand(VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image);
+
+// MARK: - Operands
+
+// Returns the text of a string operand, or NULL if the operand isn't a string
+static const char* VNRuntimeOperandText(const VNScriptImage* image, const VNScriptCommandRecord* command, int operand, uint32_t* outLength)
+{
+    if( command == NULL || operand < 0 || operand >= command->operandCount || operand >= VNScriptImageMaxOperands )
+        return NULL;
+    if( command->kinds[operand] != VNScriptOperandString )
+        return NULL;
+
+    return VNScriptImageString(image, command->operands[operand].ref.index, outLength);
+}
+
+static uint32_t VNRuntimeListCount(const VNScriptCommandRecord* command, int operand)
+{
+    if( command == NULL || operand < 0 || operand >= command->operandCount || operand >= VNScriptImageMaxOperands )
+        return 0;
+    if( command->kinds[operand] != VNScriptOperandStringList )
+        return 0;
+
+    return command->operands[operand].ref.count;
+}
+
+// Returns one of the strings in a string list operand
+static const char* VNRuntimeListItem(const VNScriptImage* image, const VNScriptCommandRecord* command, int operand, uint32_t item, uint32_t* outLength)
+{
+    if( item >= VNRuntimeListCount(command, operand) )
+        return NULL;
+
+    uint32_t first = command->operands[operand].ref.index;
+    if( first > image->header->listItemCount || item >= image->header->listItemCount - first )
+        return NULL;
+
+    return VNScriptImageString(image, image->lists[first + item], outLength);
+}
+
+// Error messages print an empty name rather than "(null)" when an operand isn't a string
+static const char* VNRuntimeOperandName(const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    const char* text = VNRuntimeOperandText(image, command, operand, NULL);
+    return (text != NULL) ? text : "";
+}
+
+// MARK: - Host helpers
+
+static uint32_t VNRuntimeFlagSlotForOperand(VNRuntime* runtime, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    uint32_t slot = VNScriptImageNotFound;
+    if( runtime->host->flagSlotForOperand != NULL )
+        slot = runtime->host->flagSlotForOperand(runtime->hostContext, image, command, operand);
+
+    // Anything that wasn't resolved ahead of time just gets looked up by name
+    if( slot == VNScriptImageNotFound ) {
+        uint32_t length = 0;
+        const char* name = VNRuntimeOperandText(image, command, operand, &length);
+        if( name != NULL )
+            slot = runtime->host->flagSlotForName(runtime->hostContext, name, length);
+    }
+
+    return slot;
+}
+
+static int VNRuntimeHasFlag(VNRuntime* runtime, uint32_t slot)
+{
+    return (slot != VNScriptImageNotFound && runtime->host->hasFlag(runtime->hostContext, slot));
+}
+
+static int64_t VNRuntimeFlagValue(VNRuntime* runtime, uint32_t slot)
+{
+    return (slot != VNScriptImageNotFound) ? runtime->host->flagValue(runtime->hostContext, slot) : 0;
+}
+
+static void VNRuntimeModifyFlag(VNRuntime* runtime, uint32_t slot, int64_t amount)
+{
+    if( slot == VNScriptImageNotFound )
+        return;
+
+    // If the flag doesn't exist yet, then it just gets created with the "modifier" as its value
+    int64_t value = runtime->host->flagValue(runtime->hostContext, slot);
+    runtime->host->setFlag(runtime->hostContext, slot, value + amount);
+}
+
+static uint32_t VNRuntimeRandomNumber(VNRuntime* runtime, uint32_t upperBound)
+{
+    if( runtime->host->randomNumber != NULL )
+        return runtime->host->randomNumber(runtime->hostContext, upperBound);
+
+    return (uint32_t)rand() % upperBound;
+}
+
+// MARK: - Conversations
+
+static void VNRuntimeUseConversation(VNRuntime* runtime, const VNRuntimeConversation* conversation)
+{
+    runtime->conversation = *conversation;
+    runtime->currentIndex = 0;
+    runtime->indexesDone = 0;
+    runtime->conversationChanges++;
+}
+
+static int VNRuntimeEnterConversation(VNRuntime* runtime, uint32_t index)
+{
+    VNRuntimeConversation conversation = {0};
+    if( runtime->host->enterConversation(runtime->hostContext, index, &conversation) == 0 )
+        return 0;
+
+    VNRuntimeUseConversation(runtime, &conversation);
+    return 1;
+}
+
+static int VNRuntimeEnterConversationNamed(VNRuntime* runtime, const char* name, size_t length)
+{
+    VNRuntimeConversation conversation = {0};
+    if( name == NULL || runtime->host->enterConversationNamed(runtime->hostContext, name, length, &conversation) == 0 )
+        return 0;
+
+    VNRuntimeUseConversation(runtime, &conversation);
+    return 1;
+}
+
+static const VNScriptCommandRecord* VNRuntimeCurrentRecord(const VNRuntime* runtime)
+{
+    if( runtime->indexesDone > runtime->currentIndex )
+        return NULL;
+    if( runtime->indexesDone < 0 || runtime->indexesDone >= runtime->conversation.commandCount )
+        return NULL;
+    if( runtime->conversation.commands == NULL )
+        return NULL;
+
+    return &runtime->conversation.commands[runtime->indexesDone];
+}
+
+// MARK: - Creating runtimes
+
+VNRuntime* VNRuntimeCreate(const VNRuntimeHost* host, void* hostContext, const VNRuntimeBackend* backend, void* backendContext)
+{
+    if( host == NULL || backend == NULL )
+        return NULL;
+
+    VNRuntime* runtime = calloc(1, sizeof(VNRuntime));
+    if( runtime == NULL )
+        return NULL;
+
+    runtime->host = host;
+    runtime->hostContext = hostContext;
+    runtime->backend = backend;
+    runtime->backendContext = backendContext;
+    runtime->state = VNRuntimeStateEnded; // Nothing can run until there's a conversation
+
+    return runtime;
+}
+
+void VNRuntimeFree(VNRuntime* runtime)
+{
+    free(runtime);
+}
+
+int VNRuntimeStartAt(VNRuntime* runtime, const char* conversationName)
+{
+    if( runtime == NULL || conversationName == NULL )
+        return 0;
+
+    if( VNRuntimeEnterConversationNamed(runtime, conversationName, strlen(conversationName)) == 0 ) {
+        fprintf(stderr, "[VNRuntime] ERROR: No section titled %s was found in script!\n", conversationName);
+        return 0;
+    }
+
+    runtime->state = VNRuntimeStateRunning;
+    runtime->choiceCount = 0;
+    return 1;
+}
+
+void VNRuntimeResume(VNRuntime* runtime, const VNRuntimeConversation* conversation, int64_t currentIndex, int64_t indexesDone)
+{
+    if( runtime == NULL || conversation == NULL )
+        return;
+
+    VNRuntimeUseConversation(runtime, conversation);
+    runtime->currentIndex = currentIndex;
+    runtime->indexesDone = indexesDone;
+    runtime->state = VNRuntimeStateRunning;
+    runtime->choiceCount = 0;
+}
+
+// MARK: - Running commands
+
+static void VNRuntimePresent(VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image)
+{
+    VNRuntimeOperation operation;
+    operation.kind = VNRuntimeOperationKindForCommand(command->type);
+    operation.type = command->type;
+    operation.command = command;
+    operation.image = image;
+
+    runtime->backend->present(runtime->backendContext, runtime, &operation);
+}
+
+// Runs a command that's nested inside of another command (like the one at the end of .ISFLAG or .IF). The outer command
+// has already moved the index past its own line, so the index gets moved back afterwards; otherwise the next line
+// would be skipped. If the nested command jumped somewhere else (like .SETCONVERSATION does), it's left alone.
+static void VNRuntimeProcessSecondaryCommand(VNRuntime* runtime, const VNScriptCommandRecord* secondaryCommand, const VNScriptImage* image)
+{
+    uint64_t changesBeforeCommand = runtime->conversationChanges;
+    int64_t indexBeforeCommand = runtime->currentIndex;
+
+    VNRuntimeProcessCommand(runtime, secondaryCommand, image);
+
+    if( runtime->conversationChanges == changesBeforeCommand && runtime->currentIndex >= indexBeforeCommand )
+        runtime->currentIndex--;
+}
+
+// Runs the nested command of .ISFLAG (and the commands like it) if the flag exists and its value passes the check
+static void VNRuntimeProcessFlagCondition(VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image,
+                                          int64_t lowerValue, int64_t upperValue, int secondaryOperand, int type)
+{
+    uint32_t flagSlot = VNRuntimeFlagSlotForOperand(runtime, image, command, 0);
+
+    // Check if the variable even exists in the first place. If not, then this command just terminates.
+    if( VNRuntimeHasFlag(runtime, flagSlot) == 0 )
+        return;
+
+    int64_t actualValue = VNRuntimeFlagValue(runtime, flagSlot);
+    int passed = 0;
+
+    switch( type ) {
+        case VNScriptCommandIfFlagHasValue: passed = (actualValue == lowerValue); break;
+        case VNScriptCommandIsFlagMoreThan: passed = (actualValue > lowerValue); break;
+        case VNScriptCommandIsFlagLessThan: passed = (actualValue < lowerValue); break;
+        case VNScriptCommandIsFlagBetween:  passed = (actualValue > lowerValue && actualValue < upperValue); break;
+    }
+
+    if( passed )
+        VNRuntimeProcessSecondaryCommand(runtime, VNScriptImageOperandCommand(image, command, secondaryOperand), image);
+}
+
+static void VNRuntimeShowChoices(VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image)
+{
+    runtime->choiceCommand = *command;
+    runtime->choiceImage = image;
+    runtime->choiceCount = (int)VNRuntimeListCount(command, 0);
+    runtime->state = VNRuntimeStateChoice;
+
+    VNRuntimePresent(runtime, command, image);
+}
+
+// Handles the commands that change the state of the game, and sends everything else to the backend. This works exactly
+// like 'processCommand' in VNScene used to: dialogue doesn't move the current index forward (so the runtime stops until
+// something calls VNRuntimeAdvance), but every other command does, so that they run one after the other.
+static void VNRuntimeDispatchCommand(VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image)
+{
+
+    runtime->commandsRun++;
+
+    // Check if there's not enough parameters; all commands should have at least one.
+    if( command->operandCount < 1 ) {
+        fprintf(stderr, "[VNRuntime] ERROR: No parameter detected; all commands must have at least 1 parameter!\n");
+        return;
+    }
+
+    if( command->type == VNScriptCommandSayLine ) {
+        VNRuntimePresent(runtime, command, image);
+        return;
+    }
+
+    runtime->currentIndex++;
+
+    switch( command->type ) {
+
+        // Jumps reset the indexes to the start of the new conversation; 'indexesDone' is moved back since it gets
+        // moved forward again as soon as this command is finished.
+        case VNScriptCommandChangeConversation: {
+
+            uint32_t updatedConversation = runtime->host->conversationForOperand(runtime->hostContext, image, command, 0);
+            if( updatedConversation == VNScriptImageNotFound ) {
+                fprintf(stderr, "[VNRuntime] ERROR: No section titled %s was found in script!\n", VNRuntimeOperandName(image, command, 0));
+                return;
+            }
+
+            if( VNRuntimeEnterConversation(runtime, updatedConversation) )
+                runtime->indexesDone--;
+
+        }break;
+
+        case VNScriptCommandJumpOnFlag: {
+
+            uint32_t flagSlot = VNRuntimeFlagSlotForOperand(runtime, image, command, 0);
+            int64_t expectedValue = VNScriptImageOperandInteger(image, command, 1);
+
+            if( VNRuntimeHasFlag(runtime, flagSlot) == 0 || VNRuntimeFlagValue(runtime, flagSlot) != expectedValue )
+                return;
+
+            uint32_t targetedConversation = runtime->host->conversationForOperand(runtime->hostContext, image, command, 2);
+            if( targetedConversation == VNScriptImageNotFound ) {
+                fprintf(stderr, "[VNRuntime] ERROR: No section titled %s was found in script!\n", VNRuntimeOperandName(image, command, 2));
+                return;
+            }
+
+            if( VNRuntimeEnterConversation(runtime, targetedConversation) )
+                runtime->indexesDone--;
+
+        }break;
+
+        case VNScriptCommandSetFlag: {
+
+            uint32_t flagSlot = VNRuntimeFlagSlotForOperand(runtime, image, command, 0);
+            if( flagSlot == VNScriptImageNotFound )
+                return;
+
+            if( runtime->host->setFlagFromOperand != NULL )
+                runtime->host->setFlagFromOperand(runtime->hostContext, flagSlot, image, command, 1);
+            else
+                runtime->host->setFlag(runtime->hostContext, flagSlot, VNScriptImageOperandInteger(image, command, 1));
+
+        }break;
+
+        case VNScriptCommandModifyFlagValue: {
+
+            uint32_t flagSlot = VNRuntimeFlagSlotForOperand(runtime, image, command, 0);
+            VNRuntimeModifyFlag(runtime, flagSlot, VNScriptImageOperandInteger(image, command, 1));
+
+        }break;
+
+        case VNScriptCommandIfFlagHasValue:
+        case VNScriptCommandIsFlagMoreThan:
+        case VNScriptCommandIsFlagLessThan: {
+
+            int64_t expectedValue = VNScriptImageOperandInteger(image, command, 1);
+            VNRuntimeProcessFlagCondition(runtime, command, image, expectedValue, 0, 2, command->type);
+
+        }break;
+
+        case VNScriptCommandIsFlagBetween: {
+
+            int64_t lesserValue = VNScriptImageOperandInteger(image, command, 1);
+            int64_t greaterValue = VNScriptImageOperandInteger(image, command, 2);
+            VNRuntimeProcessFlagCondition(runtime, command, image, lesserValue, greaterValue, 3, command->type);
+
+        }break;
+
+        case VNScriptCommandIf: {
+
+            const VNScriptExpression* condition = NULL;
+            if( runtime->host->expressionForOperand != NULL )
+                condition = runtime->host->expressionForOperand(runtime->hostContext, image, command, 0);
+
+            if( condition == NULL ) {
+                fprintf(stderr, "[VNRuntime] ERROR: The condition [%s] could not be compiled.\n", VNRuntimeOperandName(image, command, 0));
+                return;
+            }
+
+            if( VNScriptExpressionEvaluate(condition, runtime->host->flagValue, runtime->hostContext) == 0 )
+                return;
+
+            VNRuntimeProcessSecondaryCommand(runtime, VNScriptImageOperandCommand(image, command, 1), image);
+
+        }break;
+
+        case VNScriptCommandJumpOnChoice:
+        case VNScriptCommandModifyFlagOnChoice: {
+
+            VNRuntimeShowChoices(runtime, command, image);
+
+        }break;
+
+        // The host replaces the script; nothing from the old script (including this command) gets used after this
+        case VNScriptCommandSwitchScript: {
+
+            const char* scriptName = VNRuntimeOperandName(image, command, 0);
+            const char* startingPoint = VNRuntimeOperandText(image, command, 1, NULL);
+            VNRuntimeConversation conversation = {0};
+
+            if( runtime->host->switchScript == NULL ||
+                runtime->host->switchScript(runtime->hostContext, scriptName, startingPoint, &conversation) == 0 ) {
+                fprintf(stderr, "[VNRuntime] ERROR: Could not switch to script named: %s\n", scriptName);
+                runtime->state = VNRuntimeStateEnded;
+                return;
+            }
+
+            VNRuntimeUseConversation(runtime, &conversation);
+            runtime->indexesDone--;
+
+        }break;
+
+        case VNScriptCommandRollDice: {
+
+            int maximumNumber = (int)VNScriptImageOperandInteger(image, command, 0);
+            int numberOfDice = (int)VNScriptImageOperandInteger(image, command, 1);
+            const char* flagName = VNRuntimeOperandText(image, command, 2, NULL);
+            int64_t flagModifier = 0;
+
+            // Use the flag's value as a modifier, unless there isn't a flag (flags that don't exist count as zero)
+            if( flagName != NULL && strcasecmp(flagName, VNRuntimeNilValue) != 0 )
+                flagModifier = VNRuntimeFlagValue(runtime, VNRuntimeFlagSlotForOperand(runtime, image, command, 2));
+
+            // Same rules as EKRollDice
+            if( numberOfDice < 1 )
+                numberOfDice = 1;
+            if( maximumNumber < 2 )
+                maximumNumber = 2;
+
+            int64_t resultOfRoll = flagModifier;
+            for( int i = 0; i < numberOfDice; i++ )
+                resultOfRoll += VNRuntimeRandomNumber(runtime, (uint32_t)maximumNumber) + 1;
+
+            uint32_t resultSlot = runtime->host->flagSlotForName(runtime->hostContext, VNRuntimeDiceRollFlagName, strlen(VNRuntimeDiceRollFlagName));
+            if( resultSlot != VNScriptImageNotFound )
+                runtime->host->setFlag(runtime->hostContext, resultSlot, resultOfRoll);
+
+        }break;
+
+        default: {
+
+            VNRuntimePresent(runtime, command, image);
+
+        }break;
+    }
+}
+
+// Every command goes through here (including nested ones), so this is where the per-command stats are recorded
+static void VNRuntimeProcessCommand(VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image)
+{
+    if( command == NULL )
+        return;
+
+    // The type is copied first, since the command might not exist anymore once it's been run (after .SWITCHSCRIPT)
+    int type = command->type;
+    uint64_t startTime = VNStatsStart();
+    VNRuntimeDispatchCommand(runtime, command, image);
+    VNStatsRecordCommand(type, startTime);
+}
+
+// MARK: - Running scripts
+
+uint32_t VNRuntimeRun(VNRuntime* runtime)
+{
+    if( runtime == NULL )
+        return 0;
+
+    uint32_t commandsRun = 0;
+
+    // Keep going until a line of dialogue needs to be read, or until an effect or a choice menu gets in the way
+    while( runtime->state == VNRuntimeStateRunning && runtime->indexesDone <= runtime->currentIndex ) {
+
+        const VNScriptCommandRecord* command = VNRuntimeCurrentRecord(runtime);
+        if( command == NULL ) {
+            runtime->state = VNRuntimeStateEnded;
+            break;
+        }
+
+        // The image is copied here, since the command might switch to a different conversation (or script)
+        const VNScriptImage* image = runtime->conversation.image;
+
+        if( runtime->backend->willRunCommand != NULL )
+            runtime->backend->willRunCommand(runtime->backendContext, runtime, command, image);
+
+        VNRuntimeProcessCommand(runtime, command, image);
+        runtime->indexesDone++;
+        commandsRun++;
+    }
+
+    return commandsRun;
+}
+
+int VNRuntimeAdvance(VNRuntime* runtime)
+{
+    if( runtime == NULL || runtime->state != VNRuntimeStateRunning )
+        return 0;
+
+    runtime->currentIndex++;
+    return 1;
+}
+
+int VNRuntimeChoose(VNRuntime* runtime, int choice)
+{
+    if( runtime == NULL || runtime->state != VNRuntimeStateChoice )
+        return 0;
+    if( choice < 0 || choice >= runtime->choiceCount )
+        return 0;
+
+    const VNScriptCommandRecord* command = &runtime->choiceCommand;
+    const VNScriptImage* image = runtime->choiceImage;
+    uint32_t length = 0;
+
+    runtime->state = VNRuntimeStateRunning;
+    runtime->choiceCount = 0;
+
+    if( command->type == VNScriptCommandJumpOnChoice ) {
+
+        // Destinations are normally resolved ahead of time by the linker; only ones that weren't get looked up by name
+        uint32_t destinationIndex = VNScriptImageNotFound;
+        if( runtime->host->conversationForListItem != NULL )
+            destinationIndex = runtime->host->conversationForListItem(runtime->hostContext, image, command, 1, (uint32_t)choice);
+
+        if( destinationIndex != VNScriptImageNotFound && VNRuntimeEnterConversation(runtime, destinationIndex) )
+            return 1;
+
+        // If the conversation doesn't exist, the script just carries on from the line after the choice
+        const char* destination = VNRuntimeListItem(image, command, 1, (uint32_t)choice, &length);
+        if( VNRuntimeEnterConversationNamed(runtime, destination, length) == 0 )
+            fprintf(stderr, "[VNRuntime] ERROR: No section titled %s was found in script!\n", (destination != NULL) ? destination : "");
+
+    } else {
+
+        const char* flagName = VNRuntimeListItem(image, command, 1, (uint32_t)choice, &length);
+        const char* flagValue = VNRuntimeListItem(image, command, 2, (uint32_t)choice, NULL);
+
+        if( flagName != NULL && flagValue != NULL ) {
+            uint32_t flagSlot = runtime->host->flagSlotForName(runtime->hostContext, flagName, length);
+            VNRuntimeModifyFlag(runtime, flagSlot, strtoll(flagValue, NULL, 10));
+        }
+    }
+
+    return 1;
+}
+
+void VNRuntimeBeginEffect(VNRuntime* runtime)
+{
+    if( runtime != NULL && runtime->state == VNRuntimeStateRunning )
+        runtime->state = VNRuntimeStateEffect;
+}
+
+void VNRuntimeEndEffect(VNRuntime* runtime)
+{
+    if( runtime != NULL && runtime->state == VNRuntimeStateEffect )
+        runtime->state = VNRuntimeStateRunning;
+}
+
+void VNRuntimeFinish(VNRuntime* runtime)
+{
+    if( runtime != NULL )
+        runtime->state = VNRuntimeStateEnded;
+}
+
+// MARK: - State
+
+VNRuntimeState VNRuntimeGetState(const VNRuntime* runtime)
+{
+    return (runtime != NULL) ? runtime->state : VNRuntimeStateEnded;
+}
+
+int VNRuntimeIsWaitingForInput(const VNRuntime* runtime)
+{
+    return (runtime != NULL && runtime->state == VNRuntimeStateRunning && runtime->indexesDone > runtime->currentIndex);
+}
+
+int64_t VNRuntimeCurrentIndex(const VNRuntime* runtime)
+{
+    return (runtime != NULL) ? runtime->currentIndex : 0;
+}
+
+int64_t VNRuntimeIndexesDone(const VNRuntime* runtime)
+{
+    return (runtime != NULL) ? runtime->indexesDone : 0;
+}
+
+const VNRuntimeConversation* VNRuntimeCurrentConversation(const VNRuntime* runtime)
+{
+    return (runtime != NULL) ? &runtime->conversation : NULL;
+}
+
+int VNRuntimeChoiceCount(const VNRuntime* runtime)
+{
+    return (runtime != NULL && runtime->state == VNRuntimeStateChoice) ? runtime->choiceCount : 0;
+}
+
+const char* VNRuntimeChoiceText(const VNRuntime* runtime, int choice)
+{
+    if( choice < 0 || choice >= VNRuntimeChoiceCount(runtime) )
+        return NULL;
+
+    return VNRuntimeListItem(runtime->choiceImage, &runtime->choiceCommand, 0, (uint32_t)choice, NULL);
+}
+
+uint64_t VNRuntimeCommandsRun(const VNRuntime* runtime)
+{
+    return (runtime != NULL) ? runtime->commandsRun : 0;
+}
+
+VNRuntimeOperationKind VNRuntimeOperationKindForCommand(int type)
+{
+    switch( type ) {
+
+        case VNScriptCommandSayLine:                return VNRuntimeOperationSayLine;
+        case VNScriptCommandSetSpeaker:             return VNRuntimeOperationSpeaker;
+
+        case VNScriptCommandAddSprite:
+        case VNScriptCommandRemoveSprite:
+        case VNScriptCommandAlignSprite:
+        case VNScriptCommandSetSpritePosition:
+        case VNScriptCommandFlipSprite:
+        case VNScriptCommandScaleSprite:
+        case VNScriptCommandSetSpriteAlias:         return VNRuntimeOperationSprite;
+
+        case VNScriptCommandEffectMoveSprite:
+        case VNScriptCommandEffectMoveBackground:   return VNRuntimeOperationMove;
+
+        case VNScriptCommandEffectFadeIn:
+        case VNScriptCommandEffectFadeOut:          return VNRuntimeOperationFade;
+
+        case VNScriptCommandSetBackground:
+        case VNScriptCommandScaleBackground:        return VNRuntimeOperationBackground;
+
+        case VNScriptCommandPlaySound:              return VNRuntimeOperationSound;
+        case VNScriptCommandPlayMusic:              return VNRuntimeOperationMusic;
+
+        case VNScriptCommandShowSpeechOrNot:
+        case VNScriptCommandSetSpeechFont:
+        case VNScriptCommandSetSpeechFontSize:
+        case VNScriptCommandSetSpeakerFont:
+        case VNScriptCommandSetSpeakerFontSize:
+        case VNScriptCommandSetCinematicText:
+        case VNScriptCommandSetTypewriterText:
+        case VNScriptCommandSetSpeechbox:
+        case VNScriptCommandModifyChoiceboxOffset:  return VNRuntimeOperationText;
+
+        case VNScriptCommandJumpOnChoice:
+        case VNScriptCommandModifyFlagOnChoice:     return VNRuntimeOperationChoice;
+
+        case VNScriptCommandSystemCall:             return VNRuntimeOperationSystemCall;
+    }
+
+    return VNRuntimeOperationOther;
+}
+
+// MARK: - Image host
+
+#define VNRuntimeImageHostFirstFlagCapacity     64
+
+typedef struct {
+    VNScriptImage* image;
+    VNScriptExpression** expressions;   // One per string in the image (compiled the first time that string is used as a condition)
+    uint8_t* expressionFailed;          // Set for strings that couldn't be compiled, so they don't get compiled again
+} VNRuntimeImageHostScript;
+
+typedef struct {
+    char* name;
+    int64_t value;
+    int exists;
+} VNRuntimeImageHostFlag;
+
+struct VNRuntimeImageHost {
+
+    char* directory;
+
+    VNRuntimeImageHostScript* scripts;  // Every image that's been opened (the current one is 'currentScript')
+    uint32_t scriptCount;
+    uint32_t currentScript;
+
+    // Flags are stored in slot order; the index is an open-addressed hash table of slot numbers (plus one, so that
+    // zero means "empty"), and is always kept at least half empty.
+    VNRuntimeImageHostFlag* flags;
+    uint32_t flagCount;
+    uint32_t flagCapacity;
+    uint32_t* flagIndex;
+    uint32_t flagIndexSize;
+};
+
+static uint32_t VNRuntimeImageHostHashName(const char* name, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for( size_t i = 0; i < length; i++ ) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static int VNRuntimeImageHostGrowFlagIndex(VNRuntimeImageHost* host)
+{
+    uint32_t newSize = (host->flagIndexSize == 0) ? (VNRuntimeImageHostFirstFlagCapacity * 2) : (host->flagIndexSize * 2);
+    uint32_t* newIndex = calloc(newSize, sizeof(uint32_t));
+    if( newIndex == NULL )
+        return 0;
+
+    for( uint32_t slot = 0; slot < host->flagCount; slot++ ) {
+        const char* name = host->flags[slot].name;
+        uint32_t position = VNRuntimeImageHostHashName(name, strlen(name)) & (newSize - 1);
+        while( newIndex[position] != 0 )
+            position = (position + 1) & (newSize - 1);
+        newIndex[position] = slot + 1;
+    }
+
+    free(host->flagIndex);
+    host->flagIndex = newIndex;
+    host->flagIndexSize = newSize;
+    return 1;
+}
+
+// Returns the slot for a flag name, creating it if it doesn't exist yet
+static uint32_t VNRuntimeImageHostFlagSlot(VNRuntimeImageHost* host, const char* name, size_t length)
+{
+    if( name == NULL )
+        return VNScriptImageNotFound;
+
+    if( host->flagIndexSize == 0 && VNRuntimeImageHostGrowFlagIndex(host) == 0 )
+        return VNScriptImageNotFound;
+
+    uint32_t mask = host->flagIndexSize - 1;
+    uint32_t position = VNRuntimeImageHostHashName(name, length) & mask;
+
+    while( host->flagIndex[position] != 0 ) {
+        const char* existingName = host->flags[host->flagIndex[position] - 1].name;
+        if( strlen(existingName) == length && memcmp(existingName, name, length) == 0 )
+            return host->flagIndex[position] - 1;
+        position = (position + 1) & mask;
+    }
+
+    // Add a new slot
+    if( host->flagCount == host->flagCapacity ) {
+        uint32_t newCapacity = (host->flagCapacity == 0) ? VNRuntimeImageHostFirstFlagCapacity : (host->flagCapacity * 2);
+        VNRuntimeImageHostFlag* newFlags = realloc(host->flags, newCapacity * sizeof(VNRuntimeImageHostFlag));
+        if( newFlags == NULL )
+            return VNScriptImageNotFound;
+        host->flags = newFlags;
+        host->flagCapacity = newCapacity;
+    }
+
+    char* nameCopy = malloc(length + 1);
+    if( nameCopy == NULL )
+        return VNScriptImageNotFound;
+    memcpy(nameCopy, name, length);
+    nameCopy[length] = '\0';
+
+    uint32_t slot = host->flagCount++;
+    host->flags[slot].name = nameCopy;
+    host->flags[slot].value = 0;
+    host->flags[slot].exists = 0;
+    host->flagIndex[position] = slot + 1;
+
+    if( host->flagCount * 2 > host->flagIndexSize )
+        VNRuntimeImageHostGrowFlagIndex(host);
+
+    return slot;
+}
+
+static VNRuntimeImageHostScript* VNRuntimeImageHostCurrentScript(VNRuntimeImageHost* host)
+{
+    return &host->scripts[host->currentScript];
+}
+
+static int VNRuntimeImageHostAddScript(VNRuntimeImageHost* host, VNScriptImage* image)
+{
+    VNRuntimeImageHostScript* newScripts = realloc(host->scripts, (host->scriptCount + 1) * sizeof(VNRuntimeImageHostScript));
+    if( newScripts == NULL )
+        return 0;
+    host->scripts = newScripts;
+
+    uint32_t stringCount = image->header->stringCount;
+    VNRuntimeImageHostScript* script = &host->scripts[host->scriptCount];
+    script->image = image;
+    script->expressions = calloc((stringCount > 0) ? stringCount : 1, sizeof(VNScriptExpression*));
+    script->expressionFailed = calloc((stringCount > 0) ? stringCount : 1, 1);
+
+    if( script->expressions == NULL || script->expressionFailed == NULL ) {
+        free(script->expressions);
+        free(script->expressionFailed);
+        return 0;
+    }
+
+    host->currentScript = host->scriptCount++;
+    return 1;
+}
+
+VNRuntimeImageHost* VNRuntimeImageHostCreate(VNScriptImage* image, const char* directory)
+{
+    if( image == NULL )
+        return NULL;
+
+    VNRuntimeImageHost* host = calloc(1, sizeof(VNRuntimeImageHost));
+    if( host == NULL )
+        return NULL;
+
+    if( directory != NULL )
+        host->directory = strdup(directory);
+
+    if( VNRuntimeImageHostAddScript(host, image) == 0 ) {
+        free(host->directory);
+        free(host);
+        return NULL;
+    }
+
+    return host;
+}
+
+void VNRuntimeImageHostFree(VNRuntimeImageHost* host)
+{
+    if( host == NULL )
+        return;
+
+    for( uint32_t i = 0; i < host->scriptCount; i++ ) {
+        VNRuntimeImageHostScript* script = &host->scripts[i];
+        for( uint32_t string = 0; string < script->image->header->stringCount; string++ )
+            VNScriptExpressionFree(script->expressions[string]);
+        free(script->expressions);
+        free(script->expressionFailed);
+        VNScriptImageClose(script->image);
+    }
+
+    for( uint32_t slot = 0; slot < host->flagCount; slot++ )
+        free(host->flags[slot].name);
+
+    free(host->scripts);
+    free(host->flags);
+    free(host->flagIndex);
+    free(host->directory);
+    free(host);
+}
+
+int64_t VNRuntimeImageHostFlagValue(VNRuntimeImageHost* host, const char* name)
+{
+    uint32_t slot = VNRuntimeImageHostFlagSlot(host, name, (name != NULL) ? strlen(name) : 0);
+    return (slot != VNScriptImageNotFound) ? host->flags[slot].value : 0;
+}
+
+void VNRuntimeImageHostSetFlag(VNRuntimeImageHost* host, const char* name, int64_t value)
+{
+    uint32_t slot = VNRuntimeImageHostFlagSlot(host, name, (name != NULL) ? strlen(name) : 0);
+    if( slot == VNScriptImageNotFound )
+        return;
+
+    host->flags[slot].value = value;
+    host->flags[slot].exists = 1;
+}
+
+// MARK: Image host callbacks
+
+static int VNRuntimeImageHostDescribeConversation(VNRuntimeImageHost* host, uint32_t index, VNRuntimeConversation* conversation)
+{
+    const VNScriptImage* image = VNRuntimeImageHostCurrentScript(host)->image;
+    if( index >= image->header->conversationCount )
+        return 0;
+
+    const VNScriptConversationEntry* entry = &image->conversations[index];
+    conversation->image = image;
+    conversation->commands = &image->commands[entry->firstCommand];
+    conversation->commandCount = entry->commandCount;
+    return 1;
+}
+
+static int VNRuntimeImageHostEnterConversation(void* context, uint32_t index, VNRuntimeConversation* conversation)
+{
+    return VNRuntimeImageHostDescribeConversation((VNRuntimeImageHost*)context, index, conversation);
+}
+
+static int VNRuntimeImageHostEnterConversationNamed(void* context, const char* name, size_t length, VNRuntimeConversation* conversation)
+{
+    VNRuntimeImageHost* host = (VNRuntimeImageHost*)context;
+    uint32_t index = VNScriptImageFindConversation(VNRuntimeImageHostCurrentScript(host)->image, name, length);
+    if( index == VNScriptImageNotFound )
+        return 0;
+
+    return VNRuntimeImageHostDescribeConversation(host, index, conversation);
+}
+
+static uint32_t VNRuntimeImageHostConversationForOperand(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    (void)context;
+
+    uint32_t length = 0;
+    const char* name = VNRuntimeOperandText(image, command, operand, &length);
+    if( name == NULL )
+        return VNScriptImageNotFound;
+
+    return VNScriptImageFindConversation(image, name, length);
+}
+
+static int VNRuntimeImageHostSwitchScript(void* context, const char* scriptName, const char* conversationName, VNRuntimeConversation* conversation)
+{
+    VNRuntimeImageHost* host = (VNRuntimeImageHost*)context;
+    if( host->directory == NULL )
+        return 0;
+
+    size_t pathLength = strlen(host->directory) + strlen(scriptName) + strlen(VNScriptImageFileExtension) + 3;
+    char* path = malloc(pathLength);
+    if( path == NULL )
+        return 0;
+    snprintf(path, pathLength, "%s/%s.%s", host->directory, scriptName, VNScriptImageFileExtension);
+
+    VNScriptImage* image = VNScriptImageOpenFile(path);
+    free(path);
+
+    if( image == NULL || VNRuntimeImageHostAddScript(host, image) == 0 ) {
+        VNScriptImageClose(image);
+        return 0;
+    }
+
+    // Scripts start at the beginning unless they're told otherwise (just like VNScript)
+    if( conversationName == NULL || strcasecmp(conversationName, VNRuntimeNilValue) == 0 )
+        conversationName = "start";
+
+    return VNRuntimeImageHostEnterConversationNamed(host, conversationName, strlen(conversationName), conversation);
+}
+
+static uint32_t VNRuntimeImageHostFlagSlotForName(void* context, const char* name, size_t length)
+{
+    return VNRuntimeImageHostFlagSlot((VNRuntimeImageHost*)context, name, length);
+}
+
+static int VNRuntimeImageHostHasFlag(void* context, uint32_t slot)
+{
+    VNRuntimeImageHost* host = (VNRuntimeImageHost*)context;
+    return (slot < host->flagCount && host->flags[slot].exists);
+}
+
+static int64_t VNRuntimeImageHostFlagValueForSlot(void* context, uint32_t slot)
+{
+    VNRuntimeImageHost* host = (VNRuntimeImageHost*)context;
+    return (slot < host->flagCount) ? host->flags[slot].value : 0;
+}
+
+static void VNRuntimeImageHostSetFlagForSlot(void* context, uint32_t slot, int64_t value)
+{
+    VNRuntimeImageHost* host = (VNRuntimeImageHost*)context;
+    if( slot >= host->flagCount )
+        return;
+
+    host->flags[slot].value = value;
+    host->flags[slot].exists = 1;
+}
+
+static const VNScriptExpression* VNRuntimeImageHostExpressionForOperand(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    VNRuntimeImageHost* host = (VNRuntimeImageHost*)context;
+    VNRuntimeImageHostScript* script = NULL;
+
+    // The command might come from any of the images that have been opened (though it's nearly always the current one)
+    for( uint32_t i = host->scriptCount; i > 0 && script == NULL; i-- ) {
+        if( host->scripts[i - 1].image == image )
+            script = &host->scripts[i - 1];
+    }
+
+    uint32_t length = 0;
+    const char* source = VNRuntimeOperandText(image, command, operand, &length);
+    if( script == NULL || source == NULL )
+        return NULL;
+
+    uint32_t string = command->operands[operand].ref.index;
+    if( script->expressions[string] == NULL && script->expressionFailed[string] == 0 ) {
+
+        char error[VNScriptExpressionErrorLength];
+        script->expressions[string] = VNScriptExpressionCompile(source, length, VNRuntimeImageHostFlagSlotForName, host, error, sizeof(error));
+
+        if( script->expressions[string] == NULL ) {
+            fprintf(stderr, "[VNRuntime] ERROR: %s\n", error);
+            script->expressionFailed[string] = 1;
+        }
+    }
+
+    return script->expressions[string];
+}
+
+static const VNRuntimeHost VNRuntimeImageHostFunctions = {
+    .enterConversation          = VNRuntimeImageHostEnterConversation,
+    .enterConversationNamed     = VNRuntimeImageHostEnterConversationNamed,
+    .conversationForOperand     = VNRuntimeImageHostConversationForOperand,
+    .conversationForListItem    = NULL,
+    .switchScript               = VNRuntimeImageHostSwitchScript,
+    .flagSlotForName            = VNRuntimeImageHostFlagSlotForName,
+    .flagSlotForOperand         = NULL,
+    .hasFlag                    = VNRuntimeImageHostHasFlag,
+    .flagValue                  = VNRuntimeImageHostFlagValueForSlot,
+    .setFlag                    = VNRuntimeImageHostSetFlagForSlot,
+    .setFlagFromOperand         = NULL,
+    .expressionForOperand       = VNRuntimeImageHostExpressionForOperand,
+    .randomNumber               = NULL,
+};
+
+const VNRuntimeHost* VNRuntimeImageHostCallbacks(void)
+{
+    return &VNRuntimeImageHostFunctions;
+}
+
+// MARK: - Null backend
+
+static void VNRuntimeNullBackendPresent(void* context, VNRuntime* runtime, const VNRuntimeOperation* operation)
+{
+    VNRuntimeNullBackend* backend = (VNRuntimeNullBackend*)context;
+    backend->operationCounts[operation->kind]++;
+
+    if( backend->transcript == NULL )
+        return;
+
+    if( operation->kind == VNRuntimeOperationSayLine ) {
+        const char* text = VNRuntimeOperandText(operation->image, operation->command, 0, NULL);
+        fprintf(backend->transcript, "%s\n", (text != NULL) ? text : "");
+    } else if( operation->kind == VNRuntimeOperationChoice ) {
+        for( int i = 0; i < VNRuntimeChoiceCount(runtime); i++ )
+            fprintf(backend->transcript, "  %d. %s\n", i + 1, VNRuntimeChoiceText(runtime, i));
+    }
+}
+
+static const VNRuntimeBackend VNRuntimeNullBackendFunctions = {
+    .present            = VNRuntimeNullBackendPresent,
+    .willRunCommand     = NULL,
+};
+
+const VNRuntimeBackend* VNRuntimeNullBackendCallbacks(void)
+{
+    return &VNRuntimeNullBackendFunctions;
+}
+
+uint64_t VNRuntimeRunHeadless(VNRuntime* runtime, uint64_t maxCommands, VNRuntimeChooser chooser, void* context)
+{
+    if( runtime == NULL )
+        return 0;
+
+    uint64_t commandsBefore = runtime->commandsRun;
+
+    while( maxCommands == 0 || runtime->commandsRun - commandsBefore < maxCommands ) {
+
+        VNRuntimeRun(runtime);
+
+        switch( runtime->state ) {
+
+            case VNRuntimeStateRunning:
+                VNRuntimeAdvance(runtime);
+                break;
+
+            case VNRuntimeStateEffect:
+                VNRuntimeEndEffect(runtime);
+                break;
+
+            case VNRuntimeStateChoice: {
+
+                int choice = (chooser != NULL) ? chooser(context, runtime, runtime->choiceCount) : 0;
+                if( VNRuntimeChoose(runtime, choice) == 0 ) {
+                    fprintf(stderr, "[VNRuntime] ERROR: Choice %d is not one of the %d choices available.\n", choice, runtime->choiceCount);
+                    runtime->state = VNRuntimeStateEnded;
+                }
+
+            }break;
+
+            case VNRuntimeStateEnded:
+                return runtime->commandsRun - commandsBefore;
+        }
+    }
+
+    return runtime->commandsRun - commandsBefore;
+}
@@ -0,0 +1,241 @@
+//
+//  VNRuntime.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNRuntime
+
+ The part of EKVN that actually runs a script, without anything to do with how the script gets shown to the player.
+ The runtime keeps track of where it is in the script (the current conversation and the two indexes that VNScript
+ has always used), and it handles every command that only affects the state of the game: flags, conditions, jumps
+ to other conversations, switching scripts, dice rolls, and what happens after the player makes a choice.
+
+ Everything else (showing a line of dialogue, adding a sprite, fading the scene out, playing a sound...) gets passed
+ to a "backend" as a VNRuntimeOperation. The backend decides what those operations look like; VNScene is the backend
+ that draws everything with SpriteKit, but a backend could just as easily print the dialogue to a terminal, or do
+ nothing at all. The runtime only needs to hear back from the backend in two cases:
+
+   1. Effects      - If an operation takes time (like a fade), the backend calls VNRuntimeBeginEffect, and then
+                     VNRuntimeEndEffect when it's done. The runtime doesn't run any commands in between.
+   2. Choices      - Choice menus are shown by the backend, but the runtime waits until the backend (or the
+                     player) calls VNRuntimeChoose, and then makes the jump or changes the flag itself.
+
+ Lines of dialogue work the same way that they always have: the runtime stops after each one, until something calls
+ VNRuntimeAdvance (normally when the player taps the screen, or when cinematic text moves things along).
+
+ The runtime doesn't know where the script or the flags actually come from either; it asks a "host" for those (see
+ VNRuntimeHost). VNScene uses VNScript and EKFlagTable. For running scripts without any of the app (on a server, in
+ a command-line tool, or while testing scripts on Linux), this file also includes a host that runs a compiled script
+ image (see VNScriptImage.h) with its own flag table, and a "null" backend that just counts operations:
+
+   VNRuntimeImageHost* host = VNRuntimeImageHostCreate(VNScriptImageOpenFile("chapter 1.vnsb"), ".");
+   VNRuntimeNullBackend backend = {0};
+   VNRuntime* runtime = VNRuntimeCreate(VNRuntimeImageHostCallbacks(), host, VNRuntimeNullBackendCallbacks(), &backend);
+   VNRuntimeStartAt(runtime, "start");
+   VNRuntimeRunHeadless(runtime, 0, NULL, NULL);
+
+ That only needs VNRuntime.c, VNScriptImage.c, VNScriptExpression.c and VNScriptCommands.c to build.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNRuntime_h
+#define VNRuntime_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "VNScriptImage.h"
+#include "VNScriptExpression.h"
+
+// MARK: - Definitions
+
+#define VNRuntimeDiceRollFlagName       "DICEROLL"  // Flag that stores the result of .ROLLDICE (same as VNSceneDiceRollResultFlag)
+#define VNRuntimeNilValue               "nil"       // Same as VNScriptNilValue
+#define VNRuntimeNoChoice               -1
+
+typedef enum {
+    VNRuntimeStateRunning   = 0,    // Commands get run (until a line of dialogue is waiting for VNRuntimeAdvance)
+    VNRuntimeStateEffect    = 1,    // Waiting for VNRuntimeEndEffect
+    VNRuntimeStateChoice    = 2,    // Waiting for VNRuntimeChoose
+    VNRuntimeStateEnded     = 3,    // The script has run out of commands (or VNRuntimeFinish was called)
+} VNRuntimeState;
+
+// What kind of presentation operation a command is. Backends can use this to handle whole groups of commands the same
+// way (a backend that doesn't show graphics can ignore everything except dialogue, for example), and can still check
+// the command type for the details.
+typedef enum {
+    VNRuntimeOperationSayLine       = 0,    // .SAYLINE (a line of dialogue)
+    VNRuntimeOperationSpeaker       = 1,    // .SETSPEAKER
+    VNRuntimeOperationSprite        = 2,    // Adding, removing, aligning, positioning, flipping or scaling sprites (and sprite aliases)
+    VNRuntimeOperationMove          = 3,    // .MOVESPRITE and .MOVEBACKGROUND
+    VNRuntimeOperationFade          = 4,    // .FADEIN and .FADEOUT
+    VNRuntimeOperationBackground    = 5,    // .SETBACKGROUND and .SCALEBACKGROUND
+    VNRuntimeOperationSound         = 6,    // .PLAYSOUND
+    VNRuntimeOperationMusic         = 7,    // .PLAYMUSIC
+    VNRuntimeOperationText          = 8,    // Speech box, fonts, cinematic/typewriter text, choice box offsets
+    VNRuntimeOperationChoice        = 9,    // .JUMPONCHOICE and .MODIFYFLAGBYCHOICE (the runtime waits for VNRuntimeChoose)
+    VNRuntimeOperationSystemCall    = 10,   // .SYSTEMCALL
+    VNRuntimeOperationOther         = 11,   // Anything else (including commands that the runtime doesn't know about)
+    VNRuntimeOperationKindCount     = 12,
+} VNRuntimeOperationKind;
+
+typedef struct {
+    VNRuntimeOperationKind kind;
+    int type;                                   // The command type (one of the VNScriptCommand values)
+    const VNScriptCommandRecord* command;       // The command's operands (only valid until the backend returns)
+    const VNScriptImage* image;                 // The image that the command's strings come from
+} VNRuntimeOperation;
+
+// The commands in one conversation. Conversations are stored contiguously in script images, so this is just a pointer
+// to the first command. The host has to keep the conversation's memory around until the runtime changes conversations.
+typedef struct {
+    const VNScriptImage* image;
+    const VNScriptCommandRecord* commands;
+    uint32_t commandCount;
+} VNRuntimeConversation;
+
+typedef struct VNRuntime VNRuntime;
+
+// MARK: - Hosts and backends
+
+// Where the script and the flags come from. Callbacks marked as optional can be NULL. Callbacks that return an int
+// return nonzero if they worked.
+typedef struct {
+
+    // Conversations. When the runtime switches to a conversation, its indexes always start over at zero.
+    int (*enterConversation)(void* context, uint32_t index, VNRuntimeConversation* conversation);
+    int (*enterConversationNamed)(void* context, const char* name, size_t length, VNRuntimeConversation* conversation);
+    uint32_t (*conversationForOperand)(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand);
+
+    // Same as 'conversationForOperand', but for one of the names in a list (like the destinations in .JUMPONCHOICE).
+    // Optional; if it's NULL (or doesn't find anything), the conversation is looked up by name instead.
+    uint32_t (*conversationForListItem)(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand, uint32_t item);
+
+    // Replaces the script with a different one, starting at one of its conversations. After this, the command that
+    // caused the switch (and everything else from the old script) is never used again.
+    int (*switchScript)(void* context, const char* scriptName, const char* conversationName, VNRuntimeConversation* conversation);
+
+    // Flag slots. 'flagSlotForOperand' is optional (flags are looked up by name if it's NULL, or if it doesn't find anything).
+    uint32_t (*flagSlotForName)(void* context, const char* name, size_t length);
+    uint32_t (*flagSlotForOperand)(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand);
+
+    // Flag values. 'setFlagFromOperand' is optional; it's for hosts that can store flags that aren't numbers (like
+    // EKFlagTable), and if it's NULL, .SETFLAG stores the operand as an integer.
+    int (*hasFlag)(void* context, uint32_t slot);
+    int64_t (*flagValue)(void* context, uint32_t slot); // Flags that don't exist count as 0
+    void (*setFlag)(void* context, uint32_t slot, int64_t value);
+    void (*setFlagFromOperand)(void* context, uint32_t slot, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand);
+
+    // The compiled condition used by .IF (optional; without it, .IF conditions are always false)
+    const VNScriptExpression* (*expressionForOperand)(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand);
+
+    // Returns a random number from 0 up to (but not including) 'upperBound'. Optional; rand() is used if it's NULL.
+    uint32_t (*randomNumber)(void* context, uint32_t upperBound);
+
+} VNRuntimeHost;
+
+typedef struct {
+
+    // Shows (or plays, or whatever the backend does with) an operation
+    void (*present)(void* context, VNRuntime* runtime, const VNRuntimeOperation* operation);
+
+    // Called before every command is run, including the ones that the runtime handles itself (optional)
+    void (*willRunCommand)(void* context, VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image);
+
+} VNRuntimeBackend;
+
+// MARK: - Creating runtimes
+
+// Neither the host nor the backend is copied, so they both need to stay valid as long as the runtime does
+VNRuntime* VNRuntimeCreate(const VNRuntimeHost* host, void* hostContext, const VNRuntimeBackend* backend, void* backendContext);
+void VNRuntimeFree(VNRuntime* runtime);
+
+// Starts (or restarts) at the beginning of a conversation. Returns 0 if there's no such conversation.
+int VNRuntimeStartAt(VNRuntime* runtime, const char* conversationName);
+
+// Picks up from a particular point in a conversation, such as when a game is loaded from a save. The state is set to
+// VNRuntimeStateRunning.
+void VNRuntimeResume(VNRuntime* runtime, const VNRuntimeConversation* conversation, int64_t currentIndex, int64_t indexesDone);
+
+// MARK: - Running scripts
+
+// Runs commands until the runtime has to wait for something (dialogue, an effect or a choice), or until the script ends.
+// Returns the number of commands that were run.
+uint32_t VNRuntimeRun(VNRuntime* runtime);
+
+// Moves past the current line of dialogue. Returns 0 (and does nothing) unless the runtime is running normally.
+int VNRuntimeAdvance(VNRuntime* runtime);
+
+// Picks one of the choices from the current choice menu (choices are numbered from zero). Returns 0 if the runtime
+// isn't waiting for a choice, or if there's no such choice.
+int VNRuntimeChoose(VNRuntime* runtime, int choice);
+
+void VNRuntimeBeginEffect(VNRuntime* runtime);
+void VNRuntimeEndEffect(VNRuntime* runtime);
+void VNRuntimeFinish(VNRuntime* runtime);
+
+// MARK: - State
+
+VNRuntimeState VNRuntimeGetState(const VNRuntime* runtime);
+int VNRuntimeIsWaitingForInput(const VNRuntime* runtime); // Running, with a line of dialogue waiting for VNRuntimeAdvance
+
+// The same indexes that VNScript stores in saved games (see VNScriptCurrentIndexKey and VNScriptIndexesDoneKey)
+int64_t VNRuntimeCurrentIndex(const VNRuntime* runtime);
+int64_t VNRuntimeIndexesDone(const VNRuntime* runtime);
+const VNRuntimeConversation* VNRuntimeCurrentConversation(const VNRuntime* runtime);
+
+// The choice menu that the runtime is waiting on (the count is 0 if there isn't one)
+int VNRuntimeChoiceCount(const VNRuntime* runtime);
+const char* VNRuntimeChoiceText(const VNRuntime* runtime, int choice);
+
+// Total number of commands run so far (including nested commands)
+uint64_t VNRuntimeCommandsRun(const VNRuntime* runtime);
+
+VNRuntimeOperationKind VNRuntimeOperationKindForCommand(int type);
+
+// MARK: - Headless use
+
+/*
+
+ VNRuntimeImageHost runs compiled script images (.vnsb files) without VNScript or EKFlagTable. Flags are kept in the
+ host itself, conversation names are looked up in the image, and conditions are compiled the first time they're used.
+ If the host has a directory, .SWITCHSCRIPT opens "<directory>/<script name>.vnsb"; every image that gets opened stays
+ open until the host is freed.
+
+ */
+
+typedef struct VNRuntimeImageHost VNRuntimeImageHost;
+
+// The host takes ownership of the image (which can't be NULL). The directory is copied, and can be NULL.
+VNRuntimeImageHost* VNRuntimeImageHostCreate(VNScriptImage* image, const char* directory);
+void VNRuntimeImageHostFree(VNRuntimeImageHost* host);
+const VNRuntimeHost* VNRuntimeImageHostCallbacks(void);
+
+// Flags that don't exist count as 0
+int64_t VNRuntimeImageHostFlagValue(VNRuntimeImageHost* host, const char* name);
+void VNRuntimeImageHostSetFlag(VNRuntimeImageHost* host, const char* name, int64_t value);
+
+// The null backend doesn't show anything; it just counts each kind of operation. If 'transcript' is set, lines of
+// dialogue (and choices) are printed to it, which is handy for reading through a script without the app.
+typedef struct {
+    uint64_t operationCounts[VNRuntimeOperationKindCount];
+    FILE* transcript;
+} VNRuntimeNullBackend;
+
+const VNRuntimeBackend* VNRuntimeNullBackendCallbacks(void);
+
+// Picks a choice for VNRuntimeRunHeadless; returns a number from 0 to 'count' - 1
+typedef int (*VNRuntimeChooser)(void* context, VNRuntime* runtime, int count);
+
+// Runs a script all the way to the end, advancing past every line of dialogue, ending every effect right away, and
+// letting 'chooser' make every choice (or always picking the first choice, if 'chooser' is NULL). Stops after
+// 'maxCommands' commands if it isn't 0, since scripts can loop forever. Returns the number of commands run.
+uint64_t VNRuntimeRunHeadless(VNRuntime* runtime, uint64_t maxCommands, VNRuntimeChooser chooser, void* context);
+
+#endif
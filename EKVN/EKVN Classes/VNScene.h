@@ -10,7 +10,18 @@
 #import <SpriteKit/SpriteKit.h>
 #import "DSMultilineLabelNode.h"
 #import "VNScript.h"
+#import "VNRuntime.h"
+#import "VNStats.h"
+#import "VNReadHistory.h"
+#import "VNClock.h"
+#import "VNRollback.h"
+#import "VNBacklog.h"
+#import "VNBacklogNode.h"
+#import "VNSpriteTable.h"
+#import "EKFlagTable.h"
+#import "VNSceneSnapshot.h"
 #import "VNSystemCall.h"
+#import "VNAssetCache.h"
 
 /*
  
@@ -34,6 +45,38 @@
  represent branching paths in the script. When VNScene begins processing script data, it always starts with a converation
  named "start".
  
+ The script itself is run by VNRuntime (see VNRuntime.h), which handles flags, conditions, jumps and choices, and keeps
+ track of the indexes. VNScene is the runtime's "backend": the runtime hands it each command that needs to be shown or
+ played (dialogue, sprites, effects, sounds...), and VNScene tells the runtime when effects finish, when the player taps
+ to advance the dialogue, and which choice the player picked.
+ 
+ VNScene also has a "skip mode" (see 'startSkipping') for passing over dialogue that the player has already read. While
+ skipping, the script runs in a tight loop, running through as many lines each frame as the time budget allows, and
+ effects happen instantly instead of being animated. Skipping stops at lines that haven't been read before, at choices,
+ and at the end of the script. Which lines have been read is kept in a VNReadHistory, which is shared by every playthrough
+ and stored in EKRecord's global data (not in any save slot).
+ 
+ Most of the time, a visual novel is just waiting for the player to tap or pick a choice. When VNScene has been waiting
+ like that for a moment (with nothing animating on the screen), it goes "idle": it stops doing any work each frame, and
+ either lowers the view's frame rate or pauses the view entirely (see 'idleFramesPerSecond'). Touches wake it back up at
+ the full frame rate. Anything else that changes the scene from outside (like adding nodes or running actions on it)
+ should call 'wakeFromIdle' first.
+ 
+ Every line of dialogue that gets shown is also remembered in a "rollback" history (see VNRollback.h), so the scene can
+ be rewound to an earlier line (see 'rewindBy:') without running the script again from the start. Each snapshot holds
+ the same things that get saved to EKRecord: the script's position, the flags that the scene has changed, the sprites,
+ the background, the speaker and speech, and the music. Snapshots mostly get stored as the differences from the one
+ before, and the oldest ones are dropped once the history goes over its memory budget.
+ 
+ The lines that have been shown are also kept in a "backlog" (see VNBacklog.h), which the player can scroll through to
+ read them again (see 'showBacklog'). The backlog only remembers who was speaking and where each line is in the script,
+ and the text gets looked up again when a line scrolls into view. Only the newest lines are kept in saved games.
+ 
+ Images and sounds are loaded through VNAssetCache. Whenever the script stops to wait (for the player, or for an
+ effect), VNScene looks through the next few commands of the conversation for sprites, backgrounds, speechboxes,
+ choice buttons, sounds and music, and has the cache load them in the background (see 'prefetchUpcomingAssets'). At a
+ choice, the first few commands of every conversation that the choice can jump to get looked at as well.
+ 
  */
 
 /*
@@ -139,7 +182,7 @@
 #define VNSceneSavedResourcesKey                @"saved resources"
 #define VNSceneMusicToPlayKey                   @"music to play"
 #define VNSceneMusicShouldLoopKey               @"music should loop"
-#define VNSceneSpritesToShowKey                 @"sprites to show"
+#define VNSceneSpritesToShowKey                 @"sprites to show" // Encoded VNSpriteTable, as base64 (older saves have an array of dictionaries)
 #define VNSceneSoundsToRemoveKey                @"sounds to remove"
 #define VNSceneMusicToRemoveKey                 @"music to remove"
 #define VNSceneBackgroundToShowKey              @"background to show"
@@ -154,6 +197,8 @@
 #define VNSceneTypewriterTextCanSkip            @"typewriter text can skip"
 #define VNSceneTypewriterTextSpeed              @"typewriter text speed"
 #define VNSceneSavedOverriddenSpeechboxKey      @"overridden speechbox" // used to store speechbox sprites modified by .SETSPEECHBOX in saves
+#define VNSceneBacklogKey                       @"backlog" // Encoded VNBacklog, as base64 (only in saved games)
+#define VNSceneBacklogPositionKey               @"backlog position" // Used by rollback snapshots to trim the backlog
 
 // UI "override" keys (used when you change things like font size/font name in the middle of a scene).
 // By default, any changes will be restored when a saved game is loaded, though the "override X from save"
@@ -175,6 +220,7 @@
 #define VNSceneTextLayer                110
 #define VNSceneButtonsLayer             120
 #define VNSceneButtonTextLayer          130
+#define VNSceneBacklogLayer             140
 
 // Node tags (NOTE: In Cocos2D v3.0, numeric tags were replaced with string-based names, similar to Sprite Kit)
 #define VNSceneTagSpeechBox             @"speech box"   //600
@@ -191,32 +237,86 @@
 #define VNSceneModeChoiceWithJump       203
 #define VNSceneModeEnded                300 // There isn't any more script data to process
 
+// Skip mode
+#define VNSceneDefaultSkipTimeBudget    0.008 // How much of each frame (in seconds) can be spent running the script while skipping
+
+// Idle scheduling
+#define VNSceneIdleDelay                        0.5 // How long (in seconds) the scene has to be waiting on the player before it goes idle
+#define VNSceneDefaultIdleFramesPerSecond       0   // Zero pauses the view while the scene is idle
+
+// Rollback
+#define VNSceneDefaultRollbackMemoryBudget      VNRollbackDefaultMemoryBudget // In bytes
+
+// Asset prefetching
+#define VNSceneAssetLookahead                   24  // How many commands ahead of the current one get prefetched
+#define VNSceneAssetBranchLookahead             8   // How many commands at the start of each conversation a choice can jump to
+
+// Backlog
+#define VNSceneDefaultBacklogCapacity           200 // How many lines the backlog holds while the scene is running
+#define VNSceneBacklogSaveLimit                 100 // How many of those get kept in a saved game
+#define VNSceneBacklogRowHeightInFontSizes      4.0 // Each row of the backlog is this many times the speech font size
+
 // Transition types
 #define VNSceneTransitionTypeNone       00 // default, does nothing
 
 #pragma mark - VNScene Declaration
 
-@interface VNScene : SKScene {
+@interface VNScene : SKScene <VNBacklogNodeDataSource> {
     
     // Model data (which in this case is the scene's "script" that determines what will happen)
     VNScript* script;
+    VNRuntime* runtime; // Runs the script (VNScene is its backend)
     
     // A helper class that can be used to handle .systemcall commands. This may be redundant, now that
     // .callcode exists though!
     VNSystemCall* systemCallHelper;
     
     NSMutableDictionary* record; // Holds misc data (especially regarding the script)
-    NSMutableDictionary* flags; // Local flags data (later saved to EKRecord's flags, when the scene is saved)
+    EKFlagTable* flags; // Local flags data (later saved to EKRecord's flags, when the scene is saved)
     
     int mode; // What the scene is doing (or should be doing) at the current moment
+    VNClock sceneClock; // Typewriter text and cinematic text are timed with this (instead of by counting frames)
+    
+    // Skip mode
+    BOOL isSkipping;
+    NSString* skippedSpeech; // The most recent line that was skipped over (only the last one each frame actually gets shown)
+    uint32_t readHistoryPage; // The read history's page for the current conversation (or VNReadHistoryNoPage if it needs to be looked up)
+    
+    // Idle scheduling
+    BOOL isIdle;
+    double idleTimer; // How long the scene has been waiting on the player (with nothing animating)
+    NSInteger activeFramesPerSecond; // The view's frame rate from before the scene went idle
+    
+    // Rollback
+    VNRollback* rollback; // A snapshot gets pushed every time a line of dialogue is shown
+    EKFlagTable* sceneStartFlags; // Flags from when the scene started (flags changed after a snapshot go back to these values)
+    NSMutableDictionary* rollbackSectionCache; // Record key -> (value, encoded section), so values that didn't change aren't encoded again
+    EKFlagTable* rollbackFlagTable; // The flag table (and its modification count) that 'rollbackFlagSection' was encoded from
+    NSUInteger rollbackFlagModificationCount;
+    NSData* rollbackFlagSection;
+    NSDictionary* rollbackAliases; // The sprite aliases that 'rollbackAliasSection' was encoded from
+    NSData* rollbackAliasSection;
+    
+    // Backlog
+    VNBacklog* backlog; // Every line that's been shown (or skipped over), as references into the script
+    uint32_t backlogSource; // The backlog's name for the current script and conversation (or VNBacklogNoName if it needs to be looked up)
+    NSString* backlogSpeakerName; // The most recent speaker that was added to the backlog, and the backlog's name for them
+    uint32_t backlogSpeaker;
+    VNScript* backlogScript; // The most recent script (other than the current one) that text was looked up in
+    VNBacklogNode* backlogNode; // Only exists while the backlog is on the screen
+    
+    // Asset prefetching
+    VNScriptConversation* prefetchConversation; // The conversation that assets were last prefetched from
+    NSInteger prefetchedThroughLine; // Commands before this line (in that conversation) have already been looked at
     
     // The "safe save" is an pseudo-autosave created right before performing a "dangerous" action like running an EKEffect.
     // Since saving the game in the middle of an effectt can cause unexpected results (like sprites being in the wrong
     // position), VNScene won't allow for anything to be saved until a "safe" point can be reached. Instead, VNScene saves
-    // its data into this dictionary object beforehand, and if the user attempts to save the game in the middle of an effect,
+    // its data into this snapshot beforehand, and if the user attempts to save the game in the middle of an effect,
     // they will only save the "safe" information instead of anything dangerous. Of course, when the "dangerous" part ends,
-    // this dictionary is deleted, and things can be saved as normal.
-    NSDictionary* safeSave;
+    // the snapshot is deleted, and things can be saved as normal. (Taking a snapshot doesn't copy the flags or the record;
+    // see VNSceneSnapshot for how that works.)
+    VNSceneSnapshot* safeSave;
     
     // View data
     NSMutableDictionary* viewSettings;
@@ -225,16 +325,17 @@
     BOOL isPlayingMusic;
     BOOL noSkippingUntilTextIsShown;
     AVAudioPlayer* backgroundMusic;
+    AVAudioEngine* soundEffectEngine; // Plays the decoded sound effects from VNAssetCache
     //AVAudioPlayer* currentSoundEffect; // AVAudioPlayer objects seem to require a strong reference to them or they won't play
     
     NSMutableArray* soundsLoaded;
     NSMutableArray* buttons;
-    NSMutableArray* choices; // Holds values that will be used when making choices
-    NSMutableArray* choiceExtras; // Holds extra data that's used when making choices (usually, flag data)
     int buttonPicked; // Keeps track of the most recently touched button in the menu
     
     NSMutableDictionary* sprites;
     NSMutableArray* spritesToRemove;
+    VNSpriteTable* spriteTable; // Saved state of each sprite in 'sprites' (kept up to date by the sprite commands)
+    NSString* encodedSpriteTable; // The sprite table as it was the last time it was encoded
     
     SKSpriteNode* speechBox; // Dialogue box
     DSMultilineLabelNode* speech;  // The text displayed as dialogue
@@ -258,18 +359,15 @@
     CGFloat choiceButtonOffsetX, choiceButtonOffsetY; // offsets buttons (in choice menus) by a certain number of points (default is zero)
     
     // Cinematic text
-    double cinematicTextSpeed; // The speed at which text progresses without user input
+    double cinematicTextSpeed; // The speed at which text progresses without user input (in seconds per line)
     BOOL cinematicTextInputAllowed; // Whether or not user input can still be allowed
-    int cinematicTextSpeedInFrames; // The speed in frames
-    int cinematicTextCounter; // Used to keep track of current frames
+    double cinematicTextTimer; // Seconds since cinematic text last moved the script forward
     
     // Typewriter style text
     BOOL TWModeEnabled; // Off by default (standard EKVN text mode)
     BOOL TWCanSkip; // Can the user skip ahead (and cut the text short) by tapping?
     int TWSpeedInCharacters; // How many characters it should print per second
-    int TWSpeedInFrames;
-    int TWTimer; // Used to determine how many characters should be displayed (relative to the time/speed of displaying characters)
-    double TWSpeedInSeconds;
+    double TWTimer; // Seconds since the current line started being printed (used to determine how many characters should be displayed)
     int TWNumberOfCurrentCharacters;
     int TWPreviousNumberOfCurrentChars;
     int TWNumberOfTotalCharacters;
@@ -308,12 +406,44 @@
 //
 @property (nonatomic, strong) NSMutableDictionary* localSpriteAliases;
 
+// Skip mode. By default, skipping only passes over lines that have been read before (in any playthrough), but it can
+// be set to skip unread lines as well. The time budget is how long (in seconds) the script can run for each frame.
+@property (nonatomic, readonly) BOOL isSkipping;
+@property (nonatomic) BOOL skipsUnreadLines;
+@property (nonatomic) double skipTimeBudget;
+
+// Idle scheduling is on by default. While idle, the view runs at 'idleFramesPerSecond', or is paused if that's zero.
+@property (nonatomic, readonly) BOOL isIdle;
+@property (nonatomic) BOOL allowsIdling;
+@property (nonatomic) NSInteger idleFramesPerSecond;
+
+// Rollback. The memory budget covers every snapshot in the history; 'rewindableLineCount' is how far back 'rewindBy:' can go.
+@property (nonatomic) NSUInteger rollbackMemoryBudget;
+@property (nonatomic, readonly) NSUInteger rewindableLineCount;
+
+// The backlog covers the scene (and stops the script) until the player taps it without scrolling.
+@property (nonatomic, readonly) BOOL isShowingBacklog;
+
 + (VNScene*)currentVNScene;
 
+// Performance counters for commands, frames (by mode), and slow things like loading sprites or saving; see VNStats.h
++ (NSDictionary*)performanceStats;
++ (BOOL)writePerformanceStatsToFile:(NSString*)path; // As JSON
+
+// Which lines of dialogue have been read. The history is loaded from EKRecord when it's first needed, and saved back
+// whenever the scene is saved (or ends). Resetting it makes every line "unread" again.
++ (VNReadHistory*)readHistory;
++ (void)saveReadHistory;
++ (void)resetReadHistory;
+
 + (id)sceneWithSize:(CGSize)theSize andSettings:(NSDictionary*)settings;
 - (id)initWithSize:(CGSize)theSize andSettings:(NSDictionary*)settings;
 
-- (NSArray*)spriteDataFromScene; // Saves information about the sprites in the scene
+// The clock follows the time passed to 'update:', but it can be switched to virtual time for headless runs (see VNClock.h)
+- (VNClock*)sceneClock;
+
+- (NSString*)spriteDataFromScene; // The encoded sprite table, as base64 (it only gets encoded again after a sprite changes)
+- (SKSpriteNode*)spriteWithImageNamed:(NSString*)filename; // Loads a sprite (and times it; see VNStats.h)
 
 - (void)loadDefaultViewSettings;
 - (void)loadSavedResources;
@@ -324,10 +454,34 @@
 - (void)purgeDataCreatedByScene; // Get rid of any objects that were allocated by the scene (but which may be stored ELSEWHERE)
 
 - (void)runScript;
-- (void)processCommand:(NSArray*)command;
+- (void)prefetchUpcomingAssets; // Has VNAssetCache load the images and sounds for the next few commands
+- (void)processCommand:(const VNScriptCommandRecord*)command inConversation:(VNScriptConversation*)conversation; // Presentation commands only (see VNRuntime)
+- (void)displaySpeech:(NSString*)text; // Shows a line of dialogue (fading in, or as typewriter text)
 
 - (void)setEffectRunningFlag;
 - (void)clearEffectRunningFlag;
+- (double)effectDuration:(double)duration; // Zero while skipping
+
+- (void)startSkipping;
+- (void)stopSkipping; // Tapping the screen also stops skipping
+- (void)skipThroughScript; // Called every frame while skipping
+- (BOOL)markLineAsRead:(NSInteger)line; // Returns YES if the line (in the current conversation) had already been read
+
+- (BOOL)canBecomeIdle; // Waiting on the player, with nothing animating
+- (void)enterIdleState;
+- (void)wakeFromIdle; // Returns the view to its normal frame rate
+
+// Goes back to a line that was shown earlier (1 is the line before the one on the screen). This only works while the
+// scene is waiting on the player (for a line of dialogue or a choice), and returns NO otherwise.
+- (BOOL)rewindBy:(NSUInteger)lines;
+- (NSData*)rollbackSnapshot; // The scene's current state, as a list of VNRollback sections
+- (void)pushRollbackSnapshot;
+- (BOOL)restoreRollbackSnapshot:(NSData*)snapshot;
+
+- (void)showBacklog;
+- (void)hideBacklog;
+- (void)addLineToBacklog:(NSInteger)line; // A line in the current conversation, with whoever is speaking right now
+- (NSString*)backlogTextForEntry:(const VNBacklogEntry*)entry; // Looks the line up in its script (nil if it can't be found)
 
 - (void)updateCinematicTextValues;
 - (BOOL)cinematicTextAllowsUpdate; // Also returns YES if cinematic text is disabled
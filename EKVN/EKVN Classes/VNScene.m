@@ -8,6 +8,7 @@
 #import "VNScene.h"
 #import "EKRecord.h"
 #import "ekutils.h"
+#import "EKTrace.h"
 //#import "OALSimpleAudio.h"
 
 /* this is to space choices further apart when the view is in portrait mode*/
@@ -18,11 +19,24 @@
 #pragma clang diagnostic ignored "-Warc-performSelector-leaks" // Disables "performSelector"-related warnings
 
 VNScene* theCurrentScene = nil;
+VNReadHistory* theReadHistory = NULL; // Shared by every scene (and every playthrough)
+
+// Saved games are written out as JSON (see EKRecord), so anything that's encoded as binary data gets stored as a base64
+// string. Returns nil if the value isn't a base64 string.
+static NSData* VNSceneDataFromBase64(id value)
+{
+    if( [value isKindOfClass:[NSString class]] == NO )
+        return nil;
+    
+    return [[NSData alloc] initWithBase64EncodedString:value options:0];
+}
 
 @implementation VNScene
 
 //@synthesize script = script;
 @synthesize localSpriteAliases;
+@synthesize isSkipping;
+@synthesize isIdle;
 
 #pragma - 
 #pragma mark Initialization
@@ -36,6 +50,62 @@ VNScene* theCurrentScene = nil;
     return theCurrentScene;
 }
 
++ (NSDictionary*)performanceStats
+{
+    char* json = VNStatsCopyJSON();
+    if( json == NULL )
+        return nil;
+    
+    NSData* data = [NSData dataWithBytesNoCopy:json length:strlen(json) freeWhenDone:YES];
+    return [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+}
+
++ (BOOL)writePerformanceStatsToFile:(NSString*)path
+{
+    if( path == nil )
+        return NO;
+    
+    return VNStatsWriteJSONToFile([path fileSystemRepresentation]) ? YES : NO;
+}
+
++ (VNReadHistory*)readHistory
+{
+    if( theReadHistory == NULL ) {
+        
+        NSData* historyData = [[EKRecord sharedRecord] readHistoryData];
+        if( historyData )
+            theReadHistory = VNReadHistoryDecode(historyData.bytes, historyData.length);
+        
+        // Start over with an empty history if there wasn't one (or if it couldn't be loaded)
+        if( theReadHistory == NULL )
+            theReadHistory = VNReadHistoryCreate();
+    }
+    
+    return theReadHistory;
+}
+
++ (void)saveReadHistory
+{
+    if( theReadHistory == NULL || VNReadHistoryIsDirty(theReadHistory) == 0 )
+        return;
+    
+    size_t length = VNReadHistoryEncode(theReadHistory, NULL, 0);
+    NSMutableData* historyData = [NSMutableData dataWithLength:length];
+    VNReadHistoryEncode(theReadHistory, historyData.mutableBytes, length);
+    
+    [[EKRecord sharedRecord] setReadHistoryData:historyData];
+    VNReadHistoryClearDirty(theReadHistory);
+    EKTraceDebug(EKTraceCategorySave, "Read history saved (%lu bytes, %llu lines read).", (unsigned long)length,
+                 (unsigned long long)VNReadHistoryReadCount(theReadHistory));
+}
+
++ (void)resetReadHistory
+{
+    VNReadHistoryReset([self readHistory]);
+    [[EKRecord sharedRecord] setReadHistoryData:nil];
+    VNReadHistoryClearDirty(theReadHistory);
+}
+
 + (id)sceneWithSize:(CGSize)theSize andSettings:(NSDictionary*)settings
 {
     return [[self alloc] initWithSize:theSize andSettings:settings];
@@ -45,11 +115,25 @@ VNScene* theCurrentScene = nil;
 {
     if( self = [super initWithSize:theSize] ) {
         self.allSettings = [settings copy];
+        VNClockInit(&sceneClock);
     }
     
     return self;
 }
 
+- (VNClock*)sceneClock
+{
+    return &sceneClock;
+}
+
+- (void)dealloc
+{
+    VNRuntimeFree(runtime);
+    VNRollbackFree(rollback);
+    VNBacklogFree(backlog);
+    VNSpriteTableFree(spriteTable);
+}
+
 - (void)didMoveToView:(SKView *)view
 {
     EKSetScreenDataFromView(view); // Get view and screen size data; this is used to position UI elements
@@ -67,8 +151,13 @@ VNScene* theCurrentScene = nil;
     buttonPicked    = -1;
     soundsLoaded    = [[NSMutableArray alloc] init];
     sprites         = [[NSMutableDictionary alloc] init];
+    VNSpriteTableFree(spriteTable);
+    spriteTable     = VNSpriteTableCreate();
+    encodedSpriteTable = nil;
     record          = [[NSMutableDictionary alloc] initWithDictionary:self.allSettings]; // Copy data to local dictionary
-    flags           = [[NSMutableDictionary alloc] initWithDictionary:[[[EKRecord sharedRecord] flags] copy]]; // Create independent copy of flag data
+    flags           = [[[EKRecord sharedRecord] flagTable] copy]; // Create independent copy of flag data (copy-on-write, so nothing is copied until a flag changes)
+    [flags clearChanges];
+    sceneStartFlags = [flags copy]; // Shares storage with 'flags' until the scene changes something
     // set transition data
     self.transitionType = VNSceneTransitionTypeNone;
     self.transitionFilename = nil;
@@ -77,22 +166,54 @@ VNScene* theCurrentScene = nil;
     self.localSpriteAliases = [[NSMutableDictionary alloc] initWithDictionary:[[[EKRecord sharedRecord] spriteAliases] copy]];
     noSkippingUntilTextIsShown = NO; // By default is set to NO, so it IS possible to skip text before it's shown
     
+    // Skip mode is off until the player asks for it
+    isSkipping              = NO;
+    skippedSpeech           = nil;
+    readHistoryPage         = VNReadHistoryNoPage;
+    self.skipsUnreadLines   = NO;
+    self.skipTimeBudget     = VNSceneDefaultSkipTimeBudget;
+    
+    // Idle scheduling
+    isIdle                      = NO;
+    idleTimer                   = 0.0;
+    activeFramesPerSecond       = view.preferredFramesPerSecond;
+    self.allowsIdling           = YES;
+    self.idleFramesPerSecond    = VNSceneDefaultIdleFramesPerSecond;
+    
+    // Rollback
+    VNRollbackFree(rollback);
+    rollback                = VNRollbackCreate(VNSceneDefaultRollbackMemoryBudget, VNRollbackDefaultKeyframeInterval);
+    rollbackSectionCache    = [[NSMutableDictionary alloc] init];
+    
+    // Backlog. A saved game brings its backlog with it, but it's taken out of the record (which is what rollback
+    // snapshots are made from) while the scene is running, and only put back in when the game is saved.
+    NSData* savedBacklog = VNSceneDataFromBase64([record objectForKey:VNSceneBacklogKey]);
+    VNBacklogFree(backlog);
+    backlog = NULL;
+    if( savedBacklog != nil )
+        backlog = VNBacklogDecode(savedBacklog.bytes, savedBacklog.length, VNSceneDefaultBacklogCapacity);
+    if( backlog == NULL )
+        backlog = VNBacklogCreate(VNSceneDefaultBacklogCapacity);
+    [record removeObjectForKey:VNSceneBacklogKey];
+    backlogSource       = VNBacklogNoName;
+    backlogSpeakerName  = nil;
+    backlogSpeaker      = VNBacklogNoName;
+    backlogScript       = nil;
+    backlogNode         = nil;
+    
     // Set default values for cinematic text
     cinematicTextSpeed          = 0.0;
     cinematicTextInputAllowed   = YES;
-    cinematicTextCounter        = 0;
-    cinematicTextSpeedInFrames  = 0;
+    cinematicTextTimer          = 0.0;
     
     // Set default values for typewriter text mode
     TWModeEnabled                   = NO; // Off by default (standard EKVN text mode)
-    TWSpeedInFrames                 = 0;
-    TWSpeedInSeconds                = 0.0;
     TWNumberOfCurrentCharacters     = 0;
     TWPreviousNumberOfCurrentChars  = 0;
     TWNumberOfTotalCharacters       = 0;
     TWCurrentText                   = @"";
     TWFullText                      = @"";
-    TWTimer                         = 0;
+    TWTimer                         = 0.0;
     TWSpeedInCharacters             = 0;
     TWCanSkip                       = NO;
     
@@ -125,6 +246,8 @@ VNScene* theCurrentScene = nil;
         NSLog(@"[VNScene] Settings were loaded from a script file.");
     }
     
+    [self createRuntime]; // The runtime is what actually runs the script
+    
     // Load default view settings
     [self loadDefaultViewSettings]; // The standard settings
     NSLog(@"[VNScene] Default view settings loaded.");
@@ -180,7 +303,7 @@ VNScene* theCurrentScene = nil;
     if( filename == nil )
         return;
     
-    backgroundMusic = EKAudioSoundFromFile(filename);
+    backgroundMusic = [[VNAssetCache sharedCache] musicPlayerNamed:filename];
     if( backgroundMusic == nil ) {
         NSLog(@"[VNScene] ERROR: Could not load sound object from file named: %@", filename);
         return;
@@ -199,25 +322,75 @@ VNScene* theCurrentScene = nil;
     if( filename == nil ) {
         NSLog(@"[VNScene] ERROR: Cannot play sound effect because input filename is invalid.");
     } else {
-        SKAction* playSoundEffectAction = [SKAction playSoundFileNamed:filename waitForCompletion:NO];
-        if( playSoundEffectAction == nil ) {
-            NSLog(@"[VNScene] ERROR: Cannot play sound effect because SKAction for sound effect is invalid.");
+        AVAudioPCMBuffer* soundEffect = [[VNAssetCache sharedCache] soundEffectNamed:filename]; // Usually prefetched (and decoded)
+        if( soundEffect == nil ) {
+            NSLog(@"[VNScene] ERROR: Cannot play sound effect because the sound could not be loaded.");
         } else {
-            [self runAction:playSoundEffectAction];
+            [self playSoundEffectBuffer:soundEffect];
         }
     }
 }
 
+// Each sound effect gets its own player node, so that sounds can overlap (the way they could with SKAction's sounds).
+// The node is detached once the sound has finished playing.
+- (void)playSoundEffectBuffer:(AVAudioPCMBuffer*)soundEffect
+{
+    if( soundEffectEngine == nil ) {
+        soundEffectEngine = [[AVAudioEngine alloc] init];
+    }
+    
+    AVAudioEngine* engine = soundEffectEngine;
+    AVAudioPlayerNode* player = [[AVAudioPlayerNode alloc] init];
+    [engine attachNode:player];
+    [engine connect:player to:engine.mainMixerNode format:soundEffect.format];
+    
+    if( engine.isRunning == NO ) {
+        NSError* error = nil;
+        if( [engine startAndReturnError:&error] == NO ) {
+            NSLog(@"[VNScene] ERROR: Cannot play sound effect because the audio engine could not start: %@", error);
+            [engine detachNode:player];
+            return;
+        }
+    }
+    
+    [player scheduleBuffer:soundEffect completionCallbackType:AVAudioPlayerNodeCompletionDataPlayedBack completionHandler:^(AVAudioPlayerNodeCompletionCallbackType callbackType) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [engine detachNode:player];
+        });
+    }];
+    [player play];
+}
+
 
 #pragma mark - Other setup or deletion functions
 
+// Saved games from before the sprite table was added have an array with a dictionary for each sprite
+static VNSpriteTable* VNSceneSpriteTableFromArray(NSArray* savedSprites)
+{
+    VNSpriteTable* table = VNSpriteTableCreate();
+    
+    for( NSDictionary* spriteData in savedSprites ) {
+        
+        NSString* nameOfSprite = [spriteData objectForKey:@"name"];
+        NSString* filenameOfSprite = [spriteData objectForKey:@"filename"]; // Only there if the sprite had an alias
+        if( nameOfSprite == nil )
+            continue;
+        
+        VNSpriteState* state = VNSpriteTableAdd(table, [nameOfSprite UTF8String], [filenameOfSprite UTF8String],
+                                                [[spriteData objectForKey:@"x"] doubleValue], [[spriteData objectForKey:@"y"] doubleValue]);
+        VNSpriteTableSetScale(table, state, [[spriteData objectForKey:@"scale x"] doubleValue], [[spriteData objectForKey:@"scale y"] doubleValue]);
+    }
+    
+    return table;
+}
+
 // The state of VNScene's UI is stored whenever the game is saved. That way, in case music is playing, or some text is
 // supposed to be on screen, VNScene will remember and SHOULD restore things to exactly the way they were when the game
 // was saved. The restoration of UI is what this function is for.
 - (void)loadSavedResources
 {    
 	// Load any saved resource information from the dictionary
-	NSArray* savedSprites       = [record objectForKey:VNSceneSpritesToShowKey];
+	id savedSprites             = [record objectForKey:VNSceneSpritesToShowKey];
 	NSString* loadedMusic       = [record objectForKey:VNSceneMusicToPlayKey];
 	NSString* savedBackground   = [record objectForKey:VNSceneBackgroundToShowKey];
 	NSString* savedSpeakerName  = [record objectForKey:VNSceneSpeakerNameToShowKey];
@@ -267,7 +440,7 @@ VNScene* theCurrentScene = nil;
         if( savedBackgroundY ) backgroundY = [savedBackgroundY floatValue];
         
         // Create and add background image node
-        SKSpriteNode* background = [SKSpriteNode spriteNodeWithImageNamed:savedBackground];
+        SKSpriteNode* background = [self spriteWithImageNamed:savedBackground];
 		background.position = CGPointMake( backgroundX, backgroundY ); // Position the sprite / background image right in the middle of the screen
         background.zPosition = VNSceneBackgroundLayer;
         background.name = VNSceneTagBackground;
@@ -288,53 +461,51 @@ VNScene* theCurrentScene = nil;
         [self playBGMusic:loadedMusic willLoop:[musicShouldLoop boolValue]];
 	}
 	
-    // Check if any sprites need to be displayed
-	if( savedSprites ) {
+    // Check if any sprites need to be displayed. Saved games hold an encoded sprite table (see VNSpriteTable.h), but older
+    // saves have an array of dictionaries instead, which gets turned into a table first.
+    VNSpriteTable* savedSpriteTable = NULL;
+    NSData* savedSpriteData = VNSceneDataFromBase64(savedSprites);
+    if( savedSpriteData != nil )
+        savedSpriteTable = VNSpriteTableDecode(savedSpriteData.bytes, savedSpriteData.length);
+    else if( [savedSprites isKindOfClass:[NSArray class]] )
+        savedSpriteTable = VNSceneSpriteTableFromArray(savedSprites);
+    
+	if( savedSpriteTable ) {
         
-        NSLog(@"[VNScene] Sprite data was found in the saved game data.");
+        EKTraceDebug(EKTraceCategorySprites, "Sprite data was found in the saved game data.");
         
-        // Check each entry of sprite data that was found, and start loading them into memory and displaying them onto the screen.
+        // Go through each sprite in the table, and start loading them into memory and displaying them onto the screen.
         // In theory, the process should be fast enough (and the number of sprites FEW enough) that the user shouldn't notice any delays.
-		for( NSDictionary* spriteData in savedSprites ) {
-            
-            BOOL doesHaveAlias = YES; // default assumption
-            
-            // Grab sprite data from dictionary
-            NSString* nameOfSprite = [spriteData objectForKey:@"name"];
-            NSLog(@"[VNScene] Restoring saved sprite named: %@", nameOfSprite);
-            
-            // Check if there was a filename
-            NSString* filenameOfSprite = [spriteData objectForKey:@"filename"];
-            if( filenameOfSprite == nil ) {
-                doesHaveAlias = NO;
-                filenameOfSprite = nameOfSprite;
-            }
+		for( uint32_t i = 0; i < VNSpriteTableCount(savedSpriteTable); i++ ) {
             
-            // Load CCSprite object and set its coordinates
-			float spriteX = [[spriteData objectForKey:@"x"] floatValue]; // Load coordinates from dictionary
-			float spriteY = [[spriteData objectForKey:@"y"] floatValue];
-            float scaleX = [[spriteData objectForKey:@"scale x"] floatValue]; // load scaling data (for inverted sprites)
-            float scaleY = [[spriteData objectForKey:@"scale y"] floatValue];
+            const VNSpriteState* state = VNSpriteTableStateAt(savedSpriteTable, i);
+            NSString* nameOfSprite = @(state->name);
+            NSString* filenameOfSprite = (state->filename != NULL) ? @(state->filename) : nameOfSprite;
+            EKTraceDebug(EKTraceCategorySprites, "Restoring saved sprite named: %s", state->name);
             
-            // check if this will incorporate height margin for ads
-            if( doesUseHeightMarginForAds == YES ) {
-                //spriteY = spriteY - heightMarginForAds;
+            SKSpriteNode* sprite = [self spriteWithImageNamed:filenameOfSprite];
+            if( sprite == nil ) {
+                NSLog(@"[VNScene] ERROR: Could not load saved sprite named: %@", filenameOfSprite);
+                continue;
             }
             
-            SKSpriteNode* sprite    = [SKSpriteNode spriteNodeWithImageNamed:filenameOfSprite];
-			sprite.position         = CGPointMake( spriteX, spriteY );
-            sprite.xScale           = scaleX;
-            sprite.yScale           = scaleY;
+			sprite.position         = CGPointMake( state->x, state->y );
+            sprite.xScale           = state->scaleX;
+            sprite.yScale           = state->scaleY;
             sprite.zPosition        = VNSceneCharacterLayer;
             [self addChild:sprite];
             
-            // Finally, add the sprite to the 'sprites' dictionary
+            // Finally, add the sprite to the 'sprites' dictionary (and its state to the scene's own table)
             [sprites setValue:sprite forKey:nameOfSprite];
+            VNSpriteState* activeState = VNSpriteTableAdd(spriteTable, state->name, state->filename, state->x, state->y);
+            VNSpriteTableSetScale(spriteTable, activeState, state->scaleX, state->scaleY);
             
-            if( doesHaveAlias == YES ) {
+            if( state->filename != NULL ) {
                 [self.localSpriteAliases setValue:filenameOfSprite forKey:nameOfSprite];
             }
 		}
+        
+        VNSpriteTableFree(savedSpriteTable);
 	}
     
     if( savedSpeechbox ) {
@@ -350,7 +521,7 @@ VNScene* theCurrentScene = nil;
             [speechBox removeFromParent];
         }
         
-        speechBox               = [SKSpriteNode spriteNodeWithImageNamed:savedSpeechbox];
+        speechBox               = [self spriteWithImageNamed:savedSpeechbox];
         speechBox.position      = CGPointMake( widthOfScreen * 0.5, (speechBox.frame.size.height * 0.5) + boxToBottomMargin );
         speechBox.zPosition     = VNSceneUILayer;
         speechBox.name          = VNSceneTagSpeechBox;
@@ -381,11 +552,11 @@ VNScene* theCurrentScene = nil;
     // Handle loading typewriter data
     if( TWSpeedInCharsValue != nil) {
         TWSpeedInCharacters = [TWSpeedInCharsValue intValue];
-        NSLog(@"[VNScene] DIAGNOSTIC: Typewriter Text speed in characters set to: %d", TWSpeedInCharacters);
+        EKTraceDebug(EKTraceCategoryScene, "Typewriter text speed in characters set to: %d", TWSpeedInCharacters);
     }
     if( TWCanSkipValue != nil ) {
         TWCanSkip = [TWCanSkipValue boolValue];
-        NSLog(@"[VNScene] DIAGNOSTIC: Typewriter Text skip flag set to: %d", TWCanSkip);
+        EKTraceDebug(EKTraceCategoryScene, "Typewriter text skip flag set to: %d", TWCanSkip);
     }
     
     [self updateTypewriterTextSettings];
@@ -518,7 +689,7 @@ VNScene* theCurrentScene = nil;
     //         The default setting is to have NO margin/space, meaning the bottom of the box touches the bottom of the screen.
     NSString* speechBoxFile = [viewSettings objectForKey:VNSceneViewSpeechBoxFilenameKey];
     float boxToBottomMargin = [[viewSettings objectForKey:VNSceneViewSpeechBoxOffsetFromBottomKey] floatValue];
-    speechBox               = [SKSpriteNode spriteNodeWithImageNamed:speechBoxFile];//[CCSprite spriteWithImageNamed:speechBoxFile];
+    speechBox               = [self spriteWithImageNamed:speechBoxFile];//[CCSprite spriteWithImageNamed:speechBoxFile];
     speechBox.position      = CGPointMake( widthOfScreen * 0.5, (speechBox.size.height * 0.5) + boxToBottomMargin );
     speechBox.zPosition     = VNSceneUILayer;
     speechBox.name          = VNSceneTagSpeechBox;
@@ -752,7 +923,7 @@ VNScene* theCurrentScene = nil;
     if( spritesToRemove == nil || spritesToRemove.count < 1 ) // Check if there's nothing that needs doing
         return;
     
-    NSLog(@"[VNScene] Will now remove unused sprites (%lu found).", (unsigned long)spritesToRemove.count);
+    EKTraceDebug(EKTraceCategorySprites, "Will now remove unused sprites (%lu found).", (unsigned long)spritesToRemove.count);
     
     // Get all the CCSprite objects in the array and then remove them, starting from the last item and ending with the first.
     for( NSInteger i = (spritesToRemove.count - 1); i >= 0; i-- ) {
@@ -772,6 +943,8 @@ VNScene* theCurrentScene = nil;
 // should call 'removeUnusedSprites' soon afterwards; that will actually remove the CCSprite objects from RAM.
 - (void)markActiveSpritesAsUnused
 {
+    VNSpriteTableRemoveAll(spriteTable);
+    
     if( sprites == nil || sprites.count < 1 ) // Check if there are no active sprites at all
         return;
     
@@ -798,6 +971,18 @@ VNScene* theCurrentScene = nil;
     [self removeUnusedSprites];         // Remove the "unused" sprites
     [spritesToRemove removeAllObjects]; // Free from memory
     [sprites removeAllObjects];         // Array now unnecessary; any remaining child nodes will be released from memory in this function
+    VNRollbackClear(rollback);          // There's nothing left to rewind to
+    [rollbackSectionCache removeAllObjects];
+    rollbackFlagTable = nil;
+    rollbackFlagSection = nil;
+    rollbackAliases = nil;
+    rollbackAliasSection = nil;
+    [self hideBacklog];
+    backlogScript = nil;
+    
+    // Prefetched assets belong to this scene's script, so they're not much use to whatever comes next
+    prefetchConversation = nil;
+    [[VNAssetCache sharedCache] removeAllAssets];
     
     // Check if any sounds were loaded; they should be removed by this function.
     if( soundsLoaded ) {
@@ -806,6 +991,12 @@ VNScene* theCurrentScene = nil;
         soundsLoaded = nil;
     }
     
+    // Stop any sound effects that are still playing.
+    if( soundEffectEngine ) {
+        [soundEffectEngine stop];
+        soundEffectEngine = nil;
+    }
+    
     // Unload any music that may be playing.
     if( isPlayingMusic ) {
         //[[OALSimpleAudio sharedInstance] stopBg];
@@ -816,12 +1007,12 @@ VNScene* theCurrentScene = nil;
     // Now, forcibly get rid of anything that might have been missed
     if( self.children && self.children.count > 0 ) {
         
-        NSLog(@"[VNScene] Will now forcibly remove all child nodes of this layer.");
+        EKTraceDebug(EKTraceCategoryScene, "Will now forcibly remove all child nodes of this layer.");
         
         //[self removeAllChildrenWithCleanup:YES];
         [self removeAllChildren];
         
-        NSLog(@"[VNScene] All child nodes have been removed.");
+        EKTraceDebug(EKTraceCategoryScene, "All child nodes have been removed.");
     }
 }
 
@@ -833,20 +1024,12 @@ VNScene* theCurrentScene = nil;
 {
     if (TWSpeedInCharacters <= 0) {
         TWModeEnabled = NO;
-        TWTimer = 0;
     } else {
-        
         TWModeEnabled = YES;
-        
-        // Calculate speed in seconds based on characters per second
-        double charsPerSecond = (double)TWSpeedInCharacters;
-        TWSpeedInSeconds = (60.0) / charsPerSecond; // at 60fps this is 60/characters-per-second
-        
-        double speedInFrames = (60.0) * TWSpeedInSeconds;
-        TWSpeedInFrames = (int)(speedInFrames);
-        TWTimer = 0; // This gets reset
     }
     
+    TWTimer = 0.0; // This gets reset
+    
     [record setValue:[NSNumber numberWithInt:TWSpeedInCharacters] forKey:VNSceneTypewriterTextSpeed];
     [record setValue:[NSNumber numberWithBool:TWCanSkip] forKey:VNSceneTypewriterTextCanSkip];
 }
@@ -860,14 +1043,19 @@ VNScene* theCurrentScene = nil;
     
     BOOL shouldRedrawText = NO; // Determines whether or not to go through the trouble of recalculating text node positions
     
-    // Used to calculate how many characters to display (in each frame)
-    double currentChars = (double)TWNumberOfCurrentCharacters;
-    double charsPerSecond = (double)(TWSpeedInCharacters);
-    double charsPerFrame = (charsPerSecond / 60.0);
-    double c = currentChars + charsPerFrame;
+    // Work out how many characters should be showing by now, based on how long the line has been printing for. This uses
+    // the scene clock instead of counting frames, so text prints at the same speed at any frame rate (and any leftover
+    // fraction of a character carries over to the next frame, instead of getting lost).
+    TWTimer += sceneClock.delta;
+    double charactersByNow = TWTimer * (double)TWSpeedInCharacters;
+    if( charactersByNow > (double)TWNumberOfTotalCharacters ) {
+        charactersByNow = (double)TWNumberOfTotalCharacters;
+    }
     
-    // Convert back to integer (from the more precise Double)
-    TWNumberOfCurrentCharacters = (int)(c);
+    // Tapping can push the text further along than the timer has gotten to, so the count never goes backwards
+    if( (int)charactersByNow > TWNumberOfCurrentCharacters ) {
+        TWNumberOfCurrentCharacters = (int)charactersByNow;
+    }
     
     // Clamp excessive min-max values
     if (TWNumberOfCurrentCharacters < 0) {
@@ -918,30 +1106,22 @@ VNScene* theCurrentScene = nil;
 {
     // Check if cinematic text is (or should be) disabled
     if( cinematicTextSpeed <= 0.0 ) {
-        cinematicTextCounter = 0;
         cinematicTextInputAllowed = YES;
-        cinematicTextSpeedInFrames = 0;
-    } else {
-        int fpsCount = 60;
-        //double fpsAsDouble = 60.0;
-        double result = fpsCount * cinematicTextSpeed;
-        cinematicTextSpeedInFrames = (int)result;
-        cinematicTextCounter = 0; // This gets reset
     }
     
+    cinematicTextTimer = 0.0; // This gets reset
+    
     // Update record with cinematic text values
     [record setValue:@(cinematicTextSpeed) forKey:VNSceneCinematicTextSpeedKey];
     [record setValue:@(cinematicTextInputAllowed) forKey:VNSceneCinematicTextInputAllowedKey];
     
-    // Diagnostics
-    NSLog(@"[VNScene] Cinematic text speed: %f (in frames: %d). Input allowed: %d",
-          cinematicTextSpeed, cinematicTextSpeedInFrames, cinematicTextInputAllowed);
+    EKTraceDebug(EKTraceCategoryScene, "Cinematic text speed: %f seconds. Input allowed: %d", cinematicTextSpeed, cinematicTextInputAllowed);
 }
 
 - (BOOL)cinematicTextAllowsUpdate
 {
     // First, check if cinematic text is disabled, or if it allows input anyway
-    if( cinematicTextSpeed <= 0.0 || cinematicTextSpeedInFrames <= 0 ){
+    if( cinematicTextSpeed <= 0.0 ){
         return YES;
     }
     if( cinematicTextInputAllowed == YES ) {
@@ -949,8 +1129,8 @@ VNScene* theCurrentScene = nil;
     }
     
     // Check if the "right time" has been reached
-    if( cinematicTextCounter >= cinematicTextSpeedInFrames ) {
-        cinematicTextCounter = 0; // Reset
+    if( cinematicTextTimer >= cinematicTextSpeed ) {
+        cinematicTextTimer = 0.0; // Reset
         return YES;
     }
     
@@ -975,15 +1155,18 @@ VNScene* theCurrentScene = nil;
 // Used to retrieve potential sprite alias names from the local sprite alias dictionary
 - (NSString*)filenameOfSpriteAlias:(NSString*)someName
 {
+    // Aliases can be changed while the script is running (with .SETSPRITEALIAS), so unlike conversation names, they
+    // can't be resolved ahead of time by the script linker. The names are immutable strings from the script's string
+    // table, so at least they don't need to be copied.
     NSString* filenameOfSprite = [self.localSpriteAliases objectForKey:someName];
     // Check if the corresponding filename was NOT found in the alias list
     if( filenameOfSprite == nil ) {
         // In this case, just return the original name, which can be assumed to be an actual filename already
-        return [NSString stringWithString:someName];
+        return someName;
     }
     
     // Otherwise, assume that the filename was found
-    return [NSString stringWithString:filenameOfSprite];
+    return filenameOfSprite;
 }
 
 // The set/clear effect-running-flag functions exist so that Cocos2D can call them after certain actions
@@ -991,14 +1174,573 @@ VNScene* theCurrentScene = nil;
 // know when it's safe (or unsafe) to do certain things (which might interrupt the effect that's being run).
 - (void)setEffectRunningFlag
 {
-    NSLog(@"[VNScene] Effect will be running.");
+    EKTraceVerbose(EKTraceCategoryScene, "Effect will be running.");
     effectIsRunning = YES;
     mode = VNSceneModeEffectIsRunning;
+    VNRuntimeBeginEffect(runtime);
 }
 - (void)clearEffectRunningFlag
 {
     effectIsRunning = NO;
-    NSLog(@"[VNScene] Effect is no longer running.");
+    VNRuntimeEndEffect(runtime);
+    EKTraceVerbose(EKTraceCategoryScene, "Effect is no longer running.");
+}
+
+// Returns how long an effect (or fade) should take. While skipping, everything happens instantly, since the player is
+// trying to get past it as quickly as possible.
+- (double)effectDuration:(double)duration
+{
+    return (isSkipping == YES) ? 0.0 : duration;
+}
+
+#pragma mark - Skip mode
+
+- (void)startSkipping
+{
+    if( isSkipping == YES || mode == VNSceneModeEnded )
+        return;
+    
+    [self wakeFromIdle];
+    EKTraceDebug(EKTraceCategoryScene, "Skip mode started.");
+    isSkipping = YES;
+}
+
+- (void)stopSkipping
+{
+    if( isSkipping == NO )
+        return;
+    
+    isSkipping = NO;
+    [self showSkippedSpeech]; // Make sure the line the player stopped at is actually on the screen
+    EKTraceDebug(EKTraceCategoryScene, "Skip mode stopped.");
+}
+
+// Runs as much of the script as possible during a single frame. Each line that's waiting for the player gets passed over
+// right away, as long as it's been read before (checking whether it's been read happens when the line gets shown; see
+// 'processCommand'). Skipping stops at unread lines, choices, and the end of the script. Effects don't stop skipping,
+// since they happen instantly while skipping, but if one does need to wait, then skipping picks up again once it's over.
+- (void)skipThroughScript
+{
+    uint64_t deadline = VNStatsNow() + (uint64_t)(self.skipTimeBudget * 1000000000.0);
+    
+    do {
+        [self runScript];
+        
+        // Stop for this frame if the runtime isn't waiting on a line of dialogue (or if that line stopped the skipping)
+        if( isSkipping == NO || mode != VNSceneModeNormal || VNRuntimeIsWaitingForInput(runtime) == 0 )
+            break;
+        
+        VNRuntimeAdvance(runtime);
+        
+    } while( VNStatsNow() < deadline );
+    
+    if( mode == VNSceneModeChoiceWithJump || mode == VNSceneModeChoiceWithFlag || mode == VNSceneModeEnded )
+        [self stopSkipping];
+    else
+        [self showSkippedSpeech];
+}
+
+// Only the last line skipped during a frame gets shown, since redrawing the text label for every line would take far
+// longer than running the script does.
+- (void)showSkippedSpeech
+{
+    if( skippedSpeech == nil )
+        return;
+    
+    NSString* text = skippedSpeech;
+    skippedSpeech = nil;
+    [self displaySpeech:text];
+    
+    // Typewriter text gets shown all at once
+    if( TWModeEnabled == YES ) {
+        TWNumberOfCurrentCharacters = TWNumberOfTotalCharacters;
+        [self updateTypewriterTextDisplay];
+    }
+}
+
+// Checks the read history for a line in the current conversation, and marks it as read. The page for the conversation is
+// only looked up after the conversation changes.
+- (BOOL)markLineAsRead:(NSInteger)line
+{
+    VNReadHistory* history = [VNScene readHistory];
+    if( line < 0 || history == NULL )
+        return NO;
+    
+    if( readHistoryPage == VNReadHistoryNoPage ) {
+        
+        NSString* scriptName = script.filename ? script.filename : @"";
+        NSString* conversationName = script.conversationName ? script.conversationName : @"";
+        readHistoryPage = VNReadHistoryPageFor(history, [scriptName UTF8String], [conversationName UTF8String]);
+    }
+    
+    return VNReadHistoryMarkRead(history, readHistoryPage, (uint32_t)line) ? NO : YES;
+}
+
+#pragma mark - Rollback
+
+- (NSUInteger)rollbackMemoryBudget
+{
+    return VNRollbackMemoryBudget(rollback);
+}
+
+- (void)setRollbackMemoryBudget:(NSUInteger)rollbackMemoryBudget
+{
+    VNRollbackSetMemoryBudget(rollback, rollbackMemoryBudget);
+}
+
+// The newest snapshot is the line that's on the screen right now, so it doesn't count
+- (NSUInteger)rewindableLineCount
+{
+    uint32_t count = VNRollbackCount(rollback);
+    return (count > 0) ? count - 1 : 0;
+}
+
+static void VNSceneAppendRollbackSection(NSMutableData* snapshot, NSData* section)
+{
+    uint8_t header[VNRollbackMaxSectionHeaderSize];
+    [snapshot appendBytes:header length:VNRollbackSectionHeader(header, section.length)];
+    [snapshot appendData:section];
+}
+
+// The list of changed flags only grows while a scene is running, so it only gets encoded again when the flag table
+// has actually changed since the last snapshot
+- (NSData*)encodedRollbackFlags
+{
+    if( rollbackFlagSection != nil && rollbackFlagTable == flags && rollbackFlagModificationCount == [flags modificationCount] )
+        return rollbackFlagSection;
+    
+    // Removed flags show up as NSNull, which can't go in a property list, so they're kept in their own list
+    NSMutableDictionary* changedFlags = [[NSMutableDictionary alloc] init];
+    NSMutableArray* removedFlags = [[NSMutableArray alloc] init];
+    [[flags changedFlags] enumerateKeysAndObjectsUsingBlock:^(id name, id value, BOOL* stop) {
+        if( value == [NSNull null] )
+            [removedFlags addObject:name];
+        else
+            [changedFlags setObject:value forKey:name];
+    }];
+    
+    NSDictionary* flagSection = @{@"changed": changedFlags, @"removed": removedFlags};
+    NSData* data = [NSPropertyListSerialization dataWithPropertyList:flagSection format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    if( data == nil )
+        return nil;
+    
+    rollbackFlagTable = flags;
+    rollbackFlagModificationCount = [flags modificationCount];
+    rollbackFlagSection = data;
+    return data;
+}
+
+- (NSData*)encodedRollbackAliases
+{
+    NSDictionary* aliases = self.localSpriteAliases ? self.localSpriteAliases : @{};
+    if( rollbackAliasSection != nil && [rollbackAliases isEqualToDictionary:aliases] )
+        return rollbackAliasSection;
+    
+    NSData* data = [NSPropertyListSerialization dataWithPropertyList:aliases format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    if( data == nil )
+        return nil;
+    
+    rollbackAliases = [aliases copy];
+    rollbackAliasSection = data;
+    return data;
+}
+
+// Each section is a binary property list. The first one holds the flags that have changed since the scene started,
+// the second one holds the sprite aliases, and the rest hold one key/value pair from the record each (sorted by key,
+// so that the same key usually lands in the same section, which is what lets VNRollback store just the differences).
+- (NSData*)rollbackSnapshot
+{
+    [self updateScriptInfo]; // The script's position is part of the record
+    [record setObject:@(VNBacklogPosition(backlog)) forKey:VNSceneBacklogPositionKey]; // So that rewinding can trim the backlog
+    
+    NSString* spritesToSave = [self spriteDataFromScene];
+    if( spritesToSave )
+        [record setValue:spritesToSave forKey:VNSceneSpritesToShowKey];
+    else
+        [record removeObjectForKey:VNSceneSpritesToShowKey];
+    
+    NSData* flagSection = [self encodedRollbackFlags];
+    NSData* aliasSection = [self encodedRollbackAliases];
+    if( flagSection == nil || aliasSection == nil ) {
+        NSLog(@"[VNScene] ERROR: Could not encode flags or sprite aliases for rollback.");
+        return nil;
+    }
+    
+    NSMutableData* snapshot = [[NSMutableData alloc] init];
+    VNSceneAppendRollbackSection(snapshot, flagSection);
+    VNSceneAppendRollbackSection(snapshot, aliasSection);
+    
+    for( NSString* key in [[record allKeys] sortedArrayUsingSelector:@selector(compare:)] ) {
+        
+        id value = [record objectForKey:key];
+        NSArray* cachedSection = [rollbackSectionCache objectForKey:key];
+        NSData* data = nil;
+        
+        if( cachedSection != nil && [[cachedSection objectAtIndex:0] isEqual:value] ) {
+            data = [cachedSection objectAtIndex:1];
+        } else {
+            
+            data = [NSPropertyListSerialization dataWithPropertyList:@[key, value] format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+            if( data == nil ) {
+                NSLog(@"[VNScene] ERROR: Value for record key '%@' can't be stored for rollback.", key);
+                data = [NSData data]; // Remembered as "can't be stored," so that the error only shows up once
+            }
+            
+            [rollbackSectionCache setObject:@[value, data] forKey:key];
+        }
+        
+        if( data.length > 0 )
+            VNSceneAppendRollbackSection(snapshot, data);
+    }
+    
+    return snapshot;
+}
+
+- (void)pushRollbackSnapshot
+{
+    if( rollback == NULL )
+        return;
+    
+    uint64_t startTime = VNStatsStart();
+    NSData* snapshot = [self rollbackSnapshot];
+    
+    if( snapshot != nil && VNRollbackPush(rollback, snapshot.bytes, snapshot.length) == 0 )
+        NSLog(@"[VNScene] ERROR: Could not add snapshot to rollback history.");
+    
+    VNStatsRecordTimer(VNStatsTimerRollback, startTime);
+    EKTraceVerbose(EKTraceCategoryScene, "Rollback snapshot: %lu bytes (history is using %lu bytes for %u snapshots).",
+                   (unsigned long)snapshot.length, (unsigned long)VNRollbackMemoryUsed(rollback), VNRollbackCount(rollback));
+}
+
+- (BOOL)rewindBy:(NSUInteger)lines
+{
+    if( lines < 1 || lines > self.rewindableLineCount )
+        return NO;
+    
+    // While an effect is running, sprites are still being moved around (and the safe-save is in use)
+    if( mode != VNSceneModeNormal && mode != VNSceneModeChoiceWithFlag && mode != VNSceneModeChoiceWithJump ) {
+        NSLog(@"[VNScene] WARNING: Can't rewind right now; the scene isn't waiting on the player.");
+        return NO;
+    }
+    
+    size_t length = VNRollbackRestore(rollback, (uint32_t)lines, NULL, 0);
+    NSMutableData* snapshot = [NSMutableData dataWithLength:length];
+    if( length == 0 || VNRollbackRestore(rollback, (uint32_t)lines, snapshot.mutableBytes, length) != length ) {
+        NSLog(@"[VNScene] ERROR: Could not restore snapshot from rollback history.");
+        return NO;
+    }
+    
+    if( [self restoreRollbackSnapshot:snapshot] == NO )
+        return NO;
+    
+    // The restored line is about to be shown again (which pushes a new snapshot for it), and anything that happened
+    // after it doesn't apply anymore
+    VNRollbackDiscardNewest(rollback, (uint32_t)lines + 1);
+    EKTraceInfo(EKTraceCategoryScene, "Rewound by %lu lines.", (unsigned long)lines);
+    return YES;
+}
+
+// Puts the scene back the way it was when a snapshot was taken. The script picks up from the line of dialogue that the
+// snapshot was taken at, so that line gets shown again (instead of the old text just being put back on the screen).
+- (BOOL)restoreRollbackSnapshot:(NSData*)snapshot
+{
+    const uint8_t* bytes = snapshot.bytes;
+    size_t offset = 0;
+    const uint8_t* section = NULL;
+    size_t sectionLength = 0;
+    NSMutableArray* sections = [[NSMutableArray alloc] init];
+    
+    while( VNRollbackReadSection(bytes, snapshot.length, &offset, &section, &sectionLength) ) {
+        
+        NSData* data = [NSData dataWithBytesNoCopy:(void*)section length:sectionLength freeWhenDone:NO];
+        id object = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil];
+        if( object == nil )
+            break;
+        
+        [sections addObject:object];
+    }
+    
+    if( offset != snapshot.length || sections.count < 2 ) {
+        NSLog(@"[VNScene] ERROR: Rollback snapshot is corrupt.");
+        return NO;
+    }
+    
+    NSDictionary* flagSection = [sections objectAtIndex:0];
+    NSDictionary* restoredAliases = [sections objectAtIndex:1];
+    NSMutableDictionary* restoredRecord = [[NSMutableDictionary alloc] initWithCapacity:sections.count];
+    for( NSUInteger i = 2; i < sections.count; i++ ) {
+        NSArray* pair = [sections objectAtIndex:i];
+        [restoredRecord setObject:[pair objectAtIndex:1] forKey:[pair objectAtIndex:0]];
+    }
+    
+    // Move the script back first, since that's the only part that can fail. Switching scripts is cheap, since the
+    // script cache still has the translated script.
+    NSDictionary* scriptInfo = [restoredRecord objectForKey:VNSceneSavedScriptInfoKey];
+    NSString* scriptName = [scriptInfo objectForKey:VNScriptFilenameKey];
+    VNScript* restoredScript = script;
+    
+    if( scriptName == nil ) {
+        NSLog(@"[VNScene] ERROR: Rollback snapshot doesn't have any script info.");
+        return NO;
+    } else if( [scriptName isEqualToString:script.filename] == NO ) {
+        restoredScript = [[VNScript alloc] initWithInfo:scriptInfo];
+    } else if( [restoredScript changeConversationTo:[scriptInfo objectForKey:VNScriptConversationNameKey]] == NO ) {
+        restoredScript = nil;
+    }
+    
+    if( restoredScript == nil ) {
+        NSLog(@"[VNScene] ERROR: Could not return to script position from rollback snapshot: %@", scriptInfo);
+        return NO;
+    }
+    
+    restoredScript.currentIndex = [[scriptInfo objectForKey:VNScriptCurrentIndexKey] integerValue];
+    restoredScript.indexesDone = restoredScript.currentIndex;
+    script = restoredScript;
+    
+    [self wakeFromIdle];
+    skippedSpeech = nil;
+    [self stopSkipping];
+    [self removeSafeSave];
+    [self hideBacklog];
+    
+    // The line that the snapshot was taken at gets added to the backlog again when it's shown, so it goes too (along
+    // with every line that came after it)
+    uint64_t backlogPosition = [[restoredRecord objectForKey:VNSceneBacklogPositionKey] unsignedLongLongValue];
+    if( backlogPosition > 0 )
+        VNBacklogRewindTo(backlog, backlogPosition - 1);
+    
+    // Get rid of the choice menu (if there is one)
+    for( SKSpriteNode* button in buttons ) {
+        [button removeAllChildren];
+        [button removeFromParent];
+    }
+    [buttons removeAllObjects];
+    buttons = nil;
+    buttonPicked = -1;
+    
+    // Sprites and the background all get created again from the restored record
+    for( SKSpriteNode* sprite in [sprites allValues] )
+        [sprite removeFromParent];
+    [sprites removeAllObjects];
+    VNSpriteTableRemoveAll(spriteTable);
+    [[self childNodeWithName:VNSceneTagBackground] removeFromParent];
+    
+    [speech removeAllActions];
+    [speaker removeAllActions];
+    speech.text = @" ";
+    speaker.text = @" ";
+    
+    // The music only starts over if it's different from what's playing now
+    NSString* restoredMusic = [restoredRecord objectForKey:VNSceneMusicToPlayKey];
+    BOOL keepsMusic = (isPlayingMusic == YES && restoredMusic != nil &&
+                       [restoredMusic isEqualToString:[record objectForKey:VNSceneMusicToPlayKey]] &&
+                       [[restoredRecord objectForKey:VNSceneMusicShouldLoopKey] isEqual:[record objectForKey:VNSceneMusicShouldLoopKey]]);
+    if( keepsMusic == NO )
+        [self stopBGMusic];
+    
+    // Flags that changed after the snapshot was taken go back to what they were when the scene started
+    NSDictionary* changedFlags = [flagSection objectForKey:@"changed"];
+    NSSet* removedFlags = [NSSet setWithArray:[flagSection objectForKey:@"removed"]];
+    [[flags changedFlags] enumerateKeysAndObjectsUsingBlock:^(id name, id value, BOOL* stop) {
+        if( [changedFlags objectForKey:name] == nil && [removedFlags containsObject:name] == NO )
+            [self->flags setObject:[self->sceneStartFlags objectForFlagNamed:name] forFlagNamed:name];
+    }];
+    [changedFlags enumerateKeysAndObjectsUsingBlock:^(id name, id value, BOOL* stop) {
+        [self->flags setObject:value forFlagNamed:name];
+    }];
+    for( NSString* name in removedFlags )
+        [flags setObject:nil forFlagNamed:name];
+    
+    record = restoredRecord;
+    self.localSpriteAliases = [restoredAliases mutableCopy];
+    
+    if( keepsMusic == YES ) {
+        [record removeObjectForKey:VNSceneMusicToPlayKey]; // So that 'loadSavedResources' doesn't start it over
+        [self loadSavedResources];
+        [record setObject:restoredMusic forKey:VNSceneMusicToPlayKey];
+    } else {
+        [self loadSavedResources];
+    }
+    
+    // 'loadSavedResources' only sets the speaker's text
+    if( [record objectForKey:VNSceneSpeakerNameToShowKey] != nil ) {
+        speaker.alpha = 1.0;
+        speaker.anchorPoint = CGPointMake(0, 1.0);
+        speaker.position = [self updatedSpeakerPosition];
+    }
+    
+    [self createRuntime];
+    effectIsRunning = NO;
+    cinematicTextTimer = 0.0;
+    mode = VNSceneModeNormal;
+    return YES;
+}
+
+#pragma mark - Backlog
+
+- (BOOL)isShowingBacklog
+{
+    return (backlogNode != nil);
+}
+
+- (void)showBacklog
+{
+    if( backlogNode != nil || backlog == NULL )
+        return;
+    
+    [self wakeFromIdle];
+    [self stopSkipping];
+    
+    CGFloat fontSize = (speech.fontSize > 0.0) ? speech.fontSize : VNSceneViewFontSize;
+    NSString* fontName = speech.fontName ? speech.fontName : [viewSettings objectForKey:VNSceneViewFontNameKey]; // Same font as the speech
+    
+    backlogNode = [[VNBacklogNode alloc] initWithSize:self.size
+                                            rowHeight:fontSize * VNSceneBacklogRowHeightInFontSizes
+                                             fontName:fontName
+                                             fontSize:fontSize];
+    if( speechBoxTextColor )
+        backlogNode.textColor = speechBoxTextColor;
+    backlogNode.dataSource = self;
+    backlogNode.zPosition = VNSceneBacklogLayer;
+    backlogNode.position = CGPointMake(0, 0);
+    [self addChild:backlogNode];
+    [backlogNode reloadData];
+    
+    EKTraceDebug(EKTraceCategoryScene, "Showing backlog (%u lines).", VNBacklogCount(backlog));
+}
+
+- (void)hideBacklog
+{
+    if( backlogNode == nil )
+        return;
+    
+    [self wakeFromIdle];
+    backlogNode.dataSource = nil;
+    [backlogNode removeFromParent];
+    backlogNode = nil;
+}
+
+// The speaker's name only gets looked up in the backlog when it changes, and so does the script/conversation
+- (void)addLineToBacklog:(NSInteger)line
+{
+    if( backlog == NULL || line < 0 )
+        return;
+    
+    if( backlogSource == VNBacklogNoName ) {
+        
+        NSString* scriptName = script.filename ? script.filename : @"";
+        NSString* conversationName = script.conversationName ? script.conversationName : @"";
+        backlogSource = VNBacklogInternSource(backlog, [scriptName UTF8String], [conversationName UTF8String]);
+    }
+    
+    NSString* speakerName = [record objectForKey:VNSceneSpeakerNameToShowKey];
+    if( speakerName != backlogSpeakerName && [speakerName isEqualToString:backlogSpeakerName] == NO ) {
+        
+        const char* name = [speakerName UTF8String];
+        backlogSpeakerName = speakerName;
+        backlogSpeaker = (name != NULL) ? VNBacklogInternName(backlog, name, strlen(name)) : VNBacklogNoName;
+    }
+    
+    VNBacklogAppend(backlog, backlogSpeaker, backlogSource, (uint32_t)line);
+}
+
+- (NSString*)backlogTextForEntry:(const VNBacklogEntry*)entry
+{
+    size_t length = 0;
+    const char* source = (entry != NULL) ? VNBacklogName(backlog, entry->source, &length) : NULL;
+    if( source == NULL )
+        return nil;
+    
+    // Sources are the script's name, then a zero byte, then the conversation's name
+    size_t scriptNameLength = strnlen(source, length);
+    if( scriptNameLength >= length )
+        return nil;
+    
+    NSString* scriptName = [[NSString alloc] initWithBytes:source length:scriptNameLength encoding:NSUTF8StringEncoding];
+    NSString* conversationName = [[NSString alloc] initWithBytes:source + scriptNameLength + 1
+                                                          length:length - scriptNameLength - 1
+                                                        encoding:NSUTF8StringEncoding];
+    if( scriptName == nil || conversationName == nil )
+        return nil;
+    
+    // Lines from an earlier script (like one that was switched away from) need that script loaded again, which is
+    // cheap since the script cache still has it
+    VNScript* sourceScript = script;
+    if( [scriptName isEqualToString:script.filename] == NO ) {
+        
+        if( [scriptName isEqualToString:backlogScript.filename] == NO )
+            backlogScript = [[VNScript alloc] initFromFile:scriptName];
+        
+        sourceScript = backlogScript;
+    }
+    
+    VNScriptConversation* conversation = [sourceScript conversationNamed:conversationName];
+    const VNScriptCommandRecord* command = [conversation recordAtIndex:entry->line];
+    if( command == NULL || command->type != VNScriptCommandSayLine )
+        return nil;
+    
+    return [conversation stringOperand:0 ofRecord:command];
+}
+
+- (NSUInteger)numberOfRowsInBacklogNode:(VNBacklogNode*)node
+{
+    return VNBacklogCount(backlog);
+}
+
+- (NSString*)backlogNode:(VNBacklogNode*)node speakerForRow:(NSUInteger)row
+{
+    const VNBacklogEntry* entry = VNBacklogEntryAt(backlog, (uint32_t)row);
+    size_t length = 0;
+    const char* name = (entry != NULL) ? VNBacklogName(backlog, entry->speaker, &length) : NULL;
+    
+    return (name != NULL) ? [[NSString alloc] initWithBytes:name length:length encoding:NSUTF8StringEncoding] : nil;
+}
+
+- (NSString*)backlogNode:(VNBacklogNode*)node textForRow:(NSUInteger)row
+{
+    return [self backlogTextForEntry:VNBacklogEntryAt(backlog, (uint32_t)row)];
+}
+
+// The backlog node gets the touches while it's on the screen, so the scene doesn't see them
+- (void)backlogNodeWasTouched:(VNBacklogNode*)node
+{
+    [self wakeFromIdle];
+}
+
+- (void)backlogNodeWasDismissed:(VNBacklogNode*)node
+{
+    [self hideBacklog];
+}
+
+// The newest lines of the backlog get stored alongside the rest of the record when the game is saved
+- (NSDictionary*)recordWithBacklog:(NSDictionary*)recordToSave
+{
+    size_t length = VNBacklogEncode(backlog, VNSceneBacklogSaveLimit, NULL, 0);
+    if( length == 0 )
+        return recordToSave;
+    
+    NSMutableData* data = [NSMutableData dataWithLength:length];
+    if( VNBacklogEncode(backlog, VNSceneBacklogSaveLimit, data.mutableBytes, length) != length ) {
+        NSLog(@"[VNScene] ERROR: Could not encode backlog.");
+        return recordToSave;
+    }
+    
+    NSMutableDictionary* result = [recordToSave mutableCopy];
+    [result setObject:[data base64EncodedStringWithOptions:0] forKey:VNSceneBacklogKey];
+    return result;
+}
+
+// The speaker and the current line get copied into the activity dictionary, so that EKRecord can show them in the slot
+// index without having to know anything about how VNScene stores its data.
+- (void)addPreviewOfRecord:(NSDictionary*)savedRecord toActivityDict:(NSMutableDictionary*)dict
+{
+    NSString* speakerName = [savedRecord objectForKey:VNSceneSpeakerNameToShowKey];
+    NSString* speech = [savedRecord objectForKey:VNSceneSpeechToDisplayKey];
+    
+    if( speakerName != nil )
+        [dict setObject:speakerName forKey:EKRecordPreviewSpeakerKey];
+    if( speech != nil )
+        [dict setObject:speech forKey:EKRecordPreviewTextKey];
 }
 
 // Update script info. This consists of index data, the script name, and which conversation/section is the current one
@@ -1006,6 +1748,10 @@ VNScene* theCurrentScene = nil;
 - (void)updateScriptInfo
 {
     if( script ) {
+        // The runtime keeps track of the indexes while the script is running, so the script's copies get updated first
+        script.currentIndex = VNRuntimeCurrentIndex(runtime);
+        script.indexesDone = VNRuntimeIndexesDone(runtime);
+        
         // Save existing script information (indexes, "current" conversation name, etc.) in the record.
         // This overwrites any script information which may already have been stored.
         [record setObject:[script info] forKey:VNSceneSavedScriptInfoKey];
@@ -1015,7 +1761,8 @@ VNScene* theCurrentScene = nil;
 // This saves important information (script info, flags, which resources are being used, etc) to EKRecord.
 - (void)saveToRecord
 {
-    NSLog(@"[VNScene] Saving data to record.");
+    EKTraceDebug(EKTraceCategorySave, "Saving data to record.");
+    uint64_t startTime = VNStatsStart();
     
     // Create the default "dictionary to save" that will be passed into EKRecord's "activity dictionary."
     // Keep in mind that the activity dictionary holds the type of activity that the player was engaged in
@@ -1027,114 +1774,199 @@ VNScene* theCurrentScene = nil;
     // Check if the "safe save" exists; if it does, then it should be used instead of whatever the current data is.
     if( safeSave != nil ) {
     
-        [[[EKRecord sharedRecord] spriteAliases] addEntriesFromDictionary:[safeSave objectForKey:@"aliases"]];
-        [[[EKRecord sharedRecord] flags] addEntriesFromDictionary:[safeSave objectForKey:@"flags"]];
-        [dictToSave setObject:[safeSave objectForKey:@"record"] forKey:EKRecordActivityDataKey];
+        // Only the flags that had changed by the time the snapshot was taken get written back. The scene's own flags
+        // don't get their changes cleared here, since they still have to be saved once the scene is back to normal.
+        [[[EKRecord sharedRecord] spriteAliases] addEntriesFromDictionary:safeSave.spriteAliases];
+        [[EKRecord sharedRecord] addChangedFlagsFromTable:safeSave.flags];
+        [dictToSave setObject:[self recordWithBacklog:safeSave.record] forKey:EKRecordActivityDataKey];
+        [self addPreviewOfRecord:safeSave.record toActivityDict:dictToSave];
         [[EKRecord sharedRecord] setActivityDict:dictToSave];
+        VNStatsRecordTimer(VNStatsTimerSave, startTime);
         return;
     }
     
     // Save all the names and coordinates of the sprites still active in the scene. This data will be enough
     // to recreate them later on, when the game is loaded from saved data.
-    NSArray* spritesToSave = [self spriteDataFromScene];
+    NSString* spritesToSave = [self spriteDataFromScene];
     if( spritesToSave )
         [record setValue:spritesToSave forKey:VNSceneSpritesToShowKey];
     else
         [record removeObjectForKey:VNSceneSpritesToShowKey];
     
-    // Load all flag data back to EKRecord. Remember that VNScene doesn't have a monopoly on flag data;
-    // other classes and game systems can modify the flags as well! 
-    [[EKRecord sharedRecord].flags addEntriesFromDictionary:flags];
+    // Load flag data back to EKRecord. Remember that VNScene doesn't have a monopoly on flag data; other classes
+    // and game systems can modify the flags as well, so only the flags that the scene has changed get written back
+    // (which also means that saving doesn't take longer as the number of flags grows). The changes aren't cleared
+    // afterwards, since rollback snapshots need to know every flag that's changed since the scene started.
+    [[EKRecord sharedRecord] addChangedFlagsFromTable:flags];
     
     // Do the same with sprite aliases (which can also be manipulated by external classes)
     [[EKRecord sharedRecord].spriteAliases addEntriesFromDictionary:self.localSpriteAliases];
     
     // Update script data and then load it into the activity dictionary.
     [self updateScriptInfo];                                        // Update all index and conversation data
-    [dictToSave setObject:record forKey:EKRecordActivityDataKey];   // Load into activity dictionary
+    [dictToSave setObject:[self recordWithBacklog:record] forKey:EKRecordActivityDataKey]; // Load into activity dictionary (with the backlog)
+    [self addPreviewOfRecord:record toActivityDict:dictToSave];     // Whoever's speaking gets shown in the list of saved games
     [[EKRecord sharedRecord] setActivityDict:dictToSave];           // Save the activity dictionary into EKRecord
+    [VNScene saveReadHistory];                                      // The read history is global, but gets saved alongside everything else
     [[EKRecord sharedRecord] saveToDevice];                         // Save all record data to device memory
+    VNStatsRecordTimer(VNStatsTimerSave, startTime);
     
-    NSLog(@"[VNScene] Data has been saved. Stored data is: %@", dictToSave);
+    EKTraceVerbose(EKTraceCategorySave, "Data has been saved. Stored data is: %s", [[dictToSave description] UTF8String]);
 }
 
 // Create the "safe save." This function usually gets called before VNScene does some sort of volatile/potentially-hazardous
 // operation, like performing effects or presenting the player with choices menus. In case the game needs to be saved during
 // times like this, the data stored in the "safe save" will be the data that's stored in the saved game.
+//
+// If there's already a safe-save (several volatile commands can run before the scene gets back to Normal Mode), it's
+// kept as-is, since it still holds the last point where things were actually safe.
 - (void)createSafeSave
 {
-    NSLog(@"[VNScene] Creating safe-save data.");
+    if( safeSave != nil )
+        return;
+    
+    EKTraceDebug(EKTraceCategorySave, "Creating safe-save data.");
     [self updateScriptInfo]; // Update index data, conversation name, script filename, etc. to the most recent information
     
     // Save sprite names and coordinates
-    NSArray* spritesToSave = [self spriteDataFromScene];
+    NSString* spritesToSave = [self spriteDataFromScene];
     if( spritesToSave )
         [record setValue:spritesToSave forKey:VNSceneSpritesToShowKey];
     
-    // Create dictionary object
-    safeSave = [[NSDictionary alloc] initWithObjectsAndKeys:[flags copy], @"flags",    // Holds flags before they were modified
-                                                            [self.localSpriteAliases copy], @"aliases",
-                                                            record, @"record",         // Holds sprite data, UI data, etc.
-                                                            [script info], VNSceneSavedScriptInfoKey, // Script/index/conversationd ata
-                                                            nil];
+    // The snapshot shares storage with the flags, aliases, and record until the scene modifies them, so this doesn't
+    // copy anything yet (the record includes the script info, so that doesn't need to be stored separately).
+    safeSave = [VNSceneSnapshot snapshotWithFlags:flags spriteAliases:self.localSpriteAliases record:record];
 }
 
 - (void)removeSafeSave
 {
-    NSLog(@"[VNScene] Removing safe-save data.");
+    EKTraceDebug(EKTraceCategorySave, "Removing safe-save data.");
     safeSave = nil;
 }
 
-// This creates an array that stores all the sprite filenames and coordinates. When the game is loaded from saved data,
-// the sprites can be easily reloaded and repositioned.
-- (NSArray*)spriteDataFromScene
+// Sprites and backgrounds (and speechboxes and choice buttons) get loaded from here, so that the time it takes to load
+// their images shows up in VNStats. The textures come from VNAssetCache, which usually has them ready ahead of time.
+- (SKSpriteNode*)spriteWithImageNamed:(NSString*)filename
+{
+    uint64_t startTime = VNStatsStart();
+    SKSpriteNode* sprite = [SKSpriteNode spriteNodeWithTexture:[[VNAssetCache sharedCache] textureNamed:filename]];
+    VNStatsRecordTimer(VNStatsTimerSpriteLoad, startTime);
+    
+    return sprite;
+}
+
+// The sprite table already has the name, file, position and scale of every sprite (the sprite commands keep it up to
+// date), so it just needs to be encoded. It's only encoded again if something has changed since the last time, so saving
+// (or taking a safe-save, or a rollback snapshot) over and over doesn't cost anything while the sprites stay put.
+- (NSString*)spriteDataFromScene
 {
-    if( sprites == nil || sprites.count < 1 ) {
-        NSLog(@"[VNScene] No sprite data found in scene.");
+    if( VNSpriteTableCount(spriteTable) == 0 ) {
+        EKTraceDebug(EKTraceCategorySprites, "No sprite data found in scene.");
         return nil;
     }
     
-    NSLog(@"[VNScene] Retrieving sprite data from scene!");
+    if( encodedSpriteTable == nil || VNSpriteTableIsDirty(spriteTable) ) {
+        
+        size_t length = VNSpriteTableEncode(spriteTable, NULL, 0);
+        NSMutableData* data = [NSMutableData dataWithLength:length];
+        if( VNSpriteTableEncode(spriteTable, data.mutableBytes, length) != length ) {
+            NSLog(@"[VNScene] ERROR: Could not encode sprite data.");
+            return nil;
+        }
+        
+        encodedSpriteTable = [data base64EncodedStringWithOptions:0];
+        VNSpriteTableClearDirty(spriteTable);
+        EKTraceVerbose(EKTraceCategorySprites, "Sprite table encoded (%u sprites, %lu bytes).", VNSpriteTableCount(spriteTable), (unsigned long)length);
+    }
     
-    // Create the "sprites array." Each index in the array holds a dictionary, and each dictionary holds
-    // certain data: sprite filename, sprite x coordinate, and sprite y coordinate.
-    NSMutableArray* spritesArray = [NSMutableArray array];
+    return encodedSpriteTable;
+}
+
+#pragma mark - Idle scheduling
+
+// The scene can go idle when it's waiting on the player (to tap past a line that's already fully shown, or to pick
+// a choice) and nothing on the screen is moving.
+- (BOOL)canBecomeIdle
+{
+    if( self.allowsIdling == NO || isSkipping == YES || self.view == nil )
+        return NO;
     
-    // Get every single sprite from the 'sprites' dictionary and extract the relevent data from it.
-    for( NSString* spriteName in [sprites allKeys] ) {
+    if( mode == VNSceneModeNormal ) {
         
-        NSLog(@"[VNScene] Saving sprite named: %@", spriteName);
-        //CCSprite* actualSprite = [sprites objectForKey:spriteName]; // The actual CCSprite object is used as a reference (for getting coordinate data)
-        SKSpriteNode* actualSprite = sprites[spriteName];
-        NSNumber* spriteX = @(actualSprite.position.x); // Get coordinates; these will be saved to the dictionary.
-        NSNumber* spriteY = @(actualSprite.position.y);
-        
-        // store scaling data as well (this is used mostly for inverted sprites)
-        NSNumber* scaleX = @(actualSprite.xScale);
-        NSNumber* scaleY = @(actualSprite.yScale);
-        
-        // Save relevant data (sprite name and coordinates) in a dictionary
-        NSMutableDictionary* tempSpriteDictionary = [NSMutableDictionary dictionaryWithCapacity:3];
-        [tempSpriteDictionary setValue:spriteName forKey:@"name"];
-        [tempSpriteDictionary setValue:spriteX forKey:@"x"];
-        [tempSpriteDictionary setValue:spriteY forKey:@"y"];
-        [tempSpriteDictionary setValue:scaleX forKey:@"scale x"];
-        [tempSpriteDictionary setValue:scaleY forKey:@"scale y"];
-        
-        // Check to see if this has a different filename
-        NSString* filenameOfSprite = [self filenameOfSpriteAlias:spriteName];
-        // if the filenames are different, then it means that there is an alias value
-        if( [filenameOfSprite caseInsensitiveCompare:spriteName] != NSOrderedSame ) {
-            [tempSpriteDictionary setValue:filenameOfSprite forKey:@"filename"];
-        }
+        if( VNRuntimeIsWaitingForInput(runtime) == 0 )
+            return NO;
         
-        NSDictionary* savedSpriteData = [NSDictionary dictionaryWithDictionary:tempSpriteDictionary];
+        // Cinematic text moves the script forward on its own, and typewriter text may still be printing
+        if( cinematicTextSpeed > 0.0 )
+            return NO;
+        if( TWModeEnabled == YES && TWNumberOfCurrentCharacters < TWNumberOfTotalCharacters )
+            return NO;
         
-        // Save dictionary data into the array (which will later be saved to a file)
-        [spritesArray addObject:savedSpriteData];
+    } else if( mode == VNSceneModeChoiceWithJump || mode == VNSceneModeChoiceWithFlag ) {
+        
+        if( buttonPicked >= 0 )
+            return NO;
+        
+    } else {
+        return NO;
+    }
+    
+    return [self nodeIsAnimating:self] ? NO : YES;
+}
+
+// Checks a node and all its children for running actions (fades, effects, sounds...) or particle emitters
+- (BOOL)nodeIsAnimating:(SKNode*)node
+{
+    if( [node hasActions] || [node isKindOfClass:[SKEmitterNode class]] )
+        return YES;
+    
+    for( SKNode* child in node.children ) {
+        if( [self nodeIsAnimating:child] )
+            return YES;
     }
     
-    return [NSArray arrayWithArray:spritesArray];
+    return NO;
+}
+
+- (void)enterIdleState
+{
+    if( isIdle == YES || self.view == nil )
+        return;
+    
+    isIdle = YES;
+    activeFramesPerSecond = self.view.preferredFramesPerSecond;
+    
+    if( self.idleFramesPerSecond > 0 )
+        self.view.preferredFramesPerSecond = self.idleFramesPerSecond;
+    else
+        self.view.paused = YES;
+    
+    EKTraceDebug(EKTraceCategoryScene, "Scene is now idle (frame rate: %ld).", (long)self.idleFramesPerSecond);
+}
+
+- (void)wakeFromIdle
+{
+    idleTimer = 0.0;
+    
+    if( isIdle == NO )
+        return;
+    
+    isIdle = NO;
+    if( self.view ) {
+        self.view.preferredFramesPerSecond = activeFramesPerSecond;
+        self.view.paused = NO;
+    }
+    
+    // The time spent idle shouldn't count towards anything that's timed
+    VNClockResync(&sceneClock);
+    EKTraceDebug(EKTraceCategoryScene, "Scene woke up from being idle.");
+}
+
+// If something else takes over the view while the scene is idle, the view shouldn't be left paused (or running slowly)
+- (void)willMoveFromView:(SKView *)view
+{
+    [self wakeFromIdle];
+    [super willMoveFromView:view];
 }
 
 #pragma mark -
@@ -1142,6 +1974,8 @@ VNScene* theCurrentScene = nil;
 
 - (void)touchesBegan:(NSSet *)touches withEvent:(UIEvent *)event
 {
+    [self wakeFromIdle];
+    
     for( UITouch* touch in touches ) {
         
         CGPoint touchPos = [touch locationInNode:self];
@@ -1176,6 +2010,8 @@ VNScene* theCurrentScene = nil;
 
 - (void)touchesMoved:(NSSet *)touches withEvent:(UIEvent *)event
 {
+    [self wakeFromIdle];
+    
     for( UITouch* touch in touches ) {
         
         CGPoint touchPos = [touch locationInNode:self];
@@ -1205,6 +2041,8 @@ VNScene* theCurrentScene = nil;
 
 - (void)touchesEnded:(NSSet *)touches withEvent:(UIEvent *)event
 {
+    [self wakeFromIdle];
+    
     for( UITouch* touch in touches ) {
         
         CGPoint touchPos = [touch locationInNode:self];
@@ -1214,6 +2052,12 @@ VNScene* theCurrentScene = nil;
         // of dialogue).
         if( mode == VNSceneModeNormal ) { // Story mode
             
+            // Tapping while skipping just stops the skipping (instead of also moving past the current line)
+            if( isSkipping == YES ) {
+                [self stopSkipping];
+                return;
+            }
+            
             // The "just loaded from save" flag is disabled once the user passes the first line of dialogue
             if( self.wasJustLoadedFromSave == YES ) {
                 self.wasJustLoadedFromSave = NO; // Remove flag
@@ -1239,7 +2083,7 @@ VNScene* theCurrentScene = nil;
                     }
                     
                     if( canSkip == YES ) {
-                        [script advanceIndex]; // Move the script forward
+                        VNRuntimeAdvance(runtime); // Move the script forward
                     }
                 }
             } else {
@@ -1260,7 +2104,7 @@ VNScene* theCurrentScene = nil;
                         }
                         
                         if( canSkip == YES ) {
-                            [script advanceIndex];
+                            VNRuntimeAdvance(runtime);
                         }
                     }
                 }
@@ -1314,11 +2158,25 @@ VNScene* theCurrentScene = nil;
 
 - (void)update:(NSTimeInterval)currentTime
 {
+    // While the scene is idle, there's nothing to do until something (like a touch) wakes it up. This only comes up if
+    // the view is running at a lower frame rate instead of being paused.
+    if( isIdle == YES )
+        return;
+    
+    // Frames are counted under whichever mode the scene was in when the frame started
+    uint64_t frameStartTime = VNStatsStart();
+    int frameMode = mode;
+    
+    // Everything that's timed works from how much time has passed since the last frame (instead of assuming 60 frames
+    // per second), so that the scene behaves the same way at 120Hz, or when frames get dropped.
+    VNClockTick(&sceneClock, currentTime);
+    uint64_t frameInterval = (uint64_t)(sceneClock.hostDelta * 1000000000.0);
+    
     // Check if the scene is finished
     if( script.isFinished == YES ) {
         
         // Print the 'quitting time' message
-        NSLog(@"[VNScene] The 'Script Is Finished' flag is triggered. Now moving to 'end of script' mode.");
+        EKTraceInfo(EKTraceCategoryScene, "The 'Script Is Finished' flag is triggered. Now moving to 'end of script' mode.");
         mode = VNSceneModeEnded; // Set 'end' mode
     }
     
@@ -1327,7 +2185,7 @@ VNScene* theCurrentScene = nil;
         // Resources need to be loaded?
         case VNSceneModeLoading:
 
-            NSLog(@"[VNScene] Now in 'loading mode'");
+            EKTraceDebug(EKTraceCategoryScene, "Now in 'loading mode'");
             
             // Do any last-minute loading operations here
 			[self loadSavedResources];
@@ -1339,7 +2197,7 @@ VNScene* theCurrentScene = nil;
         // Have all the resources and script data just finished loading?
         case VNSceneModeFinishedLoading:
             
-            NSLog(@"[VNScene] Finished loading.");
+            EKTraceDebug(EKTraceCategoryScene, "Finished loading.");
             
             // Switch to "Normal Mode" (which is where the dialogue and normal script processing happen)
             mode = VNSceneModeNormal;
@@ -1355,21 +2213,37 @@ VNScene* theCurrentScene = nil;
                 [self removeSafeSave];
             }
             
+            // The script waits while the player is reading the backlog
+            if( backlogNode != nil )
+                break;
+            
+            // While skipping, the script runs for as long as the frame's time budget allows (and cinematic text and
+            // typewriter text don't get a say in when lines are passed over)
+            if( isSkipping == YES ) {
+                [self skipThroughScript];
+                break;
+            }
+            
             // Take care of normal operations
             [self runScript]; // Process script data
             
             if( cinematicTextSpeed > 0.0 ) {
-                cinematicTextCounter++;
+                cinematicTextTimer += sceneClock.delta;
                 
-                if( cinematicTextCounter >= cinematicTextSpeedInFrames ) {
-                    [script advanceIndex];
-                    cinematicTextCounter = 0;
+                if( cinematicTextTimer >= cinematicTextSpeed ) {
+                    VNRuntimeAdvance(runtime);
+                    
+                    // Keep whatever time went past the deadline, so that lines don't gradually fall behind schedule
+                    // when frames are long (unless it's enough for another whole line, which would mean skipping one)
+                    cinematicTextTimer -= cinematicTextSpeed;
+                    if( cinematicTextTimer >= cinematicTextSpeed ) {
+                        cinematicTextTimer = 0.0;
+                    }
                 }
             }
             
             if (TWModeEnabled == YES) {
                 if (TWNumberOfCurrentCharacters < TWNumberOfTotalCharacters) {
-                    TWTimer++;
                     [self updateTypewriterTextDisplay];
                 }
             }
@@ -1400,8 +2274,7 @@ VNScene* theCurrentScene = nil;
             // to figure out which button was pressed just by seeing what value was stored in 'buttonPicked'
             if( buttonPicked >= 0 ) {
                 
-                NSString* conversationToJumpTo = [choices objectAtIndex:buttonPicked]; // The conversation names are stored in the 'choices' array
-                [script changeConversationTo:conversationToJumpTo]; // Switch to the new "conversation" / dialogue array.
+                VNRuntimeChoose(runtime, buttonPicked); // The runtime switches to whichever "conversation" / dialogue array goes with that choice
                 mode = VNSceneModeNormal; // Go back to Normal Mode (after this has been processed, of course)
                 
                 // Get rid of any lingering objects in memory
@@ -1427,22 +2300,11 @@ VNScene* theCurrentScene = nil;
                         
             if( buttonPicked >= 0 ) {
                 
-                // Get array elements
-                id flagName  = [choices objectAtIndex:buttonPicked];
-                id flagValue = [choiceExtras objectAtIndex:buttonPicked];
-                id oldFlag   = [flags objectForKey:flagName];
-                
-                // Check if the flag had a previously existing value; if it did, then just add the old value to the new value
-                if( oldFlag ) {
-                    
-                    id tempValue = [NSNumber numberWithInt:( [oldFlag intValue] + [flagValue intValue] )];
-                    flagValue = tempValue;
-                }
-                
-                // Set the new value of the flag. The change will be made to the "local" flag dictionary, not the
-                // global one stored in EKRecord. This is to prevent any save-data conflicts (since it's certainly
-                // possible that not all the data in the VNScene will be stored along with the updated flag data)
-                [flags setValue:flagValue forKey:flagName];
+                // Set the new value of the flag. If the flag had a previously existing value, then the new value just
+                // gets added to the old value. The change will be made to the "local" flag table, not the global one
+                // stored in EKRecord. This is to prevent any save-data conflicts (since it's certainly possible that
+                // not all the data in the VNScene will be stored along with the updated flag data)
+                VNRuntimeChoose(runtime, buttonPicked);
                 
                 // Get rid of any unnecessary objects in memory
                 if( buttons ) {
@@ -1455,8 +2317,6 @@ VNScene* theCurrentScene = nil;
                 // Get rid of any lingering data
                 [buttons removeAllObjects];
                 buttons = nil;
-                choices = nil;
-                choiceExtras = nil;
                 buttonPicked = -1; // Reset this to the original, untouched value
                 
                 // Return to 'normal' mode
@@ -1471,12 +2331,13 @@ VNScene* theCurrentScene = nil;
             
             if( self.isFinished == NO ) {
             
-                NSLog(@"[VNScene] The scene has ended. Flag data will be auto-saved.");
-                NSLog(@"[VNScene] Remaining scene and activity data will be deleted.");
+                EKTraceInfo(EKTraceCategoryScene, "The scene has ended. Flag data will be auto-saved.");
+                EKTraceInfo(EKTraceCategoryScene, "Remaining scene and activity data will be deleted.");
             
                 // Save all necessary data
                 EKRecord* theRecord = [EKRecord sharedRecord];
-                [theRecord addExistingFlags:flags]; // Save flag data (this can overwrite existing flag values)
+                [theRecord addChangedFlagsFromTable:flags]; // Save flag data (this can overwrite existing flag values)
+                [VNScene saveReadHistory]; // Lines that were read during the scene are remembered for next time
                 //[theRecord resetActivityInformationInDict:theRecord.record]; // Remove activity data from record
                 
                 self.isFinished = YES; // Mark as finished
@@ -1502,210 +2363,497 @@ VNScene* theCurrentScene = nil;
                 }
             } else {
                 // nothing should happen
-                NSLog(@"[VNScene] Scene mode is SCENE ENDED, no activity should take place.");
+                EKTraceVerbose(EKTraceCategoryScene, "Scene mode is SCENE ENDED, no activity should take place.");
             }
             
             break;
             
         default:break;
     }
+    
+    // Once the scene has been waiting on the player for a moment (with nothing moving), it goes idle until it gets woken up
+    if( [self canBecomeIdle] ) {
+        idleTimer += sceneClock.delta;
+        if( idleTimer >= VNSceneIdleDelay )
+            [self enterIdleState];
+    } else {
+        idleTimer = 0.0;
+    }
+    
+    VNStatsRecordFrame(frameMode, frameStartTime, frameInterval);
 }
 
-// Processes the script (during "Normal Mode"). This function determines whether it's safe to process the script (since there are
+// Processes the script (during "Normal Mode"). The runtime decides whether it's safe to process the script (since there are
 // many times when it might be considered "unsafe," such as when effects are being run, or even if it's something mundane like
-// waiting for user input).
+// waiting for user input), and runs commands until one of those happens.
 - (void)runScript
 {
-    BOOL scriptShouldBeRun = YES; // This flag is used to run the following loop...
+    VNRuntimeRun(runtime);
     
-    while( scriptShouldBeRun == YES ) {
-        
-        // Check if there's anything that could change this flag
-        if( [script lineShouldBeProcessed] == NO ) // Have enough indexes been processed for now?
-            scriptShouldBeRun = NO;
-        if( mode == VNSceneModeEffectIsRunning ) // When effects are running, it becomes impossible to reliably process the script
-            scriptShouldBeRun = NO;
-        if( mode == VNSceneModeChoiceWithJump || mode == VNSceneModeChoiceWithFlag ) // Should a choice be made?
-            scriptShouldBeRun = NO; // Can't run script while waiting for player input!
-        
-        // Check if any of the "stop running" conditions were met; in that case the function should just stop
-        if( scriptShouldBeRun == NO )
-            return;
-        
-        /* If the function has made it this far, then it's time to grab more script data and process that */
+    // Check if there's no more script data (or the script couldn't be switched)
+    if( VNRuntimeGetState(runtime) == VNRuntimeStateEnded ) {
+        // Print warning message and finish the scene
+        EKTraceInfo(EKTraceCategoryScript, "Script has run out of commands. Switching to 'Scene Ended' mode...");
+        mode = VNSceneModeEnded;
+        return;
+    }
+    
+    // The script has stopped to wait for something, which is a good time to get the next few commands' assets loading
+    [self prefetchUpcomingAssets];
+}
+
+// Returns the position for where the speaker label should be (since the size changes every time the text changes,
+// it has to be repositioned each time).
+- (CGPoint)updatedSpeakerPosition
+{
+    if( speaker == nil || speechBox == nil )
+        return CGPointZero;
+    
+    CGFloat widthOfSpeechBox = speechBox.frame.size.width;
+    CGFloat heightOfSpeechBox = speechBox.frame.size.height;
+    CGPoint speakerNameOffsets = CGPointZero;
+    
+    // Load speaker offset values
+    NSNumber* speakerNameOffsetXValue = [viewSettings objectForKey:VNSceneViewSpeakerNameXOffsetKey];
+    NSNumber* speakerNameOffsetYValue = [viewSettings objectForKey:VNSceneViewSpeakerNameYOffsetKey];
+    if( speakerNameOffsetXValue ) speakerNameOffsets.x = (CGFloat) [speakerNameOffsetXValue doubleValue];
+    if( speakerNameOffsetYValue ) speakerNameOffsets.y = (CGFloat) [speakerNameOffsetYValue doubleValue];
+    
+    CGSize screenSize = self.view.frame.size;
+    CGSize boxSize = speechBox.frame.size;
+    CGSize workingArea = boxSize;
+    
+    // Check if the speech box is actually wider than the screen's width
+    if( screenSize.width < boxSize.width ) {
+        workingArea.width = screenSize.width;
+    }
+    widthOfSpeechBox = workingArea.width;
+    
+    // Find top-left corner of the speech box
+    CGPoint topLeftCornerOfSpeechBox = CGPointMake( 0.0 - (widthOfSpeechBox * 0.5), 0 + (heightOfSpeechBox * 0.5));
+    // Adjust slightly so that the label isn't jammed up against the upper-left corner; there should be a bit of margins
+    CGPoint adjustment = CGPointMake(widthOfSpeechBox * 0.02, heightOfSpeechBox * -0.05);
+    // Store adjustments
+    CGPoint cornerPlusAdjustments = EKPositionAddTwoPositions(topLeftCornerOfSpeechBox, adjustment);
+    // Add custom offsets
+    CGPoint adjustedPlusOffsets = EKPositionAddTwoPositions(cornerPlusAdjustments, speakerNameOffsets);
+    
+    return adjustedPlusOffsets;
+}
+
+// Since the speech label's size changes every time the text changes, this also has to be repositioned each time
+// a new line of dialogue is shown.
+- (CGPoint)updatedTextPosition
+{
+    if( !speech || !speechBox )
+        return CGPointZero;
+    
+    CGFloat widthOfBox = speechBox.frame.size.width;
+    CGFloat heightOfBox = speechBox.frame.size.height;
+    
+    CGSize screenSize = self.view.frame.size;
+    CGSize boxSize = speechBox.frame.size;
+    CGSize workingArea = boxSize;
+    
+    // Check if the speechbox is wider than the screen/view, in which case whichever one is smaller will be used
+    if( screenSize.width < boxSize.width ) {
+        workingArea.width = screenSize.width;
+    }
+    widthOfBox = workingArea.width;
+    
+    //[viewSettings objectForKey:nil];
+    
+    //float verticalMargins = [[viewSettings objectForKey:VNSceneViewSpeechVerticalMarginsKey] floatValue];
+    float horizontalMargins = [[viewSettings objectForKey:VNSceneViewSpeechHorizontalMarginsKey] floatValue];
+    float speechXOffset = [[viewSettings objectForKey:VNSceneViewSpeechOffsetXKey] floatValue];
+    
+    //NSLog(@"verticalMargins = %f, speechYOffset = %f", verticalMargins, speechYOffset);
+    
+    // Find top-left corner of speechbox (child node will be centered right over the very corner)
+    CGPoint topLeftCornerOfBox = CGPointMake( 0.0 - (widthOfBox * 0.5), 0 + (heightOfBox * 0.5));
+    CGFloat textX = topLeftCornerOfBox.x + (widthOfBox * 0.04) + speechXOffset + horizontalMargins; // + speechXOffset + horizontalMargins;
+    CGFloat textY = topLeftCornerOfBox.y - (heightOfBox * 0.1) - speaker.frame.size.height;// - verticalMargins - speechYOffset;
+
+    return CGPointMake(textX, textY);
+}
+
+#pragma mark - Asset prefetching
+
+// Looks through the next few commands in the current conversation, and has VNAssetCache start loading the images and
+// sounds that they're going to need. Commands that were looked at the last time (because they were already within
+// reach back then) are skipped, so usually only a command or two is new each time.
+- (void)prefetchUpcomingAssets
+{
+    // Skipping goes through far more commands than could ever be prefetched in time (and sound effects aren't played)
+    VNScriptConversation* conversation = script.conversation;
+    if( conversation == nil || isSkipping == YES || [VNAssetCache sharedCache].enabled == NO )
+        return;
+    
+    NSInteger currentLine = (NSInteger)VNRuntimeCurrentIndex(runtime);
+    NSInteger firstLine = (conversation == prefetchConversation) ? MAX(currentLine, prefetchedThroughLine) : currentLine;
+    NSInteger lastLine = MIN(currentLine + VNSceneAssetLookahead, (NSInteger)conversation.count);
+    
+    prefetchConversation = conversation;
+    prefetchedThroughLine = MAX(firstLine, lastLine);
+    if( firstLine >= lastLine )
+        return;
+    
+    // Sprite aliases can be changed further ahead in the script, so the aliases are followed along the way. (This is
+    // only a guess, since the script might not actually go that way; if it's wrong, the sprite just gets loaded later.)
+    NSMutableDictionary* aliases = [[NSMutableDictionary alloc] initWithDictionary:self.localSpriteAliases];
+    
+    for( NSInteger line = firstLine; line < lastLine; line++ )
+        [self prefetchAssetsForCommand:[conversation recordAtIndex:line] inConversation:conversation aliases:aliases followJumps:YES];
+}
+
+- (void)prefetchAssetsForCommand:(const VNScriptCommandRecord*)command inConversation:(VNScriptConversation*)conversation
+                         aliases:(NSMutableDictionary*)aliases followJumps:(BOOL)followJumps
+{
+    if( command == NULL )
+        return;
+    
+    VNAssetCache* cache = [VNAssetCache sharedCache];
+    NSString* filename = nil;
+    
+    switch( command->type ) {
+            
+        case VNScriptCommandAddSprite: {
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
+            filename = [aliases objectForKey:spriteName];
+            [cache prefetchTextureNamed:(filename != nil) ? filename : spriteName];
+        }break;
+            
+        case VNScriptCommandSetSpriteAlias: {
+            NSString* aliasName = [conversation stringOperand:0 ofRecord:command];
+            filename = [conversation stringOperand:1 ofRecord:command];
+            if( aliasName == nil || filename == nil )
+                break;
+            
+            if( [filename caseInsensitiveCompare:VNScriptNilValue] == NSOrderedSame )
+                [aliases removeObjectForKey:aliasName];
+            else
+                [aliases setObject:filename forKey:aliasName];
+        }break;
+            
+        case VNScriptCommandSetBackground:
+        case VNScriptCommandSetSpeechbox:
+        case VNScriptCommandPlaySound:
+        case VNScriptCommandPlayMusic: {
+            filename = [conversation stringOperand:0 ofRecord:command];
+            if( filename == nil || [filename caseInsensitiveCompare:VNScriptNilValue] == NSOrderedSame )
+                break;
+            
+            if( command->type == VNScriptCommandPlaySound )
+                [cache prefetchSoundEffectNamed:filename];
+            else if( command->type == VNScriptCommandPlayMusic )
+                [cache prefetchMusicNamed:filename];
+            else
+                [cache prefetchTextureNamed:filename];
+        }break;
+            
+        case VNScriptCommandJumpOnChoice:
+        case VNScriptCommandModifyFlagOnChoice:
+            [cache prefetchTextureNamed:[viewSettings objectForKey:VNSceneViewButtonFilenameKey]];
+            break;
+    }
+    
+    // Commands can have other commands nested inside of them (like the one that .ISFLAG runs), and they can jump to
+    // other conversations (like the choices in .JUMPONCHOICE). Wherever a jump might go, the first few commands there
+    // get prefetched too, but jumps found there aren't followed any further.
+    for( int operand = 0; operand < command->operandCount; operand++ ) {
         
-        // Get the current line/command from the script
-        NSArray* currentCommand = [script currentCommand];
+        VNScriptOperandRole role = VNScriptCommandOperandRole(command->type, operand);
         
-        // Check if there is no valid data (this might also mean that there are no more commands at all)
-        if( currentCommand == nil ) {
-            // Print warning message and finish the scene
-            NSLog(@"[VNScene] NOTICE: Script has run out of commands. Switching to 'Scene Ended' mode...");
-            mode = VNSceneModeEnded;
-            return;
+        if( role == VNScriptOperandRoleCommand ) {
+            const VNScriptCommandRecord* nestedCommand = VNScriptImageOperandCommand([conversation image], command, operand);
+            [self prefetchAssetsForCommand:nestedCommand inConversation:conversation aliases:aliases followJumps:followJumps];
+            
+        } else if( role == VNScriptOperandRoleConversation && followJumps == YES ) {
+            
+            NSArray* names = nil;
+            NSString* name = nil;
+            if( command->kinds[operand] == VNScriptOperandStringList )
+                names = [conversation stringListOperand:operand ofRecord:command];
+            else if( command->kinds[operand] == VNScriptOperandString && (name = [conversation stringOperand:operand ofRecord:command]) != nil )
+                names = @[name];
+            
+            for( NSString* name in names ) {
+                
+                if( [script hasConversationNamed:name] == NO )
+                    continue;
+                
+                // Each of the conversations gets its own copy of the aliases, since only one of them will really happen
+                VNScriptConversation* destination = [script conversationNamed:name];
+                NSMutableDictionary* destinationAliases = [aliases mutableCopy];
+                NSInteger count = MIN(VNSceneAssetBranchLookahead, (NSInteger)destination.count);
+                
+                for( NSInteger line = 0; line < count; line++ )
+                    [self prefetchAssetsForCommand:[destination recordAtIndex:line] inConversation:destination aliases:destinationAliases followJumps:NO];
+            }
         }
-        
-        // Helpful output! This is just optional, but it's useful for development (especially for tracking
-        // bugs and crashes... hopefully most of those have been ironed out at this point!)
-        NSLog(@"[%ld] %@ - %@", (long)script.currentIndex, [currentCommand objectAtIndex:0], [currentCommand objectAtIndex:1]);
-        
-        [self processCommand:currentCommand];   // Handle whatever line was just taken from the script
-        script.indexesDone++;                   // Tell the script that it's handled yet another line
     }
 }
 
-// Returns the position for where the speaker label should be (since the size changes every time the text changes,
-// it has to be repositioned each time).
-- (CGPoint)updatedSpeakerPosition
+#pragma mark - Script Processing
+
+// The runtime's view of whichever conversation the script is currently on
+- (BOOL)describeCurrentConversation:(VNRuntimeConversation*)description
+{
+    VNScriptConversation* conversation = script.conversation;
+    if( conversation == nil )
+        return NO;
+    
+    description->image          = [conversation image];
+    description->commands       = [conversation recordAtIndex:0];
+    description->commandCount   = (uint32_t) conversation.count;
+    return YES;
+}
+
+// VNScene is the host for the runtime (the script comes from VNScript, and flags come from the scene's own flag table),
+// as well as its backend. Commands from the runtime always belong to the script's current conversation.
+static int VNSceneRuntimeEnterConversation(void* context, uint32_t index, VNRuntimeConversation* conversation)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    scene->readHistoryPage = VNReadHistoryNoPage;
+    scene->backlogSource = VNBacklogNoName;
+    return [scene->script changeConversationToIndex:index] && [scene describeCurrentConversation:conversation];
+}
+
+static int VNSceneRuntimeEnterConversationNamed(void* context, const char* name, size_t length, VNRuntimeConversation* conversation)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    NSString* conversationName = [[NSString alloc] initWithBytes:name length:length encoding:NSUTF8StringEncoding];
+    scene->readHistoryPage = VNReadHistoryNoPage;
+    scene->backlogSource = VNBacklogNoName;
+    return [scene->script changeConversationTo:conversationName] && [scene describeCurrentConversation:conversation];
+}
+
+static uint32_t VNSceneRuntimeConversationForOperand(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    return [scene->script.conversation conversationIndexForOperand:operand ofRecord:command];
+}
+
+static uint32_t VNSceneRuntimeConversationForListItem(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand, uint32_t item)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    return [scene->script.conversation conversationIndexForItem:item ofOperand:operand ofRecord:command];
+}
+
+// This replaces the scene's script with a script loaded from another .PLIST file
+static int VNSceneRuntimeSwitchScript(void* context, const char* scriptName, const char* conversationName, VNRuntimeConversation* conversation)
 {
-    if( speaker == nil || speechBox == nil )
-        return CGPointZero;
-    
-    CGFloat widthOfSpeechBox = speechBox.frame.size.width;
-    CGFloat heightOfSpeechBox = speechBox.frame.size.height;
-    CGPoint speakerNameOffsets = CGPointZero;
-    
-    // Load speaker offset values
-    NSNumber* speakerNameOffsetXValue = [viewSettings objectForKey:VNSceneViewSpeakerNameXOffsetKey];
-    NSNumber* speakerNameOffsetYValue = [viewSettings objectForKey:VNSceneViewSpeakerNameYOffsetKey];
-    if( speakerNameOffsetXValue ) speakerNameOffsets.x = (CGFloat) [speakerNameOffsetXValue doubleValue];
-    if( speakerNameOffsetYValue ) speakerNameOffsets.y = (CGFloat) [speakerNameOffsetYValue doubleValue];
+    VNScene* scene = (__bridge VNScene*)context;
+    NSString* nameOfScript = @(scriptName);
+    NSString* startingPoint = (conversationName != NULL) ? @(conversationName) : nil;
     
-    CGSize screenSize = self.view.frame.size;
-    CGSize boxSize = speechBox.frame.size;
-    CGSize workingArea = boxSize;
+    EKTraceInfo(EKTraceCategoryScript, "Switching to script named [%s] with starting point [%s]", [nameOfScript UTF8String], [startingPoint UTF8String]);
     
-    // Check if the speech box is actually wider than the screen's width
-    if( screenSize.width < boxSize.width ) {
-        workingArea.width = screenSize.width;
-    }
-    widthOfSpeechBox = workingArea.width;
+    VNScript* newScript = [[VNScript alloc] initFromFile:nameOfScript withConversation:startingPoint];
+    if( newScript == nil )
+        return 0;
     
-    // Find top-left corner of the speech box
-    CGPoint topLeftCornerOfSpeechBox = CGPointMake( 0.0 - (widthOfSpeechBox * 0.5), 0 + (heightOfSpeechBox * 0.5));
-    // Adjust slightly so that the label isn't jammed up against the upper-left corner; there should be a bit of margins
-    CGPoint adjustment = CGPointMake(widthOfSpeechBox * 0.02, heightOfSpeechBox * -0.05);
-    // Store adjustments
-    CGPoint cornerPlusAdjustments = EKPositionAddTwoPositions(topLeftCornerOfSpeechBox, adjustment);
-    // Add custom offsets
-    CGPoint adjustedPlusOffsets = EKPositionAddTwoPositions(cornerPlusAdjustments, speakerNameOffsets);
+    scene->script = newScript;
+    scene->readHistoryPage = VNReadHistoryNoPage;
+    scene->backlogSource = VNBacklogNoName;
+    EKTraceDebug(EKTraceCategoryScript, "Script object replaced.");
     
-    return adjustedPlusOffsets;
+    return [scene describeCurrentConversation:conversation];
 }
 
-// Since the speech label's size changes every time the text changes, this also has to be repositioned each time
-// a new line of dialogue is shown.
-- (CGPoint)updatedTextPosition
+static uint32_t VNSceneRuntimeFlagSlotForName(void* context, const char* name, size_t length)
 {
-    if( !speech || !speechBox )
-        return CGPointZero;
-    
-    CGFloat widthOfBox = speechBox.frame.size.width;
-    CGFloat heightOfBox = speechBox.frame.size.height;
-    
-    CGSize screenSize = self.view.frame.size;
-    CGSize boxSize = speechBox.frame.size;
-    CGSize workingArea = boxSize;
-    
-    // Check if the speechbox is wider than the screen/view, in which case whichever one is smaller will be used
-    if( screenSize.width < boxSize.width ) {
-        workingArea.width = screenSize.width;
-    }
-    widthOfBox = workingArea.width;
-    
-    //[viewSettings objectForKey:nil];
-    
-    //float verticalMargins = [[viewSettings objectForKey:VNSceneViewSpeechVerticalMarginsKey] floatValue];
-    float horizontalMargins = [[viewSettings objectForKey:VNSceneViewSpeechHorizontalMarginsKey] floatValue];
-    float speechXOffset = [[viewSettings objectForKey:VNSceneViewSpeechOffsetXKey] floatValue];
+    NSString* flagName = [[NSString alloc] initWithBytes:name length:length encoding:NSUTF8StringEncoding];
+    return (flagName != nil) ? [EKFlagTable slotForFlagNamed:flagName] : VNScriptImageNotFound;
+}
+
+// Flag names normally get resolved ahead of time by the script linker (the runtime looks up anything else by name)
+static uint32_t VNSceneRuntimeFlagSlotForOperand(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    return [scene->script.conversation flagSlotForOperand:operand ofRecord:command];
+}
+
+static int VNSceneRuntimeHasFlag(void* context, uint32_t slot)
+{
+    return [((__bridge VNScene*)context)->flags hasValueForSlot:slot];
+}
+
+static int64_t VNSceneRuntimeFlagValue(void* context, uint32_t slot)
+{
+    return [((__bridge VNScene*)context)->flags valueForSlot:slot];
+}
+
+static void VNSceneRuntimeSetFlag(void* context, uint32_t slot, int64_t value)
+{
+    [((__bridge VNScene*)context)->flags setValue:value forSlot:slot];
+}
+
+// .SETFLAG stores whatever kind of value is in the script (not just numbers) in the local flag table. Whenever the game
+// is saved, the contents of that table are copied over to EKRecord's own flags (and stored in device memory).
+static void VNSceneRuntimeSetFlagFromOperand(void* context, uint32_t slot, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    id flagValue = [scene->script.conversation objectOperand:operand ofRecord:command];
     
-    //NSLog(@"verticalMargins = %f, speechYOffset = %f", verticalMargins, speechYOffset);
+    EKTraceDebug(EKTraceCategoryScript, "Setting flag named [%s] to a value of [%s]", [[EKFlagTable flagNameForSlot:slot] UTF8String], [[flagValue description] UTF8String]);
     
-    // Find top-left corner of speechbox (child node will be centered right over the very corner)
-    CGPoint topLeftCornerOfBox = CGPointMake( 0.0 - (widthOfBox * 0.5), 0 + (heightOfBox * 0.5));
-    CGFloat textX = topLeftCornerOfBox.x + (widthOfBox * 0.04) + speechXOffset + horizontalMargins; // + speechXOffset + horizontalMargins;
-    CGFloat textY = topLeftCornerOfBox.y - (heightOfBox * 0.1) - speaker.frame.size.height;// - verticalMargins - speechYOffset;
+    [scene->flags setObject:flagValue forSlot:slot];
+}
 
-    return CGPointMake(textX, textY);
+static const VNScriptExpression* VNSceneRuntimeExpressionForOperand(void* context, const VNScriptImage* image, const VNScriptCommandRecord* command, int operand)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    return [scene->script.conversation expressionForOperand:operand ofRecord:command];
 }
 
-#pragma mark - Script Processing
+static uint32_t VNSceneRuntimeRandomNumber(void* context, uint32_t upperBound)
+{
+    return arc4random_uniform(upperBound);
+}
+
+static void VNSceneRuntimePresent(void* context, VNRuntime* runtime, const VNRuntimeOperation* operation)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    [scene processCommand:operation->command inConversation:scene->script.conversation];
+}
+
+// Helpful output! This is just optional, but it's useful for development (especially for tracking
+// bugs and crashes... hopefully most of those have been ironed out at this point!) It's a verbose trace
+// message, since it happens for every single command; turn it on with EKTraceSetLevel(EKTraceLevelVerbose).
+static void VNSceneRuntimeWillRunCommand(void* context, VNRuntime* runtime, const VNScriptCommandRecord* command, const VNScriptImage* image)
+{
+    VNScene* scene = (__bridge VNScene*)context;
+    EKTraceVerbose(EKTraceCategoryScript, "[%ld] %d - %s", (long)VNRuntimeCurrentIndex(runtime), command->type,
+                   [[[scene->script.conversation objectOperand:0 ofRecord:command] description] UTF8String]);
+}
+
+static const VNRuntimeHost VNSceneRuntimeHost = {
+    .enterConversation          = VNSceneRuntimeEnterConversation,
+    .enterConversationNamed     = VNSceneRuntimeEnterConversationNamed,
+    .conversationForOperand     = VNSceneRuntimeConversationForOperand,
+    .conversationForListItem    = VNSceneRuntimeConversationForListItem,
+    .switchScript               = VNSceneRuntimeSwitchScript,
+    .flagSlotForName            = VNSceneRuntimeFlagSlotForName,
+    .flagSlotForOperand         = VNSceneRuntimeFlagSlotForOperand,
+    .hasFlag                    = VNSceneRuntimeHasFlag,
+    .flagValue                  = VNSceneRuntimeFlagValue,
+    .setFlag                    = VNSceneRuntimeSetFlag,
+    .setFlagFromOperand         = VNSceneRuntimeSetFlagFromOperand,
+    .expressionForOperand       = VNSceneRuntimeExpressionForOperand,
+    .randomNumber               = VNSceneRuntimeRandomNumber,
+};
+
+static const VNRuntimeBackend VNSceneRuntimeBackend = {
+    .present            = VNSceneRuntimePresent,
+    .willRunCommand     = VNSceneRuntimeWillRunCommand,
+};
+
+// Creates the runtime, picking up from wherever the script is (the start of the script, or wherever a saved game left off)
+- (void)createRuntime
+{
+    VNRuntimeFree(runtime);
+    runtime = VNRuntimeCreate(&VNSceneRuntimeHost, (__bridge void*)self, &VNSceneRuntimeBackend, (__bridge void*)self);
+    readHistoryPage = VNReadHistoryNoPage;
+    backlogSource = VNBacklogNoName;
+    
+    // If there's no conversation, the runtime starts out "ended" and the scene finishes right away
+    VNRuntimeConversation conversation;
+    if( [self describeCurrentConversation:&conversation] )
+        VNRuntimeResume(runtime, &conversation, script.currentIndex, script.indexesDone);
+}
+
+// Shows a line of dialogue, either by fading it in, or by having it "typed" out (if typewriter text is enabled)
+- (void)displaySpeech:(NSString*)text
+{
+    if( TWModeEnabled == NO ) {
+        
+        // Speech opacity is set to zero, making it invisible. Remember, speech is supposed to "fade in"
+        // instead of instantly appearing, since an instant appearance can be visually jarring to players.
+        speech.alpha = 0.0;
+        [speech setText:text]; // Copy over the text (while the text label is "invisble")
+        [record setValue:text forKey:VNSceneSpeechToDisplayKey]; // Copy text to save-game record
+        
+        // Now have the text fade into full visibility.
+        SKAction* fadeIn = [SKAction fadeInWithDuration:[self effectDuration:speechTransitionSpeed]];
+        [speech runAction:fadeIn];
+        
+        // If the speech-box isn't visible (or at least not fully visible), then it should fade-in as well
+        if( speechBox.alpha < 0.9 ) {
+            
+            //CCActionFadeIn* fadeInSpeechBox = [CCActionFadeIn actionWithDuration:speechTransitionSpeed];
+            SKAction* fadeInSpeechBox = [SKAction fadeInWithDuration:[self effectDuration:speechTransitionSpeed]];
+            [speechBox runAction:fadeInSpeechBox];
+        }
+        
+        speech.anchorPoint = CGPointMake(0, 1.0);
+        speech.position = [self updatedTextPosition];
+    } else {
+        
+        // Reset counter
+        TWTimer                     = 0.0;
+        TWFullText                  = text;
+        TWCurrentText               = @"";
+        TWNumberOfCurrentCharacters = 0;
+        TWNumberOfTotalCharacters   = (int) [text length];
+        TWPreviousNumberOfCurrentChars = 0;
+        
+        [record setValue:text forKey:VNSceneSpeechToDisplayKey];
+        
+        speech.text = @" ";
+        speechBox.alpha = 1.0;
+        speech.anchorPoint = CGPointMake(0, 1.0);
+        speech.position = [self updatedTextPosition];
+        
+        TWInvisibleText.text = text;
+        TWInvisibleText.anchorPoint = CGPointMake(0, 1.0);
+        TWInvisibleText.position = [self updatedTextPosition];
+        TWInvisibleText.alpha = 0.0;
+    }
+}
 
 // This is the most important function; it breaks down the data stored in each line of the script and actually
-// does something useful with it.
-- (void)processCommand:(NSArray *)command
+// does something useful with it. Each command is a record from the conversation (see VNScriptImage.h); numbers are
+// read straight out of the record, and strings come from the conversation's string table. Operands are numbered
+// from zero, so operand 0 is the command's first parameter.
+//
+// Only the commands that show (or play) something end up here. VNRuntime handles flags, conditions, jumps and
+// switching scripts by itself, and it has already moved the script's index past this command (unless it's dialogue).
+- (void)processCommand:(const VNScriptCommandRecord*)command inConversation:(VNScriptConversation*)conversation
 {
-    if( command == nil || command.count < 1 )
+    if( command == NULL || conversation == nil )
         return;
     
     // Extract some data from the command
-    int type        = [[command objectAtIndex:0] intValue]; // Command type, always stored as 'int'
-    id parameter1   = [command objectAtIndex:1]; // Get the first parameter (which might be a string, number, etc)
-    
-    // Check if there's not enough parameters; all commands should have at least one.
-    if( parameter1 == nil ) {
-        NSLog(@"[VNScene] ERROR: No parameter detected; all commands must have at least 1 parameter!");
-        return;
-    }
+    int type = command->type;
+    const VNScriptImage* image = [conversation image]; // Used for reading numbers (and nested commands) from the record
     
     // Check if the command is really just "display a regular line of text"
     if( type == VNScriptCommandSayLine ) {
         
-        if( TWModeEnabled == NO ) {
-            
-            // Speech opacity is set to zero, making it invisible. Remember, speech is supposed to "fade in"
-            // instead of instantly appearing, since an instant appearance can be visually jarring to players.
-            speech.alpha = 0.0;
-            [speech setText:parameter1]; // Copy over the text (while the text label is "invisble")
-            [record setValue:parameter1 forKey:VNSceneSpeechToDisplayKey]; // Copy text to save-game record
-            
-            // Now have the text fade into full visibility.
-            SKAction* fadeIn = [SKAction fadeInWithDuration:speechTransitionSpeed];
-            [speech runAction:fadeIn];
+        NSString* parameter1 = [conversation stringOperand:0 ofRecord:command];
+        
+        // Keep track of which lines have been read. Skip mode passes over lines that were read before, but stops at new ones
+        // (unless it's been set to skip those too).
+        BOOL lineWasRead = [self markLineAsRead:VNRuntimeCurrentIndex(runtime)];
+        [self addLineToBacklog:VNRuntimeCurrentIndex(runtime)]; // Skipped lines go in the backlog too
+        if( isSkipping == YES ) {
             
-            // If the speech-box isn't visible (or at least not fully visible), then it should fade-in as well
-            if( speechBox.alpha < 0.9 ) {
-                
-                //CCActionFadeIn* fadeInSpeechBox = [CCActionFadeIn actionWithDuration:speechTransitionSpeed];
-                SKAction* fadeInSpeechBox = [SKAction fadeInWithDuration:speechTransitionSpeed];
-                [speechBox runAction:fadeInSpeechBox];
+            if( lineWasRead == YES || self.skipsUnreadLines == YES ) {
+                skippedSpeech = parameter1; // This gets shown at the end of the frame (see 'skipThroughScript')
+                [record setValue:parameter1 forKey:VNSceneSpeechToDisplayKey];
+                return;
             }
             
-            speech.anchorPoint = CGPointMake(0, 1.0);
-            speech.position = [self updatedTextPosition];
-        } else {
-            
-            NSString* parameter1String = [command objectAtIndex:1];
-            
-            // Reset counter
-            TWTimer                     = 0;
-            TWFullText                  = parameter1String;
-            TWCurrentText               = @"";
-            TWNumberOfCurrentCharacters = 0;
-            TWNumberOfTotalCharacters   = (int) [parameter1String length];
-            TWPreviousNumberOfCurrentChars = 0;
-            
-            [record setValue:parameter1String forKey:VNSceneSpeechToDisplayKey];
-            
-            speech.text = @" ";// parameter1AsString
-            speechBox.alpha = 1.0;
-            speech.anchorPoint = CGPointMake(0, 1.0);
-            speech.position = [self updatedTextPosition];
-            
-            TWInvisibleText.text = parameter1String;
-            TWInvisibleText.anchorPoint = CGPointMake(0, 1.0);
-            TWInvisibleText.position = [self updatedTextPosition];
-            TWInvisibleText.alpha = 0.0;
+            skippedSpeech = nil; // This line replaces whatever was skipped before it
+            [self stopSkipping];
         }
         
+        [self displaySpeech:parameter1];
+        [self pushRollbackSnapshot]; // Every line that's actually shown can be rewound to later
         return;
     }
 
-    // Advance the script's index to make sure that commands run one after the other. Otherwise, they will only run one at a time
-    // and the user would have to keep touching the screen each time in order for the next command to be run. Except for the
-    // "display a line of text" command, most of the commands are designed to run one after the other seamlessly.
-    script.currentIndex++;
-    
     // Now, figure out what type of command this is!
     switch( type ) {
             
@@ -1713,9 +2861,11 @@ VNScene* theCurrentScene = nil;
         // support texture atlases, so it can only load the WHOLE IMAGE as-is.
         case VNScriptCommandAddSprite: {
             
-            NSString* spriteName = parameter1;
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
             NSString* filenameOfSprite = [self filenameOfSpriteAlias:spriteName];
-            BOOL appearAtOnce = [[command objectAtIndex:2] boolValue]; // Should the sprite show up at once, or fade in (like text does)
+            BOOL appearAtOnce = VNScriptImageOperandBool(image, command, 1); // Should the sprite show up at once, or fade in (like text does)
+            if( isSkipping == YES )
+                appearAtOnce = YES; // There's no fading while skipping
             
             if( sprites == nil ) {
                 sprites = [[NSMutableDictionary alloc] initWithCapacity:1]; // Lazy-load the sprites dictionary if it doesn't already exist.
@@ -1728,7 +2878,7 @@ VNScene* theCurrentScene = nil;
             
             // Try to load the sprite from an image in the app bundle
             //CCSprite* createdSprite = [CCSprite spriteWithImageNamed:spriteName]; // Loads from file; sprite-sheets not supported
-            SKSpriteNode* createdSprite = [SKSpriteNode spriteNodeWithImageNamed:filenameOfSprite];
+            SKSpriteNode* createdSprite = [self spriteWithImageNamed:filenameOfSprite];
             if( createdSprite == nil ) {
                 NSLog(@"[VNScene] ERROR: Could not load sprite named: %@", filenameOfSprite);
                 return;
@@ -1742,6 +2892,7 @@ VNScene* theCurrentScene = nil;
             // shouldn't see any delay.
             createdSprite.position = EKPositionWithNormalizedCoordinates(0.5, 0.5); // Sprite positioned at screen center
             createdSprite.zPosition = VNSceneCharacterLayer;
+            VNSpriteTableAdd(spriteTable, [spriteName UTF8String], [filenameOfSprite UTF8String], createdSprite.position.x, createdSprite.position.y);
             //[self addChild:createdSprite z:VNSceneCharacterLayer];
             [self addChild:createdSprite];
             
@@ -1761,10 +2912,9 @@ VNScene* theCurrentScene = nil;
         // 25%, 50% or 75% of the screen width).
         case VNScriptCommandAlignSprite: {
             
-            NSString* spriteName = parameter1;
-            NSString* newAlignment = [command objectAtIndex:2]; // "left", "center", "right"
-            NSNumber* duration = [command objectAtIndex:3]; // Default duration is 0.5 seconds; this is stored as an NSNumber (double)
-            double durationAsDouble = [duration doubleValue]; // For when an actual scalar value has to be passed (instead of NSNumber)
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
+            NSString* newAlignment = [conversation stringOperand:1 ofRecord:command]; // "left", "center", "right"
+            double durationAsDouble = [self effectDuration:VNScriptImageOperandNumber(image, command, 2)]; // Default duration is 0.5 seconds
             float alignmentFactor = 0.5; // 0.50 is the center of the screen, 0.25 is left-aligned, and 0.75 is right-aligned
             
             // STEP ONE: Find the sprite if it exists. If it doesn't, then just stop the function.
@@ -1811,11 +2961,15 @@ VNScene* theCurrentScene = nil;
             if( durationAsDouble <= 0.0 ) {
                 
                 sprite.position = CGPointMake( updatedX, updatedY ); // Set new position
+                VNSpriteTableSetPosition(spriteTable, VNSpriteTableLookup(spriteTable, [spriteName UTF8String]), updatedX, updatedY);
                 return;
             }
             
             [self createSafeSave]; // Create safe-save before using a move effect on the sprite (safe-saves are always used before effects are run)
             
+            // The sprite table gets where the sprite will end up (the safe-save, which was just taken, still has where it started)
+            VNSpriteTableSetPosition(spriteTable, VNSpriteTableLookup(spriteTable, [spriteName UTF8String]), updatedX, updatedY);
+            
             // STEP THREE: Make preparations for the "move sprite" effect. Once the actual movement has been completed, then
             //            the action sequence will call 'clearEffectRunningFlag' to let VNScene know that the effect's done.
             //CCActionMoveTo* moveSprite              = [CCActionMoveTo actionWithDuration:durationAsDouble position:CGPointMake(updatedX, updatedY)];
@@ -1835,8 +2989,10 @@ VNScene* theCurrentScene = nil;
         // jarring for players) or it can gradually fade from sight.
         case VNScriptCommandRemoveSprite: {
             
-            NSString* spriteName = parameter1;
-            BOOL spriteVanishesImmediately = [[command objectAtIndex:2] boolValue];
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
+            BOOL spriteVanishesImmediately = VNScriptImageOperandBool(image, command, 1);
+            if( isSkipping == YES )
+                spriteVanishesImmediately = YES;
             
             // Check if the sprite even exists. If it doesn't, just stop the function
             SKSpriteNode* sprite = [sprites objectForKey:spriteName];
@@ -1846,6 +3002,7 @@ VNScene* theCurrentScene = nil;
             // Remove the sprite from the sprites array. If the game needs be saved soon right after this command
             // is called, then the now-removed sprite won't be included in the save data.
             [sprites removeObjectForKey:spriteName];
+            VNSpriteTableRemove(spriteTable, [spriteName UTF8String]);
             
             // Check if it should just vanish at once (this should probably be done offscreen because it looks weird
             // if it just happens while the player can still see the sprite).
@@ -1888,23 +3045,38 @@ VNScene* theCurrentScene = nil;
             if( background == nil )
                 return;
             
-            [self createSafeSave];
-            
-            NSNumber* moveByX = [command objectAtIndex:1]; // How far to move on X-plane
-            NSNumber* moveByY = [command objectAtIndex:2]; // How far to move on Y-plane
-            NSNumber* duration = [command objectAtIndex:3]; // How long this whole process takes (default is 0.5 seconds)
-            NSNumber* parallaxing = [command objectAtIndex:4]; // Parallax factor for sprites (in relation to background)
+            float moveByX = VNScriptImageOperandNumber(image, command, 0); // How far to move on X-plane
+            float moveByY = VNScriptImageOperandNumber(image, command, 1); // How far to move on Y-plane
+            double durationAsDouble = [self effectDuration:VNScriptImageOperandNumber(image, command, 2)]; // How long this whole process takes (default is 0.5 seconds)
+            double parallaxFactor = (float) VNScriptImageOperandNumber(image, command, 3); // Parallax factor for sprites (in relation to background)
             
-            // Convert to scalars
-            double durationAsDouble = [duration doubleValue];
-            double parallaxFactor = [parallaxing floatValue];
+            // With no duration (such as while skipping), the background and sprites just move into place at once
+            if( durationAsDouble <= 0.0 ) {
+                
+                background.position = CGPointMake( background.position.x + moveByX, background.position.y + moveByY );
+                [record setObject:@(background.position.x) forKey:VNSceneBackgroundXKey];
+                [record setObject:@(background.position.y) forKey:VNSceneBackgroundYKey];
+                
+                for( NSString* spriteName in [sprites allKeys] ) {
+                    SKSpriteNode* currentSprite = [sprites objectForKey:spriteName];
+                    if( currentSprite.parent ) {
+                        currentSprite.position = CGPointMake( currentSprite.position.x + (parallaxFactor * moveByX),
+                                                              currentSprite.position.y + (parallaxFactor * moveByY) );
+                        VNSpriteTableSetPosition(spriteTable, VNSpriteTableLookup(spriteTable, [spriteName UTF8String]),
+                                                 currentSprite.position.x, currentSprite.position.y);
+                    }
+                }
+                
+                return;
+            }
             
+            [self createSafeSave];
             [self setEffectRunningFlag];
             
             // Also update the background's position in the record, so that when the game is loaded from a saved game,
             // then the background will be where it should be (that is, where it will be once the CCAction has finished).
-            float finishedX = background.position.x + [moveByX floatValue];
-            float finishedY = background.position.y + [moveByY floatValue];
+            float finishedX = background.position.x + moveByX;
+            float finishedY = background.position.y + moveByY;
             [record setObject:@(finishedX) forKey:VNSceneBackgroundXKey];
             [record setObject:@(finishedY) forKey:VNSceneBackgroundYKey];
             
@@ -1917,11 +3089,14 @@ VNScene* theCurrentScene = nil;
                 if( currentSprite.parent ) {
                     
                     // Calculate the rate at which the sprite should move
-                    float spriteMovementX = parallaxFactor * [moveByX floatValue];
-                    float spriteMovementY = parallaxFactor * [moveByY floatValue];
+                    float spriteMovementX = parallaxFactor * moveByX;
+                    float spriteMovementY = parallaxFactor * moveByY;
                     
                     //CGPoint amountOfMovement = CGPointMake( spriteMovementX, spriteMovementY );
                     SKAction* movementAction = [SKAction moveBy:CGVectorMake(spriteMovementX, spriteMovementY) duration:durationAsDouble];
+                    VNSpriteState* state = VNSpriteTableLookup(spriteTable, [spriteName UTF8String]);
+                    if( state != NULL )
+                        VNSpriteTableSetPosition(spriteTable, state, state->x + spriteMovementX, state->y + spriteMovementY);
                     //CCActionMoveBy* movementAction = [CCActionMoveBy actionWithDuration:durationAsDouble position:amountOfMovement];
                     [currentSprite runAction:movementAction];
                 }
@@ -1930,7 +3105,7 @@ VNScene* theCurrentScene = nil;
             
             // Set up the movement sequence
             //CGPoint movementAmount              = CGPointMake( [moveByX floatValue], [moveByY floatValue] );
-            CGVector movementAmount             = CGVectorMake( moveByX.floatValue, moveByY.floatValue );
+            CGVector movementAmount             = CGVectorMake( moveByX, moveByY );
             SKAction* moveByAction              = [SKAction moveBy:movementAmount duration:durationAsDouble];
             SKAction* clearEffectFlag           = [SKAction performSelector:@selector(clearEffectRunningFlag) onTarget:self];
             SKAction* movementSequence          = [SKAction sequence:@[moveByAction, clearEffectFlag]];
@@ -1945,11 +3120,10 @@ VNScene* theCurrentScene = nil;
         // is really just a "wrapper" of sorts for the CCMoveBy action in Cocos2D.
         case VNScriptCommandEffectMoveSprite: {
             
-            NSString* spriteName = parameter1;
-            NSNumber* moveByX = [command objectAtIndex:2]; // How far to move on X-plane
-            NSNumber* moveByY = [command objectAtIndex:3]; // How far to move on Y-plane
-            NSNumber* duration = [command objectAtIndex:4]; // How long this whole process takes (default is 0.5 seconds)
-            double durationAsDouble = 0.0; // Default duration
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
+            float moveByX = VNScriptImageOperandNumber(image, command, 1); // How far to move on X-plane
+            float moveByY = VNScriptImageOperandNumber(image, command, 2); // How far to move on Y-plane
+            double durationAsDouble = [self effectDuration:VNScriptImageOperandNumber(image, command, 3)]; // How long this whole process takes (zero if there's no duration)
             
             // Find the sprite! If it exists, of course... if not, just stop the function
             SKSpriteNode* sprite = [sprites objectForKey:spriteName];
@@ -1959,16 +3133,17 @@ VNScene* theCurrentScene = nil;
             
             [self createSafeSave]; // Create safe-save since VNScene is about to perform an effect
             
-            if( duration ) {
-                durationAsDouble = [duration doubleValue]; // Overwrite default duration if a duration parameter is found
-            }
+            // The table gets where the sprite will be once it's done moving
+            VNSpriteState* state = VNSpriteTableLookup(spriteTable, [spriteName UTF8String]);
+            if( state != NULL )
+                VNSpriteTableSetPosition(spriteTable, state, state->x + moveByX, state->y + moveByY);
             
             // Check if this is meant to be done instantly. In that case, instantly move the sprite and stop the function
             if( durationAsDouble <= 0.0 ) {
                 
                 // Calculate updated sprite position (current position + moveBy values)
-                float updatedX = sprite.position.x + [moveByX floatValue];
-                float updatedY = sprite.position.y + [moveByY floatValue];
+                float updatedX = sprite.position.x + moveByX;
+                float updatedY = sprite.position.y + moveByY;
                 sprite.position = CGPointMake( updatedX, updatedY );
                 return; // Stop the function, since an "immediate movement" command doesn't need to go any further
             }
@@ -1976,7 +3151,7 @@ VNScene* theCurrentScene = nil;
             [self setEffectRunningFlag];
 
             // Set up movement action, and then have the "effect is running" flag get cleared at the end of the sequence
-            CGVector movementAmount             = CGVectorMake( [moveByX floatValue], [moveByY floatValue] );
+            CGVector movementAmount             = CGVectorMake( moveByX, moveByY );
             SKAction* moveByAction              = [SKAction moveBy:movementAmount duration:durationAsDouble];
             SKAction* clearEffectFlag           = [SKAction performSelector:@selector(clearEffectRunningFlag) onTarget:self];
             SKAction* movementSequence          = [SKAction sequence:@[moveByAction, clearEffectFlag]];
@@ -1991,9 +3166,9 @@ VNScene* theCurrentScene = nil;
         // While instant movement can look strange, there are some situations it can be useful.
         case VNScriptCommandSetSpritePosition: {
             
-            NSString* spriteName = parameter1;
-            float updatedX = [[command objectAtIndex:2] floatValue];
-            float updatedY = [[command objectAtIndex:3] floatValue];
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
+            float updatedX = VNScriptImageOperandNumber(image, command, 1);
+            float updatedY = VNScriptImageOperandNumber(image, command, 2);
             
             // Find the sprite. If it exists, then just change its coordinates. If it doesn't exist... then nothing happens.
             SKSpriteNode* sprite = [sprites objectForKey:spriteName];
@@ -2001,6 +3176,7 @@ VNScene* theCurrentScene = nil;
                 
                 // Instantly reposition sprite
                 sprite.position = CGPointMake( updatedX, updatedY );
+                VNSpriteTableSetPosition(spriteTable, VNSpriteTableLookup(spriteTable, [spriteName UTF8String]), updatedX, updatedY);
             }
             
         }break;
@@ -2008,7 +3184,7 @@ VNScene* theCurrentScene = nil;
         // Change the background image. If the name parameter is set to "nil" then this command just removes the background image.
         case VNScriptCommandSetBackground: {
             
-            NSString* backgroundName = parameter1;
+            NSString* backgroundName = [conversation stringOperand:0 ofRecord:command];
             
             // Get rid of the old background
             SKSpriteNode* background = (SKSpriteNode*) [self childNodeWithName:VNSceneTagBackground];
@@ -2023,7 +3199,7 @@ VNScene* theCurrentScene = nil;
             // data. Otherwise, VNSceneView will try to use the string as a file name.
             if( [backgroundName caseInsensitiveCompare:VNScriptNilValue] != NSOrderedSame ) {
                 
-                SKSpriteNode* updatedBackground = [SKSpriteNode spriteNodeWithImageNamed:backgroundName]; // Grab new background image
+                SKSpriteNode* updatedBackground = [self spriteWithImageNamed:backgroundName]; // Grab new background image
                 updatedBackground.position      = CGPointMake( self.frame.size.width * 0.5, self.frame.size.height * 0.5 );
                 updatedBackground.alpha         = [[viewSettings objectForKey:VNSceneViewDefaultBackgroundOpacityKey] floatValue];
                 updatedBackground.zPosition     = VNSceneBackgroundLayer;
@@ -2041,7 +3217,7 @@ VNScene* theCurrentScene = nil;
         // left of the actual dialogue text. The value of the speaker name can be set to "nil" to hide the label.
         case VNScriptCommandSetSpeaker: {
             
-            NSString* updatedSpeakerName = parameter1;
+            NSString* updatedSpeakerName = [conversation stringOperand:0 ofRecord:command];
             
             speaker.alpha = 0; // Make the label invisible so that it can fade in
             speaker.text = @" "; // Default value is to not have any speaker name in the label's text string
@@ -2061,41 +3237,21 @@ VNScene* theCurrentScene = nil;
                 
                 // Fade in the speaker name label
                 //CCActionFadeIn* fadeIn = [CCActionFadeIn actionWithDuration:speechTransitionSpeed];
-                SKAction* fadeIn = [SKAction fadeInWithDuration:speechTransitionSpeed];
+                SKAction* fadeIn = [SKAction fadeInWithDuration:[self effectDuration:speechTransitionSpeed]];
                 [speaker runAction:fadeIn];
             }
             
         }break;
             
-        // This changes which "conversation" (or array of dialogue) in the script is currently being run.
-        case VNScriptCommandChangeConversation: {
-            
-            NSString* updatedConversationName = parameter1;
-            
-            // Check if this conversation actually exists
-            NSArray* convo = [script.data objectForKey:updatedConversationName];
-            if( convo == nil ) {
-                NSLog(@"[VNScene] ERROR: No section titled %@ was found in script!", updatedConversationName);
-                return;
-            }
-            
-            // If the conversation actually exists, then just switch to it
-            [script changeConversationTo:updatedConversationName];
-            script.indexesDone--;
-            
-        }break;
-            
         // This command presents a choice menu to the player, and after the player chooses, then VNScene switches conversations.
         case VNScriptCommandJumpOnChoice: {
             
             [self createSafeSave]; // Always create a safe-save before doing something volatile
             
-            NSArray* choiceTexts = [command objectAtIndex:1]; // Get the strings to display for individual choices
-            NSArray* destinations = [command objectAtIndex:2]; // Get the names of the conversations to "jump" to
-            NSUInteger numberOfChoices = [choiceTexts count]; // Calculate number of choices
+            NSArray* choiceTexts = [conversation stringListOperand:0 ofRecord:command]; // Get the strings to display for individual choices
+            NSUInteger numberOfChoices = [choiceTexts count]; // Calculate number of choices (the runtime remembers where each one goes)
             
             buttons = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
-            choices = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
             
             // Come up with some position data
             float screenHeight = self.frame.size.height;
@@ -2104,7 +3260,7 @@ VNScene* theCurrentScene = nil;
             // This loop creates the buttons and loads them with information
             for( int i = 0; i < numberOfChoices; i++ ) {
                 
-                SKSpriteNode* button = [SKSpriteNode spriteNodeWithImageNamed:[viewSettings objectForKey:VNSceneViewButtonFilenameKey]];
+                SKSpriteNode* button = [self spriteWithImageNamed:[viewSettings objectForKey:VNSceneViewButtonFilenameKey]];
                 
                 // Calculate the amount of space (including space between buttons) that each button will take up, and then
                 // figure out where and how to position the buttons (factoring in margins / spaces between buttons). Generally,
@@ -2164,9 +3320,6 @@ VNScene* theCurrentScene = nil;
                     buttonLabel.fontColor = buttonTextColor;
                     //NSLog(@"button text color set to: %@", buttonLabel.color);
                 }
-                
-                // Add destionation/conversation data to the 'choices' array
-                [choices addObject:[destinations objectAtIndex:i]];
             }
             
             // Change VNScene's mode so that it knows to handle these choices
@@ -2178,8 +3331,8 @@ VNScene* theCurrentScene = nil;
         // Hiding it is useful in case you want the player to just enjoy the background art.
         case VNScriptCommandShowSpeechOrNot: {
             
-            BOOL showSpeechOrNot = [parameter1 boolValue];
-            [record setValue:parameter1 forKey:VNSceneShowSpeechKey];
+            BOOL showSpeechOrNot = VNScriptImageOperandBool(image, command, 0);
+            [record setValue:@(showSpeechOrNot) forKey:VNSceneShowSpeechKey];
             
             if( speechBox == nil ) {
                 NSLog(@"[VNScene] ERROR: No speech box found in VN module.");
@@ -2195,12 +3348,12 @@ VNScene* theCurrentScene = nil;
                 [speech removeAllActions];
                     
                 //CCActionFadeIn* fadeInSpeechBox = [CCActionFadeIn actionWithDuration:speechTransitionSpeed];
-                SKAction* fadeInSpeechBox = [SKAction fadeInWithDuration:speechTransitionSpeed];
+                SKAction* fadeInSpeechBox = [SKAction fadeInWithDuration:[self effectDuration:speechTransitionSpeed]];
                 [speechBox runAction:fadeInSpeechBox];
                 
                 if( speech ) {
                     //CCActionFadeIn* fadeInText = [CCActionFadeIn actionWithDuration:speechTransitionSpeed];
-                    SKAction* fadeInText = [SKAction fadeInWithDuration:speechTransitionSpeed];
+                    SKAction* fadeInText = [SKAction fadeInWithDuration:[self effectDuration:speechTransitionSpeed]];
                     [speech runAction:fadeInText];
                 }
                 
@@ -2211,13 +3364,13 @@ VNScene* theCurrentScene = nil;
                 [speechBox removeAllActions];
             
                 //CCActionFadeOut* fadeOutBox = [CCActionFadeOut actionWithDuration:speechTransitionSpeed];
-                SKAction* fadeOutBox = [SKAction fadeOutWithDuration:speechTransitionSpeed];
+                SKAction* fadeOutBox = [SKAction fadeOutWithDuration:[self effectDuration:speechTransitionSpeed]];
                 [speechBox runAction:fadeOutBox];
                 
                 if( speech )  {
                     [speech removeAllActions];
                     //CCActionFadeOut* fadeOutText = [CCActionFadeOut actionWithDuration:speechTransitionSpeed];
-                    SKAction* fadeOutText = [SKAction fadeOutWithDuration:speechTransitionSpeed];
+                    SKAction* fadeOutText = [SKAction fadeOutWithDuration:[self effectDuration:speechTransitionSpeed]];
                     [speech runAction:fadeOutText];
                 }
             }
@@ -2232,10 +3385,21 @@ VNScene* theCurrentScene = nil;
         // black image behind it or something.
         case VNScriptCommandEffectFadeIn: {
             
-            NSNumber* duration = parameter1;
+            double durationAsDouble = [self effectDuration:VNScriptImageOperandNumber(image, command, 0)];
+            
+            // With no duration, everything just becomes fully visible at once
+            if( durationAsDouble <= 0.0 ) {
+                
+                for( SKSpriteNode* tempSprite in [sprites allValues] )
+                    tempSprite.alpha = 1.0;
+                
+                [self childNodeWithName:VNSceneTagBackground].alpha = 1.0;
+                [viewSettings setValue:@1.0f forKey:VNSceneViewDefaultBackgroundOpacityKey];
+                return;
+            }
+            
             [self createSafeSave];
             [self setEffectRunningFlag];
-            double durationAsDouble = [duration doubleValue];
             
             // Check if there's any character sprites in existence. If there are, they all need to have a CCFadeIn action
             // applied to each and every one.
@@ -2277,10 +3441,21 @@ VNScene* theCurrentScene = nil;
         // fully opaque to fully transparent (or "fade out").
         case VNScriptCommandEffectFadeOut: {
             
-            NSNumber* duration = parameter1;
+            double durationAsDouble = [self effectDuration:VNScriptImageOperandNumber(image, command, 0)];
+            
+            // With no duration, everything just disappears at once
+            if( durationAsDouble <= 0.0 ) {
+                
+                for( SKSpriteNode* tempSprite in [sprites allValues] )
+                    tempSprite.alpha = 0.0;
+                
+                [self childNodeWithName:VNSceneTagBackground].alpha = 0.0;
+                [viewSettings setValue:@0.0f forKey:VNSceneViewDefaultBackgroundOpacityKey];
+                return;
+            }
+            
             [self createSafeSave];
             [self setEffectRunningFlag];
-            double durationAsDouble = [duration doubleValue];
             
             // Check if there are any sprites and cause them to become fully transparent over a period of time
             // (by default that "period of time" is about 0.5 seconds)
@@ -2315,10 +3490,13 @@ VNScene* theCurrentScene = nil;
         // but I've never gotten around to implementing it.
         case VNScriptCommandPlaySound: {
             
-            NSString* soundName = parameter1;
+            NSString* soundName = [conversation stringOperand:0 ofRecord:command];
         
-            //[[OALSimpleAudio sharedInstance] playEffect:soundName];
-            [self playSoundEffect:soundName];
+            // Sound effects are left out while skipping; otherwise, a whole scene's worth of them could go off at once
+            if( isSkipping == NO ) {
+                //[[OALSimpleAudio sharedInstance] playEffect:soundName];
+                [self playSoundEffect:soundName];
+            }
     
         }break;
             
@@ -2330,8 +3508,8 @@ VNScene* theCurrentScene = nil;
         // VNScene to stop all music.
         case VNScriptCommandPlayMusic: {
             
-            NSString* musicName = parameter1;
-            NSNumber* musicShouldLoop = [command objectAtIndex:2];
+            NSString* musicName = [conversation stringOperand:0 ofRecord:command];
+            BOOL musicShouldLoop = VNScriptImageOperandBool(image, command, 1);
             
             // Check if the value is 'nil', meaning that no music should be played
             if( [musicName caseInsensitiveCompare:VNScriptNilValue] == NSOrderedSame ) {
@@ -2346,7 +3524,7 @@ VNScene* theCurrentScene = nil;
             } else {
             
                 [record setValue:musicName forKey:VNSceneMusicToPlayKey]; // Store music data in dictionary
-                [record setValue:musicShouldLoop forKey:VNSceneMusicShouldLoopKey];
+                [record setValue:@(musicShouldLoop) forKey:VNSceneMusicShouldLoopKey];
                 
                 // Stop any old background music that might be playing
                 //if( [[OALSimpleAudio sharedInstance] bgPlaying] == true )
@@ -2355,156 +3533,11 @@ VNScene* theCurrentScene = nil;
                 
                 // Play the new background music
                 //[[OALSimpleAudio sharedInstance] playBg:musicName loop:willLoop];
-                [self playBGMusic:musicName willLoop:[musicShouldLoop boolValue]];
+                [self playBGMusic:musicName willLoop:musicShouldLoop];
             }
                         
         }break;
             
-        // This command sets a variable (or "flag"), which is usually an "int" value stored in an NSNumber object by a dictionary.
-        // VNScene stores a local dictionary, and whenever the game is saved, the contents of that dictionary are copied over to
-        // EKRecord's own flags dictionary (and stored in device memory).
-        case VNScriptCommandSetFlag: {
-            
-            NSString* flagName = parameter1;
-            id flagValue = [command objectAtIndex:2];
-            
-            NSLog(@"[VNScene] Setting flag named [%@] to a value of [%@]", flagName, flagValue);
-            
-            // Store the new value in the local dictionary
-            [flags setValue:flagValue forKey:flagName];
-            
-        }break;
-            
-        // This modifies an existing flag's integer value by a certain amount (you might have guessed: a positive value "adds",
-        // while a negative "subtracts). If no flag actually exists, then a new flag is created with whatever value was passed in.
-        case VNScriptCommandModifyFlagValue: {
-            
-            NSString* flagName = parameter1;
-            int modifyWithValue = [[command objectAtIndex:2] intValue];
-            
-            // Check if the flag even exists
-            id originalObject = [flags objectForKey:flagName];
-            if( originalObject == nil ) {
-                
-                // Store the "modifier" value as a brand-new flag in the flags dictionary and then quit the function
-                [flags setValue:@(modifyWithValue) forKey:flagName];
-                return;
-            }
-            
-            // Handle the modification operation
-            int originalValue = [originalObject intValue]; // Get original value
-            int modifiedValue = originalValue + modifyWithValue; // Create new version
-            NSNumber* updatedValue = @(modifiedValue);
-            
-            // Replace the old version with the new, modified version
-            [flags setValue:updatedValue forKey:flagName];
-            
-        }break;
-            
-        // This checks if a particular flag has a certain value. If it does, then it executes ANOTHER command (which starts
-        // at the third parameter and continues to whatever comes afterwards).
-        case VNScriptCommandIfFlagHasValue: {
-            
-            NSString* flagName = parameter1;
-            int expectedValue = [[command objectAtIndex:2] intValue];
-            NSArray* secondaryCommand = [command objectAtIndex:3]; // Secondary command, which runs if the actual and expected values are the same
-            
-            // Check if the variable even exists in the first place. If not, then this command just terminates.
-            id theFlag = [flags objectForKey:flagName];
-            if( theFlag == nil )
-                return;
-            
-            // Check if the actual value doesn't matches the expected value
-            int actualValue = [theFlag intValue];
-            if( actualValue != expectedValue )
-                return; // Terminate command if the value is different
-            
-            // If this point has been reached, then it's time to run the second command
-            [self processCommand:secondaryCommand];
-            
-            int secondaryCommandType = [[secondaryCommand objectAtIndex:0] intValue];
-            if( secondaryCommandType != VNScriptCommandChangeConversation ) {
-                script.currentIndex--; // This makes sure that things don't get knocked out of order by the "secondary command"
-            }
-            
-        }break;
-            
-        // This checks if a particular flag is GREATER THAN a certain value. If it does, then it executes ANOTHER command (which starts
-        // at the third parameter and continues to whatever comes afterwards).
-        case VNScriptCommandIsFlagMoreThan: {
-            
-            NSString* flagName = parameter1;
-            int expectedValue = [[command objectAtIndex:2] intValue];
-            NSArray* secondaryCommand = [command objectAtIndex:3];
-            
-            id theFlag = [flags objectForKey:flagName];
-            if( theFlag == nil )
-                return;
-            
-            int actualValue = [theFlag intValue];
-            if( actualValue <= expectedValue )
-                return;
-            
-            [self processCommand:secondaryCommand];
-            
-            int secondaryCommandType = [[secondaryCommand objectAtIndex:0] intValue];
-            if( secondaryCommandType != VNScriptCommandChangeConversation ) {
-                script.currentIndex--; // This makes sure that things don't get knocked out of order by the "secondary command"
-            }
-            
-        }break;
-            
-        // This checks if a particular flag LESS THAN certain value. If it does, then it executes ANOTHER command (which starts
-        // at the third parameter and continues to whatever comes afterwards).
-        case VNScriptCommandIsFlagLessThan: {
-            
-            NSString* flagName = parameter1;
-            int expectedValue = [[command objectAtIndex:2] intValue];
-            NSArray* secondaryCommand = [command objectAtIndex:3];
-            
-            id theFlag = [flags objectForKey:flagName];
-            if( theFlag == nil )
-                return;
-            
-            int actualValue = [theFlag intValue];
-            if( actualValue >= expectedValue )
-                return;
-            
-            [self processCommand:secondaryCommand];
-            
-            int secondaryCommandType = [[secondaryCommand objectAtIndex:0] intValue];
-            if( secondaryCommandType != VNScriptCommandChangeConversation ) {
-                script.currentIndex--;
-            }
-            
-        }break;
-            
-        // This checks if a particular flag is between two values (a lesser value and a greater value). If thie is the case,
-        // then a secondary command is run.
-        case VNScriptCommandIsFlagBetween: {
-            
-            NSString* flagName = parameter1;
-            int lesserValue = [[command objectAtIndex:2] intValue];
-            int greaterValue = [[command objectAtIndex:3] intValue];
-            NSArray* secondaryCommand = [command objectAtIndex:4];
-            
-            id theFlag = [flags objectForKey:flagName];
-            if( theFlag == nil )
-                return;
-            
-            int actualValue = [theFlag intValue];
-            if( actualValue <= lesserValue || actualValue >= greaterValue )
-                return;
-            
-            [self processCommand:secondaryCommand];
-            
-            int secondaryCommandType = [[secondaryCommand objectAtIndex:0] intValue];
-            if( secondaryCommandType != VNScriptCommandChangeConversation ) {
-                script.currentIndex--;
-            }
-            
-        }break;
-            
         // This command presents the user with a choice menu. When the user makes a choice, it results in the value of a flag
         // being modified by a certain amount (just like if the .MODIFYFLAG command had been used).
         case VNScriptCommandModifyFlagOnChoice: {
@@ -2512,14 +3545,10 @@ VNScene* theCurrentScene = nil;
             // Create "safe" autosave before doing something as volatile as presenting a choice menu
             [self createSafeSave];
             
-            NSArray* choiceTexts    = parameter1;
-            NSArray* variableNames  = [command objectAtIndex:2];
-            NSArray* variableValues = [command objectAtIndex:3];
+            NSArray* choiceTexts    = [conversation stringListOperand:0 ofRecord:command]; // (The runtime keeps track of which flags get modified)
             NSUInteger numberOfChoices     = [choiceTexts count];
             
             buttons         = [[NSMutableArray alloc] initWithCapacity:numberOfChoices]; // Holds CCSprite objects for individual menu buttons
-            choices         = [[NSMutableArray alloc] initWithCapacity:numberOfChoices]; // The names of variables to modify
-            choiceExtras    = [[NSMutableArray alloc] initWithCapacity:numberOfChoices]; // How much to modify the variables by
             
             //float screenHeight  = [CCDirector sharedDirector].viewSize.height;
             //float screenWidth   = [CCDirector sharedDirector].viewSize.width;
@@ -2532,7 +3561,7 @@ VNScene* theCurrentScene = nil;
                 
                 // Create a 'button' sprite using a filename stored in view settings
                 //CCSprite* button = [CCSprite spriteWithImageNamed:[viewSettings objectForKey:VNSceneViewButtonFilenameKey]];
-                SKSpriteNode* button = [SKSpriteNode spriteNodeWithImageNamed:[viewSettings objectForKey:VNSceneViewButtonFilenameKey]];
+                SKSpriteNode* button = [self spriteWithImageNamed:[viewSettings objectForKey:VNSceneViewButtonFilenameKey]];
                 
                 // Calculate the amount of space (including space between buttons) that each button will take up, and then
                 // figure out the position of the button that's being made. Ideally, the middle of the choice menu will also be the middle
@@ -2590,10 +3619,6 @@ VNScene* theCurrentScene = nil;
                     buttonLabel.fontColor = buttonTextColor;
                     //NSLog(@"Set button text color to: %@", buttonTextColor);
                 }
-                
-                // Set up choices
-                [choices addObject:[variableNames objectAtIndex:i]];
-                [choiceExtras addObject:[variableValues objectAtIndex:i]];
             }
             
             // Activate the new mode
@@ -2601,40 +3626,10 @@ VNScene* theCurrentScene = nil;
     
         }break;
             
-        // This command will cause VNScene to switch conversations if a certain flag holds a particular value.
-        case VNScriptCommandJumpOnFlag: {
-            
-            NSString* flagName = parameter1;
-            int expectedValue = [[command objectAtIndex:2] intValue];
-            NSString* targetedConversation = [command objectAtIndex:3];
-            
-            // Check if the variable even exists in the first place
-            id theFlag = [flags objectForKey:flagName];
-            if( theFlag == nil )
-                return;
-            
-            // Check if the actual value doesn't matches the expected value
-            int actualValue = [theFlag intValue];
-            if( actualValue != expectedValue )
-                return;
-            
-            // Check if this conversation actually exists
-            NSArray* convo = [script.data objectForKey:targetedConversation];
-            if( convo == nil ) {
-                NSLog(@"ERROR: No section titled %@ was found in script!", targetedConversation);
-                return;
-            }
-            
-            // If this point has been reached, then it's time to switch to the new 'conversation' in the script
-            [script changeConversationTo:targetedConversation];
-            script.indexesDone--;
-            
-        }break;
-            
         // This command is used in conjuction with the VNSystemCall class, and is used to create certain game-specific effects.
         case VNScriptCommandSystemCall: {
             
-            NSMutableArray* systemCallArray = [NSMutableArray arrayWithArray:command];
+            NSMutableArray* systemCallArray = [NSMutableArray arrayWithArray:[conversation arrayFromRecord:command]];
             [systemCallArray removeObjectAtIndex:0]; // Remove the ".systemcall" part of the command
             
             // Lazy-load the system call class if it doesn't already exist.
@@ -2653,7 +3648,7 @@ VNScene* theCurrentScene = nil;
         // since this command can't access instance variables directly.
         /*case VNScriptCommandCallCode: {
             
-            NSArray* callingArray = [command objectAtIndex:1];
+            NSArray* callingArray = [conversation stringListOperand:0 ofRecord:command];
             NSString* className = [callingArray objectAtIndex:0];
             NSString* staticFunctionString = [callingArray objectAtIndex:1];
             Class nameOfClass = NSClassFromString( className );
@@ -2689,30 +3684,14 @@ VNScene* theCurrentScene = nil;
             
         }break;*/
          
-        // This command replaces the scene's script with a script loaded from another .PLIST file. This is useful in case
-        // your script is actually broken up into multiple .PLIST files.
-        case VNScriptCommandSwitchScript:
-        {
-            NSString* scriptName = [command objectAtIndex:1];
-            NSString* startingPoint = [command objectAtIndex:2];
-            
-            NSLog(@"Switching to script named [%@] with starting point [%@]", scriptName, startingPoint);
-            
-            script = [[VNScript alloc] initFromFile:scriptName withConversation:startingPoint];
-            script.indexesDone--;
-            
-            NSLog(@"Script object replaced.");
-
-        }break;
-        
         case VNScriptCommandSetSpeechFont:
         {
-            speechFont = parameter1;
+            speechFont = [conversation stringOperand:0 ofRecord:command];
             
             // This will only change the font if the font name is of a "proper" length; no supported font on iOS
             // is shorter than 4 characters (as far as I know).
             if( speechFont.length > 3) {
-                speech.fontName = parameter1;
+                speech.fontName = speechFont;
                 
                 // Update record with override
                 [record setObject:speechFont forKey:VNSceneOverrideSpeechFontKey];
@@ -2722,7 +3701,7 @@ VNScene* theCurrentScene = nil;
             
         case VNScriptCommandSetSpeechFontSize:
         {
-            fontSizeForSpeech = [parameter1 floatValue];
+            fontSizeForSpeech = VNScriptImageOperandNumber(image, command, 0);
             
             // Check for a font size that's too small; if this is the case, then just switch to a "normal" font size
             if( fontSizeForSpeech < 1.0 )
@@ -2737,7 +3716,7 @@ VNScene* theCurrentScene = nil;
             
         case VNScriptCommandSetSpeakerFont:
         {
-            speakerFont = parameter1;
+            speakerFont = [conversation stringOperand:0 ofRecord:command];
             
             if( speakerFont.length > 3 ) {
                 speaker.fontName = speakerFont;
@@ -2752,7 +3731,7 @@ VNScene* theCurrentScene = nil;
             
         case VNScriptCommandSetSpeakerFontSize:
         {
-            fontSizeForSpeaker = [parameter1 floatValue];
+            fontSizeForSpeaker = VNScriptImageOperandNumber(image, command, 0);
             
             if( fontSizeForSpeaker < 1.0 )
                 fontSizeForSpeaker = 13.0;
@@ -2768,19 +3747,16 @@ VNScene* theCurrentScene = nil;
             
         case VNScriptCommandSetCinematicText:
         {
-            cinematicTextSpeed = [parameter1 doubleValue];
-            cinematicTextInputAllowed = [[command objectAtIndex:2] boolValue];
+            cinematicTextSpeed = VNScriptImageOperandNumber(image, command, 0);
+            cinematicTextInputAllowed = VNScriptImageOperandBool(image, command, 1);
             [self updateCinematicTextValues];
             
         }break;
             
         case VNScriptCommandSetTypewriterText:
         {
-            NSNumber* first = [command objectAtIndex:1];
-            NSNumber* second = [command objectAtIndex:2];
-            
-            TWSpeedInCharacters = [first intValue];
-            TWCanSkip = [second boolValue];
+            TWSpeedInCharacters = (int) VNScriptImageOperandInteger(image, command, 0);
+            TWCanSkip = VNScriptImageOperandBool(image, command, 1);
             
             //NSLog(@"set twspeedincharacters to %@", first);
             //NSLog(@"set twscanskip to %@", second);
@@ -2791,7 +3767,8 @@ VNScene* theCurrentScene = nil;
             
         case VNScriptCommandSetSpeechbox:
         {
-            double duration = [[command objectAtIndex:2] doubleValue];
+            NSString* speechboxFilename = [conversation stringOperand:0 ofRecord:command];
+            double duration = [self effectDuration:VNScriptImageOperandNumber(image, command, 1)];
             
             // prepare positioning data
             float boxToBottomMargin = 0;
@@ -2805,7 +3782,7 @@ VNScene* theCurrentScene = nil;
                 NSArray* originalChildren = [speechBox children];
                 [speechBox removeFromParent];
                 //speechBox = [CCSprite spriteWithImageNamed:parameter1];
-                speechBox = [SKSpriteNode spriteNodeWithImageNamed:parameter1];
+                speechBox = [self spriteWithImageNamed:speechboxFilename];
                 speechBox.position = CGPointMake( widthOfScreen * 0.5, (speechBox.frame.size.height * 0.5) + boxToBottomMargin );
                 speechBox.alpha = 1.0;
                 speechBox.zPosition = VNSceneUILayer;
@@ -2841,7 +3818,7 @@ VNScene* theCurrentScene = nil;
                 
                 // get rid of the original speechbox and replace it with a new and invisible speechbox
                 [speechBox removeFromParent];
-                speechBox = [SKSpriteNode spriteNodeWithImageNamed:parameter1];
+                speechBox = [self spriteWithImageNamed:speechboxFilename];
                 speechBox.position = CGPointMake( widthOfScreen * 0.5, (speechBox.frame.size.height * 0.5) + boxToBottomMargin );
                 speechBox.alpha = 0.0;
                 speechBox.zPosition = VNSceneUILayer;
@@ -2877,14 +3854,14 @@ VNScene* theCurrentScene = nil;
                 [speechBox runAction:delayedFadeInSequence];
             }
             
-            [record setValue:parameter1 forKey:VNSceneSavedOverriddenSpeechboxKey];
+            [record setValue:speechboxFilename forKey:VNSceneSavedOverriddenSpeechboxKey];
             
         }break;
             
         case VNScriptCommandSetSpriteAlias:
         {
-            NSString* aliasParameter = [command objectAtIndex:1];
-            NSString* filenameParameter = [command objectAtIndex:2];
+            NSString* aliasParameter = [conversation stringOperand:0 ofRecord:command];
+            NSString* filenameParameter = [conversation stringOperand:1 ofRecord:command];
             
             if( self.localSpriteAliases == nil ) {
                 self.localSpriteAliases = [[NSMutableDictionary alloc] init];
@@ -2900,10 +3877,8 @@ VNScene* theCurrentScene = nil;
             
         case VNScriptCommandFlipSprite:
         {
-            NSString* spriteName = parameter1;
-            NSNumber* duration = [command objectAtIndex:2];
-            NSNumber* flipBool = [command objectAtIndex:3];
-            double durationAsDouble = 0.0;
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
+            double durationAsDouble = [self effectDuration:VNScriptImageOperandNumber(image, command, 1)];
             BOOL flipHorizontal = YES;
             
             SKSpriteNode* sprite = [sprites objectForKey:spriteName];
@@ -2913,11 +3888,16 @@ VNScene* theCurrentScene = nil;
             
             [self createSafeSave];
             
-            if( duration ) {
-                durationAsDouble = duration.doubleValue;
+            if( command->operandCount > 2 ) {
+                flipHorizontal = VNScriptImageOperandBool(image, command, 2);
             }
-            if( flipBool ) {
-                flipHorizontal = flipBool.boolValue;
+            
+            VNSpriteState* state = VNSpriteTableLookup(spriteTable, [spriteName UTF8String]);
+            if( state != NULL ) {
+                if( flipHorizontal == YES )
+                    VNSpriteTableSetScale(spriteTable, state, state->scaleX * (-1), state->scaleY);
+                else
+                    VNSpriteTableSetScale(spriteTable, state, state->scaleX, state->scaleY * (-1));
             }
             
             // If this has a duration of zero, the action will take place instantly and then the function will return
@@ -2955,41 +3935,10 @@ VNScene* theCurrentScene = nil;
             
         }break;
             
-        case VNScriptCommandRollDice:
-        {
-            NSNumber* maximumNumber = [command objectAtIndex:1];
-            NSNumber* numberOfDice  = [command objectAtIndex:2];
-            NSString* flagName      = [command objectAtIndex:3];
-            
-            int flagModifier = 0;
-            
-            // retrieve the flag assuming it doesn't have the "nil value" name (".nil", which signifies no flag was actually passed in)
-            if( [flagName caseInsensitiveCompare:VNScriptNilValue] != NSOrderedSame) {
-                // check if the flag exists
-                id theFlag = [flags objectForKey:flagName];
-                if( theFlag != nil ) {
-                    // copy data to flag modifier
-                    flagModifier = [theFlag intValue];
-                }
-            } // end flag name check
-            
-            int resultOfRoll = EKRollDice(numberOfDice.intValue, maximumNumber.intValue, flagModifier);
-            
-            // Store results in DICEROLL flag
-            NSNumber* diceRollResult = [NSNumber numberWithInt:resultOfRoll];
-            [flags setValue:diceRollResult forKey:VNSceneDiceRollResultFlag];
-            
-            NSLog(@"[VNScene] Dice roll results of %@ stored in flag named: %@", diceRollResult, VNSceneDiceRollResultFlag);
-            
-        }break;
-            
         case VNScriptCommandModifyChoiceboxOffset:
         {
-            NSNumber* xOffset = [command objectAtIndex:1];
-            NSNumber* yOffset = [command objectAtIndex:2];
-            
-            choiceButtonOffsetX = (CGFloat) xOffset.doubleValue;
-            choiceButtonOffsetY = (CGFloat) yOffset.doubleValue;
+            choiceButtonOffsetX = (CGFloat) VNScriptImageOperandNumber(image, command, 0);
+            choiceButtonOffsetY = (CGFloat) VNScriptImageOperandNumber(image, command, 1);
             
             // save offset data to record
             [record setValue:@(choiceButtonOffsetX) forKey:VNSceneViewChoiceButtonOffsetX];
@@ -3003,40 +3952,37 @@ VNScene* theCurrentScene = nil;
             if( background == nil )
                 return;
             
-            NSNumber* scaleNumber = [command objectAtIndex:1];
-            NSNumber* durationNumber = [command objectAtIndex:2];
-            double theDuration = durationNumber.doubleValue;
+            double theScale = VNScriptImageOperandNumber(image, command, 0);
+            double theDuration = [self effectDuration:VNScriptImageOperandNumber(image, command, 1)];
             
             if( theDuration <= 0.0 ) {
                 //background.scale = scaleNumber.floatValue;
-                [background setScale:scaleNumber.doubleValue];
+                [background setScale:theScale];
             } else {
                 [self createSafeSave];
                 [self setEffectRunningFlag];
                 
-                SKAction* scaleAction = [SKAction scaleTo:scaleNumber.doubleValue duration:theDuration];
+                SKAction* scaleAction = [SKAction scaleTo:theScale duration:theDuration];
                 SKAction* callClearFlag = [SKAction performSelector:@selector(clearEffectRunningFlag) onTarget:self];
                 SKAction* sequence = [SKAction sequence:@[scaleAction, callClearFlag]];
                 
                 [background runAction:sequence];
             }
             
-            [record setValue:@(scaleNumber.doubleValue) forKey:VNSceneBackgroundScaleKey];
+            [record setValue:@(theScale) forKey:VNSceneBackgroundScaleKey];
             
         }break;
             
         case VNScriptCommandScaleSprite:
         {
-            NSString* spriteName = [command objectAtIndex:1];
-            NSNumber* scaleNumber = [command objectAtIndex:2];
-            NSNumber* durationNumber = [command objectAtIndex:3];
+            NSString* spriteName = [conversation stringOperand:0 ofRecord:command];
             
             SKSpriteNode* sprite = sprites[spriteName];
             if( sprite == nil )
                 return;
             
-            CGFloat theScale = scaleNumber.doubleValue;
-            CGFloat theDuration = durationNumber.doubleValue;
+            CGFloat theScale = VNScriptImageOperandNumber(image, command, 1);
+            CGFloat theDuration = [self effectDuration:VNScriptImageOperandNumber(image, command, 2)];
             
             CGFloat xScale = theScale;
             CGFloat yScale = theScale;
@@ -3052,9 +3998,11 @@ VNScene* theCurrentScene = nil;
             if( theDuration <= 0.0 ) {
                 sprite.xScale = xScale;
                 sprite.yScale = yScale;
+                VNSpriteTableSetScale(spriteTable, VNSpriteTableLookup(spriteTable, [spriteName UTF8String]), xScale, yScale);
             } else {
                 [self createSafeSave];
                 [self setEffectRunningFlag];
+                VNSpriteTableSetScale(spriteTable, VNSpriteTableLookup(spriteTable, [spriteName UTF8String]), xScale, yScale);
                 
                 SKAction* scaleAction = [SKAction scaleXTo:xScale y:yScale duration:theDuration];
                 SKAction* callClearFlag = [SKAction performSelector:@selector(clearEffectRunningFlag) onTarget:self];
@@ -3062,7 +4010,7 @@ VNScene* theCurrentScene = nil;
                 
                 [sprite runAction:sequence];
             }
-        }
+        }break;
             
         /** NEW COMMANDS ADDED HERE **/
             
@@ -3070,7 +4018,7 @@ VNScene* theCurrentScene = nil;
             
         default:
         {
-            NSLog(@"[VNScene] WARNING: Unknown command found in script. The command's NSArray is: %@", command);
+            NSLog(@"[VNScene] WARNING: Unknown command found in script. The command's NSArray is: %@", [conversation arrayFromRecord:command]);
         }break;
     }
 }
@@ -0,0 +1,38 @@
+//
+//  VNSceneSnapshot.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNSceneSnapshot
+
+ A frozen copy of the parts of a VNScene that get saved: the flags, the sprite aliases, and the scene's "record"
+ (script name/indexes, sprite data, UI data, and so on). VNScene takes one of these as its "safe-save" before doing
+ anything volatile, like running an effect or showing a choice menu, so that if the game is saved in the middle of it,
+ what gets saved is the state from just before.
+
+ Taking a snapshot doesn't copy any flags or dictionary entries. The flag table and the dictionaries are copy-on-write
+ (EKFlagTable does this itself, and Foundation does the same thing for copies of mutable collections), so a snapshot
+ just holds on to the same storage as the scene until the scene modifies something. Committing a snapshot to EKRecord
+ only copies the flags that changed.
+
+ */
+
+#import <Foundation/Foundation.h>
+#import "EKFlagTable.h"
+
+#pragma mark - VNSceneSnapshot
+
+@interface VNSceneSnapshot : NSObject
+
+@property (nonatomic, strong, readonly) EKFlagTable* flags;
+@property (nonatomic, strong, readonly) NSDictionary* spriteAliases;
+@property (nonatomic, strong, readonly) NSDictionary* record;
+
+// The objects passed in are copied, so changing them later on doesn't change the snapshot
++ (instancetype)snapshotWithFlags:(EKFlagTable*)flags spriteAliases:(NSDictionary*)spriteAliases record:(NSDictionary*)record;
+- (instancetype)initWithFlags:(EKFlagTable*)flags spriteAliases:(NSDictionary*)spriteAliases record:(NSDictionary*)record;
+
+@end
@@ -0,0 +1,37 @@
+//
+//  VNSceneSnapshot.m
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#import "VNSceneSnapshot.h"
+
+@implementation VNSceneSnapshot
+
+@synthesize flags = _flags;
+@synthesize spriteAliases = _spriteAliases;
+@synthesize record = _record;
+
++ (instancetype)snapshotWithFlags:(EKFlagTable*)flags spriteAliases:(NSDictionary*)spriteAliases record:(NSDictionary*)record
+{
+    return [[self alloc] initWithFlags:flags spriteAliases:spriteAliases record:record];
+}
+
+- (instancetype)initWithFlags:(EKFlagTable*)flags spriteAliases:(NSDictionary*)spriteAliases record:(NSDictionary*)record
+{
+    if( (self = [super init]) ) {
+
+        _flags = (flags != nil) ? [flags copy] : [[EKFlagTable alloc] init];
+        _spriteAliases = (spriteAliases != nil) ? [spriteAliases copy] : [NSDictionary dictionary];
+        _record = (record != nil) ? [record copy] : [NSDictionary dictionary];
+
+        if( _flags == nil ) {
+            NSLog(@"[VNSceneSnapshot] ERROR: Could not copy flag data.");
+            return nil;
+        }
+    }
+
+    return self;
+}
+
+@end
@@ -51,58 +51,14 @@
 #define VNScriptIndexesDoneKey                 @"indexes done"
 #define VNScriptCurrentIndexKey                @"current index"
 
-// The command types, in numeric format
-#define VNScriptCommandSayLine                  100
-#define VNScriptCommandAddSprite                101
-#define VNScriptCommandSetBackground            102
-#define VNScriptCommandSetSpeaker               103
-#define VNScriptCommandChangeConversation       104
-#define VNScriptCommandJumpOnChoice             105
-#define VNScriptCommandShowSpeechOrNot          106
-#define VNScriptCommandEffectFadeIn             107
-#define VNScriptCommandEffectFadeOut            108
-#define VNScriptCommandEffectMoveBackground     109
-#define VNScriptCommandEffectMoveSprite         110
-#define VNScriptCommandSetSpritePosition        111
-#define VNScriptCommandPlaySound                112
-#define VNScriptCommandPlayMusic                113
-#define VNScriptCommandSetFlag                  114
-#define VNScriptCommandModifyFlagValue          115 // Add or subtract
-#define VNScriptCommandIfFlagHasValue           116 // An "if" command, really
-#define VNScriptCommandModifyFlagOnChoice       117 // Choice changes variable
-#define VNScriptCommandAlignSprite              118
-#define VNScriptCommandRemoveSprite             119
-#define VNScriptCommandJumpOnFlag               120 // Change conversation if a certain flag holds a particular value
-#define VNScriptCommandSystemCall               121
-//#define VNScriptCommandCallCode                 122 // CALLCODE has been disabled because it was a bad idea
-#define VNScriptCommandIsFlagMoreThan           123
-#define VNScriptCommandIsFlagLessThan           124
-#define VNScriptCommandIsFlagBetween            125
-#define VNScriptCommandSwitchScript             126
-#define VNScriptCommandSetSpeechFont            127
-#define VNScriptCommandSetSpeechFontSize        128
-#define VNScriptCommandSetSpeakerFont           129
-#define VNScriptCommandSetSpeakerFontSize       130
-#define VNScriptCommandSetCinematicText         131
-#define VNScriptCommandSetTypewriterText        132
-#define VNScriptCommandSetSpeechbox             133
-#define VNScriptCommandSetSpriteAlias           134
-#define VNScriptCommandFlipSprite               135
-#define VNScriptCommandRollDice                 136
-#define VNScriptCommandModifyChoiceboxOffset    137
-#define VNScriptCommandScaleBackground          138
-#define VNScriptCommandScaleSprite              139
-#define VNScriptCommandAddToChoiceSet           140
-#define VNScriptCommandRemoveFromChoiceSet      141
-#define VNScriptCommandWipeChoiceSet            142
-#define VNScriptCommandShowChoiceSet            143
-#define VNScriptCommandIsFlagLessThanFlag       144
-#define VNScriptCommandIsFlagEqualToFlag        145
-#define VNScriptCommandIsFlagMoreThanFlag       146
-#define VNScriptCommandIncreaseFlagByFlag       147
-#define VNScriptCommandDecreaseFlagByFlag       148
-#define VNScriptCommandShowChoiceAndJump        149
-#define VNScriptCommandShowChoiceAndModify      150
+// The command types, in numeric format, are defined in VNScriptCommands.h (which can also be used from plain C code)
+#import "VNScriptCommands.h"
+
+// Translated commands are stored as fixed-size records (see VNScriptImage.h)
+#import "VNScriptImage.h"
+
+// The conditions used by .IF get compiled into small programs (see VNScriptExpression.h)
+#import "VNScriptExpression.h"
 
 // The command strings. Each one starts with a dot (the parser will only check treat a line as a command if it starts
 // with a dot), and is followed by some parameters, separated by colons.
@@ -156,11 +112,75 @@
 #define VNScriptStringDecreaseFlagByFlag        @".decreaseflagbyflag"  // Subtracts the second flag's value from the first flag
 #define VNScriptStringShowChoiceAndJump         @".showchoiceandjump"   // Shows a line of dialogue and then displays choice at the same time
 #define VNScriptStringShowChoiceAndModify       @".showchoiceandmodify" // Shows a line of dialogue and then displays choice (for modifying flag)
+#define VNScriptStringIf                        @".if"                  // Runs another command if an expression (like "gold >= 10 && trust > 3") is true
 
 // Script syntax
 #define VNScriptSeparationString               @":"
 #define VNScriptNilValue                       @"nil"
 
+// Precompiled scripts (see VNScriptImage.h). If a file with this extension exists in the app bundle with the same name
+// as the script, it gets loaded instead of the .plist file.
+#define VNScriptCompiledFileExtension          @"vnsb"
+
+// By default, conversations are only translated when the script actually switches to them. Translated conversations
+// are kept in a cache, and the least-recently-used ones get thrown out when the cache uses more memory than this.
+#define VNScriptDefaultConversationCacheBudget (2 * 1024 * 1024) // In bytes
+
+// Script files bigger than this get streamed (see 'prepareScriptFromFile') instead of being loaded into an NSDictionary
+#define VNScriptStreamingThreshold             (4 * 1024 * 1024) // In bytes
+
+// Scripts that get translated lazily are only checked one conversation at a time, as each conversation gets used. To
+// check the entire script as soon as it's loaded (which means translating every conversation right away, and defeats
+// the point of lazy translation), define VNSCRIPT_LINK_ON_LOAD as 1 in the build settings. Tools can just call 'link'.
+#ifndef VNSCRIPT_LINK_ON_LOAD
+    #define VNSCRIPT_LINK_ON_LOAD              0
+#endif
+
+#pragma mark - VNScriptConversation
+
+/*
+ 
+ VNScriptConversation
+ 
+ A translated conversation. Each line is stored as a VNScriptCommandRecord: the command type, with any numbers stored
+ directly in the record, and any text stored as an index into a string table. This is what VNScene actually runs, so
+ nothing has to be unboxed from NSNumber objects (or looked up with 'objectAtIndex') while the game is playing.
+ 
+ For everything else, VNScriptConversation still works like an NSArray: each item is created on demand, in the same
+ format that 'analyzedCommand' uses (an NSArray of NSNumber/NSString objects).
+ 
+ */
+
+@interface VNScriptConversation : NSArray
+
+// The script image that holds the records (and strings) for this conversation
+- (const VNScriptImage*)image;
+
+// Returns NULL if the index is out of bounds
+- (const VNScriptCommandRecord*)recordAtIndex:(NSUInteger)index;
+
+// Operands are numbered from zero, so operand 0 is the command's first parameter. Strings are only created once per
+// conversation; asking for the same string again returns the same object.
+- (NSString*)stringOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record;
+- (NSArray*)stringListOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record;
+- (id)objectOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record; // Same object that 'analyzedCommand' would have used
+
+// Creates the NSArray version of a record (the format used by 'analyzedCommand')
+- (NSArray*)arrayFromRecord:(const VNScriptCommandRecord*)record;
+
+// Conversation names and flag names get resolved by the script linker when the conversation is loaded. These return
+// the conversation's index in the script (see 'changeConversationToIndex') or the flag's slot number (see
+// 'slotForFlagNamed'), or VNScriptImageNotFound if the operand couldn't be resolved.
+- (uint32_t)conversationIndexForOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record;
+- (uint32_t)conversationIndexForItem:(uint32_t)item ofOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record; // For string lists
+- (uint32_t)flagSlotForOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record;
+
+// Conditions (like the one used by .IF) also get compiled by the linker. Returns NULL if the operand isn't a condition,
+// or if it couldn't be compiled (in which case the problem is listed in the script's 'linkErrors').
+- (const VNScriptExpression*)expressionForOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record;
+
+@end
+
 #pragma mark - VNScript
 
 @interface VNScript : NSObject
@@ -168,8 +188,8 @@
 #pragma mark - VNScript Properties
 
 // Script data
-@property (nonatomic, strong) NSDictionary* data; // Stores all the script data (dialogue, commands, etc)
-@property (nonatomic, strong) NSArray* conversation; // Array that holds conversation script
+@property (nonatomic, strong) NSDictionary* data; // Stores all the script data (dialogue, commands, etc); nil if the script is translated lazily
+@property (nonatomic, strong) VNScriptConversation* conversation; // Holds the current conversation
 
 // Conversation data
 @property (nonatomic, strong) NSString* filename; // Where was the script loaded from?
@@ -181,16 +201,37 @@
 @property NSInteger maxIndexes;
 @property BOOL isFinished;
 
+// Lazy translation. The budget is only an estimate of memory used, and the current conversation is never removed from
+// the cache (even if it happens to be bigger than the entire budget).
+@property (nonatomic) NSUInteger conversationCacheBudget;
+@property (nonatomic, readonly) NSUInteger conversationCacheSize; // Size (in bytes) of everything in the cache
+
+// Problems found by the script linker (such as jumps to conversations that don't exist), as human-readable strings.
+// Each one is also logged when it's found.
+@property (nonatomic, readonly) NSArray* linkErrors;
+
 #pragma mark - VNScript Methods
 
 // This gets the properties, which are the current "conversation"/section of the script, the script's filename,
 // as well as the indexes used to figure out exactly which lines need processing.
 - (NSDictionary*)info;
 
-// The default initialization function; just pass in the script's filename and everything should work.
+// The default initialization function; just pass in the script's filename and everything should work. Scripts share
+// their translated data with the VNScriptCache if the script is already there; otherwise the script is translated
+// lazily, and the cache loads it in the background, so creating several scripts from the same file doesn't translate
+// that file every time.
 - (id)initFromFile:(NSString*)nameOfFile;
 - (id)initFromFile:(NSString *)nameOfFile withConversation:(NSString*)conversationName;
 
+// Loads a script from the app bundle without going through the cache. This uses the compiled version of the script if
+// there is one; otherwise, big scripts get streamed and smaller ones get translated lazily. If 'shouldTranslateEverything'
+// is YES, nothing is left to be translated lazily (this is what the cache uses, since it shares the translated data).
+- (BOOL)loadScriptFromBundleNamed:(NSString*)nameOfFile translateEverything:(BOOL)shouldTranslateEverything;
++ (NSString*)pathForScriptNamed:(NSString*)nameOfFile; // The file that 'loadScriptFromBundleNamed' would load
+
+// Size (in bytes) of the script's translated data
+- (NSUInteger)translatedSize;
+
 // This version is used for loading the dictionary AND jumping to a particular part of the script.
 - (id)initWithInfo:(NSDictionary*)dictionary;
 
@@ -198,8 +239,35 @@
 // understood and used by the VN system.
 - (void)prepareScript:(NSDictionary*)dictionary;
 
+// Translates the whole script using several threads at once (pass in zero to use one thread per CPU core). The result
+// is identical to 'prepareScript'; this is mostly useful for tools that need to translate lots of scripts.
+- (void)prepareScript:(NSDictionary*)dictionary workerCount:(NSUInteger)workerCount;
+
+// Like 'prepareScript' except that nothing gets translated right away; each conversation gets translated the first
+// time that it's used. This is what 'initFromFile' does when the script isn't in the script cache yet.
+- (void)prepareScriptLazily:(NSDictionary*)dictionary;
+
+// Translates an entire script straight from an XML .plist file (see VNScriptStream.h), one line at a time, without
+// ever loading the file into an NSDictionary. The result is the same as 'prepareScript', but the peak memory use is
+// much lower. Scripts loaded into the VNScriptCache are always streamed (as are scripts bigger than
+// VNScriptStreamingThreshold that are loaded without the cache). Returns NO if the file couldn't be streamed (for example,
+// if it's a binary .plist), in which case nothing about the script changes.
+- (BOOL)prepareScriptFromFile:(NSString*)path;
+
+// Translates a single conversation (an array of strings from the .plist file)
+- (VNScriptConversation*)translatedConversation:(NSArray*)originalArray;
+
+// Use these instead of accessing 'data' directly, since they work for lazily-translated and compiled scripts as well
+- (VNScriptConversation*)conversationNamed:(NSString*)name;
+- (BOOL)hasConversationNamed:(NSString*)name;
+
 - (id)currentCommand;
 - (id)commandAtLine:(NSInteger)line;
+
+// Just like 'currentCommand' and 'commandAtLine' except that these return the command record itself (which belongs to
+// the current conversation) instead of creating an NSArray. They return NULL if there's no command.
+- (const VNScriptCommandRecord*)currentRecord;
+- (const VNScriptCommandRecord*)recordAtLine:(NSInteger)line;
 - (BOOL)changeConversationTo:(NSString*)newConversation;
 - (BOOL)lineShouldBeProcessed;
 - (void)advanceLine;
@@ -207,5 +275,35 @@
 - (id)analyzedCommand:(NSArray*)command; // This is where most of the processing work happens
 - (id)currentLine;
 
+#pragma mark - Linking
+
+// The script linker runs automatically whenever conversations are translated or loaded. It gives every conversation
+// an index (so that jumps don't need to look up conversations by name) and every flag a slot number, and reports any
+// conversation names that don't exist. This checks the ENTIRE script, translating any conversations that haven't been
+// translated yet, and returns the same list as 'linkErrors'. (See VNSCRIPT_LINK_ON_LOAD to do this whenever a script loads.)
+- (NSArray*)link;
+
+// Conversations are numbered in alphabetical order, starting from zero
+- (NSString*)nameOfConversationAtIndex:(uint32_t)index;
+- (BOOL)changeConversationToIndex:(uint32_t)index;
+
+// Flag slots are shared by every script (so the same flag has the same slot no matter which script uses it). A flag
+// gets a slot the first time that a script using it is linked, or the first time that this function is called. These
+// are the same slots that EKFlagTable uses, so a linked flag operand can be used to read a flag table directly.
++ (uint32_t)slotForFlagNamed:(NSString*)name;
++ (NSString*)flagNameForSlot:(uint32_t)slot;
++ (uint32_t)flagSlotCount;
+
+#pragma mark - Compiled scripts
+
+// Loads a precompiled script image (created by the functions below) by mapping it into memory. Conversations from
+// the image are decoded one line at a time, as they're needed, instead of being translated all at once.
+- (BOOL)loadCompiledScriptFromPath:(NSString*)path;
+
+// The "offline compiler." This turns the script's translated data into a binary script image, which can then be
+// shipped in the app bundle (as "filename.vnsb") in place of the original .plist file.
+- (NSData*)compiledScriptData;
++ (BOOL)compileScriptFile:(NSString*)plistPath toFile:(NSString*)compiledPath;
+
 
 @end
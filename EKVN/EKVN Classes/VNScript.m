@@ -6,1576 +6,3025 @@
 //
 
 #import "VNScript.h"
+#import "EKFlagTable.h"
+#import "VNScriptStream.h"
+#import "VNScriptCache.h"
+#import "VNStats.h"
+#import "EKTrace.h"
 
-@implementation VNScript
+#include <stdatomic.h>
 
-#pragma mark -
-#pragma mark Initialization
+#pragma mark - Compiled script helpers
 
-// Load the script from a Property List (.plist) file in the app bundle. Make sure to not include the ".plist" in the file name.
-// For example, if the script is stored as "ThisScript.plist" in the bundle, just pass in "ThisScript" as the parameter.
-- (id)initFromFile:(NSString *)nameOfFile withConversation:(NSString*)conversationName {
+// Keeps a script image open for as long as anything (the script, or one of its conversation arrays) still uses it.
+// References from the VNScriptCache are shared by every script that uses the same file (and can be used by the cache's
+// preload thread at the same time as the main thread), so the tables that get filled in lazily are all protected by
+// synchronizing on the reference itself.
+@interface VNScriptImageReference : NSObject
+{
+    VNScriptImage* image;
+    NSMutableArray* strings; // NSString objects for the string table, created as they're needed (NSNull if not created yet)
+    
+    // Filled in by the script linker. For each string in the string table, this is the index of the conversation with
+    // that name, and the slot number of the flag with that name (or VNScriptImageNotFound).
+    uint32_t* conversationLinks;
+    uint32_t* flagLinks;
+    
+    // Also filled in by the linker: the compiled version of each string that's used as a condition (or NULL)
+    VNScriptExpression** expressions;
+}
+
+- (id)initWithImage:(VNScriptImage*)openedImage;
+- (VNScriptImage*)image;
+- (NSString*)stringAtIndex:(uint32_t)index;
+
+- (uint32_t)conversationLinkForString:(uint32_t)index;
+- (uint32_t)flagLinkForString:(uint32_t)index;
+- (void)linkString:(uint32_t)index toConversation:(uint32_t)conversationIndex;
+- (void)linkString:(uint32_t)index toFlagSlot:(uint32_t)slot;
+- (const VNScriptExpression*)expressionForString:(uint32_t)index;
+- (void)linkString:(uint32_t)index toExpression:(VNScriptExpression*)expression; // The reference takes ownership of the expression
+
+@end
+
+@implementation VNScriptImageReference
+
+- (id)initWithImage:(VNScriptImage*)openedImage
+{
     if( self = [super init] ) {
-        // Load a dictionary from a .plist file in the app bundle
-        NSString* filepath              = [[NSBundle mainBundle] pathForResource:nameOfFile ofType:@"plist"];
-        NSDictionary* loadedDictionary  = [[NSDictionary alloc] initWithContentsOfFile:filepath]; // All data in the file
-        self.filename                   = [[NSString alloc] initWithString:nameOfFile]; // Save filename
-        
-        // Now actually load some of the data
-        [self prepareScript:loadedDictionary]; // Convert the script from text into binary data that's more easily read
-        [self changeConversationTo:conversationName]; // Automatically move to the 'start' array (and set "index" data)
-        
-        // Check if no valid data could be loaded from the file
-        if( self.data == nil ) {
-            NSLog(@"[VNScript] ERROR: VNScript could not translate script.");
-            return nil;
-        }
+        image = openedImage;
     }
     
     return self;
 }
 
-- (id)initFromFile:(NSString *)nameOfFile {
-    return [self initFromFile:nameOfFile withConversation:VNScriptStartingPoint];
+- (VNScriptImage*)image
+{
+    return image;
 }
 
-// Loads the script from a dictionary with a lot of other data (such as specific conversation names, indexes, etc).
-// This is used mostly for loading from saved games.
-- (id)initWithInfo:(NSDictionary*)dictionary {
-    if( dictionary == nil )
-        return nil;
-    
-    NSString* filenameValue     = [dictionary objectForKey:VNScriptFilenameKey]; // File to load script from
-    NSString* conversationValue = [dictionary objectForKey:VNScriptConversationNameKey]; // The conversation to start with
-    NSNumber* currentIndexValue = [dictionary objectForKey:VNScriptCurrentIndexKey]; // OPTIONAL: Which index to start processing on
-    NSNumber* indexesDoneValue  = [dictionary objectForKey:VNScriptIndexesDoneKey]; // OPTIONAL: Number of indexes processed already
-    
-    if( filenameValue == nil || conversationValue == nil )
+static NSString* VNScriptStringFromImage(const VNScriptImage* image, uint32_t index);
+
+// Returns a string from the image's string table. The NSString is only created the first time it's needed, so running
+// the same line over and over (or lots of lines with the same sprite name) doesn't keep allocating new strings.
+- (NSString*)stringAtIndex:(uint32_t)index
+{
+    if( index >= image->header->stringCount )
         return nil;
     
-    // Load (and translate) the script from a .plist file that has the same name as whatever 'filenameValue' has
-    id result = [self initFromFile:filenameValue];
-    
-    // Go to the right conversation
-    [self changeConversationTo:conversationValue];
+    @synchronized( self ) {
+        
+        if( strings == nil ) {
+            strings = [[NSMutableArray alloc] initWithCapacity:image->header->stringCount];
+            for( uint32_t i = 0; i < image->header->stringCount; i++ )
+                [strings addObject:[NSNull null]];
+        }
+        
+        id string = [strings objectAtIndex:index];
+        if( string == [NSNull null] ) {
+            
+            string = VNScriptStringFromImage(image, index);
+            if( string == nil )
+                return nil;
+            
+            [strings replaceObjectAtIndex:index withObject:string];
+        }
+        
+        return string;
+    }
+}
+
+// Creates a link table for every string in the image, with nothing linked yet
+static uint32_t* VNScriptCreateLinkTable(const VNScriptImage* image)
+{
+    size_t count = (size_t)image->header->stringCount + 1;
+    uint32_t* table = malloc(sizeof(uint32_t) * count);
     
-    // Copy the "indexes done" and "current index" values from the dictionary to the class's instance variables
-    if( currentIndexValue )
-        self.currentIndex = [currentIndexValue intValue];
-    if( indexesDoneValue )
-        self.indexesDone = [indexesDoneValue intValue];
+    if( table != NULL ) {
+        for( size_t i = 0; i < count; i++ )
+            table[i] = VNScriptImageNotFound;
+    }
     
-    return result;
+    return table;
 }
 
-/*
-  Scene data:
- 
-    (dictionary root)
-      1. "start" (array; holds dialogue, instructions, etc)
-      2. ...other arrays just like "start"
- 
- */
+- (uint32_t)conversationLinkForString:(uint32_t)index
+{
+    @synchronized( self ) {
+        if( conversationLinks == NULL || index >= image->header->stringCount )
+            return VNScriptImageNotFound;
+        
+        return conversationLinks[index];
+    }
+}
 
-// This processes the script, converting the data from its original Property List format into something
-// that can be used by VNLayer. (This new, converted format is stored in VNScript's "data" dictionary)
-- (void)prepareScript:(NSDictionary*)dictionary
+- (uint32_t)flagLinkForString:(uint32_t)index
 {
-    // NOTE: The Property List dictionary that holds all the script data has a "child" dictionary titled
-    //       "actual script." In an earlier version of the VN system, the Property List also had a section
-    //       titled "resources" (which held the names of sounds/images/etc to pre-load), plus some other
-    //       sections as well. However, as these other sections were never used, support for them has since
-    //       been removed from the VN engine. Now, the entire dictionary is treated as the "actual script"
-    //       section, and is composed of arrays that hold the "conversation" data.
+    @synchronized( self ) {
+        if( flagLinks == NULL || index >= image->header->stringCount )
+            return VNScriptImageNotFound;
+        
+        return flagLinks[index];
+    }
+}
+
+- (void)linkString:(uint32_t)index toConversation:(uint32_t)conversationIndex
+{
+    @synchronized( self ) {
+        if( conversationLinks == NULL )
+            conversationLinks = VNScriptCreateLinkTable(image);
+        
+        if( conversationLinks != NULL && index < image->header->stringCount )
+            conversationLinks[index] = conversationIndex;
+    }
+}
+
+- (void)linkString:(uint32_t)index toFlagSlot:(uint32_t)slot
+{
+    @synchronized( self ) {
+        if( flagLinks == NULL )
+            flagLinks = VNScriptCreateLinkTable(image);
+        
+        if( flagLinks != NULL && index < image->header->stringCount )
+            flagLinks[index] = slot;
+    }
+}
+
+// Compiled expressions are never replaced once a script has been shared, so the pointer that comes back stays valid
+- (const VNScriptExpression*)expressionForString:(uint32_t)index
+{
+    @synchronized( self ) {
+        if( expressions == NULL || index >= image->header->stringCount )
+            return NULL;
+        
+        return expressions[index];
+    }
+}
+
+- (void)linkString:(uint32_t)index toExpression:(VNScriptExpression*)expression
+{
+    @synchronized( self ) {
+        if( expressions == NULL )
+            expressions = calloc((size_t)image->header->stringCount + 1, sizeof(VNScriptExpression*));
+        
+        if( expressions == NULL || index >= image->header->stringCount ) {
+            VNScriptExpressionFree(expression);
+            return;
+        }
+        
+        VNScriptExpressionFree(expressions[index]);
+        expressions[index] = expression;
+    }
+}
+
+- (void)dealloc
+{
+    if( expressions != NULL ) {
+        for( uint32_t i = 0; i < image->header->stringCount; i++ )
+            VNScriptExpressionFree(expressions[i]);
+    }
     
-    // Here's a dictionary object that will hold all the text-to-binary-data translated conversations. It will
-    // hold the "finished product" when this function is done processing.
-    NSMutableDictionary* translatedScript = [[NSMutableDictionary alloc] initWithCapacity:[dictionary count]];
+    free(expressions);
+    free(conversationLinks);
+    free(flagLinks);
+    VNScriptImageClose(image);
+}
+
+@end
+
+// Converts one of the operands in a compiled command back into the object that VNScript would normally have created.
+static id VNScriptObjectFromOperand(const VNScriptImage* image, const VNScriptCommandRecord* record, int index);
+
+// Converts a command record from a compiled script back into the usual array format (the same format that 'analyzedCommand'
+// creates), so that the rest of the VN system doesn't need to know if a script was compiled or not.
+static NSArray* VNScriptArrayFromRecord(const VNScriptImage* image, const VNScriptCommandRecord* record)
+{
+    NSMutableArray* command = [[NSMutableArray alloc] initWithCapacity:record->operandCount + 1];
+    [command addObject:@(record->type)];
     
-    // Go through each NSArray (conversation) in the script and translate each conversation into something that's
-    // easier for the program to process. This "outer" for loop will get all the conversation names and the loops
-    // inside this one will translate each conversation.
-    for( NSString* conversationKey in [dictionary allKeys] ) {
+    for( int i = 0; i < record->operandCount && i < VNScriptImageMaxOperands; i++ ) {
         
-        // This retrieves the actual array data so that it can be processed. There's an "original array" that holds
-        // the raw text data (taken from the Property List) and then a "translated array" that holds the data that's
-        // been converted to processed data.
-        NSArray* originalArray = [dictionary objectForKey:conversationKey]; // Get original text array
+        id operand = VNScriptObjectFromOperand(image, record, i);
+        if( operand == nil ) {
+            NSLog(@"[VNScript] ERROR: Compiled command (type %d) has an invalid parameter.", record->type);
+            return nil;
+        }
         
-        // Make sure this is actually an NSArray object, and not some other kind of object that just happened to be in the dictionary
-        if( [originalArray isKindOfClass:[NSArray class]] ) {
+        [command addObject:operand];
+    }
+    
+    return command;
+}
 
-            NSMutableArray* translatedArray = [[NSMutableArray alloc] initWithCapacity:[originalArray count]];
-        
-            // Now go through each line in this particular "conversation" and convert it from raw text to processed data
-            for( NSString* line in originalArray ) {
+static NSString* VNScriptStringFromImage(const VNScriptImage* image, uint32_t index)
+{
+    uint32_t length = 0;
+    const char* string = VNScriptImageString(image, index, &length);
+    if( string == NULL )
+        return nil;
+    
+    return [[NSString alloc] initWithBytes:string length:length encoding:NSUTF8StringEncoding];
+}
+
+static id VNScriptObjectFromOperand(const VNScriptImage* image, const VNScriptCommandRecord* record, int index)
+{
+    VNScriptOperand operand = record->operands[index];
+    
+    switch( record->kinds[index] ) {
+            
+        case VNScriptOperandInteger:    return @(operand.integer);
+        case VNScriptOperandBool:       return @(operand.integer != 0 ? YES : NO);
+        case VNScriptOperandNumber:     return @(operand.number);
+        case VNScriptOperandString:     return VNScriptStringFromImage(image, operand.ref.index);
+            
+        case VNScriptOperandStringList: {
+            
+            if( operand.ref.index > image->header->listItemCount || operand.ref.count > image->header->listItemCount - operand.ref.index )
+                return nil;
+            
+            NSMutableArray* strings = [[NSMutableArray alloc] initWithCapacity:operand.ref.count];
+            for( uint32_t i = 0; i < operand.ref.count; i++ ) {
                 
-                // Break the string down into its individual components and translate it into something easy for the program to "read"
-                NSArray* commandFromLine = [line componentsSeparatedByString:VNScriptSeparationString];
-                NSArray* translatedLine = [self analyzedCommand:commandFromLine];
+                NSString* string = VNScriptStringFromImage(image, image->lists[operand.ref.index + i]);
+                if( string == nil )
+                    return nil;
                 
-                // Add the translated line to the correct, "finished product" array
-                if( translatedLine != nil ) {
-                    [translatedArray addObject:translatedLine];
-                }
+                [strings addObject:string];
             }
             
-            // Add this translated "conversation" to the script
-            [translatedScript setObject:translatedArray forKey:conversationKey];
+            return strings;
+        }
+            
+        case VNScriptOperandCommand: {
+            
+            if( operand.ref.index >= image->header->secondaryCount )
+                return nil;
+            
+            return VNScriptArrayFromRecord(image, &image->secondaryCommands[operand.ref.index]);
         }
     }
     
-    // At this point, the entire script should be translated, and can now be used in the actual game.
-    // The finished product gets stored by the class for use later (during the game).
-    self.data = [[NSDictionary alloc] initWithDictionary:translatedScript];
+    return nil;
 }
 
-#pragma mark - 
-#pragma mark Misc
+// Conversations keep a reference to their image, which can either be a memory-mapped compiled script (in which case
+// every conversation shares the same image) or a small image created when a single conversation gets translated.
+@interface VNScriptConversation ()
+{
+    VNScriptImageReference* reference;
+    uint32_t firstCommand;
+    uint32_t commandCount;
+}
 
-// Returns information ABOUT the script (but NOT the script itself). Conveniently, this same information can be
-// used to load a script using the 'initWithInfo' function.
-- (NSDictionary*)info
+- (id)initWithReference:(VNScriptImageReference*)imageReference entry:(const VNScriptConversationEntry*)entry;
+
+// Used by the script linker; any problems get added to 'errors'
+- (void)linkWithConversationIndexes:(NSDictionary*)conversationIndexes named:(NSString*)name errors:(NSMutableArray*)errors;
+
+@end
+
+@implementation VNScriptConversation
+
+- (id)initWithReference:(VNScriptImageReference*)imageReference entry:(const VNScriptConversationEntry*)entry
 {
-	// Store index data
-    NSNumber* indexesDoneValue = @(self.indexesDone);
-    NSNumber* currentIndexValue = @(self.currentIndex);
+    if( self = [super init] ) {
+        reference       = imageReference;
+        firstCommand    = entry->firstCommand;
+        commandCount    = entry->commandCount;
+    }
     
-    // Store all relevant data into another dictionary
-    NSDictionary* dictForScript = @{VNScriptIndexesDoneKey:        indexesDoneValue,
-                                    VNScriptCurrentIndexKey:       currentIndexValue,
-                                    VNScriptConversationNameKey:   self.conversationName,
-                                    VNScriptFilenameKey:           self.filename};
+    return self;
+}
+
+- (NSUInteger)count
+{
+    return commandCount;
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+    if( index >= commandCount ) {
+        [NSException raise:NSRangeException format:@"[VNScript] Index %lu is beyond the end of the conversation (%u commands)",
+                                                    (unsigned long)index, commandCount];
+    }
     
-    return dictForScript;
+    VNScriptImage* image = [reference image];
+    return VNScriptArrayFromRecord(image, &image->commands[firstCommand + index]);
 }
 
-// Changes from one conversation to another. The indexes are reset as part of the process.
-- (BOOL)changeConversationTo:(NSString *)newConversation
+- (const VNScriptImage*)image
 {
-    // Check if there's any data; if not, then there's no point to this function as there are no conversations!
-    if( self.data != nil ) {
+    return [reference image];
+}
+
+- (const VNScriptCommandRecord*)recordAtIndex:(NSUInteger)index
+{
+    if( index >= commandCount )
+        return NULL;
+    
+    return &[reference image]->commands[firstCommand + index];
+}
+
+- (NSString*)stringOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
+{
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return nil;
+    if( record->kinds[index] != VNScriptOperandString )
+        return [[self objectOperand:index ofRecord:record] description]; // Numbers get turned into text
+    
+    return [reference stringAtIndex:record->operands[index].ref.index];
+}
+
+- (NSArray*)stringListOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
+{
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return nil;
+    if( record->kinds[index] != VNScriptOperandStringList )
+        return nil;
+    
+    VNScriptImage* image = [reference image];
+    VNScriptOperand operand = record->operands[index];
+    if( operand.ref.index > image->header->listItemCount || operand.ref.count > image->header->listItemCount - operand.ref.index )
+        return nil;
+    
+    NSMutableArray* list = [[NSMutableArray alloc] initWithCapacity:operand.ref.count];
+    for( uint32_t i = 0; i < operand.ref.count; i++ ) {
         
-        // Try to point to a new array with dialogue data
-        self.conversation = [self.data objectForKey:newConversation];
+        NSString* string = [reference stringAtIndex:image->lists[operand.ref.index + i]];
+        if( string == nil )
+            return nil;
         
-        // Check if that worked at all
-        if( self.conversation ) {
-            
-            // Get rid of old data and replace it
-            self.conversationName   = [newConversation copy];
-            self.currentIndex       = 0;
-            self.indexesDone        = 0;
-            self.maxIndexes         = self.conversation.count;
-            
-            return YES;
-        }
+        [list addObject:string];
     }
     
-    return NO;
+    return list;
 }
 
-- (id)commandAtLine:(NSInteger)line
+- (id)objectOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
 {
-    // Check if conversation data is valid
-    if( self.conversation  ) {
-        
-        // Check to make sure there's no "out-of-bounds" array error
-        if( line < self.conversation.count ) {
-            return [self.conversation objectAtIndex:line];
-        }
-    }
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return nil;
     
-    return nil;
+    switch( record->kinds[index] ) {
+        case VNScriptOperandString:     return [reference stringAtIndex:record->operands[index].ref.index];
+        case VNScriptOperandStringList: return [self stringListOperand:index ofRecord:record];
+        default:                        return VNScriptObjectFromOperand([reference image], record, index);
+    }
 }
 
-// Returns the current "command" (string) in the current conversation
-- (id)currentCommand
+- (NSArray*)arrayFromRecord:(const VNScriptCommandRecord*)record
 {
-    if( self.indexesDone > self.currentIndex )
+    if( record == NULL )
         return nil;
     
-    return [self commandAtLine:self.indexesDone];
+    return VNScriptArrayFromRecord([reference image], record);
 }
 
-// Check if the current index still needs processing, or if it's already been processed
-- (BOOL)lineShouldBeProcessed
+#pragma mark Linking
+
+- (uint32_t)conversationIndexForOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
 {
-    if( self.indexesDone <= self.currentIndex )
-        return YES;
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return VNScriptImageNotFound;
+    if( record->kinds[index] != VNScriptOperandString )
+        return VNScriptImageNotFound;
     
-    return NO;
+    return [reference conversationLinkForString:record->operands[index].ref.index];
 }
 
-// Advance the number of indexes done by by one. Since this function only has one line, it's probably not necessary
-// to call it (or rather, you could just copy+paste its one line INSTEAD of calling it), but it might be useful in
-// case you need to advance the line in a selector (or as part of a Cocos2D action).
-- (void)advanceLine
+- (uint32_t)conversationIndexForItem:(uint32_t)item ofOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
 {
-    self.indexesDone = self.indexesDone + 1;
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return VNScriptImageNotFound;
+    if( record->kinds[index] != VNScriptOperandStringList || item >= record->operands[index].ref.count )
+        return VNScriptImageNotFound;
+    
+    VNScriptImage* image = [reference image];
+    uint32_t first = record->operands[index].ref.index;
+    if( first > image->header->listItemCount || item >= image->header->listItemCount - first )
+        return VNScriptImageNotFound;
+    
+    return [reference conversationLinkForString:image->lists[first + item]];
 }
 
-// Similar to 'advanceLine' except it advances the current index instead of the number of indexes that have been processed
-- (void)advanceIndex
+- (uint32_t)flagSlotForOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
 {
-    self.currentIndex++;
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return VNScriptImageNotFound;
+    if( record->kinds[index] != VNScriptOperandString )
+        return VNScriptImageNotFound;
+    
+    return [reference flagLinkForString:record->operands[index].ref.index];
 }
 
-- (id)currentLine
+- (const VNScriptExpression*)expressionForOperand:(int)index ofRecord:(const VNScriptCommandRecord*)record
 {
-    return [self commandAtLine:self.currentIndex];
+    if( record == NULL || index < 0 || index >= record->operandCount || index >= VNScriptImageMaxOperands )
+        return NULL;
+    if( record->kinds[index] != VNScriptOperandString )
+        return NULL;
+    
+    return [reference expressionForString:record->operands[index].ref.index];
 }
 
-#pragma mark - Script Translation
+// Used when compiling conditions; flag names in conditions get the same slots as every other flag name
+static uint32_t VNScriptResolveFlagName(void* context, const char* name, size_t length)
+{
+    NSString* flagName = [[NSString alloc] initWithBytes:name length:length encoding:NSUTF8StringEncoding];
+    return [VNScript slotForFlagNamed:flagName];
+}
 
-// Function definition
-//
-//  Name: NAME
-//
-//  DESCRIPTION
-//
-//  Parameters:
-//
-//      #1: PARAMETER1 (type)
-//
-//      #2: (OPTIONAL) Sprite appears at once? (Boolean value) (example: "NO") (default is NO)
-//          If set to YES, the sprite appears immediately (no fade-in). If set to NO, then the
-//          sprite "gradually" fades in (though the fade-in usually takes a second or less).
-//
-//  Example: EXAMPLE
-//
+- (void)linkWithConversationIndexes:(NSDictionary*)conversationIndexes named:(NSString*)name errors:(NSMutableArray*)errors
+{
+    for( uint32_t line = 0; line < commandCount; line++ )
+        [self linkRecord:[self recordAtIndex:line] line:line conversationIndexes:conversationIndexes named:name errors:errors];
+}
 
-- (id)analyzedCommand:(NSArray*)command
+// Finds every conversation name and flag name in a command (including any nested commands) and resolves them
+- (void)linkRecord:(const VNScriptCommandRecord*)record line:(uint32_t)line conversationIndexes:(NSDictionary*)conversationIndexes
+             named:(NSString*)name errors:(NSMutableArray*)errors
 {
-    NSArray* analyzedArray = nil;
-    NSNumber* type = nil;
+    VNScriptImage* image = [reference image];
     
-    unichar firstCharacter = [[command objectAtIndex:0] characterAtIndex:0];
-    
-    // Check if this is really just a line of dialogue being spoken by a character/narrator. Since "real"
-    // commands always have two or more items in the array, AND start with a "." character, this is
-    // the easiest way to check.
-    if( command.count < 2 || firstCharacter != '.' ) {
+    for( int i = 0; i < record->operandCount && i < VNScriptImageMaxOperands; i++ ) {
         
-        // Any time that a line of dialogue has colons, it will be treated as a command and split into
-        // different sections. However, it's possible that it really was just meant to be a regular
-        // line (and not a command), so it's sometimes necessary to take the different substrings and
-        // merge them back into one fixed string. This is kind of a cheap, hack-y way to do it, but
-        // it works.
-        NSMutableString* fixedString = [NSMutableString stringWithFormat:@"%@", [command objectAtIndex:0]];
-        if( firstCharacter != '.' && command.count > 1 ) {
+        VNScriptOperandRole role = VNScriptCommandOperandRole(record->type, i);
+        if( role == VNScriptOperandRoleNone )
+            continue;
+        
+        if( role == VNScriptOperandRoleCommand ) {
             
-            for( int part = 1; part < command.count; part++ ) {
-                
-                NSString* currentPart = [command objectAtIndex:part];
-                NSString* fixedSubString = [[NSString alloc] initWithFormat:@":%@", currentPart];
-                [fixedString appendString:fixedSubString];
-            }
+            const VNScriptCommandRecord* nestedCommand = VNScriptImageOperandCommand(image, record, i);
+            if( nestedCommand != NULL )
+                [self linkRecord:nestedCommand line:line conversationIndexes:conversationIndexes named:name errors:errors];
+            
+            continue;
         }
         
-        // Example: "Hi there"
-        type = @VNScriptCommandSayLine;
-        //analyzedArray = @[type, [command objectAtIndex:0]];
-        analyzedArray = @[type, fixedString];
-        return analyzedArray; // Return the data at once (instead of doing more processing)
-    }
-    
-    // Automatically prepare the action and parameter values. After all, pretty much every command has 
-    // an action string and a first parameter. It's only certain commands that have more parameters than that.
-    NSString* action = [command objectAtIndex:0];
-    NSString* parameter1 = [command objectAtIndex:1];
-    
-    // Now begins a long series of if-else comparisons to check if the first item in the array
-    // matches any of the predetermined "commands" that this rather simple scripting language knows.
-    if( [action caseInsensitiveCompare:VNScriptStringAddSprite] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ADDSPRITE
-        //
-        //  Uses Cocos2D to add a sprite to the screen. By default, the sprite usually appears right
-        //  at the center of the screen.
-        //
-        //  Parameters:
-        //
-        //      #1: Sprite name (string) (example: "girl.png")
-        //          Quite simply, the name of a file where the sprite is. Currently, the VN system doesn't
-        //          support sprite sheets, so it needs to be a single image in a single file.
-        //
-        //      #2: (OPTIONAL) Sprite appears at once? (Boolean value) (example: "NO") (default is NO)
-        //          If set to YES, the sprite appears immediately (no fade-in). If set to NO, then the
-        //          sprite "gradually" fades in (though the fade-in usually takes a second or less).
-        //
-        //  Example: .addsprite:girl.png:NO
-        //
-        
-        NSString* parameter2 = [NSString stringWithFormat:@"NO"]; // Set default value
-        
-        // If an existing command was already provided in the script, then overwrite the default one
-        // with the value found within the script.
-        if( command.count > 2 )
-            parameter2 = [command objectAtIndex:2];
-        
-        // Convert the second parameter to a Boolean value (stored as a Boolean NSNumber object)
-        BOOL appearAtOnce = [parameter2 boolValue];
-        NSNumber* appearParameter = @(appearAtOnce);
-        
-        type = @VNScriptCommandAddSprite;            
-        analyzedArray = @[type, parameter1, appearParameter];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringAlignSprite] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ALIGNSPRITE
-        //
-        //  Aligns a particular sprite in either the center, left, or right ends of the screen. This is done
-        //  by finding the center of the sprite and setting the X coordinate to either 25% of the screen's
-        //  width (on the iPhone 4S, this is 480*0.25 or 120), 50% (the middle), or 75% (the right).
-        //
-        //  There's also the Far Left (the left border of the screen), Far Right (the right border of the screen),
-        //  and Extreme Left and Extremem Right, which are so far that the sprite is drawn offscreen.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of sprite (string) (example: "girl.png")
-        //          This is the name of the sprite to manipulate/align. All sprites currently displayed by the
-        //          VN system are kept track of in the scene, so if the sprite exists onscreen, it'll be found.
-        //
-        //      #2: Alignment name (string) (example: "left") (default is "center")
-        //          Determines whether to move the sprite to the LEFT, CENTER, or RIGHT of the screen.
-        //          (Other, more unusual values also include FAR LEFT, FAR RIGHT, EXTREME LEFT, EXTREME RIGHT)
-        //          It has to be one of those values; partial/percentage values aren't supported.
-        //
-        //      #2: (OPTIONAL) Alignment duration in SECONDS (double value) (example: "0.5") (Default is 0.5)
-        //          Determines how long it takes for the sprite to move from its current position to the
-        //          new position. Setting it to zero makes the transition instant. Time is measured in seconds.
-        //
-        //  Example: .alignsprite:girl.png:center
-        //
-	
-		// Set default values
-        NSString* newAlignment = [NSString stringWithFormat:@"center"];
-        NSString* duration = [NSString stringWithFormat:@"0.5"];
-        
-        // Overwrite any default values with any values that have been explicitly written into the script
-        if( command.count >= 3 )
-            newAlignment = [command objectAtIndex:2]; // Parameter 2; should be either "left", "center", or "right"
-        if( command.count >= 4 )
-            duration = [command objectAtIndex:3]; // Optional, default value is 0.5
-            
-        type = @VNScriptCommandAlignSprite;
-        NSNumber* durationToUse = @([duration doubleValue]);
-        analyzedArray = @[type, parameter1, newAlignment, durationToUse];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringRemoveSprite] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .REMOVESPRITE
-        //
-        //  Removes a sprite from the screen, assuming that it's part of the VN system's dictionary of
-        //  existing sprite objects.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of sprite (string) (example: "girl.png")
-        //          This is the name of the sprite to manipulate/align. All sprites currently displayed by the
-        //          VN system are kept track of in the scene, so if the sprite exists onscreen, it'll be found.
-        //
-        //      #2: (OPTIONAL) Sprite appears at once (Boolean value) (example: "NO") (Default is NO)
-        //          Determines whether the sprite disappears from the screen instantly or fades out gradually.
-        //
-        //  Example: .removesprite:girl.png:NO
-        //
-        
-        NSString* parameter2 = [NSString stringWithFormat:@"NO"]; // Default value
-        
-        if( command.count > 2 )
-            parameter2 = [command objectAtIndex:2]; // Overwrite default value with user-defined one, if it exists
-        
-        // Convert to Boolean NSNumber object
-        BOOL vanishAtOnce = [parameter2 boolValue];
-        NSNumber* vanishParameter = @(vanishAtOnce);
-        
-        // Example: .removesprite:bob:NO
-        type = @VNScriptCommandRemoveSprite;
-        analyzedArray = @[type, parameter1, vanishParameter];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringEffectMoveSprite] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .MOVESPRITE
-        //
-        //  Uses Cocos2D actions to move a sprite by a certain number of points.
-        //
-        //  Parameters:
-        //
-        //   (note that all parameters after the first are TECHNICALLY optional, but if you use one,
-        //    you had better call the ones that come before it!)
-        //
-        //      #1: The name of the sprite to move (string) (example: "girl.png")
-        //
-        //      #2: Amount to move sprite by X points (float) (example: 128) (default is ZERO)
-        //
-        //      #3: Amount to move the sprite by Y points (float) (example: 256) (default is ZERO)
-        //
-        //      #4: Duration in seconds (float) (example: 0.5) (default is 0.5 seconds)
-        //          This measures how long it takes to move the sprite, in seconds.
-        //
-        //  Example: .movesprite:girl.png:128:-128:1.0
-        //
-        
-        // Set default values for extra parameters
-        NSString* xParameter = @"0";
-        NSString* yParameter = @"0";
-        NSString* durationParameter = @"0.5";
-        
-        // Overwrite default values with ones that exist in the script (assuming they exist, of course)
-        if( command.count > 2 ) xParameter = [command objectAtIndex:2];
-        if( command.count > 3 ) yParameter = [command objectAtIndex:3];
-        if( command.count > 4 ) durationParameter = [command objectAtIndex:4];
-        
-        // Convert parameters (which are NSStrings) to NSNumber values
-        NSNumber* moveByX = @([xParameter floatValue]);
-        NSNumber* moveByY = @([yParameter floatValue]);
-        NSNumber* duration = @([durationParameter doubleValue]);
-        
-        // syntax = command:sprite:xcoord:ycoord:duration
-        type = @VNScriptCommandEffectMoveSprite;
-        analyzedArray = @[type, parameter1, moveByX, moveByY, duration];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringEffectMoveBackground] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .MOVEBACKGROUND
-        //
-        //  Uses Cocos2D actions to move the background by a certain number of points. This is normally used to
-        //  pan the background (along the X-axis), but you can move the background up and down as well. Character
-        //  sprites can also be moved along with the background, though usually at a slightly different rate;
-        //  the rate is referred to as the "parallax factor." A parallax factor of 1.0 means that the character
-        //  sprites move just as quickly as the background does, while a factor 0.0 means that the character
-        //  sprites do not move at all.
-        //
-        //  Parameters:
-        //
-        //      #1: Amount to move sprite by X points (float) (example: 128) (default is ZERO)
-        //
-        //      #2: Amount to move the sprite by Y points (float) (OPTIONAL) (example: 256) (default is ZERO)
-        //
-        //      #3: Duration in seconds (float) (OPTIONAL) (example: 0.5) (default is 0.5 seconds)
-        //          This measures how long it takes to move the sprite, in seconds.
-        //
-        //      #4: Parallax factor (float) (OPTIONAL) (example: 0.5) (default is 0.95)
-        //          The rate at which sprites move compared to the background. 1.00 means that the
-        //          sprites move at exactly the same rate as the background, while 0.00 means that
-        //          the sprites do not move at all. You'll probably want to set it something in between.
-        //
-        //  Example: .movebackground:100:0:1.0
-        //
-        
-        // Set default values for extra parameters
-        NSString* xParameter = @"0";
-        NSString* yParameter = @"0";
-        NSString* durationParameter = @"0.5";
-        NSString* parallaxFactor = @"0.95";
-        
-        // Overwrite default values with ones that exist in the script (assuming they exist, of course)
-        if( command.count > 1 ) xParameter = [command objectAtIndex:1];
-        if( command.count > 2 ) yParameter = [command objectAtIndex:2];
-        if( command.count > 3 ) durationParameter = [command objectAtIndex:3];
-        if( command.count > 4 ) parallaxFactor = [command objectAtIndex:4];
-        
-        // Convert parameters (which are NSStrings) to NSNumber values
-        NSNumber* moveByX = @([xParameter floatValue]);
-        NSNumber* moveByY = @([yParameter floatValue]);
-        NSNumber* duration = @([durationParameter doubleValue]);
-        NSNumber* parallaxing = @([parallaxFactor floatValue]);
-        
-        // syntax = command:xcoord:ycoord:duration:parallaxing
-        type = @VNScriptCommandEffectMoveBackground;
-        analyzedArray = @[type, moveByX, moveByY, duration, parallaxing];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringSetSpritePosition] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPRITEPOSITION
-        //
-        //  NOTE that unlike .MOVESPRITE, this call is instantaneous. I don't remember why I made it that
-        //  way (probably since sprites usually don't move instantly in most visual novels), but it's probably
-        //  best to keep things simple like that anyways.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the sprite (string) (example: "girl.png")
-        //
-        //      #2: The sprite's X coordinate, in points (float) (example: 10)
-        //
-        //      #3: The sprite's Y coordinate, in points (float) (example: 10)
-        //
-        //  Example: .setspriteposition:girl.png:100:100
-        //
-        
-        NSString* xParameter = @"0";
-        NSString* yParameter = @"0";
-        
-        if( command.count > 2 ) xParameter = [command objectAtIndex:2];
-        if( command.count > 3 ) yParameter = [command objectAtIndex:3];
-        
-        NSNumber* coordinateX = @([xParameter floatValue]);
-        NSNumber* coordinateY = @([yParameter floatValue]);
-        
-        type = @VNScriptCommandSetSpritePosition;
-        analyzedArray = @[type, parameter1, coordinateX, coordinateY];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringSetBackground] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETBACKGROUND
-        //
-        //  Changes whatever image (if any) is used as the background. You can set this to 'nil' which removes
-        //  the background entirely, and shows whatever is behind. This is useful if you're overlaying the VN
-        //  scene over an existing Cocos2D layer/scene node.
-        //
-        //  Unlike some of the other image-switching commands, this one is supposed to do the change instantly.
-        //  It might be helpful to fade-out and then fade-in the scene during transistions so that the background
-        //  change isn't too jarring for the person playing the game.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the background image (string) (example: "beach.png")
-        //
-        //  Example: .setbackground:beach.png
-        
-        type = @VNScriptCommandSetBackground;
-        analyzedArray = @[type, parameter1];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringSetSpeaker] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPEAKER
-        //
-        //  The "speaker name" is the title of the person speaking. If you set this to "nil" then it
-        //  removes whatever the previous speaker name was.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the character speaking (string) (example: "Harry Potter")
-        //
-        //  Example: .setspeaker:John Smith
-        //
-        
-        type = @VNScriptCommandSetSpeaker;
-        analyzedArray = @[type, parameter1];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringChangeConversation] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETCONVERSATION
-        //
-        //  This jumps to a new conversation. The beginning conversation name is "start" and the other
-        //  arrays in the script's Property List represent other conversations.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the conversation/array to switch to (string) (example: "flirt sequence")
-        //
-        //  Example: .setconversation:flirt sequence
-        // 
-
-        type = @VNScriptCommandChangeConversation;
-        analyzedArray = @[type, parameter1];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringJumpOnChoice] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .JUMPONCHOICE
-        //
-        //  This presents the player with multiple choices. Each choice causes the scene to jump to a different
-        //  "conversation" (or rather, an array in the script dictionary). The function can have multipe parameters,
-        //  but the number should always be even-numbered.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the first action (shows up on button when player decides) (string) (example: "Run away")
-        //
-        //      #2: The name of the conversation to jump to (string) (example: "fleeing sequence")
-        //
-        //      ...these variables can be repeated multiple times.
-        //
-        //  Example: .JUMPONCHOICE:"Hug someone":hug sequence:"Glomp someone":glomp sequence
-        //
-        
-        // Figure out how many choices there are
-        NSInteger numberOfChoices = (command.count - 1) / 2;
-        
-        // Check if there's not enough data
-        if( numberOfChoices < 1 || command.count < 3 ) 
-            return nil;
-        
-        // Create some arrays; one will hold the text that appears to the player, while the other will hold
-        // the names of the conversations/arrays that the script will switch to depending on the player's choice.
-        NSMutableArray* choiceText = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
-        NSMutableArray* destinations = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
-        
-        // After determining the number of choices that exist, use a loop to match each choice text with the
-        // name of the conversation that each choice would correspond to. Then add both to the appropriate arrays.
-        for( int i = 0; i < numberOfChoices; i++ ) {
+        // Conditions get compiled, with every flag name in them turned into a flag slot. Identical conditions share
+        // the same string, so each one only gets compiled once no matter how many times it shows up.
+        if( role == VNScriptOperandRoleExpression ) {
             
-            // This variable will hold 1 and then every odd number after. It starts at one because index "zero"
-            // is where the actual .JUMPONCHOICE string is stored.
-            int indexOfChoice = 1 + (2 * i);
+            if( record->kinds[i] != VNScriptOperandString || [reference expressionForString:record->operands[i].ref.index] != NULL )
+                continue;
             
-            // Add choice data to the two separate arrays
-            [choiceText addObject:[command objectAtIndex:indexOfChoice]];
-            [destinations addObject:[command objectAtIndex:indexOfChoice+1]];
+            uint32_t length = 0;
+            const char* source = VNScriptImageString(image, record->operands[i].ref.index, &length);
+            char error[VNScriptExpressionErrorLength];
+            
+            VNScriptExpression* expression = VNScriptExpressionCompile(source, length, VNScriptResolveFlagName, NULL, error, sizeof(error));
+            if( expression == NULL ) {
+                [errors addObject:[NSString stringWithFormat:@"Command %u in conversation '%@' (%s) has a condition that couldn't be compiled: %s",
+                                   line + 1, name, VNScriptCommandNameForType(record->type), error]];
+                continue;
+            }
+            
+            [reference linkString:record->operands[i].ref.index toExpression:expression];
+            continue;
         }
         
-        type = @VNScriptCommandJumpOnChoice;
-        analyzedArray = @[type, choiceText, destinations];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringShowSpeechOrNot] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SHOWSPEECH
-        //
-        //  Determines whether or not to show the speech (and accompanying speech-box or speech-area). You
-        //  can set it to NO if you don't want any text to show up.
-        //
-        //  Parameters:
-        //
-        //      #1: Whether or not to show the speech box (Boolean)
-        //
-        //  Example: .SHOWSPEECH:NO
-        //
-        
-        // Convert parameter from NSString to a Boolean NSNumber
-        BOOL showParameter = [parameter1 boolValue];
-        NSNumber* parameterObject = @(showParameter);
-        
-        type = @VNScriptCommandShowSpeechOrNot;
-        analyzedArray = @[type, parameterObject];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringEffectFadeIn] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .FADEIN
-        //
-        //  Uses Cocos2D to fade-out the VN scene's backgrounds and sprites... and nothing else (UI
-        //  elements like speech text are unaffected).
-        //
-        //  Parameters:
-        //
-        //      #1: Duration of fade-in sequence, in seconds (double)
-        //
-        //  Example: .FADEIN:0.5
-        //
-        
-        // Convert from NSString to NSNumber
-        double fadeDuration = [parameter1 doubleValue]; // NSString gets converted to a 'double' by this
-        NSNumber* durationObject = @(fadeDuration);
-        
-        type = @VNScriptCommandEffectFadeIn;
-        analyzedArray = @[type, durationObject];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringEffectFadeOut] == NSOrderedSame) {
-        
-        // Function definition
-        //
-        //  Name: .FADEOUT
-        //
-        //  Uses Cocos2D to fade-out the VN scene's backgrounds and sprites... and nothing else (UI
-        //  elements like speech text are unaffected).
-        //
-        //  Parameters:
-        //
-        //      #1: Duration of fade-out sequence, in seconds (double)
-        //
-        //  Example: .FADEOUT:1.0
-        //
-
-        double fadeDuration = [parameter1 doubleValue];
-        NSNumber* durationObject = @(fadeDuration);
-        
-        type = @VNScriptCommandEffectFadeOut;
-        analyzedArray = @[type, durationObject];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringPlaySound] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .PLAYSOUND
-        //
-        //  Plays a sound (any type of sound file supported by Cocos2D/SimpleAudioEngine)
-        //
-        //  Parameters:
-        //
-        //      #1: name of sound file (string)
-        //
-        //  Example: .PLAYSOUND:effect1.caf
-        //
-        
-        type = @VNScriptCommandPlaySound;
-        analyzedArray = @[type, parameter1];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringPlayMusic] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .PLAYMUSIC
-        //
-        //  Plays background music. May or may not loop. You can also stop any background music
-        //  by calling this with the parameter set to "nil"
-        //
-        //  Parameters:
-        //
-        //      #1: name of music filename (string)
-        //          (you can write "nil" to stop all the music)
-        //
-        //      #2: (Optional) Should this loop forever? (BOOL value) (default is YES)
-        //
-        //  Example: .PLAYMUSIC:LevelUpper.mp3:NO
-        //
-        
-        NSString* parameter2 = @"YES"; // Loops forever by default
-        
-        // Check if there's already a user-specified value, in which case that would override the default value
-        if( command.count > 2 )
-            parameter2 = [command objectAtIndex:2];
-        
-        // Convert the second parameter to a Boolean NSNumber, since it was originally stored as a string
-        BOOL musicLoopsForever = [parameter2 boolValue];
-        NSNumber* loopParameter = @(musicLoopsForever);
-        
-        type = @VNScriptCommandPlayMusic;
-        analyzedArray = @[type, parameter1, loopParameter];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringSetFlag] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETFLAG
-        //
-        //  Used to manually set a "flag" value in the VN system.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of flag (string)
-        //
-        //      #2: The value to set the flag to (integer)
-        //
-        //  Example: .SETFLAG:number of friends:12
-        //
-        
-        NSString* parameter2 = @"0"; // Default value
-        
-        if( command.count > 2 ) 
-            parameter2 = [command objectAtIndex:2];
-        
-        // Convert the second parameter to an NSNumber (it was originally an NSString)
-        NSNumber* value = @([parameter2 intValue]);
-        
-        type = @VNScriptCommandSetFlag;
-        analyzedArray = @[type, parameter1, value];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringModifyFlagValue] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .MODIFYFLAG
-        //
-        //  Modifies a flag (which stores a numeric, integer value) by another integer. The catch is,
-        //  the modifying value has to be a "literal" number value, and not another flag/variable.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of the flag/variable to modify (string)
-        //
-        //      #2: The number to modify the flag by (integer)
-        //
-        //  Example: .MODIFYFLAG:number of friends:1
-        //
-        
-        NSString* parameter2 = @"0";
-        
-        if( command.count > 2 ) 
-            parameter2 = [command objectAtIndex:2];
- 
-        NSNumber* modifyWithValue = @([parameter2 intValue]); // Converts from string to Boolean NSNumber
- 
-        type = @VNScriptCommandModifyFlagValue;
-        analyzedArray = @[type, parameter1, modifyWithValue];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringIfFlagHasValue] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ISFLAG
-        //
-        //  Checks if a flag matches a certain value. If it does, then it immediately runs another command.
-        //  In theory, you could probably even nest .ISFLAG commands inside each other, but I've never tried
-        //  this before.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of flag (string)
-        //
-        //      #2: Expected value (integer)
-        //
-        //      #3: Another command
-        //
-        //  Example: .ISFLAG:number of friends:1:.SETSPEAKER:That One Friend You Have
-        //
-        
-        if( command.count < 4 )
-            return nil;
-        
-        NSString* variableName = [command objectAtIndex:1];
-        NSString* expectedValue = [command objectAtIndex:2];
-        NSInteger extraCount = command.count - 3; // This number = secondary command + secondary command's parameters
-        
-        if( variableName == nil || expectedValue == nil ) {
-            NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAG command");
-            return nil;
+        // The operand is either a single name, or a list of names (like the destinations in .JUMPONCHOICE)
+        const uint32_t* stringIndexes = NULL;
+        uint32_t stringCount = 0;
+        VNScriptOperand operand = record->operands[i];
+        
+        if( record->kinds[i] == VNScriptOperandString ) {
+            stringIndexes = &record->operands[i].ref.index;
+            stringCount = 1;
+        } else if( record->kinds[i] == VNScriptOperandStringList ) {
+            if( operand.ref.index > image->header->listItemCount || operand.ref.count > image->header->listItemCount - operand.ref.index )
+                continue;
+            stringIndexes = &image->lists[operand.ref.index];
+            stringCount = operand.ref.count;
         }
         
-        // Now, here comes the hard part... the 3rd "parameter" (and all that follows) is actually a separate
-        // command that will get executed IF the variable contains the expected value. At this point, it's necessary to
-        // translate that extra command so it can be more easily run when the actual script gets run for real.
-        NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
+        for( uint32_t j = 0; j < stringCount; j++ ) {
+            
+            NSString* target = [reference stringAtIndex:stringIndexes[j]];
+            if( target == nil )
+                continue;
+            
+            if( role == VNScriptOperandRoleConversation ) {
+                
+                NSNumber* conversationIndex = [conversationIndexes objectForKey:target];
+                if( conversationIndex == nil ) {
+                    [errors addObject:[NSString stringWithFormat:@"Command %u in conversation '%@' (%s) refers to a conversation named '%@', which doesn't exist.",
+                                       line + 1, name, VNScriptCommandNameForType(record->type), target]];
+                    continue;
+                }
+                
+                [reference linkString:stringIndexes[j] toConversation:[conversationIndex unsignedIntValue]];
+                
+            } else if( [target caseInsensitiveCompare:VNScriptNilValue] != NSOrderedSame ) { // .ROLLDICE uses "nil" to mean "no flag"
+                
+                [reference linkString:stringIndexes[j] toFlagSlot:[VNScript slotForFlagNamed:target]];
+            }
+        }
+    }
+}
+
+@end
+
+// Converts a translated command (as created by 'analyzedCommand') into a fixed-width record for a script image.
+// Nested commands and lists of strings get stored in their own sections of the image.
+static BOOL VNScriptRecordFromArray(VNScriptImageBuilder* builder, NSArray* command, VNScriptCommandRecord* record)
+{
+    memset(record, 0, sizeof(VNScriptCommandRecord));
+    
+    if( command.count < 1 || command.count - 1 > VNScriptImageMaxOperands )
+        return NO;
+    
+    record->type = [[command objectAtIndex:0] unsignedShortValue];
+    record->operandCount = (uint8_t)(command.count - 1);
+    
+    for( NSUInteger i = 1; i < command.count; i++ ) {
         
-        // This loop starts at the command index where the "secondary command" is and then goes through each
-        // parameter of the second command.
-        for( int i = 3; i < command.count; i++ ) {
+        id item = [command objectAtIndex:i];
+        NSUInteger index = i - 1;
         
-            // Extract the secondary/"extra" command and put it in its own array
-            NSString* partOfCommand = [command objectAtIndex:i]; // 3rd parameter and everything afterwards
-            [extraCommand addObject:partOfCommand]; // Add that new data to the "extra command" array
+        if( [item isKindOfClass:[NSString class]] ) {
+            
+            NSData* utf8 = [item dataUsingEncoding:NSUTF8StringEncoding];
+            record->kinds[index] = VNScriptOperandString;
+            record->operands[index].ref.index = VNScriptImageBuilderInternString(builder, utf8.bytes, utf8.length);
+            
+        } else if( [item isKindOfClass:[NSNumber class]] ) {
+            
+            // Figure out what kind of number this is, so that it can be turned back into the same kind of NSNumber later
+            const char* numberType = [item objCType];
+            if( strcmp(numberType, @encode(BOOL)) == 0 || strcmp(numberType, @encode(bool)) == 0 ) {
+                record->kinds[index] = VNScriptOperandBool;
+                record->operands[index].integer = [item boolValue] ? 1 : 0;
+            } else if( strcmp(numberType, @encode(float)) == 0 || strcmp(numberType, @encode(double)) == 0 ) {
+                record->kinds[index] = VNScriptOperandNumber;
+                record->operands[index].number = [item doubleValue];
+            } else {
+                record->kinds[index] = VNScriptOperandInteger;
+                record->operands[index].integer = [item longLongValue];
+            }
+            
+        } else if( [item isKindOfClass:[NSArray class]] ) {
+            
+            NSArray* array = item;
+            
+            // Arrays that start with a number are secondary commands (like the command that .ISFLAG runs). Any other
+            // kind of array is a list of strings (such as the text for each choice in .JUMPONCHOICE).
+            if( array.count > 0 && [[array objectAtIndex:0] isKindOfClass:[NSNumber class]] ) {
+                
+                VNScriptCommandRecord secondaryRecord;
+                if( VNScriptRecordFromArray(builder, array, &secondaryRecord) == NO )
+                    return NO;
+                
+                record->kinds[index] = VNScriptOperandCommand;
+                record->operands[index].ref.index = VNScriptImageBuilderAddSecondaryCommand(builder, &secondaryRecord);
+                record->operands[index].ref.count = 1;
+                
+            } else {
+                
+                uint32_t* strings = malloc(sizeof(uint32_t) * (array.count + 1));
+                for( NSUInteger j = 0; j < array.count; j++ ) {
+                    NSData* utf8 = [[[array objectAtIndex:j] description] dataUsingEncoding:NSUTF8StringEncoding];
+                    strings[j] = VNScriptImageBuilderInternString(builder, utf8.bytes, utf8.length);
+                }
+                
+                record->kinds[index] = VNScriptOperandStringList;
+                record->operands[index].ref.index = VNScriptImageBuilderAddStringList(builder, strings, (uint32_t)array.count);
+                record->operands[index].ref.count = (uint32_t)array.count;
+                free(strings);
+            }
+            
+        } else {
+            return NO;
         }
         
-        // Try to make sense of that secondary command... if it doesn't work out, then just give up on translating this line
-        NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
-        if( secondaryCommand == nil ) {
-            NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAG");
-            return nil;
+        if( record->kinds[index] != VNScriptOperandNumber && record->kinds[index] != VNScriptOperandInteger &&
+            record->kinds[index] != VNScriptOperandBool && record->operands[index].ref.index == VNScriptImageNotFound )
+            return NO;
+    }
+    
+    return YES;
+}
+
+@interface VNScript ()
+{
+    // Set when the script was loaded from a compiled script image (instead of a .plist file)
+    VNScriptImageReference* compiledImage;
+    
+    // Lazy translation data
+    NSDictionary* rawConversations;                 // The untranslated conversations, straight from the .plist file
+    NSMutableDictionary* conversationCache;         // Conversations that have already been translated
+    NSMutableDictionary* conversationCacheCosts;    // Size of each conversation (in bytes) in the cache
+    NSMutableArray* conversationCacheOrder;         // Least-recently-used conversation names come first
+    
+    // Linker data
+    NSArray* conversationNames;                     // Sorted alphabetically; a conversation's position is its index
+    NSDictionary* conversationIndexes;              // Conversation name -> index
+    NSArray* conversationsByIndex;                  // Translated conversations in index order (not used by lazy scripts)
+    NSMutableDictionary* linkErrorsByConversation;  // Conversation name -> errors (so relinking a conversation replaces them)
+    
+    // Set when the translated data belongs to a script in the VNScriptCache (and might be used by other scripts too)
+    BOOL isSharingData;
+}
+
+- (void)translateLine:(NSString*)line intoBuilder:(VNScriptImageBuilder*)builder;
+- (void)useScriptImage:(VNScriptImage*)image;
+- (void)shareTranslatedDataOfScript:(VNScript*)source;
+
+@end
+
+@implementation VNScript
+
+#pragma mark -
+#pragma mark Initialization
+
+// Load the script from a Property List (.plist) file in the app bundle. Make sure to not include the ".plist" in the file name.
+// For example, if the script is stored as "ThisScript.plist" in the bundle, just pass in "ThisScript" as the parameter.
+- (id)initFromFile:(NSString *)nameOfFile withConversation:(NSString*)conversationName {
+    if( self = [super init] ) {
+        self.filename = [[NSString alloc] initWithString:nameOfFile]; // Save filename
+        uint64_t startTime = VNStatsStart();
+        
+        // Scripts that have already been translated are shared through the script cache, so switching back to a script
+        // (or starting a new game) doesn't mean loading and translating the entire file all over again. This script
+        // just keeps track of its own position in the shared data.
+        VNScriptCache* cache = [VNScriptCache sharedCache];
+        VNScript* sharedScript = cache.enabled ? [cache cachedScriptNamed:nameOfFile] : nil;
+        
+        if( sharedScript != nil ) {
+            [self shareTranslatedDataOfScript:sharedScript];
+        } else {
+            
+            // Translating the entire script here would hold up the main thread, so this script gets translated lazily
+            // (one conversation at a time), and the cache translates the whole thing in the background for next time
+            [self loadScriptFromBundleNamed:nameOfFile translateEverything:NO];
+            
+            if( cache.enabled )
+                [cache preloadScriptsNamed:@[nameOfFile]];
         }
         
-        type = @VNScriptCommandIfFlagHasValue;
-        analyzedArray = @[type, variableName, expectedValue, secondaryCommand];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringIsFlagMoreThan] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ISFLAGMORETHAN
-        //
-        //  Checks if a flag's value is above a certain number. If it is, then a secondary command is run.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of flag (string)
-        //
-        //      #2: Certain number (integer)
-        //
-        //      #3: Another command
-        //
-        //  Example: .ISFLAGMORETHAN:power level:9000:.PLAYSOUND:over nine thousand.mp3
-        //
-        
-        if( command.count < 4 )
-            return nil;
-        
-        NSString* variableName = [command objectAtIndex:1];
-        NSString* expectedValue = [command objectAtIndex:2];
-        NSInteger extraCount = command.count - 3; // This number = secondary command + secondary command's parameters
+        // Now actually load some of the data
+        [self changeConversationTo:conversationName]; // Automatically move to the 'start' array (and set "index" data)
+        VNStatsRecordTimer(VNStatsTimerScriptLoad, startTime);
         
-        if( variableName == nil || expectedValue == nil ) {
-            NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAGMORETHAN command");
+        // Check if no valid data could be loaded from the file
+        if( self.data == nil && rawConversations == nil ) {
+            NSLog(@"[VNScript] ERROR: VNScript could not translate script.");
             return nil;
         }
+    }
+    
+    return self;
+}
+
+- (id)initFromFile:(NSString *)nameOfFile {
+    return [self initFromFile:nameOfFile withConversation:VNScriptStartingPoint];
+}
+
+// Where a script will be loaded from: the precompiled version if there is one, or the .plist file otherwise
++ (NSString*)pathForScriptNamed:(NSString*)nameOfFile
+{
+    NSString* compiledPath = [[NSBundle mainBundle] pathForResource:nameOfFile ofType:VNScriptCompiledFileExtension];
+    if( compiledPath != nil )
+        return compiledPath;
+    
+    return [[NSBundle mainBundle] pathForResource:nameOfFile ofType:@"plist"];
+}
+
+- (BOOL)loadScriptFromBundleNamed:(NSString*)nameOfFile translateEverything:(BOOL)shouldTranslateEverything
+{
+    // If there's a precompiled version of the script, use that instead, since it doesn't need to be translated at all
+    NSString* compiledPath = [[NSBundle mainBundle] pathForResource:nameOfFile ofType:VNScriptCompiledFileExtension];
+    if( compiledPath != nil && [self loadCompiledScriptFromPath:compiledPath] )
+        return YES;
+    
+    NSString* filepath = [[NSBundle mainBundle] pathForResource:nameOfFile ofType:@"plist"];
+    if( filepath == nil )
+        return NO;
+    
+    // Really big scripts get streamed straight from the file and translated in a single pass. Loading them into
+    // an NSDictionary first means having the whole script in memory twice (once as strings, and once translated)
+    // which is a lot of memory for scripts that are tens of megabytes. Smaller scripts get translated lazily, unless
+    // everything needs to be translated anyway, in which case streaming is still the cheapest way to do it.
+    if( shouldTranslateEverything || [VNScript fileSizeAtPath:filepath] >= VNScriptStreamingThreshold ) {
+        if( [self prepareScriptFromFile:filepath] )
+            return YES;
+    }
+    
+    // Load a dictionary from a .plist file in the app bundle
+    NSDictionary* loadedDictionary = [[NSDictionary alloc] initWithContentsOfFile:filepath]; // All data in the file
+    if( loadedDictionary == nil )
+        return NO;
+    
+    if( shouldTranslateEverything ) {
+        [self prepareScript:loadedDictionary];
+        return YES;
+    }
+    
+    [self prepareScriptLazily:loadedDictionary]; // Conversations get translated as they're needed
+    
+#if VNSCRIPT_LINK_ON_LOAD
+    // Check the whole script right away, so that broken jumps show up as soon as the script is loaded (instead
+    // of only when, and if, someone playing the game actually reaches them)
+    [self link];
+#endif
+    
+    return YES;
+}
+
+// Uses the same translated data as another script. Only things that never change once a script has been translated
+// and linked get shared; everything else (the current conversation, indexes, and so on) belongs to this script.
+- (void)shareTranslatedDataOfScript:(VNScript*)source
+{
+    compiledImage           = source->compiledImage;
+    self.data               = source.data;
+    rawConversations        = nil;
+    conversationNames       = source->conversationNames;
+    conversationIndexes     = source->conversationIndexes;
+    conversationsByIndex    = source->conversationsByIndex;
+    linkErrorsByConversation = [source->linkErrorsByConversation mutableCopy];
+    isSharingData           = YES;
+}
+
+- (NSUInteger)translatedSize
+{
+    // Conversations from the same script image all point at the same bytes, so each image only gets counted once
+    NSMutableSet* countedImages = [[NSMutableSet alloc] init];
+    NSUInteger size = 0;
+    
+    NSArray* conversations = (self.data != nil) ? [self.data allValues] : [conversationCache allValues];
+    for( VNScriptConversation* conversation in conversations ) {
         
-        NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
-        
-        for( int i = 3; i < command.count; i++ ) {
-            NSString* partOfCommand = [command objectAtIndex:i];
-            [extraCommand addObject:partOfCommand];
-        }
+        const VNScriptImage* image = [conversation image];
+        NSValue* imagePointer = [NSValue valueWithPointer:image];
         
-        NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
-        if( secondaryCommand == nil ) {
-            NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAGMORETHAN");
-            return nil;
+        if( image != NULL && [countedImages containsObject:imagePointer] == NO ) {
+            [countedImages addObject:imagePointer];
+            size += image->length;
         }
-        
-        type = @VNScriptCommandIsFlagMoreThan;
-        analyzedArray = @[type, variableName, expectedValue, secondaryCommand];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringIsFlagLessThan] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ISFLAGLESSTHAN
-        //
-        //  Checks if a flag's value is below a certain number. If it is, then a secondary command is run.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of flag (string)
-        //
-        //      #2: Certain number (integer)
-        //
-        //      #3: Another command
-        //
-        //  Example: .ISFLAGLESSTHAN:time remaining:0:.PLAYMUSIC:time's up.mp3
-        //
-        
-        if( command.count < 4 )
-            return nil;
-        
-        NSString* variableName = [command objectAtIndex:1];
-        NSString* expectedValue = [command objectAtIndex:2];
-        NSInteger extraCount = command.count - 3; // This number = secondary command + secondary command's parameters
-        
-        if( variableName == nil || expectedValue == nil ) {
-            NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAGLESSTHAN command");
-            return nil;
-        }
-        
-        NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
-        
-        for( int i = 3; i < command.count; i++ ) {
-            NSString* partOfCommand = [command objectAtIndex:i];
-            [extraCommand addObject:partOfCommand];
-        }
-        
-        NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
-        if( secondaryCommand == nil ) {
-            NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAGLESSTHAN");
-            return nil;
-        }
-        
-        type = @VNScriptCommandIsFlagLessThan;
-        analyzedArray = @[type, variableName, expectedValue, secondaryCommand];
+    }
     
-    }else if ( [action caseInsensitiveCompare:VNScriptStringIsFlagBetween] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ISFLAGBETWEEN
-        //
-        //  Checks if a flag's value is between two numbers, and if it is, this will run another command.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of flag (string)
-        //
-        //      #2: First number (integer)
-        //
-        //      #3: Second number (integer)
-        //
-        //      #4: Another command
-        //
-        //  Example: .ISFLAGBETWEEN:number of cookies:1:3:YOU HAVE EXACTLY TWO COOKIES!
-        //
-        
-        if( command.count < 5 )
-            return nil;
+    return size;
+}
+
+// Loads the script from a dictionary with a lot of other data (such as specific conversation names, indexes, etc).
+// This is used mostly for loading from saved games.
+- (id)initWithInfo:(NSDictionary*)dictionary {
+    if( dictionary == nil )
+        return nil;
+    
+    NSString* filenameValue     = [dictionary objectForKey:VNScriptFilenameKey]; // File to load script from
+    NSString* conversationValue = [dictionary objectForKey:VNScriptConversationNameKey]; // The conversation to start with
+    NSNumber* currentIndexValue = [dictionary objectForKey:VNScriptCurrentIndexKey]; // OPTIONAL: Which index to start processing on
+    NSNumber* indexesDoneValue  = [dictionary objectForKey:VNScriptIndexesDoneKey]; // OPTIONAL: Number of indexes processed already
+    
+    if( filenameValue == nil || conversationValue == nil )
+        return nil;
+    
+    // Load (and translate) the script from a .plist file that has the same name as whatever 'filenameValue' has
+    id result = [self initFromFile:filenameValue];
+    
+    // Go to the right conversation
+    [self changeConversationTo:conversationValue];
+    
+    // Copy the "indexes done" and "current index" values from the dictionary to the class's instance variables
+    if( currentIndexValue )
+        self.currentIndex = [currentIndexValue intValue];
+    if( indexesDoneValue )
+        self.indexesDone = [indexesDoneValue intValue];
+    
+    return result;
+}
+
+/*
+  Scene data:
+ 
+    (dictionary root)
+      1. "start" (array; holds dialogue, instructions, etc)
+      2. ...other arrays just like "start"
+ 
+ */
+
+// This processes the script, converting the data from its original Property List format into something
+// that can be used by VNLayer. (This new, converted format is stored in VNScript's "data" dictionary)
+- (void)prepareScript:(NSDictionary*)dictionary
+{
+    // NOTE: The Property List dictionary that holds all the script data has a "child" dictionary titled
+    //       "actual script." In an earlier version of the VN system, the Property List also had a section
+    //       titled "resources" (which held the names of sounds/images/etc to pre-load), plus some other
+    //       sections as well. However, as these other sections were never used, support for them has since
+    //       been removed from the VN engine. Now, the entire dictionary is treated as the "actual script"
+    //       section, and is composed of arrays that hold the "conversation" data.
+    
+    // Here's a dictionary object that will hold all the text-to-binary-data translated conversations. It will
+    // hold the "finished product" when this function is done processing.
+    NSMutableDictionary* translatedScript = [[NSMutableDictionary alloc] initWithCapacity:[dictionary count]];
+    
+    // Go through each NSArray (conversation) in the script and translate each conversation into something that's
+    // easier for the program to process. This "outer" for loop will get all the conversation names and the loops
+    // inside this one will translate each conversation.
+    for( NSString* conversationKey in [dictionary allKeys] ) {
         
-        NSString* variableName  = [command objectAtIndex:1];
-        NSString* firstValue    = [command objectAtIndex:2];
-        NSString* secondValue   = [command objectAtIndex:3];
-        NSInteger extraCount    = command.count - 4; // This number = secondary command + secondary command's parameters
+        // This retrieves the actual array data so that it can be processed. There's an "original array" that holds
+        // the raw text data (taken from the Property List) and then a "translated array" that holds the data that's
+        // been converted to processed data.
+        NSArray* originalArray = [dictionary objectForKey:conversationKey]; // Get original text array
         
-        if( variableName == nil || firstValue == nil || secondValue == nil ) {
-            NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAGBETWEEN command");
-            return nil;
+        // Make sure this is actually an NSArray object, and not some other kind of object that just happened to be in the dictionary
+        if( [originalArray isKindOfClass:[NSArray class]] ) {
+
+            NSArray* translatedArray = [self translatedConversation:originalArray];
+            
+            // Add this translated "conversation" to the script
+            [translatedScript setObject:translatedArray forKey:conversationKey];
         }
+    }
+    
+    // At this point, the entire script should be translated, and can now be used in the actual game.
+    // The finished product gets stored by the class for use later (during the game).
+    self.data = [[NSDictionary alloc] initWithDictionary:translatedScript];
+    rawConversations = nil;
+    
+    [self linkTranslatedScript];
+}
+
+// Does the same thing as 'prepareScript' but translates several conversations at the same time, on different CPU cores.
+// Each conversation is translated independently, and the results are stored by position (and not in the order that
+// the workers happen to finish in), so the finished script is exactly the same as what 'prepareScript' creates.
+- (void)prepareScript:(NSDictionary*)dictionary workerCount:(NSUInteger)workerCount
+{
+    if( workerCount == 0 )
+        workerCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    
+    if( workerCount <= 1 || dictionary.count <= 1 ) {
+        [self prepareScript:dictionary];
+        return;
+    }
+    
+    NSArray* conversationNames = [dictionary allKeys];
+    NSUInteger conversationCount = conversationNames.count;
+    workerCount = MIN(workerCount, conversationCount);
+    
+    // Each worker stores its translated conversations here. The arrays are retained "manually" (with CFBridgingRetain)
+    // since ARC doesn't manage plain C arrays of objects.
+    void** results = calloc(conversationCount, sizeof(void*));
+    if( results == NULL ) {
+        [self prepareScript:dictionary];
+        return;
+    }
+    
+    // Workers grab the next untranslated conversation from this counter until there aren't any left. That way, one
+    // really long conversation doesn't leave the other workers sitting around with nothing to do.
+    atomic_size_t nextConversation = 0;
+    atomic_size_t* nextConversationPointer = &nextConversation;
+    
+    dispatch_queue_t workQueue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+    dispatch_apply(workerCount, workQueue, ^(size_t worker) {
         
-        // Figure out which value is the lesser value, and which one is the greater value. By default,
-        // it's assumed first value is the "lesser" value, and the second ond is the "greater" one
-        int first           = [firstValue intValue];
-        int second          = [secondValue intValue];
-        int lesserValue     = first;
-        int greaterValue    = second;
-        
-        // Check if the default value assignment is wrong. In this case, the second value is the lesser one,
-        // and that the first value is the greater one.
-        if( first > second ) {
-            // Reassign the values appropriately
-            greaterValue = first;
-            lesserValue = second;
+        size_t index = atomic_fetch_add(nextConversationPointer, 1);
+        while( index < conversationCount ) {
+            
+            @autoreleasepool {
+                NSArray* originalArray = [dictionary objectForKey:[conversationNames objectAtIndex:index]];
+                if( [originalArray isKindOfClass:[NSArray class]] )
+                    results[index] = (void*)CFBridgingRetain([self translatedConversation:originalArray]);
+            }
+            
+            index = atomic_fetch_add(nextConversationPointer, 1);
         }
+    });
+    
+    // Merge everything back together (on this thread)
+    NSMutableDictionary* translatedScript = [[NSMutableDictionary alloc] initWithCapacity:conversationCount];
+    for( NSUInteger i = 0; i < conversationCount; i++ ) {
+        if( results[i] != NULL )
+            [translatedScript setObject:CFBridgingRelease(results[i]) forKey:[conversationNames objectAtIndex:i]];
+    }
+    
+    free(results);
+    
+    self.data = [[NSDictionary alloc] initWithDictionary:translatedScript];
+    rawConversations = nil;
+    
+    [self linkTranslatedScript];
+}
+
+// Stores the original script data so that conversations can be translated later, when they're actually needed. For
+// scripts with lots of branches, most conversations never get used in a particular playthrough, so there's no point
+// spending time (and memory) translating all of them up front.
+- (void)prepareScriptLazily:(NSDictionary*)dictionary
+{
+    if( dictionary == nil )
+        return;
+    
+    rawConversations        = [[NSDictionary alloc] initWithDictionary:dictionary];
+    conversationCache       = [[NSMutableDictionary alloc] init];
+    conversationCacheCosts  = [[NSMutableDictionary alloc] init];
+    conversationCacheOrder  = [[NSMutableArray alloc] init];
+    _conversationCacheSize  = 0;
+    self.data               = nil;
+    
+    if( self.conversationCacheBudget == 0 )
+        self.conversationCacheBudget = VNScriptDefaultConversationCacheBudget;
+    
+    // Conversations get linked one at a time (as they're translated), but they all need to have indexes right away
+    NSMutableArray* names = [[NSMutableArray alloc] initWithCapacity:dictionary.count];
+    for( NSString* name in dictionary ) {
+        if( [[dictionary objectForKey:name] isKindOfClass:[NSArray class]] )
+            [names addObject:name];
+    }
+    
+    [self prepareConversationIndexes:names];
+}
+
+// Translates a single conversation from its original text into the command records that VNScene uses. The records
+// (and the strings they use) are packed into a small script image that belongs to the conversation, which is exactly
+// the same format that compiled scripts use.
+- (VNScriptConversation*)translatedConversation:(NSArray*)originalArray
+{
+    VNScriptImageBuilder* builder = VNScriptImageBuilderCreate();
+    if( builder == NULL )
+        return nil;
+    
+    VNScriptImageBuilderBeginConversation(builder, "", 0);
+    
+    // Now go through each line in this particular "conversation" and convert it from raw text to processed data
+    for( NSString* line in originalArray ) {
+        if( [line isKindOfClass:[NSString class]] )
+            [self translateLine:line intoBuilder:builder];
+    }
+    
+    VNScriptImageBuilderEndConversation(builder);
+    
+    size_t length = 0;
+    void* bytes = VNScriptImageBuilderCopyBytes(builder, &length);
+    VNScriptImageBuilderFree(builder);
+    
+    VNScriptImage* image = VNScriptImageOpenOwnedBytes(bytes, length);
+    if( image == NULL ) {
+        free(bytes);
+        return nil;
+    }
+    
+    VNScriptImageReference* reference = [[VNScriptImageReference alloc] initWithImage:image];
+    return [[VNScriptConversation alloc] initWithReference:reference entry:&image->conversations[0]];
+}
+
+// Translates one line of the script and adds it to the conversation that's currently being built
+- (void)translateLine:(NSString*)line intoBuilder:(VNScriptImageBuilder*)builder
+{
+    // The arrays created while translating are only needed until the line has been turned into a record
+    @autoreleasepool {
         
-        NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
+        // Break the string down into its individual components and translate it into something easy for the program to "read"
+        NSArray* commandFromLine = [line componentsSeparatedByString:VNScriptSeparationString];
+        NSArray* translatedLine = [self analyzedCommand:commandFromLine];
         
-        for( int i = 4; i < command.count; i++ ) {
-            NSString* partOfCommand = [command objectAtIndex:i];
-            [extraCommand addObject:partOfCommand];
+        // Add the translated line to the correct, "finished product" conversation
+        if( translatedLine != nil ) {
+            
+            VNScriptCommandRecord record;
+            if( VNScriptRecordFromArray(builder, translatedLine, &record) == NO ) {
+                NSLog(@"[VNScript] ERROR: Could not store translated line: %@", line);
+                return;
+            }
+            
+            VNScriptImageBuilderAddCommand(builder, &record);
         }
-        
-        NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
-        if( secondaryCommand == nil ) {
-            NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAGBETWEEN");
-            return nil;
+    }
+}
+
+#pragma mark - Streaming
+
+// Passed to the VNScriptStream callbacks. The script isn't retained, since it's only used while the file is being read.
+typedef struct {
+    __unsafe_unretained VNScript* script;
+    VNScriptImageBuilder* builder;
+} VNScriptStreamContext;
+
+static void VNScriptStreamBeginConversation(void* context, const char* name, size_t length)
+{
+    VNScriptStreamContext* streamContext = (VNScriptStreamContext*)context;
+    VNScriptImageBuilderBeginConversation(streamContext->builder, name, length);
+}
+
+static void VNScriptStreamAddLine(void* context, const char* text, size_t length)
+{
+    VNScriptStreamContext* streamContext = (VNScriptStreamContext*)context;
+    
+    @autoreleasepool {
+        NSString* line = [[NSString alloc] initWithBytes:text length:length encoding:NSUTF8StringEncoding];
+        if( line == nil ) {
+            NSLog(@"[VNScript] ERROR: Script has a line that isn't valid UTF-8; skipping it.");
+            return;
         }
         
-        // Convert greater/lesser scalar values back into NSString format for the script
-        NSString* lesserValueString = [NSString stringWithFormat:@"%d", lesserValue];
-        NSString* greaterValueString = [NSString stringWithFormat:@"%d", greaterValue];
-        
-        type = @VNScriptCommandIsFlagBetween;
-        analyzedArray = @[type, variableName, lesserValueString, greaterValueString, secondaryCommand];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringModifyFlagOnChoice] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .MODIFYFLAGBYCHOICE
-        //
-        //  This presents a choice menu. Each choice causes a particular flag/variable to be changed
-        //  by a particular integer value.
-        //
-        //  Parameters:
-        //
-        //      #1: The text that will appear on the choice (string)
-        //
-        //      #2: The name of the flag/variable to be modified (string)
-        //
-        //      #3: The amount to modify the flag/variable by (integer)
-        //
-        //      ...these variables can be repeated multiple times.
-        //
-        //  Example: .MODIFYFLAGBYCHOICE:"Be nice":niceness:1:"Be rude":niceness:-1
-        //
+        [streamContext->script translateLine:line intoBuilder:streamContext->builder];
+    }
+}
+
+static void VNScriptStreamEndConversation(void* context)
+{
+    VNScriptStreamContext* streamContext = (VNScriptStreamContext*)context;
+    VNScriptImageBuilderEndConversation(streamContext->builder);
+}
+
++ (unsigned long long)fileSizeAtPath:(NSString*)path
+{
+    if( path == nil )
+        return 0;
+    
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileSize];
+}
+
+// Every line goes straight from the file, through 'analyzedCommand', and into a script image, so the only copy of the
+// whole script that ever exists is the translated one.
+- (BOOL)prepareScriptFromFile:(NSString*)path
+{
+    VNScriptImageBuilder* builder = VNScriptImageBuilderCreate();
+    if( builder == NULL )
+        return NO;
+    
+    VNScriptStreamContext context = { self, builder };
+    VNScriptStreamCallbacks callbacks = { VNScriptStreamBeginConversation, VNScriptStreamAddLine, VNScriptStreamEndConversation };
+    VNScriptStreamStats stats;
+    char error[VNScriptStreamErrorLength];
+    
+    VNScriptStreamResult result = VNScriptStreamParseFile([path fileSystemRepresentation], &callbacks, &context, &stats, error, sizeof(error));
+    if( result != VNScriptStreamOK ) {
         
-        // Since the first item in the command array is the ".MODIFYFLAG" string, we'll just ignore that first index
-        // when counting the number of choices. Also, since each set of parameters consists of three parts (choice text,
-        // variable name, and variable value), the number will be divided by three to get the actual number of choices.
-        NSInteger numberOfChoices = (command.count - 1) / 3;
+        // Binary .plist files aren't a problem; they just have to be loaded the normal way
+        if( result != VNScriptStreamErrorBinary )
+            NSLog(@"[VNScript] ERROR: Could not stream script %@: %s", [path lastPathComponent], error);
         
-        // Create some empty mutable arrays
-        NSMutableArray* choiceText = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
-        NSMutableArray* variableNames = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
-        NSMutableArray* variableValues = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
+        VNScriptImageBuilderFree(builder);
+        return NO;
+    }
+    
+    size_t length = 0;
+    void* bytes = VNScriptImageBuilderCopyBytes(builder, &length);
+    VNScriptImageBuilderFree(builder);
+    
+    VNScriptImage* image = (bytes != NULL) ? VNScriptImageOpenOwnedBytes(bytes, length) : NULL;
+    if( image == NULL ) {
+        NSLog(@"[VNScript] ERROR: Could not create script image for streamed script: %@", [path lastPathComponent]);
+        free(bytes);
+        return NO;
+    }
+    
+    [self useScriptImage:image];
+    
+    EKTraceInfo(EKTraceCategoryScript, "Streamed %s: %u conversations, %u lines (%llu bytes read, %lu byte image)", [[path lastPathComponent] UTF8String],
+                stats.conversationCount, stats.lineCount, (unsigned long long)stats.bytesRead, (unsigned long)length);
+    return YES;
+}
+
+#pragma mark - Conversation cache
+
+- (BOOL)hasConversationNamed:(NSString*)name
+{
+    if( name == nil )
+        return NO;
+    
+    if( self.data != nil )
+        return ([self.data objectForKey:name] != nil);
+    
+    return [[rawConversations objectForKey:name] isKindOfClass:[NSArray class]];
+}
+
+// Returns a translated conversation. If the script is being translated lazily, then the conversation is either
+// retrieved from the cache, or translated (and then added to the cache).
+- (VNScriptConversation*)conversationNamed:(NSString*)name
+{
+    if( name == nil )
+        return nil;
+    
+    // Fully-translated (or compiled) scripts already have everything ready to go
+    if( self.data != nil )
+        return [self.data objectForKey:name];
+    
+    VNScriptConversation* translated = [conversationCache objectForKey:name];
+    if( translated != nil ) {
         
-        for( int i = 0; i < numberOfChoices; i++ ) {
+        // Move it to the end of the list, since it's now the most recently used conversation
+        [conversationCacheOrder removeObject:name];
+        [conversationCacheOrder addObject:name];
+        return translated;
+    }
+    
+    NSArray* originalArray = [rawConversations objectForKey:name];
+    if( [originalArray isKindOfClass:[NSArray class]] == NO )
+        return nil;
+    
+    translated = [self translatedConversation:originalArray];
+    if( translated == nil )
+        return nil;
+    
+    // Since the translated conversation is just a block of records and strings, its size is known exactly
+    NSUInteger cost = [translated image]->length;
+    
+    NSString* key = [name copy];
+    [self linkConversation:translated named:key];
+    
+    [conversationCache setObject:translated forKey:key];
+    [conversationCacheCosts setObject:@(cost) forKey:key];
+    [conversationCacheOrder addObject:key];
+    _conversationCacheSize += cost;
+    
+    [self trimConversationCacheExcept:key];
+    
+    return translated;
+}
+
+// Removes the least-recently-used conversations until the cache fits in its budget. The current conversation (and
+// the one that's about to be used) always stay in the cache.
+- (void)trimConversationCacheExcept:(NSString*)nameToKeep
+{
+    NSUInteger index = 0;
+    
+    while( _conversationCacheSize > self.conversationCacheBudget && index < conversationCacheOrder.count ) {
         
-        	// This is used as an offset in order to get the right index numbers for the 'command' array.
-        	// It starts at 1 and then jumps to every third number thereafter (from 1 to 4, 7, 10, 13, etc).    
-            int nameIndex = 1 + (i * 3);
-            
-            // Get the parameters for the command array
-            NSString* text = [command objectAtIndex:nameIndex]; // Text to show to player
-            NSString* name = [command objectAtIndex:nameIndex+1]; // The name of the flag to modify
-            NSString* check = [command objectAtIndex:nameIndex+2]; // The amount to modify the flag by
-            
-            // Move each value to the appropriate array
-            [choiceText addObject:text];
-            [variableNames addObject:name];
-            [variableValues addObject:check];
+        NSString* name = [conversationCacheOrder objectAtIndex:index];
+        if( [name isEqualToString:nameToKeep] || [name isEqualToString:self.conversationName] ) {
+            index++;
+            continue;
         }
         
-        type = @VNScriptCommandModifyFlagOnChoice;
-        analyzedArray = @[type, choiceText, variableNames, variableValues];
-        
-    } else if ( [action caseInsensitiveCompare:VNScriptStringJumpOnFlag] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .JUMPONFLAG
-        //
-        //  If a particular flag has a particular value, then this command will jump to a different
-        //  conversation/dialogue-sequence in the script.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the flag to be checked (string)
-        //
-        //      #2: The expected value of the flag (integer)
-        //
-        //      #3: The scene to jump to, if the flag's vaue matches the expected value in parameter #2 (string)
-        //
-        //  Example: .JUMPONFLAG:should jump to beach scene:1:BeachScene
-        //
-        
-        if( command.count < 4 )
-            return nil;
+        _conversationCacheSize -= [[conversationCacheCosts objectForKey:name] unsignedIntegerValue];
+        [conversationCache removeObjectForKey:name];
+        [conversationCacheCosts removeObjectForKey:name];
+        [conversationCacheOrder removeObjectAtIndex:index];
+    }
+}
+
+- (void)setConversationCacheBudget:(NSUInteger)budget
+{
+    _conversationCacheBudget = budget;
+    [self trimConversationCacheExcept:nil];
+}
+
+#pragma mark - 
+#pragma mark Misc
+
+// Returns information ABOUT the script (but NOT the script itself). Conveniently, this same information can be
+// used to load a script using the 'initWithInfo' function.
+- (NSDictionary*)info
+{
+	// Store index data
+    NSNumber* indexesDoneValue = @(self.indexesDone);
+    NSNumber* currentIndexValue = @(self.currentIndex);
+    
+    // Store all relevant data into another dictionary
+    NSDictionary* dictForScript = @{VNScriptIndexesDoneKey:        indexesDoneValue,
+                                    VNScriptCurrentIndexKey:       currentIndexValue,
+                                    VNScriptConversationNameKey:   self.conversationName,
+                                    VNScriptFilenameKey:           self.filename};
+    
+    return dictForScript;
+}
+
+// Changes from one conversation to another. The indexes are reset as part of the process.
+- (BOOL)changeConversationTo:(NSString *)newConversation
+{
+    // Check if there's any data; if not, then there's no point to this function as there are no conversations!
+    if( self.data != nil || rawConversations != nil ) {
         
-        NSString* variableName = [command objectAtIndex:1];
-        NSString* expectedValue = [command objectAtIndex:2];
-        NSString* newLocation = [command objectAtIndex:3];
+        // Try to point to a new array with dialogue data (translating it first, if it hasn't been translated yet)
+        VNScriptConversation* newArray = [self conversationNamed:newConversation];
         
-        if( variableName == nil || expectedValue == nil || newLocation == nil ) {
-            NSLog(@"[VNScript] ERROR: Invalid parameters passed to .JUMPONFLAG command.");
-            return nil;
+        // Check if that worked at all
+        if( newArray ) {
+            
+            [self switchToConversation:newArray named:newConversation];
+            return YES;
         }
+    }
+    
+    return NO;
+}
+
+// Just like 'changeConversationTo' except that it uses a conversation's index instead of its name (which is what
+// linked commands like .SETCONVERSATION and .JUMPONFLAG store).
+- (BOOL)changeConversationToIndex:(uint32_t)index
+{
+    NSString* name = [self nameOfConversationAtIndex:index];
+    if( name == nil )
+        return NO;
+    
+    VNScriptConversation* newArray = nil;
+    if( conversationsByIndex != nil )
+        newArray = [conversationsByIndex objectAtIndex:index];
+    else
+        newArray = [self conversationNamed:name];
+    
+    if( newArray == nil )
+        return NO;
+    
+    [self switchToConversation:newArray named:name];
+    return YES;
+}
+
+- (void)switchToConversation:(VNScriptConversation*)newConversation named:(NSString*)name
+{
+    self.conversation = newConversation;
+    
+    // Get rid of old data and replace it
+    self.conversationName   = [name copy];
+    self.currentIndex       = 0;
+    self.indexesDone        = 0;
+    self.maxIndexes         = self.conversation.count;
+}
+
+- (id)commandAtLine:(NSInteger)line
+{
+    // Check if conversation data is valid
+    if( self.conversation  ) {
         
-        type = @VNScriptCommandJumpOnFlag;
-        analyzedArray = @[type, variableName, expectedValue, newLocation];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringSystemCall] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SYSTEMCALL
-        //
-        //  Used to do a "system call," which is usually game-specific. This command will try to contact the
-        //  VNSystemCall class, and use it to perform some kind of particular task. Some examples of this would
-        //  be starting a mini-game or some other activity that's specific to a particular app.
-        //
-        //  Parameters:
-        //
-        //      #1: The "call string" or a string that described what the activity/system-call type will be (string)
-        //
-        //      #2: (OPTIONAL) The first parameter to pass in to the system call (string?)
-        //
-        //      ...more parameters can be passed in as necessary
-        //
-        //  Example: .SYSTEMCALL:start-bullet-hell-minigame:BulletHellLevel01
-        //
-        
-        if( command.count < 1 )
-            return nil;
-        
-        NSString* callString = [command objectAtIndex:1]; // Extract the call string
-        
-        NSMutableArray* extraParameters = [NSMutableArray arrayWithArray:command];
-        [extraParameters removeObjectAtIndex:1]; // Remove call type
-        [extraParameters removeObjectAtIndex:0]; // Remove command
-        
-        // Add a dummy parameter just for the heck of it
-        if( extraParameters.count < 1 )
-            [extraParameters addObject:@"nil"];
-        
-        type = @VNScriptCommandSystemCall;
-        analyzedArray = @[type, callString, extraParameters];
-        
-    } /*
-       
-       NOTE: CALLCODE has been disabled because it was a bad idea; it's better to just use SYSTEMCALL for
-             any unusual game-specific functionality.
-       
-       else if( [action caseInsensitiveCompare:VNScriptStringCallCode] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .CALLCODE
-        //
-        //  This action can be used to call functions (usually from static objects). Careful when using it to
-        //  call classes or functions that the VN system doesn't have access to! You may need to include header
-        //  files from certain places if you really want to use certain classes.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the class to call (string)
-        //
-        //      #2: The name of a static function to call (string)
-        //
-        //		#3: (OPTIONAL) The name of another function, PRESUMABLY a function that belongs to the class
-        //			instance that was returned by the function called in #2 (string)
-        //
-        //		#4: (OPTIONAL) A parameter to pass into the function called in #3 (string?)
-        //
-        //  Example: .CALLCODE:EKRecord:sharedRecord:flagNamed:times played
-        //
-        
-        if( command.count < 3 )
-            return nil;
+        // Check to make sure there's no "out-of-bounds" array error
+        if( line < self.conversation.count ) {
+            return [self.conversation objectAtIndex:line];
+        }
+    }
+    
+    return nil;
+}
+
+// Returns the current "command" (string) in the current conversation
+- (id)currentCommand
+{
+    if( self.indexesDone > self.currentIndex )
+        return nil;
+    
+    return [self commandAtLine:self.indexesDone];
+}
+
+- (const VNScriptCommandRecord*)recordAtLine:(NSInteger)line
+{
+    if( self.conversation == nil || line < 0 )
+        return NULL;
+    
+    return [self.conversation recordAtIndex:line];
+}
+
+- (const VNScriptCommandRecord*)currentRecord
+{
+    if( self.indexesDone > self.currentIndex )
+        return NULL;
+    
+    return [self recordAtLine:self.indexesDone];
+}
+
+// Check if the current index still needs processing, or if it's already been processed
+- (BOOL)lineShouldBeProcessed
+{
+    if( self.indexesDone <= self.currentIndex )
+        return YES;
+    
+    return NO;
+}
+
+// Advance the number of indexes done by by one. Since this function only has one line, it's probably not necessary
+// to call it (or rather, you could just copy+paste its one line INSTEAD of calling it), but it might be useful in
+// case you need to advance the line in a selector (or as part of a Cocos2D action).
+- (void)advanceLine
+{
+    self.indexesDone = self.indexesDone + 1;
+}
+
+// Similar to 'advanceLine' except it advances the current index instead of the number of indexes that have been processed
+- (void)advanceIndex
+{
+    self.currentIndex++;
+}
+
+- (id)currentLine
+{
+    return [self commandAtLine:self.currentIndex];
+}
+
+#pragma mark - Linking
+
+// Gives each conversation an index, based on alphabetical order (so the same script always gets the same indexes)
+- (void)prepareConversationIndexes:(NSArray*)names
+{
+    conversationNames = [names sortedArrayUsingSelector:@selector(compare:)];
+    conversationsByIndex = nil;
+    isSharingData = NO;
+    linkErrorsByConversation = [[NSMutableDictionary alloc] init];
+    
+    NSMutableDictionary* indexes = [[NSMutableDictionary alloc] initWithCapacity:conversationNames.count];
+    for( NSUInteger i = 0; i < conversationNames.count; i++ )
+        [indexes setObject:@(i) forKey:[conversationNames objectAtIndex:i]];
+    
+    conversationIndexes = indexes;
+}
+
+- (void)linkConversation:(VNScriptConversation*)conversation named:(NSString*)name
+{
+    NSMutableArray* errors = [[NSMutableArray alloc] init];
+    [conversation linkWithConversationIndexes:conversationIndexes named:name errors:errors];
+    
+    // Conversations that got thrown out of the cache are linked again when they're translated again, and the errors
+    // they had the first time around are only logged once
+    if( [linkErrorsByConversation objectForKey:name] == nil ) {
+        for( NSString* error in errors )
+            NSLog(@"[VNScript] ERROR: %@", error);
+    }
+    
+    [linkErrorsByConversation setObject:errors forKey:name];
+}
+
+// Links every conversation in a script that's already been completely translated (or loaded from a compiled image)
+- (void)linkTranslatedScript
+{
+    [self prepareConversationIndexes:[self.data allKeys]];
+    
+    NSMutableArray* conversations = [[NSMutableArray alloc] initWithCapacity:conversationNames.count];
+    for( NSString* name in conversationNames ) {
         
-        // At this point, you'll need an array that has all the things needed to call a particular class,
-        // as well as class functions. The first string in the array will be the class, the second will be
-        // a "shared object" static function, and if a third string exists, it will call a particular
-        // function in that class. If there are any more strings, they will be parameters. For example:
-        //
-        //  callingArray[0] = EKRecord
-        //  callingArray[1] = sharedRecord
-        //  callingArray[2] = flagNamed
-        //  callingArray[3] = times played
-        //
-        // ...which would come out something like --> [[EKRecord sharedRecord] flagNamed:@"times played"];
-        //
-        NSMutableArray* callingArray = [NSMutableArray arrayWithArray:command];
-        [callingArray removeObjectAtIndex:0]; // Removes the string ".callcode"
+        VNScriptConversation* conversation = [self.data objectForKey:name];
+        [self linkConversation:conversation named:name];
+        [conversations addObject:conversation];
+    }
+    
+    conversationsByIndex = conversations;
+}
+
+- (NSArray*)link
+{
+    // Shared data was already linked when it was loaded into the cache, and linking it again would mean changing data
+    // that other scripts might be using
+    if( isSharingData )
+        return self.linkErrors;
+    
+    if( self.data != nil ) {
         
-        type = @VNScriptCommandCallCode;
-        analyzedArray = @[type, callingArray];
-    } */ else if( [action caseInsensitiveCompare:VNScriptStringSwitchScript] == NSOrderedSame ) {
+        [self linkTranslatedScript];
         
-        // Function definition
-        //
-        //  Name: .SWITCHSCRIPT
-        //
-        //  Replaces a scene's script with a script loaded from another .PLIST file. This is useful if you're
-        //  using multiple .PLIST files.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the .PLIST file to load (string)
-        //
-        //      #2: (OPTIONAL) The name of the "conversation"/array to start at to (string) (default is "start")
-        //
-        //  Example: .SWITCHSCRIPT:script number 2:Some Random Event
-        //
+    } else if( rawConversations != nil ) {
         
-        if( command.count < 2 )
-            return nil;
+        for( NSString* name in conversationNames ) {
+            
+            // Conversations that haven't been used yet get translated just so they can be checked; they don't get added
+            // to the cache (and will be linked again if they're ever actually used).
+            @autoreleasepool {
+                VNScriptConversation* conversation = [conversationCache objectForKey:name];
+                if( conversation == nil )
+                    conversation = [self translatedConversation:[rawConversations objectForKey:name]];
+                
+                if( conversation != nil )
+                    [self linkConversation:conversation named:name];
+            }
+        }
+    }
+    
+    return self.linkErrors;
+}
+
+- (NSArray*)linkErrors
+{
+    NSMutableArray* errors = [[NSMutableArray alloc] init];
+    for( NSString* name in [[linkErrorsByConversation allKeys] sortedArrayUsingSelector:@selector(compare:)] )
+        [errors addObjectsFromArray:[linkErrorsByConversation objectForKey:name]];
+    
+    return errors;
+}
+
+- (NSString*)nameOfConversationAtIndex:(uint32_t)index
+{
+    if( index >= conversationNames.count )
+        return nil;
+    
+    return [conversationNames objectAtIndex:index];
+}
+
+// Flag slots are handed out by EKFlagTable, which is also where flag values are stored (see VNScene's 'flags')
++ (uint32_t)slotForFlagNamed:(NSString*)name
+{
+    return [EKFlagTable slotForFlagNamed:name];
+}
+
++ (NSString*)flagNameForSlot:(uint32_t)slot
+{
+    return [EKFlagTable flagNameForSlot:slot];
+}
+
++ (uint32_t)flagSlotCount
+{
+    return [EKFlagTable slotCount];
+}
+
+#pragma mark - Compiled scripts
+
+- (BOOL)loadCompiledScriptFromPath:(NSString*)path
+{
+    VNScriptImage* image = VNScriptImageOpenFile([path fileSystemRepresentation]);
+    if( image == NULL ) {
+        NSLog(@"[VNScript] ERROR: Could not load compiled script from: %@", path);
+        return NO;
+    }
+    
+    [self useScriptImage:image];
+    return YES;
+}
+
+// Makes a (completely translated) script image the script's data. The script takes ownership of the image.
+- (void)useScriptImage:(VNScriptImage*)image
+{
+    VNScriptImageReference* reference = [[VNScriptImageReference alloc] initWithImage:image];
+    NSMutableDictionary* conversations = [[NSMutableDictionary alloc] initWithCapacity:image->header->conversationCount];
+    
+    // Only the conversation table gets read here; the actual commands stay in the mapped file until they're used
+    for( uint32_t i = 0; i < image->header->conversationCount; i++ ) {
         
-        NSString* scriptName = [command objectAtIndex:1];
-        NSString* startingPoint = VNScriptStartingPoint; // Default value
+        const VNScriptConversationEntry* entry = &image->conversations[i];
+        NSString* name = VNScriptStringFromImage(image, entry->name);
+        if( name == nil )
+            continue;
         
-        // Check if the script name is missing
-        if( scriptName == nil )
-            return nil;
+        [conversations setObject:[[VNScriptConversation alloc] initWithReference:reference entry:entry] forKey:name];
+    }
+    
+    compiledImage = reference;
+    self.data = [[NSDictionary alloc] initWithDictionary:conversations];
+    rawConversations = nil;
+    
+    [self linkTranslatedScript];
+}
 
-        // Load non-default starting point (if it exists)
-        if( command.count > 2 ) {
-            startingPoint = [command objectAtIndex:2];
+- (NSData*)compiledScriptData
+{
+    NSDictionary* translatedScript = self.data;
+    
+    // Lazily-translated scripts need to have everything translated first
+    if( translatedScript == nil && rawConversations != nil ) {
+        
+        NSMutableDictionary* everything = [[NSMutableDictionary alloc] initWithCapacity:rawConversations.count];
+        for( NSString* name in rawConversations ) {
+            NSArray* conversation = [self conversationNamed:name];
+            if( conversation )
+                [everything setObject:conversation forKey:name];
         }
         
-        type = @VNScriptCommandSwitchScript;
-        
-        NSLog(@"Hey, starting point is: %@", startingPoint);
-        NSLog(@"Command.count is %lu", (unsigned long)command.count);
-        analyzedArray = @[type, scriptName, startingPoint];
-        NSLog(@"Anaylzed array is: %@", analyzedArray);
-    } else if( [action caseInsensitiveCompare:VNScriptStringSetSpeakerFont] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPEAKERFONT
-        //
-        //  Replaces the current font used by the "speaker name" label with another font.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the font to use (string)
-        //
-        //  Example: .SETSPEAKERFONT:Helvetica
-        //
-        
-        type = @VNScriptCommandSetSpeakerFont;
-        analyzedArray = @[type, parameter1];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringSetSpeakerFontSize] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPEAKERFONTSIZE
-        //
-        //  Changes the font size used by the "speaker name" label.
-        //
-        //  Parameters:
-        //
-        //      #1: Font size (float)
-        //
-        //  Example: .SETSPEAKERFONTSIZE:17.0
-        //
-        
-        type = @VNScriptCommandSetSpeakerFontSize;
-        analyzedArray = @[type, parameter1];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringSetSpeechFont] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPEECHFONT
-        //
-        //  Replaces the current font used by the speech/dialogue label with another font.
-        //
-        //  Parameters:
-        //
-        //      #1: The name of the font to use (string)
-        //
-        //  Example: .SETSPEECHFONT:Courier New
-        //
-        
-        type = @VNScriptCommandSetSpeechFont;
-        analyzedArray = @[type, parameter1];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringSetSpeechFontSize] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPEECHFONTSIZE
-        //
-        //  Changes the speech/dialogue font size.
-        //
-        //  Parameters:
-        //
-        //      #1: Font size (float)
-        //
-        //  Example: .SETSPEECHFONTSIZE:18.0
-        //
-        
-        type = @VNScriptCommandSetSpeechFontSize;
-        analyzedArray = @[type, parameter1];
-        
-    }  else if( [action caseInsensitiveCompare:VNScriptStringSetTypewriterText] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETTYPEWRITERTEXT
-        //
-        //  Sets or disables "typewriter text" mode, in which each character of text/dialogue appears
-        //  one at a time (though usually still very quickly).
-        //
-        //  Parameters:
-        //
-        //      #1: How many characters it should print per second (Integer)
-        //          (setting this to zero disables typewriter text mode)
-        //
-        //      #2: (OPTIONAL) Whether the user can still skip ahead by tapping the screen (BOOL)
-        //          (default value is NO)
-        //
-        //  Example: .SETTYPEWRITERTEXT:30:NO
-        //
-        
-        NSString* defaultSkipString = @"NO";
+        translatedScript = everything;
+    }
+    
+    if( translatedScript == nil )
+        return nil;
+    
+    VNScriptImageBuilder* builder = VNScriptImageBuilderCreate();
+    if( builder == NULL )
+        return nil;
+    
+    // Conversations are added in alphabetical order so that the same script always compiles to the same bytes
+    NSArray* sortedNames = [[translatedScript allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    
+    for( NSString* conversationName in sortedNames ) {
         
-        int textSpeed = parameter1.intValue;
-        NSNumber* timeNumber = [NSNumber numberWithInt:textSpeed];
+        NSData* utf8Name = [conversationName dataUsingEncoding:NSUTF8StringEncoding];
+        VNScriptImageBuilderBeginConversation(builder, utf8Name.bytes, utf8Name.length);
         
-        BOOL canSkip = [defaultSkipString boolValue]; // Use default value first
-        if( command.count > 2 ) {
-            canSkip = [[command objectAtIndex:2] boolValue]; // Use custom value if it exists
+        for( NSArray* command in [translatedScript objectForKey:conversationName] ) {
+            
+            VNScriptCommandRecord record;
+            if( VNScriptRecordFromArray(builder, command, &record) == NO ) {
+                NSLog(@"[VNScript] ERROR: Could not compile command %@ in conversation: %@", command, conversationName);
+                VNScriptImageBuilderFree(builder);
+                return nil;
+            }
+            
+            VNScriptImageBuilderAddCommand(builder, &record);
         }
         
-        NSNumber* skipNumber = [NSNumber numberWithBool:canSkip];
-        
-        type = @VNScriptCommandSetTypewriterText;
-        analyzedArray = @[type, timeNumber, skipNumber];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringSetSpriteAlias] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPRITEALIAS
-        //
-        //  Assigns a filename to a particular sprite alias. Creates the that sprite alias if none exists.
-        //
-        //  Parameters:
-        //
-        //      #1: The sprite alias. (string)
-        //
-        //      #2: The filename to use. (string)
-        //
-        //  Example: .SETSPRITEALIAS:hero:harry.png
-        //
-        
-        NSString* aliasParameter = [command objectAtIndex:1];
-        NSString* filenameParameter = [command objectAtIndex:2];
-        
-        type = @VNScriptCommandSetSpriteAlias;
-        analyzedArray = @[type, aliasParameter, filenameParameter];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringSetSpeechbox] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SETSPEECHBOX
-        //
-        //  Dynamically switches to a different speechbox sprite.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of speechbox sprite to use (string)
-        //
-        //      #2: (OPTIONAL) Duration of transition, in seconds) (double)
-        //          (default is 0, which is instant)
-        //
-        //  Example: .SETSPEECHBOX:alternate_box.png:1.0
-        //
-        
-        // Set default values
-        NSString* duration = [NSString stringWithFormat:@"0"];
-        
-        // Overwrite any default values with any values that have been explicitly written into the script
-        if( command.count >= 3 )
-            duration = [command objectAtIndex:2]; // Optional, default value is 0
-        
-        type = @VNScriptCommandSetSpeechbox;
-        NSNumber* durationToUse = @([duration doubleValue]);
-        analyzedArray = @[type, parameter1, durationToUse];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringFlipSprite] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .FLIPSPRITE
-        //
-        //  Flips the sprite left/right or upside-down/right-side-up.
-        //
-        //  Parameters:
-        //
-        //      #1: Name of sprite (string)
-        //
-        //      #2: (OPTIONAL) Duration in seconds. Duration of zero is instantaneous. (double)
-        //
-        //      #3: (OPTIONAL) Whether to flip horizontally or not (BOOL)
-        //          (YES means horizontal flip, NO means vertical flip)
-        //
-        //  Example: .FLIPSPRITE:girl.png:0:YES
-        //
-        
-        // Set default values
-        NSString* duration = [NSString stringWithFormat:@"0"];
-        NSString* flipBool = [NSString stringWithFormat:@"YES"];
-        
-        // Overwrite any default values with any values that have been explicitly written into the script
-        if( command.count >= 3 )
-            duration = [command objectAtIndex:2];
-        if( command.count >= 4 )
-            flipBool = [command objectAtIndex:3]; // Optional, default value is 0
-        
-        type = @VNScriptCommandFlipSprite;
-        NSNumber* durationToUse = @([duration doubleValue]);
-        NSNumber* numberForFlip = @(flipBool.boolValue);
-        analyzedArray = @[type, parameter1, durationToUse, numberForFlip];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringRollDice] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .ROLLDICE
-        //
-        //  Rolls dice to get random result, stores value in a flag named DICEROLL. A flag (holding an integer value)
-        //  can be added as a "modifier." Whatever the value the flag has is added to the final result of the dice roll.
-        //
-        //  Parameters:
-        //
-        //      #1: Maximum value of roll; possible results = from 1 to (max value) (int)
-        //
-        //      #2: (OPTIONAL) Number of dice, default is 1 (int)
-        //
-        //      #3: (OPTIONAL) Name of flag, adds integer value in flag to final result (string)
-        //          (default is ".nil")
-        //
-        //  Example: .ROLLDICE:20:1:luck_modifier
-        //
-        
-        // set defaults
-        NSString* numberOfDice = @"1";
-        NSString* nameOfFlagModifier = VNScriptNilValue; // ".nil"
-        
-        if( command.count >= 3 )
-            numberOfDice = [command objectAtIndex:2];
-        if( command.count >= 4 )
-            nameOfFlagModifier = [command objectAtIndex:3];
-        
-        type = @VNScriptCommandRollDice;
-        NSNumber* maximumValueOfDice = @(parameter1.intValue);
-        NSNumber* diceNumberToUse = @(numberOfDice.intValue);
-        analyzedArray = @[type, maximumValueOfDice, diceNumberToUse, nameOfFlagModifier];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringModifyChoiceboxOffset] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .MODIFYCHOICEBOXOFFSET
-        //
-        //  Modifies button offsets during choices, in case you don't want them to show up in the middle of the screen.
-        //
-        //  Parameters:
-        //
-        //      #1: X coordinate (in points) (double)
-        //
-        //      #2: Y coordinate (in points) (double)
-        //
-        //  Example: .MODIFYCHOICEBOXOFFSET:10:10
-        //
-        
-        // Set default values
-        NSString* xOffset = [NSString stringWithFormat:@"0"];
-        NSString* yOffset = [NSString stringWithFormat:@"0"];
-        
-        // Overwrite any default values with any values that have been explicitly written into the script
-        if( command.count >= 2 )
-            xOffset = [command objectAtIndex:1];
-        if( command.count >= 3 )
-            yOffset = [command objectAtIndex:2];
-        
-        type = @VNScriptCommandModifyChoiceboxOffset;
-        NSNumber* xAsNumber = @(xOffset.doubleValue);
-        NSNumber* yAsNumber = @(yOffset.doubleValue);
-        analyzedArray = @[type, xAsNumber, yAsNumber];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringScaleBackground] == NSOrderedSame ) {
-        
-        // Function definition
-        //
-        //  Name: .SCALEBACKGROUND
-        //
-        //  Changes background scale (1.0 being the "normal" scale)
-        //
-        //  Parameters:
-        //
-        //      #1: Scale (double)
-        //
-        //      #2: (OPTIONAL) Duration in seconds; 0 results in instantaneous scaling (double)
-        //
-        //  Example: .SCALEBACKGROUND:2.5:1
-        //
-        
-        // Set default values
-        NSString* scaleValue    = [NSString stringWithFormat:@"1"];
-        NSString* durationValue = [NSString stringWithFormat:@"0"];
-        
-        // Overwrite any default values with any values that have been explicitly written into the script
-        if( command.count >= 2 )
-            scaleValue = [command objectAtIndex:1];
-        if( command.count >= 3 )
-            durationValue = [command objectAtIndex:2];
-        
-        type = @VNScriptCommandScaleBackground;
-        NSNumber* scaleNumber = @(scaleValue.doubleValue);
-        NSNumber* durationNumber = @(durationValue.doubleValue);
-        analyzedArray = @[type, scaleNumber, durationNumber];
-        
-    } else if( [action caseInsensitiveCompare:VNScriptStringScaleSprite] == NSOrderedSame ) {
+        VNScriptImageBuilderEndConversation(builder);
+    }
+    
+    size_t length = 0;
+    void* bytes = VNScriptImageBuilderCopyBytes(builder, &length);
+    VNScriptImageBuilderFree(builder);
+    
+    if( bytes == NULL )
+        return nil;
+    
+    return [[NSData alloc] initWithBytesNoCopy:bytes length:length freeWhenDone:YES];
+}
+
+// Compiles a .plist script file into a script image. This is meant to be run ahead of time (for example, from a
+// command-line tool or a debug build), and the resulting file added to the app bundle.
++ (BOOL)compileScriptFile:(NSString*)plistPath toFile:(NSString*)compiledPath
+{
+    VNScript* script = [[VNScript alloc] init];
+    
+    // Stream the script if possible (so that huge scripts can be compiled without huge amounts of memory)
+    if( [script prepareScriptFromFile:plistPath] == NO ) {
         
-        // Function definition
-        //
-        //  Name: .SCALESPRITE
-        //
-        //  Changes sprite scale (1.0 being the "normal" scale)
-        //
-        //  Parameters:
-        //
-        //      #1: Name of sprite (string)
-        //
-        //      #2: Scale (default is 1.0) (double)
-        //
-        //      #3: (OPTIONAL) Duration in seconds; 0 results in instantaneous scaling (double)
-        //
-        //  Example: .SCALESPRITE:girl.png:2:1.5
-        //
+        NSDictionary* loadedDictionary = [[NSDictionary alloc] initWithContentsOfFile:plistPath];
+        if( loadedDictionary == nil ) {
+            NSLog(@"[VNScript] ERROR: Could not load script for compiling: %@", plistPath);
+            return NO;
+        }
         
-        // Set default values
-        NSString* inputScale    = [NSString stringWithFormat:@"1"];
-        NSString* inputDuration = [NSString stringWithFormat:@"0"];
+        [script prepareScript:loadedDictionary];
+    }
+    
+    NSData* compiledData = [script compiledScriptData];
+    if( compiledData == nil || [compiledData writeToFile:compiledPath atomically:YES] == NO ) {
+        NSLog(@"[VNScript] ERROR: Could not write compiled script to: %@", compiledPath);
+        return NO;
+    }
+    
+    EKTraceInfo(EKTraceCategoryScript, "Compiled %s (%lu bytes)", [[plistPath lastPathComponent] UTF8String], (unsigned long)compiledData.length);
+    return YES;
+}
+
+#pragma mark - Script Translation
+
+// Gets the command type for an action string (such as ".addsprite") without creating any new string objects
+static int VNScriptCommandTypeForString(NSString* action)
+{
+    char buffer[VNScriptCommandLongestName + 1];
+    
+    if( [action getCString:buffer maxLength:sizeof(buffer) encoding:NSUTF8StringEncoding] == NO )
+        return VNScriptCommandUnknown; // Too long to be a command
+    
+    return VNScriptCommandTypeForName(buffer, strlen(buffer));
+}
+
+// Function definition
+//
+//  Name: NAME
+//
+//  DESCRIPTION
+//
+//  Parameters:
+//
+//      #1: PARAMETER1 (type)
+//
+//      #2: (OPTIONAL) Sprite appears at once? (Boolean value) (example: "NO") (default is NO)
+//          If set to YES, the sprite appears immediately (no fade-in). If set to NO, then the
+//          sprite "gradually" fades in (though the fade-in usually takes a second or less).
+//
+//  Example: EXAMPLE
+//
+
+- (id)analyzedCommand:(NSArray*)command
+{
+    NSArray* analyzedArray = nil;
+    NSNumber* type = nil;
+    
+    unichar firstCharacter = [[command objectAtIndex:0] characterAtIndex:0];
+    
+    // Check if this is really just a line of dialogue being spoken by a character/narrator. Since "real"
+    // commands always have two or more items in the array, AND start with a "." character, this is
+    // the easiest way to check.
+    if( command.count < 2 || firstCharacter != '.' ) {
         
-        // Overwrite any default values with any values that have been explicitly written into the script
-        if( command.count >= 3 )
-            inputScale = [command objectAtIndex:2];
-        if( command.count >= 4 )
-            inputDuration = [command objectAtIndex:3];
+        // Any time that a line of dialogue has colons, it will be treated as a command and split into
+        // different sections. However, it's possible that it really was just meant to be a regular
+        // line (and not a command), so it's sometimes necessary to take the different substrings and
+        // merge them back into one fixed string. This is kind of a cheap, hack-y way to do it, but
+        // it works.
+        NSMutableString* fixedString = [NSMutableString stringWithFormat:@"%@", [command objectAtIndex:0]];
+        if( firstCharacter != '.' && command.count > 1 ) {
+            
+            for( int part = 1; part < command.count; part++ ) {
+                
+                NSString* currentPart = [command objectAtIndex:part];
+                NSString* fixedSubString = [[NSString alloc] initWithFormat:@":%@", currentPart];
+                [fixedString appendString:fixedSubString];
+            }
+        }
         
-        type = @VNScriptCommandScaleSprite;
-        NSNumber* scaleNumber = @(inputScale.doubleValue);
-        NSNumber* durationNumber = @(inputDuration.doubleValue);
-        analyzedArray = @[type, parameter1, scaleNumber, durationNumber];
+        // Example: "Hi there"
+        type = @VNScriptCommandSayLine;
+        //analyzedArray = @[type, [command objectAtIndex:0]];
+        analyzedArray = @[type, fixedString];
+        return analyzedArray; // Return the data at once (instead of doing more processing)
     }
     
-    /** NEW COMMANDS ARE ADDED HERE **/
+    // Automatically prepare the action and parameter values. After all, pretty much every command has 
+    // an action string and a first parameter. It's only certain commands that have more parameters than that.
+    NSString* action = [command objectAtIndex:0];
+    NSString* parameter1 = [command objectAtIndex:1];
+    
+    // Look up the command type. This uses a hash table, so it takes the same amount of time no matter which command
+    // it is (instead of comparing the action against every known command, one after the other).
+    int commandType = VNScriptCommandTypeForString(action);
+    
+    // Now translate the parameters, based on which of the predetermined "commands" that this rather simple
+    // scripting language knows was found.
+    switch( commandType ) {
+            
+        case VNScriptCommandAddSprite: {
+            
+            // Function definition
+            //
+            //  Name: .ADDSPRITE
+            //
+            //  Uses Cocos2D to add a sprite to the screen. By default, the sprite usually appears right
+            //  at the center of the screen.
+            //
+            //  Parameters:
+            //
+            //      #1: Sprite name (string) (example: "girl.png")
+            //          Quite simply, the name of a file where the sprite is. Currently, the VN system doesn't
+            //          support sprite sheets, so it needs to be a single image in a single file.
+            //
+            //      #2: (OPTIONAL) Sprite appears at once? (Boolean value) (example: "NO") (default is NO)
+            //          If set to YES, the sprite appears immediately (no fade-in). If set to NO, then the
+            //          sprite "gradually" fades in (though the fade-in usually takes a second or less).
+            //
+            //  Example: .addsprite:girl.png:NO
+            //
+            
+            NSString* parameter2 = [NSString stringWithFormat:@"NO"]; // Set default value
+            
+            // If an existing command was already provided in the script, then overwrite the default one
+            // with the value found within the script.
+            if( command.count > 2 )
+                parameter2 = [command objectAtIndex:2];
+            
+            // Convert the second parameter to a Boolean value (stored as a Boolean NSNumber object)
+            BOOL appearAtOnce = [parameter2 boolValue];
+            NSNumber* appearParameter = @(appearAtOnce);
+            
+            type = @VNScriptCommandAddSprite;            
+            analyzedArray = @[type, parameter1, appearParameter];
+            
+        } break;
+            
+        case VNScriptCommandAlignSprite: {
+            
+            // Function definition
+            //
+            //  Name: .ALIGNSPRITE
+            //
+            //  Aligns a particular sprite in either the center, left, or right ends of the screen. This is done
+            //  by finding the center of the sprite and setting the X coordinate to either 25% of the screen's
+            //  width (on the iPhone 4S, this is 480*0.25 or 120), 50% (the middle), or 75% (the right).
+            //
+            //  There's also the Far Left (the left border of the screen), Far Right (the right border of the screen),
+            //  and Extreme Left and Extremem Right, which are so far that the sprite is drawn offscreen.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of sprite (string) (example: "girl.png")
+            //          This is the name of the sprite to manipulate/align. All sprites currently displayed by the
+            //          VN system are kept track of in the scene, so if the sprite exists onscreen, it'll be found.
+            //
+            //      #2: Alignment name (string) (example: "left") (default is "center")
+            //          Determines whether to move the sprite to the LEFT, CENTER, or RIGHT of the screen.
+            //          (Other, more unusual values also include FAR LEFT, FAR RIGHT, EXTREME LEFT, EXTREME RIGHT)
+            //          It has to be one of those values; partial/percentage values aren't supported.
+            //
+            //      #2: (OPTIONAL) Alignment duration in SECONDS (double value) (example: "0.5") (Default is 0.5)
+            //          Determines how long it takes for the sprite to move from its current position to the
+            //          new position. Setting it to zero makes the transition instant. Time is measured in seconds.
+            //
+            //  Example: .alignsprite:girl.png:center
+            //
+    	
+    		// Set default values
+            NSString* newAlignment = [NSString stringWithFormat:@"center"];
+            NSString* duration = [NSString stringWithFormat:@"0.5"];
+            
+            // Overwrite any default values with any values that have been explicitly written into the script
+            if( command.count >= 3 )
+                newAlignment = [command objectAtIndex:2]; // Parameter 2; should be either "left", "center", or "right"
+            if( command.count >= 4 )
+                duration = [command objectAtIndex:3]; // Optional, default value is 0.5
+                
+            type = @VNScriptCommandAlignSprite;
+            NSNumber* durationToUse = @([duration doubleValue]);
+            analyzedArray = @[type, parameter1, newAlignment, durationToUse];
+            
+        } break;
+            
+        case VNScriptCommandRemoveSprite: {
+            
+            // Function definition
+            //
+            //  Name: .REMOVESPRITE
+            //
+            //  Removes a sprite from the screen, assuming that it's part of the VN system's dictionary of
+            //  existing sprite objects.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of sprite (string) (example: "girl.png")
+            //          This is the name of the sprite to manipulate/align. All sprites currently displayed by the
+            //          VN system are kept track of in the scene, so if the sprite exists onscreen, it'll be found.
+            //
+            //      #2: (OPTIONAL) Sprite appears at once (Boolean value) (example: "NO") (Default is NO)
+            //          Determines whether the sprite disappears from the screen instantly or fades out gradually.
+            //
+            //  Example: .removesprite:girl.png:NO
+            //
+            
+            NSString* parameter2 = [NSString stringWithFormat:@"NO"]; // Default value
+            
+            if( command.count > 2 )
+                parameter2 = [command objectAtIndex:2]; // Overwrite default value with user-defined one, if it exists
+            
+            // Convert to Boolean NSNumber object
+            BOOL vanishAtOnce = [parameter2 boolValue];
+            NSNumber* vanishParameter = @(vanishAtOnce);
+            
+            // Example: .removesprite:bob:NO
+            type = @VNScriptCommandRemoveSprite;
+            analyzedArray = @[type, parameter1, vanishParameter];
+            
+        } break;
+            
+        case VNScriptCommandEffectMoveSprite: {
+            
+            // Function definition
+            //
+            //  Name: .MOVESPRITE
+            //
+            //  Uses Cocos2D actions to move a sprite by a certain number of points.
+            //
+            //  Parameters:
+            //
+            //   (note that all parameters after the first are TECHNICALLY optional, but if you use one,
+            //    you had better call the ones that come before it!)
+            //
+            //      #1: The name of the sprite to move (string) (example: "girl.png")
+            //
+            //      #2: Amount to move sprite by X points (float) (example: 128) (default is ZERO)
+            //
+            //      #3: Amount to move the sprite by Y points (float) (example: 256) (default is ZERO)
+            //
+            //      #4: Duration in seconds (float) (example: 0.5) (default is 0.5 seconds)
+            //          This measures how long it takes to move the sprite, in seconds.
+            //
+            //  Example: .movesprite:girl.png:128:-128:1.0
+            //
+            
+            // Set default values for extra parameters
+            NSString* xParameter = @"0";
+            NSString* yParameter = @"0";
+            NSString* durationParameter = @"0.5";
+            
+            // Overwrite default values with ones that exist in the script (assuming they exist, of course)
+            if( command.count > 2 ) xParameter = [command objectAtIndex:2];
+            if( command.count > 3 ) yParameter = [command objectAtIndex:3];
+            if( command.count > 4 ) durationParameter = [command objectAtIndex:4];
+            
+            // Convert parameters (which are NSStrings) to NSNumber values
+            NSNumber* moveByX = @([xParameter floatValue]);
+            NSNumber* moveByY = @([yParameter floatValue]);
+            NSNumber* duration = @([durationParameter doubleValue]);
+            
+            // syntax = command:sprite:xcoord:ycoord:duration
+            type = @VNScriptCommandEffectMoveSprite;
+            analyzedArray = @[type, parameter1, moveByX, moveByY, duration];
+            
+        } break;
+            
+        case VNScriptCommandEffectMoveBackground: {
+            
+            // Function definition
+            //
+            //  Name: .MOVEBACKGROUND
+            //
+            //  Uses Cocos2D actions to move the background by a certain number of points. This is normally used to
+            //  pan the background (along the X-axis), but you can move the background up and down as well. Character
+            //  sprites can also be moved along with the background, though usually at a slightly different rate;
+            //  the rate is referred to as the "parallax factor." A parallax factor of 1.0 means that the character
+            //  sprites move just as quickly as the background does, while a factor 0.0 means that the character
+            //  sprites do not move at all.
+            //
+            //  Parameters:
+            //
+            //      #1: Amount to move sprite by X points (float) (example: 128) (default is ZERO)
+            //
+            //      #2: Amount to move the sprite by Y points (float) (OPTIONAL) (example: 256) (default is ZERO)
+            //
+            //      #3: Duration in seconds (float) (OPTIONAL) (example: 0.5) (default is 0.5 seconds)
+            //          This measures how long it takes to move the sprite, in seconds.
+            //
+            //      #4: Parallax factor (float) (OPTIONAL) (example: 0.5) (default is 0.95)
+            //          The rate at which sprites move compared to the background. 1.00 means that the
+            //          sprites move at exactly the same rate as the background, while 0.00 means that
+            //          the sprites do not move at all. You'll probably want to set it something in between.
+            //
+            //  Example: .movebackground:100:0:1.0
+            //
+            
+            // Set default values for extra parameters
+            NSString* xParameter = @"0";
+            NSString* yParameter = @"0";
+            NSString* durationParameter = @"0.5";
+            NSString* parallaxFactor = @"0.95";
+            
+            // Overwrite default values with ones that exist in the script (assuming they exist, of course)
+            if( command.count > 1 ) xParameter = [command objectAtIndex:1];
+            if( command.count > 2 ) yParameter = [command objectAtIndex:2];
+            if( command.count > 3 ) durationParameter = [command objectAtIndex:3];
+            if( command.count > 4 ) parallaxFactor = [command objectAtIndex:4];
+            
+            // Convert parameters (which are NSStrings) to NSNumber values
+            NSNumber* moveByX = @([xParameter floatValue]);
+            NSNumber* moveByY = @([yParameter floatValue]);
+            NSNumber* duration = @([durationParameter doubleValue]);
+            NSNumber* parallaxing = @([parallaxFactor floatValue]);
+            
+            // syntax = command:xcoord:ycoord:duration:parallaxing
+            type = @VNScriptCommandEffectMoveBackground;
+            analyzedArray = @[type, moveByX, moveByY, duration, parallaxing];
+            
+        } break;
+            
+        case VNScriptCommandSetSpritePosition: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPRITEPOSITION
+            //
+            //  NOTE that unlike .MOVESPRITE, this call is instantaneous. I don't remember why I made it that
+            //  way (probably since sprites usually don't move instantly in most visual novels), but it's probably
+            //  best to keep things simple like that anyways.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the sprite (string) (example: "girl.png")
+            //
+            //      #2: The sprite's X coordinate, in points (float) (example: 10)
+            //
+            //      #3: The sprite's Y coordinate, in points (float) (example: 10)
+            //
+            //  Example: .setspriteposition:girl.png:100:100
+            //
+            
+            NSString* xParameter = @"0";
+            NSString* yParameter = @"0";
+            
+            if( command.count > 2 ) xParameter = [command objectAtIndex:2];
+            if( command.count > 3 ) yParameter = [command objectAtIndex:3];
+            
+            NSNumber* coordinateX = @([xParameter floatValue]);
+            NSNumber* coordinateY = @([yParameter floatValue]);
+            
+            type = @VNScriptCommandSetSpritePosition;
+            analyzedArray = @[type, parameter1, coordinateX, coordinateY];
+            
+        } break;
+            
+        case VNScriptCommandSetBackground: {
+            
+            // Function definition
+            //
+            //  Name: .SETBACKGROUND
+            //
+            //  Changes whatever image (if any) is used as the background. You can set this to 'nil' which removes
+            //  the background entirely, and shows whatever is behind. This is useful if you're overlaying the VN
+            //  scene over an existing Cocos2D layer/scene node.
+            //
+            //  Unlike some of the other image-switching commands, this one is supposed to do the change instantly.
+            //  It might be helpful to fade-out and then fade-in the scene during transistions so that the background
+            //  change isn't too jarring for the person playing the game.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the background image (string) (example: "beach.png")
+            //
+            //  Example: .setbackground:beach.png
+            
+            type = @VNScriptCommandSetBackground;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandSetSpeaker: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPEAKER
+            //
+            //  The "speaker name" is the title of the person speaking. If you set this to "nil" then it
+            //  removes whatever the previous speaker name was.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the character speaking (string) (example: "Harry Potter")
+            //
+            //  Example: .setspeaker:John Smith
+            //
+            
+            type = @VNScriptCommandSetSpeaker;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandChangeConversation: {
+            
+            // Function definition
+            //
+            //  Name: .SETCONVERSATION
+            //
+            //  This jumps to a new conversation. The beginning conversation name is "start" and the other
+            //  arrays in the script's Property List represent other conversations.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the conversation/array to switch to (string) (example: "flirt sequence")
+            //
+            //  Example: .setconversation:flirt sequence
+            // 
+
+            type = @VNScriptCommandChangeConversation;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandJumpOnChoice: {
+            
+            // Function definition
+            //
+            //  Name: .JUMPONCHOICE
+            //
+            //  This presents the player with multiple choices. Each choice causes the scene to jump to a different
+            //  "conversation" (or rather, an array in the script dictionary). The function can have multipe parameters,
+            //  but the number should always be even-numbered.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the first action (shows up on button when player decides) (string) (example: "Run away")
+            //
+            //      #2: The name of the conversation to jump to (string) (example: "fleeing sequence")
+            //
+            //      ...these variables can be repeated multiple times.
+            //
+            //  Example: .JUMPONCHOICE:"Hug someone":hug sequence:"Glomp someone":glomp sequence
+            //
+            
+            // Figure out how many choices there are
+            NSInteger numberOfChoices = (command.count - 1) / 2;
+            
+            // Check if there's not enough data
+            if( numberOfChoices < 1 || command.count < 3 ) 
+                return nil;
+            
+            // Create some arrays; one will hold the text that appears to the player, while the other will hold
+            // the names of the conversations/arrays that the script will switch to depending on the player's choice.
+            NSMutableArray* choiceText = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
+            NSMutableArray* destinations = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
+            
+            // After determining the number of choices that exist, use a loop to match each choice text with the
+            // name of the conversation that each choice would correspond to. Then add both to the appropriate arrays.
+            for( int i = 0; i < numberOfChoices; i++ ) {
+                
+                // This variable will hold 1 and then every odd number after. It starts at one because index "zero"
+                // is where the actual .JUMPONCHOICE string is stored.
+                int indexOfChoice = 1 + (2 * i);
+                
+                // Add choice data to the two separate arrays
+                [choiceText addObject:[command objectAtIndex:indexOfChoice]];
+                [destinations addObject:[command objectAtIndex:indexOfChoice+1]];
+            }
+            
+            type = @VNScriptCommandJumpOnChoice;
+            analyzedArray = @[type, choiceText, destinations];
+            
+        } break;
+            
+        case VNScriptCommandShowSpeechOrNot: {
+            
+            // Function definition
+            //
+            //  Name: .SHOWSPEECH
+            //
+            //  Determines whether or not to show the speech (and accompanying speech-box or speech-area). You
+            //  can set it to NO if you don't want any text to show up.
+            //
+            //  Parameters:
+            //
+            //      #1: Whether or not to show the speech box (Boolean)
+            //
+            //  Example: .SHOWSPEECH:NO
+            //
+            
+            // Convert parameter from NSString to a Boolean NSNumber
+            BOOL showParameter = [parameter1 boolValue];
+            NSNumber* parameterObject = @(showParameter);
+            
+            type = @VNScriptCommandShowSpeechOrNot;
+            analyzedArray = @[type, parameterObject];
+            
+        } break;
+            
+        case VNScriptCommandEffectFadeIn: {
+            
+            // Function definition
+            //
+            //  Name: .FADEIN
+            //
+            //  Uses Cocos2D to fade-out the VN scene's backgrounds and sprites... and nothing else (UI
+            //  elements like speech text are unaffected).
+            //
+            //  Parameters:
+            //
+            //      #1: Duration of fade-in sequence, in seconds (double)
+            //
+            //  Example: .FADEIN:0.5
+            //
+            
+            // Convert from NSString to NSNumber
+            double fadeDuration = [parameter1 doubleValue]; // NSString gets converted to a 'double' by this
+            NSNumber* durationObject = @(fadeDuration);
+            
+            type = @VNScriptCommandEffectFadeIn;
+            analyzedArray = @[type, durationObject];
+            
+        } break;
+            
+        case VNScriptCommandEffectFadeOut: {
+            
+            // Function definition
+            //
+            //  Name: .FADEOUT
+            //
+            //  Uses Cocos2D to fade-out the VN scene's backgrounds and sprites... and nothing else (UI
+            //  elements like speech text are unaffected).
+            //
+            //  Parameters:
+            //
+            //      #1: Duration of fade-out sequence, in seconds (double)
+            //
+            //  Example: .FADEOUT:1.0
+            //
+
+            double fadeDuration = [parameter1 doubleValue];
+            NSNumber* durationObject = @(fadeDuration);
+            
+            type = @VNScriptCommandEffectFadeOut;
+            analyzedArray = @[type, durationObject];
+            
+        } break;
+            
+        case VNScriptCommandPlaySound: {
+            
+            // Function definition
+            //
+            //  Name: .PLAYSOUND
+            //
+            //  Plays a sound (any type of sound file supported by Cocos2D/SimpleAudioEngine)
+            //
+            //  Parameters:
+            //
+            //      #1: name of sound file (string)
+            //
+            //  Example: .PLAYSOUND:effect1.caf
+            //
+            
+            type = @VNScriptCommandPlaySound;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandPlayMusic: {
+            
+            // Function definition
+            //
+            //  Name: .PLAYMUSIC
+            //
+            //  Plays background music. May or may not loop. You can also stop any background music
+            //  by calling this with the parameter set to "nil"
+            //
+            //  Parameters:
+            //
+            //      #1: name of music filename (string)
+            //          (you can write "nil" to stop all the music)
+            //
+            //      #2: (Optional) Should this loop forever? (BOOL value) (default is YES)
+            //
+            //  Example: .PLAYMUSIC:LevelUpper.mp3:NO
+            //
+            
+            NSString* parameter2 = @"YES"; // Loops forever by default
+            
+            // Check if there's already a user-specified value, in which case that would override the default value
+            if( command.count > 2 )
+                parameter2 = [command objectAtIndex:2];
+            
+            // Convert the second parameter to a Boolean NSNumber, since it was originally stored as a string
+            BOOL musicLoopsForever = [parameter2 boolValue];
+            NSNumber* loopParameter = @(musicLoopsForever);
+            
+            type = @VNScriptCommandPlayMusic;
+            analyzedArray = @[type, parameter1, loopParameter];
+            
+        } break;
+            
+        case VNScriptCommandSetFlag: {
+            
+            // Function definition
+            //
+            //  Name: .SETFLAG
+            //
+            //  Used to manually set a "flag" value in the VN system.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of flag (string)
+            //
+            //      #2: The value to set the flag to (integer)
+            //
+            //  Example: .SETFLAG:number of friends:12
+            //
+            
+            NSString* parameter2 = @"0"; // Default value
+            
+            if( command.count > 2 ) 
+                parameter2 = [command objectAtIndex:2];
+            
+            // Convert the second parameter to an NSNumber (it was originally an NSString)
+            NSNumber* value = @([parameter2 intValue]);
+            
+            type = @VNScriptCommandSetFlag;
+            analyzedArray = @[type, parameter1, value];
+            
+        } break;
+            
+        case VNScriptCommandModifyFlagValue: {
+            
+            // Function definition
+            //
+            //  Name: .MODIFYFLAG
+            //
+            //  Modifies a flag (which stores a numeric, integer value) by another integer. The catch is,
+            //  the modifying value has to be a "literal" number value, and not another flag/variable.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of the flag/variable to modify (string)
+            //
+            //      #2: The number to modify the flag by (integer)
+            //
+            //  Example: .MODIFYFLAG:number of friends:1
+            //
+            
+            NSString* parameter2 = @"0";
+            
+            if( command.count > 2 ) 
+                parameter2 = [command objectAtIndex:2];
+     
+            NSNumber* modifyWithValue = @([parameter2 intValue]); // Converts from string to Boolean NSNumber
+     
+            type = @VNScriptCommandModifyFlagValue;
+            analyzedArray = @[type, parameter1, modifyWithValue];
+            
+        } break;
+            
+        case VNScriptCommandIfFlagHasValue: {
+            
+            // Function definition
+            //
+            //  Name: .ISFLAG
+            //
+            //  Checks if a flag matches a certain value. If it does, then it immediately runs another command.
+            //  In theory, you could probably even nest .ISFLAG commands inside each other, but I've never tried
+            //  this before.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of flag (string)
+            //
+            //      #2: Expected value (integer)
+            //
+            //      #3: Another command
+            //
+            //  Example: .ISFLAG:number of friends:1:.SETSPEAKER:That One Friend You Have
+            //
+            
+            if( command.count < 4 )
+                return nil;
+            
+            NSString* variableName = [command objectAtIndex:1];
+            NSString* expectedValue = [command objectAtIndex:2];
+            NSInteger extraCount = command.count - 3; // This number = secondary command + secondary command's parameters
+            
+            if( variableName == nil || expectedValue == nil ) {
+                NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAG command");
+                return nil;
+            }
+            
+            // Now, here comes the hard part... the 3rd "parameter" (and all that follows) is actually a separate
+            // command that will get executed IF the variable contains the expected value. At this point, it's necessary to
+            // translate that extra command so it can be more easily run when the actual script gets run for real.
+            NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
+            
+            // This loop starts at the command index where the "secondary command" is and then goes through each
+            // parameter of the second command.
+            for( int i = 3; i < command.count; i++ ) {
+            
+                // Extract the secondary/"extra" command and put it in its own array
+                NSString* partOfCommand = [command objectAtIndex:i]; // 3rd parameter and everything afterwards
+                [extraCommand addObject:partOfCommand]; // Add that new data to the "extra command" array
+            }
+            
+            // Try to make sense of that secondary command... if it doesn't work out, then just give up on translating this line
+            NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
+            if( secondaryCommand == nil ) {
+                NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAG");
+                return nil;
+            }
+            
+            type = @VNScriptCommandIfFlagHasValue;
+            analyzedArray = @[type, variableName, expectedValue, secondaryCommand];
+            
+        } break;
+            
+        case VNScriptCommandIsFlagMoreThan: {
+            
+            // Function definition
+            //
+            //  Name: .ISFLAGMORETHAN
+            //
+            //  Checks if a flag's value is above a certain number. If it is, then a secondary command is run.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of flag (string)
+            //
+            //      #2: Certain number (integer)
+            //
+            //      #3: Another command
+            //
+            //  Example: .ISFLAGMORETHAN:power level:9000:.PLAYSOUND:over nine thousand.mp3
+            //
+            
+            if( command.count < 4 )
+                return nil;
+            
+            NSString* variableName = [command objectAtIndex:1];
+            NSString* expectedValue = [command objectAtIndex:2];
+            NSInteger extraCount = command.count - 3; // This number = secondary command + secondary command's parameters
+            
+            if( variableName == nil || expectedValue == nil ) {
+                NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAGMORETHAN command");
+                return nil;
+            }
+            
+            NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
+            
+            for( int i = 3; i < command.count; i++ ) {
+                NSString* partOfCommand = [command objectAtIndex:i];
+                [extraCommand addObject:partOfCommand];
+            }
+            
+            NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
+            if( secondaryCommand == nil ) {
+                NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAGMORETHAN");
+                return nil;
+            }
+            
+            type = @VNScriptCommandIsFlagMoreThan;
+            analyzedArray = @[type, variableName, expectedValue, secondaryCommand];
+            
+        } break;
+            
+        case VNScriptCommandIsFlagLessThan: {
+            
+            // Function definition
+            //
+            //  Name: .ISFLAGLESSTHAN
+            //
+            //  Checks if a flag's value is below a certain number. If it is, then a secondary command is run.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of flag (string)
+            //
+            //      #2: Certain number (integer)
+            //
+            //      #3: Another command
+            //
+            //  Example: .ISFLAGLESSTHAN:time remaining:0:.PLAYMUSIC:time's up.mp3
+            //
+            
+            if( command.count < 4 )
+                return nil;
+            
+            NSString* variableName = [command objectAtIndex:1];
+            NSString* expectedValue = [command objectAtIndex:2];
+            NSInteger extraCount = command.count - 3; // This number = secondary command + secondary command's parameters
+            
+            if( variableName == nil || expectedValue == nil ) {
+                NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAGLESSTHAN command");
+                return nil;
+            }
+            
+            NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
+            
+            for( int i = 3; i < command.count; i++ ) {
+                NSString* partOfCommand = [command objectAtIndex:i];
+                [extraCommand addObject:partOfCommand];
+            }
+            
+            NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
+            if( secondaryCommand == nil ) {
+                NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAGLESSTHAN");
+                return nil;
+            }
+            
+            type = @VNScriptCommandIsFlagLessThan;
+            analyzedArray = @[type, variableName, expectedValue, secondaryCommand];
+        
+        } break;
+            
+        case VNScriptCommandIsFlagBetween: {
+            
+            // Function definition
+            //
+            //  Name: .ISFLAGBETWEEN
+            //
+            //  Checks if a flag's value is between two numbers, and if it is, this will run another command.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of flag (string)
+            //
+            //      #2: First number (integer)
+            //
+            //      #3: Second number (integer)
+            //
+            //      #4: Another command
+            //
+            //  Example: .ISFLAGBETWEEN:number of cookies:1:3:YOU HAVE EXACTLY TWO COOKIES!
+            //
+            
+            if( command.count < 5 )
+                return nil;
+            
+            NSString* variableName  = [command objectAtIndex:1];
+            NSString* firstValue    = [command objectAtIndex:2];
+            NSString* secondValue   = [command objectAtIndex:3];
+            NSInteger extraCount    = command.count - 4; // This number = secondary command + secondary command's parameters
+            
+            if( variableName == nil || firstValue == nil || secondValue == nil ) {
+                NSLog(@"[VNScript] ERROR: Invalid variable name or value in .ISFLAGBETWEEN command");
+                return nil;
+            }
+            
+            // Figure out which value is the lesser value, and which one is the greater value. By default,
+            // it's assumed first value is the "lesser" value, and the second ond is the "greater" one
+            int first           = [firstValue intValue];
+            int second          = [secondValue intValue];
+            int lesserValue     = first;
+            int greaterValue    = second;
+            
+            // Check if the default value assignment is wrong. In this case, the second value is the lesser one,
+            // and that the first value is the greater one.
+            if( first > second ) {
+                // Reassign the values appropriately
+                greaterValue = first;
+                lesserValue = second;
+            }
+            
+            NSMutableArray* extraCommand = [[NSMutableArray alloc] initWithCapacity:extraCount];
+            
+            for( int i = 4; i < command.count; i++ ) {
+                NSString* partOfCommand = [command objectAtIndex:i];
+                [extraCommand addObject:partOfCommand];
+            }
+            
+            NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
+            if( secondaryCommand == nil ) {
+                NSLog(@"[VNScript] ERROR: Could not translate secondary command of .ISFLAGBETWEEN");
+                return nil;
+            }
+            
+            // Convert greater/lesser scalar values back into NSString format for the script
+            NSString* lesserValueString = [NSString stringWithFormat:@"%d", lesserValue];
+            NSString* greaterValueString = [NSString stringWithFormat:@"%d", greaterValue];
+            
+            type = @VNScriptCommandIsFlagBetween;
+            analyzedArray = @[type, variableName, lesserValueString, greaterValueString, secondaryCommand];
+            
+        } break;
+            
+        case VNScriptCommandModifyFlagOnChoice: {
+            
+            // Function definition
+            //
+            //  Name: .MODIFYFLAGBYCHOICE
+            //
+            //  This presents a choice menu. Each choice causes a particular flag/variable to be changed
+            //  by a particular integer value.
+            //
+            //  Parameters:
+            //
+            //      #1: The text that will appear on the choice (string)
+            //
+            //      #2: The name of the flag/variable to be modified (string)
+            //
+            //      #3: The amount to modify the flag/variable by (integer)
+            //
+            //      ...these variables can be repeated multiple times.
+            //
+            //  Example: .MODIFYFLAGBYCHOICE:"Be nice":niceness:1:"Be rude":niceness:-1
+            //
+            
+            // Since the first item in the command array is the ".MODIFYFLAG" string, we'll just ignore that first index
+            // when counting the number of choices. Also, since each set of parameters consists of three parts (choice text,
+            // variable name, and variable value), the number will be divided by three to get the actual number of choices.
+            NSInteger numberOfChoices = (command.count - 1) / 3;
+            
+            // Create some empty mutable arrays
+            NSMutableArray* choiceText = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
+            NSMutableArray* variableNames = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
+            NSMutableArray* variableValues = [[NSMutableArray alloc] initWithCapacity:numberOfChoices];
+            
+            for( int i = 0; i < numberOfChoices; i++ ) {
+            
+            	// This is used as an offset in order to get the right index numbers for the 'command' array.
+            	// It starts at 1 and then jumps to every third number thereafter (from 1 to 4, 7, 10, 13, etc).    
+                int nameIndex = 1 + (i * 3);
+                
+                // Get the parameters for the command array
+                NSString* text = [command objectAtIndex:nameIndex]; // Text to show to player
+                NSString* name = [command objectAtIndex:nameIndex+1]; // The name of the flag to modify
+                NSString* check = [command objectAtIndex:nameIndex+2]; // The amount to modify the flag by
+                
+                // Move each value to the appropriate array
+                [choiceText addObject:text];
+                [variableNames addObject:name];
+                [variableValues addObject:check];
+            }
+            
+            type = @VNScriptCommandModifyFlagOnChoice;
+            analyzedArray = @[type, choiceText, variableNames, variableValues];
+            
+        } break;
+            
+        case VNScriptCommandJumpOnFlag: {
+            
+            // Function definition
+            //
+            //  Name: .JUMPONFLAG
+            //
+            //  If a particular flag has a particular value, then this command will jump to a different
+            //  conversation/dialogue-sequence in the script.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the flag to be checked (string)
+            //
+            //      #2: The expected value of the flag (integer)
+            //
+            //      #3: The scene to jump to, if the flag's vaue matches the expected value in parameter #2 (string)
+            //
+            //  Example: .JUMPONFLAG:should jump to beach scene:1:BeachScene
+            //
+            
+            if( command.count < 4 )
+                return nil;
+            
+            NSString* variableName = [command objectAtIndex:1];
+            NSString* expectedValue = [command objectAtIndex:2];
+            NSString* newLocation = [command objectAtIndex:3];
+            
+            if( variableName == nil || expectedValue == nil || newLocation == nil ) {
+                NSLog(@"[VNScript] ERROR: Invalid parameters passed to .JUMPONFLAG command.");
+                return nil;
+            }
+            
+            type = @VNScriptCommandJumpOnFlag;
+            analyzedArray = @[type, variableName, expectedValue, newLocation];
+            
+        } break;
+            
+        case VNScriptCommandSystemCall: {
+            
+            // Function definition
+            //
+            //  Name: .SYSTEMCALL
+            //
+            //  Used to do a "system call," which is usually game-specific. This command will try to contact the
+            //  VNSystemCall class, and use it to perform some kind of particular task. Some examples of this would
+            //  be starting a mini-game or some other activity that's specific to a particular app.
+            //
+            //  Parameters:
+            //
+            //      #1: The "call string" or a string that described what the activity/system-call type will be (string)
+            //
+            //      #2: (OPTIONAL) The first parameter to pass in to the system call (string?)
+            //
+            //      ...more parameters can be passed in as necessary
+            //
+            //  Example: .SYSTEMCALL:start-bullet-hell-minigame:BulletHellLevel01
+            //
+            
+            if( command.count < 1 )
+                return nil;
+            
+            NSString* callString = [command objectAtIndex:1]; // Extract the call string
+            
+            NSMutableArray* extraParameters = [NSMutableArray arrayWithArray:command];
+            [extraParameters removeObjectAtIndex:1]; // Remove call type
+            [extraParameters removeObjectAtIndex:0]; // Remove command
+            
+            // Add a dummy parameter just for the heck of it
+            if( extraParameters.count < 1 )
+                [extraParameters addObject:@"nil"];
+            
+            type = @VNScriptCommandSystemCall;
+            analyzedArray = @[type, callString, extraParameters];
+            
+        } break;
+            
+        /*
+           
+           NOTE: CALLCODE has been disabled because it was a bad idea; it's better to just use SYSTEMCALL for
+                 any unusual game-specific functionality.
+           
+        case VNScriptCommandCallCode: {
+            
+            // Function definition
+            //
+            //  Name: .CALLCODE
+            //
+            //  This action can be used to call functions (usually from static objects). Careful when using it to
+            //  call classes or functions that the VN system doesn't have access to! You may need to include header
+            //  files from certain places if you really want to use certain classes.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the class to call (string)
+            //
+            //      #2: The name of a static function to call (string)
+            //
+            //		#3: (OPTIONAL) The name of another function, PRESUMABLY a function that belongs to the class
+            //			instance that was returned by the function called in #2 (string)
+            //
+            //		#4: (OPTIONAL) A parameter to pass into the function called in #3 (string?)
+            //
+            //  Example: .CALLCODE:EKRecord:sharedRecord:flagNamed:times played
+            //
+            
+            if( command.count < 3 )
+                return nil;
+            
+            // At this point, you'll need an array that has all the things needed to call a particular class,
+            // as well as class functions. The first string in the array will be the class, the second will be
+            // a "shared object" static function, and if a third string exists, it will call a particular
+            // function in that class. If there are any more strings, they will be parameters. For example:
+            //
+            //  callingArray[0] = EKRecord
+            //  callingArray[1] = sharedRecord
+            //  callingArray[2] = flagNamed
+            //  callingArray[3] = times played
+            //
+            // ...which would come out something like --> [[EKRecord sharedRecord] flagNamed:@"times played"];
+            //
+            NSMutableArray* callingArray = [NSMutableArray arrayWithArray:command];
+            [callingArray removeObjectAtIndex:0]; // Removes the string ".callcode"
+            
+            type = @VNScriptCommandCallCode;
+            analyzedArray = @[type, callingArray];
+        } break; */
+            
+        case VNScriptCommandSwitchScript: {
+            
+            // Function definition
+            //
+            //  Name: .SWITCHSCRIPT
+            //
+            //  Replaces a scene's script with a script loaded from another .PLIST file. This is useful if you're
+            //  using multiple .PLIST files.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the .PLIST file to load (string)
+            //
+            //      #2: (OPTIONAL) The name of the "conversation"/array to start at to (string) (default is "start")
+            //
+            //  Example: .SWITCHSCRIPT:script number 2:Some Random Event
+            //
+            
+            if( command.count < 2 )
+                return nil;
+            
+            NSString* scriptName = [command objectAtIndex:1];
+            NSString* startingPoint = VNScriptStartingPoint; // Default value
+            
+            // Check if the script name is missing
+            if( scriptName == nil )
+                return nil;
+
+            // Load non-default starting point (if it exists)
+            if( command.count > 2 ) {
+                startingPoint = [command objectAtIndex:2];
+            }
+            
+            type = @VNScriptCommandSwitchScript;
+            analyzedArray = @[type, scriptName, startingPoint];
+        } break;
+            
+        case VNScriptCommandSetSpeakerFont: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPEAKERFONT
+            //
+            //  Replaces the current font used by the "speaker name" label with another font.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the font to use (string)
+            //
+            //  Example: .SETSPEAKERFONT:Helvetica
+            //
+            
+            type = @VNScriptCommandSetSpeakerFont;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandSetSpeakerFontSize: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPEAKERFONTSIZE
+            //
+            //  Changes the font size used by the "speaker name" label.
+            //
+            //  Parameters:
+            //
+            //      #1: Font size (float)
+            //
+            //  Example: .SETSPEAKERFONTSIZE:17.0
+            //
+            
+            type = @VNScriptCommandSetSpeakerFontSize;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandSetSpeechFont: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPEECHFONT
+            //
+            //  Replaces the current font used by the speech/dialogue label with another font.
+            //
+            //  Parameters:
+            //
+            //      #1: The name of the font to use (string)
+            //
+            //  Example: .SETSPEECHFONT:Courier New
+            //
+            
+            type = @VNScriptCommandSetSpeechFont;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandSetSpeechFontSize: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPEECHFONTSIZE
+            //
+            //  Changes the speech/dialogue font size.
+            //
+            //  Parameters:
+            //
+            //      #1: Font size (float)
+            //
+            //  Example: .SETSPEECHFONTSIZE:18.0
+            //
+            
+            type = @VNScriptCommandSetSpeechFontSize;
+            analyzedArray = @[type, parameter1];
+            
+        } break;
+            
+        case VNScriptCommandSetTypewriterText: {
+            
+            // Function definition
+            //
+            //  Name: .SETTYPEWRITERTEXT
+            //
+            //  Sets or disables "typewriter text" mode, in which each character of text/dialogue appears
+            //  one at a time (though usually still very quickly).
+            //
+            //  Parameters:
+            //
+            //      #1: How many characters it should print per second (Integer)
+            //          (setting this to zero disables typewriter text mode)
+            //
+            //      #2: (OPTIONAL) Whether the user can still skip ahead by tapping the screen (BOOL)
+            //          (default value is NO)
+            //
+            //  Example: .SETTYPEWRITERTEXT:30:NO
+            //
+            
+            NSString* defaultSkipString = @"NO";
+            
+            int textSpeed = parameter1.intValue;
+            NSNumber* timeNumber = [NSNumber numberWithInt:textSpeed];
+            
+            BOOL canSkip = [defaultSkipString boolValue]; // Use default value first
+            if( command.count > 2 ) {
+                canSkip = [[command objectAtIndex:2] boolValue]; // Use custom value if it exists
+            }
+            
+            NSNumber* skipNumber = [NSNumber numberWithBool:canSkip];
+            
+            type = @VNScriptCommandSetTypewriterText;
+            analyzedArray = @[type, timeNumber, skipNumber];
+            
+        } break;
+            
+        case VNScriptCommandSetSpriteAlias: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPRITEALIAS
+            //
+            //  Assigns a filename to a particular sprite alias. Creates the that sprite alias if none exists.
+            //
+            //  Parameters:
+            //
+            //      #1: The sprite alias. (string)
+            //
+            //      #2: The filename to use. (string)
+            //
+            //  Example: .SETSPRITEALIAS:hero:harry.png
+            //
+            
+            NSString* aliasParameter = [command objectAtIndex:1];
+            NSString* filenameParameter = [command objectAtIndex:2];
+            
+            type = @VNScriptCommandSetSpriteAlias;
+            analyzedArray = @[type, aliasParameter, filenameParameter];
+            
+        } break;
+            
+        case VNScriptCommandSetSpeechbox: {
+            
+            // Function definition
+            //
+            //  Name: .SETSPEECHBOX
+            //
+            //  Dynamically switches to a different speechbox sprite.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of speechbox sprite to use (string)
+            //
+            //      #2: (OPTIONAL) Duration of transition, in seconds) (double)
+            //          (default is 0, which is instant)
+            //
+            //  Example: .SETSPEECHBOX:alternate_box.png:1.0
+            //
+            
+            // Set default values
+            NSString* duration = [NSString stringWithFormat:@"0"];
+            
+            // Overwrite any default values with any values that have been explicitly written into the script
+            if( command.count >= 3 )
+                duration = [command objectAtIndex:2]; // Optional, default value is 0
+            
+            type = @VNScriptCommandSetSpeechbox;
+            NSNumber* durationToUse = @([duration doubleValue]);
+            analyzedArray = @[type, parameter1, durationToUse];
+            
+        } break;
+            
+        case VNScriptCommandFlipSprite: {
+            
+            // Function definition
+            //
+            //  Name: .FLIPSPRITE
+            //
+            //  Flips the sprite left/right or upside-down/right-side-up.
+            //
+            //  Parameters:
+            //
+            //      #1: Name of sprite (string)
+            //
+            //      #2: (OPTIONAL) Duration in seconds. Duration of zero is instantaneous. (double)
+            //
+            //      #3: (OPTIONAL) Whether to flip horizontally or not (BOOL)
+            //          (YES means horizontal flip, NO means vertical flip)
+            //
+            //  Example: .FLIPSPRITE:girl.png:0:YES
+            //
+            
+            // Set default values
+            NSString* duration = [NSString stringWithFormat:@"0"];
+            NSString* flipBool = [NSString stringWithFormat:@"YES"];
+            
+            // Overwrite any default values with any values that have been explicitly written into the script
+            if( command.count >= 3 )
+                duration = [command objectAtIndex:2];
+            if( command.count >= 4 )
+                flipBool = [command objectAtIndex:3]; // Optional, default value is 0
+            
+            type = @VNScriptCommandFlipSprite;
+            NSNumber* durationToUse = @([duration doubleValue]);
+            NSNumber* numberForFlip = @(flipBool.boolValue);
+            analyzedArray = @[type, parameter1, durationToUse, numberForFlip];
+            
+        } break;
+            
+        case VNScriptCommandRollDice: {
+            
+            // Function definition
+            //
+            //  Name: .ROLLDICE
+            //
+            //  Rolls dice to get random result, stores value in a flag named DICEROLL. A flag (holding an integer value)
+            //  can be added as a "modifier." Whatever the value the flag has is added to the final result of the dice roll.
+            //
+            //  Parameters:
+            //
+            //      #1: Maximum value of roll; possible results = from 1 to (max value) (int)
+            //
+            //      #2: (OPTIONAL) Number of dice, default is 1 (int)
+            //
+            //      #3: (OPTIONAL) Name of flag, adds integer value in flag to final result (string)
+            //          (default is ".nil")
+            //
+            //  Example: .ROLLDICE:20:1:luck_modifier
+            //
+            
+            // set defaults
+            NSString* numberOfDice = @"1";
+            NSString* nameOfFlagModifier = VNScriptNilValue; // ".nil"
+            
+            if( command.count >= 3 )
+                numberOfDice = [command objectAtIndex:2];
+            if( command.count >= 4 )
+                nameOfFlagModifier = [command objectAtIndex:3];
+            
+            type = @VNScriptCommandRollDice;
+            NSNumber* maximumValueOfDice = @(parameter1.intValue);
+            NSNumber* diceNumberToUse = @(numberOfDice.intValue);
+            analyzedArray = @[type, maximumValueOfDice, diceNumberToUse, nameOfFlagModifier];
+            
+        } break;
+            
+        case VNScriptCommandModifyChoiceboxOffset: {
+            
+            // Function definition
+            //
+            //  Name: .MODIFYCHOICEBOXOFFSET
+            //
+            //  Modifies button offsets during choices, in case you don't want them to show up in the middle of the screen.
+            //
+            //  Parameters:
+            //
+            //      #1: X coordinate (in points) (double)
+            //
+            //      #2: Y coordinate (in points) (double)
+            //
+            //  Example: .MODIFYCHOICEBOXOFFSET:10:10
+            //
+            
+            // Set default values
+            NSString* xOffset = [NSString stringWithFormat:@"0"];
+            NSString* yOffset = [NSString stringWithFormat:@"0"];
+            
+            // Overwrite any default values with any values that have been explicitly written into the script
+            if( command.count >= 2 )
+                xOffset = [command objectAtIndex:1];
+            if( command.count >= 3 )
+                yOffset = [command objectAtIndex:2];
+            
+            type = @VNScriptCommandModifyChoiceboxOffset;
+            NSNumber* xAsNumber = @(xOffset.doubleValue);
+            NSNumber* yAsNumber = @(yOffset.doubleValue);
+            analyzedArray = @[type, xAsNumber, yAsNumber];
+            
+        } break;
+            
+        case VNScriptCommandScaleBackground: {
+            
+            // Function definition
+            //
+            //  Name: .SCALEBACKGROUND
+            //
+            //  Changes background scale (1.0 being the "normal" scale)
+            //
+            //  Parameters:
+            //
+            //      #1: Scale (double)
+            //
+            //      #2: (OPTIONAL) Duration in seconds; 0 results in instantaneous scaling (double)
+            //
+            //  Example: .SCALEBACKGROUND:2.5:1
+            //
+            
+            // Set default values
+            NSString* scaleValue    = [NSString stringWithFormat:@"1"];
+            NSString* durationValue = [NSString stringWithFormat:@"0"];
+            
+            // Overwrite any default values with any values that have been explicitly written into the script
+            if( command.count >= 2 )
+                scaleValue = [command objectAtIndex:1];
+            if( command.count >= 3 )
+                durationValue = [command objectAtIndex:2];
+            
+            type = @VNScriptCommandScaleBackground;
+            NSNumber* scaleNumber = @(scaleValue.doubleValue);
+            NSNumber* durationNumber = @(durationValue.doubleValue);
+            analyzedArray = @[type, scaleNumber, durationNumber];
+            
+        } break;
+            
+        case VNScriptCommandScaleSprite: {
+            
+            // Function definition
+            //
+            //  Name: .SCALESPRITE
+            //
+            //  Changes sprite scale (1.0 being the "normal" scale)
+            //
+            //  Parameters:
+            //
+            //      #1: Name of sprite (string)
+            //
+            //      #2: Scale (default is 1.0) (double)
+            //
+            //      #3: (OPTIONAL) Duration in seconds; 0 results in instantaneous scaling (double)
+            //
+            //  Example: .SCALESPRITE:girl.png:2:1.5
+            //
+            
+            // Set default values
+            NSString* inputScale    = [NSString stringWithFormat:@"1"];
+            NSString* inputDuration = [NSString stringWithFormat:@"0"];
+            
+            // Overwrite any default values with any values that have been explicitly written into the script
+            if( command.count >= 3 )
+                inputScale = [command objectAtIndex:2];
+            if( command.count >= 4 )
+                inputDuration = [command objectAtIndex:3];
+            
+            type = @VNScriptCommandScaleSprite;
+            NSNumber* scaleNumber = @(inputScale.doubleValue);
+            NSNumber* durationNumber = @(inputDuration.doubleValue);
+            analyzedArray = @[type, parameter1, scaleNumber, durationNumber];
+        } break;
+            
+        case VNScriptCommandIf: {
+            
+            // Function definition
+            //
+            //  Name: .IF
+            //
+            //  Checks if a condition is true, and if it is, runs another command. The condition can use numbers, flags,
+            //  math, comparisons, and the && / || / ! operators (see VNScriptExpression.h for all the details). Flag names
+            //  with spaces in them go inside of square brackets. This does the same job as the .ISFLAG family of commands,
+            //  except that several checks can be combined into a single line.
+            //
+            //  Parameters:
+            //
+            //      #1: The condition (string)
+            //
+            //      #2: Another command
+            //
+            //  Example: .IF:gold >= 10 && ([times visited] > 2 || chapter == 3):.SETCONVERSATION:shop
+            //
+            
+            if( command.count < 3 )
+                return nil;
+            
+            NSString* condition = [command objectAtIndex:1];
+            
+            // Make sure that the condition actually makes sense. (It gets compiled again when the script is linked,
+            // since that's when the flag names can be turned into flag slots.)
+            NSData* conditionText = [condition dataUsingEncoding:NSUTF8StringEncoding];
+            char error[VNScriptExpressionErrorLength];
+            VNScriptExpression* expression = VNScriptExpressionCompile(conditionText.bytes, conditionText.length, NULL, NULL, error, sizeof(error));
+            if( expression == NULL ) {
+                NSLog(@"[VNScript] ERROR: Invalid condition in .IF command [%@]: %s", condition, error);
+                return nil;
+            }
+            VNScriptExpressionFree(expression);
+            
+            NSArray* extraCommand = [command subarrayWithRange:NSMakeRange(2, command.count - 2)];
+            NSArray* secondaryCommand = [self analyzedCommand:extraCommand];
+            if( secondaryCommand == nil ) {
+                NSLog(@"[VNScript] ERROR: Could not translate secondary command of .IF");
+                return nil;
+            }
+            
+            type = @VNScriptCommandIf;
+            analyzedArray = @[type, condition, secondaryCommand];
+            
+        } break;
+            
+        /** NEW COMMANDS ARE ADDED HERE **/
+            
+        default:
+            break; // Unknown commands aren't translated (and get left out of the conversation)
+    }
     
     return analyzedArray;
 }
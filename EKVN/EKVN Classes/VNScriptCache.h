@@ -0,0 +1,80 @@
+//
+//  VNScriptCache.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNScriptCache
+
+ Keeps translated scripts around so that they can be shared by every VNScript that uses the same file. Without it,
+ every .SWITCHSCRIPT command (and every new or loaded game) creates a brand new VNScript, which means reading the
+ whole .plist file and translating it all over again, even if that exact script was in use a moment ago. With it,
+ the file only gets translated once; after that, creating a VNScript just means pointing at the translated data
+ that's already in memory, and each VNScript only keeps track of where it is in the script (the current
+ conversation and indexes).
+
+ Scripts are looked up by filename AND by a hash of the file's contents, so if a script file changes (while testing,
+ for example), the new version gets loaded instead of the old one. Files are only hashed again if their size or
+ modification date change, so looking up a script that's already in the cache doesn't read the file.
+
+ Scripts that are going to be needed soon (like the one that the next chapter switches to) can be preloaded on a
+ background thread, so that they're ready by the time the game actually needs them:
+
+   [[VNScriptCache sharedCache] preloadScriptsNamed:@[@"chapter 2"]];
+
+ VNScript only uses a script from the cache if it's already there. On a miss, the new VNScript loads its own copy
+ of the script lazily (so only the conversations that actually get used are translated, and the main thread never
+ waits for an entire script), and the script is preloaded in the background so that the next VNScript for that file
+ can share it. If 'scriptNamed' is called while a script is still being preloaded, it waits for the preload to finish
+ instead of translating the script a second time. Everything here can be called from any thread.
+
+ */
+
+#import <Foundation/Foundation.h>
+
+@class VNScript;
+
+#pragma mark - Definitions
+
+#define VNScriptCacheDefaultBudget      (32 * 1024 * 1024) // Size (in bytes) of the translated scripts the cache holds on to
+
+#pragma mark - VNScriptCache
+
+@interface VNScriptCache : NSObject
+
++ (VNScriptCache*)sharedCache;
+
+// When this is NO, VNScript loads every script from scratch (the way it used to). The default is YES.
+@property (atomic) BOOL enabled;
+
+// The cache uses up to this much memory. Scripts that haven't been used recently may be thrown out to stay under the
+// budget (or when the system is low on memory), in which case they just get loaded again the next time they're needed.
+@property (nonatomic) NSUInteger budget;
+
+// Counters, mostly for checking that the cache is actually doing something. Preloads aren't counted.
+@property (atomic, readonly) NSUInteger hitCount;
+@property (atomic, readonly) NSUInteger missCount;
+
+// Returns the fully-translated (and linked) script for a file, loading it first if it isn't already in the cache.
+// Returns nil if the script couldn't be loaded. The returned script should be treated as read-only; VNScript uses it
+// as a template, and shares its data with new scripts (see 'initFromFile'). Translating a whole script can take a
+// while, so this is meant for background threads.
+- (VNScript*)scriptNamed:(NSString*)nameOfFile;
+
+// Returns the script only if it's already in the cache; nothing gets loaded, and nothing waits on a preload that's
+// still running. This is what 'initFromFile' uses, since it runs on the main thread.
+- (VNScript*)cachedScriptNamed:(NSString*)nameOfFile;
+
+// Checks whether the current version of a script is already in the cache (without loading it)
+- (BOOL)hasScriptNamed:(NSString*)nameOfFile;
+
+// Loads scripts into the cache on a background thread. The completion block (which is optional) gets called on the
+// main thread once every script has been loaded.
+- (void)preloadScriptsNamed:(NSArray*)names;
+- (void)preloadScriptsNamed:(NSArray*)names completion:(void (^)(void))completion;
+
+- (void)removeAllScripts;
+
+@end
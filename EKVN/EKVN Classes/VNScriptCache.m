@@ -0,0 +1,263 @@
+//
+//  VNScriptCache.m
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#import "VNScriptCache.h"
+#import "VNScript.h"
+#import "EKTrace.h"
+
+#include <stdio.h>
+
+#define VNScriptCacheHashBufferSize     (64 * 1024)
+
+// 64-bit FNV-1a hash of everything in a file (or zero if the file can't be read)
+static uint64_t VNScriptCacheHashFile(NSString* path)
+{
+    FILE* file = fopen([path fileSystemRepresentation], "rb");
+    if( file == NULL )
+        return 0;
+
+    uint8_t* buffer = malloc(VNScriptCacheHashBufferSize);
+    if( buffer == NULL ) {
+        fclose(file);
+        return 0;
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    size_t length = 0;
+
+    while( (length = fread(buffer, 1, VNScriptCacheHashBufferSize, file)) > 0 ) {
+        for( size_t i = 0; i < length; i++ ) {
+            hash ^= buffer[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    free(buffer);
+    fclose(file);
+
+    return hash;
+}
+
+@implementation VNScriptCache
+{
+    NSCache* scripts;                   // Cache key -> translated VNScript
+    NSMutableDictionary* fingerprints;  // File path -> @[size, modification date, content hash]
+    NSMutableDictionary* loadLocks;     // Cache key -> NSLock (held while that script is being loaded)
+    dispatch_queue_t preloadQueue;
+}
+
++ (VNScriptCache*)sharedCache
+{
+    static dispatch_once_t pred = 0;
+    __strong static id _sharedObject = nil;
+    dispatch_once(&pred, ^{
+        _sharedObject = [[VNScriptCache alloc] init];
+    });
+    return _sharedObject;
+}
+
+- (id)init
+{
+    if( (self = [super init]) ) {
+
+        scripts = [[NSCache alloc] init];
+        scripts.name = @"VNScriptCache";
+        scripts.totalCostLimit = VNScriptCacheDefaultBudget;
+
+        fingerprints = [[NSMutableDictionary alloc] init];
+        loadLocks = [[NSMutableDictionary alloc] init];
+
+        // Preloading is for scripts that the player is about to need, so it shouldn't be put off for too long
+        dispatch_queue_attr_t attributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0);
+        preloadQueue = dispatch_queue_create("VNScriptCache preload", attributes);
+
+        _enabled = YES;
+        _budget = VNScriptCacheDefaultBudget;
+    }
+
+    return self;
+}
+
+- (void)setBudget:(NSUInteger)budget
+{
+    _budget = budget;
+    scripts.totalCostLimit = budget;
+}
+
+#pragma mark - Keys
+
+// The key is the script's name plus a hash of whichever file the script is going to be loaded from. Returns nil if
+// the script file doesn't exist.
+- (NSString*)keyForScriptNamed:(NSString*)nameOfFile
+{
+    NSString* path = [VNScript pathForScriptNamed:nameOfFile];
+    if( path == nil )
+        return nil;
+
+    NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+    if( attributes == nil )
+        return nil;
+
+    NSNumber* size = @([attributes fileSize]);
+    NSDate* modificationDate = [attributes fileModificationDate];
+    if( modificationDate == nil )
+        modificationDate = [NSDate distantPast];
+
+    // The file only needs to be hashed again if it looks like it's changed
+    NSNumber* hash = nil;
+    @synchronized( fingerprints ) {
+        NSArray* fingerprint = [fingerprints objectForKey:path];
+        if( fingerprint != nil && [[fingerprint objectAtIndex:0] isEqualToNumber:size] && [[fingerprint objectAtIndex:1] isEqualToDate:modificationDate] )
+            hash = [fingerprint objectAtIndex:2];
+    }
+
+    // This happens outside of the lock, since reading a big file can take a while
+    if( hash == nil ) {
+        hash = @(VNScriptCacheHashFile(path));
+
+        @synchronized( fingerprints ) {
+            [fingerprints setObject:@[size, modificationDate, hash] forKey:path];
+        }
+    }
+
+    return [NSString stringWithFormat:@"%@#%016llx", nameOfFile, [hash unsignedLongLongValue]];
+}
+
+- (NSLock*)lockForKey:(NSString*)key
+{
+    @synchronized( loadLocks ) {
+
+        NSLock* lock = [loadLocks objectForKey:key];
+        if( lock == nil ) {
+            lock = [[NSLock alloc] init];
+            [loadLocks setObject:lock forKey:key];
+        }
+
+        return lock;
+    }
+}
+
+#pragma mark - Scripts
+
+// Translates the entire script and adds it to the cache, unless it's already there. This doesn't touch the counters.
+- (VNScript*)loadScriptNamed:(NSString*)nameOfFile forKey:(NSString*)key
+{
+    VNScript* script = [scripts objectForKey:key];
+    if( script != nil )
+        return script;
+
+    // Only one thread loads any particular script; anything else that wants the same script waits here until it's ready
+    NSLock* lock = [self lockForKey:key];
+    [lock lock];
+
+    script = [scripts objectForKey:key];
+    if( script == nil ) {
+
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+
+        script = [[VNScript alloc] init];
+        script.filename = nameOfFile;
+
+        if( [script loadScriptFromBundleNamed:nameOfFile translateEverything:YES] ) {
+
+            NSUInteger size = [script translatedSize];
+            [scripts setObject:script forKey:key cost:size];
+
+            EKTraceInfo(EKTraceCategoryScript, "Script cache loaded %s in %.4fs (%lu bytes)", [nameOfFile UTF8String],
+                        CFAbsoluteTimeGetCurrent() - startTime, (unsigned long)size);
+
+        } else {
+
+            NSLog(@"[VNScriptCache] ERROR: Could not load script named: %@", nameOfFile);
+            script = nil;
+        }
+    }
+
+    [lock unlock];
+    return script;
+}
+
+- (VNScript*)scriptNamed:(NSString*)nameOfFile
+{
+    if( nameOfFile == nil )
+        return nil;
+
+    NSString* key = [self keyForScriptNamed:nameOfFile];
+    if( key == nil ) {
+        NSLog(@"[VNScriptCache] ERROR: Could not find script named: %@", nameOfFile);
+        return nil;
+    }
+
+    BOOL wasCached = ([scripts objectForKey:key] != nil);
+    VNScript* script = [self loadScriptNamed:nameOfFile forKey:key];
+
+    @synchronized( self ) {
+        if( wasCached )
+            _hitCount++;
+        else
+            _missCount++;
+    }
+
+    return script;
+}
+
+- (VNScript*)cachedScriptNamed:(NSString*)nameOfFile
+{
+    NSString* key = (nameOfFile != nil) ? [self keyForScriptNamed:nameOfFile] : nil;
+    VNScript* script = (key != nil) ? [scripts objectForKey:key] : nil;
+
+    @synchronized( self ) {
+        if( script != nil )
+            _hitCount++;
+        else
+            _missCount++;
+    }
+
+    return script;
+}
+
+- (BOOL)hasScriptNamed:(NSString*)nameOfFile
+{
+    NSString* key = (nameOfFile != nil) ? [self keyForScriptNamed:nameOfFile] : nil;
+    return (key != nil && [scripts objectForKey:key] != nil);
+}
+
+- (void)preloadScriptsNamed:(NSArray*)names
+{
+    [self preloadScriptsNamed:names completion:nil];
+}
+
+- (void)preloadScriptsNamed:(NSArray*)names completion:(void (^)(void))completion
+{
+    NSArray* namesToLoad = [names copy];
+
+    dispatch_async(preloadQueue, ^{
+
+        for( NSString* name in namesToLoad ) {
+            @autoreleasepool {
+                NSString* key = [self keyForScriptNamed:name];
+                if( key != nil )
+                    [self loadScriptNamed:name forKey:key];
+                else
+                    NSLog(@"[VNScriptCache] ERROR: Could not find script named: %@", name);
+            }
+        }
+
+        if( completion != nil )
+            dispatch_async(dispatch_get_main_queue(), completion);
+    });
+}
+
+- (void)removeAllScripts
+{
+    [scripts removeAllObjects];
+
+    @synchronized( fingerprints ) {
+        [fingerprints removeAllObjects];
+    }
+}
+
+@end
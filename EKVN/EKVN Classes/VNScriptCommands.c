@@ -0,0 +1,210 @@
+//
+//  VNScriptCommands.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNScriptCommands.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    const char* name;
+    int type;
+} VNScriptCommandName;
+
+// Every command that the script language knows about. When adding a new command, add its name here as well as
+// in VNScript.h (and then add the code that translates it in VNScript's 'analyzedCommand' function).
+static const VNScriptCommandName VNScriptCommandNames[] = {
+    { ".addsprite",               VNScriptCommandAddSprite },
+    { ".setbackground",           VNScriptCommandSetBackground },
+    { ".setspeaker",              VNScriptCommandSetSpeaker },
+    { ".setconversation",         VNScriptCommandChangeConversation },
+    { ".jumponchoice",            VNScriptCommandJumpOnChoice },
+    { ".showspeech",              VNScriptCommandShowSpeechOrNot },
+    { ".fadein",                  VNScriptCommandEffectFadeIn },
+    { ".fadeout",                 VNScriptCommandEffectFadeOut },
+    { ".movebackground",          VNScriptCommandEffectMoveBackground },
+    { ".movesprite",              VNScriptCommandEffectMoveSprite },
+    { ".setspriteposition",       VNScriptCommandSetSpritePosition },
+    { ".playsound",               VNScriptCommandPlaySound },
+    { ".playmusic",               VNScriptCommandPlayMusic },
+    { ".setflag",                 VNScriptCommandSetFlag },
+    { ".modifyflag",              VNScriptCommandModifyFlagValue },
+    { ".isflag",                  VNScriptCommandIfFlagHasValue },
+    { ".modifyflagbychoice",      VNScriptCommandModifyFlagOnChoice },
+    { ".alignsprite",             VNScriptCommandAlignSprite },
+    { ".removesprite",            VNScriptCommandRemoveSprite },
+    { ".jumponflag",              VNScriptCommandJumpOnFlag },
+    { ".systemcall",              VNScriptCommandSystemCall },
+    { ".isflagmorethan",          VNScriptCommandIsFlagMoreThan },
+    { ".isflaglessthan",          VNScriptCommandIsFlagLessThan },
+    { ".isflagbetween",           VNScriptCommandIsFlagBetween },
+    { ".switchscript",            VNScriptCommandSwitchScript },
+    { ".setspeechfont",           VNScriptCommandSetSpeechFont },
+    { ".setspeechfontsize",       VNScriptCommandSetSpeechFontSize },
+    { ".setspeakerfont",          VNScriptCommandSetSpeakerFont },
+    { ".setspeakerfontsize",      VNScriptCommandSetSpeakerFontSize },
+    { ".setcinematictext",        VNScriptCommandSetCinematicText },
+    { ".settypewritertext",       VNScriptCommandSetTypewriterText },
+    { ".setspritealias",          VNScriptCommandSetSpriteAlias },
+    { ".setspeechbox",            VNScriptCommandSetSpeechbox },
+    { ".flipsprite",              VNScriptCommandFlipSprite },
+    { ".rolldice",                VNScriptCommandRollDice },
+    { ".modifychoiceboxoffset",   VNScriptCommandModifyChoiceboxOffset },
+    { ".scalebackground",         VNScriptCommandScaleBackground },
+    { ".scalesprite",             VNScriptCommandScaleSprite },
+    { ".addtochoiceset",          VNScriptCommandAddToChoiceSet },
+    { ".removefromchoiceset",     VNScriptCommandRemoveFromChoiceSet },
+    { ".wipechoiceset",           VNScriptCommandWipeChoiceSet },
+    { ".showchoiceset",           VNScriptCommandShowChoiceSet },
+    { ".isflaglessthanflag",      VNScriptCommandIsFlagLessThanFlag },
+    { ".isflagequaltoflag",       VNScriptCommandIsFlagEqualToFlag },
+    { ".isflagmorethanflag",      VNScriptCommandIsFlagMoreThanFlag },
+    { ".increaseflagbyflag",      VNScriptCommandIncreaseFlagByFlag },
+    { ".decreaseflagbyflag",      VNScriptCommandDecreaseFlagByFlag },
+    { ".showchoiceandjump",       VNScriptCommandShowChoiceAndJump },
+    { ".showchoiceandmodify",     VNScriptCommandShowChoiceAndModify },
+    { ".if",                      VNScriptCommandIf },
+};
+
+#define VNScriptCommandNameCount        (sizeof(VNScriptCommandNames) / sizeof(VNScriptCommandNames[0]))
+#define VNScriptCommandTableSize        256 // Must be a power of two, and at least twice the number of commands
+
+// Hash table of command names. Each slot holds (index in VNScriptCommandNames + 1), or zero for an empty slot.
+static uint8_t VNScriptCommandTable[VNScriptCommandTableSize];
+static uint32_t VNScriptCommandTableHashes[VNScriptCommandTableSize];
+static pthread_once_t VNScriptCommandTableOnce = PTHREAD_ONCE_INIT;
+
+static inline unsigned char VNScriptCommandFoldCase(unsigned char character)
+{
+    return (character >= 'A' && character <= 'Z') ? (unsigned char)(character + ('a' - 'A')) : character;
+}
+
+// FNV-1a over the lowercase version of the name, so that ".AddSprite" and ".addsprite" end up in the same slot
+static uint32_t VNScriptCommandHashName(const char* name, size_t length)
+{
+    uint32_t hash = 2166136261u;
+
+    for( size_t i = 0; i < length; i++ ) {
+        hash ^= VNScriptCommandFoldCase((unsigned char)name[i]);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void VNScriptCommandBuildTable(void)
+{
+    _Static_assert(VNScriptCommandNameCount * 2 <= VNScriptCommandTableSize, "VNScriptCommandTableSize is too small");
+
+    for( size_t i = 0; i < VNScriptCommandNameCount; i++ ) {
+
+        const char* name = VNScriptCommandNames[i].name;
+        uint32_t hash = VNScriptCommandHashName(name, strlen(name));
+        size_t slot = hash & (VNScriptCommandTableSize - 1);
+
+        while( VNScriptCommandTable[slot] != 0 )
+            slot = (slot + 1) & (VNScriptCommandTableSize - 1);
+
+        VNScriptCommandTable[slot] = (uint8_t)(i + 1);
+        VNScriptCommandTableHashes[slot] = hash;
+    }
+}
+
+// Compares a name from a script with one of the (already lowercase) names from the table
+static int VNScriptCommandNameMatches(const char* name, size_t length, const char* lowercaseName)
+{
+    for( size_t i = 0; i < length; i++ ) {
+        if( lowercaseName[i] == '\0' || VNScriptCommandFoldCase((unsigned char)name[i]) != (unsigned char)lowercaseName[i] )
+            return 0;
+    }
+
+    return lowercaseName[length] == '\0';
+}
+
+int VNScriptCommandTypeForName(const char* name, size_t length)
+{
+    if( name == NULL || length < 2 || length > VNScriptCommandLongestName || name[0] != '.' )
+        return VNScriptCommandUnknown;
+
+    pthread_once(&VNScriptCommandTableOnce, VNScriptCommandBuildTable);
+
+    uint32_t hash = VNScriptCommandHashName(name, length);
+    size_t slot = hash & (VNScriptCommandTableSize - 1);
+
+    // Since the table is never more than half full, there's always an empty slot that ends the search
+    while( VNScriptCommandTable[slot] != 0 ) {
+
+        const VNScriptCommandName* entry = &VNScriptCommandNames[VNScriptCommandTable[slot] - 1];
+        if( VNScriptCommandTableHashes[slot] == hash && VNScriptCommandNameMatches(name, length, entry->name) )
+            return entry->type;
+
+        slot = (slot + 1) & (VNScriptCommandTableSize - 1);
+    }
+
+    return VNScriptCommandUnknown;
+}
+
+VNScriptOperandRole VNScriptCommandOperandRole(int type, int operand)
+{
+    switch( type ) {
+
+        case VNScriptCommandChangeConversation:
+            return (operand == 0) ? VNScriptOperandRoleConversation : VNScriptOperandRoleNone;
+
+        case VNScriptCommandJumpOnChoice: // Choice text, then destinations
+            return (operand == 1) ? VNScriptOperandRoleConversation : VNScriptOperandRoleNone;
+
+        case VNScriptCommandJumpOnFlag: // Flag, expected value, destination
+            if( operand == 0 ) return VNScriptOperandRoleFlag;
+            if( operand == 2 ) return VNScriptOperandRoleConversation;
+            return VNScriptOperandRoleNone;
+
+        case VNScriptCommandSetFlag:
+        case VNScriptCommandModifyFlagValue:
+            return (operand == 0) ? VNScriptOperandRoleFlag : VNScriptOperandRoleNone;
+
+        case VNScriptCommandIfFlagHasValue: // Flag, value, command
+        case VNScriptCommandIsFlagMoreThan:
+        case VNScriptCommandIsFlagLessThan:
+            if( operand == 0 ) return VNScriptOperandRoleFlag;
+            if( operand == 2 ) return VNScriptOperandRoleCommand;
+            return VNScriptOperandRoleNone;
+
+        case VNScriptCommandIsFlagBetween: // Flag, lesser value, greater value, command
+            if( operand == 0 ) return VNScriptOperandRoleFlag;
+            if( operand == 3 ) return VNScriptOperandRoleCommand;
+            return VNScriptOperandRoleNone;
+
+        case VNScriptCommandModifyFlagOnChoice: // Choice text, flag names, amounts
+            return (operand == 1) ? VNScriptOperandRoleFlag : VNScriptOperandRoleNone;
+
+        case VNScriptCommandRollDice: // Maximum number, number of dice, flag (which can be "nil")
+            return (operand == 2) ? VNScriptOperandRoleFlag : VNScriptOperandRoleNone;
+
+        case VNScriptCommandIf: // Condition, command
+            if( operand == 0 ) return VNScriptOperandRoleExpression;
+            if( operand == 1 ) return VNScriptOperandRoleCommand;
+            return VNScriptOperandRoleNone;
+
+        // .SWITCHSCRIPT names a conversation too, but it's in a different script, so it can't be checked here
+    }
+
+    return VNScriptOperandRoleNone;
+}
+
+const char* VNScriptCommandNameForType(int type)
+{
+    if( type == VNScriptCommandSayLine )
+        return "(say line)";
+
+    for( size_t i = 0; i < VNScriptCommandNameCount; i++ ) {
+        if( VNScriptCommandNames[i].type == type )
+            return VNScriptCommandNames[i].name;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,101 @@
+//
+//  VNScriptCommands.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNScriptCommands
+
+ The numeric command types used by translated scripts, plus a fast way of looking up a command type from its name.
+ This is plain C so that it can be shared by VNScript, the script image format, and any command-line tools.
+
+ Command names are looked up in a hash table (built the first time it's needed) instead of being compared one
+ at a time against every known command. Lookups are case-insensitive, just like the script language itself.
+
+ */
+
+#ifndef VNScriptCommands_h
+#define VNScriptCommands_h
+
+#include <stddef.h>
+
+#define VNScriptCommandUnknown                  0   // Returned when a name doesn't match any command
+#define VNScriptCommandLongestName              64  // Anything longer than this (in bytes) can't possibly be a command
+
+// The command types, in numeric format
+#define VNScriptCommandSayLine                  100
+#define VNScriptCommandAddSprite                101
+#define VNScriptCommandSetBackground            102
+#define VNScriptCommandSetSpeaker               103
+#define VNScriptCommandChangeConversation       104
+#define VNScriptCommandJumpOnChoice             105
+#define VNScriptCommandShowSpeechOrNot          106
+#define VNScriptCommandEffectFadeIn             107
+#define VNScriptCommandEffectFadeOut            108
+#define VNScriptCommandEffectMoveBackground     109
+#define VNScriptCommandEffectMoveSprite         110
+#define VNScriptCommandSetSpritePosition        111
+#define VNScriptCommandPlaySound                112
+#define VNScriptCommandPlayMusic                113
+#define VNScriptCommandSetFlag                  114
+#define VNScriptCommandModifyFlagValue          115 // Add or subtract
+#define VNScriptCommandIfFlagHasValue           116 // An "if" command, really
+#define VNScriptCommandModifyFlagOnChoice       117 // Choice changes variable
+#define VNScriptCommandAlignSprite              118
+#define VNScriptCommandRemoveSprite             119
+#define VNScriptCommandJumpOnFlag               120 // Change conversation if a certain flag holds a particular value
+#define VNScriptCommandSystemCall               121
+//#define VNScriptCommandCallCode                 122 // CALLCODE has been disabled because it was a bad idea
+#define VNScriptCommandIsFlagMoreThan           123
+#define VNScriptCommandIsFlagLessThan           124
+#define VNScriptCommandIsFlagBetween            125
+#define VNScriptCommandSwitchScript             126
+#define VNScriptCommandSetSpeechFont            127
+#define VNScriptCommandSetSpeechFontSize        128
+#define VNScriptCommandSetSpeakerFont           129
+#define VNScriptCommandSetSpeakerFontSize       130
+#define VNScriptCommandSetCinematicText         131
+#define VNScriptCommandSetTypewriterText        132
+#define VNScriptCommandSetSpeechbox             133
+#define VNScriptCommandSetSpriteAlias           134
+#define VNScriptCommandFlipSprite               135
+#define VNScriptCommandRollDice                 136
+#define VNScriptCommandModifyChoiceboxOffset    137
+#define VNScriptCommandScaleBackground          138
+#define VNScriptCommandScaleSprite              139
+#define VNScriptCommandAddToChoiceSet           140
+#define VNScriptCommandRemoveFromChoiceSet      141
+#define VNScriptCommandWipeChoiceSet            142
+#define VNScriptCommandShowChoiceSet            143
+#define VNScriptCommandIsFlagLessThanFlag       144
+#define VNScriptCommandIsFlagEqualToFlag        145
+#define VNScriptCommandIsFlagMoreThanFlag       146
+#define VNScriptCommandIncreaseFlagByFlag       147
+#define VNScriptCommandDecreaseFlagByFlag       148
+#define VNScriptCommandShowChoiceAndJump        149
+#define VNScriptCommandShowChoiceAndModify      150
+#define VNScriptCommandIf                       151 // Runs another command if an expression is true (see VNScriptExpression.h)
+
+// Returns the command type (such as VNScriptCommandAddSprite) for a command name (such as ".addsprite"). The name must
+// include the leading dot, but doesn't need to be null-terminated. Returns VNScriptCommandUnknown if there's no match.
+int VNScriptCommandTypeForName(const char* name, size_t length);
+
+// Returns the (lowercase) name of a command type, or NULL if the type isn't known.
+const char* VNScriptCommandNameForType(int type);
+
+// What a (translated) command's operand refers to. The script linker uses this to find every conversation name and
+// flag name in a script, so that they can be resolved ahead of time instead of being looked up while the game runs.
+typedef enum {
+    VNScriptOperandRoleNone             = 0, // Just a value (or something that can't be resolved ahead of time)
+    VNScriptOperandRoleConversation     = 1, // The name of a conversation in the same script (or a list of names)
+    VNScriptOperandRoleFlag             = 2, // The name of a flag (or a list of names)
+    VNScriptOperandRoleCommand          = 3, // A nested command
+    VNScriptOperandRoleExpression       = 4, // A condition that gets compiled by the linker (see VNScriptExpression.h)
+} VNScriptOperandRole;
+
+// Operands are numbered from zero (the first parameter after the command type)
+VNScriptOperandRole VNScriptCommandOperandRole(int type, int operand);
+
+#endif
@@ -0,0 +1,600 @@
+//
+//  VNScriptExpression.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNScriptExpression.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// MARK: - Tokens
+
+typedef enum {
+    VNScriptTokenEnd,
+    VNScriptTokenNumber,
+    VNScriptTokenFlag,
+    VNScriptTokenLeftParenthesis,
+    VNScriptTokenRightParenthesis,
+    VNScriptTokenPlus,
+    VNScriptTokenMinus,
+    VNScriptTokenStar,
+    VNScriptTokenSlash,
+    VNScriptTokenPercent,
+    VNScriptTokenEqual,
+    VNScriptTokenNotEqual,
+    VNScriptTokenLess,
+    VNScriptTokenLessOrEqual,
+    VNScriptTokenGreater,
+    VNScriptTokenGreaterOrEqual,
+    VNScriptTokenAnd,
+    VNScriptTokenOr,
+    VNScriptTokenNot,
+} VNScriptToken;
+
+typedef struct {
+    const char* source;
+    size_t length;
+    size_t position;
+
+    VNScriptExpressionFlagResolver resolver;
+    void* context;
+
+    // The instructions created so far (these get copied into the finished expression)
+    VNScriptExpressionInstruction* instructions;
+    uint32_t count;
+    uint32_t capacity;
+
+    // Keeps track of how deep the stack would be at this point in the program
+    uint32_t depth;
+    uint32_t maxDepth;
+    uint32_t flagCount;
+    uint32_t nesting;
+
+    // The current token
+    VNScriptToken token;
+    size_t tokenStart;
+    int64_t number;
+    const char* name;
+    size_t nameLength;
+
+    int failed;
+    char* error;
+    size_t errorSize;
+} VNScriptExpressionCompiler;
+
+// Only the first error gets reported, since everything after it is usually just a side effect of the first one
+static void VNScriptExpressionFail(VNScriptExpressionCompiler* compiler, const char* format, ...)
+{
+    if( compiler->failed )
+        return;
+
+    compiler->failed = 1;
+
+    if( compiler->error != NULL && compiler->errorSize > 0 ) {
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(compiler->error, compiler->errorSize, format, arguments);
+        va_end(arguments);
+    }
+}
+
+static int VNScriptExpressionIsNameCharacter(char character, int isFirst)
+{
+    if( isalpha((unsigned char)character) || character == '_' )
+        return 1;
+
+    return !isFirst && (isdigit((unsigned char)character) || character == '.');
+}
+
+static void VNScriptExpressionNextToken(VNScriptExpressionCompiler* compiler)
+{
+    const char* source = compiler->source;
+    size_t length = compiler->length;
+    size_t position = compiler->position;
+
+    while( position < length && isspace((unsigned char)source[position]) )
+        position++;
+
+    compiler->tokenStart = position;
+
+    if( position >= length ) {
+        compiler->token = VNScriptTokenEnd;
+        compiler->position = position;
+        return;
+    }
+
+    char character = source[position];
+    char next = (position + 1 < length) ? source[position + 1] : '\0';
+
+    // Numbers
+    if( isdigit((unsigned char)character) ) {
+
+        uint64_t value = 0;
+        while( position < length && isdigit((unsigned char)source[position]) ) {
+
+            uint64_t digit = (uint64_t)(source[position] - '0');
+            if( value > ((uint64_t)INT64_MAX - digit) / 10 ) {
+                VNScriptExpressionFail(compiler, "The number at position %zu is too large", compiler->tokenStart + 1);
+                compiler->token = VNScriptTokenEnd;
+                return;
+            }
+
+            value = (value * 10) + digit;
+            position++;
+        }
+
+        compiler->token = VNScriptTokenNumber;
+        compiler->number = (int64_t)value;
+        compiler->position = position;
+        return;
+    }
+
+    // Flag names (either plain, or inside of square brackets)
+    if( VNScriptExpressionIsNameCharacter(character, 1) ) {
+
+        size_t start = position;
+        while( position < length && VNScriptExpressionIsNameCharacter(source[position], 0) )
+            position++;
+
+        compiler->token = VNScriptTokenFlag;
+        compiler->name = source + start;
+        compiler->nameLength = position - start;
+        compiler->position = position;
+        return;
+    }
+
+    if( character == '[' ) {
+
+        size_t start = position + 1;
+        size_t end = start;
+        while( end < length && source[end] != ']' )
+            end++;
+
+        if( end >= length ) {
+            VNScriptExpressionFail(compiler, "The '[' at position %zu is never closed", compiler->tokenStart + 1);
+            compiler->token = VNScriptTokenEnd;
+            return;
+        }
+
+        position = end + 1;
+
+        // Spaces just inside the brackets aren't part of the name
+        while( start < end && isspace((unsigned char)source[start]) )
+            start++;
+        while( end > start && isspace((unsigned char)source[end - 1]) )
+            end--;
+
+        if( start == end ) {
+            VNScriptExpressionFail(compiler, "The brackets at position %zu don't have a flag name inside", compiler->tokenStart + 1);
+            compiler->token = VNScriptTokenEnd;
+            return;
+        }
+
+        compiler->token = VNScriptTokenFlag;
+        compiler->name = source + start;
+        compiler->nameLength = end - start;
+        compiler->position = position;
+        return;
+    }
+
+    // Operators
+    VNScriptToken token = VNScriptTokenEnd;
+    size_t tokenLength = 1;
+
+    switch( character ) {
+        case '(': token = VNScriptTokenLeftParenthesis; break;
+        case ')': token = VNScriptTokenRightParenthesis; break;
+        case '+': token = VNScriptTokenPlus; break;
+        case '-': token = VNScriptTokenMinus; break;
+        case '*': token = VNScriptTokenStar; break;
+        case '/': token = VNScriptTokenSlash; break;
+        case '%': token = VNScriptTokenPercent; break;
+        case '<':
+            token = (next == '=') ? VNScriptTokenLessOrEqual : VNScriptTokenLess;
+            tokenLength = (next == '=') ? 2 : 1;
+            break;
+        case '>':
+            token = (next == '=') ? VNScriptTokenGreaterOrEqual : VNScriptTokenGreater;
+            tokenLength = (next == '=') ? 2 : 1;
+            break;
+        case '!':
+            token = (next == '=') ? VNScriptTokenNotEqual : VNScriptTokenNot;
+            tokenLength = (next == '=') ? 2 : 1;
+            break;
+        case '=':
+            if( next == '=' ) { token = VNScriptTokenEqual; tokenLength = 2; }
+            break;
+        case '&':
+            if( next == '&' ) { token = VNScriptTokenAnd; tokenLength = 2; }
+            break;
+        case '|':
+            if( next == '|' ) { token = VNScriptTokenOr; tokenLength = 2; }
+            break;
+    }
+
+    if( token == VNScriptTokenEnd ) {
+        VNScriptExpressionFail(compiler, "Unexpected '%c' at position %zu", character, compiler->tokenStart + 1);
+        compiler->position = length;
+    } else {
+        compiler->position = position + tokenLength;
+    }
+
+    compiler->token = token;
+}
+
+// MARK: - Code generation
+
+static void VNScriptExpressionEmit(VNScriptExpressionCompiler* compiler, VNScriptExpressionOp op, int64_t operand)
+{
+    if( compiler->failed )
+        return;
+
+    if( compiler->count == compiler->capacity ) {
+
+        uint32_t updatedCapacity = (compiler->capacity > 0) ? compiler->capacity * 2 : 16;
+        VNScriptExpressionInstruction* updated = realloc(compiler->instructions, updatedCapacity * sizeof(VNScriptExpressionInstruction));
+        if( updated == NULL ) {
+            VNScriptExpressionFail(compiler, "Out of memory");
+            return;
+        }
+
+        compiler->instructions = updated;
+        compiler->capacity = updatedCapacity;
+    }
+
+    VNScriptExpressionInstruction* instruction = &compiler->instructions[compiler->count++];
+    instruction->op = op;
+    instruction->reserved = 0;
+    instruction->operand = operand;
+
+    // Work out what this instruction does to the stack. The jumps only pop when they don't jump (and when they DO jump,
+    // they land at a point where the other path has pushed exactly one value back), so they count as a pop here.
+    switch( op ) {
+
+        case VNScriptExpressionOpConstant:
+        case VNScriptExpressionOpFlag:
+            compiler->depth++;
+            if( compiler->depth > compiler->maxDepth )
+                compiler->maxDepth = compiler->depth;
+            if( compiler->depth > VNScriptExpressionMaxStackDepth )
+                VNScriptExpressionFail(compiler, "The expression is too complicated");
+            break;
+
+        case VNScriptExpressionOpNegate:
+        case VNScriptExpressionOpNot:
+        case VNScriptExpressionOpTruth:
+            break;
+
+        default:
+            compiler->depth--;
+            break;
+    }
+}
+
+// Jumps are created before their destination is known, so they get filled in afterwards
+static void VNScriptExpressionPatchJump(VNScriptExpressionCompiler* compiler, uint32_t jump)
+{
+    if( compiler->failed == 0 )
+        compiler->instructions[jump].operand = compiler->count;
+}
+
+// MARK: - Parsing
+
+static void VNScriptExpressionParseOr(VNScriptExpressionCompiler* compiler);
+
+static void VNScriptExpressionParsePrimary(VNScriptExpressionCompiler* compiler)
+{
+    if( compiler->failed )
+        return;
+
+    switch( compiler->token ) {
+
+        case VNScriptTokenNumber:
+            VNScriptExpressionEmit(compiler, VNScriptExpressionOpConstant, compiler->number);
+            VNScriptExpressionNextToken(compiler);
+            break;
+
+        case VNScriptTokenFlag: {
+
+            uint32_t slot = compiler->flagCount;
+            if( compiler->resolver != NULL ) {
+
+                slot = compiler->resolver(compiler->context, compiler->name, compiler->nameLength);
+                if( slot == UINT32_MAX ) {
+                    VNScriptExpressionFail(compiler, "The flag '%.*s' couldn't be found", (int)compiler->nameLength, compiler->name);
+                    return;
+                }
+            }
+
+            compiler->flagCount++;
+            VNScriptExpressionEmit(compiler, VNScriptExpressionOpFlag, slot);
+            VNScriptExpressionNextToken(compiler);
+        } break;
+
+        case VNScriptTokenLeftParenthesis:
+
+            if( ++compiler->nesting > VNScriptExpressionMaxNesting ) {
+                VNScriptExpressionFail(compiler, "Too many nested parentheses");
+                return;
+            }
+
+            VNScriptExpressionNextToken(compiler);
+            VNScriptExpressionParseOr(compiler);
+
+            if( compiler->failed == 0 && compiler->token != VNScriptTokenRightParenthesis ) {
+                VNScriptExpressionFail(compiler, "Expected ')' at position %zu", compiler->tokenStart + 1);
+                return;
+            }
+
+            compiler->nesting--;
+            VNScriptExpressionNextToken(compiler);
+            break;
+
+        case VNScriptTokenEnd:
+            VNScriptExpressionFail(compiler, "The expression ends too soon");
+            break;
+
+        default:
+            VNScriptExpressionFail(compiler, "Expected a number or flag name at position %zu", compiler->tokenStart + 1);
+            break;
+    }
+}
+
+static void VNScriptExpressionParseUnary(VNScriptExpressionCompiler* compiler)
+{
+    if( compiler->failed )
+        return;
+
+    VNScriptToken token = compiler->token;
+    if( token != VNScriptTokenNot && token != VNScriptTokenMinus ) {
+        VNScriptExpressionParsePrimary(compiler);
+        return;
+    }
+
+    if( ++compiler->nesting > VNScriptExpressionMaxNesting ) {
+        VNScriptExpressionFail(compiler, "Too many nested operators");
+        return;
+    }
+
+    VNScriptExpressionNextToken(compiler);
+
+    // Negative numbers are stored as constants instead of being negated every time the expression runs
+    if( token == VNScriptTokenMinus && compiler->token == VNScriptTokenNumber ) {
+        compiler->number = -compiler->number;
+        VNScriptExpressionParsePrimary(compiler);
+    } else {
+        VNScriptExpressionParseUnary(compiler);
+        VNScriptExpressionEmit(compiler, (token == VNScriptTokenNot) ? VNScriptExpressionOpNot : VNScriptExpressionOpNegate, 0);
+    }
+
+    compiler->nesting--;
+}
+
+// Parses a chain of left-associative binary operators, such as "a * b / c"
+typedef void (*VNScriptExpressionParser)(VNScriptExpressionCompiler* compiler);
+
+static void VNScriptExpressionParseBinary(VNScriptExpressionCompiler* compiler, VNScriptExpressionParser parseOperand,
+                                          const VNScriptToken* tokens, const VNScriptExpressionOp* ops, int operatorCount)
+{
+    parseOperand(compiler);
+
+    while( compiler->failed == 0 ) {
+
+        int match = -1;
+        for( int i = 0; i < operatorCount; i++ ) {
+            if( compiler->token == tokens[i] )
+                match = i;
+        }
+
+        if( match < 0 )
+            return;
+
+        VNScriptExpressionNextToken(compiler);
+        parseOperand(compiler);
+        VNScriptExpressionEmit(compiler, ops[match], 0);
+    }
+}
+
+static void VNScriptExpressionParseMultiplicative(VNScriptExpressionCompiler* compiler)
+{
+    static const VNScriptToken tokens[] = { VNScriptTokenStar, VNScriptTokenSlash, VNScriptTokenPercent };
+    static const VNScriptExpressionOp ops[] = { VNScriptExpressionOpMultiply, VNScriptExpressionOpDivide, VNScriptExpressionOpRemainder };
+    VNScriptExpressionParseBinary(compiler, VNScriptExpressionParseUnary, tokens, ops, 3);
+}
+
+static void VNScriptExpressionParseAdditive(VNScriptExpressionCompiler* compiler)
+{
+    static const VNScriptToken tokens[] = { VNScriptTokenPlus, VNScriptTokenMinus };
+    static const VNScriptExpressionOp ops[] = { VNScriptExpressionOpAdd, VNScriptExpressionOpSubtract };
+    VNScriptExpressionParseBinary(compiler, VNScriptExpressionParseMultiplicative, tokens, ops, 2);
+}
+
+static void VNScriptExpressionParseRelational(VNScriptExpressionCompiler* compiler)
+{
+    static const VNScriptToken tokens[] = { VNScriptTokenLess, VNScriptTokenLessOrEqual, VNScriptTokenGreater, VNScriptTokenGreaterOrEqual };
+    static const VNScriptExpressionOp ops[] = { VNScriptExpressionOpLess, VNScriptExpressionOpLessOrEqual, VNScriptExpressionOpGreater, VNScriptExpressionOpGreaterOrEqual };
+    VNScriptExpressionParseBinary(compiler, VNScriptExpressionParseAdditive, tokens, ops, 4);
+}
+
+static void VNScriptExpressionParseEquality(VNScriptExpressionCompiler* compiler)
+{
+    static const VNScriptToken tokens[] = { VNScriptTokenEqual, VNScriptTokenNotEqual };
+    static const VNScriptExpressionOp ops[] = { VNScriptExpressionOpEqual, VNScriptExpressionOpNotEqual };
+    VNScriptExpressionParseBinary(compiler, VNScriptExpressionParseRelational, tokens, ops, 2);
+}
+
+// && and || are handled differently from the other operators, since the right side only runs when it's needed:
+//
+//   a && b   =>   a, ANDJUMP end, b, TRUTH, end:
+//   a || b   =>   a, ORJUMP end,  b, TRUTH, end:
+//
+static void VNScriptExpressionParseAnd(VNScriptExpressionCompiler* compiler)
+{
+    VNScriptExpressionParseEquality(compiler);
+
+    while( compiler->failed == 0 && compiler->token == VNScriptTokenAnd ) {
+
+        uint32_t jump = compiler->count;
+        VNScriptExpressionEmit(compiler, VNScriptExpressionOpAndJump, 0);
+        VNScriptExpressionNextToken(compiler);
+        VNScriptExpressionParseEquality(compiler);
+        VNScriptExpressionEmit(compiler, VNScriptExpressionOpTruth, 0);
+        VNScriptExpressionPatchJump(compiler, jump);
+    }
+}
+
+static void VNScriptExpressionParseOr(VNScriptExpressionCompiler* compiler)
+{
+    VNScriptExpressionParseAnd(compiler);
+
+    while( compiler->failed == 0 && compiler->token == VNScriptTokenOr ) {
+
+        uint32_t jump = compiler->count;
+        VNScriptExpressionEmit(compiler, VNScriptExpressionOpOrJump, 0);
+        VNScriptExpressionNextToken(compiler);
+        VNScriptExpressionParseAnd(compiler);
+        VNScriptExpressionEmit(compiler, VNScriptExpressionOpTruth, 0);
+        VNScriptExpressionPatchJump(compiler, jump);
+    }
+}
+
+// MARK: - Functions
+
+VNScriptExpression* VNScriptExpressionCompile(const char* source, size_t length, VNScriptExpressionFlagResolver resolver,
+                                              void* context, char* error, size_t errorSize)
+{
+    if( error != NULL && errorSize > 0 )
+        error[0] = '\0';
+
+    VNScriptExpressionCompiler compiler;
+    memset(&compiler, 0, sizeof(compiler));
+    compiler.source = (source != NULL) ? source : "";
+    compiler.length = (source != NULL) ? length : 0;
+    compiler.resolver = resolver;
+    compiler.context = context;
+    compiler.error = error;
+    compiler.errorSize = errorSize;
+
+    VNScriptExpressionNextToken(&compiler);
+    VNScriptExpressionParseOr(&compiler);
+
+    if( compiler.failed == 0 && compiler.token != VNScriptTokenEnd )
+        VNScriptExpressionFail(&compiler, "Unexpected text at position %zu", compiler.tokenStart + 1);
+
+    VNScriptExpression* expression = NULL;
+    if( compiler.failed == 0 ) {
+
+        expression = malloc(sizeof(VNScriptExpression) + compiler.count * sizeof(VNScriptExpressionInstruction));
+        if( expression != NULL ) {
+            expression->instructionCount = compiler.count;
+            expression->stackDepth = compiler.maxDepth;
+            expression->flagCount = compiler.flagCount;
+            expression->reserved = 0;
+            memcpy(expression->instructions, compiler.instructions, compiler.count * sizeof(VNScriptExpressionInstruction));
+        } else {
+            VNScriptExpressionFail(&compiler, "Out of memory");
+        }
+    }
+
+    free(compiler.instructions);
+    return expression;
+}
+
+void VNScriptExpressionFree(VNScriptExpression* expression)
+{
+    free(expression);
+}
+
+int64_t VNScriptExpressionEvaluate(const VNScriptExpression* expression, VNScriptExpressionFlagReader reader, void* context)
+{
+    if( expression == NULL || expression->instructionCount == 0 )
+        return 0;
+
+    // The compiler guarantees that the stack never gets deeper than this, and that jumps only go forward
+    int64_t stack[VNScriptExpressionMaxStackDepth];
+    int top = -1;
+
+    const VNScriptExpressionInstruction* instructions = expression->instructions;
+    uint32_t count = expression->instructionCount;
+
+    for( uint32_t pc = 0; pc < count; pc++ ) {
+
+        const VNScriptExpressionInstruction* instruction = &instructions[pc];
+
+        switch( instruction->op ) {
+
+            case VNScriptExpressionOpConstant:
+                stack[++top] = instruction->operand;
+                continue;
+
+            case VNScriptExpressionOpFlag:
+                stack[++top] = (reader != NULL) ? reader(context, (uint32_t)instruction->operand) : 0;
+                continue;
+
+            case VNScriptExpressionOpNegate:
+                stack[top] = (int64_t)(0 - (uint64_t)stack[top]); // Wraps around instead of overflowing
+                continue;
+
+            case VNScriptExpressionOpNot:
+                stack[top] = (stack[top] == 0);
+                continue;
+
+            case VNScriptExpressionOpTruth:
+                stack[top] = (stack[top] != 0);
+                continue;
+
+            case VNScriptExpressionOpAndJump:
+                if( stack[top] == 0 )
+                    pc = (uint32_t)instruction->operand - 1; // The loop adds one
+                else
+                    top--;
+                continue;
+
+            case VNScriptExpressionOpOrJump:
+                if( stack[top] != 0 ) {
+                    stack[top] = 1;
+                    pc = (uint32_t)instruction->operand - 1;
+                } else {
+                    top--;
+                }
+                continue;
+        }
+
+        // Everything else takes two values and leaves one
+        int64_t right = stack[top--];
+        int64_t left = stack[top];
+        int64_t result = 0;
+
+        switch( instruction->op ) {
+            case VNScriptExpressionOpAdd:               result = (int64_t)((uint64_t)left + (uint64_t)right); break;
+            case VNScriptExpressionOpSubtract:          result = (int64_t)((uint64_t)left - (uint64_t)right); break;
+            case VNScriptExpressionOpMultiply:          result = (int64_t)((uint64_t)left * (uint64_t)right); break;
+            case VNScriptExpressionOpDivide:
+                if( right == 0 )
+                    result = 0;
+                else if( right == -1 )
+                    result = (int64_t)(0 - (uint64_t)left); // INT64_MIN / -1 would overflow
+                else
+                    result = left / right;
+                break;
+            case VNScriptExpressionOpRemainder:
+                result = (right == 0 || right == -1) ? 0 : left % right;
+                break;
+            case VNScriptExpressionOpEqual:             result = (left == right); break;
+            case VNScriptExpressionOpNotEqual:          result = (left != right); break;
+            case VNScriptExpressionOpLess:              result = (left < right); break;
+            case VNScriptExpressionOpLessOrEqual:       result = (left <= right); break;
+            case VNScriptExpressionOpGreater:           result = (left > right); break;
+            case VNScriptExpressionOpGreaterOrEqual:    result = (left >= right); break;
+        }
+
+        stack[top] = result;
+    }
+
+    return (top >= 0) ? stack[top] : 0;
+}
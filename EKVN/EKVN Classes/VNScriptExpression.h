@@ -0,0 +1,101 @@
+//
+//  VNScriptExpression.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNScriptExpression
+
+ Compiles the conditions used by the .IF command (like "gold >= 10 && (trust > 3 || chapter == 2)") into a small
+ program for a stack machine. Conditions are compiled once, when a script gets linked, and after that evaluating
+ one is just a loop over an array of instructions: nothing is parsed, looked up by name, or allocated.
+
+ The expression language:
+
+   Numbers          Whole numbers (like 12 or -3). All math is done with 64-bit integers.
+   Flags            Flag names made up of letters, digits, underscores and periods (like gold or met_alice), or any
+                    name at all inside of square brackets (like [number of cookies]). Flags that don't exist count as 0.
+   Math             +  -  *  /  %  (dividing by zero gives 0 instead of crashing)
+   Comparisons      ==  !=  <  <=  >  >=  (these give 1 for true and 0 for false)
+   Logic            &&  ||  !  (anything that isn't 0 counts as true; && and || skip the right side when they can)
+   Grouping         ( and )
+
+ Operators have the same precedence as in C. Since script lines are split up wherever there's a colon, expressions
+ can't contain colons (not even inside of square brackets).
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNScriptExpression_h
+#define VNScriptExpression_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNScriptExpressionMaxStackDepth     32  // Expressions that would need a deeper stack than this don't compile
+#define VNScriptExpressionMaxNesting        32  // The most parentheses (and unary operators) that can be nested
+#define VNScriptExpressionErrorLength       128 // Big enough for any error message from VNScriptExpressionCompile
+
+typedef enum {
+    VNScriptExpressionOpConstant        = 0,    // Push 'operand'
+    VNScriptExpressionOpFlag            = 1,    // Push the value of the flag in slot 'operand'
+    VNScriptExpressionOpNegate          = 2,
+    VNScriptExpressionOpNot             = 3,
+    VNScriptExpressionOpTruth           = 4,    // Turns the top value into 0 or 1
+    VNScriptExpressionOpAdd             = 5,
+    VNScriptExpressionOpSubtract        = 6,
+    VNScriptExpressionOpMultiply        = 7,
+    VNScriptExpressionOpDivide          = 8,
+    VNScriptExpressionOpRemainder       = 9,
+    VNScriptExpressionOpEqual           = 10,
+    VNScriptExpressionOpNotEqual        = 11,
+    VNScriptExpressionOpLess            = 12,
+    VNScriptExpressionOpLessOrEqual     = 13,
+    VNScriptExpressionOpGreater         = 14,
+    VNScriptExpressionOpGreaterOrEqual  = 15,
+    VNScriptExpressionOpAndJump         = 16,   // If the top value is 0, jump to instruction 'operand' (leaving 0); otherwise pop it
+    VNScriptExpressionOpOrJump          = 17,   // If the top value isn't 0, jump to instruction 'operand' (leaving 1); otherwise pop it
+} VNScriptExpressionOp;
+
+typedef struct {
+    uint32_t op;            // VNScriptExpressionOp
+    uint32_t reserved;
+    int64_t operand;
+} VNScriptExpressionInstruction;
+
+// A compiled expression. The instructions are stored right after the struct, in the same block of memory.
+typedef struct {
+    uint32_t instructionCount;
+    uint32_t stackDepth;    // The deepest that the stack gets while this expression is being evaluated
+    uint32_t flagCount;     // Number of flag references in the expression
+    uint32_t reserved;
+    VNScriptExpressionInstruction instructions[];
+} VNScriptExpression;
+
+// Turns a flag name into the slot number that gets stored in the compiled expression (VNScript uses the EKFlagTable
+// slots). Returning UINT32_MAX makes the expression fail to compile.
+typedef uint32_t (*VNScriptExpressionFlagResolver)(void* context, const char* name, size_t length);
+
+// Returns the value of the flag in a particular slot (0 if the flag doesn't exist)
+typedef int64_t (*VNScriptExpressionFlagReader)(void* context, uint32_t slot);
+
+// MARK: - Functions
+
+// Compiles an expression (the text doesn't need to be null-terminated). If 'resolver' is NULL, each flag reference just
+// gets the next number (0, 1, 2...), which is good enough for checking that the expression is valid. Returns NULL if the
+// expression can't be compiled, with a description of the problem copied into 'error' (if it isn't NULL).
+VNScriptExpression* VNScriptExpressionCompile(const char* source, size_t length, VNScriptExpressionFlagResolver resolver,
+                                              void* context, char* error, size_t errorSize);
+
+void VNScriptExpressionFree(VNScriptExpression* expression);
+
+// Runs a compiled expression. This never allocates memory (the stack is a local array), so it's safe to call as often
+// as needed. A NULL expression evaluates to 0.
+int64_t VNScriptExpressionEvaluate(const VNScriptExpression* expression, VNScriptExpressionFlagReader reader, void* context);
+
+#endif
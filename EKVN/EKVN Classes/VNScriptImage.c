@@ -0,0 +1,652 @@
+//
+//  VNScriptImage.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNScriptImage.h"
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Records get written straight to disk (and read straight from mapped memory), so their size can't depend on the compiler
+_Static_assert(sizeof(VNScriptCommandRecord) == 48, "VNScriptCommandRecord must be 48 bytes");
+_Static_assert(sizeof(VNScriptImageHeader) % 8 == 0, "VNScriptImageHeader must keep the sections 8-byte aligned");
+
+#define VNScriptImageAlignment      8
+#define VNScriptImageAligned(x)     (((x) + (VNScriptImageAlignment - 1)) & ~((size_t)VNScriptImageAlignment - 1))
+
+// MARK: - Reading images
+
+// Checks that a section (of 'count' items of size 'itemSize') fits inside the image
+static int VNScriptImageSectionIsValid(size_t imageLength, uint32_t offset, uint32_t count, size_t itemSize)
+{
+    if( offset % VNScriptImageAlignment != 0 )
+        return 0;
+    if( offset > imageLength )
+        return 0;
+
+    return ((size_t)count * itemSize) <= (imageLength - offset);
+}
+
+VNScriptImage* VNScriptImageOpenBytes(const void* bytes, size_t length)
+{
+    if( bytes == NULL || length < sizeof(VNScriptImageHeader) )
+        return NULL;
+
+    const VNScriptImageHeader* header = (const VNScriptImageHeader*)bytes;
+
+    // Make sure this is a script image, and that it was written by a compatible version of the compiler
+    if( header->magic != VNScriptImageMagic ) {
+        fprintf(stderr, "[VNScriptImage] ERROR: Data is not a compiled script image.\n");
+        return NULL;
+    }
+    if( header->version != VNScriptImageVersion || header->recordSize != sizeof(VNScriptCommandRecord) ) {
+        fprintf(stderr, "[VNScriptImage] ERROR: Compiled script uses version %u; expected version %u. Recompile the script.\n",
+                header->version, VNScriptImageVersion);
+        return NULL;
+    }
+    if( header->imageSize > length ||
+        !VNScriptImageSectionIsValid(length, header->conversationsOffset, header->conversationCount, sizeof(VNScriptConversationEntry)) ||
+        !VNScriptImageSectionIsValid(length, header->commandsOffset, header->commandCount, sizeof(VNScriptCommandRecord)) ||
+        !VNScriptImageSectionIsValid(length, header->secondaryOffset, header->secondaryCount, sizeof(VNScriptCommandRecord)) ||
+        !VNScriptImageSectionIsValid(length, header->listsOffset, header->listItemCount, sizeof(uint32_t)) ||
+        !VNScriptImageSectionIsValid(length, header->stringTableOffset, header->stringCount, sizeof(VNScriptStringEntry)) ||
+        !VNScriptImageSectionIsValid(length, header->stringPoolOffset, header->stringPoolSize, 1) ) {
+        fprintf(stderr, "[VNScriptImage] ERROR: Compiled script is truncated or damaged.\n");
+        return NULL;
+    }
+
+    VNScriptImage* image = calloc(1, sizeof(VNScriptImage));
+    if( image == NULL )
+        return NULL;
+
+    const uint8_t* base = (const uint8_t*)bytes;
+    image->bytes                = base;
+    image->length               = length;
+    image->header               = header;
+    image->conversations        = (const VNScriptConversationEntry*)(base + header->conversationsOffset);
+    image->commands             = (const VNScriptCommandRecord*)(base + header->commandsOffset);
+    image->secondaryCommands    = (const VNScriptCommandRecord*)(base + header->secondaryOffset);
+    image->lists                = (const uint32_t*)(base + header->listsOffset);
+    image->strings              = (const VNScriptStringEntry*)(base + header->stringTableOffset);
+    image->stringPool           = (const char*)(base + header->stringPoolOffset);
+
+    // Check that every conversation's commands actually exist
+    for( uint32_t i = 0; i < header->conversationCount; i++ ) {
+        const VNScriptConversationEntry* entry = &image->conversations[i];
+        if( entry->name >= header->stringCount ||
+            entry->firstCommand > header->commandCount ||
+            entry->commandCount > header->commandCount - entry->firstCommand ) {
+            fprintf(stderr, "[VNScriptImage] ERROR: Conversation table in compiled script is damaged.\n");
+            free(image);
+            return NULL;
+        }
+    }
+
+    return image;
+}
+
+VNScriptImage* VNScriptImageOpenFile(const char* path)
+{
+    if( path == NULL )
+        return NULL;
+
+    int fileDescriptor = open(path, O_RDONLY);
+    if( fileDescriptor < 0 )
+        return NULL;
+
+    struct stat fileInfo;
+    if( fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size < (off_t)sizeof(VNScriptImageHeader) ) {
+        close(fileDescriptor);
+        return NULL;
+    }
+
+    // The mapping stays valid after the file descriptor is closed
+    size_t length = (size_t)fileInfo.st_size;
+    void* mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+
+    if( mapped == MAP_FAILED ) {
+        fprintf(stderr, "[VNScriptImage] ERROR: Could not map compiled script at: %s\n", path);
+        return NULL;
+    }
+
+    VNScriptImage* image = VNScriptImageOpenBytes(mapped, length);
+    if( image == NULL ) {
+        munmap(mapped, length);
+        return NULL;
+    }
+
+    image->isMapped = 1;
+    return image;
+}
+
+VNScriptImage* VNScriptImageOpenOwnedBytes(void* bytes, size_t length)
+{
+    VNScriptImage* image = VNScriptImageOpenBytes(bytes, length);
+    if( image == NULL )
+        return NULL;
+
+    image->ownsBytes = 1;
+    return image;
+}
+
+void VNScriptImageClose(VNScriptImage* image)
+{
+    if( image == NULL )
+        return;
+
+    if( image->isMapped )
+        munmap((void*)image->bytes, image->length);
+    else if( image->ownsBytes )
+        free((void*)image->bytes);
+
+    free(image);
+}
+
+const char* VNScriptImageString(const VNScriptImage* image, uint32_t index, uint32_t* outLength)
+{
+    if( image == NULL || index >= image->header->stringCount )
+        return NULL;
+
+    const VNScriptStringEntry* entry = &image->strings[index];
+
+    // Don't trust the string table blindly; the string (and its null terminator) has to be inside the pool
+    if( entry->offset > image->header->stringPoolSize || entry->length >= image->header->stringPoolSize - entry->offset )
+        return NULL;
+
+    if( outLength )
+        *outLength = entry->length;
+
+    return image->stringPool + entry->offset;
+}
+
+// Compares two strings the same way the builder sorts the conversation table (plain byte order, shorter strings first)
+static int VNScriptImageCompareNames(const char* a, size_t aLength, const char* b, size_t bLength)
+{
+    size_t shortest = (aLength < bLength) ? aLength : bLength;
+    int result = memcmp(a, b, shortest);
+
+    if( result != 0 )
+        return result;
+    if( aLength == bLength )
+        return 0;
+
+    return (aLength < bLength) ? -1 : 1;
+}
+
+uint32_t VNScriptImageFindConversation(const VNScriptImage* image, const char* name, size_t length)
+{
+    if( image == NULL || name == NULL )
+        return VNScriptImageNotFound;
+
+    // The conversation table is sorted by name, so a binary search works here
+    uint32_t low = 0;
+    uint32_t high = image->header->conversationCount;
+
+    while( low < high ) {
+
+        uint32_t middle = low + ((high - low) / 2);
+        uint32_t middleLength = 0;
+        const char* middleName = VNScriptImageString(image, image->conversations[middle].name, &middleLength);
+        if( middleName == NULL )
+            return VNScriptImageNotFound;
+
+        int result = VNScriptImageCompareNames(name, length, middleName, middleLength);
+        if( result == 0 )
+            return middle;
+        else if( result < 0 )
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return VNScriptImageNotFound;
+}
+
+// MARK: - Reading commands
+
+// Returns the text of a string operand (or NULL if the operand isn't a string)
+static const char* VNScriptImageOperandText(const VNScriptImage* image, const VNScriptCommandRecord* record, int index)
+{
+    if( record->kinds[index] != VNScriptOperandString )
+        return NULL;
+
+    return VNScriptImageString(image, record->operands[index].ref.index, NULL);
+}
+
+static int VNScriptImageOperandExists(const VNScriptCommandRecord* record, int index)
+{
+    return (record != NULL && index >= 0 && index < record->operandCount && index < VNScriptImageMaxOperands);
+}
+
+int64_t VNScriptImageOperandInteger(const VNScriptImage* image, const VNScriptCommandRecord* record, int index)
+{
+    if( !VNScriptImageOperandExists(record, index) )
+        return 0;
+
+    switch( record->kinds[index] ) {
+        case VNScriptOperandInteger:
+        case VNScriptOperandBool:       return record->operands[index].integer;
+        case VNScriptOperandNumber:     return (int64_t)record->operands[index].number;
+        case VNScriptOperandString: {
+            const char* text = VNScriptImageOperandText(image, record, index);
+            return (text != NULL) ? strtoll(text, NULL, 10) : 0;
+        }
+    }
+
+    return 0;
+}
+
+double VNScriptImageOperandNumber(const VNScriptImage* image, const VNScriptCommandRecord* record, int index)
+{
+    if( !VNScriptImageOperandExists(record, index) )
+        return 0.0;
+
+    switch( record->kinds[index] ) {
+        case VNScriptOperandInteger:
+        case VNScriptOperandBool:       return (double)record->operands[index].integer;
+        case VNScriptOperandNumber:     return record->operands[index].number;
+        case VNScriptOperandString: {
+            const char* text = VNScriptImageOperandText(image, record, index);
+            return (text != NULL) ? strtod(text, NULL) : 0.0;
+        }
+    }
+
+    return 0.0;
+}
+
+int VNScriptImageOperandBool(const VNScriptImage* image, const VNScriptCommandRecord* record, int index)
+{
+    if( !VNScriptImageOperandExists(record, index) )
+        return 0;
+
+    if( record->kinds[index] != VNScriptOperandString )
+        return VNScriptImageOperandNumber(image, record, index) != 0.0;
+
+    // Just like NSString's boolValue: skip any leading whitespace (plus a sign and leading zeroes), and then check for
+    // 'Y', 'y', 'T', 't', or a non-zero digit.
+    const char* text = VNScriptImageOperandText(image, record, index);
+    if( text == NULL )
+        return 0;
+
+    while( isspace((unsigned char)*text) )
+        text++;
+    if( *text == '+' || *text == '-' )
+        text++;
+    while( *text == '0' )
+        text++;
+
+    return (*text == 'Y' || *text == 'y' || *text == 'T' || *text == 't' || (*text >= '1' && *text <= '9'));
+}
+
+const VNScriptCommandRecord* VNScriptImageOperandCommand(const VNScriptImage* image, const VNScriptCommandRecord* record, int index)
+{
+    if( image == NULL || !VNScriptImageOperandExists(record, index) || record->kinds[index] != VNScriptOperandCommand )
+        return NULL;
+
+    uint32_t secondaryIndex = record->operands[index].ref.index;
+    if( secondaryIndex >= image->header->secondaryCount )
+        return NULL;
+
+    return &image->secondaryCommands[secondaryIndex];
+}
+
+// MARK: - Writing images
+
+// A simple growable array; 'count' and 'capacity' are in items (not bytes)
+typedef struct {
+    void* items;
+    size_t count;
+    size_t capacity;
+    size_t itemSize;
+} VNScriptImageArray;
+
+static int VNScriptImageArrayReserve(VNScriptImageArray* array, size_t additional)
+{
+    if( array->count + additional <= array->capacity )
+        return 1;
+
+    size_t newCapacity = (array->capacity > 0) ? array->capacity * 2 : 64;
+    while( newCapacity < array->count + additional )
+        newCapacity *= 2;
+
+    void* newItems = realloc(array->items, newCapacity * array->itemSize);
+    if( newItems == NULL )
+        return 0;
+
+    array->items = newItems;
+    array->capacity = newCapacity;
+    return 1;
+}
+
+// Appends items and returns the index of the first one (or VNScriptImageNotFound if memory ran out)
+static uint32_t VNScriptImageArrayAppend(VNScriptImageArray* array, const void* items, size_t count)
+{
+    if( VNScriptImageArrayReserve(array, count) == 0 )
+        return VNScriptImageNotFound;
+
+    uint32_t firstIndex = (uint32_t)array->count;
+    memcpy((uint8_t*)array->items + (array->count * array->itemSize), items, count * array->itemSize);
+    array->count += count;
+
+    return firstIndex;
+}
+
+struct VNScriptImageBuilder {
+    VNScriptImageArray conversations;   // VNScriptConversationEntry
+    VNScriptImageArray commands;        // VNScriptCommandRecord
+    VNScriptImageArray secondary;       // VNScriptCommandRecord
+    VNScriptImageArray lists;           // uint32_t
+    VNScriptImageArray strings;         // VNScriptStringEntry
+    VNScriptImageArray pool;            // char
+
+    // Hash table used to intern strings. Each slot holds (string index + 1), so zero means "empty slot"
+    uint32_t* stringHashes;
+    size_t stringHashCapacity;
+
+    int isInConversation;
+    VNScriptConversationEntry currentConversation;
+};
+
+VNScriptImageBuilder* VNScriptImageBuilderCreate(void)
+{
+    VNScriptImageBuilder* builder = calloc(1, sizeof(VNScriptImageBuilder));
+    if( builder == NULL )
+        return NULL;
+
+    builder->conversations.itemSize = sizeof(VNScriptConversationEntry);
+    builder->commands.itemSize      = sizeof(VNScriptCommandRecord);
+    builder->secondary.itemSize     = sizeof(VNScriptCommandRecord);
+    builder->lists.itemSize         = sizeof(uint32_t);
+    builder->strings.itemSize       = sizeof(VNScriptStringEntry);
+    builder->pool.itemSize          = sizeof(char);
+
+    return builder;
+}
+
+void VNScriptImageBuilderFree(VNScriptImageBuilder* builder)
+{
+    if( builder == NULL )
+        return;
+
+    free(builder->conversations.items);
+    free(builder->commands.items);
+    free(builder->secondary.items);
+    free(builder->lists.items);
+    free(builder->strings.items);
+    free(builder->pool.items);
+    free(builder->stringHashes);
+    free(builder);
+}
+
+// FNV-1a; it's fast, simple, and good enough for script text
+static uint32_t VNScriptImageHashString(const char* string, size_t length)
+{
+    uint32_t hash = 2166136261u;
+
+    for( size_t i = 0; i < length; i++ ) {
+        hash ^= (uint8_t)string[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static int VNScriptImageBuilderStringMatches(VNScriptImageBuilder* builder, uint32_t index, const char* string, size_t length)
+{
+    const VNScriptStringEntry* entry = (const VNScriptStringEntry*)builder->strings.items + index;
+    const char* pool = (const char*)builder->pool.items;
+
+    return entry->length == length && memcmp(pool + entry->offset, string, length) == 0;
+}
+
+// Grows the hash table (and re-inserts every string) once it gets more than half full
+static int VNScriptImageBuilderGrowStringHashes(VNScriptImageBuilder* builder)
+{
+    size_t newCapacity = (builder->stringHashCapacity > 0) ? builder->stringHashCapacity * 2 : 1024;
+    uint32_t* newHashes = calloc(newCapacity, sizeof(uint32_t));
+    if( newHashes == NULL )
+        return 0;
+
+    const VNScriptStringEntry* entries = (const VNScriptStringEntry*)builder->strings.items;
+    const char* pool = (const char*)builder->pool.items;
+
+    for( size_t i = 0; i < builder->strings.count; i++ ) {
+        size_t slot = VNScriptImageHashString(pool + entries[i].offset, entries[i].length) & (newCapacity - 1);
+        while( newHashes[slot] != 0 )
+            slot = (slot + 1) & (newCapacity - 1);
+        newHashes[slot] = (uint32_t)i + 1;
+    }
+
+    free(builder->stringHashes);
+    builder->stringHashes = newHashes;
+    builder->stringHashCapacity = newCapacity;
+    return 1;
+}
+
+uint32_t VNScriptImageBuilderInternString(VNScriptImageBuilder* builder, const char* string, size_t length)
+{
+    if( builder == NULL || string == NULL )
+        return VNScriptImageNotFound;
+
+    if( (builder->strings.count + 1) * 2 > builder->stringHashCapacity ) {
+        if( VNScriptImageBuilderGrowStringHashes(builder) == 0 )
+            return VNScriptImageNotFound;
+    }
+
+    // Check if this string has already been added
+    size_t mask = builder->stringHashCapacity - 1;
+    size_t slot = VNScriptImageHashString(string, length) & mask;
+    while( builder->stringHashes[slot] != 0 ) {
+        uint32_t existingIndex = builder->stringHashes[slot] - 1;
+        if( VNScriptImageBuilderStringMatches(builder, existingIndex, string, length) )
+            return existingIndex;
+        slot = (slot + 1) & mask;
+    }
+
+    // It's a new string; copy it (plus a null terminator) to the end of the pool
+    VNScriptStringEntry entry;
+    entry.offset = (uint32_t)builder->pool.count;
+    entry.length = (uint32_t)length;
+
+    const char terminator = '\0';
+    if( VNScriptImageArrayAppend(&builder->pool, string, length) == VNScriptImageNotFound ||
+        VNScriptImageArrayAppend(&builder->pool, &terminator, 1) == VNScriptImageNotFound )
+        return VNScriptImageNotFound;
+
+    uint32_t index = VNScriptImageArrayAppend(&builder->strings, &entry, 1);
+    if( index != VNScriptImageNotFound )
+        builder->stringHashes[slot] = index + 1;
+
+    return index;
+}
+
+uint32_t VNScriptImageBuilderAddStringList(VNScriptImageBuilder* builder, const uint32_t* strings, uint32_t count)
+{
+    if( builder == NULL )
+        return VNScriptImageNotFound;
+    if( count == 0 )
+        return (uint32_t)builder->lists.count;
+
+    return VNScriptImageArrayAppend(&builder->lists, strings, count);
+}
+
+uint32_t VNScriptImageBuilderAddSecondaryCommand(VNScriptImageBuilder* builder, const VNScriptCommandRecord* record)
+{
+    if( builder == NULL || record == NULL )
+        return VNScriptImageNotFound;
+
+    return VNScriptImageArrayAppend(&builder->secondary, record, 1);
+}
+
+void VNScriptImageBuilderBeginConversation(VNScriptImageBuilder* builder, const char* name, size_t length)
+{
+    if( builder == NULL )
+        return;
+
+    if( builder->isInConversation )
+        VNScriptImageBuilderEndConversation(builder);
+
+    builder->currentConversation.name           = VNScriptImageBuilderInternString(builder, name, length);
+    builder->currentConversation.firstCommand   = (uint32_t)builder->commands.count;
+    builder->currentConversation.commandCount   = 0;
+    builder->isInConversation                   = 1;
+}
+
+void VNScriptImageBuilderAddCommand(VNScriptImageBuilder* builder, const VNScriptCommandRecord* record)
+{
+    if( builder == NULL || record == NULL || builder->isInConversation == 0 )
+        return;
+
+    if( VNScriptImageArrayAppend(&builder->commands, record, 1) != VNScriptImageNotFound )
+        builder->currentConversation.commandCount++;
+}
+
+void VNScriptImageBuilderEndConversation(VNScriptImageBuilder* builder)
+{
+    if( builder == NULL || builder->isInConversation == 0 )
+        return;
+
+    VNScriptImageArrayAppend(&builder->conversations, &builder->currentConversation, 1);
+    builder->isInConversation = 0;
+}
+
+// Used when sorting the conversation table; the name is stored alongside each entry so that qsort() can compare them
+typedef struct {
+    VNScriptConversationEntry entry;
+    const char* name;
+    size_t length;
+} VNScriptImageSortableConversation;
+
+static int VNScriptImageCompareConversations(const void* a, const void* b)
+{
+    const VNScriptImageSortableConversation* first = (const VNScriptImageSortableConversation*)a;
+    const VNScriptImageSortableConversation* second = (const VNScriptImageSortableConversation*)b;
+
+    return VNScriptImageCompareNames(first->name, first->length, second->name, second->length);
+}
+
+// Sorts the conversation table by name, so that VNScriptImageFindConversation can do a binary search
+static int VNScriptImageBuilderSortConversations(VNScriptImageBuilder* builder)
+{
+    size_t count = builder->conversations.count;
+    if( count < 2 )
+        return 1;
+
+    VNScriptImageSortableConversation* sortable = malloc(count * sizeof(VNScriptImageSortableConversation));
+    if( sortable == NULL )
+        return 0;
+
+    VNScriptConversationEntry* entries = (VNScriptConversationEntry*)builder->conversations.items;
+    const VNScriptStringEntry* strings = (const VNScriptStringEntry*)builder->strings.items;
+    const char* pool = (const char*)builder->pool.items;
+
+    for( size_t i = 0; i < count; i++ ) {
+        sortable[i].entry   = entries[i];
+        sortable[i].name    = pool + strings[entries[i].name].offset;
+        sortable[i].length  = strings[entries[i].name].length;
+    }
+
+    qsort(sortable, count, sizeof(VNScriptImageSortableConversation), VNScriptImageCompareConversations);
+
+    for( size_t i = 0; i < count; i++ )
+        entries[i] = sortable[i].entry;
+
+    free(sortable);
+    return 1;
+}
+
+void* VNScriptImageBuilderCopyBytes(VNScriptImageBuilder* builder, size_t* outLength)
+{
+    if( builder == NULL )
+        return NULL;
+
+    if( builder->isInConversation )
+        VNScriptImageBuilderEndConversation(builder);
+
+    if( VNScriptImageBuilderSortConversations(builder) == 0 )
+        return NULL;
+
+    // Figure out where each section goes
+    VNScriptImageHeader header;
+    memset(&header, 0, sizeof(header));
+
+    size_t offset = VNScriptImageAligned(sizeof(VNScriptImageHeader));
+    header.conversationsOffset  = (uint32_t)offset;
+    header.conversationCount    = (uint32_t)builder->conversations.count;
+    offset = VNScriptImageAligned(offset + builder->conversations.count * sizeof(VNScriptConversationEntry));
+    header.commandsOffset       = (uint32_t)offset;
+    header.commandCount         = (uint32_t)builder->commands.count;
+    offset = VNScriptImageAligned(offset + builder->commands.count * sizeof(VNScriptCommandRecord));
+    header.secondaryOffset      = (uint32_t)offset;
+    header.secondaryCount       = (uint32_t)builder->secondary.count;
+    offset = VNScriptImageAligned(offset + builder->secondary.count * sizeof(VNScriptCommandRecord));
+    header.listsOffset          = (uint32_t)offset;
+    header.listItemCount        = (uint32_t)builder->lists.count;
+    offset = VNScriptImageAligned(offset + builder->lists.count * sizeof(uint32_t));
+    header.stringTableOffset    = (uint32_t)offset;
+    header.stringCount          = (uint32_t)builder->strings.count;
+    offset = VNScriptImageAligned(offset + builder->strings.count * sizeof(VNScriptStringEntry));
+    header.stringPoolOffset     = (uint32_t)offset;
+    header.stringPoolSize       = (uint32_t)builder->pool.count;
+    offset = VNScriptImageAligned(offset + builder->pool.count);
+
+    if( offset > UINT32_MAX ) {
+        fprintf(stderr, "[VNScriptImage] ERROR: Script is too large to be compiled.\n");
+        return NULL;
+    }
+
+    header.magic        = VNScriptImageMagic;
+    header.version      = VNScriptImageVersion;
+    header.imageSize    = (uint32_t)offset;
+    header.recordSize   = (uint32_t)sizeof(VNScriptCommandRecord);
+
+    // The padding between sections is zeroed out so that compiling the same script always produces identical files
+    uint8_t* bytes = calloc(1, offset);
+    if( bytes == NULL )
+        return NULL;
+
+    memcpy(bytes, &header, sizeof(header));
+    memcpy(bytes + header.conversationsOffset, builder->conversations.items, builder->conversations.count * sizeof(VNScriptConversationEntry));
+    memcpy(bytes + header.commandsOffset, builder->commands.items, builder->commands.count * sizeof(VNScriptCommandRecord));
+    memcpy(bytes + header.secondaryOffset, builder->secondary.items, builder->secondary.count * sizeof(VNScriptCommandRecord));
+    memcpy(bytes + header.listsOffset, builder->lists.items, builder->lists.count * sizeof(uint32_t));
+    memcpy(bytes + header.stringTableOffset, builder->strings.items, builder->strings.count * sizeof(VNScriptStringEntry));
+    memcpy(bytes + header.stringPoolOffset, builder->pool.items, builder->pool.count);
+
+    if( outLength )
+        *outLength = offset;
+
+    return bytes;
+}
+
+int VNScriptImageBuilderWriteFile(VNScriptImageBuilder* builder, const char* path)
+{
+    size_t length = 0;
+    void* bytes = VNScriptImageBuilderCopyBytes(builder, &length);
+    if( bytes == NULL || path == NULL ) {
+        free(bytes);
+        return -1;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if( file == NULL ) {
+        fprintf(stderr, "[VNScriptImage] ERROR: Could not open %s for writing.\n", path);
+        free(bytes);
+        return -1;
+    }
+
+    size_t written = fwrite(bytes, 1, length, file);
+    int closeResult = fclose(file);
+    free(bytes);
+
+    return (written == length && closeResult == 0) ? 0 : -1;
+}
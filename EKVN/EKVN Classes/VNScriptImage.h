@@ -0,0 +1,184 @@
+//
+//  VNScriptImage.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNScriptImage
+
+ A "script image" is a precompiled, binary version of a script .plist file. Normally, VNScript loads a script by
+ reading the entire Property List into an NSDictionary and then translating every line of every conversation into
+ arrays of NSNumber/NSString objects. That's fine for small scripts, but on long routes it ends up being most of the
+ time spent starting a scene. A script image holds the result of that translation, so loading one is just a matter of
+ mapping the file into memory (with mmap) and pointing at the right places. Nothing gets parsed, and since the file is
+ mapped read-only, the pages can be shared/dropped by the OS instead of sitting around as a heap of NSArrays.
+
+ The image is laid out like this (all values are little-endian, and every section starts on an 8-byte boundary):
+
+   1. HEADER               - Magic number, format version, and the offset/count of every other section
+   2. CONVERSATION TABLE   - One entry per conversation: name (string index), first command, number of commands.
+                             The table is sorted by name so that conversations can be found with a binary search.
+   3. COMMAND STREAM       - Fixed-width command records. Each conversation's commands are stored contiguously.
+   4. SECONDARY COMMANDS   - Commands that are nested inside other commands (like the command run by .ISFLAG)
+   5. STRING LISTS         - Arrays of string indexes (used by commands like .JUMPONCHOICE that have lists of text)
+   6. STRING TABLE         - Offset/length pairs for each string in the string pool
+   7. STRING POOL          - Every string used by the script, stored once (UTF-8, null-terminated)
+
+ Script images are created offline with the compiler functions in VNScript (see "compileScriptFile:toFile:") and are
+ stored in the app bundle with the ".vnsb" extension alongside (or instead of) the original .plist file.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNScriptImage_h
+#define VNScriptImage_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNScriptImageMagic                  0x42534E56  // "VNSB" when read as little-endian bytes
+#define VNScriptImageVersion                1
+#define VNScriptImageFileExtension          "vnsb"
+#define VNScriptImageMaxOperands            5           // The most parameters any (translated) command can have
+#define VNScriptImageNotFound               UINT32_MAX
+
+// What kind of data is stored in each operand (parameter) of a command record
+typedef enum {
+    VNScriptOperandNone         = 0,
+    VNScriptOperandInteger      = 1, // Stored in 'integer'
+    VNScriptOperandBool         = 2, // Stored in 'integer' (either 0 or 1)
+    VNScriptOperandNumber       = 3, // Stored in 'number' (floating-point)
+    VNScriptOperandString       = 4, // 'ref.index' is an index in the string table
+    VNScriptOperandStringList   = 5, // 'ref.index' is the first item in the string lists section, 'ref.count' is the number of strings
+    VNScriptOperandCommand      = 6, // 'ref.index' is an index in the secondary commands section
+} VNScriptOperandKind;
+
+typedef union {
+    int64_t integer;
+    double number;
+    struct {
+        uint32_t index;
+        uint32_t count;
+    } ref;
+} VNScriptOperand;
+
+// A single translated line from the script. Every record is the same size (48 bytes), regardless of command type.
+typedef struct {
+    uint16_t type;                                      // One of the VNScriptCommand values
+    uint8_t operandCount;                               // How many of the operands are actually used
+    uint8_t kinds[VNScriptImageMaxOperands];            // VNScriptOperandKind for each operand
+    VNScriptOperand operands[VNScriptImageMaxOperands];
+} VNScriptCommandRecord;
+
+typedef struct {
+    uint32_t name;          // Index in string table
+    uint32_t firstCommand;  // Index in command stream
+    uint32_t commandCount;
+} VNScriptConversationEntry;
+
+typedef struct {
+    uint32_t offset;        // Offset from the start of the string pool
+    uint32_t length;        // Length in bytes (not counting the null terminator)
+} VNScriptStringEntry;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t imageSize;
+    uint32_t recordSize;    // sizeof(VNScriptCommandRecord) when the image was written
+
+    uint32_t conversationCount;
+    uint32_t conversationsOffset;
+    uint32_t commandCount;
+    uint32_t commandsOffset;
+    uint32_t secondaryCount;
+    uint32_t secondaryOffset;
+    uint32_t listItemCount;
+    uint32_t listsOffset;
+    uint32_t stringCount;
+    uint32_t stringTableOffset;
+    uint32_t stringPoolSize;
+    uint32_t stringPoolOffset;
+} VNScriptImageHeader;
+
+// MARK: - Reading images
+
+typedef struct {
+    const uint8_t* bytes;
+    size_t length;
+    int isMapped;   // If set, 'bytes' was mapped with mmap and gets unmapped when the image is closed
+    int ownsBytes;  // If set, 'bytes' was allocated with malloc and gets freed when the image is closed
+
+    const VNScriptImageHeader* header;
+    const VNScriptConversationEntry* conversations;
+    const VNScriptCommandRecord* commands;
+    const VNScriptCommandRecord* secondaryCommands;
+    const uint32_t* lists;
+    const VNScriptStringEntry* strings;
+    const char* stringPool;
+} VNScriptImage;
+
+// Maps a compiled script file into memory (read-only). Returns NULL if the file doesn't exist or isn't a valid image.
+VNScriptImage* VNScriptImageOpenFile(const char* path);
+
+// Uses an image that's already in memory. The bytes are NOT copied, so they need to stay valid until the image is closed.
+VNScriptImage* VNScriptImageOpenBytes(const void* bytes, size_t length);
+
+// Same as above, except that the image takes ownership of the bytes (which must have been allocated with malloc, such as
+// the bytes returned by VNScriptImageBuilderCopyBytes). If the image can't be opened, the caller still owns the bytes.
+VNScriptImage* VNScriptImageOpenOwnedBytes(void* bytes, size_t length);
+
+void VNScriptImageClose(VNScriptImage* image);
+
+// Returns a (null-terminated) string from the string pool; the length is stored in 'outLength' if it isn't NULL
+const char* VNScriptImageString(const VNScriptImage* image, uint32_t index, uint32_t* outLength);
+
+// Finds a conversation by name. Returns its index in the conversation table, or VNScriptImageNotFound.
+uint32_t VNScriptImageFindConversation(const VNScriptImage* image, const char* name, size_t length);
+
+// MARK: - Reading commands
+
+// These read one of a command's operands as a plain C value, which is what the interpreter uses instead of unboxing
+// NSNumber objects. Operands stored as text get converted the same way NSString's intValue/doubleValue/boolValue would
+// (some commands, like .ISFLAGBETWEEN, keep their numbers as strings). Missing operands and strings that can't be
+// found in the image are treated as zero.
+int64_t VNScriptImageOperandInteger(const VNScriptImage* image, const VNScriptCommandRecord* record, int index);
+double VNScriptImageOperandNumber(const VNScriptImage* image, const VNScriptCommandRecord* record, int index);
+int VNScriptImageOperandBool(const VNScriptImage* image, const VNScriptCommandRecord* record, int index);
+
+// Returns the nested command stored in an operand, or NULL if that operand isn't a (valid) command
+const VNScriptCommandRecord* VNScriptImageOperandCommand(const VNScriptImage* image, const VNScriptCommandRecord* record, int index);
+
+// MARK: - Writing images
+
+typedef struct VNScriptImageBuilder VNScriptImageBuilder;
+
+VNScriptImageBuilder* VNScriptImageBuilderCreate(void);
+void VNScriptImageBuilderFree(VNScriptImageBuilder* builder);
+
+// Adds a string to the string pool (if an identical string was already added, the existing index is returned)
+uint32_t VNScriptImageBuilderInternString(VNScriptImageBuilder* builder, const char* string, size_t length);
+
+// Adds a list of string indexes; returns the index of the first item in the list
+uint32_t VNScriptImageBuilderAddStringList(VNScriptImageBuilder* builder, const uint32_t* strings, uint32_t count);
+
+// Adds a nested command (used by commands like .ISFLAG); returns its index in the secondary commands section
+uint32_t VNScriptImageBuilderAddSecondaryCommand(VNScriptImageBuilder* builder, const VNScriptCommandRecord* record);
+
+// Conversations are written one at a time; every command added between "begin" and "end" belongs to that conversation.
+void VNScriptImageBuilderBeginConversation(VNScriptImageBuilder* builder, const char* name, size_t length);
+void VNScriptImageBuilderAddCommand(VNScriptImageBuilder* builder, const VNScriptCommandRecord* record);
+void VNScriptImageBuilderEndConversation(VNScriptImageBuilder* builder);
+
+// Creates the finished image. The returned buffer is allocated with malloc() and must be freed by the caller.
+void* VNScriptImageBuilderCopyBytes(VNScriptImageBuilder* builder, size_t* outLength);
+
+// Writes the finished image to a file. Returns 0 on success, -1 on failure.
+int VNScriptImageBuilderWriteFile(VNScriptImageBuilder* builder, const char* path);
+
+#endif
@@ -0,0 +1,630 @@
+//
+//  VNScriptStream.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNScriptStream.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#define VNScriptStreamBinaryMagic       "bplist"
+#define VNScriptStreamMaxEntityLength   10  // Long enough for "#x10FFFF" (plus a little extra)
+
+// MARK: - Parser
+
+// The only elements that the parser cares about; everything else (integer, real, true, data...) is "other"
+typedef enum {
+    VNScriptStreamElementPlist,
+    VNScriptStreamElementDict,
+    VNScriptStreamElementArray,
+    VNScriptStreamElementKey,
+    VNScriptStreamElementString,
+    VNScriptStreamElementOther,
+} VNScriptStreamElement;
+
+typedef enum {
+    VNScriptStreamStateText,        // Between tags
+    VNScriptStreamStateEntity,      // After an '&' in some text
+    VNScriptStreamStateTag,         // After a '<'
+    VNScriptStreamStateComment,     // Inside of <!-- -->
+    VNScriptStreamStateCData,       // Inside of <![CDATA[ ]]>
+} VNScriptStreamState;
+
+typedef struct {
+    char* bytes;
+    size_t length;
+    size_t capacity;
+} VNScriptStreamBuffer;
+
+typedef struct {
+    const VNScriptStreamCallbacks* callbacks;
+    void* context;
+    VNScriptStreamState state;
+
+    // The text of the key or line being read, and the last key that was read (which is waiting for its value). These
+    // are the only buffers that grow, and they only ever get as big as the longest string in the script.
+    VNScriptStreamBuffer text;
+    VNScriptStreamBuffer key;
+    int capturing;
+    int hasKey;
+
+    char tag[VNScriptStreamMaxTagLength + 1];
+    size_t tagLength;
+    char entity[VNScriptStreamMaxEntityLength + 1];
+    size_t entityLength;
+    int markerCount;                // Number of '-' (in a comment) or ']' (in a CDATA section) seen in a row
+
+    // Open elements, and where the interesting ones are. Depths count the elements that are open; zero means "none".
+    uint8_t elements[VNScriptStreamMaxDepth];
+    int depth;
+    int rootDepth;                  // Depth of the elements inside of the root dictionary
+    int conversationDepth;          // Depth of the elements inside of the current conversation's array
+    int finishedRoot;
+
+    uint32_t lineNumber;            // Line in the file (not in the script), for error messages
+    size_t readBufferSize;
+
+    VNScriptStreamStats stats;
+    VNScriptStreamResult result;
+    char* error;
+    size_t errorSize;
+} VNScriptStreamParser;
+
+// Only the first error gets reported; the parser ignores everything after it
+static void VNScriptStreamFail(VNScriptStreamParser* parser, VNScriptStreamResult result, const char* format, ...)
+{
+    if( parser->result != VNScriptStreamOK )
+        return;
+
+    parser->result = result;
+
+    if( parser->error != NULL && parser->errorSize > 0 ) {
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(parser->error, parser->errorSize, format, arguments);
+        va_end(arguments);
+    }
+}
+
+static void VNScriptStreamUpdateMemoryStats(VNScriptStreamParser* parser)
+{
+    size_t memory = parser->readBufferSize + parser->text.capacity + parser->key.capacity;
+    if( memory > parser->stats.parserMemory )
+        parser->stats.parserMemory = memory;
+}
+
+static void VNScriptStreamAppend(VNScriptStreamParser* parser, const char* bytes, size_t length)
+{
+    VNScriptStreamBuffer* buffer = &parser->text;
+
+    // Leave room for the null terminator that gets added before the text is handed to a callback
+    if( buffer->length + length + 1 > buffer->capacity ) {
+        size_t capacity = (buffer->capacity > 0) ? buffer->capacity : 256;
+        while( buffer->length + length + 1 > capacity )
+            capacity *= 2;
+
+        char* grown = realloc(buffer->bytes, capacity);
+        if( grown == NULL ) {
+            VNScriptStreamFail(parser, VNScriptStreamErrorMemory, "Out of memory on line %u", parser->lineNumber);
+            return;
+        }
+
+        buffer->bytes = grown;
+        buffer->capacity = capacity;
+        VNScriptStreamUpdateMemoryStats(parser);
+    }
+
+    memcpy(buffer->bytes + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+static void VNScriptStreamAppendCharacter(VNScriptStreamParser* parser, char character, int count)
+{
+    for( int i = 0; i < count; i++ )
+        VNScriptStreamAppend(parser, &character, 1);
+}
+
+// Finishes the text that was being captured, and returns it (null-terminated)
+static const char* VNScriptStreamFinishText(VNScriptStreamParser* parser)
+{
+    VNScriptStreamAppend(parser, "", 0);
+    if( parser->text.bytes == NULL )
+        return "";
+
+    parser->text.bytes[parser->text.length] = '\0';
+    return parser->text.bytes;
+}
+
+// MARK: - Entities
+
+static int VNScriptStreamEncodeUTF8(uint32_t codepoint, char* output)
+{
+    if( codepoint < 0x80 ) {
+        output[0] = (char)codepoint;
+        return 1;
+    }
+    if( codepoint < 0x800 ) {
+        output[0] = (char)(0xC0 | (codepoint >> 6));
+        output[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if( codepoint < 0x10000 ) {
+        output[0] = (char)(0xE0 | (codepoint >> 12));
+        output[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        output[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+
+    output[0] = (char)(0xF0 | (codepoint >> 18));
+    output[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    output[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    output[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+static void VNScriptStreamDecodeEntity(VNScriptStreamParser* parser)
+{
+    const char* entity = parser->entity;
+    parser->entity[parser->entityLength] = '\0';
+
+    if( strcmp(entity, "lt") == 0 )
+        VNScriptStreamAppend(parser, "<", 1);
+    else if( strcmp(entity, "gt") == 0 )
+        VNScriptStreamAppend(parser, ">", 1);
+    else if( strcmp(entity, "amp") == 0 )
+        VNScriptStreamAppend(parser, "&", 1);
+    else if( strcmp(entity, "quot") == 0 )
+        VNScriptStreamAppend(parser, "\"", 1);
+    else if( strcmp(entity, "apos") == 0 )
+        VNScriptStreamAppend(parser, "'", 1);
+    else if( entity[0] == '#' ) {
+
+        // Character references, like &#233; or &#xE9;
+        int isHex = (entity[1] == 'x' || entity[1] == 'X');
+        const char* digits = entity + (isHex ? 2 : 1);
+        char* end = NULL;
+        unsigned long codepoint = strtoul(digits, &end, isHex ? 16 : 10);
+
+        if( *digits == '\0' || *end != '\0' || codepoint == 0 || codepoint > 0x10FFFF ||
+            (codepoint >= 0xD800 && codepoint <= 0xDFFF) ) {
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Invalid character reference &%s; on line %u", entity, parser->lineNumber);
+            return;
+        }
+
+        char encoded[4];
+        VNScriptStreamAppend(parser, encoded, (size_t)VNScriptStreamEncodeUTF8((uint32_t)codepoint, encoded));
+
+    } else {
+        VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Unknown entity &%s; on line %u", entity, parser->lineNumber);
+    }
+}
+
+// MARK: - Elements
+
+static VNScriptStreamElement VNScriptStreamElementNamed(const char* name, size_t length)
+{
+    if( length == 5 && memcmp(name, "plist", 5) == 0 )
+        return VNScriptStreamElementPlist;
+    if( length == 4 && memcmp(name, "dict", 4) == 0 )
+        return VNScriptStreamElementDict;
+    if( length == 5 && memcmp(name, "array", 5) == 0 )
+        return VNScriptStreamElementArray;
+    if( length == 3 && memcmp(name, "key", 3) == 0 )
+        return VNScriptStreamElementKey;
+    if( length == 6 && memcmp(name, "string", 6) == 0 )
+        return VNScriptStreamElementString;
+
+    return VNScriptStreamElementOther;
+}
+
+static void VNScriptStreamOpenElement(VNScriptStreamParser* parser, VNScriptStreamElement element, const char* name, int nameLength)
+{
+    if( parser->depth > 0 ) {
+        VNScriptStreamElement parent = parser->elements[parser->depth - 1];
+        if( parent == VNScriptStreamElementKey || parent == VNScriptStreamElementString ) {
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Unexpected <%.*s> inside of a string on line %u", nameLength, name, parser->lineNumber);
+            return;
+        }
+    }
+    if( parser->depth >= VNScriptStreamMaxDepth ) {
+        VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Elements are nested too deeply on line %u", parser->lineNumber);
+        return;
+    }
+
+    if( parser->rootDepth == 0 ) {
+
+        // Nothing matters until the root dictionary shows up (apart from the <plist> tag around it)
+        if( parser->finishedRoot ) {
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Unexpected <%.*s> after the root dictionary on line %u", nameLength, name, parser->lineNumber);
+            return;
+        }
+        if( element == VNScriptStreamElementDict ) {
+            parser->rootDepth = parser->depth + 1;
+        } else if( element != VNScriptStreamElementPlist || parser->depth != 0 ) {
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "The root object isn't a dictionary (found <%.*s> on line %u)", nameLength, name, parser->lineNumber);
+            return;
+        }
+
+    } else if( parser->depth == parser->rootDepth ) {
+
+        // Inside the root dictionary, there's a key and then a value. Arrays are conversations; anything else gets skipped.
+        if( element == VNScriptStreamElementKey ) {
+            if( parser->hasKey ) {
+                VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Key \"%s\" has no value (line %u)", parser->key.bytes, parser->lineNumber);
+                return;
+            }
+
+            parser->capturing = 1;
+            parser->text.length = 0;
+
+        } else {
+            if( parser->hasKey == 0 ) {
+                VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Found <%.*s> without a key on line %u", nameLength, name, parser->lineNumber);
+                return;
+            }
+
+            parser->hasKey = 0;
+
+            if( element == VNScriptStreamElementArray ) {
+                parser->conversationDepth = parser->depth + 1;
+                parser->stats.conversationCount++;
+
+                if( parser->callbacks->beginConversation )
+                    parser->callbacks->beginConversation(parser->context, parser->key.bytes, parser->key.length);
+            }
+        }
+
+    } else if( parser->conversationDepth > 0 && parser->depth == parser->conversationDepth && element == VNScriptStreamElementString ) {
+
+        parser->capturing = 1;
+        parser->text.length = 0;
+    }
+
+    parser->elements[parser->depth++] = (uint8_t)element;
+}
+
+static void VNScriptStreamCloseElement(VNScriptStreamParser* parser, VNScriptStreamElement element, const char* name, int nameLength)
+{
+    if( parser->depth == 0 || parser->elements[parser->depth - 1] != element ) {
+        VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Unexpected </%.*s> on line %u", nameLength, name, parser->lineNumber);
+        return;
+    }
+
+    parser->depth--;
+
+    // Since keys and strings can't have anything nested inside of them, the element being captured is always the one that just closed
+    if( parser->capturing ) {
+
+        parser->capturing = 0;
+        const char* text = VNScriptStreamFinishText(parser);
+        if( parser->result != VNScriptStreamOK )
+            return;
+
+        if( element == VNScriptStreamElementKey ) {
+
+            // Swapping the buffers saves having to copy the key
+            VNScriptStreamBuffer previousKey = parser->key;
+            parser->key = parser->text;
+            parser->text = previousKey;
+            parser->hasKey = 1;
+
+        } else {
+
+            parser->stats.lineCount++;
+            if( parser->text.length > parser->stats.longestString )
+                parser->stats.longestString = parser->text.length;
+
+            if( parser->callbacks->addLine )
+                parser->callbacks->addLine(parser->context, text, parser->text.length);
+        }
+    }
+
+    if( element == VNScriptStreamElementArray && parser->conversationDepth > 0 && parser->depth == parser->conversationDepth - 1 ) {
+
+        parser->conversationDepth = 0;
+        if( parser->callbacks->endConversation )
+            parser->callbacks->endConversation(parser->context);
+
+    } else if( element == VNScriptStreamElementDict && parser->rootDepth > 0 && parser->depth == parser->rootDepth - 1 ) {
+
+        if( parser->hasKey ) {
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Key \"%s\" has no value (line %u)", parser->key.bytes, parser->lineNumber);
+            return;
+        }
+
+        parser->rootDepth = 0;
+        parser->finishedRoot = 1;
+    }
+}
+
+static void VNScriptStreamHandleTag(VNScriptStreamParser* parser)
+{
+    char* tag = parser->tag;
+    size_t length = parser->tagLength;
+    tag[length] = '\0';
+
+    // Processing instructions (<?xml ... ?>) and declarations (<!DOCTYPE ...>) don't affect anything
+    if( length > 0 && (tag[0] == '?' || tag[0] == '!') )
+        return;
+
+    int isClosing = (length > 0 && tag[0] == '/');
+    while( length > 0 && (tag[length - 1] == ' ' || tag[length - 1] == '\t' || tag[length - 1] == '\r' || tag[length - 1] == '\n') )
+        length--;
+
+    int isEmpty = (isClosing == 0 && length > 0 && tag[length - 1] == '/'); // Like <string/>
+    if( isEmpty )
+        length--;
+
+    // The name ends at the first space (anything after it is an attribute, like the version in <plist version="1.0">)
+    const char* name = tag + isClosing;
+    size_t nameLength = strcspn(name, " \t\r\n/");
+    if( nameLength == 0 || (size_t)isClosing + nameLength > length ) {
+        VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Invalid tag <%s> on line %u", tag, parser->lineNumber);
+        return;
+    }
+
+    VNScriptStreamElement element = VNScriptStreamElementNamed(name, nameLength);
+
+    if( isClosing ) {
+        VNScriptStreamCloseElement(parser, element, name, (int)nameLength);
+    } else {
+        VNScriptStreamOpenElement(parser, element, name, (int)nameLength);
+        if( isEmpty )
+            VNScriptStreamCloseElement(parser, element, name, (int)nameLength);
+    }
+}
+
+// MARK: - Reading
+
+static void VNScriptStreamFeed(VNScriptStreamParser* parser, const char* bytes, size_t length)
+{
+    parser->stats.bytesRead += length;
+
+    for( size_t i = 0; i < length && parser->result == VNScriptStreamOK; i++ ) {
+
+        char c = bytes[i];
+        if( c == '\n' )
+            parser->lineNumber++;
+
+        switch( parser->state ) {
+
+            case VNScriptStreamStateText: {
+
+                if( c == '<' ) {
+                    parser->state = VNScriptStreamStateTag;
+                    parser->tagLength = 0;
+                } else if( parser->capturing ) {
+
+                    if( c == '&' ) {
+                        parser->state = VNScriptStreamStateEntity;
+                        parser->entityLength = 0;
+                        continue;
+                    }
+
+                    // Copy as much plain text as possible in one go, instead of a character at a time
+                    size_t end = i + 1;
+                    while( end < length && bytes[end] != '<' && bytes[end] != '&' ) {
+                        if( bytes[end] == '\n' )
+                            parser->lineNumber++;
+                        end++;
+                    }
+
+                    VNScriptStreamAppend(parser, bytes + i, end - i);
+                    i = end - 1;
+                }
+
+            }break;
+
+            case VNScriptStreamStateEntity: {
+
+                if( c == ';' ) {
+                    VNScriptStreamDecodeEntity(parser);
+                    parser->state = VNScriptStreamStateText;
+                } else if( parser->entityLength >= VNScriptStreamMaxEntityLength ) {
+                    VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Unterminated entity on line %u", parser->lineNumber);
+                } else {
+                    parser->entity[parser->entityLength++] = c;
+                }
+
+            }break;
+
+            case VNScriptStreamStateTag: {
+
+                if( c == '>' ) {
+                    parser->state = VNScriptStreamStateText;
+                    VNScriptStreamHandleTag(parser);
+                    continue;
+                }
+                if( parser->tagLength >= VNScriptStreamMaxTagLength ) {
+                    VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "Tag is too long on line %u", parser->lineNumber);
+                    continue;
+                }
+
+                parser->tag[parser->tagLength++] = c;
+
+                // Comments and CDATA sections can have '>' in them, so they get handled separately from other tags
+                if( parser->tagLength == 3 && memcmp(parser->tag, "!--", 3) == 0 ) {
+                    parser->state = VNScriptStreamStateComment;
+                    parser->markerCount = 0;
+                } else if( parser->tagLength == 8 && memcmp(parser->tag, "![CDATA[", 8) == 0 ) {
+                    parser->state = VNScriptStreamStateCData;
+                    parser->markerCount = 0;
+                }
+
+            }break;
+
+            case VNScriptStreamStateComment: {
+
+                if( c == '-' )
+                    parser->markerCount++;
+                else if( c == '>' && parser->markerCount >= 2 )
+                    parser->state = VNScriptStreamStateText;
+                else
+                    parser->markerCount = 0;
+
+            }break;
+
+            case VNScriptStreamStateCData: {
+
+                // The text is used exactly as it is (no entities), up until "]]>"
+                if( c == ']' ) {
+                    parser->markerCount++;
+                } else if( c == '>' && parser->markerCount >= 2 ) {
+                    if( parser->capturing )
+                        VNScriptStreamAppendCharacter(parser, ']', parser->markerCount - 2);
+                    parser->state = VNScriptStreamStateText;
+                } else {
+                    if( parser->capturing ) {
+                        VNScriptStreamAppendCharacter(parser, ']', parser->markerCount);
+                        VNScriptStreamAppend(parser, &c, 1);
+                    }
+                    parser->markerCount = 0;
+                }
+
+            }break;
+        }
+    }
+}
+
+static VNScriptStreamResult VNScriptStreamFinish(VNScriptStreamParser* parser, VNScriptStreamStats* stats)
+{
+    if( parser->result == VNScriptStreamOK ) {
+        if( parser->state != VNScriptStreamStateText || parser->depth != 0 )
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "The file ended unexpectedly (on line %u)", parser->lineNumber);
+        else if( parser->finishedRoot == 0 )
+            VNScriptStreamFail(parser, VNScriptStreamErrorMalformed, "The file doesn't have a root dictionary");
+    }
+
+    free(parser->text.bytes);
+    free(parser->key.bytes);
+
+    if( stats != NULL )
+        *stats = parser->stats;
+
+    return parser->result;
+}
+
+static void VNScriptStreamStart(VNScriptStreamParser* parser, const VNScriptStreamCallbacks* callbacks, void* context,
+                                char* error, size_t errorSize)
+{
+    memset(parser, 0, sizeof(VNScriptStreamParser));
+    parser->callbacks = callbacks;
+    parser->context = context;
+    parser->lineNumber = 1;
+    parser->error = error;
+    parser->errorSize = errorSize;
+
+    if( error != NULL && errorSize > 0 )
+        error[0] = '\0';
+}
+
+static int VNScriptStreamIsBinary(const void* bytes, size_t length)
+{
+    size_t magicLength = strlen(VNScriptStreamBinaryMagic);
+    return (length >= magicLength && memcmp(bytes, VNScriptStreamBinaryMagic, magicLength) == 0);
+}
+
+VNScriptStreamResult VNScriptStreamParseBytes(const void* bytes, size_t length, const VNScriptStreamCallbacks* callbacks,
+                                              void* context, VNScriptStreamStats* stats, char* error, size_t errorSize)
+{
+    VNScriptStreamParser parser;
+    VNScriptStreamStart(&parser, callbacks, context, error, errorSize);
+
+    if( bytes == NULL || callbacks == NULL ) {
+        VNScriptStreamFail(&parser, VNScriptStreamErrorFile, "No script data");
+    } else if( VNScriptStreamIsBinary(bytes, length) ) {
+        VNScriptStreamFail(&parser, VNScriptStreamErrorBinary, "Binary property lists can't be streamed");
+    } else {
+        VNScriptStreamFeed(&parser, bytes, length);
+    }
+
+    return VNScriptStreamFinish(&parser, stats);
+}
+
+VNScriptStreamResult VNScriptStreamParseFile(const char* path, const VNScriptStreamCallbacks* callbacks, void* context,
+                                             VNScriptStreamStats* stats, char* error, size_t errorSize)
+{
+    VNScriptStreamParser parser;
+    VNScriptStreamStart(&parser, callbacks, context, error, errorSize);
+
+    FILE* file = (path != NULL && callbacks != NULL) ? fopen(path, "rb") : NULL;
+    char* buffer = malloc(VNScriptStreamBufferSize);
+
+    if( file == NULL ) {
+        VNScriptStreamFail(&parser, VNScriptStreamErrorFile, "Could not open script file");
+    } else if( buffer == NULL ) {
+        VNScriptStreamFail(&parser, VNScriptStreamErrorMemory, "Out of memory");
+    } else {
+
+        parser.readBufferSize = VNScriptStreamBufferSize;
+        VNScriptStreamUpdateMemoryStats(&parser);
+
+        size_t length = fread(buffer, 1, VNScriptStreamBufferSize, file);
+        if( VNScriptStreamIsBinary(buffer, length) )
+            VNScriptStreamFail(&parser, VNScriptStreamErrorBinary, "Binary property lists can't be streamed");
+
+        while( length > 0 && parser.result == VNScriptStreamOK ) {
+            VNScriptStreamFeed(&parser, buffer, length);
+            length = fread(buffer, 1, VNScriptStreamBufferSize, file);
+        }
+
+        if( ferror(file) )
+            VNScriptStreamFail(&parser, VNScriptStreamErrorFile, "Could not read script file");
+    }
+
+    free(buffer);
+    if( file != NULL )
+        fclose(file);
+
+    return VNScriptStreamFinish(&parser, stats);
+}
+
+// MARK: - Memory use
+
+size_t VNScriptStreamResidentBytes(void)
+{
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if( task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS )
+        return 0;
+
+    return (size_t)info.resident_size;
+#elif defined(__linux__)
+    FILE* file = fopen("/proc/self/statm", "r");
+    if( file == NULL )
+        return 0;
+
+    unsigned long totalPages = 0;
+    unsigned long residentPages = 0;
+    int found = fscanf(file, "%lu %lu", &totalPages, &residentPages);
+    fclose(file);
+
+    return (found == 2) ? (size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+size_t VNScriptStreamPeakResidentBytes(void)
+{
+    struct rusage usage;
+    if( getrusage(RUSAGE_SELF, &usage) != 0 )
+        return 0;
+
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;         // Already in bytes
+#else
+    return (size_t)usage.ru_maxrss * 1024;  // Linux reports this in kilobytes
+#endif
+}
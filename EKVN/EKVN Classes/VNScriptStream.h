@@ -0,0 +1,97 @@
+//
+//  VNScriptStream.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNScriptStream
+
+ Reads a script .plist file (in XML format) a small piece at a time, and hands each conversation name and each line
+ of dialogue/commands to a set of callbacks as soon as it's been read. Loading a script with NSDictionary means the
+ entire file gets turned into an NSDictionary of NSArrays of NSStrings, and then translating it creates a second copy
+ of the whole script, so for really big scripts (like ones where several routes have been combined into one file)
+ the peak memory use ends up being about twice the size of the script. When the script is streamed, the only things
+ that stay in memory are the read buffer, the line that's currently being read, and whatever the callbacks decide
+ to keep (VNScript translates each line into a command record right away).
+
+ Only the parts of the Property List format that scripts actually use get reported:
+
+   <plist>
+     <dict>
+       <key>start</key>             <- beginConversation("start")
+       <array>
+         <string>Hello!</string>    <- addLine("Hello!")
+         ...
+       </array>                     <- endConversation()
+       ...
+     </dict>
+   </plist>
+
+ Any other kinds of values in the root dictionary (and anything inside a conversation that isn't a string) get
+ skipped, just like 'prepareScript' skips them. Entities (&amp; &lt; &#233; etc) and CDATA sections are decoded.
+ Binary .plist files can't be streamed; they return VNScriptStreamErrorBinary so that the caller can fall back to
+ loading the file some other way.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNScriptStream_h
+#define VNScriptStream_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNScriptStreamBufferSize        (64 * 1024) // How much of the file gets read at a time
+#define VNScriptStreamMaxDepth          64          // How deeply elements can be nested
+#define VNScriptStreamMaxTagLength      1024        // Longest tag (not counting comments) that the parser accepts
+#define VNScriptStreamErrorLength       128         // Big enough for any error message from the parser
+
+typedef enum {
+    VNScriptStreamOK                = 0,
+    VNScriptStreamErrorFile         = -1,   // The file couldn't be opened or read
+    VNScriptStreamErrorBinary       = -2,   // The file is a binary .plist
+    VNScriptStreamErrorMalformed    = -3,   // The file isn't valid XML, or isn't a script
+    VNScriptStreamErrorMemory       = -4,
+} VNScriptStreamResult;
+
+// Strings passed to the callbacks are null-terminated, but they're only valid until the callback returns
+typedef struct {
+    void (*beginConversation)(void* context, const char* name, size_t length);
+    void (*addLine)(void* context, const char* text, size_t length);
+    void (*endConversation)(void* context);
+} VNScriptStreamCallbacks;
+
+typedef struct {
+    uint64_t bytesRead;
+    uint32_t conversationCount;
+    uint32_t lineCount;
+    size_t longestString;       // In bytes, after decoding
+    size_t parserMemory;        // The most memory that the parser itself had allocated at any one time
+} VNScriptStreamStats;
+
+// MARK: - Functions
+
+// Streams a script file. 'stats' and 'error' can be NULL. Returns VNScriptStreamOK, or one of the errors (with a
+// description of the problem copied into 'error'). If parsing fails partway through the file, the callbacks will
+// already have been called for everything before the problem.
+VNScriptStreamResult VNScriptStreamParseFile(const char* path, const VNScriptStreamCallbacks* callbacks, void* context,
+                                             VNScriptStreamStats* stats, char* error, size_t errorSize);
+
+// Same as above, for a script that's already in memory
+VNScriptStreamResult VNScriptStreamParseBytes(const void* bytes, size_t length, const VNScriptStreamCallbacks* callbacks,
+                                              void* context, VNScriptStreamStats* stats, char* error, size_t errorSize);
+
+// MARK: - Memory use
+
+// The amount of physical memory that the process is using right now, and the most it has used since it started (this
+// can only go up). Both are in bytes, and both are zero if the OS doesn't say. These are here so that tools and
+// benchmarks can report how much memory loading a script really takes, on both macOS/iOS and Linux.
+size_t VNScriptStreamResidentBytes(void);
+size_t VNScriptStreamPeakResidentBytes(void);
+
+#endif
@@ -0,0 +1,348 @@
+//
+//  VNSpriteTable.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNSpriteTable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VNSpriteTableHeaderSize         12      // Magic, version, sprite count
+#define VNSpriteTableStateSize          40      // Four doubles, plus the lengths of the two names
+#define VNSpriteTableMaxNameLength      4096
+
+// Encoded tables look like this (everything is little-endian):
+//
+//   uint32 magic, uint32 version, uint32 sprite count
+//   for each sprite: float64 x, float64 y, float64 scale x, float64 scale y,
+//                    uint32 name length, uint32 filename length (zero if there's no filename), name, filename
+
+struct VNSpriteTable {
+    VNSpriteState* states;
+    uint32_t count;
+    uint32_t capacity;
+    int dirty; // Set when sprites are removed (which can't be seen in the flags of the ones that are left)
+};
+
+// MARK: - Table
+
+VNSpriteTable* VNSpriteTableCreate(void)
+{
+    return calloc(1, sizeof(VNSpriteTable));
+}
+
+static void VNSpriteStateFreeNames(VNSpriteState* state)
+{
+    free(state->name);
+    free(state->filename);
+}
+
+void VNSpriteTableFree(VNSpriteTable* table)
+{
+    if( table == NULL )
+        return;
+
+    VNSpriteTableRemoveAll(table);
+    free(table->states);
+    free(table);
+}
+
+uint32_t VNSpriteTableCount(const VNSpriteTable* table)
+{
+    return (table != NULL) ? table->count : 0;
+}
+
+VNSpriteState* VNSpriteTableStateAt(VNSpriteTable* table, uint32_t index)
+{
+    if( table == NULL || index >= table->count )
+        return NULL;
+
+    return &table->states[index];
+}
+
+uint32_t VNSpriteTableFind(const VNSpriteTable* table, const char* name)
+{
+    if( table == NULL || name == NULL )
+        return VNSpriteTableNotFound;
+
+    for( uint32_t i = 0; i < table->count; i++ ) {
+        if( strcmp(table->states[i].name, name) == 0 )
+            return i;
+    }
+
+    return VNSpriteTableNotFound;
+}
+
+VNSpriteState* VNSpriteTableLookup(VNSpriteTable* table, const char* name)
+{
+    uint32_t index = VNSpriteTableFind(table, name);
+    return (index != VNSpriteTableNotFound) ? &table->states[index] : NULL;
+}
+
+static char* VNSpriteTableCopyName(const char* name, size_t length)
+{
+    char* copy = malloc(length + 1);
+    if( copy != NULL ) {
+        memcpy(copy, name, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
+
+VNSpriteState* VNSpriteTableAdd(VNSpriteTable* table, const char* name, const char* filename, double x, double y)
+{
+    if( table == NULL || name == NULL || VNSpriteTableFind(table, name) != VNSpriteTableNotFound )
+        return NULL;
+
+    if( table->count == table->capacity ) {
+        uint32_t capacity = (table->capacity > 0) ? table->capacity * 2 : 8;
+        VNSpriteState* states = realloc(table->states, capacity * sizeof(VNSpriteState));
+        if( states == NULL )
+            return NULL;
+
+        table->states = states;
+        table->capacity = capacity;
+    }
+
+    VNSpriteState state = {0};
+    state.name = VNSpriteTableCopyName(name, strlen(name));
+    if( filename != NULL && strcmp(filename, name) != 0 )
+        state.filename = VNSpriteTableCopyName(filename, strlen(filename));
+
+    if( state.name == NULL || (filename != NULL && strcmp(filename, name) != 0 && state.filename == NULL) ) {
+        VNSpriteStateFreeNames(&state);
+        return NULL;
+    }
+
+    state.x = x;
+    state.y = y;
+    state.scaleX = 1.0;
+    state.scaleY = 1.0;
+    state.dirty = VNSpriteStateDirtyAdded;
+
+    table->states[table->count] = state;
+    return &table->states[table->count++];
+}
+
+int VNSpriteTableRemove(VNSpriteTable* table, const char* name)
+{
+    uint32_t index = VNSpriteTableFind(table, name);
+    if( index == VNSpriteTableNotFound )
+        return 0;
+
+    // The sprites after it move down, so that the table stays in the order the sprites were added
+    VNSpriteStateFreeNames(&table->states[index]);
+    memmove(&table->states[index], &table->states[index + 1], (table->count - index - 1) * sizeof(VNSpriteState));
+    table->count--;
+    table->dirty = 1;
+    return 1;
+}
+
+void VNSpriteTableRemoveAll(VNSpriteTable* table)
+{
+    if( table == NULL )
+        return;
+
+    for( uint32_t i = 0; i < table->count; i++ )
+        VNSpriteStateFreeNames(&table->states[i]);
+
+    if( table->count > 0 )
+        table->dirty = 1;
+
+    table->count = 0;
+}
+
+void VNSpriteTableSetPosition(VNSpriteTable* table, VNSpriteState* state, double x, double y)
+{
+    if( table == NULL || state == NULL || (state->x == x && state->y == y) )
+        return;
+
+    state->x = x;
+    state->y = y;
+    state->dirty |= VNSpriteStateDirtyPosition;
+}
+
+void VNSpriteTableSetScale(VNSpriteTable* table, VNSpriteState* state, double scaleX, double scaleY)
+{
+    if( table == NULL || state == NULL || (state->scaleX == scaleX && state->scaleY == scaleY) )
+        return;
+
+    state->scaleX = scaleX;
+    state->scaleY = scaleY;
+    state->dirty |= VNSpriteStateDirtyScale;
+}
+
+int VNSpriteTableIsDirty(const VNSpriteTable* table)
+{
+    if( table == NULL )
+        return 0;
+    if( table->dirty )
+        return 1;
+
+    for( uint32_t i = 0; i < table->count; i++ ) {
+        if( table->states[i].dirty != 0 )
+            return 1;
+    }
+
+    return 0;
+}
+
+void VNSpriteTableClearDirty(VNSpriteTable* table)
+{
+    if( table == NULL )
+        return;
+
+    for( uint32_t i = 0; i < table->count; i++ )
+        table->states[i].dirty = 0;
+
+    table->dirty = 0;
+}
+
+// MARK: - Encoding
+
+static void VNSpriteTableWrite32(uint8_t* buffer, uint32_t value)
+{
+    for( int i = 0; i < 4; i++ )
+        buffer[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint32_t VNSpriteTableRead32(const uint8_t* buffer)
+{
+    uint32_t value = 0;
+    for( int i = 0; i < 4; i++ )
+        value |= (uint32_t)buffer[i] << (i * 8);
+    return value;
+}
+
+static void VNSpriteTableWriteDouble(uint8_t* buffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for( int i = 0; i < 8; i++ )
+        buffer[i] = (uint8_t)(bits >> (i * 8));
+}
+
+static double VNSpriteTableReadDouble(const uint8_t* buffer)
+{
+    uint64_t bits = 0;
+    for( int i = 0; i < 8; i++ )
+        bits |= (uint64_t)buffer[i] << (i * 8);
+
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t VNSpriteTableEncode(const VNSpriteTable* table, uint8_t* buffer, size_t capacity)
+{
+    if( table == NULL )
+        return 0;
+
+    size_t size = VNSpriteTableHeaderSize;
+    for( uint32_t i = 0; i < table->count; i++ ) {
+        size += VNSpriteTableStateSize + strlen(table->states[i].name);
+        if( table->states[i].filename != NULL )
+            size += strlen(table->states[i].filename);
+    }
+
+    if( buffer == NULL || capacity < size )
+        return size;
+
+    VNSpriteTableWrite32(buffer, VNSpriteTableMagic);
+    VNSpriteTableWrite32(buffer + 4, VNSpriteTableVersion);
+    VNSpriteTableWrite32(buffer + 8, table->count);
+    uint8_t* position = buffer + VNSpriteTableHeaderSize;
+
+    for( uint32_t i = 0; i < table->count; i++ ) {
+
+        const VNSpriteState* state = &table->states[i];
+        size_t nameLength = strlen(state->name);
+        size_t filenameLength = (state->filename != NULL) ? strlen(state->filename) : 0;
+
+        VNSpriteTableWriteDouble(position, state->x);
+        VNSpriteTableWriteDouble(position + 8, state->y);
+        VNSpriteTableWriteDouble(position + 16, state->scaleX);
+        VNSpriteTableWriteDouble(position + 24, state->scaleY);
+        VNSpriteTableWrite32(position + 32, (uint32_t)nameLength);
+        VNSpriteTableWrite32(position + 36, (uint32_t)filenameLength);
+        position += VNSpriteTableStateSize;
+
+        memcpy(position, state->name, nameLength);
+        position += nameLength;
+        if( filenameLength > 0 )
+            memcpy(position, state->filename, filenameLength);
+        position += filenameLength;
+    }
+
+    return size;
+}
+
+VNSpriteTable* VNSpriteTableDecode(const uint8_t* data, size_t length)
+{
+    if( data == NULL || length < VNSpriteTableHeaderSize )
+        return NULL;
+
+    if( VNSpriteTableRead32(data) != VNSpriteTableMagic ) {
+        fprintf(stderr, "[VNSpriteTable] ERROR: Data is not a sprite table.\n");
+        return NULL;
+    }
+    if( VNSpriteTableRead32(data + 4) != VNSpriteTableVersion ) {
+        fprintf(stderr, "[VNSpriteTable] ERROR: Unsupported sprite table version: %u\n", VNSpriteTableRead32(data + 4));
+        return NULL;
+    }
+
+    VNSpriteTable* table = VNSpriteTableCreate();
+    if( table == NULL )
+        return NULL;
+
+    uint32_t count = VNSpriteTableRead32(data + 8);
+    size_t offset = VNSpriteTableHeaderSize;
+
+    for( uint32_t i = 0; i < count; i++ ) {
+
+        if( length - offset < VNSpriteTableStateSize )
+            goto corrupt;
+
+        const uint8_t* record = data + offset;
+        uint32_t nameLength = VNSpriteTableRead32(record + 32);
+        uint32_t filenameLength = VNSpriteTableRead32(record + 36);
+        offset += VNSpriteTableStateSize;
+
+        if( nameLength == 0 || nameLength > VNSpriteTableMaxNameLength || filenameLength > VNSpriteTableMaxNameLength )
+            goto corrupt;
+        if( length - offset < (size_t)nameLength + filenameLength )
+            goto corrupt;
+
+        char* name = VNSpriteTableCopyName((const char*)(data + offset), nameLength);
+        char* filename = (filenameLength > 0) ? VNSpriteTableCopyName((const char*)(data + offset + nameLength), filenameLength) : NULL;
+        offset += nameLength + filenameLength;
+
+        // Names with zero bytes in them (or names that show up twice) can't have come from a real table
+        VNSpriteState* state = NULL;
+        if( name != NULL && strlen(name) == nameLength && (filename == NULL || strlen(filename) == filenameLength) )
+            state = VNSpriteTableAdd(table, name, filename, VNSpriteTableReadDouble(record), VNSpriteTableReadDouble(record + 8));
+
+        free(name);
+        free(filename);
+        if( state == NULL )
+            goto corrupt;
+
+        state->scaleX = VNSpriteTableReadDouble(record + 16);
+        state->scaleY = VNSpriteTableReadDouble(record + 24);
+    }
+
+    if( offset != length )
+        goto corrupt;
+
+    VNSpriteTableClearDirty(table);
+    return table;
+
+corrupt:
+    fprintf(stderr, "[VNSpriteTable] ERROR: Sprite table data is corrupt.\n");
+    VNSpriteTableFree(table);
+    return NULL;
+}
@@ -0,0 +1,99 @@
+//
+//  VNSpriteTable.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNSpriteTable
+
+ The saved state of every character sprite in a scene: its name, which file it was loaded from (if that was different
+ from its name, because of a sprite alias), where it is, and how it's scaled. VNScene updates the table whenever a
+ sprite command changes one of those things, so saving the game doesn't have to go through the sprites on the screen
+ and box their coordinates into dictionaries; the table just gets encoded as it is (and only when something in it has
+ changed since the last time). When a game is loaded, the sprites are created straight from the table.
+
+ Each sprite has "dirty" flags for whatever has changed since the flags were last cleared, and the table itself
+ remembers whether anything was added, changed, or removed. Sprites are kept in the order they were added. Scenes only
+ have a handful of sprites at a time, so looking one up is just a search through the table.
+
+ Pointers to sprite states stay valid until the next time a sprite is added or removed.
+
+ This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNSpriteTable_h
+#define VNSpriteTable_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNSpriteTableNotFound           UINT32_MAX
+#define VNSpriteTableMagic              0x54534E56  // "VNST" (little-endian)
+#define VNSpriteTableVersion            1
+
+// Dirty flags
+#define VNSpriteStateDirtyAdded         0x01
+#define VNSpriteStateDirtyPosition      0x02
+#define VNSpriteStateDirtyScale         0x04
+
+typedef struct {
+    char* name;
+    char* filename;     // NULL if the sprite was loaded from a file with the same name
+    double x;
+    double y;
+    double scaleX;      // Negative if the sprite has been flipped
+    double scaleY;
+    uint32_t dirty;
+} VNSpriteState;
+
+typedef struct VNSpriteTable VNSpriteTable;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+VNSpriteTable* VNSpriteTableCreate(void);
+void VNSpriteTableFree(VNSpriteTable* table);
+
+uint32_t VNSpriteTableCount(const VNSpriteTable* table);
+VNSpriteState* VNSpriteTableStateAt(VNSpriteTable* table, uint32_t index);
+
+// Returns VNSpriteTableNotFound (or NULL) if there's no sprite with that name
+uint32_t VNSpriteTableFind(const VNSpriteTable* table, const char* name);
+VNSpriteState* VNSpriteTableLookup(VNSpriteTable* table, const char* name);
+
+// Adds a sprite (with a scale of 1). Returns NULL if there's already a sprite with that name, or if there wasn't enough
+// memory. The filename can be NULL (or the same as the name) if there's no alias.
+VNSpriteState* VNSpriteTableAdd(VNSpriteTable* table, const char* name, const char* filename, double x, double y);
+
+// Returns 0 if there was no sprite with that name
+int VNSpriteTableRemove(VNSpriteTable* table, const char* name);
+void VNSpriteTableRemoveAll(VNSpriteTable* table);
+
+// These only mark the sprite as dirty if the values are actually different
+void VNSpriteTableSetPosition(VNSpriteTable* table, VNSpriteState* state, double x, double y);
+void VNSpriteTableSetScale(VNSpriteTable* table, VNSpriteState* state, double scaleX, double scaleY);
+
+// Whether anything has been added, changed, or removed since the dirty flags were last cleared
+int VNSpriteTableIsDirty(const VNSpriteTable* table);
+void VNSpriteTableClearDirty(VNSpriteTable* table);
+
+// Encodes the table and returns the number of bytes used. If the buffer is NULL (or too small), nothing is written and
+// the size that the buffer needs to be is returned instead.
+size_t VNSpriteTableEncode(const VNSpriteTable* table, uint8_t* buffer, size_t capacity);
+
+// Creates a table from encoded data (with nothing marked as dirty). Returns NULL if the data isn't a valid sprite table.
+VNSpriteTable* VNSpriteTableDecode(const uint8_t* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
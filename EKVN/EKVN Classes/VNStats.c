@@ -0,0 +1,403 @@
+//
+//  VNStats.c
+//
+//  Copyright 2026. All rights reserved.
+//
+
+#include "VNStats.h"
+#include "VNScriptCommands.h"
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VNStatsJSONInitialCapacity      (16 * 1024)
+#define VNStatsModeUnused               0       // Mode keys are the mode plus VNStatsModeKeyBit, so zero is never a real mode
+#define VNStatsModeKeyBit               (1ULL << 32)
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t totalTime;
+    _Atomic uint64_t maxTime;
+} VNStatsCounter;
+
+typedef struct {
+    _Atomic uint64_t key;
+    VNStatsCounter update;
+    VNStatsCounter interval;
+    _Atomic uint64_t updateHistogram[VNStatsFrameBucketCount];
+    _Atomic uint64_t intervalHistogram[VNStatsFrameBucketCount];
+} VNStatsModeCounters;
+
+static _Atomic int VNStatsEnabled = 1;
+static _Atomic uint64_t VNStatsStartTime = 0;
+static VNStatsCounter VNStatsCommands[VNStatsMaxCommandTypes];
+static VNStatsCounter VNStatsTimers[VNStatsTimerCount];
+static VNStatsModeCounters VNStatsModes[VNStatsMaxModes];
+
+static const uint64_t VNStatsBucketLimits[VNStatsFrameBucketCount] = VNStatsFrameBucketLimits;
+static const char* VNStatsTimerNames[VNStatsTimerCount] = { "text retexture", "sprite load", "save", "script load", "rollback" };
+
+// MARK: - Recording
+
+void VNStatsSetEnabled(int isEnabled)
+{
+    atomic_store_explicit(&VNStatsEnabled, isEnabled, memory_order_relaxed);
+}
+
+int VNStatsIsEnabled(void)
+{
+    return atomic_load_explicit(&VNStatsEnabled, memory_order_relaxed);
+}
+
+uint64_t VNStatsNow(void)
+{
+#if defined(__APPLE__)
+    // This just reads a value that the kernel keeps updated in shared memory, so it doesn't need a system call
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
+uint64_t VNStatsStart(void)
+{
+    if( atomic_load_explicit(&VNStatsEnabled, memory_order_relaxed) == 0 )
+        return 0;
+
+    uint64_t now = VNStatsNow();
+    if( atomic_load_explicit(&VNStatsStartTime, memory_order_relaxed) == 0 ) {
+        uint64_t expected = 0;
+        atomic_compare_exchange_strong(&VNStatsStartTime, &expected, now);
+    }
+
+    return now;
+}
+
+static void VNStatsAdd(VNStatsCounter* counter, uint64_t time)
+{
+    atomic_fetch_add_explicit(&counter->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counter->totalTime, time, memory_order_relaxed);
+
+    // The maximum hardly ever changes, so this is almost always just one read
+    uint64_t maxTime = atomic_load_explicit(&counter->maxTime, memory_order_relaxed);
+    while( time > maxTime ) {
+        if( atomic_compare_exchange_weak_explicit(&counter->maxTime, &maxTime, time, memory_order_relaxed, memory_order_relaxed) )
+            break;
+    }
+}
+
+static void VNStatsAddToHistogram(_Atomic uint64_t* histogram, uint64_t time)
+{
+    uint64_t microseconds = time / 1000;
+    int bucket = 0;
+    while( bucket < VNStatsFrameBucketCount - 1 && microseconds >= VNStatsBucketLimits[bucket] )
+        bucket++;
+
+    atomic_fetch_add_explicit(&histogram[bucket], 1, memory_order_relaxed);
+}
+
+static uint64_t VNStatsElapsedSince(uint64_t startTime)
+{
+    uint64_t now = VNStatsNow();
+    return (now > startTime) ? (now - startTime) : 0;
+}
+
+void VNStatsRecordCommand(int commandType, uint64_t startTime)
+{
+    if( startTime == 0 || commandType < 0 || commandType >= VNStatsMaxCommandTypes )
+        return;
+
+    VNStatsAdd(&VNStatsCommands[commandType], VNStatsElapsedSince(startTime));
+}
+
+void VNStatsRecordTimer(VNStatsTimer timer, uint64_t startTime)
+{
+    if( startTime == 0 || timer < 0 || timer >= VNStatsTimerCount )
+        return;
+
+    VNStatsAdd(&VNStatsTimers[timer], VNStatsElapsedSince(startTime));
+}
+
+// Finds (or claims) the counters for a mode. Returns NULL if every slot is already taken by other modes.
+static VNStatsModeCounters* VNStatsCountersForMode(int mode)
+{
+    uint64_t key = (uint64_t)(uint32_t)mode | VNStatsModeKeyBit;
+
+    for( int i = 0; i < VNStatsMaxModes; i++ ) {
+
+        uint64_t existingKey = atomic_load_explicit(&VNStatsModes[i].key, memory_order_acquire);
+        if( existingKey == key )
+            return &VNStatsModes[i];
+
+        if( existingKey == VNStatsModeUnused ) {
+            uint64_t expected = VNStatsModeUnused;
+            if( atomic_compare_exchange_strong(&VNStatsModes[i].key, &expected, key) || expected == key )
+                return &VNStatsModes[i];
+        }
+    }
+
+    return NULL;
+}
+
+void VNStatsRecordFrame(int mode, uint64_t startTime, uint64_t interval)
+{
+    if( startTime == 0 )
+        return;
+
+    VNStatsModeCounters* counters = VNStatsCountersForMode(mode);
+    if( counters == NULL )
+        return;
+
+    uint64_t time = VNStatsElapsedSince(startTime);
+    VNStatsAdd(&counters->update, time);
+    VNStatsAddToHistogram(counters->updateHistogram, time);
+
+    if( interval > 0 ) {
+        VNStatsAdd(&counters->interval, interval);
+        VNStatsAddToHistogram(counters->intervalHistogram, interval);
+    }
+}
+
+static void VNStatsClearCounter(VNStatsCounter* counter)
+{
+    atomic_store_explicit(&counter->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&counter->totalTime, 0, memory_order_relaxed);
+    atomic_store_explicit(&counter->maxTime, 0, memory_order_relaxed);
+}
+
+void VNStatsReset(void)
+{
+    for( int i = 0; i < VNStatsMaxCommandTypes; i++ )
+        VNStatsClearCounter(&VNStatsCommands[i]);
+    for( int i = 0; i < VNStatsTimerCount; i++ )
+        VNStatsClearCounter(&VNStatsTimers[i]);
+
+    // Modes keep their slots, since frames for them might be getting recorded right now
+    for( int i = 0; i < VNStatsMaxModes; i++ ) {
+        VNStatsClearCounter(&VNStatsModes[i].update);
+        VNStatsClearCounter(&VNStatsModes[i].interval);
+        for( int bucket = 0; bucket < VNStatsFrameBucketCount; bucket++ ) {
+            atomic_store_explicit(&VNStatsModes[i].updateHistogram[bucket], 0, memory_order_relaxed);
+            atomic_store_explicit(&VNStatsModes[i].intervalHistogram[bucket], 0, memory_order_relaxed);
+        }
+    }
+
+    atomic_store_explicit(&VNStatsStartTime, VNStatsNow(), memory_order_relaxed);
+}
+
+// MARK: - Snapshots
+
+static void VNStatsCopyCounter(VNStatsCounter* counter, VNStatsTiming* timing)
+{
+    timing->count = atomic_load_explicit(&counter->count, memory_order_relaxed);
+    timing->totalTime = atomic_load_explicit(&counter->totalTime, memory_order_relaxed);
+    timing->maxTime = atomic_load_explicit(&counter->maxTime, memory_order_relaxed);
+}
+
+void VNStatsCopySnapshot(VNStatsSnapshot* snapshot)
+{
+    if( snapshot == NULL )
+        return;
+
+    memset(snapshot, 0, sizeof(VNStatsSnapshot));
+
+    uint64_t startTime = atomic_load_explicit(&VNStatsStartTime, memory_order_relaxed);
+    if( startTime > 0 )
+        snapshot->uptime = VNStatsElapsedSince(startTime);
+
+    for( int i = 0; i < VNStatsMaxCommandTypes; i++ )
+        VNStatsCopyCounter(&VNStatsCommands[i], &snapshot->commands[i]);
+    for( int i = 0; i < VNStatsTimerCount; i++ )
+        VNStatsCopyCounter(&VNStatsTimers[i], &snapshot->timers[i]);
+
+    for( int i = 0; i < VNStatsMaxModes; i++ ) {
+
+        uint64_t key = atomic_load_explicit(&VNStatsModes[i].key, memory_order_acquire);
+        if( key == VNStatsModeUnused )
+            continue;
+
+        VNStatsModeSnapshot* mode = &snapshot->modes[snapshot->modeCount++];
+        mode->mode = (int)(uint32_t)(key & 0xFFFFFFFFULL);
+        VNStatsCopyCounter(&VNStatsModes[i].update, &mode->update);
+        VNStatsCopyCounter(&VNStatsModes[i].interval, &mode->interval);
+        for( int bucket = 0; bucket < VNStatsFrameBucketCount; bucket++ ) {
+            mode->updateHistogram[bucket] = atomic_load_explicit(&VNStatsModes[i].updateHistogram[bucket], memory_order_relaxed);
+            mode->intervalHistogram[bucket] = atomic_load_explicit(&VNStatsModes[i].intervalHistogram[bucket], memory_order_relaxed);
+        }
+    }
+}
+
+const char* VNStatsTimerName(VNStatsTimer timer)
+{
+    if( timer < 0 || timer >= VNStatsTimerCount )
+        return NULL;
+
+    return VNStatsTimerNames[timer];
+}
+
+// MARK: - JSON
+
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity;
+    int failed;
+} VNStatsJSON;
+
+static void VNStatsJSONAppend(VNStatsJSON* json, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void VNStatsJSONAppend(VNStatsJSON* json, const char* format, ...)
+{
+    if( json->failed )
+        return;
+
+    for( ;; ) {
+        va_list arguments;
+        va_start(arguments, format);
+        int length = vsnprintf(json->text + json->length, json->capacity - json->length, format, arguments);
+        va_end(arguments);
+
+        if( length < 0 ) {
+            json->failed = 1;
+            return;
+        }
+
+        if( json->length + (size_t)length < json->capacity ) {
+            json->length += (size_t)length;
+            return;
+        }
+
+        size_t capacity = json->capacity * 2;
+        while( capacity <= json->length + (size_t)length )
+            capacity *= 2;
+
+        char* text = realloc(json->text, capacity);
+        if( text == NULL ) {
+            json->failed = 1;
+            return;
+        }
+
+        json->text = text;
+        json->capacity = capacity;
+    }
+}
+
+static double VNStatsMilliseconds(uint64_t nanoseconds)
+{
+    return (double)nanoseconds / 1000000.0;
+}
+
+static void VNStatsJSONAppendTiming(VNStatsJSON* json, const VNStatsTiming* timing)
+{
+    double average = (timing->count > 0) ? VNStatsMilliseconds(timing->totalTime) / (double)timing->count : 0;
+    VNStatsJSONAppend(json, "\"count\": %llu, \"total ms\": %.4f, \"average ms\": %.4f, \"max ms\": %.4f",
+                      (unsigned long long)timing->count, VNStatsMilliseconds(timing->totalTime), average, VNStatsMilliseconds(timing->maxTime));
+}
+
+static void VNStatsJSONAppendHistogram(VNStatsJSON* json, const uint64_t* histogram)
+{
+    VNStatsJSONAppend(json, "[");
+    for( int bucket = 0; bucket < VNStatsFrameBucketCount; bucket++ )
+        VNStatsJSONAppend(json, "%s%llu", (bucket > 0) ? ", " : "", (unsigned long long)histogram[bucket]);
+    VNStatsJSONAppend(json, "]");
+}
+
+char* VNStatsCopyJSON(void)
+{
+    VNStatsSnapshot* snapshot = malloc(sizeof(VNStatsSnapshot));
+    if( snapshot == NULL )
+        return NULL;
+
+    VNStatsCopySnapshot(snapshot);
+
+    VNStatsJSON json = { malloc(VNStatsJSONInitialCapacity), 0, VNStatsJSONInitialCapacity, 0 };
+    if( json.text == NULL ) {
+        free(snapshot);
+        return NULL;
+    }
+
+    VNStatsJSONAppend(&json, "{\n  \"uptime ms\": %.3f,\n", VNStatsMilliseconds(snapshot->uptime));
+
+    // Commands that have never been run are left out
+    VNStatsJSONAppend(&json, "  \"commands\": [");
+    int commandCount = 0;
+    for( int type = 0; type < VNStatsMaxCommandTypes; type++ ) {
+
+        if( snapshot->commands[type].count == 0 )
+            continue;
+
+        const char* name = VNScriptCommandNameForType(type);
+        VNStatsJSONAppend(&json, "%s\n    { \"type\": %d, \"name\": \"%s\", ", (commandCount > 0) ? "," : "", type, (name != NULL) ? name : "");
+        VNStatsJSONAppendTiming(&json, &snapshot->commands[type]);
+        VNStatsJSONAppend(&json, " }");
+        commandCount++;
+    }
+    VNStatsJSONAppend(&json, "%s],\n", (commandCount > 0) ? "\n  " : "");
+
+    VNStatsJSONAppend(&json, "  \"timers\": {");
+    for( int timer = 0; timer < VNStatsTimerCount; timer++ ) {
+        VNStatsJSONAppend(&json, "%s\n    \"%s\": { ", (timer > 0) ? "," : "", VNStatsTimerNames[timer]);
+        VNStatsJSONAppendTiming(&json, &snapshot->timers[timer]);
+        VNStatsJSONAppend(&json, " }");
+    }
+    VNStatsJSONAppend(&json, "\n  },\n");
+
+    VNStatsJSONAppend(&json, "  \"frame buckets us\": [");
+    for( int bucket = 0; bucket < VNStatsFrameBucketCount - 1; bucket++ )
+        VNStatsJSONAppend(&json, "%s%llu", (bucket > 0) ? ", " : "", (unsigned long long)VNStatsBucketLimits[bucket]);
+    VNStatsJSONAppend(&json, "],\n");
+
+    VNStatsJSONAppend(&json, "  \"frames\": [");
+    for( int i = 0; i < snapshot->modeCount; i++ ) {
+        const VNStatsModeSnapshot* mode = &snapshot->modes[i];
+        VNStatsJSONAppend(&json, "%s\n    { \"mode\": %d,\n      \"update\": { ", (i > 0) ? "," : "", mode->mode);
+        VNStatsJSONAppendTiming(&json, &mode->update);
+        VNStatsJSONAppend(&json, ", \"histogram\": ");
+        VNStatsJSONAppendHistogram(&json, mode->updateHistogram);
+        VNStatsJSONAppend(&json, " },\n      \"interval\": { ");
+        VNStatsJSONAppendTiming(&json, &mode->interval);
+        VNStatsJSONAppend(&json, ", \"histogram\": ");
+        VNStatsJSONAppendHistogram(&json, mode->intervalHistogram);
+        VNStatsJSONAppend(&json, " } }");
+    }
+    VNStatsJSONAppend(&json, "%s]\n}\n", (snapshot->modeCount > 0) ? "\n  " : "");
+
+    free(snapshot);
+
+    if( json.failed ) {
+        free(json.text);
+        return NULL;
+    }
+
+    return json.text;
+}
+
+int VNStatsWriteJSONToFile(const char* path)
+{
+    if( path == NULL )
+        return 0;
+
+    char* json = VNStatsCopyJSON();
+    if( json == NULL )
+        return 0;
+
+    FILE* file = fopen(path, "w");
+    if( file == NULL ) {
+        fprintf(stderr, "[VNStats] ERROR: Could not open %s for writing.\n", path);
+        free(json);
+        return 0;
+    }
+
+    size_t length = strlen(json);
+    int didWrite = (fwrite(json, 1, length, file) == length);
+    fclose(file);
+    free(json);
+
+    return didWrite;
+}
@@ -0,0 +1,125 @@
+//
+//  VNStats.h
+//
+//  Copyright 2026. All rights reserved.
+//
+
+/*
+
+ VNStats
+
+ Performance counters for the parts of the engine that can make a frame take too long. Unlike VNBenchmark (which
+ only exists in debug builds) and Instruments, these are meant to be left on in release builds, so that when a
+ player runs into a stutter, there's a record of what the engine was doing. Recording something only takes a
+ couple of reads of the system clock and a few atomic additions, and doesn't allocate memory or take any locks.
+
+ Three kinds of things get recorded:
+
+   - Commands: how many times each kind of script command (see VNScriptCommands.h) has been run, and how long they
+     took. This is measured by VNRuntime, so it includes logic commands as well as the ones that VNScene presents.
+     The time for commands that contain other commands (like .IF) includes the time of the nested command.
+
+   - Frames: how long VNScene's 'update:' took, and how long it's been since the previous frame, for each scene mode.
+     Both are also counted in a histogram (see VNStatsFrameBucketLimits), which makes stutters easy to spot even
+     when the averages look fine.
+
+   - Timers: how long the usual suspects took (see VNStatsTimer): retexturing text labels, loading sprites, saving,
+     loading scripts, and taking rollback snapshots.
+
+ Everything can be copied into a VNStatsSnapshot, or exported as JSON:
+
+   char* json = VNStatsCopyJSON();
+   ...
+   free(json);
+
+ Times are in nanoseconds, except in the JSON, where they're in milliseconds. Counters can be updated from any
+ thread. This file is plain C so that it can be used outside of the app, such as in command-line tools.
+
+ */
+
+#ifndef VNStats_h
+#define VNStats_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MARK: - Definitions
+
+#define VNStatsMaxCommandTypes          256     // Command types (VNScriptCommand...) have to be below this
+#define VNStatsMaxModes                 16      // How many different scene modes can have frame stats
+#define VNStatsFrameBucketCount         8
+
+// Upper limits (in microseconds) for each bucket of the frame histograms; the last bucket holds anything slower
+#define VNStatsFrameBucketLimits        { 1000, 2000, 4000, 8333, 16667, 33333, 66667, UINT64_MAX }
+
+typedef enum {
+    VNStatsTimerTextRetexture = 0,  // Redrawing a multiline label's texture (whenever its text changes)
+    VNStatsTimerSpriteLoad,         // Creating sprites (and backgrounds) from image files
+    VNStatsTimerSave,               // VNScene saving to EKRecord (and to the device)
+    VNStatsTimerScriptLoad,         // Creating a VNScript (which might mean loading and translating a file)
+    VNStatsTimerRollback,           // VNScene taking a rollback snapshot (whenever a line of dialogue is shown)
+    VNStatsTimerCount
+} VNStatsTimer;
+
+typedef struct {
+    uint64_t count;
+    uint64_t totalTime;
+    uint64_t maxTime;
+} VNStatsTiming;
+
+typedef struct {
+    int mode;
+    VNStatsTiming update;       // Time spent in 'update:'
+    VNStatsTiming interval;     // Time since the previous frame
+    uint64_t updateHistogram[VNStatsFrameBucketCount];
+    uint64_t intervalHistogram[VNStatsFrameBucketCount];
+} VNStatsModeSnapshot;
+
+typedef struct {
+    uint64_t uptime;            // Time since the stats were started (or reset)
+    VNStatsTiming commands[VNStatsMaxCommandTypes];
+    VNStatsTiming timers[VNStatsTimerCount];
+    int modeCount;
+    VNStatsModeSnapshot modes[VNStatsMaxModes];
+} VNStatsSnapshot;
+
+// MARK: - Functions
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Stats are on by default. While they're off, nothing gets recorded.
+void VNStatsSetEnabled(int isEnabled);
+int VNStatsIsEnabled(void);
+
+// The current time (in nanoseconds) from a monotonic clock
+uint64_t VNStatsNow(void);
+
+// Returns the current time, or zero if stats are off. Pass the result to one of the 'record' functions once the
+// thing being measured has finished (they do nothing if the start time is zero).
+uint64_t VNStatsStart(void);
+
+void VNStatsRecordCommand(int commandType, uint64_t startTime);
+void VNStatsRecordTimer(VNStatsTimer timer, uint64_t startTime);
+
+// The interval is the time since the previous frame (or zero if it isn't known)
+void VNStatsRecordFrame(int mode, uint64_t startTime, uint64_t interval);
+
+void VNStatsReset(void);
+
+void VNStatsCopySnapshot(VNStatsSnapshot* snapshot);
+
+// Returns the stats as a JSON object (which needs to be freed), or NULL if there wasn't enough memory
+char* VNStatsCopyJSON(void);
+
+// Writes the JSON to a file (overwriting it). Returns 0 on failure.
+int VNStatsWriteJSONToFile(const char* path);
+
+const char* VNStatsTimerName(VNStatsTimer timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,6 +7,7 @@
 
 #import "VNTestScene.h"
 #import "VNScene.h"
+#import "VNScriptCache.h"
 #import "EKRecord.h"
 #import "ekutils.h"
 //#import "OALSimpleAudio.h"
@@ -119,6 +120,18 @@
     // Grab script name information
     nameOfScript = standardSettings[VNTestSceneScriptToLoad];
     
+    // Start translating the scripts that the player is going to need next (the one for a new game, and the one from the
+    // saved game, if there is one) while they're looking at the menu, so that starting or continuing a game is quick
+    NSMutableArray* scriptsToPreload = [NSMutableArray array];
+    if( nameOfScript != nil )
+        [scriptsToPreload addObject:nameOfScript];
+    NSDictionary* savedGameData = [[[EKRecord sharedRecord] activityDict] objectForKey:EKRecordActivityDataKey];
+    NSString* savedScriptName = [[savedGameData objectForKey:VNSceneSavedScriptInfoKey] objectForKey:VNScriptFilenameKey];
+    if( savedScriptName != nil && [savedScriptName isEqualToString:nameOfScript] == NO )
+        [scriptsToPreload addObject:savedScriptName];
+    
+    [[VNScriptCache sharedCache] preloadScriptsNamed:scriptsToPreload];
+    
     // The music data is loaded last since it looks weird if music is playing but nothing has shown up on the screen yet.
     NSString* musicFilename = standardSettings[VNTestSceneMenuMusic];
     // Make sure the music isn't set to 'nil'
@@ -15,6 +15,7 @@
 //
 
 #import "DSMultilineLabelNode.h"
+#import "VNStats.h"
 
 @implementation DSMultilineLabelNode
 
@@ -111,6 +112,8 @@
 //Generates and applies new textures based on the current property values
 -(void) retexture
 {
+    uint64_t startTime = VNStatsStart();
+    
     DSMultiLineLabelImage *newTextImage = [self imageFromText:self.text];
     SKTexture *newTexture =[SKTexture textureWithImage:newTextImage];
     
@@ -119,6 +122,8 @@
     
     //Resetting the texture also reset the anchorPoint.  Let's recenter it.
     selfNode.anchorPoint = CGPointMake(0.5, 0.5);
+    
+    VNStatsRecordTimer(VNStatsTimerTextRetexture, startTime);
 
 }
 